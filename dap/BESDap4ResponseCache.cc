@@ -0,0 +1,241 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BESDebug.h"
+#include "BESIndent.h"
+#include "BESLog.h"
+#include "TheBESKeys.h"
+#include "FileCache.h"
+
+#include "BESDap4ResponseCache.h"
+
+#define MODULE "dap4_response_cache"
+#define prolog std::string("BESDap4ResponseCache::").append(__func__).append("() - ")
+
+using namespace std;
+
+const string BESDap4ResponseCache::PATH_KEY = "DAP.Dap4ResponseCache.path";
+const string BESDap4ResponseCache::SIZE_KEY = "DAP.Dap4ResponseCache.size";
+const string BESDap4ResponseCache::PURGE_SIZE_KEY = "DAP.Dap4ResponseCache.purge_size";
+const string BESDap4ResponseCache::MAX_ENTRY_SIZE_KEY = "DAP.Dap4ResponseCache.max_entry_size";
+const string BESDap4ResponseCache::EXCLUDE_TYPES_KEY = "DAP.Dap4ResponseCache.exclude_container_types";
+
+void BESDap4ResponseCache::Capture::begin() {
+    if (d_before_first_write) {
+        auto f = std::move(d_before_first_write);
+        d_before_first_write = nullptr;
+        f();
+    }
+}
+
+void BESDap4ResponseCache::Capture::keep(const char *s, streamsize n) {
+    if (d_overflowed)
+        return;
+    if (d_copy.size() + n > d_limit) {
+        d_overflowed = true;
+        string().swap(d_copy);
+        return;
+    }
+    d_copy.append(s, n);
+}
+
+BESDap4ResponseCache::Capture::int_type BESDap4ResponseCache::Capture::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+
+    begin();
+    if (traits_type::eq_int_type(d_sink->sputc(traits_type::to_char_type(c)), traits_type::eof()))
+        return traits_type::eof();
+    char ch = traits_type::to_char_type(c);
+    keep(&ch, 1);
+    return c;
+}
+
+streamsize BESDap4ResponseCache::Capture::xsputn(const char *s, streamsize n) {
+    begin();
+    streamsize written = d_sink->sputn(s, n);
+    keep(s, written);
+    return written;
+}
+
+/**
+ * @brief Read the configuration and initialize the FileCache
+ *
+ * If DAP.Dap4ResponseCache.path is not set or the cache cannot be
+ * initialized, the cache is disabled.
+ */
+BESDap4ResponseCache::BESDap4ResponseCache() {
+    d_cache_dir = TheBESKeys::TheKeys()->read_string_key(PATH_KEY, "");
+    if (d_cache_dir.empty())
+        return;
+
+    const long long size_mb = TheBESKeys::TheKeys()->read_ulong_key(SIZE_KEY, 1000);
+    const long long purge_mb = TheBESKeys::TheKeys()->read_ulong_key(PURGE_SIZE_KEY, 100);
+    d_max_entry_size = TheBESKeys::TheKeys()->read_ulong_key(MAX_ENTRY_SIZE_KEY, 64) * 1024 * 1024;
+
+    d_cache.reset(new FileCache());
+    if (!d_cache->initialize(d_cache_dir, size_mb * 1024 * 1024, purge_mb * 1024 * 1024)) {
+        ERROR_LOG(prolog + "Could not initialize the DAP4 response cache in " + d_cache_dir + "; it is disabled.");
+        d_cache.reset();
+        return;
+    }
+
+    d_enabled = true;
+    BESDEBUG(MODULE, prolog << "DAP4 response cache: " << d_cache_dir << ", " << size_mb << "MB" << endl);
+}
+
+// Defined here because FileCache is incomplete in the header.
+BESDap4ResponseCache::~BESDap4ResponseCache() = default;
+
+/**
+ * @brief Can responses made from this type of container be cached?
+ *
+ * Some handlers read files other than the container's (e.g., the members
+ * of an NcML aggregation). A change to one of those would not change the
+ * key, so those container types are listed in
+ * DAP.Dap4ResponseCache.exclude_container_types; the default is ncml.
+ */
+bool BESDap4ResponseCache::is_cacheable_type(const string &container_type) {
+    bool found = false;
+    vector<string> types;
+    TheBESKeys::TheKeys()->get_values(EXCLUDE_TYPES_KEY, types, found);
+    if (!found)
+        types.emplace_back("ncml");
+
+    return find(types.begin(), types.end(), container_type) == types.end();
+}
+
+/**
+ * @brief The cache key for a response
+ *
+ * @param datasets The pathnames of all the datasets the response is made
+ * from, i.e., of each container of the request
+ * @param ce The DAP4 constraint expression
+ * @param function The DAP4 server function expression
+ * @param settings Anything else that changes the bytes of the response
+ * @return The key, or the empty string if one of the datasets is not a file,
+ * in which case the response must not be cached.
+ */
+string BESDap4ResponseCache::get_key(const vector<string> &datasets, const string &ce, const string &function,
+                                     const string &settings) {
+    if (datasets.empty())
+        return "";
+
+    ostringstream oss;
+    oss << ce << '\n' << function << '\n' << settings;
+    for (const auto &dataset : datasets) {
+        struct stat sb = {};
+        if (stat(dataset.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+            return "";
+
+        oss << '\n' << dataset << '\n' << sb.st_mtim.tv_sec << '.' << sb.st_mtim.tv_nsec << '\n' << sb.st_size << '\n'
+            << sb.st_ino;
+    }
+    return FileCache::hash_key(oss.str());
+}
+
+/**
+ * @brief Send a cached response
+ *
+ * The cached item is memory mapped and written to the stream in one call, so
+ * the bytes go from the page cache to the stream without another copy.
+ *
+ * @param key The key from get_key()
+ * @param out Write the response here
+ * @param before_response If not null, called just before the response is
+ * written, e.g., to write the MIME headers
+ * @return True if the response was sent, false if it is not in the cache, in
+ * which case nothing was written.
+ */
+bool BESDap4ResponseCache::send(const string &key, ostream &out, const function<void()> &before_response) {
+    if (!d_enabled)
+        return false;
+
+    FileCache::Item item;
+    struct stat sb = {};
+    if (!d_cache->get(key, item) || fstat(item.get_fd(), &sb) != 0 || sb.st_size == 0) {
+        ++d_misses;
+        return false;
+    }
+
+    void *response = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, item.get_fd(), 0);
+    if (response == MAP_FAILED) {
+        ERROR_LOG(prolog + "Could not map the cached response " + key + ": " + get_errno());
+        ++d_misses;
+        return false;
+    }
+    madvise(response, sb.st_size, MADV_SEQUENTIAL);
+
+    if (before_response)
+        before_response();
+    out.write(static_cast<const char *>(response), sb.st_size);
+    out.flush();
+    munmap(response, sb.st_size);
+
+    ++d_hits;
+    d_bytes_sent += sb.st_size;
+    BESDEBUG(MODULE, prolog << "Sent " << sb.st_size << " bytes from " << key << endl);
+    return true;
+}
+
+/**
+ * @brief Cache a response
+ *
+ * @param key The key from get_key()
+ * @param response The DMR and chunked data, without MIME headers
+ * @return True if the response was cached, false if not (e.g., another
+ * process cached it first).
+ */
+bool BESDap4ResponseCache::put(const string &key, const string &response) {
+    if (!d_enabled || response.empty() || response.size() > d_max_entry_size)
+        return false;
+
+    if (!d_cache->put_data(key, response))
+        return false;
+
+    d_cache->purge();
+    BESDEBUG(MODULE, prolog << "Cached " << response.size() << " bytes as " << key << endl);
+    return true;
+}
+
+void BESDap4ResponseCache::dump(ostream &strm) const {
+    strm << BESIndent::LMarg << prolog << "(this: " << (void *)this << ")" << endl;
+    BESIndent::Indent();
+    strm << BESIndent::LMarg << "enabled: " << (d_enabled ? "true" : "false") << endl;
+    strm << BESIndent::LMarg << "cache_dir: " << d_cache_dir << endl;
+    strm << BESIndent::LMarg << "max_entry_size: " << d_max_entry_size << endl;
+    strm << BESIndent::LMarg << "hits: " << d_hits << endl;
+    strm << BESIndent::LMarg << "misses: " << d_misses << endl;
+    strm << BESIndent::LMarg << "bytes_sent: " << d_bytes_sent << endl;
+    BESIndent::UnIndent();
+}
@@ -0,0 +1,169 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _bes_dap4_response_cache_h
+#define _bes_dap4_response_cache_h
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "BESObj.h"
+
+class FileCache;
+
+/**
+ * @brief Cache serialized DAP4 data responses
+ *
+ * A DAP4 data response is a function of the dataset, the constraint and
+ * server function expressions, and a few request settings (checksums, the
+ * xml:base of the DMR and the response size limits). When none of those
+ * change, and the source file has not been modified, the bytes sent are the
+ * same. This cache keeps those bytes - the DMR and the chunked data, including
+ * any checksums, but not the MIME headers - in a FileCache that all the
+ * beslistener processes share.
+ *
+ * The key is the SHA256 hash of the request parameters plus the sources'
+ * last-modified time, size and inode, which serve as their ETag. The sources
+ * are the files of all the containers of the request. A source that changes
+ * gets a new key; the stale entries are removed by the cache's LRU purge.
+ * Datasets that are not local files (e.g., NGAP granules) have no such
+ * validator and are not cached. Neither are the container types listed in
+ * DAP.Dap4ResponseCache.exclude_container_types (by default, ncml), since
+ * they read files (e.g., the members of an aggregation) that are not known
+ * here.
+ *
+ * Responses are copied to the cache as they are sent to the client (see
+ * Capture), so a miss costs no more than the copy. Responses larger than
+ * DAP.Dap4ResponseCache.max_entry_size are not cached.
+ *
+ * The cache is off unless DAP.Dap4ResponseCache.path is set.
+ */
+class BESDap4ResponseCache : public BESObj {
+private:
+    std::unique_ptr<FileCache> d_cache;
+    std::string d_cache_dir;
+    bool d_enabled = false;
+    unsigned long long d_max_entry_size = 0;
+
+    std::atomic<unsigned long long> d_hits{0};
+    std::atomic<unsigned long long> d_misses{0};
+    std::atomic<unsigned long long> d_bytes_sent{0};
+
+    BESDap4ResponseCache();
+
+    friend class Dap4ResponseCacheTest;
+
+public:
+    static const std::string PATH_KEY;
+    static const std::string SIZE_KEY;
+    static const std::string PURGE_SIZE_KEY;
+    static const std::string MAX_ENTRY_SIZE_KEY;
+    static const std::string EXCLUDE_TYPES_KEY;
+
+    /**
+     * @brief Pass a response through to another stream and keep a copy of it
+     *
+     * Once the response grows larger than the limit, the copy is dropped; the
+     * response is still passed through.
+     */
+    class Capture : public std::streambuf {
+        std::streambuf *d_sink;
+        std::string d_copy;
+        unsigned long long d_limit;
+        bool d_overflowed = false;
+        std::function<void()> d_before_first_write;
+
+        void begin();
+        void keep(const char *s, std::streamsize n);
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+        int sync() override { return d_sink->pubsync(); }
+
+    public:
+        Capture(std::streambuf *sink, unsigned long long limit) : d_sink(sink), d_limit(limit) {}
+
+        /**
+         * @brief Call 'f' just before the first byte of the response is passed through
+         *
+         * What 'f' writes to the sink, e.g., the MIME headers, is not kept. If
+         * nothing is ever written, 'f' is not called.
+         */
+        void before_first_write(std::function<void()> f) { d_before_first_write = std::move(f); }
+
+        /// @return True if the response was larger than the limit
+        bool overflowed() const { return d_overflowed; }
+        /// @return The copy of the response; empty if overflowed() is true
+        const std::string &response() const { return d_copy; }
+    };
+
+    /** @brief Get the singleton BESDap4ResponseCache instance.
+     *
+     * Thread safe with C++-11 and greater.
+     */
+    static BESDap4ResponseCache *TheCache() {
+        static BESDap4ResponseCache instance;
+        return &instance;
+    }
+
+    BESDap4ResponseCache(const BESDap4ResponseCache &) = delete;
+    BESDap4ResponseCache &operator=(const BESDap4ResponseCache &) = delete;
+
+    ~BESDap4ResponseCache() override;
+
+    /// @return True if responses are cached
+    bool is_enabled() const { return d_enabled; }
+
+    /// @return Responses larger than this many bytes are not cached
+    unsigned long long get_max_entry_size() const { return d_max_entry_size; }
+
+    static bool is_cacheable_type(const std::string &container_type);
+
+    static std::string get_key(const std::vector<std::string> &datasets, const std::string &ce,
+                               const std::string &function, const std::string &settings);
+
+    /// @brief The key for a response made from one dataset
+    static std::string get_key(const std::string &dataset, const std::string &ce, const std::string &function,
+                               const std::string &settings) {
+        return get_key(std::vector<std::string>{dataset}, ce, function, settings);
+    }
+
+    bool send(const std::string &key, std::ostream &out, const std::function<void()> &before_response = nullptr);
+
+    bool put(const std::string &key, const std::string &response);
+
+    /// @return The number of responses sent from the cache
+    unsigned long long get_hits() const { return d_hits; }
+    /// @return The number of cacheable responses that were built
+    unsigned long long get_misses() const { return d_misses; }
+
+    void dump(std::ostream &strm) const override;
+};
+
+#endif // _bes_dap4_response_cache_h
@@ -0,0 +1,105 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+
+#include <libdap/Array.h>
+
+#include "BESDebug.h"
+
+#include "BESDapArraySlabReader.h"
+
+#define MODULE "dap"
+#define prolog std::string("BESDapArraySlabReader::").append(__func__).append("() - ")
+
+using namespace std;
+using namespace libdap;
+
+/**
+ * @brief Set up to read an Array in slabs.
+ *
+ * The number of rows in each slab is chosen so that a slab holds no more than
+ * max_slab_bytes of values, but a slab always holds at least one row.
+ *
+ * @param a The Array to read. Its data must not have been read.
+ * @param max_slab_bytes Memory budget for one slab; zero reads the whole Array
+ * in one slab.
+ */
+BESDapArraySlabReader::BESDapArraySlabReader(Array *a, uint64_t max_slab_bytes) : d_array(a)
+{
+    Array::Dim_iter outer = d_array->dim_begin();
+    d_start = d_array->dimension_start(outer, true);
+    d_stride = d_array->dimension_stride(outer, true);
+    d_stop = d_array->dimension_stop(outer, true);
+    d_rows = 1 + (d_stop - d_start) / d_stride;
+
+    uint64_t row_bytes = d_array->var()->width();
+    for (auto d = outer + 1; d != d_array->dim_end(); ++d)
+        row_bytes *= d_array->dimension_size(d, true);
+
+    d_rows_per_slab = d_rows;
+    if (max_slab_bytes > 0 && row_bytes > 0)
+        d_rows_per_slab = max<uint64_t>(1, min<uint64_t>(d_rows, max_slab_bytes / row_bytes));
+
+    BESDEBUG(MODULE, prolog << d_array->name() << " rows: " << d_rows << " rows_per_slab: " << d_rows_per_slab
+             << endl);
+}
+
+/**
+ * @brief Release the last slab and restore the Array's original constraint.
+ */
+BESDapArraySlabReader::~BESDapArraySlabReader()
+{
+    try {
+        d_array->clear_local_data();
+        d_array->add_constraint(d_array->dim_begin(), d_start, d_stride, d_stop);
+    }
+    catch (...) {
+        BESDEBUG(MODULE, prolog << "Failed to restore the constraint on " << d_array->name() << endl);
+    }
+}
+
+/**
+ * @brief Read the slab that begins at first_row.
+ *
+ * The values of the previous slab are released first. After this call the
+ * Array's value() methods return the values of this slab only.
+ *
+ * @param first_row Index of the first row, in the constrained outer dimension
+ * @return The number of rows read
+ */
+unsigned int BESDapArraySlabReader::read_slab(unsigned int first_row)
+{
+    unsigned int num_rows = min(d_rows_per_slab, d_rows - first_row);
+    int slab_start = d_start + static_cast<int>(first_row) * d_stride;
+    int slab_stop = slab_start + static_cast<int>(num_rows - 1) * d_stride;
+
+    d_array->clear_local_data();
+    d_array->add_constraint(d_array->dim_begin(), slab_start, d_stride, slab_stop);
+    d_array->read();
+    d_array->set_read_p(true);
+
+    return num_rows;
+}
@@ -0,0 +1,64 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _bes_dap_array_slab_reader_h
+#define _bes_dap_array_slab_reader_h
+
+#include <cstdint>
+
+namespace libdap {
+class Array;
+}
+
+/**
+ * @brief Read an Array one outer-dimension slab at a time
+ *
+ * Keeps the values held in memory under a fixed budget. The reader narrows
+ * the constraint on the outer dimension for each slab and restores the
+ * original constraint when it is destroyed. Used by the responses that
+ * stream Arrays left unread by dap_utils::intern_data_up_to().
+ */
+class BESDapArraySlabReader {
+    libdap::Array *d_array;
+    int d_start;
+    int d_stride;
+    int d_stop;
+    unsigned int d_rows;
+    unsigned int d_rows_per_slab;
+
+public:
+    BESDapArraySlabReader(libdap::Array *a, uint64_t max_slab_bytes);
+    ~BESDapArraySlabReader();
+
+    BESDapArraySlabReader(const BESDapArraySlabReader &) = delete;
+    BESDapArraySlabReader &operator=(const BESDapArraySlabReader &) = delete;
+
+    /// @return The number of rows (elements of the outer dimension) in the constrained Array
+    unsigned int rows() const { return d_rows; }
+    /// @return The number of rows read by each call to read_slab()
+    unsigned int rows_per_slab() const { return d_rows_per_slab; }
+
+    unsigned int read_slab(unsigned int first_row);
+};
+
+#endif // _bes_dap_array_slab_reader_h
@@ -32,6 +32,7 @@
 #include <sys/stat.h>
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -51,6 +52,14 @@
 #include <libdap/D4StreamMarshaller.h>
 #include <libdap/D4StreamUnMarshaller.h>
 
+#include <libdap/DMR.h>
+#include <libdap/D4Group.h>
+#include <libdap/D4BaseTypeFactory.h>
+#include <libdap/D4ParserSax2.h>
+#include <libdap/D4FunctionEvaluator.h>
+#include <libdap/ServerFunctionsList.h>
+#include <libdap/XMLWriter.h>
+
 #include <libdap/Sequence.h>   // We have to special-case these; see read_data_ddx()
 
 #include <libdap/debug.h>
@@ -64,6 +73,7 @@
 #include "BESDapFunctionResponseCache.h"
 #include "BESDapResponseBuilder.h"
 #include "BESInternalError.h"
+#include "BESSyntaxUserError.h"
 
 #include "BESUtil.h"
 #include "TheBESKeys.h"
@@ -398,27 +408,30 @@ BESDapFunctionResponseCache::get_or_cache_dataset(DDS *dds, const string &constr
 }
 
 /**
- * @brief Look for a cache hit; load a DDS and its associated data
+ * @brief Look for a cache hit; load a DDS or DMR and its associated data
  *
  * This private method compares the 'resource_id' value with the resource id
  * in the named cache file. If they match, then this cache file contains
- * the data we're after. In that case this code calls read_data_ddx() which
- * allocates a new DDS object and reads its data from the cache file. If
+ * the data we're after. In that case this code calls read_cached() which
+ * allocates a new DDS (or DMR) object and reads its data from the cache file. If
  * the two resource ids don't match, this method returns null.
  *
  * @param resourceId The resource id is a combination of the filename and the
  * function call part of the CE that built the cached response.
  * @param cache_file_name Value-result parameter: The basename of a cache
  * file that _may_ contain the correct response.
- * @return A pointer to a newly allocated DDS that contains data if the cache file
+ * @param read_cached Read the DDS or DMR and data that follow the resource id
+ * @return A pointer to a newly allocated DDS (or DMR) that contains data if the cache file
  * held the correct response, null otherwise.
  */
-DDS *
-BESDapFunctionResponseCache::load_from_cache(const string &resource_id, string &cache_file_name)
+template<typename T>
+T *
+BESDapFunctionResponseCache::find_in_cache(const string &resource_id, string &cache_file_name,
+    T *(BESDapFunctionResponseCache::*read_cached)(istream &))
 {
     BESDEBUG(DEBUG_KEY, __FUNCTION__ << " resource_id: " << resource_id << endl);
 
-    DDS *cached_dds = 0;   // nullptr
+    T *cached_dds = 0;   // nullptr
 
     unsigned long suffix_counter = 0;
     bool keep_looking = true;
@@ -464,7 +477,7 @@ BESDapFunctionResponseCache::load_from_cache(const string &resource_id, string &
                 BESDEBUG(DEBUG_KEY, "BESDapFunctionResponseCache::load_from_cache() - Cache Hit!" << endl);
 
                 // non-null value value for cached_dds will exit the loop
-                cached_dds = read_cached_data(cache_file_istream);
+                cached_dds = (this->*read_cached)(cache_file_istream);
             }
 
             unlock_and_close(cfname.str());
@@ -476,6 +489,12 @@ BESDapFunctionResponseCache::load_from_cache(const string &resource_id, string &
     return cached_dds;
 }
 
+DDS *
+BESDapFunctionResponseCache::load_from_cache(const string &resource_id, string &cache_file_name)
+{
+    return find_in_cache<DDS>(resource_id, cache_file_name, &BESDapFunctionResponseCache::read_cached_data);
+}
+
 /**
  * Read data from cache. Allocates a new DDS using the given factory.
  *
@@ -616,3 +635,209 @@ BESDapFunctionResponseCache::write_dataset_to_cache(DDS *dds, const string &reso
     return fdds;
 }
 
+
+/**
+ * The resource id of a DAP4 function result. The last modified time of the
+ * dataset is part of the id, so results computed from an older version of a
+ * dataset are not used. If the dataset is not a file, there is no time.
+ */
+string BESDapFunctionResponseCache::get_resource_id(DMR *dmr, const string &function)
+{
+    string resource_id = dmr->filename() + "#dap4:" + function;
+
+    struct stat buf;
+    if (stat(dmr->filename().c_str(), &buf) == 0) {
+        resource_id.append("#").append(to_string(buf.st_mtime));
+    }
+
+    return resource_id;
+}
+
+bool BESDapFunctionResponseCache::can_be_cached(DMR *dmr, const string &function)
+{
+    // The resource id is read back using a buffer of max_cacheable_ce_len chars
+    return get_resource_id(dmr, function).size() < max_cacheable_ce_len;
+}
+
+/**
+ * @brief Return a DMR loaded with data that can be serialized back to a client
+ *
+ * This is the DAP4 version of get_or_cache_dataset(DDS*, ...). Given a DMR
+ * and a DAP4 server function expression, either read the DMR that results
+ * from evaluating the function(s) from the cache or evaluate, cache and
+ * return the result.
+ *
+ * @param dmr Evaluate the function(s) using this DMR
+ * @param function The DAP4 server function expression
+ * @return A newly allocated DMR holding the function result. The caller
+ * must delete it.
+ */
+DMR *
+BESDapFunctionResponseCache::get_or_cache_dataset(DMR *dmr, const string &function)
+{
+    string resource_id = get_resource_id(dmr, function);
+
+    BESDEBUG(DEBUG_KEY, __FUNCTION__ << " resource_id: '" << resource_id << "'" << endl);
+
+    HASH_OBJ<string> str_hash;
+    stringstream hashed_id;
+    hashed_id << str_hash(resource_id);
+
+    string cache_file_name = BESFileLockingCache::get_cache_file_name(hashed_id.str(), false);
+
+    DMR *ret_dmr = nullptr;
+    if ((ret_dmr = load_dap4_from_cache(resource_id, cache_file_name))) {
+        BESDEBUG(DEBUG_KEY, __FUNCTION__ << " Data loaded from cache file: " << cache_file_name << endl);
+        ret_dmr->set_filename(dmr->filename());
+    }
+    else if ((ret_dmr = write_dap4_dataset_to_cache(dmr, resource_id, function, cache_file_name))) {
+        BESDEBUG(DEBUG_KEY, __FUNCTION__ << " Data written to cache file: " << cache_file_name << endl);
+    }
+    else if ((ret_dmr = load_dap4_from_cache(resource_id, cache_file_name))) {
+        BESDEBUG(DEBUG_KEY, __FUNCTION__ << " Data loaded from cache file (2nd try): " << cache_file_name << endl);
+        ret_dmr->set_filename(dmr->filename());
+    }
+
+    return ret_dmr;
+}
+
+DMR *
+BESDapFunctionResponseCache::load_dap4_from_cache(const string &resource_id, string &cache_file_name)
+{
+    return find_in_cache<DMR>(resource_id, cache_file_name, &BESDapFunctionResponseCache::read_cached_dap4_data);
+}
+
+// Mark every variable as read so that serialize() uses the values read from
+// the cache instead of calling read().
+static void set_read_p_grp(D4Group *grp)
+{
+    for (auto i = grp->var_begin(), e = grp->var_end(); i != e; ++i) {
+        (*i)->set_read_p(true);
+        (*i)->set_send_p(true);
+    }
+
+    for (auto g = grp->grp_begin(), e = grp->grp_end(); g != e; ++g) {
+        set_read_p_grp(*g);
+    }
+}
+
+/**
+ * Read a DAP4 function result from the cache. The stream is positioned just
+ * after the resource id.
+ */
+DMR *
+BESDapFunctionResponseCache::read_cached_dap4_data(istream &cached_data)
+{
+    BESDEBUG(DEBUG_KEY, __FUNCTION__ << " - BEGIN" << endl);
+
+    unsigned long long dmr_size = 0;
+    cached_data >> dmr_size;
+    cached_data.ignore(1);  // the newline
+
+    string dmr_doc(dmr_size, '\0');
+    cached_data.read(&dmr_doc[0], dmr_size);
+    if (!cached_data)
+        throw BESInternalError("Could not read the DMR of a cached DAP4 function result.", __FILE__, __LINE__);
+
+    D4BaseTypeFactory factory;
+    unique_ptr<DMR> fdmr(new DMR(&factory));
+
+    try {
+        D4ParserSax2 parser;
+        parser.intern(dmr_doc, fdmr.get());
+
+        // The cache is written on this host, so there is no need to twiddle bytes.
+        D4StreamUnMarshaller um(cached_data, false);
+        fdmr->root()->deserialize(um, *fdmr);
+    }
+    catch (Error &e) { // Catch the libdap::Error and throw BESInternalError
+        throw BESInternalError(e.get_error_message(), __FILE__, __LINE__);
+    }
+
+    set_read_p_grp(fdmr->root());
+
+    BESDEBUG(DEBUG_KEY, __FUNCTION__ << " - END." << endl);
+
+    fdmr->set_factory(nullptr);   // Make sure there is no left-over cruft in the returned DMR
+
+    return fdmr.release();
+}
+
+/**
+ * @brief Evaluate the DAP4 function(s) with the DMR and write and return the result
+ *
+ * This is the DAP4 version of write_dataset_to_cache().
+ *
+ * @param dmr Evaluate the function(s) in the context of this DMR.
+ * @param resource_id
+ * @param function The DAP4 server function expression
+ * @param cache_file_name Use this name to store the cached result
+ * @return The new DMR, or null if the cache file could not be made (e.g.,
+ * because another process is making it).
+ */
+DMR *
+BESDapFunctionResponseCache::write_dap4_dataset_to_cache(DMR *dmr, const string &resource_id, const string &function,
+    const string &cache_file_name)
+{
+    BESDEBUG(DEBUG_KEY, __FUNCTION__ << " BEGIN " << resource_id << ": " << function << ": " << cache_file_name << endl);
+
+    int fd;
+    if (!create_and_lock(cache_file_name, fd))
+        return nullptr;
+
+    ofstream cache_file_ostream(cache_file_name.c_str(), ios::out|ios::app|ios::binary);
+    if (!cache_file_ostream.is_open()) {
+        unlock_and_close(cache_file_name);
+        throw BESInternalError("Could not open '" + cache_file_name + "' to write cached response.", __FILE__, __LINE__);
+    }
+
+    D4BaseTypeFactory factory;
+    unique_ptr<DMR> fdmr(new DMR(&factory, "function_results"));
+
+    try {
+        D4FunctionEvaluator parser(dmr, ServerFunctionsList::TheList());
+        if (!parser.parse(function))
+            throw BESSyntaxUserError("Failed to parse the provided DAP4 server-side function expression: " + function,
+                __FILE__, __LINE__);
+        parser.eval(fdmr.get());
+
+        // Cache all of the result; the DAP4 CE is applied to it later.
+        fdmr->root()->set_send_p(true);
+        fdmr->use_checksums(false);
+
+        XMLWriter xml;
+        fdmr->print_dap4(xml, false);
+
+        cache_file_ostream << resource_id << endl;
+        cache_file_ostream << xml.get_doc_size() << endl;
+        cache_file_ostream.write(xml.get_doc(), xml.get_doc_size());
+
+        // As with the DAP2 code, make sure the marshaller is done before the stream is closed.
+        {
+            D4StreamMarshaller m(cache_file_ostream, true, false);
+            fdmr->root()->serialize(m, *fdmr, false);
+        }
+
+        cache_file_ostream.close();
+        if (!cache_file_ostream)
+            throw BESInternalError("Could not write the cached response '" + cache_file_name + "'.", __FILE__, __LINE__);
+
+        exclusive_to_shared_lock(fd);
+
+        unsigned long long size = update_cache_info(cache_file_name);
+        if (cache_too_big(size)) update_and_purge(cache_file_name);
+
+        unlock_and_close(cache_file_name);
+    }
+    catch (...) {
+        // Don't leave a partial response where the next request will find it.
+        cache_file_ostream.close();
+        unlink(cache_file_name.c_str());
+        unlock_and_close(cache_file_name);
+        throw;
+    }
+
+    fdmr->set_factory(nullptr);
+
+    return fdmr.release();
+}
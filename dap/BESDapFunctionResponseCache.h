@@ -35,6 +35,7 @@ class BESDapResponseBuilder;
 
 namespace libdap {
 class DDS;
+class DMR;
 class ConstraintEvaluator;
 class BaseTypeFactory;
 }
@@ -67,6 +68,13 @@ class BaseTypeFactory;
  * each cache entry contains the resource id as its first line so that the correct
  * entry can be identified.
  *
+ * @note DAP4 function results are cached too. Their entries hold the size of
+ * the DMR, the DMR and the data as written by D4StreamMarshaller (which uses
+ * native byte order) without checksums. The resource id of a DAP4 entry
+ * includes the last modified time of the dataset, so a modified dataset does
+ * not use an old result. Both kinds of entries share the cache and its
+ * size-based purge.
+ *
  * @author ndp, jhrg
  */
 
@@ -98,6 +106,19 @@ private:
 
     libdap::DDS *load_from_cache(const std::string &resource_id, std::string &cache_file_name);
 
+    std::string get_resource_id(libdap::DMR *dmr, const std::string &function);
+
+    libdap::DMR *read_cached_dap4_data(std::istream &cached_data);
+
+    libdap::DMR *write_dap4_dataset_to_cache(libdap::DMR *dmr, const std::string &resource_id,
+        const std::string &function, const std::string &cache_file_name);
+
+    libdap::DMR *load_dap4_from_cache(const std::string &resource_id, std::string &cache_file_name);
+
+    template<typename T>
+    T *find_in_cache(const std::string &resource_id, std::string &cache_file_name,
+        T *(BESDapFunctionResponseCache::*read_cached)(std::istream &));
+
     friend class FunctionResponseCacheTest;
     friend class StoredResultTest;
 
@@ -146,6 +167,11 @@ public:
 
     virtual bool can_be_cached(libdap::DDS *dds, const std::string &constraint);
 
+    // The DAP4 versions; 'function' is the DAP4 server function expression.
+    virtual libdap::DMR *get_or_cache_dataset(libdap::DMR *dmr, const std::string &function);
+
+    virtual bool can_be_cached(libdap::DMR *dmr, const std::string &function);
+
     static string get_cache_dir_from_config();
     static string get_cache_prefix_from_config();
     static unsigned long get_cache_size_from_config();
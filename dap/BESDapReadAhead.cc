@@ -0,0 +1,172 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <libdap/BaseType.h>
+
+#include "BESDebug.h"
+#include "BESTrace.h"
+#include "TheBESKeys.h"
+
+#include "BESDapReadAhead.h"
+
+#define MODULE "dap"
+#define prolog std::string("BESDapReadAhead::").append(__func__).append("() - ")
+
+using namespace std;
+using namespace libdap;
+
+const string BESDapReadAhead::DEPTH_KEY = "DAP.ReadAhead.depth";
+const string BESDapReadAhead::MAX_MEMORY_KEY = "DAP.ReadAhead.max_memory";
+const string BESDapReadAhead::CONTAINER_TYPES_KEY = "DAP.ReadAhead.container_types";
+
+/**
+ * @param vars The variables, in the order they will be serialized
+ * @param depth Read up to this many variables past the one being sent; zero
+ * turns off read ahead.
+ * @param max_bytes The variables read ahead must fit in this many bytes.
+ */
+BESDapReadAhead::BESDapReadAhead(vector<BaseType *> vars, unsigned int depth, unsigned long long max_bytes)
+    : d_vars(std::move(vars)), d_reads(d_vars.size()), d_bytes(d_vars.size(), 0), d_depth(depth),
+      d_max_bytes(max_bytes) {
+}
+
+/**
+ * If serialization stopped early (e.g., the client went away), wait for the
+ * reads still running since they use the variables. Their errors no longer
+ * matter.
+ */
+BESDapReadAhead::~BESDapReadAhead() {
+    for (auto &read: d_reads) {
+        if (!read.valid())
+            continue;
+        try {
+            read.get();
+        }
+        catch (...) {
+            BESDEBUG(MODULE, prolog << "Ignoring an error from a read that was not used." << endl);
+        }
+    }
+}
+
+/**
+ * @param container_type The type of the container that holds the variables
+ * @return How many variables to read ahead for this container type; zero if
+ * read ahead is off or the container type is not listed in
+ * DAP.ReadAhead.container_types.
+ */
+unsigned int BESDapReadAhead::get_depth(const string &container_type) {
+    const unsigned long depth = TheBESKeys::TheKeys()->read_ulong_key(DEPTH_KEY, 0);
+    if (depth == 0 || container_type.empty())
+        return 0;
+
+    bool found = false;
+    vector<string> types;
+    TheBESKeys::TheKeys()->get_values(CONTAINER_TYPES_KEY, types, found);
+    if (!found)
+        types.emplace_back("dmrpp");
+
+    if (find(types.begin(), types.end(), container_type) == types.end())
+        return 0;
+
+    return depth;
+}
+
+/// @return The memory budget for read ahead, in bytes
+unsigned long long BESDapReadAhead::get_max_bytes() {
+    return TheBESKeys::TheKeys()->read_ulong_key(MAX_MEMORY_KEY, 256) * 1024ULL * 1024ULL;
+}
+
+/**
+ * @brief Can this variable be read on another thread before it is serialized?
+ * @param var The variable
+ * @return True for simple types, arrays of simple types and Grids
+ */
+bool BESDapReadAhead::can_read_ahead(BaseType *var) {
+    if (var->is_simple_type() || var->type() == dods_grid_c)
+        return true;
+    return var->is_vector_type() && var->var() && !var->var()->is_constructor_type();
+}
+
+// The variables before 'i' have been serialized (and their data cleared), so
+// the memory they held can be used again.
+void BESDapReadAhead::release_before(vector<BaseType *>::size_type i) {
+    for (; d_released < i && d_released < d_vars.size(); ++d_released) {
+        d_bytes_in_use -= d_bytes[d_released];
+        d_bytes[d_released] = 0;
+    }
+}
+
+// Start reading the variables after 'i' that are within d_depth of it and
+// fit in the memory budget. The variables are read in order, so when one
+// does not fit, wait for the ones being sent to free some memory.
+void BESDapReadAhead::start_reads(vector<BaseType *>::size_type i) {
+    d_next = max(d_next, i + 1);
+    for (; d_next < d_vars.size() && d_next <= i + d_depth; ++d_next) {
+        BaseType *var = d_vars[d_next];
+        if (var->read_p() || !can_read_ahead(var))
+            continue;
+
+        const auto bytes = static_cast<unsigned long long>(var->width_ll(true));
+        if (bytes > d_max_bytes)
+            continue;   // it will never fit; read it when it is serialized
+        if (d_bytes_in_use + bytes > d_max_bytes)
+            break;
+
+        d_bytes[d_next] = bytes;
+        d_bytes_in_use += bytes;
+        BESDEBUG(MODULE, prolog << "Reading " << var->name() << " (" << bytes << " bytes) ahead" << endl);
+        d_reads[d_next] = std::async(std::launch::async, [var]() {
+            BES_TRACE_SPAN("dap", "read ahead " + var->name());
+            var->read();
+            var->set_read_p(true);
+        });
+    }
+}
+
+/**
+ * @brief Call before serializing a variable
+ *
+ * Wait until the variable has been read, if it was read ahead, and start
+ * reading the ones after it.
+ *
+ * @param i The index of the variable about to be serialized
+ * @exception Any exception thrown by the variable's read() method
+ */
+void BESDapReadAhead::wait(vector<BaseType *>::size_type i) {
+    if (d_depth == 0 || i >= d_vars.size())
+        return;
+
+    release_before(i);
+    start_reads(i);
+
+    if (d_reads[i].valid()) {
+        BES_TRACE_SPAN("dap", "wait for " + d_vars[i]->name());
+        d_reads[i].get();
+    }
+}
@@ -0,0 +1,96 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _bes_dap_read_ahead_h
+#define _bes_dap_read_ahead_h
+
+#include <future>
+#include <string>
+#include <vector>
+
+namespace libdap {
+class BaseType;
+}
+
+/**
+ * @brief Read the next few variables of a data response while the current one is sent
+ *
+ * The data responses read each projected variable and then write it to the
+ * client, so reading (i.e., the transfer and decompression of the data) and
+ * writing never overlap. Given the variables in the order they will be
+ * serialized, this reads up to 'depth' of the variables that follow the one
+ * being sent, each on its own thread. Serialization calls wait() before each
+ * variable; once a variable has been read, its serialize() method will not
+ * read it again.
+ *
+ * The variables read ahead must fit in max_bytes, as measured by
+ * BaseType::width_ll(true); a variable's memory is counted until the one
+ * after it is serialized. A variable larger than max_bytes is read when it
+ * is serialized, as it would be without this.
+ *
+ * Only simple types, arrays of simple types and Grids are read ahead;
+ * Sequences are read as they are serialized and other constructors may
+ * hold Sequences.
+ *
+ * @note The handler's read() methods must be thread safe. Read ahead is only
+ * used for the container types listed in DAP.ReadAhead.container_types.
+ */
+class BESDapReadAhead {
+    std::vector<libdap::BaseType *> d_vars;
+    std::vector<std::future<void>> d_reads;
+    std::vector<unsigned long long> d_bytes;    // bytes held by each variable read ahead
+
+    unsigned int d_depth;
+    unsigned long long d_max_bytes;
+    unsigned long long d_bytes_in_use = 0;
+
+    std::vector<libdap::BaseType *>::size_type d_next = 0;      // next variable to think about reading
+    std::vector<libdap::BaseType *>::size_type d_released = 0;  // variables before this have been sent
+
+    void release_before(std::vector<libdap::BaseType *>::size_type i);
+    void start_reads(std::vector<libdap::BaseType *>::size_type i);
+
+public:
+    static const std::string DEPTH_KEY;
+    static const std::string MAX_MEMORY_KEY;
+    static const std::string CONTAINER_TYPES_KEY;
+
+    BESDapReadAhead(std::vector<libdap::BaseType *> vars, unsigned int depth, unsigned long long max_bytes);
+
+    BESDapReadAhead(const BESDapReadAhead &) = delete;
+    BESDapReadAhead &operator=(const BESDapReadAhead &) = delete;
+
+    virtual ~BESDapReadAhead();
+
+    static unsigned int get_depth(const std::string &container_type);
+    static unsigned long long get_max_bytes();
+
+    static bool can_read_ahead(libdap::BaseType *var);
+
+    void wait(std::vector<libdap::BaseType *>::size_type i);
+
+    /// @return The number of bytes held by the variables read ahead
+    unsigned long long get_bytes_in_use() const { return d_bytes_in_use; }
+};
+
+#endif // _bes_dap_read_ahead_h
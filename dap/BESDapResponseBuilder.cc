@@ -49,6 +49,8 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
 
 #include <cstring>
 #include <ctime>
@@ -98,6 +100,9 @@
 #include "BESDapResponseBuilder.h"
 #include "BESContextManager.h"
 #include "BESDapFunctionResponseCache.h"
+#include "BESDap4ResponseCache.h"
+#include "BESDapReadAhead.h"
+#include "BESMemoryLedger.h"
 #include "BESStoredDapResultCache.h"
 
 
@@ -118,6 +123,7 @@
 #include "BESDebug.h"
 #include "BESLog.h"
 #include "BESStopWatch.h"
+#include "BESTrace.h"
 #include "DapFunctionUtils.h"
 #include "RequestServiceTimer.h"
 #include "BESContextManager.h"
@@ -697,21 +703,40 @@ void BESDapResponseBuilder::serialize_dap2_data_dds(ostream &out, DDS **dds, Con
 
     BESDEBUG(MODULE, prolog << "BEGIN" << endl);
 
+    // Send all variables in the current projection (send_p())
+    vector<BaseType *> vars;
+    for (auto i = (*dds)->var_begin(); i != (*dds)->var_end(); i++) {
+        if ((*i)->send_p())
+            vars.push_back(*i);
+    }
+
+    // Each variable is cleared once it is sent, so the response needs room
+    // for the largest one plus those read ahead. Without the room for read
+    // ahead, turn it off.
+    unsigned int read_ahead_depth = BESDapReadAhead::get_depth(d_container_type);
+    uint64_t largest_var = 0;
+    const uint64_t total = dap_utils::compute_memory_estimate(vars, largest_var);
+    const uint64_t read_ahead_bytes =
+            read_ahead_depth ? min<uint64_t>(BESDapReadAhead::get_max_bytes(), total - largest_var) : 0;
+    auto reservation = BESMemoryLedger::TheLedger()->admit(largest_var + read_ahead_bytes, largest_var);
+    if (reservation.is_streaming())
+        read_ahead_depth = 0;
+
     (*dds)->print_constrained(out);
     out << "Data:\n";
     out << flush;
 
     XDRStreamMarshaller m(out);
 
-    // Send all variables in the current projection (send_p())
-    for (auto i = (*dds)->var_begin(); i != (*dds)->var_end(); i++) {
-        if ((*i)->send_p()) {
-            RequestServiceTimer::TheTimer()->throw_if_timeout_expired(prolog +"ERROR: bes-timeout expired before transmit " + (*i)->name(), __FILE__, __LINE__);
-            (*i)->serialize(eval, **dds, m, ce_eval);
+    BESDapReadAhead read_ahead(vars, read_ahead_depth, BESDapReadAhead::get_max_bytes());
+    for (vector<BaseType *>::size_type i = 0; i < vars.size(); ++i) {
+        RequestServiceTimer::TheTimer()->throw_if_timeout_expired(prolog +"ERROR: bes-timeout expired before transmit " + vars[i]->name(), __FILE__, __LINE__);
+        read_ahead.wait(i);
+        BES_TRACE_SPAN("dap", "serialize " + vars[i]->name());
+        vars[i]->serialize(eval, **dds, m, ce_eval);
 #ifdef CLEAR_LOCAL_DATA
-            (*i)->clear_local_data();
+        vars[i]->clear_local_data();
 #endif
-        }
     }
 
     BESDEBUG(MODULE, prolog << "END" << endl);
@@ -885,6 +910,47 @@ BESDapResponseBuilder::intern_dap2_data(BESResponseObject *obj, BESDataHandlerIn
 
     BESDEBUG(MODULE, prolog << "BEGIN"<< endl);
 
+    DDS *dds = setup_dap2_intern_data(obj, dhi);
+    reserve_intern_memory(*dds);
+
+    auto bdds = dynamic_cast<BESDataDDSResponse *>(obj);
+    ConstraintEvaluator &eval = bdds->get_ce();
+
+    // Iterate through the variables in the DataDDS and read
+    // in the data if the variable has its send flag set.
+    for (auto i = dds->var_begin(), e = dds->var_end(); i != e; ++i) {
+        if ((*i)->send_p()) {
+            try {
+                BES_TRACE_SPAN("dap", "intern_data " + (*i)->name());
+                (*i)->intern_data(eval, *dds);
+            }
+            catch(std::exception &e) {
+                throw BESSyntaxUserError(string("Caught a C++ standard exception while working on '") + (*i)->name() + "' The error was: " + e.what(), __FILE__, __LINE__);
+            }
+        }
+    }
+
+    BESDEBUG(MODULE, prolog << "END"<< endl);
+
+    return dds;
+}
+
+/**
+ * Set up the ResponseObject (a DAP2 DDS) for a data response without reading
+ * any data. This does everything intern_dap2_data() does - add attributes,
+ * evaluate server functions and the constraint, check the response size - but
+ * stops short of calling intern_data() on the projected variables. Transmitters
+ * that stream their response (e.g., fileout_json) use this so they can read
+ * each variable, or part of a variable, just before it is written.
+ *
+ * @param obj The BESResponseObject. Holds the DDS for this request.
+ * @param dhi The BESDataHandlerInterface. Holds many parameters for this request.
+ * @return The DDS* with the constraint applied but no data read. The DDS is
+ * managed by the ResponseObject.
+ */
+libdap::DDS *
+BESDapResponseBuilder::setup_dap2_intern_data(BESResponseObject *obj, BESDataHandlerInterface &dhi)
+{
     dhi.first_container();
 
     auto bdds = dynamic_cast<BESDataDDSResponse *>(obj);
@@ -959,22 +1025,6 @@ BESDapResponseBuilder::intern_dap2_data(BESResponseObject *obj, BESDataHandlerIn
     dap_utils::throw_for_dap4_typed_vars_or_attrs(dds, __FILE__, __LINE__);
     dap_utils::throw_if_too_big(*dds, __FILE__, __LINE__);
 
-
-    // Iterate through the variables in the DataDDS and read
-    // in the data if the variable has its send flag set.
-    for (auto i = dds->var_begin(), e = dds->var_end(); i != e; ++i) {
-        if ((*i)->send_p()) {
-            try {
-                (*i)->intern_data(eval, *dds);
-            }
-            catch(std::exception &e) {
-                throw BESSyntaxUserError(string("Caught a C++ standard exception while working on '") + (*i)->name() + "' The error was: " + e.what(), __FILE__, __LINE__);
-            }
-        }
-    }
-
-    BESDEBUG(MODULE, prolog << "END"<< endl);
-
     return dds;
 }
 
@@ -1419,23 +1469,121 @@ void BESDapResponseBuilder::dap4_process_ce_for_intern_data(DMR &dmr)
     dap_utils::throw_if_too_big(dmr, __FILE__, __LINE__);
 }
 
+bool use_dap4_checksums() {
+    bool found_it = false;
+    string state = "unset";
+    state = BESContextManager::TheManager()->get_context(DAP4_CHECKSUMS_CONTEXT_KEY, found_it);
+    if (!found_it) {
+        state="false";
+    }
+    BESDEBUG(MODULE, prolog << DAP4_CHECKSUMS_CONTEXT_KEY << ": " << state << "\n");
+    return found_it && (BESUtil::lowercase(state) == "true");
+}
+
+/**
+ * @brief The DAP4 response cache key for this request
+ *
+ * Besides the datasets of all the request's containers and the CE and
+ * function expressions, the key holds the other things that change the bytes
+ * of the response.
+ *
+ * @return The key, or the empty string if the response should not be cached
+ */
+string BESDapResponseBuilder::get_dap4_response_cache_key(DMR &dmr) const
+{
+    // A stored result is answered with an async response, not the data.
+    if (!BESDap4ResponseCache::TheCache()->is_enabled() || !d_store_result.empty())
+        return "";
+
+    if (!BESDap4ResponseCache::is_cacheable_type(d_container_type))
+        return "";
+
+    vector<string> datasets{d_dataset};
+    for (const auto &container : d_other_containers) {
+        if (!BESDap4ResponseCache::is_cacheable_type(container.second))
+            return "";
+        datasets.push_back(container.first);
+    }
+
+    uint64_t max_response_size = 0;
+    uint64_t max_var_size = 0;
+    dap_utils::get_max_sizes_bytes(max_response_size, max_var_size);
+
+    ostringstream settings;
+    settings << "checksums=" << use_dap4_checksums() << ",xml_base=" << dmr.request_xml_base()
+             << ",utf8=" << dmr.get_utf8_xml_encoding() << ",max_response_size=" << max_response_size
+             << ",max_var_size=" << max_var_size;
+
+    return BESDap4ResponseCache::get_key(datasets, d_dap4ce, d_dap4function, settings.str());
+}
+
+/**
+ * @brief Send the DAP4 data response, using the DAP4 response cache if it is on
+ *
+ * On a miss, the response is copied to the cache as it is sent. The MIME
+ * headers are not cached since they hold the date.
+ */
 void BESDapResponseBuilder::send_dap4_data(ostream &out, DMR &dmr, bool with_mime_headers)
 {
-    // If a function was passed in with this request, evaluate it and use that DMR
-    // for the remainder of this request.
-    // TODO Add caching for these function invocations
-    if (!d_dap4function.empty()) {
-        D4BaseTypeFactory d4_factory;
-        DMR function_result(&d4_factory, "function_results");
+    string cache_key = get_dap4_response_cache_key(dmr);
+    if (cache_key.empty()) {
+        build_dap4_data(out, dmr, with_mime_headers);
+        return;
+    }
 
-        // Function modules load their functions onto this list. The list is
-        // part of libdap, not the BES.
-        if (!ServerFunctionsList::TheList()) {
-            stringstream msg;
-            msg << "The function expression could not be evaluated because ";
-            msg << "there are no server-side functions defined on this server.";
-            throw BESSyntaxUserError(msg.str(),__FILE__,__LINE__);
-        }
+    auto write_headers = [&]() {
+        if (with_mime_headers)
+            set_mime_binary(out, dap4_data, x_plain, last_modified_time(d_dataset), dmr.dap_version());
+    };
+
+    // The cache holds only the response body
+    auto cache = BESDap4ResponseCache::TheCache();
+    if (cache->send(cache_key, out, write_headers)) {
+        BESDEBUG(MODULE, prolog << "Sent the cached response for " << d_dataset << endl);
+        return;
+    }
+
+    // On a miss, the headers go out just before the body, as they do when the
+    // cache is off, so an error found before then is not sent after a 200 binary header.
+    BESDap4ResponseCache::Capture capture(out.rdbuf(), cache->get_max_entry_size());
+    capture.before_first_write(write_headers);
+    ostream capture_out(&capture);
+    build_dap4_data(capture_out, dmr, false);
+    capture_out.flush();
+
+    if (capture_out.good() && !capture.overflowed())
+        cache->put(cache_key, capture.response());
+}
+
+/**
+ * @brief Evaluate the DAP4 server function expression
+ *
+ * If the function response cache is configured, the result is read from, or
+ * written to, the cache.
+ *
+ * @param dmr Evaluate the function(s) using this DMR
+ * @return The DMR holding the function result; the caller must delete it
+ */
+DMR *BESDapResponseBuilder::evaluate_dap4_function(DMR &dmr)
+{
+    // Function modules load their functions onto this list. The list is
+    // part of libdap, not the BES.
+    if (!ServerFunctionsList::TheList()) {
+        stringstream msg;
+        msg << "The function expression could not be evaluated because ";
+        msg << "there are no server-side functions defined on this server.";
+        throw BESSyntaxUserError(msg.str(),__FILE__,__LINE__);
+    }
+
+    unique_ptr<DMR> function_result;
+
+    BESDapFunctionResponseCache *response_cache = BESDapFunctionResponseCache::get_instance();
+    if (response_cache && response_cache->can_be_cached(&dmr, d_dap4function))
+        function_result.reset(response_cache->get_or_cache_dataset(&dmr, d_dap4function));
+
+    if (!function_result) {
+        static D4BaseTypeFactory d4_factory;
+        function_result.reset(new DMR(&d4_factory, "function_results"));
 
         D4FunctionEvaluator parser(&dmr, ServerFunctionsList::TheList());
         bool parse_ok = parser.parse(d_dap4function);
@@ -1444,11 +1592,28 @@ void BESDapResponseBuilder::send_dap4_data(ostream &out, DMR &dmr, bool with_mim
             msg << "Failed to parse the provided DAP4 server-side function expression: " << d_dap4function;
             throw BESSyntaxUserError(msg.str(),__FILE__,__LINE__);
         }
-        parser.eval(&function_result);
+        parser.eval(function_result.get());
+    }
+
+    // Functions mark their results to be sent, and so does the cache when it
+    // writes or reads a result. The CE is applied to this DMR next and only
+    // ever sets send_p, so start with nothing selected; an empty CE selects
+    // everything. This way a cached result is sent just like a new one.
+    function_result->root()->set_send_p(false);
+
+    return function_result.release();
+}
+
+void BESDapResponseBuilder::build_dap4_data(ostream &out, DMR &dmr, bool with_mime_headers)
+{
+    // If a function was passed in with this request, evaluate it and use that DMR
+    // for the remainder of this request.
+    if (!d_dap4function.empty()) {
+        unique_ptr<DMR> function_result(evaluate_dap4_function(dmr));
 
         // Now use the results of running the functions for the remainder of the
         // send_data operation.
-        send_dap4_data_using_ce(out, function_result, with_mime_headers);
+        send_dap4_data_using_ce(out, *function_result, with_mime_headers);
     }
     else {
         send_dap4_data_using_ce(out, dmr, with_mime_headers);
@@ -1456,19 +1621,59 @@ void BESDapResponseBuilder::send_dap4_data(ostream &out, DMR &dmr, bool with_mim
 }
 
 
-bool use_dap4_checksums() {
-    bool found_it = false;
-    string state = "unset";
-    state = BESContextManager::TheManager()->get_context(DAP4_CHECKSUMS_CONTEXT_KEY, found_it);
-    if (!found_it) {
-        state="false";
+// The variables D4Group::serialize() sends, in the order it sends them: the
+// child groups' variables and then the group's own.
+static void get_dap4_serialized_vars(D4Group *grp, vector<BaseType *> &vars)
+{
+    for (auto g = grp->grp_begin(); g != grp->grp_end(); ++g)
+        get_dap4_serialized_vars(*g, vars);
+
+    for (auto v = grp->var_begin(); v != grp->var_end(); ++v) {
+        if ((*v)->send_p())
+            vars.push_back(*v);
+    }
+}
+
+/**
+ * @brief Serialize the DAP4 data one variable at a time
+ *
+ * This writes the same bytes as D4Group::serialize() for the root group,
+ * including the checksum that follows each top-level variable. Each variable's
+ * data are cleared once it has been sent so the memory can be used by the
+ * variables being read ahead, or by other requests.
+ *
+ * @param m Serialize using this marshaller
+ * @param dmr The DMR to serialize
+ * @param vars The variables to send, from get_dap4_serialized_vars()
+ * @param depth How many variables to read ahead; zero for none
+ */
+void BESDapResponseBuilder::serialize_dap4_vars(D4StreamMarshaller &m, DMR &dmr, const vector<BaseType *> &vars,
+                                                unsigned int depth)
+{
+    BESDapReadAhead read_ahead(vars, depth, BESDapReadAhead::get_max_bytes());
+    for (vector<BaseType *>::size_type i = 0; i < vars.size(); ++i) {
+        read_ahead.wait(i);
+        BES_TRACE_SPAN("dap", "serialize " + vars[i]->name());
+        m.reset_checksum();
+        vars[i]->serialize(m, dmr, !d_dap4ce.empty());
+        if (dmr.use_checksums())
+            m.put_checksum();
+#ifdef CLEAR_LOCAL_DATA
+        vars[i]->clear_local_data();
+#endif
     }
-    BESDEBUG(MODULE, prolog << DAP4_CHECKSUMS_CONTEXT_KEY << ": " << state << "\n");
-    return found_it && (BESUtil::lowercase(state) == "true");
 }
 
 /**
  * Serialize the DAP4 data response to the passed stream
+ *
+ * If DAP.ReadAhead.depth is set and the handler for this container type can
+ * read variables on several threads, the next variables are read while each
+ * one is sent.
+ *
+ * The memory the response needs is reserved with the BESMemoryLedger before
+ * anything is written. If the ledger only has room for the largest variable,
+ * the variables are sent one at a time and each is cleared once sent.
  */
 void BESDapResponseBuilder::serialize_dap4_data(std::ostream &out, libdap::DMR &dmr, bool with_mime_headers)
 {
@@ -1480,6 +1685,20 @@ void BESDapResponseBuilder::serialize_dap4_data(std::ostream &out, libdap::DMR &
     dmr.use_checksums(ucs);
     BESDEBUG(MODULE, prolog << "dmr.use_checksums(): " << (dmr.use_checksums()?"true":"false") << "\n");
 
+    // D4Group::serialize() holds all the variables' data until it is done;
+    // sending them one at a time needs room for the largest one plus those
+    // read ahead.
+    vector<BaseType *> vars;
+    get_dap4_serialized_vars(dmr.root(), vars);
+    unsigned int read_ahead_depth = BESDapReadAhead::get_depth(d_container_type);
+    uint64_t largest_var = 0;
+    const uint64_t total = dap_utils::compute_memory_estimate(vars, largest_var);
+    const uint64_t peak = read_ahead_depth
+            ? largest_var + min<uint64_t>(BESDapReadAhead::get_max_bytes(), total - largest_var) : total;
+    auto reservation = BESMemoryLedger::TheLedger()->admit(peak, largest_var);
+    if (reservation.is_streaming())
+        read_ahead_depth = 0;
+
     if (with_mime_headers) set_mime_binary(out, dap4_data, x_plain, last_modified_time(d_dataset), dmr.dap_version());
 
     BESDEBUG(MODULE, prolog << "dmr.request_xml_base(): \"" << dmr.request_xml_base() << "\""<< endl);
@@ -1504,10 +1723,16 @@ void BESDapResponseBuilder::serialize_dap4_data(std::ostream &out, libdap::DMR &
 
     // Write the data, chunked with checksums
     D4StreamMarshaller m(cos, true, dmr.use_checksums());
-    dmr.root()->serialize(m, dmr, !d_dap4ce.empty());
+    BES_TRACE_SPAN("dap", "serialize DAP4 data");
+    if (read_ahead_depth == 0 && !reservation.is_streaming()) {
+        dmr.root()->serialize(m, dmr, !d_dap4ce.empty());
 #ifdef CLEAR_LOCAL_DATA
-    dmr.root()->clear_local_data();
+        dmr.root()->clear_local_data();
 #endif
+    }
+    else {
+        serialize_dap4_vars(m, dmr, vars, read_ahead_depth);
+    }
     cos << flush;
 
     BESDEBUG(MODULE, prolog << "END" << endl);
@@ -1629,12 +1854,38 @@ BESDapResponseBuilder::intern_dap4_data(BESResponseObject *obj, BESDataHandlerIn
     BESDEBUG(MODULE , prolog << "BEGIN" << endl);
 
     unique_ptr<DMR> dmr = setup_dap4_intern_data(obj, dhi);
+    reserve_intern_memory(*dmr);
 
     intern_dap4_data_grp(dmr->root());
 
     return dmr.release();
 }
 
+/**
+ * @brief Reserve the memory the projected variables will hold once read
+ *
+ * The transmitters that use intern_dap2_data() or intern_dap4_data() keep
+ * all the data until they have written the response, so the response cannot
+ * be streamed; all of it is reserved with the BESMemoryLedger. The memory is
+ * returned when this builder is destroyed.
+ *
+ * @param dds The DDS with the constraint applied
+ */
+void BESDapResponseBuilder::reserve_intern_memory(DDS &dds)
+{
+    uint64_t largest_var = 0;
+    const uint64_t total = dap_utils::compute_memory_estimate(dds.variables(), largest_var);
+    d_intern_reservation = BESMemoryLedger::TheLedger()->admit(total, total);
+}
+
+/// @brief The DAP4 version of reserve_intern_memory(DDS &)
+void BESDapResponseBuilder::reserve_intern_memory(DMR &dmr)
+{
+    uint64_t largest_var = 0;
+    const uint64_t total = dap_utils::compute_memory_estimate(dmr.root(), largest_var);
+    d_intern_reservation = BESMemoryLedger::TheLedger()->admit(total, total);
+}
+
 libdap::DMR *
 BESDapResponseBuilder::process_dap4_dmr(BESResponseObject *obj, BESDataHandlerInterface &dhi)
 {
@@ -1671,27 +1922,7 @@ BESDapResponseBuilder::setup_dap4_intern_data(BESResponseObject *obj, BESDataHan
     set_store_result(dhi.data[STORE_RESULT]);
 
     if (!d_dap4function.empty()) {
-        D4BaseTypeFactory d4_factory;
-        unique_ptr<DMR> function_result(new DMR(&d4_factory, "function_results"));
-
-        // Function modules load their functions onto this list. The list is
-        // part of libdap, not the BES.
-        if (!ServerFunctionsList::TheList()) {
-            stringstream msg;
-            msg << "The function expression could not be evaluated because ";
-            msg << "there are no server-side functions defined on this server.";
-            throw BESSyntaxUserError(msg.str(),__FILE__,__LINE__);
-        }
-
-        D4FunctionEvaluator parser(dmr.get(), ServerFunctionsList::TheList());
-        bool parse_ok = parser.parse(d_dap4function);
-        if (!parse_ok){
-            stringstream msg;
-            msg << "Failed to parse the provided DAP4 server-side function expression: " << d_dap4function;
-            throw BESSyntaxUserError(msg.str(),__FILE__,__LINE__);
-        }
-
-        parser.eval(function_result.get());
+        unique_ptr<DMR> function_result(evaluate_dap4_function(*dmr));
 
         // Now use the results of running the functions for the remainder of the
         // send_data operation.
@@ -1711,6 +1942,7 @@ void BESDapResponseBuilder::intern_dap4_data_grp(libdap::D4Group* grp) {
         BESDEBUG(MODULE , "BESDapResponseBuilder::intern_dap4_data() - "<< (*i)->name() <<endl);
         if ((*i)->send_p()) {
             BESDEBUG(MODULE , "BESDapResponseBuilder::intern_dap4_data() Obtain data- "<< (*i)->name() <<endl);
+            BES_TRACE_SPAN("dap", "intern_data " + (*i)->name());
             (*i)->intern_data();
         }
     }
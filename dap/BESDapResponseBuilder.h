@@ -27,6 +27,10 @@
 
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
+
+#include "BESMemoryLedger.h"
 
 #define DAP_PROTOCOL_VERSION "3.2"
 
@@ -41,6 +45,8 @@ class BESResponseObject;
 class BRDRequestHandler;
 
 namespace libdap {
+class BaseType;
+
 class ConstraintEvaluator;
 
 class DDS;
@@ -50,6 +56,8 @@ class DAS;
 class DMR;
 
 class D4Group;
+
+class D4StreamMarshaller;
 }
 
 
@@ -86,14 +94,35 @@ protected:
      */
     std::string d_store_result;
 
+    /// The type of the container; used to decide if variables can be read ahead
+    std::string d_container_type;
+
+    /// The dataset and type of each of the request's other containers
+    std::vector<std::pair<std::string, std::string>> d_other_containers;
+
+    /// The memory held by the data intern_dap2_data() or intern_dap4_data() read
+    BESMemoryLedger::Reservation d_intern_reservation;
+
 #ifdef DAP2_STORED_RESULTS
     bool store_dap2_result(ostream &out, libdap::DDS &dds, libdap::ConstraintEvaluator &eval);
 #endif
 
     void send_dap4_data_using_ce(std::ostream &out, libdap::DMR &dmr, bool with_mime_headersr);
 
+    void build_dap4_data(std::ostream &out, libdap::DMR &dmr, bool with_mime_headers);
+
+    libdap::DMR *evaluate_dap4_function(libdap::DMR &dmr);
+
+    std::string get_dap4_response_cache_key(libdap::DMR &dmr) const;
+
+    void serialize_dap4_vars(libdap::D4StreamMarshaller &m, libdap::DMR &dmr,
+                             const std::vector<libdap::BaseType *> &vars, unsigned int depth);
+
     void intern_dap4_data_grp(libdap::D4Group *grp);
 
+    void reserve_intern_memory(libdap::DDS &dds);
+    void reserve_intern_memory(libdap::DMR &dmr);
+
 public:
 
     /** Make an empty instance. Use the set_*() methods to load with needed
@@ -133,6 +162,19 @@ public:
         d_btp_func_ce = _ce;
     }
 
+    virtual std::string get_container_type() const {
+        return d_container_type;
+    }
+
+    virtual void set_container_type(const std::string &_type) {
+        d_container_type = _type;
+    }
+
+    /// @brief Add one of the request's containers other than the first
+    virtual void add_other_container(const std::string &dataset, const std::string &container_type) {
+        d_other_containers.emplace_back(dataset, container_type);
+    }
+
     virtual std::string get_dataset_name() const;
 
     virtual void set_dataset_name(const std::string &_dataset);
@@ -159,6 +201,8 @@ public:
     // Added jhrg 9/1/16
     virtual libdap::DDS *intern_dap2_data(BESResponseObject *obj, BESDataHandlerInterface &dhi);
 
+    virtual libdap::DDS *setup_dap2_intern_data(BESResponseObject *obj, BESDataHandlerInterface &dhi);
+
     virtual libdap::DDS *process_dap2_dds(BESResponseObject *obj, BESDataHandlerInterface &dhi);
 
     // Add the handling of DMR objects, including the function to handle expression constraints.
@@ -203,6 +203,7 @@ private:
 
         BESDapResponseBuilder rb;
         rb.set_dataset_name(dds->filename());
+        if (dhi.container) rb.set_container_type(dhi.container->get_container_type());
         rb.set_ce(dhi.data[POST_CONSTRAINT]);
 
         rb.set_async_accepted(dhi.data[ASYNC]);
@@ -302,6 +303,14 @@ private:
 
         BESDapResponseBuilder rb;
         rb.set_dataset_name(dmr->filename());
+        if (dhi.container) {
+            rb.set_container_type(dhi.container->get_container_type());
+
+            // The response cache key must cover every file the DMR was built from.
+            for (dhi.next_container(); dhi.container; dhi.next_container())
+                rb.add_other_container(dhi.container->get_real_name(), dhi.container->get_container_type());
+            dhi.first_container();
+        }
 
         rb.set_dap4ce(dhi.data[DAP4_CONSTRAINT]);
         rb.set_dap4function(dhi.data[DAP4_FUNCTION]);
@@ -0,0 +1,94 @@
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef BES_CHUNK_STATISTICS_H
+#define BES_CHUNK_STATISTICS_H
+
+#include <vector>
+
+namespace bes {
+
+/**
+ * @brief Summary of the values stored in one chunk of an Array
+ *
+ * The statistics cover only the elements of the chunk that are inside the
+ * Array (edge chunks may extend past the end of a dimension). Values equal
+ * to the variable's fill value are counted but are not included in the
+ * min, max or monotonic values.
+ */
+struct ChunkStatistics {
+    /// Index of the chunk's first element in the Array, one per dimension
+    std::vector<unsigned long long> position;
+
+    /// True if the chunk holds at least one value that is not the fill value
+    bool has_values = false;
+    double min_value = 0.0;
+    double max_value = 0.0;
+
+    /// Number of elements equal to the fill value
+    unsigned long long fill_count = 0;
+
+    /// False if the (non-fill) values, in row-major order, change direction
+    bool monotonic = true;
+
+    /// True if the chunk holds NaN values that are not the fill value
+    bool has_nan = false;
+};
+
+/**
+ * @brief Interface for Arrays that know the statistics of their chunks
+ *
+ * A handler whose Array type can describe its stored values without
+ * reading them (e.g., the DMR++ handler when build_dmrpp recorded the
+ * statistics) implements this. Server functions use dynamic_cast to
+ * test for it and fall back to reading the data when it is not present
+ * or get_chunk_statistics() returns false.
+ *
+ * @note This is header-only so that modules (and their unit tests) do not
+ * need to link with the dap module to use it.
+ */
+class ChunkStatisticsSource {
+public:
+    virtual ~ChunkStatisticsSource() = default;
+
+    /**
+     * @brief Get the statistics for every chunk of the Array
+     *
+     * @param chunk_shape Value-result; the size of a chunk in each dimension
+     * @param stats Value-result; one entry for each chunk that holds data.
+     * Chunks that are in the Array but not listed hold only the fill value.
+     * @return True if statistics are available for all of the listed chunks,
+     * false otherwise.
+     */
+    virtual bool get_chunk_statistics(std::vector<unsigned long long> &chunk_shape,
+                                      std::vector<ChunkStatistics> &stats) const = 0;
+
+    /**
+     * @brief Get the fill value as a double
+     *
+     * @param fill_value Value-result
+     * @return True if the variable has a fill value, false otherwise.
+     */
+    virtual bool get_fill_value_as_double(double &fill_value) const = 0;
+};
+
+} // namespace bes
+
+#endif // BES_CHUNK_STATISTICS_H
@@ -28,6 +28,7 @@
 #include <sstream>
 #include <unordered_map>
 #include <cmath>
+#include <algorithm>
 
 #include <libdap/DDS.h>
 #include <libdap/DMR.h>
@@ -35,6 +36,7 @@
 #include <libdap/Vector.h>
 #include <libdap/Array.h>
 #include <libdap/Constructor.h>
+#include <libdap/ConstraintEvaluator.h>
 #include <libdap/XMLWriter.h>
 
 #include "TheBESKeys.h"
@@ -418,6 +420,86 @@ uint64_t compute_response_size_and_inv_big_vars(
     return compute_response_size_and_inv_big_vars(dmr.root(), max_var_size,too_big);
 }
 
+/**
+ * @brief Estimate the memory needed to hold the data of some variables
+ *
+ * The estimate is the sum of the variables' constrained sizes, as computed
+ * for the response size limits. It is used to reserve memory with the
+ * BESMemoryLedger before the variables are read.
+ *
+ * @param vars The variables to be sent; ones not marked to be sent count as zero.
+ * @param largest_var Value-result parameter; the size, in bytes, of the
+ * largest of the variables. This is what a response that releases each
+ * variable once it has been sent needs.
+ * @return The size, in bytes, of all the variables.
+ */
+uint64_t compute_memory_estimate(const std::vector<libdap::BaseType *> &vars, uint64_t &largest_var)
+{
+    std::vector<std::string> unused;
+    uint64_t total = 0;
+    largest_var = 0;
+    for (auto var: vars) {
+        const uint64_t size = crsaibv_process_variable(var, 0, unused);
+        largest_var = std::max(largest_var, size);
+        total += size;
+    }
+    return total;
+}
+
+/**
+ * @brief Estimate the memory needed to hold the data of the variables in a group and its children
+ *
+ * @param grp The group; only the variables marked to be sent count.
+ * @param largest_var Value-result parameter; the size, in bytes, of the
+ * largest variable in any of the groups.
+ * @return The size, in bytes, of all the variables.
+ */
+uint64_t compute_memory_estimate(const libdap::D4Group *grp, uint64_t &largest_var)
+{
+    uint64_t total = compute_memory_estimate(grp->variables(), largest_var);
+    for (const auto child_grp: grp->groups()) {
+        uint64_t largest_in_child = 0;
+        total += compute_memory_estimate(child_grp, largest_in_child);
+        largest_var = std::max(largest_var, largest_in_child);
+    }
+    return total;
+}
+
+/**
+ * @brief Estimate the memory needed to read all of some variables, whatever the constraint
+ *
+ * Server functions read their arguments before the rest of the constraint
+ * is applied, so this is the estimate used for a request with functions.
+ *
+ * @param vars The variables; whether they are marked to be sent does not matter.
+ * @param largest_var Value-result parameter; the size, in bytes, of the
+ * largest of the variables.
+ * @return The size, in bytes, of all the variables.
+ */
+uint64_t compute_unconstrained_memory_estimate(const std::vector<libdap::BaseType *> &vars, uint64_t &largest_var)
+{
+    uint64_t total = 0;
+    largest_var = 0;
+    for (auto var: vars) {
+        const uint64_t size = var->width(false);
+        largest_var = std::max(largest_var, size);
+        total += size;
+    }
+    return total;
+}
+
+/// @brief The group version of compute_unconstrained_memory_estimate(); includes the child groups
+uint64_t compute_unconstrained_memory_estimate(const libdap::D4Group *grp, uint64_t &largest_var)
+{
+    uint64_t total = compute_unconstrained_memory_estimate(grp->variables(), largest_var);
+    for (const auto child_grp: grp->groups()) {
+        uint64_t largest_in_child = 0;
+        total += compute_unconstrained_memory_estimate(child_grp, largest_in_child);
+        largest_var = std::max(largest_var, largest_in_child);
+    }
+    return total;
+}
+
 /**
  * @brief Assesses the provided DDS to identify a set of variables whose size is larger than the provided max_var_size and return total response size.
  *
@@ -697,6 +779,111 @@ void throw_if_too_big(const libdap::DDS &dds, const std::string &file, const uns
     }
 }
 
+/**
+ * @brief Should the read of this variable be left to the caller?
+ *
+ * Only Arrays of the DAP2 numeric types can be read in pieces by the callers
+ * of intern_data_up_to(). Arrays of strings are always read since their size
+ * in memory cannot be bounded by the width of their elements; Arrays of the
+ * DAP4-only types (Int8, Int64, UInt64, ...) are read so the callers report
+ * them as they do when streaming is off.
+ *
+ * @param var The variable
+ * @param max_var_size Arrays larger than this many bytes are deferred. Zero means never.
+ * @return True if the variable should not be read now.
+ */
+static bool defer_intern_data(BaseType *var, const uint64_t max_var_size)
+{
+    if (max_var_size == 0 || var->type() != dods_array_c)
+        return false;
+
+    switch (var->var()->type()) {
+    case dods_byte_c:
+    case dods_int16_c:
+    case dods_uint16_c:
+    case dods_int32_c:
+    case dods_uint32_c:
+    case dods_float32_c:
+    case dods_float64_c:
+        return static_cast<uint64_t>(var->width_ll(true)) > max_var_size;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Read the data for var unless it is an Array too big to hold in memory.
+ *
+ * Constructors that are too big are descended so that their small members are
+ * read and their big Array members are deferred. Sequences are always read
+ * whole since their values can only be read row by row.
+ *
+ * @param var The variable
+ * @param eval The constraint evaluator for DAP2; nullptr for DAP4
+ * @param dds The DDS for DAP2; nullptr for DAP4
+ * @param max_var_size Size threshold in bytes
+ */
+static void intern_variable_up_to(BaseType *var, ConstraintEvaluator *eval, DDS *dds, const uint64_t max_var_size)
+{
+    if (!var->send_p() || defer_intern_data(var, max_var_size)) {
+        BESDEBUG(MODULE_VERBOSE, prolog << "Not reading " << var->FQN() << endl);
+        return;
+    }
+
+    if (max_var_size > 0 && var->is_constructor_type() && var->type() != dods_sequence_c
+        && static_cast<uint64_t>(var->width_ll(true)) > max_var_size) {
+        for (auto child: dynamic_cast<Constructor *>(var)->variables()) {
+            intern_variable_up_to(child, eval, dds, max_var_size);
+        }
+        return;
+    }
 
+    if (eval)
+        var->intern_data(*eval, *dds);
+    else
+        var->intern_data();
+}
+
+/**
+ * @brief Read the projected variables of a DAP2 DDS, leaving out the big Arrays.
+ *
+ * This is the bounded-memory counterpart of the loop at the end of
+ * BESDapResponseBuilder::intern_dap2_data(). Every projected variable is read
+ * except Arrays of atomic types whose constrained size is larger than
+ * max_var_size. Those are left with read_p() false so that the caller can
+ * read them in pieces as it writes the response.
+ *
+ * @param dds The DDS, with the constraint already applied
+ * @param eval The constraint evaluator used with dds
+ * @param max_var_size Size threshold in bytes; zero reads everything.
+ */
+void intern_data_up_to(libdap::DDS &dds, libdap::ConstraintEvaluator &eval, const uint64_t max_var_size)
+{
+    BES_STOPWATCH_START(MODULE, prolog + "DDS");
+
+    for (auto var: dds.variables()) {
+        intern_variable_up_to(var, &eval, &dds, max_var_size);
+    }
+}
+
+/**
+ * @brief Read the projected variables of a DAP4 Group, leaving out the big Arrays.
+ *
+ * @param grp The group, with the constraint already applied. Child groups are
+ * processed too.
+ * @param max_var_size Size threshold in bytes; zero reads everything.
+ * @see intern_data_up_to(libdap::DDS &, libdap::ConstraintEvaluator &, uint64_t)
+ */
+void intern_data_up_to(libdap::D4Group *grp, const uint64_t max_var_size)
+{
+    for (auto var: grp->variables()) {
+        intern_variable_up_to(var, nullptr, nullptr, max_var_size);
+    }
+
+    for (auto child_grp: grp->groups()) {
+        intern_data_up_to(child_grp, max_var_size);
+    }
+}
 
 }   // namespace dap_utils
@@ -36,6 +36,8 @@
 namespace libdap {
 class DDS;
 class DMR;
+class D4Group;
+class ConstraintEvaluator;
 }
 
 namespace dap_utils {
@@ -52,9 +54,17 @@ uint64_t compute_response_size_and_inv_big_vars(const libdap::Constructor *ctr,
 uint64_t compute_response_size_and_inv_big_vars(const libdap::D4Group *grp, uint64_t max_var_size, std::vector<std::string> &too_big);
 uint64_t compute_response_size_and_inv_big_vars(libdap::DMR &dmr, uint64_t max_var_size, std::vector<std::string> &too_big);
 
+uint64_t compute_memory_estimate(const std::vector<libdap::BaseType *> &vars, uint64_t &largest_var);
+uint64_t compute_memory_estimate(const libdap::D4Group *grp, uint64_t &largest_var);
+uint64_t compute_unconstrained_memory_estimate(const std::vector<libdap::BaseType *> &vars, uint64_t &largest_var);
+uint64_t compute_unconstrained_memory_estimate(const libdap::D4Group *grp, uint64_t &largest_var);
+
 void get_max_sizes_bytes(uint64_t &max_response_size_bytes, uint64_t &max_var_size_bytes,  bool is_dap2=false);
 
 void throw_if_too_big(libdap::DMR &dmr, const std::string &file, unsigned int line);
 void throw_if_too_big(const libdap::DDS &dds, const std::string &file, unsigned int line);
+
+void intern_data_up_to(libdap::DDS &dds, libdap::ConstraintEvaluator &eval, uint64_t max_var_size);
+void intern_data_up_to(libdap::D4Group *grp, uint64_t max_var_size);
 }
 #endif //BES_DAPUTILS_H
@@ -53,6 +53,7 @@
 #include "TheBESKeys.h"
 #include "BESUtil.h"
 #include "BESLog.h"
+#include "BESMetrics.h"
 #include "BESContextManager.h"
 #include "BESDebug.h"
 #include "BESRequestHandler.h"
@@ -759,6 +760,9 @@ GlobalMetadataStore::get_read_lock_helper(const string &name, const string &suff
         hit_or_miss = "hit";
     }
     INFO_LOG(prolog + "MDS Cache " + hit_or_miss + " for '" + name + "' and response " + object_name);
+    BESMetrics::TheMetrics()->add("bes_cache_lookups_total", 1,
+                                  BESMetrics::label("cache", "mds") + "," + BESMetrics::label("object", object_name) +
+                                      "," + BESMetrics::label("result", hit_or_miss));
 
     return lock;
  }
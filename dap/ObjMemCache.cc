@@ -34,6 +34,8 @@
 #include <libdap/DapObj.h>
 #include <libdap/InternalErr.h>
 
+#include "BESMetrics.h"
+
 #include "ObjMemCache.h"
 
 // using namespace bes {
@@ -135,6 +137,10 @@ DapObj *ObjMemCache::get(const string &key)
         index.insert(index_pair_t(key, d_age));
     }
 
+    static const string hit = BESMetrics::label("cache", "obj_mem") + "," + BESMetrics::label("result", "hit");
+    static const string miss = BESMetrics::label("cache", "obj_mem") + "," + BESMetrics::label("result", "miss");
+    BESMetrics::TheMetrics()->add("bes_cache_lookups_total", 1, cached_obj ? hit : miss);
+
     return cached_obj;
 }
 
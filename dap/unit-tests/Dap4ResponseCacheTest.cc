@@ -0,0 +1,239 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "test_config.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BESUtil.h"
+#include "TheBESKeys.h"
+#include "BESDap4ResponseCache.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+
+#define prolog std::string("Dap4ResponseCacheTest::").append(__func__).append("() - ")
+
+class Dap4ResponseCacheTest : public CppUnit::TestFixture {
+    const string d_cache_dir = string(TEST_BUILD_DIR) + "/dap4_response_cache";
+    const string d_dataset = string(TEST_BUILD_DIR) + "/dap4_response_cache_dataset";
+
+    unique_ptr<BESDap4ResponseCache> make_cache(const string &max_entry_mb = "1") {
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::PATH_KEY, d_cache_dir);
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::MAX_ENTRY_SIZE_KEY, max_entry_mb);
+        return unique_ptr<BESDap4ResponseCache>(new BESDap4ResponseCache());
+    }
+
+    void write_dataset(const string &content) {
+        ofstream ofs(d_dataset, ios::binary | ios::trunc);
+        ofs << content;
+    }
+
+public:
+    void setUp() override {
+        TheBESKeys::TheKeys()->set_key("BES.LogName", "./bes.log");
+        BESUtil::mkdir_p(d_cache_dir, 0775);
+        write_dataset("data");
+    }
+
+    void tearDown() override {
+        string cmd = "rm -rf " + d_cache_dir + " " + d_dataset;
+        CPPUNIT_ASSERT(system(cmd.c_str()) == 0);
+    }
+
+    void disabled_test() {
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::PATH_KEY, "");
+        unique_ptr<BESDap4ResponseCache> cache(new BESDap4ResponseCache());
+        CPPUNIT_ASSERT(!cache->is_enabled());
+
+        string key = BESDap4ResponseCache::get_key(d_dataset, "x", "", "");
+        CPPUNIT_ASSERT(!cache->put(key, "response"));
+        ostringstream oss;
+        CPPUNIT_ASSERT(!cache->send(key, oss));
+        CPPUNIT_ASSERT(oss.str().empty());
+    }
+
+    void key_test() {
+        string key = BESDap4ResponseCache::get_key(d_dataset, "x", "", "checksums=0");
+        CPPUNIT_ASSERT(!key.empty());
+        CPPUNIT_ASSERT_EQUAL(key, BESDap4ResponseCache::get_key(d_dataset, "x", "", "checksums=0"));
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(d_dataset, "y", "", "checksums=0"));
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(d_dataset, "x", "f()", "checksums=0"));
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(d_dataset, "x", "", "checksums=1"));
+
+        // Only files can be validated
+        CPPUNIT_ASSERT(BESDap4ResponseCache::get_key("https://example.com/granule.h5", "x", "", "").empty());
+        CPPUNIT_ASSERT(BESDap4ResponseCache::get_key(TEST_BUILD_DIR, "x", "", "").empty());
+    }
+
+    // A response made from several files is keyed by all of them
+    void several_datasets_test() {
+        const string other = d_dataset + "_other";
+        {
+            ofstream ofs(other, ios::binary | ios::trunc);
+            ofs << "member";
+        }
+
+        string key = BESDap4ResponseCache::get_key(vector<string>{d_dataset, other}, "x", "", "");
+        CPPUNIT_ASSERT(!key.empty());
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(d_dataset, "x", "", ""));
+
+        struct timeval times[2] = {{1000, 0}, {1000, 0}};
+        CPPUNIT_ASSERT(utimes(other.c_str(), times) == 0);
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(vector<string>{d_dataset, other}, "x", "", ""));
+
+        // All must be files
+        CPPUNIT_ASSERT(
+            BESDap4ResponseCache::get_key(vector<string>{d_dataset, "https://example.com/granule.h5"}, "x", "", "")
+                .empty());
+        CPPUNIT_ASSERT(BESDap4ResponseCache::get_key(vector<string>{}, "x", "", "").empty());
+
+        unlink(other.c_str());
+    }
+
+    void cacheable_type_test() {
+        CPPUNIT_ASSERT(BESDap4ResponseCache::is_cacheable_type("dmrpp"));
+        CPPUNIT_ASSERT(BESDap4ResponseCache::is_cacheable_type(""));
+        CPPUNIT_ASSERT(!BESDap4ResponseCache::is_cacheable_type("ncml"));
+
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::EXCLUDE_TYPES_KEY, "nc");
+        CPPUNIT_ASSERT(BESDap4ResponseCache::is_cacheable_type("ncml"));
+        CPPUNIT_ASSERT(!BESDap4ResponseCache::is_cacheable_type("nc"));
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::EXCLUDE_TYPES_KEY, "ncml");
+    }
+
+    // A new last-modified time means a new key
+    void modified_test() {
+        string key = BESDap4ResponseCache::get_key(d_dataset, "x", "", "");
+
+        struct timeval times[2] = {{1000, 0}, {1000, 0}};
+        CPPUNIT_ASSERT(utimes(d_dataset.c_str(), times) == 0);
+        CPPUNIT_ASSERT(key != BESDap4ResponseCache::get_key(d_dataset, "x", "", ""));
+    }
+
+    void put_send_test() {
+        auto cache = make_cache();
+        CPPUNIT_ASSERT(cache->is_enabled());
+
+        string key = BESDap4ResponseCache::get_key(d_dataset, "x", "", "");
+        ostringstream miss;
+        CPPUNIT_ASSERT(!cache->send(key, miss, [&miss]() { miss << "headers\r\n"; }));
+        CPPUNIT_ASSERT(miss.str().empty());
+
+        string response("<Dataset/>\r\n\0\1\2\3", 16);
+        CPPUNIT_ASSERT(cache->put(key, response));
+        // Another process cached it first
+        CPPUNIT_ASSERT(!cache->put(key, response));
+
+        ostringstream hit;
+        CPPUNIT_ASSERT(cache->send(key, hit, [&hit]() { hit << "headers\r\n"; }));
+        CPPUNIT_ASSERT_EQUAL(string("headers\r\n") + response, hit.str());
+        CPPUNIT_ASSERT_EQUAL(1ULL, cache->get_hits());
+        CPPUNIT_ASSERT_EQUAL(1ULL, cache->get_misses());
+    }
+
+    void max_entry_size_test() {
+        auto cache = make_cache("1");
+        string key = BESDap4ResponseCache::get_key(d_dataset, "x", "", "");
+        CPPUNIT_ASSERT(!cache->put(key, string(1024 * 1024 + 1, 'x')));
+        CPPUNIT_ASSERT(!cache->put(key, ""));
+        ostringstream oss;
+        CPPUNIT_ASSERT(!cache->send(key, oss));
+    }
+
+    void capture_test() {
+        ostringstream sink;
+        BESDap4ResponseCache::Capture capture(sink.rdbuf(), 10);
+        ostream out(&capture);
+
+        out << "abc" << 'd';
+        out.write("efg", 3);
+        out.flush();
+        CPPUNIT_ASSERT(out.good());
+        CPPUNIT_ASSERT_EQUAL(string("abcdefg"), sink.str());
+        CPPUNIT_ASSERT_EQUAL(string("abcdefg"), capture.response());
+        CPPUNIT_ASSERT(!capture.overflowed());
+
+        // Past the limit the response still goes through but the copy is dropped
+        out << "hijkl";
+        CPPUNIT_ASSERT_EQUAL(string("abcdefghijkl"), sink.str());
+        CPPUNIT_ASSERT(capture.overflowed());
+        CPPUNIT_ASSERT(capture.response().empty());
+    }
+
+    // The headers go out just before the body, and are not kept
+    void capture_headers_test() {
+        ostringstream sink;
+        {
+            BESDap4ResponseCache::Capture capture(sink.rdbuf(), 10);
+            capture.before_first_write([&sink]() { sink << "headers\r\n"; });
+            ostream out(&capture);
+            out.flush();
+        }
+        CPPUNIT_ASSERT(sink.str().empty());     // nothing was written, e.g., the CE did not parse
+
+        BESDap4ResponseCache::Capture capture(sink.rdbuf(), 10);
+        capture.before_first_write([&sink]() { sink << "headers\r\n"; });
+        ostream out(&capture);
+        out << "abc";
+        out.write("def", 3);
+        out.flush();
+        CPPUNIT_ASSERT_EQUAL(string("headers\r\nabcdef"), sink.str());
+        CPPUNIT_ASSERT_EQUAL(string("abcdef"), capture.response());
+    }
+
+    CPPUNIT_TEST_SUITE(Dap4ResponseCacheTest);
+
+    CPPUNIT_TEST(disabled_test);
+    CPPUNIT_TEST(key_test);
+    CPPUNIT_TEST(modified_test);
+    CPPUNIT_TEST(several_datasets_test);
+    CPPUNIT_TEST(cacheable_type_test);
+    CPPUNIT_TEST(put_send_test);
+    CPPUNIT_TEST(max_entry_size_test);
+    CPPUNIT_TEST(capture_test);
+    CPPUNIT_TEST(capture_headers_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Dap4ResponseCacheTest);
+
+int main(int argc, char *argv[]) {
+    return bes_run_tests<Dap4ResponseCacheTest>(argc, argv, "cerr,dap4_response_cache") ? 0 : 1;
+}
@@ -441,6 +441,34 @@ public:
     }
 
 
+    void memory_estimate_test() {
+        D4BaseTypeFactory d_d4f;
+        D4ParserSax2 dp;
+        auto d_test_dmr = mk_dmr_from_file("input-files/test_01.dmr", dp, &d_d4f);
+        d_test_dmr->root()->set_send_p(true);
+
+        vector<BaseType *> vars(d_test_dmr->root()->var_begin(), d_test_dmr->root()->var_end());
+        std::vector<std::string> too_big;
+        uint64_t response_size = dap_utils::compute_response_size_and_inv_big_vars(*d_test_dmr, 0, too_big);
+
+        uint64_t largest_var = 0;
+        uint64_t estimate = dap_utils::compute_memory_estimate(vars, largest_var);
+        DBG(cerr << prolog << "estimate: " << estimate << ", largest_var: " << largest_var << endl);
+        CPPUNIT_ASSERT_EQUAL(response_size, estimate);
+        CPPUNIT_ASSERT(largest_var > 0 && largest_var <= estimate);
+
+        // Variables not marked to be sent do not count
+        vars.front()->set_send_p(false);
+        CPPUNIT_ASSERT(dap_utils::compute_memory_estimate(vars, largest_var) < estimate);
+
+        // ...but they do when the constraint is ignored
+        uint64_t largest_input = 0;
+        const uint64_t input = dap_utils::compute_unconstrained_memory_estimate(vars, largest_input);
+        CPPUNIT_ASSERT(largest_input > 0 && largest_input <= input);
+        vars.front()->set_send_p(true);
+        CPPUNIT_ASSERT_EQUAL(input, dap_utils::compute_unconstrained_memory_estimate(vars, largest_input));
+    }
+
     void dmrpp_var_too_big_test() {
 
         D4BaseTypeFactory d_d4f;
@@ -657,6 +685,7 @@ public:
     CPPUNIT_TEST(throw_if_dds_response_too_big_test);
 
     CPPUNIT_TEST(var_too_big_test);
+    CPPUNIT_TEST(memory_estimate_test);
     CPPUNIT_TEST(throw_if_dmr_too_big_test_rv);
     CPPUNIT_TEST(throw_if_dmr_too_big_test_Rv);
     CPPUNIT_TEST(throw_if_dmr_too_big_test_rV);
@@ -39,6 +39,8 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <unistd.h>
 
+#include <memory>
+
 #include <libdap/Array.h>
 #include <libdap/Byte.h>
 #include <libdap/ServerFunctionsList.h>
@@ -46,6 +48,9 @@
 #include <libdap/DAS.h>
 #include <libdap/DDS.h>
 #include <libdap/DDXParserSAX2.h>
+#include <libdap/DMR.h>
+#include <libdap/D4Group.h>
+#include <libdap/D4BaseTypeFactory.h>
 
 #include <libdap/util.h>
 #include <libdap/debug.h>
@@ -369,6 +374,50 @@ public:
         DBG(cerr << "cache_and_read_a_response() - END" << endl);
     }
 
+    // The DAP4 version of cache_and_read_a_response2(). The second call reads
+    // the function result from the cache.
+    void cache_and_read_a_dap4_response()
+    {
+        cache = BESDapFunctionResponseCache::get_instance();
+        try {
+            D4BaseTypeFactory factory;
+            DMR dmr(&factory, "test_dmr");
+            dmr.set_filename("function_result_dap4");
+
+            const string function = "test(\"bar\")";
+            CPPUNIT_ASSERT(cache->can_be_cached(&dmr, function));
+
+            unique_ptr<DMR> result(cache->get_or_cache_dataset(&dmr, function));
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT(result->root()->var("bar"));
+
+            string resource_id = cache->get_resource_id(&dmr, function);
+            string cache_file_name = cache->get_hash_basename(resource_id);
+            DBG(cerr << "cache_and_read_a_dap4_response() - resource_id: " << resource_id << endl);
+
+            unique_ptr<DMR> result2(cache->load_dap4_from_cache(resource_id, cache_file_name));
+            CPPUNIT_ASSERT(result2);
+
+            // A DAP2 request with the same text is a different resource
+            CPPUNIT_ASSERT(cache->get_resource_id(test_dds, function) != resource_id);
+
+            D4Group *root = result2->root();
+            CPPUNIT_ASSERT(root->var_end() - root->var_begin() == 1);
+            BaseType *bar = root->var("bar");
+            CPPUNIT_ASSERT(bar);
+            CPPUNIT_ASSERT(bar->type() == dods_array_c);
+            CPPUNIT_ASSERT(bar->read_p());
+
+            ostringstream oss;
+            bar->print_val(oss, "", false /*print declaration */);
+            DBG(cerr << "Value " << oss.str() << endl);
+            CPPUNIT_ASSERT(oss.str().compare("{{0, 1, 2},{3, 4, 5},{6, 7, 8}}") == 0);
+        }
+        catch (Error &e) {
+            CPPUNIT_FAIL(e.get_error_message());
+        }
+    }
+
 CPPUNIT_TEST_SUITE( FunctionResponseCacheTest );
 
     //CPPUNIT_TEST(ctor_test_1);
@@ -376,6 +425,7 @@ CPPUNIT_TEST_SUITE( FunctionResponseCacheTest );
     CPPUNIT_TEST(cache_a_response);
     CPPUNIT_TEST(cache_and_read_a_response);
     CPPUNIT_TEST(cache_and_read_a_response2);
+    CPPUNIT_TEST(cache_and_read_a_dap4_response);
 
     CPPUNIT_TEST_SUITE_END()
     ;
@@ -0,0 +1,175 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of Hyrax, A C++ implementation of the OPeNDAP Data
+// Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libdap/Int32.h>
+
+#include "BESInternalError.h"
+#include "TheBESKeys.h"
+#include "BESDapReadAhead.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+using namespace libdap;
+
+#define prolog std::string("ReadAheadTest::").append(__func__).append("() - ")
+
+// Records the thread that read it; throws if told to.
+class ReadAheadInt32 : public Int32 {
+public:
+    thread::id reader;
+    bool fail = false;
+
+    explicit ReadAheadInt32(const string &name) : Int32(name) {}
+
+    BaseType *ptr_duplicate() override { return new ReadAheadInt32(*this); }
+
+    bool read() override {
+        reader = this_thread::get_id();
+        if (fail)
+            throw BESInternalError("read failed", __FILE__, __LINE__);
+        set_value(42);
+        set_read_p(true);
+        return true;
+    }
+};
+
+class ReadAheadTest : public CppUnit::TestFixture {
+    vector<unique_ptr<ReadAheadInt32>> d_storage;
+    vector<BaseType *> d_vars;
+
+public:
+    void setUp() override {
+        TheBESKeys::TheKeys()->set_key("BES.LogName", "./bes.log");
+        for (int i = 0; i < 5; ++i) {
+            d_storage.emplace_back(new ReadAheadInt32("v" + to_string(i)));
+            d_vars.push_back(d_storage.back().get());
+        }
+    }
+
+    void tearDown() override {
+        d_vars.clear();
+        d_storage.clear();
+    }
+
+    void off_test() {
+        BESDapReadAhead read_ahead(d_vars, 0, 1024);
+        for (vector<BaseType *>::size_type i = 0; i < d_vars.size(); ++i)
+            read_ahead.wait(i);
+        for (auto var: d_vars)
+            CPPUNIT_ASSERT(!var->read_p());
+    }
+
+    void depth_test() {
+        BESDapReadAhead read_ahead(d_vars, 2, 1024);
+        read_ahead.wait(0);
+        // The variable being sent is read by serialize()
+        CPPUNIT_ASSERT(!d_vars[0]->read_p());
+
+        read_ahead.wait(1);
+        CPPUNIT_ASSERT(d_vars[1]->read_p());
+        CPPUNIT_ASSERT(d_storage[1]->reader != this_thread::get_id());
+
+        read_ahead.wait(2);
+        CPPUNIT_ASSERT(d_vars[2]->read_p());
+
+        read_ahead.wait(3);
+        read_ahead.wait(4);
+        CPPUNIT_ASSERT(d_vars[3]->read_p());
+        CPPUNIT_ASSERT(d_vars[4]->read_p());
+    }
+
+    // Room for one Int32 at a time
+    void budget_test() {
+        BESDapReadAhead read_ahead(d_vars, 4, 4);
+        read_ahead.wait(0);
+        CPPUNIT_ASSERT_EQUAL(4ULL, read_ahead.get_bytes_in_use());
+        read_ahead.wait(1);
+        CPPUNIT_ASSERT(d_vars[1]->read_p());
+        // v1 is being sent, so v2 must wait
+        CPPUNIT_ASSERT(!d_vars[2]->read_p());
+        CPPUNIT_ASSERT_EQUAL(4ULL, read_ahead.get_bytes_in_use());
+
+        read_ahead.wait(2);
+        CPPUNIT_ASSERT(!d_vars[2]->read_p());
+        read_ahead.wait(3);
+        CPPUNIT_ASSERT(d_vars[3]->read_p());
+    }
+
+    void too_big_test() {
+        BESDapReadAhead read_ahead(d_vars, 2, 2);
+        read_ahead.wait(0);
+        read_ahead.wait(1);
+        CPPUNIT_ASSERT(!d_vars[1]->read_p());
+        CPPUNIT_ASSERT_EQUAL(0ULL, read_ahead.get_bytes_in_use());
+    }
+
+    void error_test() {
+        d_storage[1]->fail = true;
+        BESDapReadAhead read_ahead(d_vars, 2, 1024);
+        read_ahead.wait(0);
+        CPPUNIT_ASSERT_THROW(read_ahead.wait(1), BESInternalError);
+    }
+
+    void get_depth_test() {
+        TheBESKeys::TheKeys()->set_key(BESDapReadAhead::DEPTH_KEY, "0");
+        CPPUNIT_ASSERT_EQUAL(0U, BESDapReadAhead::get_depth("dmrpp"));
+
+        TheBESKeys::TheKeys()->set_key(BESDapReadAhead::DEPTH_KEY, "2");
+        CPPUNIT_ASSERT_EQUAL(2U, BESDapReadAhead::get_depth("dmrpp"));
+        CPPUNIT_ASSERT_EQUAL(0U, BESDapReadAhead::get_depth("h5"));
+        CPPUNIT_ASSERT_EQUAL(0U, BESDapReadAhead::get_depth(""));
+
+        TheBESKeys::TheKeys()->set_key(BESDapReadAhead::CONTAINER_TYPES_KEY, "h5");
+        CPPUNIT_ASSERT_EQUAL(2U, BESDapReadAhead::get_depth("h5"));
+        CPPUNIT_ASSERT_EQUAL(0U, BESDapReadAhead::get_depth("dmrpp"));
+    }
+
+    CPPUNIT_TEST_SUITE(ReadAheadTest);
+
+    CPPUNIT_TEST(off_test);
+    CPPUNIT_TEST(depth_test);
+    CPPUNIT_TEST(budget_test);
+    CPPUNIT_TEST(too_big_test);
+    CPPUNIT_TEST(error_test);
+    CPPUNIT_TEST(get_depth_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReadAheadTest);
+
+int main(int argc, char *argv[]) {
+    return bes_run_tests<ReadAheadTest>(argc, argv, "cerr,dap") ? 0 : 1;
+}
@@ -67,9 +67,11 @@
 
 #include "BESRegex.h"
 #include "BESDebug.h"
+#include "BESUtil.h"
 #include "TheBESKeys.h"
 #include "BESDapResponseBuilder.h"
 #include "BESDapFunctionResponseCache.h"
+#include "BESDap4ResponseCache.h"
 #include "BESStoredDapResultCache.h"
 
 #include "BESResponseObject.h"
@@ -80,6 +82,7 @@
 
 #include "test_utils.h"
 #include "test_config.h"
+#include "TestFunction.h"
 
 using namespace CppUnit;
 using namespace std;
@@ -184,6 +187,7 @@ private:
             rb_simple_function);
 
         libdap::ServerFunctionsList::TheList()->add_function(rbSSF);
+        libdap::ServerFunctionsList::TheList()->add_function(new TestFunction());
     }
 
 public:
@@ -794,6 +798,94 @@ public:
         DBG(cerr << plog << "END" << endl);
     }
 
+    // A response sent from the DAP4 response cache is the same as the one that was built
+    void send_dap4_data_cache_test()
+    {
+        const string cache_dir = (string) TEST_BUILD_DIR + "/dap4_response_cache";
+        string rm_cache = "rm -rf " + cache_dir;
+        CPPUNIT_ASSERT(system(rm_cache.c_str()) == 0);
+        BESUtil::mkdir_p(cache_dir, 0775);
+
+        TheBESKeys::TheKeys()->set_key(BESDap4ResponseCache::PATH_KEY, cache_dir);
+        BESDap4ResponseCache *cache = BESDap4ResponseCache::TheCache();
+        CPPUNIT_ASSERT(cache->is_enabled());
+
+        // The dataset is only stat()ed for the cache key; the data come from the DMR.
+        drb->set_dataset_name((string) TEST_SRC_DIR + "/input-files/test_01.dmr");
+        const unsigned long long hits = cache->get_hits();
+        const unsigned long long misses = cache->get_misses();
+
+        ostringstream built;
+        drb->send_dap4_data(built, *test_01_dmr, false);
+        CPPUNIT_ASSERT_EQUAL(hits, cache->get_hits());
+        CPPUNIT_ASSERT_EQUAL(misses + 1, cache->get_misses());
+        CPPUNIT_ASSERT(!built.str().empty());
+
+        ostringstream cached;
+        drb->send_dap4_data(cached, *test_01_dmr, false);
+        CPPUNIT_ASSERT_EQUAL(hits + 1, cache->get_hits());
+        CPPUNIT_ASSERT_EQUAL(built.str().size(), cached.str().size());
+        CPPUNIT_ASSERT(built.str() == cached.str());
+
+        // NcML reads files the key does not cover, so it is never cached
+        drb->set_container_type("ncml");
+        ostringstream ncml;
+        drb->send_dap4_data(ncml, *test_01_dmr, false);
+        CPPUNIT_ASSERT_EQUAL(hits + 1, cache->get_hits());
+        CPPUNIT_ASSERT_EQUAL(misses + 1, cache->get_misses());
+
+        // A CE that does not parse is an error before any headers are written
+        drb->set_container_type("");
+        drb->set_dap4ce("no_such_variable");
+        ostringstream bad_ce;
+        bool caught = false;
+        try {
+            drb->send_dap4_data(bad_ce, *test_01_dmr, true);
+        }
+        catch (...) {
+            caught = true;
+        }
+        CPPUNIT_ASSERT(caught);
+        CPPUNIT_ASSERT(bad_ce.str().empty());
+        drb->set_dap4ce("");
+
+        CPPUNIT_ASSERT(system(rm_cache.c_str()) == 0);
+    }
+
+    // A DAP4 function plus CE must send the same bytes whether or not the
+    // function result came from the function response cache.
+    void send_dap4_function_cache_test()
+    {
+        BESDapFunctionResponseCache *cache = BESDapFunctionResponseCache::get_instance();
+        CPPUNIT_ASSERT(cache);
+
+        test_01_dmr->set_filename((string) TEST_SRC_DIR + "/input-files/test_01.dmr");
+        drb->set_dap4function("test(\"bar\");test(\"baz\")");
+        drb->set_dap4ce("bar");
+
+        cache->disable();
+        ostringstream uncached;
+        try {
+            drb->build_dap4_data(uncached, *test_01_dmr, false);
+        }
+        catch (...) {
+            cache->enable();
+            throw;
+        }
+        cache->enable();
+        CPPUNIT_ASSERT(!uncached.str().empty());
+        CPPUNIT_ASSERT(uncached.str().find("baz") == string::npos);
+
+        // The first call may write the result to the cache, the second reads it
+        ostringstream written;
+        drb->build_dap4_data(written, *test_01_dmr, false);
+        CPPUNIT_ASSERT(uncached.str() == written.str());
+
+        ostringstream read;
+        drb->build_dap4_data(read, *test_01_dmr, false);
+        CPPUNIT_ASSERT(uncached.str() == read.str());
+    }
+
     CPPUNIT_TEST_SUITE( ResponseBuilderTest );
 
 #if 0
@@ -810,6 +902,8 @@ public:
         CPPUNIT_TEST(invoke_server_side_function_test);
 #endif
         CPPUNIT_TEST(dummy_test);
+        CPPUNIT_TEST(send_dap4_data_cache_test);
+        CPPUNIT_TEST(send_dap4_function_cache_test);
 
 #if 0
         // FIXME These tests have baselines that rely on hash values that are
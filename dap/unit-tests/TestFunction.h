@@ -8,6 +8,8 @@
 
 #include <libdap/DAS.h>
 #include <libdap/DDS.h>
+#include <libdap/DMR.h>
+#include <libdap/D4RValue.h>
 #include <libdap/util.h>
 
 //#define KEY "response_cache"
@@ -62,6 +64,36 @@ private:
         *btpp = dest;
     }
 
+    /// The DAP4 version of function_dap2_test()
+    static libdap::BaseType *function_dap4_test(libdap::D4RValueList *args, libdap::DMR &dmr)
+    {
+        if (args->size() != 1) {
+            throw libdap::Error(malformed_expr, "test(name) requires one argument.");
+        }
+
+        std::string name = libdap::extract_string_argument(args->get_rvalue(0)->value(dmr));
+
+        auto dest = new libdap::Array(name, new libdap::Byte(name), true /* is_dap4 */);
+
+        unsigned long num_elem = 1;
+        for (int d = 0; d < num_dim; ++d) {
+            num_elem *= dim_sz;
+            dest->append_dim(dim_sz);
+        }
+
+        vector<libdap::dods_byte> values(num_elem);
+        for (unsigned int i = 0; i < num_elem; ++i) {
+            values[i] = i;
+        }
+
+        dest->set_value(values, num_elem);
+
+        dest->set_send_p(true);
+        dest->set_read_p(true);
+
+        return dest;
+    }
+
 public:
     TestFunction()
     {
@@ -71,6 +103,7 @@ public:
         setRole("http://services.opendap.org/dap4/server-side-function/");
         setDocUrl("https://docs.opendap.org/index.php/Server_Side_Processing_Functions");
         setFunction(TestFunction::function_dap2_test);
+        setFunction(TestFunction::function_dap4_test);
         // setFunction(TestFunction::function_dap4_tabular);
         setVersion("1.0");
     }
@@ -47,6 +47,7 @@
 
 #include "BESCatalogDirectory.h"
 #include "BESCatalogEntry.h"
+#include "BESCatalogTree.h"
 #include "BESCatalogUtils.h"
 #include "BESUtil.h"
 
@@ -63,6 +64,7 @@
 #include "BESNotFoundError.h"
 
 #include "BESDebug.h"
+#include "TheBESKeys.h"
 
 using namespace bes;
 using namespace std;
@@ -79,6 +81,12 @@ using namespace std;
  * @note Access to the host's file system is made using BESCatalogUtils,
  * which is initialized using the catalog name.
  *
+ * @note When BES.Catalog.<name>.TreeCacheSeconds is greater than zero the
+ * directory listings are kept in a BESCatalogTree and reused by get_node()
+ * and get_site_map() until the directory changes or the listing is that
+ * many seconds old. BES.Catalog.<name>.TreeCacheMaxDirectories (default
+ * 10,000) limits the number of directories held.
+ *
  * @param name The name of the catalog.
  * @see BESCatalogUtils
  */
@@ -86,6 +94,13 @@ BESCatalogDirectory::BESCatalogDirectory(const string &name) : BESCatalog(name)
 #if 0
     get_catalog_utils() = BESCatalogUtils::Utils(name);
 #endif
+    int seconds = TheBESKeys::read_int_key("BES.Catalog." + name + ".TreeCacheSeconds", 0);
+    if (seconds > 0) {
+        unsigned long max_dirs = TheBESKeys::read_ulong_key("BES.Catalog." + name + ".TreeCacheMaxDirectories", 10000);
+        d_tree.reset(new BESCatalogTree(
+            [this](const string &dir, BESCatalogTree::Listing &listing) { scan_directory(dir, listing); }, seconds,
+            max_dirs));
+    }
 }
 
 BESCatalogDirectory::~BESCatalogDirectory() = default;
@@ -284,11 +299,16 @@ static string get_time(time_t the_time, bool use_local_time = false) {
 }
 
 /**
- * Takes a directory entry and adds the appropriate CatalogItem to the node.
+ * Takes a directory entry and decides if it is a node, a leaf, or not part of
+ * the catalog. For nodes and leaves, \arg entry is filled in.
+ *
+ * @return CatalogItem::node, CatalogItem::leaf or CatalogItem::unknown if the
+ * entry is not part of the catalog.
  */
-CatalogItem *BESCatalogDirectory::make_item(string path_prefix, string item) const {
+CatalogItem::item_type BESCatalogDirectory::make_entry(const string &path_prefix, const string &item,
+                                                       BESCatalogTree::Entry &entry) const {
     if (item == "." || item == "..")
-        return nullptr;
+        return CatalogItem::unknown;
 
     string item_path = BESUtil::assemblePath(path_prefix, item);
     BESDEBUG(MODULE, PROLOG << "Processing POSIX entry: " << item_path << endl);
@@ -312,18 +332,25 @@ CatalogItem *BESCatalogDirectory::make_item(string path_prefix, string item) con
         struct stat lbuf;
         (void)lstat(item_path.c_str(), &lbuf);
         if (S_ISLNK(lbuf.st_mode))
-            return nullptr;
+            return CatalogItem::unknown;
     }
     // Is this a directory or a file? Should it be excluded or included?
     struct stat buf;
     int statret = stat(item_path.c_str(), &buf);
     if (statret == 0 && S_ISDIR(buf.st_mode) && !exclude_item) {
         BESDEBUG(MODULE, PROLOG << item_path << " is NODE" << endl);
-        return new CatalogItem(item, 0, get_time(buf.st_mtime), CatalogItem::node);
+        entry.name = item;
+        entry.size = 0;
+        entry.mtime = buf.st_mtime;
+        entry.is_data = false;
+        return CatalogItem::node;
     } else if (statret == 0 && S_ISREG(buf.st_mode) && include_item) {
         BESDEBUG(MODULE, PROLOG << item_path << " is LEAF" << endl);
-        return new CatalogItem(item, buf.st_size, get_time(buf.st_mtime), get_catalog_utils()->is_data(item),
-                               CatalogItem::leaf);
+        entry.name = item;
+        entry.size = buf.st_size;
+        entry.mtime = buf.st_mtime;
+        entry.is_data = get_catalog_utils()->is_data(item);
+        return CatalogItem::leaf;
     }
 
     // This is the error case; it only is run when the item_path is neither a
@@ -339,7 +366,125 @@ CatalogItem *BESCatalogDirectory::make_item(string path_prefix, string item) con
     BESDEBUG(MODULE, PROLOG << msg.str());
     VERBOSE(msg.str());
 
-    return nullptr;
+    return CatalogItem::unknown;
+}
+
+/**
+ * Takes a directory entry and adds the appropriate CatalogItem to the node.
+ */
+CatalogItem *BESCatalogDirectory::make_item(string path_prefix, string item) const {
+    BESCatalogTree::Entry entry;
+    switch (make_entry(path_prefix, item, entry)) {
+    case CatalogItem::node:
+        return new CatalogItem(entry.name, 0, get_time(entry.mtime), CatalogItem::node);
+    case CatalogItem::leaf:
+        return new CatalogItem(entry.name, entry.size, get_time(entry.mtime), entry.is_data, CatalogItem::leaf);
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Read the directory \arg fullpath into \arg listing
+ *
+ * This is the only place a catalog directory is read; the results are
+ * cached by BESCatalogTree when BES.Catalog.<name>.TreeCacheSeconds is set.
+ */
+void BESCatalogDirectory::scan_directory(const string &fullpath, BESCatalogTree::Listing &listing) const {
+    DIR *dip = opendir(fullpath.c_str());
+    if (dip == nullptr) {
+        // That went well...
+        // We need to return this "node", and at this point it is empty.
+        // Which is probably enough, so we do nothing more.
+        BESDEBUG(MODULE, PROLOG << "Unable to open '" << fullpath << "' SKIPPING (errno: " << std::strerror(errno)
+                                << ")" << endl);
+        return;
+    }
+
+    try {
+        // otherwise we grind through the node contents...
+        struct dirent *dit;
+        BESCatalogTree::Entry entry;
+        while ((dit = readdir(dip)) != nullptr) {
+            switch (make_entry(fullpath, dit->d_name, entry)) {
+            case CatalogItem::node:
+                listing.nodes.push_back(entry);
+                break;
+            case CatalogItem::leaf:
+                listing.leaves.push_back(entry);
+                break;
+            default:
+                break;
+            }
+        }
+        closedir(dip);
+    } catch (...) {
+        closedir(dip);
+        throw;
+    }
+
+    auto ordering = [](const BESCatalogTree::Entry &a, const BESCatalogTree::Entry &b) { return a.name < b.name; };
+    sort(listing.nodes.begin(), listing.nodes.end(), ordering);
+    sort(listing.leaves.begin(), listing.leaves.end(), ordering);
+}
+
+/**
+ * @brief Check \arg path and, if it names a directory, get its listing
+ *
+ * @param path The pathname for the node; must start with a slash (/)
+ * @param path_stat Value-result parameter; the stat(2) information for \arg path
+ * @return The listing for a directory or null for a regular file.
+ *
+ * @throw BESInternalError If the \arg path is not a directory or regular file
+ * @throw BESForbiddenError If the \arg path is explicitly excluded by the
+ * bes.conf file
+ */
+BESCatalogTree::ListingPtr BESCatalogDirectory::get_listing(const string &path, struct stat &path_stat) const {
+    if (path[0] != '/')
+        throw BESInternalError("The path sent to BESCatalogDirectory::get_node() must start with a slash (/)", __FILE__,
+                               __LINE__);
+
+    string rootdir = get_catalog_utils()->get_root_dir();
+
+    // This will throw the appropriate exception (Forbidden or Not Found).
+    // Checks to make sure the different elements of the path are not
+    // symbolic links if follow_sym_links is set to false, and checks to
+    // make sure have permission to access node and the node exists.
+    // TODO Make BESUtil::check_path() return the stat struct so we don't have to stat again here.
+    BESUtil::check_path(path, rootdir, get_catalog_utils()->follow_sym_links());
+    string fullpath = BESUtil::assemblePath(rootdir, path);
+    int stat_result = stat(fullpath.c_str(), &path_stat);
+    if (stat_result) {
+        throw BESForbiddenError(string("Unable to 'stat' the path '") + fullpath +
+                                    "' errno says: " + std::strerror(errno),
+                                __FILE__, __LINE__);
+    }
+
+    if (S_ISREG(path_stat.st_mode))
+        return nullptr;
+
+    if (S_ISDIR(path_stat.st_mode)) {
+        BESDEBUG(MODULE, PROLOG << "Processing directory node: " << fullpath << endl);
+        // The node is a directory
+        // Based on other code (show_catalogs()), use BESCatalogUtils::exclude() on
+        // a directory, but BESCatalogUtils::include() on a file.
+        if (get_catalog_utils()->exclude(path))
+            throw BESForbiddenError(string("The path '") + path + "' is not included in the catalog '" +
+                                        get_catalog_name() + "'.",
+                                    __FILE__, __LINE__);
+
+        if (d_tree)
+            return d_tree->get(fullpath, path_stat);
+
+        auto listing = make_shared<BESCatalogTree::Listing>();
+        scan_directory(fullpath, *listing);
+        return listing;
+    }
+
+    throw BESInternalError("A BESCatalogDirectory can only return nodes for directories and regular files. The path '" +
+                               path + "' is not a directory or a regular file for BESCatalog '" + get_catalog_name() +
+                               "'.",
+                           __FILE__, __LINE__);
 }
 
 // path must start with a '/'. By this class it will be interpreted as a
@@ -373,32 +518,14 @@ CatalogItem *BESCatalogDirectory::make_item(string path_prefix, string item) con
  * bes.conf file
  */
 CatalogNode *BESCatalogDirectory::get_node(const string &path) const {
-    if (path[0] != '/')
-        throw BESInternalError("The path sent to BESCatalogDirectory::get_node() must start with a slash (/)", __FILE__,
-                               __LINE__);
-
-    string rootdir = get_catalog_utils()->get_root_dir();
-
-    // This will throw the appropriate exception (Forbidden or Not Found).
-    // Checks to make sure the different elements of the path are not
-    // symbolic links if follow_sym_links is set to false, and checks to
-    // make sure have permission to access node and the node exists.
-    // TODO Make BESUtil::check_path() return the stat struct so we don't have to stat again here.
-    BESUtil::check_path(path, rootdir, get_catalog_utils()->follow_sym_links());
-    string fullpath = BESUtil::assemblePath(rootdir, path);
     struct stat full_path_stat_buf;
-    int stat_result = stat(fullpath.c_str(), &full_path_stat_buf);
-    if (stat_result) {
-        throw BESForbiddenError(string("Unable to 'stat' the path '") + fullpath +
-                                    "' errno says: " + std::strerror(errno),
-                                __FILE__, __LINE__);
-    }
+    BESCatalogTree::ListingPtr listing = get_listing(path, full_path_stat_buf);
 
-    CatalogNode *node = new CatalogNode(path);
-    if (S_ISREG(full_path_stat_buf.st_mode)) {
-        BESDEBUG(MODULE, PROLOG << "The requested node '" + fullpath + "' is actually a leaf. Wut do?" << endl);
+    unique_ptr<CatalogNode> node(new CatalogNode(path));
+    if (!listing) {
+        BESDEBUG(MODULE, PROLOG << "The requested node '" + path + "' is actually a leaf. Wut do?" << endl);
 
-        CatalogItem *item = make_item(rootdir, path);
+        CatalogItem *item = make_item(get_catalog_utils()->get_root_dir(), path);
         if (item) {
             node->set_leaf(item);
         } else {
@@ -408,59 +535,21 @@ CatalogNode *BESCatalogDirectory::get_node(const string &path) const {
         }
 
         BESDEBUG(MODULE, PROLOG << "Actually, I'm a LEAF (" << (void *)item << ")" << endl);
-        return node;
-    } else if (S_ISDIR(full_path_stat_buf.st_mode)) {
-        BESDEBUG(MODULE, PROLOG << "Processing directory node: " << fullpath << endl);
-        DIR *dip = nullptr;
-        try {
-            // The node is a directory
-            // Based on other code (show_catalogs()), use BESCatalogUtils::exclude() on
-            // a directory, but BESCatalogUtils::include() on a file.
-            if (get_catalog_utils()->exclude(path))
-                throw BESForbiddenError(string("The path '") + path + "' is not included in the catalog '" +
-                                            get_catalog_name() + "'.",
-                                        __FILE__, __LINE__);
-
-            node->set_catalog_name(get_catalog_name());
-            node->set_lmt(get_time(full_path_stat_buf.st_mtime));
-
-            dip = opendir(fullpath.c_str());
-            if (dip == nullptr) {
-                // That went well...
-                // We need to return this "node", and at this point it is empty.
-                // Which is probably enough, so we do nothing more.
-                BESDEBUG(MODULE, PROLOG << "Unable to open '" << fullpath
-                                        << "' SKIPPING (errno: " << std::strerror(errno) << ")" << endl);
-            } else {
-                // otherwise we grind through the node contents...
-                struct dirent *dit;
-                while ((dit = readdir(dip)) != nullptr) {
-                    CatalogItem *item = make_item(fullpath, dit->d_name);
-                    if (item) {
-                        if (item->get_type() == CatalogItem::node) {
-                            node->add_node(item);
-                        } else {
-                            node->add_leaf(item);
-                        }
-                    }
-                }
-                closedir(dip);
-            }
+        return node.release();
+    }
 
-            CatalogItem::CatalogItemAscending ordering;
-            sort(node->nodes_begin(), node->nodes_end(), ordering);
-            sort(node->leaves_begin(), node->leaves_end(), ordering);
+    node->set_catalog_name(get_catalog_name());
+    node->set_lmt(get_time(full_path_stat_buf.st_mtime));
 
-            return node;
-        } catch (...) {
-            closedir(dip);
-            throw;
-        }
-    }
-    throw BESInternalError("A BESCatalogDirectory can only return nodes for directories and regular files. The path '" +
-                               path + "' is not a directory or a regular file for BESCatalog '" + get_catalog_name() +
-                               "'.",
-                           __FILE__, __LINE__);
+    // The listing is already sorted
+    for (const auto &entry : listing->nodes)
+        node->add_node(new CatalogItem(entry.name, 0, get_time(entry.mtime), CatalogItem::node));
+
+    for (const auto &entry : listing->leaves)
+        node->add_leaf(
+            new CatalogItem(entry.name, entry.size, get_time(entry.mtime), entry.is_data, CatalogItem::leaf));
+
+    return node.release();
 }
 
 #if 0
@@ -607,32 +696,27 @@ BESCatalogDirectory::get_node(const string &path) const
  */
 void BESCatalogDirectory::get_site_map(const string &prefix, const string &node_suffix, const string &leaf_suffix,
                                        ostream &out, const string &path) const {
-    unique_ptr<CatalogNode> node(get_node(path));
-
-#if ITEMS
-    for (CatalogNode::item_citer i = node->items_begin(), e = node->items_end(); i != e; ++i) {
-        if ((*i)->get_type() == CatalogItem::leaf && (*i)->is_data()) {
-            out << prefix << path << (*i)->get_name() << leaf_suffix << endl;
-        } else if ((*i)->get_type() == CatalogItem::node) {
-            get_site_map(prefix, leaf_suffix, out, path + (*i)->get_name() + "/");
-        }
-    }
-#endif
+    // Work from the directory listings; building a CatalogNode (and a CatalogItem
+    // for each entry) for every directory in the catalog is not needed here.
+    struct stat path_stat;
+    BESCatalogTree::ListingPtr listing = get_listing(path, path_stat);
 
     if (!node_suffix.empty())
-        out << prefix << path << node_suffix << endl;
+        out << prefix << path << node_suffix << '\n';
 
-    // Depth-first node traversal. Assume the nodes and leaves are sorted
-    for (CatalogNode::item_citer i = node->nodes_begin(), e = node->nodes_end(); i != e; ++i) {
-        assert((*i)->get_type() == CatalogItem::node);
-        get_site_map(prefix, node_suffix, leaf_suffix, out, path + (*i)->get_name() + "/");
-    }
+    if (!listing)
+        return;
+
+    // Depth-first node traversal. The nodes and leaves are sorted
+    for (const auto &entry : listing->nodes)
+        get_site_map(prefix, node_suffix, leaf_suffix, out, path + entry.name + "/");
 
     // For leaves, only write the data items
-    for (CatalogNode::item_citer i = node->leaves_begin(), e = node->leaves_end(); i != e; ++i) {
-        assert((*i)->get_type() == CatalogItem::leaf);
-        if ((*i)->is_data() && !leaf_suffix.empty())
-            out << prefix << path << (*i)->get_name() << leaf_suffix << endl;
+    if (!leaf_suffix.empty()) {
+        for (const auto &entry : listing->leaves) {
+            if (entry.is_data)
+                out << prefix << path << entry.name << leaf_suffix << '\n';
+        }
     }
 }
 
@@ -651,5 +735,11 @@ void BESCatalogDirectory::dump(ostream &strm) const {
     BESIndent::Indent();
     get_catalog_utils()->dump(strm);
     BESIndent::UnIndent();
+    if (d_tree) {
+        strm << BESIndent::LMarg << "directory cache: " << endl;
+        BESIndent::Indent();
+        d_tree->dump(strm);
+        BESIndent::UnIndent();
+    }
     BESIndent::UnIndent();
 }
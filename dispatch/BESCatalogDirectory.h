@@ -33,11 +33,15 @@
 #ifndef I_BESCatalogDirectory_h
 #define I_BESCatalogDirectory_h 1
 
+#include <sys/stat.h>
+
 #include <list>
+#include <memory>
 #include <ostream>
 #include <string>
 
 #include "BESCatalog.h"
+#include "BESCatalogTree.h"
 #include "CatalogItem.h"
 
 class BESCatalogEntry;
@@ -50,7 +54,13 @@ class CatalogNode;
  * @brief Catalogs from a directory structure
  */
 class BESCatalogDirectory : public BESCatalog {
+    std::unique_ptr<BESCatalogTree> d_tree; ///< Cached directory listings; null if not enabled
+
+    bes::CatalogItem::item_type make_entry(const std::string &path_prefix, const std::string &item,
+                                           BESCatalogTree::Entry &entry) const;
     bes::CatalogItem *make_item(std::string item, std::string fullpath) const;
+    void scan_directory(const std::string &fullpath, BESCatalogTree::Listing &listing) const;
+    BESCatalogTree::ListingPtr get_listing(const std::string &path, struct stat &path_stat) const;
 #if 0
     // not impl. jhrg 11/14/25
     bes::CatalogItem *make_item(std::string item) const;
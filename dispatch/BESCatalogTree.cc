@@ -0,0 +1,289 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "BESCatalogTree.h"
+#include "BESDebug.h"
+#include "BESIndent.h"
+#include "BESLog.h"
+
+using namespace std;
+
+#define MODULE "bes"
+#define PROLOG "BESCatalogTree::" << __func__ << "() - "
+
+#ifdef HAVE_SYS_INOTIFY_H
+// Changes to a directory's entries, or to the size, mtime or permissions of the
+// files in it. IN_MODIFY is included so a file that is being written does not
+// keep a stale size until it is closed.
+static const uint32_t watch_mask = IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY |
+                                   IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// These also change the mtime of the watched directory itself, which the
+// listing of its parent directory holds.
+static const uint32_t parent_mask = IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO;
+#endif
+
+/**
+ * @brief Make a cache for one catalog
+ *
+ * @param scanner Called to read a directory that is not in the cache
+ * @param reconcile_seconds Re-read a directory once its listing is this old
+ * @param max_dirs Hold at most this many directory listings
+ */
+BESCatalogTree::BESCatalogTree(Scanner scanner, unsigned int reconcile_seconds, unsigned long max_dirs)
+    : d_scanner(std::move(scanner)), d_reconcile_seconds(reconcile_seconds), d_max_dirs(max_dirs) {
+}
+
+BESCatalogTree::~BESCatalogTree() {
+    if (d_inotify_fd >= 0)
+        close(d_inotify_fd);
+}
+
+/**
+ * @brief Strip trailing slashes from a pathname so each directory has one key
+ */
+string BESCatalogTree::normalize(const string &dir) {
+    string::size_type last = dir.find_last_not_of('/');
+    if (last == string::npos)
+        return "/";
+    return dir.substr(0, last + 1);
+}
+
+// Call with d_lock held.
+void BESCatalogTree::drop(map<string, Dir>::iterator i) {
+#ifdef HAVE_SYS_INOTIFY_H
+    if (i->second.wd >= 0) {
+        inotify_rm_watch(d_inotify_fd, i->second.wd);
+        d_watches.erase(i->second.wd);
+    }
+#endif
+    d_lru.erase(i->second.lru);
+    d_dirs.erase(i);
+}
+
+// Call with d_lock held.
+void BESCatalogTree::drop(const string &dir) {
+    auto i = d_dirs.find(dir);
+    if (i != d_dirs.end())
+        drop(i);
+}
+
+/**
+ * @brief Make this process's inotify instance
+ *
+ * Call with d_lock held. The catalogs are made before the BES forks the
+ * processes that answer requests, and an inotify instance is shared by every
+ * process that inherits it: one process would read the others' events and
+ * remove the watches they use. So each process makes its own instance the
+ * first time it needs one. Listings inherited from the parent are dropped,
+ * since this process has no watches for them; the parent's watches are left
+ * alone.
+ */
+void BESCatalogTree::start_watching() {
+#ifdef HAVE_SYS_INOTIFY_H
+    const pid_t pid = getpid();
+    if (d_inotify_pid == pid)
+        return;
+
+    if (d_inotify_fd >= 0) {
+        close(d_inotify_fd);
+        d_inotify_fd = -1;
+    }
+    d_dirs.clear();
+    d_lru.clear();
+    d_watches.clear();
+
+    d_inotify_pid = pid;
+    d_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (d_inotify_fd < 0)
+        ERROR_LOG(string("Could not initialize inotify for the catalog cache, changes will be found every ") +
+                  to_string(d_reconcile_seconds) + " seconds: " + strerror(errno));
+#endif
+}
+
+/**
+ * @brief Drop the listings of the directories inotify reported changes for
+ *
+ * Call with d_lock held. The inotify descriptor is non-blocking, so this
+ * returns as soon as the pending events have been read.
+ */
+void BESCatalogTree::process_events() {
+#ifdef HAVE_SYS_INOTIFY_H
+    if (d_inotify_fd < 0)
+        return;
+
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = read(d_inotify_fd, buf, sizeof buf)) > 0) {
+        for (char *ptr = buf; ptr < buf + len;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                BESDEBUG(MODULE, PROLOG << "inotify queue overflow, dropping all listings" << endl);
+                while (!d_dirs.empty())
+                    drop(d_dirs.begin());
+                continue;
+            }
+
+            auto w = d_watches.find(event->wd);
+            if (w == d_watches.end())
+                continue; // a watch that was already removed
+
+            string dir = w->second;
+            BESDEBUG(MODULE, PROLOG << "Change (0x" << hex << event->mask << dec << ") in " << dir << endl);
+
+            if (event->mask & IN_IGNORED) {
+                // The kernel removed the watch (directory deleted or unmounted).
+                auto i = d_dirs.find(dir);
+                if (i != d_dirs.end())
+                    i->second.wd = -1;
+                d_watches.erase(w);
+            }
+
+            drop(dir);
+            if ((event->mask & parent_mask) && dir != "/")
+                drop(normalize(dir.substr(0, dir.rfind('/') + 1)));
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Get the listing for a directory, reading it only if needed
+ *
+ * @param dir Full pathname of the directory
+ * @param dir_stat The result of stat(2) for \arg dir, taken by the caller
+ * @return The listing; it is not changed once returned, so it stays valid
+ * even if the cache drops it.
+ */
+BESCatalogTree::ListingPtr BESCatalogTree::get(const string &dir, const struct stat &dir_stat) {
+    string key = normalize(dir);
+
+    lock_guard<mutex> lock(d_lock);
+
+    start_watching();
+    process_events();
+
+    time_t now = time(nullptr);
+    auto i = d_dirs.find(key);
+    if (i != d_dirs.end()) {
+        const Listing &cached = *i->second.listing;
+        if (cached.dir_mtime == dir_stat.st_mtime && cached.dir_ctime == dir_stat.st_ctime &&
+            cached.dir_mtime < cached.scanned && now - cached.scanned < d_reconcile_seconds) {
+            d_lru.splice(d_lru.begin(), d_lru, i->second.lru);
+            return i->second.listing;
+        }
+        BESDEBUG(MODULE, PROLOG << "Listing for " << key << " is out of date" << endl);
+        drop(i);
+    }
+
+    // Add the watch before reading the directory so a change made while it is
+    // read is not lost.
+    int wd = -1;
+#ifdef HAVE_SYS_INOTIFY_H
+    if (d_inotify_fd >= 0) {
+        wd = inotify_add_watch(d_inotify_fd, key.c_str(), watch_mask);
+        if (wd < 0) {
+            BESDEBUG(MODULE, PROLOG << "Could not watch " << key << ": " << strerror(errno) << endl);
+        } else {
+            d_watches[wd] = key;
+        }
+    }
+#endif
+
+    auto listing = make_shared<Listing>();
+    listing->dir_mtime = dir_stat.st_mtime;
+    listing->dir_ctime = dir_stat.st_ctime;
+    listing->scanned = now;
+    try {
+        d_scanner(key, *listing);
+    } catch (...) {
+#ifdef HAVE_SYS_INOTIFY_H
+        if (wd >= 0) {
+            inotify_rm_watch(d_inotify_fd, wd);
+            d_watches.erase(wd);
+        }
+#endif
+        throw;
+    }
+
+    d_lru.push_front(key);
+    Dir &entry = d_dirs[key];
+    entry.listing = listing;
+    entry.wd = wd;
+    entry.lru = d_lru.begin();
+
+    while (d_dirs.size() > d_max_dirs && d_lru.size() > 1)
+        drop(d_lru.back());
+
+    return listing;
+}
+
+/**
+ * @brief Drop the listing for a directory
+ */
+void BESCatalogTree::invalidate(const string &dir) {
+    lock_guard<mutex> lock(d_lock);
+    start_watching();
+    drop(normalize(dir));
+}
+
+/**
+ * @brief Drop all the listings
+ */
+void BESCatalogTree::clear() {
+    lock_guard<mutex> lock(d_lock);
+    start_watching();
+    while (!d_dirs.empty())
+        drop(d_dirs.begin());
+}
+
+/**
+ * @brief How many directory listings are held
+ */
+size_t BESCatalogTree::size() const {
+    lock_guard<mutex> lock(d_lock);
+    return d_dirs.size();
+}
+
+void BESCatalogTree::dump(ostream &strm) const {
+    lock_guard<mutex> lock(d_lock);
+    strm << BESIndent::LMarg << "BESCatalogTree::dump - (" << (void *)this << ")" << endl;
+    BESIndent::Indent();
+    strm << BESIndent::LMarg << "reconcile seconds: " << d_reconcile_seconds << endl;
+    strm << BESIndent::LMarg << "max directories: " << d_max_dirs << endl;
+    strm << BESIndent::LMarg << "directories: " << d_dirs.size() << endl;
+    strm << BESIndent::LMarg << "inotify watches: " << d_watches.size() << endl;
+    BESIndent::UnIndent();
+}
@@ -0,0 +1,138 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESCatalogTree_h
+#define I_BESCatalogTree_h 1
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <ctime>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BESObj.h"
+
+/**
+ * @brief An in-memory cache of the directory listings of a POSIX catalog
+ *
+ * Building a catalog node for a directory means reading the directory and
+ * calling stat(2) (and maybe lstat(2)) for every entry in it. This class holds
+ * the result of that work, one Listing per directory, so that repeated showNode
+ * and site map requests are answered without touching the file system more
+ * than once per directory.
+ *
+ * A cached listing is used only while all of these hold:
+ * - The mtime and ctime of the directory are the ones seen when it was read.
+ *   This catches entries being added, removed or renamed, even on NFS.
+ * - The directory was not modified during the second in which it was read;
+ *   a change made in that second would not alter the (one-second) mtime.
+ * - No inotify(7) event was reported for the directory. This catches changes
+ *   to the size or mtime of the files in it. Only built when the host has
+ *   sys/inotify.h.
+ * - The listing is younger than the reconciliation interval. This bounds how
+ *   long a change the other tests cannot see (a file rewritten on an NFS
+ *   server, an inotify watch that could not be added) is missed.
+ *
+ * At most max_dirs listings are held; the least recently used is dropped.
+ * The methods may be called from several threads.
+ */
+class BESCatalogTree : public BESObj {
+public:
+    /// @brief One entry of a directory; directories have a size of zero
+    struct Entry {
+        std::string name;
+        off_t size = 0;
+        time_t mtime = 0;
+        bool is_data = false;
+    };
+
+    /// @brief The catalog entries of a directory, each vector sorted by name
+    struct Listing {
+        time_t dir_mtime = 0;
+        time_t dir_ctime = 0;
+        time_t scanned = 0;
+        std::vector<Entry> nodes;
+        std::vector<Entry> leaves;
+    };
+
+    using ListingPtr = std::shared_ptr<const Listing>;
+
+    /// @brief Fills in the nodes and leaves of a Listing for the named directory
+    using Scanner = std::function<void(const std::string &dir, Listing &listing)>;
+
+private:
+    struct Dir {
+        ListingPtr listing;
+        int wd = -1;
+        std::list<std::string>::iterator lru;
+    };
+
+    Scanner d_scanner;
+    time_t d_reconcile_seconds;
+    unsigned long d_max_dirs;
+
+    mutable std::mutex d_lock;
+    std::map<std::string, Dir> d_dirs;
+    std::list<std::string> d_lru; // most recently used at the front
+    std::map<int, std::string> d_watches;
+    // The inotify instance belongs to the process that made it; see start_watching().
+    int d_inotify_fd = -1;
+    pid_t d_inotify_pid = 0;
+
+    void drop(std::map<std::string, Dir>::iterator i);
+    void drop(const std::string &dir);
+    void start_watching();
+    void process_events();
+
+public:
+    BESCatalogTree(Scanner scanner, unsigned int reconcile_seconds, unsigned long max_dirs);
+
+    BESCatalogTree(const BESCatalogTree &) = delete;
+    BESCatalogTree &operator=(const BESCatalogTree &) = delete;
+
+    ~BESCatalogTree() override;
+
+    ListingPtr get(const std::string &dir, const struct stat &dir_stat);
+
+    void invalidate(const std::string &dir);
+    void clear();
+
+    size_t size() const;
+
+    /// @brief True if inotify is used to find changes to the cached directories
+    /// @note The inotify instance is made by the first call to get() in a process.
+    bool watching() const { return d_inotify_fd >= 0; }
+
+    static std::string normalize(const std::string &dir);
+
+    void dump(std::ostream &strm) const override;
+};
+
+#endif // I_BESCatalogTree_h
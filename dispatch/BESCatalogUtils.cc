@@ -50,7 +50,6 @@
 #include "BESInfo.h"
 #include "BESInternalError.h"
 #include "BESNotFoundError.h"
-#include "BESRegex.h"
 #include "BESSyntaxUserError.h"
 #include "BESUtil.h"
 #include "TheBESKeys.h"
@@ -162,6 +161,50 @@ BESCatalogUtils::BESCatalogUtils(const string &n, bool strict) : d_name(n), d_fo
     if (s_str == "yes" || s_str == "on" || s_str == "true") {
         d_follow_syms = true;
     }
+
+    compile_patterns();
+}
+
+/**
+ * @brief Compile the Include, Exclude and TypeMatch regular expressions
+ *
+ * These are tested against every entry of every directory the catalog lists,
+ * so they are compiled once here instead of for each test.
+ *
+ * @exception BESInternalError if any pattern is malformed
+ */
+void BESCatalogUtils::compile_patterns() {
+    for (const auto &reg: d_include) {
+        if (reg.empty()) continue;
+        try {
+            d_include_matcher.add(reg);
+        } catch (BESError &e) {
+            string serr = (string) "Unable to get catalog information, " + "malformed Catalog Include parameter " +
+                          "in bes configuration file around " + reg + ": " + e.get_message();
+            throw BESInternalError(serr, __FILE__, __LINE__);
+        }
+    }
+
+    for (const auto &reg: d_exclude) {
+        if (reg.empty()) continue;
+        try {
+            d_exclude_matcher.add(reg);
+        } catch (BESError &e) {
+            string serr = (string) "Unable to get catalog information, " + "malformed Catalog Exclude parameter " +
+                          "in bes configuration file around " + reg + ": " + e.get_message();
+            throw BESInternalError(serr, __FILE__, __LINE__);
+        }
+    }
+
+    for (const auto &match: d_match_list) {
+        try {
+            d_type_matcher.add(match.regex);
+        } catch (BESError &e) {
+            string serr = (string) "Unable to get catalog information, " + "malformed Catalog TypeMatch parameter " +
+                          "in bes configuration file around " + match.regex + ": " + e.get_message();
+            throw BESInternalError(serr, __FILE__, __LINE__);
+        }
+    }
 }
 
 /**
@@ -184,26 +227,9 @@ bool BESCatalogUtils::include(const string &inQuestion) const {
     if (d_include.size() == 0) {
         toInclude = true;
     } else {
-        list<string>::const_iterator i_iter = d_include.begin();
-        list<string>::const_iterator i_end = d_include.end();
-        for (; i_iter != i_end; i_iter++) {
-            string reg = *i_iter;
-            if (!reg.empty()) {
-                try {
-                    // must match exactly, meaning result is = to length of string
-                    // in question
-                    BESRegex reg_expr(reg.c_str());
-                    if (reg_expr.match(inQuestion.c_str(), inQuestion.size()) == static_cast<int>(inQuestion.size())) {
-                        toInclude = true;
-                    }
-                } catch (BESError &e) {
-                    string serr = (string) "Unable to get catalog information, " +
-                                  "malformed Catalog Include parameter " + "in bes configuration file around " + reg +
-                                  ": " + e.get_message();
-                    throw BESInternalError(serr, __FILE__, __LINE__);
-                }
-            }
-        }
+        // must match exactly, meaning result is = to length of string
+        // in question
+        toInclude = d_include_matcher.matches(inQuestion);
     }
 
     if (toInclude == true) {
@@ -223,24 +249,7 @@ bool BESCatalogUtils::include(const string &inQuestion) const {
  * @return True if the file/directory should be excluded, false if not.
  */
 bool BESCatalogUtils::exclude(const string &inQuestion) const {
-    list<string>::const_iterator e_iter = d_exclude.begin();
-    list<string>::const_iterator e_end = d_exclude.end();
-    for (; e_iter != e_end; e_iter++) {
-        string reg = *e_iter;
-        if (!reg.empty()) {
-            try {
-                BESRegex reg_expr(reg.c_str());
-                if (reg_expr.match(inQuestion.c_str(), inQuestion.size()) == static_cast<int>(inQuestion.size())) {
-                    return true;
-                }
-            } catch (BESError &e) {
-                string serr = (string) "Unable to get catalog information, " + "malformed Catalog Exclude parameter " +
-                              "in bes configuration file around " + reg + ": " + e.get_message();
-                throw BESInternalError(serr, __FILE__, __LINE__);
-            }
-        }
-    }
-    return false;
+    return d_exclude_matcher.matches(inQuestion);
 }
 
 /**
@@ -397,14 +406,8 @@ void BESCatalogUtils::display_entry(BESCatalogEntry *entry, BESInfo *info) {
  * processed by any handler.
  */
 std::string BESCatalogUtils::get_handler_name(const std::string &item) const {
-    for (auto i = match_list_begin(), e = match_list_end(); i != e; ++i) {
-        BESRegex expr((*i).regex.c_str());
-        if (expr.match(item.c_str(), item.size()) == (int)item.size()) {
-            return (*i).handler;
-        }
-    }
-
-    return "";
+    int i = d_type_matcher.first_match(item);
+    return (i == -1) ? "" : d_match_list[i].handler;
 }
 
 /**
@@ -420,13 +423,7 @@ std::string BESCatalogUtils::get_handler_name(const std::string &item) const {
  * @see get_handler_name()
  */
 bool BESCatalogUtils::is_data(const std::string &item) const {
-    for (auto i = match_list_begin(), e = match_list_end(); i != e; ++i) {
-        BESRegex expr((*i).regex.c_str());
-        if (expr.match(item.c_str(), item.size()) == (int)item.size()) {
-            return true;
-        }
-    }
-    return false;
+    return d_type_matcher.matches(item);
 }
 
 /**
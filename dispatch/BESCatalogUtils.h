@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "BESObj.h"
+#include "BESPatternMatcher.h"
 #include "BESUtil.h"
 
 class BESInfo;
@@ -78,6 +79,14 @@ private:
 
     std::vector<handler_regex> d_match_list; ///< The list of types & regexes
 
+    // The Include, Exclude and TypeMatch patterns compiled once, when the
+    // catalog is configured. d_type_matcher's patterns parallel d_match_list.
+    BESPatternMatcher d_include_matcher;
+    BESPatternMatcher d_exclude_matcher;
+    BESPatternMatcher d_type_matcher;
+
+    void compile_patterns();
+
     using match_citer = std::vector<handler_regex>::const_iterator;
     BESCatalogUtils::match_citer match_list_begin() const;
     BESCatalogUtils::match_citer match_list_end() const;
@@ -40,7 +40,7 @@
 
 #include "BESFSDir.h"
 #include "BESInternalError.h"
-#include "BESRegex.h"
+#include "BESPatternMatcher.h"
 
 using std::string;
 
@@ -90,6 +90,11 @@ void BESFSDir::loadDir() {
     DIR *dip;
     struct dirent *dit;
 
+    // Compile the file expression once, not once per directory entry.
+    BESPatternMatcher file_matcher;
+    if (_fileExpr != "")
+        file_matcher.add(_fileExpr);
+
     try {
         // open a directory stream
         // make sure the directory is valid and readable
@@ -128,9 +133,7 @@ void BESFSDir::loadDir() {
                         _dirList.emplace_back(fullPath);
                     } else {
                         if (_fileExpr != "") {
-                            BESRegex reg_expr(_fileExpr.c_str());
-                            int match_ret = reg_expr.match(dirEntry.c_str(), dirEntry.size());
-                            if (match_ret == static_cast<int>(dirEntry.size())) {
+                            if (file_matcher.matches(dirEntry)) {
                                 _fileList.emplace_back(_dirName, dirEntry);
                             }
                         } else {
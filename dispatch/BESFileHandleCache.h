@@ -0,0 +1,220 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESFileHandleCache_h
+#define I_BESFileHandleCache_h 1
+
+#include <ctime>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+
+#include <sys/stat.h>
+
+/**
+ * @brief A bounded LRU cache of open file handles (netCDF ids, HDF5 hid_t, ...)
+ *
+ * The data handlers open a file once for each variable they read. This keeps
+ * the library handles open so that the variables of a request, and later
+ * requests for the same file in the same beslistener, can reuse them.
+ *
+ * The cache is used in place of the library's open and close functions:
+ * get() returns a handle that is already open, if there is one, else the
+ * caller opens the file and passes the handle to add(). When the caller is
+ * done, it passes the handle to release(); if release() returns false the
+ * handle is not cached and the caller must close it itself.
+ *
+ * Entries are keyed by the pathname and the file's modification time, so a
+ * file that changes is reopened. A handle is closed (using the function
+ * passed to the constructor) when it is evicted, but never while it is in
+ * use; a handle that is in use when it would be evicted is closed when it
+ * is released. A cache with zero entries caches nothing.
+ *
+ * @note Handles must be opened read-only.
+ * @tparam Handle The type of the library's file handle
+ */
+template<typename Handle>
+class BESFileHandleCache {
+private:
+    struct Entry {
+        std::string path;
+        time_t mtime;
+        Handle handle;
+        unsigned int users;
+        bool stale;
+    };
+
+    std::mutex d_mutex;
+    std::list<Entry> d_entries;     // most recently used first
+    unsigned int d_max_entries;
+    std::function<void(Handle)> d_close;
+
+    static bool get_mtime(const std::string &path, time_t &mtime) {
+        struct stat buf;
+        if (stat(path.c_str(), &buf) != 0)
+            return false;
+        mtime = buf.st_mtime;
+        return true;
+    }
+
+    // Close unused handles, least recently used first, until there are at most
+    // d_max_entries. Handles in use are skipped. The caller must hold d_mutex.
+    void evict() {
+        auto it = d_entries.end();
+        while (d_entries.size() > d_max_entries && it != d_entries.begin()) {
+            --it;
+            if (it->users == 0) {
+                d_close(it->handle);
+                it = d_entries.erase(it);
+            }
+        }
+    }
+
+    friend class BESFileHandleCacheTest;
+
+public:
+    /**
+     * @brief Make a new handle cache
+     * @param max_entries Keep at most this many handles open. Zero disables the cache.
+     * @param close The function used to close a handle
+     */
+    BESFileHandleCache(unsigned int max_entries, std::function<void(Handle)> close)
+        : d_max_entries(max_entries), d_close(std::move(close)) {}
+
+    BESFileHandleCache(const BESFileHandleCache &) = delete;
+    BESFileHandleCache &operator=(const BESFileHandleCache &) = delete;
+
+    /// Closes all the handles, including those that are still in use.
+    ~BESFileHandleCache() {
+        for (auto &entry: d_entries)
+            d_close(entry.handle);
+    }
+
+    /**
+     * @brief Get an open handle for a file
+     * @param path The pathname of the file
+     * @param handle Value-result parameter; the handle if one is cached
+     * @return True if a handle was found. The caller must pass it to release().
+     */
+    bool get(const std::string &path, Handle &handle) {
+        if (d_max_entries == 0)
+            return false;
+
+        time_t mtime = 0;
+        bool have_mtime = get_mtime(path, mtime);
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        for (auto it = d_entries.begin(); it != d_entries.end(); ++it) {
+            if (it->path != path || it->stale)
+                continue;
+
+            if (!have_mtime || it->mtime != mtime) {
+                // The file changed (or is gone); don't use this handle again.
+                it->stale = true;
+                if (it->users == 0) {
+                    d_close(it->handle);
+                    d_entries.erase(it);
+                }
+                return false;
+            }
+
+            it->users++;
+            d_entries.splice(d_entries.begin(), d_entries, it);
+            handle = it->handle;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Add a handle the caller just opened
+     *
+     * The handle is in use by the caller; it must be passed to release().
+     * If the cache is disabled or the file cannot be stat'd, the handle is
+     * not added and release() will return false for it.
+     *
+     * @param path The pathname of the file
+     * @param handle The open handle
+     */
+    void add(const std::string &path, Handle handle) {
+        if (d_max_entries == 0)
+            return;
+
+        time_t mtime = 0;
+        if (!get_mtime(path, mtime))
+            return;
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_entries.push_front(Entry{path, mtime, handle, 1, false});
+        evict();
+    }
+
+    /**
+     * @brief The caller is done with a handle
+     * @param handle A handle from get() or add()
+     * @return True if the handle belongs to the cache, false if the caller must close it
+     */
+    bool release(Handle handle) {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        for (auto it = d_entries.begin(); it != d_entries.end(); ++it) {
+            if (!(it->handle == handle) || it->users == 0)
+                continue;
+
+            it->users--;
+            if (it->users == 0 && it->stale) {
+                d_close(it->handle);
+                d_entries.erase(it);
+            }
+            else {
+                evict();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /// Close all the handles that are not in use.
+    void clear() {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        for (auto it = d_entries.begin(); it != d_entries.end();) {
+            if (it->users == 0) {
+                d_close(it->handle);
+                it = d_entries.erase(it);
+            }
+            else {
+                it->stale = true;
+                ++it;
+            }
+        }
+    }
+
+    /// @return The number of open handles in the cache
+    unsigned int size() {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_entries.size();
+    }
+};
+
+#endif // I_BESFileHandleCache_h
@@ -65,6 +65,8 @@
 #include "ServerAdministrator.h"
 
 #include "BESLog.h"
+#include "BESMetrics.h"
+#include "BESTrace.h"
 
 // If not defined, this is false (source code file names are logged). jhrg 10/4/18
 #define EXCLUDE_FILE_INFO_FROM_LOG "BES.DoNotLogSourceFilenames"
@@ -364,6 +366,7 @@ int BESInterface::execute_request(const string &from) {
     // transmit of the request then we can transmit the exception/error
     // information.
     int status = 0; // save the return status from exception_manager() and return that.
+    auto request_start = chrono::steady_clock::now();
     try {
         VERBOSE(d_dhi_ptr->data[REQUEST_FROM] + " request received");
 
@@ -385,6 +388,12 @@ int BESInterface::execute_request(const string &from) {
         RequestServiceTimer::TheTimer()->start(std::chrono::seconds{d_bes_timeout});
         BESDEBUG("request_timer", prolog << RequestServiceTimer::TheTimer()->dump() << endl);
 
+        // Record the spans of this request if the client asked for a trace. A
+        // context command in the request can also ask for one, so
+        // execute_data_request_plan() checks again before each command.
+        BESTrace::begin_request(BESLog::TheLog()->get_request_id());
+        BES_TRACE_SPAN("dispatch", "request");
+
         // This method (execute_data_request_plan()) does two key things:
         // Calls the request handler to make a response object' (the C++
         // object that will hold the response) and then calls the transmitter
@@ -421,6 +430,21 @@ int BESInterface::execute_request(const string &from) {
         status = handleException(ex, *d_dhi_ptr);
     }
 
+    // d_dhi_ptr now refers to the last command of the request, which is the
+    // one that made the response.
+    BESMetrics *metrics = BESMetrics::TheMetrics();
+    if (metrics->enabled()) {
+        string handler;
+        if (!d_dhi_ptr->containers.empty() && d_dhi_ptr->containers.front())
+            handler = d_dhi_ptr->containers.front()->get_container_type();
+        string labels = BESMetrics::label("action", d_dhi_ptr->action) + "," + BESMetrics::label("handler", handler);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - request_start;
+        metrics->observe("bes_request_duration_seconds", elapsed.count(), labels);
+        metrics->add("bes_requests_total", 1, labels + "," + BESMetrics::label("status", status == 0 ? "ok" : "error"));
+    }
+
+    BESTrace::end_request();
+
     return status;
 }
 
@@ -32,6 +32,8 @@
 
 #include "config.h"
 
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -40,12 +42,14 @@
 #include "BESDebug.h"
 #include "BESInternalFatalError.h"
 #include "BESLog.h"
+#include "BESLogWriter.h"
 #include "BESUtil.h"
 #include "TheBESKeys.h"
 
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#include <syslog.h>
 
 #define MODULE "bes"
 #define prolog std::string("BESLog::").append(__func__).append("() - ")
@@ -156,6 +160,18 @@ BESLog::BESLog() {
     d_use_unix_time = found && (BESUtil::lowercase(s) == "true");
     BESDEBUG(MODULE, prolog << "d_use_unix_time: " << (d_use_unix_time ? "true" : "false") << endl);
 
+    d_use_json = BESUtil::lowercase(TheBESKeys::read_string_key("BES.LogFormat", "text")) == "json";
+    d_use_syslog = TheBESKeys::read_bool_key("BES.LogSyslog", false);
+    if (d_use_syslog)
+        openlog("bes", LOG_PID, LOG_DAEMON);
+
+    if (TheBESKeys::read_bool_key("BES.LogAsync", false)) {
+        d_writer.reset(new BESLogWriter(d_file_name, d_use_syslog,
+                                        TheBESKeys::read_ulong_key("BES.LogAsyncBufferRecords", 8192)));
+    }
+    BESDEBUG(MODULE, prolog << "async: " << (d_writer ? "true" : "false") << ", json: " << (d_use_json ? "true" : "false")
+                            << ", syslog: " << (d_use_syslog ? "true" : "false") << endl);
+
     // Set the pid and build the log rord prolog base...
     update_pid();
 }
@@ -165,6 +181,7 @@ BESLog::BESLog() {
  * Cleans up the logging mechanism by closing the log file.
  */
 BESLog::~BESLog() {
+    d_writer.reset();
     d_file_buffer->close();
     delete d_file_buffer;
     d_file_buffer = nullptr;
@@ -187,43 +204,177 @@ pid_t BESLog::update_pid() {
  * However, if BES.LogUnixTime=true appears in the BES configuration then time
  * will be expressed as a numeric unix time value.
  *
- * @return The string: time + mark + pid + mark
+ * @return The string: time + mark + pid + mark; only the time for BES.LogFormat=json
  */
 std::string BESLog::log_record_begin() const {
-    string log_record_prolog;
+    // strftime() costs more than the rest of a record and the result only
+    // changes once a second, so keep the last one made by this thread (and
+    // the format it was made in).
+    thread_local time_t last_time = -1;
+    thread_local int last_format = -1;
+    thread_local string last_stamp;
 
     time_t now;
     time(&now);
-    if (d_use_unix_time) {
-        log_record_prolog = std::to_string(now);
-    } else {
-        char buf[sizeof "YYYY-MM-DDTHH:MM:SS zones"];
-        tm date_time{};
-        if (!d_use_local_time) {
-            gmtime_r(&now, &date_time);
+    const int format = (d_use_unix_time ? 1 : 0) | (d_use_local_time ? 2 : 0);
+    if (now != last_time || format != last_format) {
+        if (d_use_unix_time) {
+            last_stamp = std::to_string(now);
         } else {
-            localtime_r(&now, &date_time);
+            char buf[sizeof "YYYY-MM-DDTHH:MM:SS zones"];
+            tm date_time{};
+            if (!d_use_local_time) {
+                gmtime_r(&now, &date_time);
+            } else {
+                localtime_r(&now, &date_time);
+            }
+            (void)strftime(buf, sizeof buf, "%FT%T %Z", &date_time);
+            last_stamp = buf;
         }
-        (void)strftime(buf, sizeof buf, "%FT%T %Z", &date_time);
-        log_record_prolog = buf;
+        last_time = now;
+        last_format = format;
     }
 
-    log_record_prolog += d_log_record_prolog_base + get_request_id() + mark;
-    return log_record_prolog;
+    if (d_use_json)
+        return last_stamp;
+
+    return last_stamp + d_log_record_prolog_base + get_request_id() + mark;
 }
 
 /**
- * @brief Writes msg to a log record with type lrt.
+ * @brief Append \arg value to \arg out as a JSON string
+ */
+static void append_json_string(string &out, const string &value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[sizeof "\\u0000"];
+                snprintf(buf, sizeof buf, "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Build a complete log record, ending with a newline
+ *
  * @param lrt The log record type
  * @param msg The message to be logged.
+ * @param file If not null, make a trace record with this file and \arg line
+ * @param line The line number for a trace record
  */
-void BESLog::log_record(const std::string &lrt, const std::string &msg) const {
+std::string BESLog::format_record(const std::string &lrt, const std::string &msg, const std::string *file,
+                                  int line) const {
+    string record;
+    record.reserve(msg.size() + 128);
+
+    if (d_use_json) {
+        string type = file ? "trace-" + lrt : lrt;
+        string text = (!msg.empty() && msg.back() == '\n') ? msg.substr(0, msg.size() - 1) : msg;
+
+        record += "{\"time\":";
+        if (d_use_unix_time)
+            record += log_record_begin();
+        else
+            append_json_string(record, log_record_begin());
+        record += ",\"instance\":";
+        append_json_string(record, d_instance_id);
+        record += ",\"pid\":";
+        record += d_pid;
+        record += ",\"request\":";
+        append_json_string(record, get_request_id());
+        record += ",\"type\":";
+        append_json_string(record, type);
+        if (file) {
+            record += ",\"file\":";
+            append_json_string(record, *file);
+            record += ",\"line\":";
+            record += to_string(line);
+        }
+        record += ",\"message\":";
+        append_json_string(record, text);
+        record += "}\n";
+        return record;
+    }
 
-    *d_file_buffer << log_record_begin() << lrt << mark << msg;
+    record = log_record_begin();
+    if (file)
+        record += "trace-";
+    record += lrt;
+    record += mark;
+    if (file) {
+        record += *file;
+        record += mark;
+        record += to_string(line);
+        record += mark;
+    }
+    record += msg;
     if (!msg.empty() && msg.back() != '\n')
-        *d_file_buffer << "\n";
+        record += "\n";
+    return record;
+}
+
+/**
+ * @brief Send a record built by format_record() to its destination
+ *
+ * Error records are on their way to the file or syslog when this returns,
+ * even if logging is asynchronous.
+ */
+void BESLog::write_record(const std::string &lrt, std::string &&record) const {
+    int priority = LOG_INFO;
+    if (lrt == ERROR_LOG_TYPE_KEY)
+        priority = LOG_ERR;
+    else if (lrt == VERBOSE_LOG_TYPE_KEY)
+        priority = LOG_DEBUG;
+
+    if (d_writer) {
+        // Report earlier losses once there is room again. If the report does
+        // not fit either, it is counted and reported with the next record.
+        uint64_t dropped = d_writer->write(priority, std::move(record)) ? d_writer->take_unreported_drops() : 0;
+        if (dropped) {
+            d_writer->write(LOG_WARNING, format_record(INFO_LOG_TYPE_KEY,
+                                                       "Dropped " + to_string(dropped) +
+                                                           " log records because the log buffer was full.",
+                                                       nullptr, 0));
+        }
 
-    *d_file_buffer << flush;
+        if (priority == LOG_ERR)
+            d_writer->flush();
+    } else if (d_use_syslog) {
+        syslog(priority, "%s", record.c_str());
+    } else {
+        *d_file_buffer << record << std::flush;
+    }
+}
+
+/**
+ * @brief Writes msg to a log record with type lrt.
+ * @param lrt The log record type
+ * @param msg The message to be logged.
+ */
+void BESLog::log_record(const std::string &lrt, const std::string &msg) const {
+    write_record(lrt, format_record(lrt, msg, nullptr, 0));
 }
 
 /**
@@ -233,15 +384,24 @@ void BESLog::log_record(const std::string &lrt, const std::string &msg) const {
  */
 void BESLog::trace_log_record(const std::string &lrt, const std::string &msg, const std::string &file,
                               const int line) const {
+    write_record(lrt, format_record(lrt, msg, &file, line));
+}
 
-    *d_file_buffer << log_record_begin() << "trace-" << lrt << mark;
-    *d_file_buffer << file << mark << line << mark << msg;
-    if (!msg.empty() && msg.back() != '\n')
-        *d_file_buffer << "\n";
-
-    *d_file_buffer << flush;
+/**
+ * @brief Wait until every record logged so far has been written
+ */
+void BESLog::flush() const {
+    if (d_writer)
+        d_writer->flush();
+    else
+        d_file_buffer->flush();
 }
 
+/**
+ * @brief The number of records lost because the asynchronous log queue was full
+ */
+uint64_t BESLog::dropped_records() const { return d_writer ? d_writer->dropped() : 0; }
+
 /** @brief dumps information about this object
  *
  * Displays the pointer value of this instance along with information about
@@ -261,6 +421,11 @@ void BESLog::dump(ostream &strm) const {
     strm << BESIndent::LMarg << "    d_verbose: " << (d_verbose ? "enabled" : "disable") << "\n";
     strm << BESIndent::LMarg << "d_instance_id: " << d_instance_id << "\n";
     strm << BESIndent::LMarg << "        d_pid: " << d_pid << "\n";
+    strm << BESIndent::LMarg << "        async: " << (d_writer ? "enabled" : "disabled") << "\n";
+    if (d_writer) {
+        strm << BESIndent::LMarg << "      written: " << d_writer->written() << "\n";
+        strm << BESIndent::LMarg << "      dropped: " << d_writer->dropped() << "\n";
+    }
     BESIndent::UnIndent();
 }
 
@@ -275,6 +440,8 @@ void BESLog::set_request_id(const std::string &id) {
 BESLog *BESLog::TheLog() {
     if (d_instance == nullptr) {
         d_instance = new BESLog;
+        // The instance is never deleted; write what is still queued when the process exits.
+        atexit([]() { d_instance->flush(); });
     }
     return d_instance;
 }
@@ -35,7 +35,9 @@
 
 #include "config.h"
 
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "BESObj.h"
@@ -139,8 +141,17 @@
  * BESLog provides a static method for access to a single BESLog object,
  * TheLog.
  *
+ * With BES.LogAsync=yes, the calling thread only formats the record and
+ * queues it; a BESLogWriter thread writes the queued records in batches.
+ * Records that do not fit in the queue (BES.LogAsyncBufferRecords per
+ * thread) are dropped and the number dropped is logged. Error records are
+ * written before error() returns. BES.LogFormat=json writes each record as
+ * a JSON object and BES.LogSyslog=yes sends records to syslog(3).
+ *
  * @see TheBESKeys
  */
+class BESLogWriter;
+
 class BESLog : public BESObj {
 private:
     static BESLog *d_instance;
@@ -161,6 +172,15 @@ private:
     // Use the UNIX time value as the log time.
     bool d_use_unix_time = false;
 
+    // Write JSON objects instead of BESLog::mark separated fields.
+    bool d_use_json = false;
+
+    // Send records to syslog(3) instead of the log file.
+    bool d_use_syslog = false;
+
+    // Queues records for a background thread; null unless BES.LogAsync=yes.
+    std::unique_ptr<BESLogWriter> d_writer;
+
     const char *REQUEST_LOG_TYPE_KEY = "request";
     const char *INFO_LOG_TYPE_KEY = "info";
     const char *ERROR_LOG_TYPE_KEY = "error";
@@ -177,6 +197,10 @@ protected:
     void trace_log_record(const std::string &record_type, const std::string &msg, const std::string &file,
                           int line) const;
 
+    std::string format_record(const std::string &record_type, const std::string &msg, const std::string *file,
+                              int line) const;
+    void write_record(const std::string &record_type, std::string &&record) const;
+
 public:
     ~BESLog() override;
 
@@ -285,6 +309,10 @@ public:
     void set_request_id(const std::string &id);
     std::string get_request_id() const { return request_id; }
 
+    void flush() const;
+
+    uint64_t dropped_records() const;
+
     void dump(std::ostream &strm) const override;
 
     static BESLog *TheLog();
@@ -0,0 +1,310 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "BESInternalFatalError.h"
+#include "BESLogWriter.h"
+
+using namespace std;
+
+#define prolog std::string("BESLogWriter::").append(__func__).append("() - ")
+
+// How long the writer thread waits before it looks at the rings again.
+static const chrono::milliseconds writer_interval(100);
+
+// The instance that the fork handlers stop and restart.
+static BESLogWriter *s_active = nullptr;
+
+// Each instance gets a distinct id so a thread can tell that the ring it holds
+// belongs to an instance that has been deleted.
+static atomic<uint64_t> s_next_id{1};
+
+namespace {
+struct ThreadRing {
+    uint64_t owner = 0;
+    shared_ptr<BESLogWriter::Ring> ring;
+
+    ~ThreadRing() {
+        if (ring)
+            ring->closed = true;
+    }
+};
+
+thread_local ThreadRing t_ring;
+} // namespace
+
+BESLogWriter::Ring::Ring(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+}
+
+/**
+ * @brief Start writing records to \arg file_name or syslog
+ *
+ * @param file_name Append records to this file
+ * @param use_syslog If true, send records to syslog(3) instead
+ * @param ring_records The number of records each thread may have waiting;
+ * rounded up to a power of two.
+ * @throw BESInternalFatalError if the log file cannot be opened
+ */
+BESLogWriter::BESLogWriter(const string &file_name, bool use_syslog, size_t ring_records)
+    : d_id(s_next_id++), d_file_name(file_name), d_use_syslog(use_syslog), d_ring_records(ring_records) {
+    if (!d_use_syslog) {
+        d_fd = open(d_file_name.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (d_fd < 0)
+            throw BESInternalFatalError(prolog + "Cannot open log file " + d_file_name + ": " + strerror(errno),
+                                        __FILE__, __LINE__);
+    }
+
+    static once_flag fork_handlers;
+    call_once(fork_handlers, []() { pthread_atfork(prepare_fork, parent_after_fork, child_after_fork); });
+
+    s_active = this;
+    start();
+}
+
+/**
+ * @brief Write the records still queued and stop the writer thread
+ */
+BESLogWriter::~BESLogWriter() {
+    if (s_active == this)
+        s_active = nullptr;
+    stop();
+    if (d_fd >= 0)
+        close(d_fd);
+}
+
+/**
+ * @brief The calling thread's ring, made and registered on first use
+ */
+BESLogWriter::Ring *BESLogWriter::thread_ring() {
+    if (t_ring.owner != d_id || !t_ring.ring) {
+        if (t_ring.ring)
+            t_ring.ring->closed = true;
+
+        auto ring = make_shared<Ring>(d_ring_records);
+        {
+            lock_guard<mutex> lock(d_lock);
+            d_rings.push_back(ring);
+        }
+        t_ring.owner = d_id;
+        t_ring.ring = ring;
+    }
+    return t_ring.ring.get();
+}
+
+/**
+ * @brief Queue a record
+ *
+ * If the ring is full, the record is dropped unless it is an error (LOG_ERR
+ * or more severe); for an error, wait until the ring has been emptied.
+ *
+ * @param priority The syslog(3) priority of the record
+ * @param text The record, ending with a newline. Moved from.
+ * @return False if the record was dropped because the ring was full
+ */
+bool BESLogWriter::write(int priority, string &&text) {
+    Ring *ring = thread_ring();
+
+    size_t head = ring->head.load(memory_order_relaxed);
+    if (head - ring->tail.load(memory_order_acquire) > ring->mask && priority <= LOG_ERR)
+        flush();
+    if (head - ring->tail.load(memory_order_acquire) > ring->mask) {
+        d_dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    Record &slot = ring->slots[head & ring->mask];
+    slot.priority = priority;
+    slot.text = std::move(text);
+    ring->head.store(head + 1, memory_order_release);
+
+    // Don't wait for the timer when a ring is filling quickly.
+    if (((head + 1) & (ring->mask >> 1)) == 0) {
+        d_work.store(true, memory_order_relaxed);
+        d_wake.notify_one();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wait until the records queued by any thread so far are written
+ */
+void BESLogWriter::flush() {
+    unique_lock<mutex> lock(d_lock);
+    if (!d_thread.joinable()) {
+        string batch;
+        drain(batch);
+        return;
+    }
+
+    uint64_t ticket = ++d_flush_requested;
+    d_wake.notify_one();
+    d_flushed.wait(lock, [this, ticket]() { return d_flush_done >= ticket || d_stop; });
+}
+
+/**
+ * @brief Get the number of records dropped since the last call
+ *
+ * BESLog calls this after each record it queues so that the loss is recorded
+ * in the log itself. Only one caller sees a given drop.
+ */
+uint64_t BESLogWriter::take_unreported_drops() {
+    uint64_t dropped = d_dropped.load(memory_order_relaxed);
+    uint64_t reported = d_dropped_reported.load(memory_order_relaxed);
+    if (dropped == reported || !d_dropped_reported.compare_exchange_strong(reported, dropped))
+        return 0;
+    return dropped - reported;
+}
+
+/**
+ * @brief Empty every ring and write the records
+ *
+ * Call with d_lock held. Rings of threads that have exited are removed once
+ * they are empty.
+ */
+void BESLogWriter::drain(string &batch) {
+    uint64_t count = 0;
+    for (auto &ring : d_rings) {
+        // Read 'closed' first; once it is set, the thread has queued its last record.
+        bool closed = ring->closed.load(memory_order_acquire);
+        size_t tail = ring->tail.load(memory_order_relaxed);
+        size_t head = ring->head.load(memory_order_acquire);
+        for (; tail != head; ++tail) {
+            Record &record = ring->slots[tail & ring->mask];
+            if (d_use_syslog) {
+                size_t len = record.text.size();
+                if (len && record.text[len - 1] == '\n')
+                    --len;
+                syslog(record.priority, "%.*s", (int)len, record.text.c_str());
+            } else {
+                batch += record.text;
+            }
+            record.text.clear();
+            ++count;
+        }
+        ring->tail.store(tail, memory_order_release);
+        if (closed)
+            ring.reset();
+    }
+    d_rings.erase(remove(d_rings.begin(), d_rings.end(), nullptr), d_rings.end());
+
+    const char *data = batch.data();
+    size_t left = batch.size();
+    while (left > 0) {
+        ssize_t n = ::write(d_fd, data, left);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break; // There is nowhere to report this.
+        }
+        data += n;
+        left -= n;
+    }
+    batch.clear();
+
+    d_written.fetch_add(count, memory_order_relaxed);
+}
+
+void BESLogWriter::run() {
+    string batch;
+    unique_lock<mutex> lock(d_lock);
+    for (;;) {
+        d_wake.wait_for(lock, writer_interval, [this]() {
+            return d_stop || d_flush_requested != d_flush_done || d_work.load(memory_order_relaxed);
+        });
+        d_work.store(false, memory_order_relaxed);
+        uint64_t requested = d_flush_requested;
+        bool stop = d_stop;
+
+        drain(batch);
+
+        d_flush_done = requested;
+        d_flushed.notify_all();
+        if (stop)
+            break;
+    }
+}
+
+void BESLogWriter::start() {
+    lock_guard<mutex> lock(d_lock);
+    d_stop = false;
+    d_thread = thread(&BESLogWriter::run, this);
+}
+
+// The writer thread drains the rings once more before it exits.
+void BESLogWriter::stop() {
+    {
+        lock_guard<mutex> lock(d_lock);
+        d_stop = true;
+    }
+    d_wake.notify_one();
+    if (d_thread.joinable())
+        d_thread.join();
+}
+
+// Write everything queued and stop the thread so the child does not inherit
+// records the parent will also write. Hold d_lock across the fork so it is in
+// a known state in the child.
+void BESLogWriter::prepare_fork() {
+    if (s_active) {
+        s_active->stop();
+        s_active->d_lock.lock();
+    }
+}
+
+void BESLogWriter::parent_after_fork() {
+    if (s_active) {
+        s_active->d_lock.unlock();
+        s_active->start();
+    }
+}
+
+// Only the thread that called fork() exists in the child; the rings of the
+// other threads will never be filled or closed.
+void BESLogWriter::child_after_fork() {
+    if (s_active) {
+        BESLogWriter *writer = s_active;
+        shared_ptr<Ring> mine = (t_ring.owner == writer->d_id) ? t_ring.ring : nullptr;
+        writer->d_rings.clear();
+        if (mine)
+            writer->d_rings.push_back(mine);
+        writer->d_lock.unlock();
+        writer->start();
+    }
+}
@@ -0,0 +1,123 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESLogWriter_h
+#define I_BESLogWriter_h 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Write log records from a background thread
+ *
+ * BESLog hands each formatted record to write(), which moves it into a ring
+ * buffer owned by the calling thread and returns. No lock is taken and no
+ * system call is made. A writer thread empties the rings of all threads at
+ * least every 100ms and writes what it found with a single write(2) to the
+ * log file (opened with O_APPEND, so records from other BES processes are not
+ * mixed into a line), or sends each record to syslog(3).
+ *
+ * When a thread's ring is full the record is dropped and counted; the writer
+ * only makes a request wait for the disk to keep an error record. Call
+ * flush() to wait until all records queued so far have been written, e.g.,
+ * after an error record.
+ *
+ * The BES forks a process for each client connection. A writer thread does not
+ * survive fork(2), and records still in the rings would be written by both
+ * processes, so pthread_atfork(3) handlers drain the rings and stop the thread
+ * before a fork and start it again in both processes after it. Only one
+ * instance should exist at a time.
+ */
+class BESLogWriter {
+public:
+    struct Record {
+        int priority = 0; ///< syslog(3) priority
+        std::string text; ///< The record, ending with a newline
+    };
+
+    struct Ring {
+        explicit Ring(size_t capacity);
+        std::vector<Record> slots;
+        size_t mask;
+        std::atomic<size_t> head{0}; ///< Next slot the owning thread will fill
+        std::atomic<size_t> tail{0}; ///< Next slot the writer thread will empty
+        std::atomic<bool> closed{false}; ///< The owning thread has exited
+    };
+
+private:
+    uint64_t d_id;
+    std::string d_file_name;
+    bool d_use_syslog;
+    size_t d_ring_records;
+    int d_fd = -1;
+
+    std::atomic<uint64_t> d_dropped{0};
+    std::atomic<uint64_t> d_dropped_reported{0};
+    std::atomic<uint64_t> d_written{0};
+    std::atomic<bool> d_work{false}; // a ring is filling; drain without waiting for the timer
+
+    std::mutex d_lock; // guards the members below
+    std::condition_variable d_wake;
+    std::condition_variable d_flushed;
+    std::vector<std::shared_ptr<Ring>> d_rings;
+    uint64_t d_flush_requested = 0;
+    uint64_t d_flush_done = 0;
+    bool d_stop = false;
+    std::thread d_thread;
+
+    Ring *thread_ring();
+    void drain(std::string &batch);
+    void run();
+    void start();
+    void stop();
+
+    static void prepare_fork();
+    static void parent_after_fork();
+    static void child_after_fork();
+
+public:
+    BESLogWriter(const std::string &file_name, bool use_syslog, size_t ring_records);
+
+    BESLogWriter(const BESLogWriter &) = delete;
+    BESLogWriter &operator=(const BESLogWriter &) = delete;
+
+    virtual ~BESLogWriter();
+
+    bool write(int priority, std::string &&text);
+    void flush();
+
+    /// @brief Records dropped because a ring buffer was full
+    uint64_t dropped() const { return d_dropped; }
+    /// @brief Records handed to the log file or syslog
+    uint64_t written() const { return d_written; }
+
+    uint64_t take_unreported_drops();
+};
+
+#endif // I_BESLogWriter_h
@@ -0,0 +1,446 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "BESDebug.h"
+#include "BESIndent.h"
+#include "BESLog.h"
+#include "BESMemoryLedger.h"
+#include "BESMetrics.h"
+#include "BESSyntaxUserError.h"
+#include "BESTimeoutError.h"
+#include "RequestServiceTimer.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+#define MODULE "memory_ledger"
+#define PROLOG "BESMemoryLedger::" << __func__ << "() - "
+
+constexpr size_t BESMemoryLedger::max_reservations;
+
+BESMemoryLedger *BESMemoryLedger::d_instance = nullptr;
+
+// How many times lock() spins between checks that the lock's owner is alive
+static const unsigned long lock_check_spins = 1024;
+
+// How long a queued request sleeps before it looks for free memory again
+static const chrono::milliseconds queue_poll_interval(50);
+
+static const char *const admissions_metric = "bes_memory_admissions_total";
+
+// A pid that kill() cannot find belongs to a process that has exited (or
+// been killed) without returning what it held.
+static bool is_dead(pid_t pid) {
+    return kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+/**
+ * @brief When a process started, in clock ticks since boot
+ *
+ * This is field 22 of /proc/<pid>/stat. Pids are reused, but a pid and its
+ * start time name one process.
+ *
+ * @param pid The process
+ * @return The start time, or zero if it cannot be read (the process has
+ * exited or there is no /proc)
+ */
+uint64_t BESMemoryLedger::process_start_time(pid_t pid) {
+    ifstream stat_file("/proc/" + to_string(pid) + "/stat");
+    string stat;
+    if (!getline(stat_file, stat))
+        return 0;
+
+    // The command name (field 2) is in parentheses and may hold spaces
+    const auto paren = stat.rfind(')');
+    if (paren == string::npos)
+        return 0;
+
+    istringstream fields(stat.substr(paren + 1));
+    string field;
+    for (int i = 3; i < 22; ++i)
+        fields >> field;
+    uint64_t start = 0;
+    fields >> start;
+    return start;
+}
+
+BESMemoryLedger::BESMemoryLedger() {
+    const unsigned long budget_mb = TheBESKeys::read_ulong_key("BES.MemoryLedger.budget", 0);
+    if (budget_mb == 0)
+        return;
+
+    void *region = mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        ERROR_LOG(string("Could not allocate memory for the memory ledger, requests will not be limited: ")
+                  + strerror(errno));
+        return;
+    }
+
+    d_table = new (region) Table();
+    d_budget = budget_mb * 1024ULL * 1024ULL;
+    d_wait_seconds = TheBESKeys::read_ulong_key("BES.MemoryLedger.wait", 30);
+
+    BESDEBUG(MODULE, PROLOG << "Budget: " << d_budget << " bytes, wait: " << d_wait_seconds << "s" << endl);
+}
+
+BESMemoryLedger::~BESMemoryLedger() {
+    if (d_table)
+        munmap(d_table, sizeof(Table));
+}
+
+/**
+ * @brief Get the memory ledger
+ *
+ * Call this once before the BES forks its client-handling processes so they
+ * share the ledger.
+ */
+BESMemoryLedger *BESMemoryLedger::TheLedger() {
+    if (d_instance == nullptr)
+        d_instance = new BESMemoryLedger();
+    return d_instance;
+}
+
+/// @return The start time of this process; read once per process and thread
+uint64_t BESMemoryLedger::own_start_time() {
+    thread_local pid_t pid = 0;
+    thread_local uint64_t start = 0;
+    if (getpid() != pid) {
+        pid = getpid();
+        start = process_start_time(pid);
+    }
+    return start;
+}
+
+// True if 'pid', which started at 'start' (zero if not known), has exited.
+// A live process with that pid but another start time reused the pid.
+static bool has_exited(pid_t pid, uint64_t start) {
+    return is_dead(pid) || (start != 0 && BESMemoryLedger::process_start_time(pid) != start);
+}
+
+// The lock is only held for a pass over the table, so spin. Now and then,
+// check the process holding it; if that process has died, take the lock over.
+void BESMemoryLedger::lock() {
+    const pid_t me = getpid();
+    for (unsigned long spins = 1;; ++spins) {
+        pid_t owner = 0;
+        if (d_table->lock.compare_exchange_weak(owner, me, memory_order_acquire)) {
+            d_table->lock_start.store(own_start_time(), memory_order_relaxed);
+            return;
+        }
+        if (spins % lock_check_spins == 0 && owner != 0 && owner != me
+            && has_exited(owner, d_table->lock_start.load(memory_order_relaxed))
+            && d_table->lock.compare_exchange_strong(owner, me, memory_order_acquire)) {
+            d_table->lock_start.store(own_start_time(), memory_order_relaxed);
+            BESDEBUG(MODULE, PROLOG << "Took the lock from process " << owner << ", which has exited" << endl);
+            return;
+        }
+        sched_yield();
+    }
+}
+
+void BESMemoryLedger::unlock() {
+    // Clear the start time first; until the next owner sets it, only kill() can find the owner dead
+    d_table->lock_start.store(0, memory_order_relaxed);
+    d_table->lock.store(0, memory_order_release);
+}
+
+/**
+ * @brief Sum the reservations; call with the table locked
+ *
+ * The total is not kept in the table, so no reservation can be counted twice
+ * or lost when a process dies while it holds the lock.
+ *
+ * @param free_slot If not null, value-result parameter; the first free slot,
+ * or max_reservations if there is none
+ * @return The memory, in bytes, reserved by all the BES processes
+ */
+uint64_t BESMemoryLedger::reserved_locked(size_t *free_slot) const {
+    if (free_slot)
+        *free_slot = max_reservations;
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < max_reservations; ++i) {
+        const Slot &s = d_table->slots[i];
+        if (s.pid != 0)
+            total += s.bytes;
+        else if (free_slot && *free_slot == max_reservations)
+            *free_slot = i;
+    }
+    return total;
+}
+
+/**
+ * @brief Free the slots of processes that have exited
+ *
+ * Checking a process reads /proc, so the owners are copied out of the table
+ * and checked without the lock. A slot is freed only if it still holds the
+ * reservation that was checked.
+ *
+ * @return True if any slot was freed
+ */
+bool BESMemoryLedger::reclaim() {
+    vector<Slot> owners;
+    vector<size_t> indices;
+    lock();
+    for (size_t i = 0; i < max_reservations; ++i) {
+        if (d_table->slots[i].pid != 0) {
+            owners.push_back(d_table->slots[i]);
+            indices.push_back(i);
+        }
+    }
+    unlock();
+
+    vector<size_t> dead;
+    for (size_t i = 0; i < owners.size(); ++i) {
+        if (has_exited(owners[i].pid, owners[i].start))
+            dead.push_back(i);
+    }
+    if (dead.empty())
+        return false;
+
+    lock();
+    for (size_t i : dead) {
+        Slot &s = d_table->slots[indices[i]];
+        if (s.pid == owners[i].pid && s.start == owners[i].start) {
+            BESDEBUG(MODULE, PROLOG << "Returning " << s.bytes << " bytes held by process " << s.pid
+                     << ", which has exited" << endl);
+            s = Slot();
+        }
+    }
+    unlock();
+    return true;
+}
+
+/**
+ * @brief Reserve memory if the budget has room for it
+ *
+ * If the memory is not free, reservations held by processes that have
+ * exited are returned and the budget is checked again.
+ *
+ * @param bytes The memory to reserve
+ * @param slot Value-result parameter; the slot that holds the reservation
+ * @return True if the memory was reserved
+ */
+bool BESMemoryLedger::try_reserve(uint64_t bytes, size_t &slot) {
+    const pid_t me = getpid();
+    const uint64_t start = own_start_time();
+
+    bool reserved = false;
+    uint64_t total = 0;
+    // Only look for processes that have exited when the request does not fit
+    for (int pass = 0; pass < 2 && !reserved; ++pass) {
+        if (pass == 1 && !reclaim())
+            break;
+
+        lock();
+        size_t free_slot = max_reservations;
+        total = reserved_locked(&free_slot);
+        reserved = free_slot != max_reservations && total + bytes <= d_budget;
+        if (reserved) {
+            Slot &s = d_table->slots[free_slot];
+            s.pid = me;
+            s.start = start;
+            s.bytes = bytes;
+            total += bytes;
+            slot = free_slot;
+        }
+        unlock();
+    }
+
+    BESMetrics::TheMetrics()->gauge_set("bes_memory_reserved_bytes", static_cast<int64_t>(total));
+    return reserved;
+}
+
+void BESMemoryLedger::release(size_t slot) {
+    lock();
+    d_table->slots[slot] = Slot();
+    const uint64_t total = reserved_locked();
+    unlock();
+
+    BESMetrics::TheMetrics()->gauge_set("bes_memory_reserved_bytes", static_cast<int64_t>(total));
+}
+
+void BESMemoryLedger::resize(size_t slot, uint64_t bytes) {
+    lock();
+    d_table->slots[slot].bytes = bytes;
+    const uint64_t total = reserved_locked();
+    unlock();
+
+    BESMetrics::TheMetrics()->gauge_set("bes_memory_reserved_bytes", static_cast<int64_t>(total));
+}
+
+/// @return The memory, in bytes, reserved by all the BES processes
+uint64_t BESMemoryLedger::get_reserved() {
+    if (!enabled())
+        return 0;
+
+    lock();
+    const uint64_t total = reserved_locked();
+    unlock();
+    return total;
+}
+
+/**
+ * @brief Reserve the memory a request will use
+ *
+ * Reserve 'peak_bytes' if they are free, else 'streaming_bytes'. If neither
+ * is free, wait for up to BES.MemoryLedger.wait seconds (or until the
+ * request times out) for other requests to finish.
+ *
+ * @param peak_bytes The memory the request uses when built as usual
+ * @param streaming_bytes The memory the request uses when each variable is
+ * released once it has been sent
+ * @return The reservation; if the ledger is off, the reservation is empty
+ * and is_streaming() is false.
+ * @exception BESSyntaxUserError if the request needs more memory than the
+ * whole budget
+ * @exception BESTimeoutError if the memory did not become free in time
+ */
+BESMemoryLedger::Reservation BESMemoryLedger::admit(uint64_t peak_bytes, uint64_t streaming_bytes) {
+    if (!enabled() || peak_bytes == 0)
+        return {};
+
+    streaming_bytes = min(streaming_bytes, peak_bytes);
+    BESMetrics *metrics = BESMetrics::TheMetrics();
+
+    if (streaming_bytes > d_budget) {
+        metrics->add(admissions_metric, 1, BESMetrics::label("result", "rejected"));
+        stringstream msg;
+        msg << "The request needs at least " << streaming_bytes << " bytes of memory, which is more than the "
+            << d_budget << " bytes this server shares among all its requests. Please request fewer variables "
+            << "or a smaller subset of them.";
+        throw BESSyntaxUserError(msg.str(), __FILE__, __LINE__);
+    }
+
+    size_t slot = 0;
+    if (peak_bytes <= d_budget && try_reserve(peak_bytes, slot)) {
+        metrics->add(admissions_metric, 1, BESMetrics::label("result", "admitted"));
+        return {this, slot, peak_bytes, false};
+    }
+    if (streaming_bytes < peak_bytes && try_reserve(streaming_bytes, slot)) {
+        BESDEBUG(MODULE, PROLOG << "Streaming a request that needs " << peak_bytes << " bytes" << endl);
+        metrics->add(admissions_metric, 1, BESMetrics::label("result", "streamed"));
+        return {this, slot, streaming_bytes, true};
+    }
+
+    BESDEBUG(MODULE, PROLOG << "Queueing a request that needs " << streaming_bytes << " bytes" << endl);
+    metrics->add("bes_memory_queued_total");
+    metrics->gauge_add("bes_memory_queued_requests", 1);
+
+    // Once queued, take whichever of the two fits first.
+    const auto deadline = chrono::steady_clock::now() + chrono::seconds(d_wait_seconds);
+    bool reserved = false;
+    bool streaming = false;
+    try {
+        while (!reserved && chrono::steady_clock::now() < deadline) {
+            RequestServiceTimer::TheTimer()->throw_if_timeout_expired("Waiting for memory to become free.",
+                                                                      __FILE__, __LINE__);
+            this_thread::sleep_for(queue_poll_interval);
+            if (peak_bytes <= d_budget && try_reserve(peak_bytes, slot))
+                reserved = true;
+            else if (streaming_bytes < peak_bytes && try_reserve(streaming_bytes, slot))
+                reserved = streaming = true;
+        }
+    }
+    catch (...) {
+        metrics->gauge_add("bes_memory_queued_requests", -1);
+        metrics->add(admissions_metric, 1, BESMetrics::label("result", "rejected"));
+        throw;
+    }
+
+    metrics->gauge_add("bes_memory_queued_requests", -1);
+
+    if (!reserved) {
+        metrics->add(admissions_metric, 1, BESMetrics::label("result", "rejected"));
+        stringstream msg;
+        msg << "The server is too busy to answer this request; it waited " << d_wait_seconds
+            << " seconds for memory to become free. Please try again later.";
+        throw BESTimeoutError(msg.str(), __FILE__, __LINE__);
+    }
+
+    metrics->add(admissions_metric, 1, BESMetrics::label("result", streaming ? "streamed" : "admitted"));
+    return {this, slot, streaming ? streaming_bytes : peak_bytes, streaming};
+}
+
+BESMemoryLedger::Reservation &BESMemoryLedger::Reservation::operator=(Reservation &&rhs) noexcept {
+    if (this != &rhs) {
+        release();
+        d_ledger = rhs.d_ledger;
+        d_slot = rhs.d_slot;
+        d_bytes = rhs.d_bytes;
+        d_streaming = rhs.d_streaming;
+        rhs.d_ledger = nullptr;
+    }
+    return *this;
+}
+
+/// @brief Return the memory to the ledger; the Reservation is empty afterwards
+void BESMemoryLedger::Reservation::release() {
+    if (d_ledger) {
+        d_ledger->release(d_slot);
+        d_ledger = nullptr;
+    }
+}
+
+/**
+ * @brief Return all but 'bytes' of the memory to the ledger
+ *
+ * A reservation cannot grow this way; if 'bytes' is more than is reserved,
+ * nothing changes.
+ *
+ * @param bytes The memory to keep
+ */
+void BESMemoryLedger::Reservation::trim(uint64_t bytes) {
+    if (d_ledger && bytes < d_bytes) {
+        d_ledger->resize(d_slot, bytes);
+        d_bytes = bytes;
+    }
+}
+
+void BESMemoryLedger::dump(ostream &strm) const {
+    strm << BESIndent::LMarg << "BESMemoryLedger::dump - (" << (void *)this << ")" << endl;
+    BESIndent::Indent();
+    strm << BESIndent::LMarg << "enabled: " << (d_table ? "yes" : "no") << endl;
+    if (d_table) {
+        strm << BESIndent::LMarg << "budget: " << d_budget << " bytes" << endl;
+        strm << BESIndent::LMarg << "wait: " << d_wait_seconds << " seconds" << endl;
+    }
+    BESIndent::UnIndent();
+}
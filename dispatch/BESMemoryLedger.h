@@ -0,0 +1,172 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESMemoryLedger_h
+#define I_BESMemoryLedger_h 1
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include "BESObj.h"
+
+/**
+ * @brief Share a memory budget among the requests running in all the BES processes
+ *
+ * The response size limits apply to one request, so several large requests,
+ * each in its own process, can together use more memory than the host has.
+ * Before a response reads its data, it asks the ledger to admit() it with an
+ * estimate of the memory it will need:
+ * <pre>
+ *     auto reservation = BESMemoryLedger::TheLedger()->admit(peak, streaming);
+ *     if (reservation.is_streaming()) ...release each variable once it is sent...
+ * </pre>
+ * 'peak' is the memory the response needs as it is normally built, and
+ * 'streaming' is what it needs when each variable is released once it has
+ * been sent. When 'peak' bytes are not free, but 'streaming' bytes are, the
+ * request is admitted in streaming mode. When neither is free, the request
+ * waits (is queued) for up to BES.MemoryLedger.wait seconds and then is
+ * rejected with a BESTimeoutError. The memory is returned when the
+ * Reservation is destroyed.
+ *
+ * The reservations live in a table in memory mapped with MAP_SHARED. The
+ * listener makes the table (by calling TheLedger()) before it forks the
+ * processes that handle client connections, so all of them share the
+ * budget. The table is locked by storing the pid of the process using it.
+ * Each reservation records its process's pid and start time, so a
+ * reservation held by a process that has died, even if its pid has been
+ * reused, is reclaimed when a request does not fit. The lock records its
+ * owner's start time too, and is taken over if that process has died.
+ *
+ * The ledger is off unless BES.MemoryLedger.budget (megabytes) is set. The
+ * bes_memory_admissions_total metric counts each request once, as admitted,
+ * streamed or rejected; bes_memory_queued_total counts the requests that had
+ * to wait.
+ */
+class BESMemoryLedger : public BESObj {
+public:
+    static constexpr size_t max_reservations = 1024;
+
+    struct Slot {
+        pid_t pid = 0;          ///< The process holding the reservation; zero if the slot is free
+        uint64_t start = 0;     ///< When that process started; tells it from a later one with the same pid
+        uint64_t bytes = 0;
+    };
+
+    /// The table shared by all the BES processes
+    struct Table {
+        std::atomic<pid_t> lock{0};     ///< The process using the table; zero if none
+        std::atomic<uint64_t> lock_start{0};    ///< When that process started; zero if not yet known
+        Slot slots[max_reservations];
+    };
+
+    /**
+     * @brief Memory reserved for one request
+     *
+     * Destroying the Reservation returns the memory to the ledger.
+     */
+    class Reservation {
+        BESMemoryLedger *d_ledger = nullptr;
+        size_t d_slot = 0;
+        uint64_t d_bytes = 0;
+        bool d_streaming = false;
+
+        friend class BESMemoryLedger;
+
+        Reservation(BESMemoryLedger *ledger, size_t slot, uint64_t bytes, bool streaming)
+            : d_ledger(ledger), d_slot(slot), d_bytes(bytes), d_streaming(streaming) {}
+
+    public:
+        Reservation() = default;
+
+        Reservation(Reservation &&rhs) noexcept
+            : d_ledger(rhs.d_ledger), d_slot(rhs.d_slot), d_bytes(rhs.d_bytes), d_streaming(rhs.d_streaming) {
+            rhs.d_ledger = nullptr;
+        }
+
+        Reservation &operator=(Reservation &&rhs) noexcept;
+
+        Reservation(const Reservation &) = delete;
+        Reservation &operator=(const Reservation &) = delete;
+
+        ~Reservation() { release(); }
+
+        void release();
+
+        void trim(uint64_t bytes);
+
+        /// @return The number of bytes reserved
+        uint64_t bytes() const { return d_ledger ? d_bytes : 0; }
+
+        /// @return True if the request must release each variable once it is sent
+        bool is_streaming() const { return d_streaming; }
+    };
+
+private:
+    static BESMemoryLedger *d_instance;
+
+    Table *d_table = nullptr;
+    uint64_t d_budget = 0;
+    unsigned long d_wait_seconds = 30;
+
+    BESMemoryLedger();
+
+    static uint64_t own_start_time();
+
+    void lock();
+    void unlock();
+
+    uint64_t reserved_locked(size_t *free_slot = nullptr) const;
+    bool reclaim();
+    bool try_reserve(uint64_t bytes, size_t &slot);
+    void release(size_t slot);
+    void resize(size_t slot, uint64_t bytes);
+
+    friend class BESMemoryLedgerTest;
+
+public:
+    static uint64_t process_start_time(pid_t pid);
+
+    ~BESMemoryLedger() override;
+
+    BESMemoryLedger(const BESMemoryLedger &) = delete;
+    BESMemoryLedger &operator=(const BESMemoryLedger &) = delete;
+
+    static BESMemoryLedger *TheLedger();
+
+    /// @brief True if requests are admitted using the ledger
+    bool enabled() const { return d_table != nullptr; }
+
+    /// @return The memory, in bytes, shared by all the requests
+    uint64_t get_budget() const { return d_budget; }
+
+    uint64_t get_reserved();
+
+    Reservation admit(uint64_t peak_bytes, uint64_t streaming_bytes);
+
+    void dump(std::ostream &strm) const override;
+};
+
+#endif // I_BESMemoryLedger_h
@@ -0,0 +1,339 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include "BESDebug.h"
+#include "BESIndent.h"
+#include "BESLog.h"
+#include "BESMetrics.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+#define MODULE "metrics"
+#define PROLOG "BESMetrics::" << __func__ << "() - "
+
+constexpr double BESMetrics::buckets[];
+constexpr size_t BESMetrics::num_buckets;
+constexpr size_t BESMetrics::max_key_length;
+
+BESMetrics *BESMetrics::d_instance = nullptr;
+
+// Entry::state values. While an entry is being claimed its state is
+// entry_claiming plus 31 bits of the hash of the key being written, so a
+// search for a different key can pass it by without reading the key.
+static const uint32_t entry_empty = 0;
+static const uint32_t entry_ready = 1;
+static const uint32_t entry_claiming = 0x80000000;
+
+// How long to wait for another process to finish claiming an entry that may be
+// for the same key. A process killed in the middle of a claim leaves that key
+// unrecorded, but not the table.
+static const int claim_spins = 1000;
+
+// FNV-1a
+static uint64_t hash_key(const string &key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+BESMetrics::BESMetrics() {
+    if (!TheBESKeys::read_bool_key("BES.Metrics.Enabled", false))
+        return;
+
+    unsigned long entries = TheBESKeys::read_ulong_key("BES.Metrics.Entries", 1024);
+    if (entries == 0)
+        return;
+
+    size_t length = entries * sizeof(Entry);
+    void *region = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        ERROR_LOG(string("Could not allocate memory for the metrics, they will not be recorded: ") + strerror(errno));
+        return;
+    }
+
+    d_entries = static_cast<Entry *>(region);
+    d_num_entries = entries;
+    for (size_t i = 0; i < d_num_entries; ++i)
+        new (&d_entries[i]) Entry();
+
+    BESDEBUG(MODULE, PROLOG << "Room for " << d_num_entries << " metrics" << endl);
+}
+
+BESMetrics::~BESMetrics() {
+    if (d_entries)
+        munmap(d_entries, d_num_entries * sizeof(Entry));
+}
+
+/**
+ * @brief Get the metrics registry
+ *
+ * Call this once before the BES forks its client-handling processes so they
+ * share the registry.
+ */
+BESMetrics *BESMetrics::TheMetrics() {
+    if (d_instance == nullptr)
+        d_instance = new BESMetrics();
+    return d_instance;
+}
+
+/**
+ * @brief Find, or claim, the entry for a metric
+ *
+ * @return The entry, or null if the key is too long, the table is full, or the
+ * name is already used for a different type of metric.
+ */
+BESMetrics::Entry *BESMetrics::find(const string &name, const string &labels, metric_type type) {
+    string key = labels.empty() ? name : name + "{" + labels + "}";
+    if (key.size() > max_key_length) {
+        BESDEBUG(MODULE, PROLOG << "Metric name too long: " << key << endl);
+        d_lost.fetch_add(1, memory_order_relaxed);
+        return nullptr;
+    }
+
+    uint64_t hash = hash_key(key);
+    const uint32_t claim = entry_claiming | static_cast<uint32_t>(hash >> 33);
+    size_t start = hash % d_num_entries;
+    for (size_t n = 0; n < d_num_entries; ++n) {
+        Entry &entry = d_entries[(start + n) % d_num_entries];
+
+        uint32_t state = entry.state.load(memory_order_acquire);
+        if (state == entry_empty) {
+            if (entry.state.compare_exchange_strong(state, claim, memory_order_acquire)) {
+                entry.type = type;
+                memcpy(entry.key, key.c_str(), key.size() + 1);
+                entry.state.store(entry_ready, memory_order_release);
+                return &entry;
+            }
+            // Another process or thread got there first; 'state' now holds its value.
+        }
+
+        // If the entry is being claimed for this key, moving on would put the
+        // key in a second entry, so wait for the claim to finish.
+        for (int spins = 0; state == claim && spins < claim_spins; ++spins) {
+            sched_yield();
+            state = entry.state.load(memory_order_acquire);
+        }
+        if (state == claim) {
+            BESDEBUG(MODULE, PROLOG << "Gave up waiting for another process to claim " << key << endl);
+            d_lost.fetch_add(1, memory_order_relaxed);
+            return nullptr;
+        }
+
+        if (state == entry_ready && key == entry.key) {
+            if (entry.type != type) {
+                BESDEBUG(MODULE, PROLOG << key << " was first used as a different type" << endl);
+                d_lost.fetch_add(1, memory_order_relaxed);
+                return nullptr;
+            }
+            return &entry;
+        }
+    }
+
+    BESDEBUG(MODULE, PROLOG << "No room for " << key << endl);
+    d_lost.fetch_add(1, memory_order_relaxed);
+    return nullptr;
+}
+
+/**
+ * @brief Add to a counter
+ *
+ * @param name The metric name, e.g., bes_requests_total
+ * @param value Add this to the counter
+ * @param labels Prometheus labels, e.g., made with label(); joined with ','
+ */
+void BESMetrics::add(const string &name, uint64_t value, const string &labels) {
+    if (!d_entries)
+        return;
+    Entry *entry = find(name, labels, counter);
+    if (entry)
+        entry->value.fetch_add(static_cast<int64_t>(value), memory_order_relaxed);
+}
+
+/**
+ * @brief Add to, or subtract from, a gauge
+ */
+void BESMetrics::gauge_add(const string &name, int64_t delta, const string &labels) {
+    if (!d_entries)
+        return;
+    Entry *entry = find(name, labels, gauge);
+    if (entry)
+        entry->value.fetch_add(delta, memory_order_relaxed);
+}
+
+/**
+ * @brief Set a gauge
+ */
+void BESMetrics::gauge_set(const string &name, int64_t value, const string &labels) {
+    if (!d_entries)
+        return;
+    Entry *entry = find(name, labels, gauge);
+    if (entry)
+        entry->value.store(value, memory_order_relaxed);
+}
+
+/**
+ * @brief Record a duration in a histogram
+ *
+ * @param name The metric name, e.g., bes_request_duration_seconds
+ * @param seconds The duration
+ * @param labels Prometheus labels
+ */
+void BESMetrics::observe(const string &name, double seconds, const string &labels) {
+    if (!d_entries)
+        return;
+    Entry *entry = find(name, labels, histogram);
+    if (!entry)
+        return;
+
+    if (seconds < 0)
+        seconds = 0;
+    // The first bucket whose bound is >= seconds; num_buckets is +Inf
+    size_t b = lower_bound(buckets, buckets + num_buckets, seconds) - buckets;
+    entry->bucket_counts[b].fetch_add(1, memory_order_relaxed);
+    entry->count.fetch_add(1, memory_order_relaxed);
+    entry->sum_usec.fetch_add(static_cast<uint64_t>(seconds * 1e6), memory_order_relaxed);
+}
+
+/**
+ * @brief Make a Prometheus label, escaping the value
+ *
+ * @return name="value"
+ */
+string BESMetrics::label(const string &name, const string &value) {
+    string out = name;
+    out.reserve(name.size() + value.size() + 3);
+    out += "=\"";
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            out += "\\\\";
+            break;
+        case '"':
+            out += "\\\"";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static string format_bound(double bound) {
+    ostringstream oss;
+    oss << bound;
+    return oss.str();
+}
+
+/**
+ * @brief Write all the metrics in the Prometheus text format, version 0.0.4
+ *
+ * The values of all the processes sharing the registry are written, sorted by
+ * name and labels.
+ */
+void BESMetrics::write_prometheus(ostream &strm) const {
+    if (!d_entries)
+        return;
+
+    vector<const Entry *> ready;
+    for (size_t i = 0; i < d_num_entries; ++i) {
+        if (d_entries[i].state.load(memory_order_acquire) == entry_ready)
+            ready.push_back(&d_entries[i]);
+    }
+    // Sort by name, then labels, so all the entries for a name are together
+    // even when another name starts with it.
+    sort(ready.begin(), ready.end(), [](const Entry *a, const Entry *b) {
+        size_t a_len = strcspn(a->key, "{");
+        size_t b_len = strcspn(b->key, "{");
+        int cmp = strncmp(a->key, b->key, min(a_len, b_len));
+        if (cmp != 0 || a_len != b_len)
+            return cmp != 0 ? cmp < 0 : a_len < b_len;
+        return strcmp(a->key + a_len, b->key + b_len) < 0;
+    });
+
+    string last_name;
+    for (const Entry *entry : ready) {
+        string key = entry->key;
+        string::size_type brace = key.find('{');
+        string name = key.substr(0, brace);
+        string labels = (brace == string::npos) ? "" : key.substr(brace + 1, key.size() - brace - 2);
+
+        if (name != last_name) {
+            const char *type_name = entry->type == counter ? "counter" : entry->type == gauge ? "gauge" : "histogram";
+            strm << "# TYPE " << name << " " << type_name << "\n";
+            last_name = name;
+        }
+
+        if (entry->type != histogram) {
+            strm << key << " " << entry->value.load(memory_order_relaxed) << "\n";
+            continue;
+        }
+
+        string sep = labels.empty() ? "" : labels + ",";
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b <= num_buckets; ++b) {
+            cumulative += entry->bucket_counts[b].load(memory_order_relaxed);
+            strm << name << "_bucket{" << sep << "le=\"" << (b < num_buckets ? format_bound(buckets[b]) : "+Inf")
+                 << "\"} " << cumulative << "\n";
+        }
+        string suffix = labels.empty() ? "" : "{" + labels + "}";
+        strm << name << "_sum" << suffix << " " << fixed << setprecision(6)
+             << entry->sum_usec.load(memory_order_relaxed) / 1e6 << defaultfloat << "\n";
+        strm << name << "_count" << suffix << " " << entry->count.load(memory_order_relaxed) << "\n";
+    }
+}
+
+void BESMetrics::dump(ostream &strm) const {
+    strm << BESIndent::LMarg << "BESMetrics::dump - (" << (void *)this << ")" << endl;
+    BESIndent::Indent();
+    strm << BESIndent::LMarg << "enabled: " << (d_entries ? "yes" : "no") << endl;
+    if (d_entries) {
+        size_t used = 0;
+        for (size_t i = 0; i < d_num_entries; ++i)
+            if (d_entries[i].state.load(memory_order_acquire) != entry_empty)
+                ++used;
+        strm << BESIndent::LMarg << "entries: " << used << " of " << d_num_entries << endl;
+        strm << BESIndent::LMarg << "updates lost by this process: " << d_lost.load() << endl;
+    }
+    BESIndent::UnIndent();
+}
@@ -0,0 +1,120 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESMetrics_h
+#define I_BESMetrics_h 1
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "BESObj.h"
+
+/**
+ * @brief Process-wide counters, gauges and latency histograms
+ *
+ * Code anywhere in the BES records a value with add(), gauge_add(),
+ * gauge_set() or observe(), naming the metric and, optionally, a Prometheus
+ * label set:
+ * <pre>
+ *     BESMetrics::TheMetrics()->add("bes_response_bytes_total", n);
+ *     BESMetrics::TheMetrics()->observe("bes_request_duration_seconds", secs,
+ *                                       BESMetrics::label("action", dhi.action));
+ * </pre>
+ * The showMetrics command returns all the values in the Prometheus text
+ * exposition format.
+ *
+ * The values live in a table in memory mapped with MAP_SHARED. The listener
+ * makes the table (by calling TheMetrics()) before it forks the processes that
+ * handle client connections, so all of those processes update, and report, the
+ * same values. A metric is found by hashing its name and labels; a new one
+ * claims a free entry with a compare-and-swap, so no lock is needed. When the
+ * table is full, values for new metrics are not recorded.
+ *
+ * The table is only made when BES.Metrics.Enabled is true; otherwise the
+ * methods return without doing anything. BES.Metrics.Entries sets the number
+ * of metrics (name and label set combinations) the table can hold.
+ */
+class BESMetrics : public BESObj {
+public:
+    enum metric_type : uint32_t { counter = 1, gauge = 2, histogram = 3 };
+
+    /// Upper bounds (seconds) of the histogram buckets; the last bucket is +Inf
+    static constexpr double buckets[] = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60};
+    static constexpr size_t num_buckets = sizeof(buckets) / sizeof(buckets[0]);
+
+    static constexpr size_t max_key_length = 191;
+
+    struct Entry {
+        std::atomic<uint32_t> state{0};
+        uint32_t type = 0;
+        char key[max_key_length + 1] = {0}; ///< name, or name{labels}
+        std::atomic<int64_t> value{0};       ///< counter or gauge value
+        std::atomic<uint64_t> count{0};      ///< histogram observations
+        std::atomic<uint64_t> sum_usec{0};   ///< histogram sum, in microseconds
+        std::atomic<uint64_t> bucket_counts[num_buckets + 1];
+
+        Entry() {
+            for (auto &b : bucket_counts)
+                b = 0;
+        }
+    };
+
+private:
+    static BESMetrics *d_instance;
+
+    Entry *d_entries = nullptr;
+    size_t d_num_entries = 0;
+    std::atomic<uint64_t> d_lost{0};
+
+    BESMetrics();
+
+    Entry *find(const std::string &name, const std::string &labels, metric_type type);
+
+    friend class BESMetricsTest;
+
+public:
+    ~BESMetrics() override;
+
+    BESMetrics(const BESMetrics &) = delete;
+    BESMetrics &operator=(const BESMetrics &) = delete;
+
+    static BESMetrics *TheMetrics();
+
+    /// @brief True if values are being recorded
+    bool enabled() const { return d_entries != nullptr; }
+
+    void add(const std::string &name, uint64_t value = 1, const std::string &labels = "");
+    void gauge_add(const std::string &name, int64_t delta, const std::string &labels = "");
+    void gauge_set(const std::string &name, int64_t value, const std::string &labels = "");
+    void observe(const std::string &name, double seconds, const std::string &labels = "");
+
+    void write_prometheus(std::ostream &strm) const;
+
+    static std::string label(const std::string &name, const std::string &value);
+
+    void dump(std::ostream &strm) const override;
+};
+
+#endif // I_BESMetrics_h
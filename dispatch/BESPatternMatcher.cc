@@ -0,0 +1,255 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+#include "BESPatternMatcher.h"
+#include "BESInternalError.h"
+
+using namespace std;
+
+namespace {
+
+// More alternatives than this and the pattern is left to the regex engine.
+const size_t max_suffixes = 256;
+
+// Characters that stand for themselves in both ECMAScript and POSIX extended
+// regular expressions.
+bool is_plain_literal(char c) {
+    return c != '\0' && (isalnum(static_cast<unsigned char>(c)) || strchr("_-/,:;=@#%&~<>'\"! ", c) != nullptr);
+}
+
+/**
+ * Expands the part of a pattern between the leading '.*' and the trailing '$'
+ * into the finite set of strings it matches. Only literals, escaped punctuation,
+ * groups with alternatives and the '?' quantifier are accepted; anything else
+ * makes the parse fail.
+ */
+class suffix_parser {
+    const string &d_pattern;
+    size_t d_pos;
+
+    static bool cross(vector<string> &prefixes, const vector<string> &tails) {
+        if (prefixes.size() * tails.size() > max_suffixes) return false;
+        vector<string> result;
+        for (const auto &p: prefixes)
+            for (const auto &t: tails)
+                result.push_back(p + t);
+        prefixes.swap(result);
+        return true;
+    }
+
+    bool at_end() const { return d_pos >= d_pattern.size(); }
+    char peek() const { return d_pattern[d_pos]; }
+
+public:
+    suffix_parser(const string &pattern, size_t pos) : d_pattern(pattern), d_pos(pos) {}
+
+    size_t pos() const { return d_pos; }
+
+    // alternatives := sequence ('|' sequence)*
+    bool alternatives(vector<string> &out) {
+        if (!sequence(out)) return false;
+        while (!at_end() && peek() == '|') {
+            ++d_pos;
+            vector<string> more;
+            if (!sequence(more)) return false;
+            out.insert(out.end(), more.begin(), more.end());
+            if (out.size() > max_suffixes) return false;
+        }
+        return true;
+    }
+
+    // sequence := (atom '?'?)*, where atom := literal | '\' punct | '(' ['?:'] alternatives ')'
+    bool sequence(vector<string> &out) {
+        out.assign(1, "");
+        while (!at_end() && peek() != ')' && peek() != '|' && peek() != '$') {
+            vector<string> atom;
+            char c = peek();
+            if (c == '(') {
+                ++d_pos;
+                if (d_pattern.compare(d_pos, 2, "?:") == 0) d_pos += 2;
+                if (!alternatives(atom) || at_end() || peek() != ')') return false;
+                ++d_pos;
+            }
+            else if (c == '\\') {
+                if (d_pos + 1 >= d_pattern.size() || isalnum(static_cast<unsigned char>(d_pattern[d_pos + 1])))
+                    return false;   // \d, \w, \1, ... are not literals
+                atom.assign(1, string(1, d_pattern[d_pos + 1]));
+                d_pos += 2;
+            }
+            else if (is_plain_literal(c)) {
+                atom.assign(1, string(1, c));
+                ++d_pos;
+            }
+            else {
+                return false;
+            }
+
+            if (!at_end() && peek() == '?') {
+                ++d_pos;
+                atom.emplace_back("");
+            }
+            if (!at_end() && (peek() == '?' || peek() == '*' || peek() == '+' || peek() == '{')) return false;
+
+            if (!cross(out, atom)) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Build a matcher from a list of patterns
+ * @param patterns The patterns, in match order
+ * @exception BESInternalError if a pattern is not a valid regular expression
+ */
+BESPatternMatcher::BESPatternMatcher(const vector<string> &patterns)
+{
+    for (const auto &pattern: patterns)
+        add(pattern);
+}
+
+/**
+ * @brief Compile and append a pattern
+ *
+ * @param pattern The regular expression
+ * @exception BESInternalError if \arg pattern is not a valid regular expression
+ */
+void BESPatternMatcher::add(const string &pattern)
+{
+    try {
+        d_regexes.emplace_back(new BESRegex(pattern));
+    }
+    catch (const BESError &e) {
+        throw BESInternalError("Malformed regular expression '" + pattern + "': " + e.get_message(), __FILE__, __LINE__);
+    }
+    catch (const std::exception &e) {
+        throw BESInternalError("Malformed regular expression '" + pattern + "': " + e.what(), __FILE__, __LINE__);
+    }
+
+    d_patterns.push_back(pattern);
+
+    vector<string> suffixes;
+    bool in_trie = literal_suffixes(pattern, suffixes);
+    d_in_trie.push_back(in_trie);
+    if (in_trie) {
+        for (const auto &suffix: suffixes)
+            add_suffix(suffix, static_cast<int>(d_patterns.size() - 1));
+    }
+}
+
+/**
+ * @brief Can this pattern be matched by comparing suffixes?
+ *
+ * True for patterns of the form '[^].*<tail>$' where the tail is built from
+ * literal characters, escaped punctuation, groups of alternatives and '?'. With
+ * the leading '.*' and the trailing '$', such a pattern matches all of a string
+ * with no line terminators exactly when the string ends with one of the strings
+ * the tail matches.
+ *
+ * @param pattern The regular expression
+ * @param suffixes Value-result parameter; the strings the tail matches
+ * @return True if the pattern has that form, false otherwise.
+ */
+bool BESPatternMatcher::literal_suffixes(const string &pattern, vector<string> &suffixes)
+{
+    size_t pos = (!pattern.empty() && pattern[0] == '^') ? 1 : 0;
+    if (pattern.compare(pos, 2, ".*") != 0) return false;
+    pos += 2;
+
+    suffix_parser parser(pattern, pos);
+    vector<string> tail;
+    if (!parser.sequence(tail)) return false;
+    if (parser.pos() + 1 != pattern.size() || pattern[parser.pos()] != '$') return false;
+
+    sort(tail.begin(), tail.end());
+    tail.erase(unique(tail.begin(), tail.end()), tail.end());
+    suffixes.swap(tail);
+    return true;
+}
+
+void BESPatternMatcher::add_suffix(const string &suffix, int pattern_index)
+{
+    size_t node = 0;
+    for (auto c = suffix.rbegin(); c != suffix.rend(); ++c) {
+        auto next = d_suffix_trie[node].next.find(*c);
+        if (next == d_suffix_trie[node].next.end()) {
+            d_suffix_trie.emplace_back();
+            next = d_suffix_trie[node].next.emplace(*c, d_suffix_trie.size() - 1).first;
+        }
+        node = next->second;
+    }
+
+    // Patterns are added in order, so the first one recorded has the lowest index.
+    if (d_suffix_trie[node].first_pattern == -1) d_suffix_trie[node].first_pattern = pattern_index;
+}
+
+/// @return The lowest index of a trie pattern that matches \arg s, or -1.
+int BESPatternMatcher::first_suffix_match(const string &s) const
+{
+    int best = d_suffix_trie[0].first_pattern;
+    size_t node = 0;
+    for (auto c = s.rbegin(); c != s.rend(); ++c) {
+        auto next = d_suffix_trie[node].next.find(*c);
+        if (next == d_suffix_trie[node].next.end()) break;
+        node = next->second;
+        int p = d_suffix_trie[node].first_pattern;
+        if (p != -1 && (best == -1 || p < best)) best = p;
+    }
+
+    return best;
+}
+
+/**
+ * @brief Find the first pattern that matches all of \arg s
+ * @param s The string to test
+ * @return The index of the pattern (see pattern()), or -1 if none match.
+ */
+int BESPatternMatcher::first_match(const string &s) const
+{
+    const int len = static_cast<int>(s.size());
+
+    // '.' does not match a line terminator, so the suffix test does not apply.
+    if (s.find_first_of("\n\r") != string::npos) {
+        for (size_t i = 0; i < d_regexes.size(); ++i) {
+            if (d_regexes[i]->match(s.c_str(), len) == len) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Only the regex patterns listed before the best trie match need to be tried.
+    int best = first_suffix_match(s);
+    size_t limit = (best == -1) ? d_regexes.size() : static_cast<size_t>(best);
+    for (size_t i = 0; i < limit; ++i) {
+        if (!d_in_trie[i] && d_regexes[i]->match(s.c_str(), len) == len) return static_cast<int>(i);
+    }
+
+    return best;
+}
@@ -0,0 +1,102 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_BESPatternMatcher_h
+#define I_BESPatternMatcher_h 1
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BESRegex.h"
+
+/**
+ * @brief An ordered list of regular expressions compiled once and matched many times.
+ *
+ * The catalog Include/Exclude/TypeMatch keys and the AllowedHosts key are lists
+ * of patterns that are tested against every directory entry or URL. Compiling a
+ * BESRegex is far more expensive than matching one, so build one of these when
+ * the configuration is read and use it for every test.
+ *
+ * A pattern matches a string when BESRegex::match() returns the length of the
+ * string, i.e., the same 'full match' test the catalog and AllowedHosts code has
+ * always used. Patterns are tested in the order they were added and the first
+ * one that matches wins.
+ *
+ * Most TypeMatch patterns have the form '.*<literal suffixes>$', e.g.,
+ * '.*\.(nc|h5)(\.gz)?$'. Such a pattern matches a name exactly when the name
+ * ends with one of a finite set of strings (and holds no line terminator, which
+ * '.' does not match). Those suffixes are stored in one reversed trie so a single
+ * backward walk over the name finds the first such pattern that matches. The
+ * other patterns are only tried when they come before that one in the list.
+ *
+ * Instances are not modified by the match methods, so a fully built matcher may be
+ * shared between threads.
+ */
+class BESPatternMatcher {
+    std::vector<std::string> d_patterns;
+    std::vector<std::unique_ptr<BESRegex>> d_regexes;
+
+    /// A node of the reversed suffix trie; node 0 is the root.
+    struct suffix_node {
+        std::map<char, size_t> next;
+        int first_pattern = -1;     ///< The lowest pattern index with a suffix ending here
+    };
+    std::vector<suffix_node> d_suffix_trie{1};
+    std::vector<bool> d_in_trie;    ///< d_in_trie[i] is true if pattern i is matched using the trie
+
+    void add_suffix(const std::string &suffix, int pattern_index);
+    int first_suffix_match(const std::string &s) const;
+
+public:
+    BESPatternMatcher() = default;
+    explicit BESPatternMatcher(const std::vector<std::string> &patterns);
+
+    BESPatternMatcher(const BESPatternMatcher &) = delete;
+    BESPatternMatcher &operator=(const BESPatternMatcher &) = delete;
+    BESPatternMatcher(BESPatternMatcher &&) = default;
+    BESPatternMatcher &operator=(BESPatternMatcher &&) = default;
+
+    ~BESPatternMatcher() = default;
+
+    void add(const std::string &pattern);
+
+    int first_match(const std::string &s) const;
+
+    /// @brief Does any pattern match all of \arg s?
+    bool matches(const std::string &s) const { return first_match(s) != -1; }
+
+    /// @brief The number of patterns
+    size_t size() const { return d_patterns.size(); }
+
+    /// @brief True if there are no patterns
+    bool empty() const { return d_patterns.empty(); }
+
+    /// @brief The i-th pattern, in the order they were added
+    const std::string &pattern(size_t i) const { return d_patterns.at(i); }
+
+    static bool literal_suffixes(const std::string &pattern, std::vector<std::string> &suffixes);
+};
+
+#endif // I_BESPatternMatcher_h
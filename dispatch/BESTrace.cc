@@ -0,0 +1,307 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#include "BESContextManager.h"
+#include "BESDebug.h"
+#include "BESLog.h"
+#include "BESTrace.h"
+#include "BESUtil.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+#define MODULE "trace"
+#define prolog std::string("BESTrace::").append(__func__).append("() - ")
+
+static const char *const TRACE_CONTEXT = "bes_trace";
+static const char *const TRACE_DIRECTORY_KEY = "BES.Trace.Directory";
+static const char *const TRACE_MAX_EVENTS_KEY = "BES.Trace.MaxEvents";
+
+atomic<bool> BESTrace::d_enabled{false};
+mutex BESTrace::d_lock;
+uint64_t BESTrace::d_generation = 0;
+chrono::steady_clock::time_point BESTrace::d_origin;
+string BESTrace::d_request_id;
+uint32_t BESTrace::d_request_tid = 0;
+vector<BESTrace::Event> BESTrace::d_events;
+size_t BESTrace::d_max_events = 0;
+uint64_t BESTrace::d_dropped = 0;
+
+/**
+ * @brief A small number that identifies the calling thread in a trace
+ */
+uint32_t BESTrace::thread_id() {
+    static atomic<uint32_t> next_id{1};
+    thread_local uint32_t id = 0;
+    if (id == 0)
+        id = next_id++;
+    return id;
+}
+
+/**
+ * @brief Start recording spans, discarding those of a previous trace
+ *
+ * @param request_id Identifies the request in the trace
+ * @param max_events Record at most this many spans; count the others
+ */
+void BESTrace::start(const string &request_id, size_t max_events) {
+    lock_guard<mutex> lock(d_lock);
+    ++d_generation;
+    d_origin = chrono::steady_clock::now();
+    d_request_id = request_id;
+    d_request_tid = thread_id();
+    d_events.clear();
+    d_max_events = max_events;
+    d_dropped = 0;
+    d_enabled = true;
+}
+
+/**
+ * @brief Stop recording spans; those recorded are kept until the next start()
+ */
+void BESTrace::stop() {
+    lock_guard<mutex> lock(d_lock);
+    d_enabled = false;
+}
+
+/**
+ * @brief The number of spans recorded
+ */
+size_t BESTrace::size() {
+    lock_guard<mutex> lock(d_lock);
+    return d_events.size();
+}
+
+// The trace a span belongs to, or zero if none is being recorded.
+uint64_t BESTrace::generation() {
+    lock_guard<mutex> lock(d_lock);
+    return d_enabled ? d_generation : 0;
+}
+
+void BESTrace::record(uint64_t generation, const char *category, string &&name, chrono::steady_clock::time_point start,
+                      chrono::steady_clock::time_point stop) {
+    lock_guard<mutex> lock(d_lock);
+    if (!d_enabled || generation != d_generation || start < d_origin)
+        return;
+
+    if (d_events.size() >= d_max_events) {
+        ++d_dropped;
+        return;
+    }
+
+    d_events.push_back({category, std::move(name), thread_id(),
+                        chrono::duration_cast<chrono::microseconds>(start - d_origin).count(),
+                        chrono::duration_cast<chrono::microseconds>(stop - start).count()});
+}
+
+static void write_json_string(ostream &strm, const string &value) {
+    strm << '"';
+    for (char c : value) {
+        switch (c) {
+        case '"':
+            strm << "\\\"";
+            break;
+        case '\\':
+            strm << "\\\\";
+            break;
+        case '\n':
+            strm << "\\n";
+            break;
+        case '\t':
+            strm << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[sizeof "\\u0000"];
+                snprintf(buf, sizeof buf, "\\u%04x", c);
+                strm << buf;
+            } else {
+                strm << c;
+            }
+        }
+    }
+    strm << '"';
+}
+
+/**
+ * @brief Write the recorded spans as a Chrome trace-event JSON document
+ *
+ * Each span is a complete ('X') event; thread name metadata marks the thread
+ * that ran the request.
+ */
+void BESTrace::write_chrome_trace(ostream &strm) {
+    lock_guard<mutex> lock(d_lock);
+
+    vector<const Event *> events;
+    events.reserve(d_events.size());
+    set<uint32_t> tids;
+    for (const auto &event : d_events) {
+        events.push_back(&event);
+        tids.insert(event.tid);
+    }
+    stable_sort(events.begin(), events.end(),
+                [](const Event *a, const Event *b) { return a->start_us < b->start_us; });
+
+    const pid_t pid = getpid();
+
+    strm << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"request_id\":";
+    write_json_string(strm, d_request_id);
+    strm << ",\"dropped_events\":" << d_dropped << "},\"traceEvents\":[\n";
+
+    strm << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"besd "
+         << pid << "\"}}";
+    for (uint32_t tid : tids) {
+        string thread_name = (tid == d_request_tid) ? "request" : "worker " + to_string(tid);
+        strm << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << thread_name << "\"}}";
+    }
+
+    for (const Event *event : events) {
+        strm << ",\n{\"name\":";
+        write_json_string(strm, event->name);
+        strm << ",\"cat\":\"" << event->category << "\",\"ph\":\"X\",\"ts\":" << event->start_us
+             << ",\"dur\":" << event->duration_us << ",\"pid\":" << pid << ",\"tid\":" << event->tid << "}";
+    }
+
+    strm << "\n]}\n";
+}
+
+/**
+ * @brief Start a trace for this request if the client asked for one
+ *
+ * A trace is recorded when the 'bes_trace' context is true and
+ * BES.Trace.Directory is set. The context can be set by a command of the
+ * request itself, so call this again before each command; once the trace
+ * has started, later calls do nothing.
+ *
+ * @return True if a trace is being recorded
+ */
+bool BESTrace::begin_request(const string &request_id) {
+    if (enabled())
+        return true;
+
+    bool found = false;
+    string value = BESUtil::lowercase(BESContextManager::TheManager()->get_context(TRACE_CONTEXT, found));
+    if (!found || !(value == "true" || value == "yes" || value == "1"))
+        return false;
+
+    if (TheBESKeys::read_string_key(TRACE_DIRECTORY_KEY, "").empty()) {
+        BESDEBUG(MODULE, prolog << "A trace was requested but " << TRACE_DIRECTORY_KEY << " is not set" << endl);
+        return false;
+    }
+
+    start(request_id, TheBESKeys::read_ulong_key(TRACE_MAX_EVENTS_KEY, 100000));
+    return true;
+}
+
+/**
+ * @brief Stop the trace started by begin_request() and write it to a file
+ *
+ * The file is named bes_trace_<pid>_<request id>.json and is written to
+ * BES.Trace.Directory.
+ *
+ * @return The pathname of the trace file, or the empty string if no trace was
+ * being recorded or it could not be written.
+ */
+string BESTrace::end_request() {
+    if (!enabled())
+        return "";
+
+    stop();
+
+    string request_id;
+    {
+        lock_guard<mutex> lock(d_lock);
+        request_id = d_request_id.empty() ? to_string(d_generation) : d_request_id;
+    }
+    for (auto &c : request_id) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.')
+            c = '_';
+    }
+
+    string file_name = BESUtil::pathConcat(TheBESKeys::read_string_key(TRACE_DIRECTORY_KEY, ""),
+                                           "bes_trace_" + to_string(getpid()) + "_" + request_id + ".json");
+
+    // Write to a temporary file and rename it so a partial trace is never seen.
+    string tmp_name = file_name + ".tmp";
+    {
+        ofstream out(tmp_name);
+        if (out)
+            write_chrome_trace(out);
+        if (!out) {
+            ERROR_LOG(prolog + "Could not write the trace file " + tmp_name + ": " + strerror(errno));
+            unlink(tmp_name.c_str());
+            return "";
+        }
+    }
+    if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        ERROR_LOG(prolog + "Could not rename the trace file " + tmp_name + ": " + strerror(errno));
+        unlink(tmp_name.c_str());
+        return "";
+    }
+
+    {
+        lock_guard<mutex> lock(d_lock);
+        vector<Event>().swap(d_events);
+    }
+
+    INFO_LOG(prolog + "Wrote the trace for request " + request_id + " to " + file_name);
+    return file_name;
+}
+
+/**
+ * @brief Start the span if a trace is being recorded
+ *
+ * @param category A string literal that groups spans, e.g., "dmrpp"
+ * @param name The name shown for the span
+ */
+void BESTraceSpan::start(const char *category, string name) {
+    d_generation = BESTrace::generation();
+    if (!d_generation)
+        return;
+    d_category = category;
+    d_name = std::move(name);
+    d_start = chrono::steady_clock::now();
+}
+
+/**
+ * @brief End the span and record it
+ */
+void BESTraceSpan::stop() {
+    if (!d_generation)
+        return;
+    BESTrace::record(d_generation, d_category, std::move(d_name), d_start, chrono::steady_clock::now());
+    d_generation = 0;
+}
@@ -0,0 +1,133 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+
+#ifndef I_BESTrace_h
+#define I_BESTrace_h 1
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Time a scope as a span in the request's trace. The name is only evaluated
+// when a trace is being recorded, so it may be an expensive expression.
+#define BES_TRACE_CONCAT_(a, b) a##b
+#define BES_TRACE_CONCAT(a, b) BES_TRACE_CONCAT_(a, b)
+
+#define BES_TRACE_SPAN(category, name)                                                                                 \
+    BESTraceSpan BES_TRACE_CONCAT(besTraceSpan, __LINE__);                                                             \
+    if (BESTrace::enabled())                                                                                           \
+    BES_TRACE_CONCAT(besTraceSpan, __LINE__).start((category), (name))
+
+/**
+ * @brief Record nested, per-thread spans for one request
+ *
+ * BESStopWatch writes one log line per timer, which makes it hard to see how
+ * the parts of a request overlap, e.g., chunk transfers running on several
+ * threads while the response is serialized. A BESTraceSpan records when a
+ * scope started and how long it took, along with the thread it ran on. When
+ * the request is done the spans are written as a Chrome trace-event JSON file
+ * that chrome://tracing or https://ui.perfetto.dev shows as a timeline, one
+ * row per thread, with the spans of each thread nested.
+ *
+ * A client asks for a trace by setting the context 'bes_trace' to 'true'
+ * (using setContext). The BES only honors that when BES.Trace.Directory names
+ * the directory the trace files go in. BES.Trace.MaxEvents (default 100000)
+ * limits the number of spans recorded for a request.
+ *
+ * When no trace is being recorded, BES_TRACE_SPAN costs one relaxed atomic
+ * load.
+ */
+class BESTrace {
+public:
+    struct Event {
+        const char *category;
+        std::string name;
+        uint32_t tid;
+        int64_t start_us; ///< Since the trace started
+        int64_t duration_us;
+    };
+
+private:
+    static std::atomic<bool> d_enabled;
+
+    static std::mutex d_lock; // guards the members below
+    static uint64_t d_generation;
+    static std::chrono::steady_clock::time_point d_origin;
+    static std::string d_request_id;
+    static uint32_t d_request_tid;
+    static std::vector<Event> d_events;
+    static size_t d_max_events;
+    static uint64_t d_dropped;
+
+    friend class BESTraceSpan;
+    static uint64_t generation();
+    static void record(uint64_t generation, const char *category, std::string &&name,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stop);
+
+public:
+    /// @brief True if spans are being recorded
+    static bool enabled() { return d_enabled.load(std::memory_order_relaxed); }
+
+    static void start(const std::string &request_id, size_t max_events);
+    static void stop();
+    static void write_chrome_trace(std::ostream &strm);
+    static size_t size();
+
+    static uint32_t thread_id();
+
+    static bool begin_request(const std::string &request_id);
+    static std::string end_request();
+};
+
+/**
+ * @brief A span in the current trace; use BES_TRACE_SPAN
+ *
+ * The span ends when the object is destroyed. A span that started before the
+ * trace did, or ends after it stopped, is not recorded.
+ */
+class BESTraceSpan {
+    uint64_t d_generation = 0;
+    const char *d_category = nullptr;
+    std::string d_name;
+    std::chrono::steady_clock::time_point d_start;
+
+public:
+    BESTraceSpan() = default;
+    BESTraceSpan(const BESTraceSpan &) = delete;
+    BESTraceSpan &operator=(const BESTraceSpan &) = delete;
+
+    ~BESTraceSpan() {
+        if (d_generation)
+            stop();
+    }
+
+    void start(const char *category, std::string name);
+    void stop();
+};
+
+#endif // I_BESTrace_h
@@ -48,6 +48,7 @@
 #include <openssl/sha.h>
 
 #include "BESLog.h"
+#include "BESMetrics.h"
 #include "BESUtil.h"
 
 // Make all the error log messages uniform in one small way. This is a macro
@@ -299,6 +300,13 @@ class FileCache {
 
     friend class FileCacheTest;
 
+    // Labels for the bes_cache_lookups_total metric
+    static const std::string &cache_metric_labels(bool is_hit) {
+        static const std::string hit = BESMetrics::label("cache", "file") + "," + BESMetrics::label("result", "hit");
+        static const std::string miss = BESMetrics::label("cache", "file") + "," + BESMetrics::label("result", "miss");
+        return is_hit ? hit : miss;
+    }
+
 public:
     /**
      * @brief Return a SHA256 hash of the given key.
@@ -575,8 +583,10 @@ public:
         std::string key_file_name = BESUtil::pathConcat(d_cache_dir, key);
         int fd = open(key_file_name.c_str(), O_RDONLY, 0666);
         if (fd < 0) {
-            if (errno == ENOENT)
+            if (errno == ENOENT) {
+                BESMetrics::TheMetrics()->add("bes_cache_lookups_total", 1, cache_metric_labels(false));
                 return false;
+            }
             else {
                 ERROR("Error opening the cache item in get for: " + key + " " + get_errno());
                 return false;
@@ -589,6 +599,7 @@ public:
 
         // Here's where we should update the info about the item in the cache_info file
 
+        BESMetrics::TheMetrics()->add("bes_cache_lookups_total", 1, cache_metric_labels(true));
         return true;
     }
 
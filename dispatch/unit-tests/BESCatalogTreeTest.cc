@@ -0,0 +1,293 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <unistd.h>
+
+#include "BESCatalogTree.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+class BESCatalogTreeTest : public CppUnit::TestFixture {
+    string d_dir;
+    int d_scans = 0;
+
+    // Every entry is a leaf; that is enough to see when a directory is read.
+    BESCatalogTree::Scanner scanner() {
+        return [this](const string &dir, BESCatalogTree::Listing &listing) {
+            ++d_scans;
+            DIR *dip = opendir(dir.c_str());
+            CPPUNIT_ASSERT(dip);
+            struct dirent *dit;
+            while ((dit = readdir(dip)) != nullptr) {
+                string name = dit->d_name;
+                if (name == "." || name == "..")
+                    continue;
+                struct stat buf;
+                CPPUNIT_ASSERT(stat((dir + "/" + name).c_str(), &buf) == 0);
+                BESCatalogTree::Entry entry;
+                entry.name = name;
+                entry.size = buf.st_size;
+                entry.mtime = buf.st_mtime;
+                listing.leaves.push_back(entry);
+            }
+            closedir(dip);
+        };
+    }
+
+    void write_file(const string &name, const string &content) {
+        ofstream out(d_dir + "/" + name);
+        out << content;
+    }
+
+    // A listing read in the same second the directory was changed is not
+    // trusted, so move the directory's mtime into the past.
+    struct stat age_dir(const string &dir) {
+        struct timeval times[2] = {{time(nullptr) - 10, 0}, {time(nullptr) - 10, 0}};
+        CPPUNIT_ASSERT(utimes(dir.c_str(), times) == 0);
+        struct stat buf;
+        CPPUNIT_ASSERT(stat(dir.c_str(), &buf) == 0);
+        return buf;
+    }
+
+public:
+    void setUp() override {
+        char tmpl[] = "/tmp/BESCatalogTreeTest_XXXXXX";
+        CPPUNIT_ASSERT(mkdtemp(tmpl));
+        d_dir = tmpl;
+        d_scans = 0;
+        write_file("a.nc", "abc");
+        write_file("b.h5", "abcdef");
+    }
+
+    void tearDown() override {
+        string cmd = "rm -rf " + d_dir;
+        if (system(cmd.c_str()) != 0)
+            cerr << "Could not remove " << d_dir << endl;
+    }
+
+    void cached_listing_test() {
+        BESCatalogTree tree(scanner(), 300, 100);
+        struct stat buf = age_dir(d_dir);
+
+        BESCatalogTree::ListingPtr first = tree.get(d_dir, buf);
+        BESCatalogTree::ListingPtr second = tree.get(d_dir + "/", buf);
+        DBG(cerr << "scans: " << d_scans << ", watching: " << tree.watching() << endl);
+        CPPUNIT_ASSERT(d_scans == 1);
+        CPPUNIT_ASSERT(first == second);
+        CPPUNIT_ASSERT(first->leaves.size() == 2);
+        CPPUNIT_ASSERT(tree.size() == 1);
+    }
+
+    void directory_change_test() {
+        BESCatalogTree tree(scanner(), 300, 100);
+        struct stat buf = age_dir(d_dir);
+        CPPUNIT_ASSERT(tree.get(d_dir, buf)->leaves.size() == 2);
+
+        write_file("c.nc", "xyz");
+        CPPUNIT_ASSERT(stat(d_dir.c_str(), &buf) == 0);
+
+        CPPUNIT_ASSERT(tree.get(d_dir, buf)->leaves.size() == 3);
+        CPPUNIT_ASSERT(d_scans == 2);
+    }
+
+    void file_change_test() {
+        BESCatalogTree tree(scanner(), 300, 100);
+        struct stat buf = age_dir(d_dir);
+        CPPUNIT_ASSERT(tree.get(d_dir, buf)->leaves.size() == 2);
+        if (!tree.watching()) {
+            DBG(cerr << "inotify not available, skipping" << endl);
+            return;
+        }
+
+        // Rewriting a file does not change the directory, only inotify sees it
+        write_file("a.nc", "a much longer value");
+        BESCatalogTree::ListingPtr listing = tree.get(d_dir, buf);
+        CPPUNIT_ASSERT(d_scans == 2);
+        for (const auto &entry : listing->leaves) {
+            if (entry.name == "a.nc")
+                CPPUNIT_ASSERT(entry.size == 19);
+        }
+    }
+
+    // The BES makes the catalogs before it forks. A child's listings and
+    // watches must not disturb those of its parent.
+    void fork_test() {
+        BESCatalogTree tree(scanner(), 300, 100);
+        struct stat buf = age_dir(d_dir);
+        CPPUNIT_ASSERT(tree.get(d_dir, buf)->leaves.size() == 2);
+        if (!tree.watching()) {
+            DBG(cerr << "inotify not available, skipping" << endl);
+            return;
+        }
+
+        pid_t pid = fork();
+        CPPUNIT_ASSERT(pid >= 0);
+        if (pid == 0) {
+            // The inherited listing has no watch in this process, so it is read again.
+            tree.get(d_dir, buf);
+            bool ok = d_scans == 2 && tree.watching();
+            tree.clear();
+            write_file("a.nc", "a much longer value");
+            _exit(ok ? 0 : 1);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CPPUNIT_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+        // The parent still sees the change the child made.
+        BESCatalogTree::ListingPtr listing = tree.get(d_dir, buf);
+        CPPUNIT_ASSERT(d_scans == 2);
+        for (const auto &entry : listing->leaves) {
+            if (entry.name == "a.nc")
+                CPPUNIT_ASSERT(entry.size == 19);
+        }
+    }
+
+    void reconcile_test() {
+        BESCatalogTree tree(scanner(), 1, 100);
+        struct stat buf = age_dir(d_dir);
+        tree.get(d_dir, buf);
+        tree.get(d_dir, buf);
+        CPPUNIT_ASSERT(d_scans == 1);
+
+        sleep(2);
+        tree.get(d_dir, buf);
+        CPPUNIT_ASSERT(d_scans == 2);
+    }
+
+    void invalidate_test() {
+        BESCatalogTree tree(scanner(), 300, 100);
+        struct stat buf = age_dir(d_dir);
+        tree.get(d_dir, buf);
+        tree.invalidate(d_dir + "/");
+        CPPUNIT_ASSERT(tree.size() == 0);
+        tree.get(d_dir, buf);
+        CPPUNIT_ASSERT(d_scans == 2);
+
+        tree.clear();
+        CPPUNIT_ASSERT(tree.size() == 0);
+    }
+
+    void lru_test() {
+        BESCatalogTree tree(scanner(), 300, 2);
+        for (const char *sub : {"/one", "/two", "/three"}) {
+            CPPUNIT_ASSERT(mkdir((d_dir + sub).c_str(), 0755) == 0);
+        }
+        struct stat one = age_dir(d_dir + "/one");
+        struct stat two = age_dir(d_dir + "/two");
+        struct stat three = age_dir(d_dir + "/three");
+
+        tree.get(d_dir + "/one", one);
+        tree.get(d_dir + "/two", two);
+        tree.get(d_dir + "/one", one); // 'two' is now the least recently used
+        tree.get(d_dir + "/three", three);
+        CPPUNIT_ASSERT(tree.size() == 2);
+        CPPUNIT_ASSERT(d_scans == 3);
+
+        tree.get(d_dir + "/one", one);
+        CPPUNIT_ASSERT(d_scans == 3);
+        tree.get(d_dir + "/two", two);
+        CPPUNIT_ASSERT(d_scans == 4);
+    }
+
+    void normalize_test() {
+        CPPUNIT_ASSERT(BESCatalogTree::normalize("/data/") == "/data");
+        CPPUNIT_ASSERT(BESCatalogTree::normalize("/data//") == "/data");
+        CPPUNIT_ASSERT(BESCatalogTree::normalize("/data") == "/data");
+        CPPUNIT_ASSERT(BESCatalogTree::normalize("/") == "/");
+        CPPUNIT_ASSERT(BESCatalogTree::normalize("//") == "/");
+    }
+
+CPPUNIT_TEST_SUITE(BESCatalogTreeTest);
+
+    CPPUNIT_TEST(cached_listing_test);
+    CPPUNIT_TEST(directory_change_test);
+    CPPUNIT_TEST(file_change_test);
+    CPPUNIT_TEST(fork_test);
+    CPPUNIT_TEST(reconcile_test);
+    CPPUNIT_TEST(invalidate_test);
+    CPPUNIT_TEST(lru_test);
+    CPPUNIT_TEST(normalize_test);
+
+CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESCatalogTreeTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESCatalogTreeTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <unistd.h>
+#include <utime.h>
+
+#include "BESFileHandleCache.h"
+
+#include "test_config.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+#define prolog std::string("BESFileHandleCacheTest::").append(__func__).append("() - ")
+
+class BESFileHandleCacheTest : public CppUnit::TestFixture {
+    vector<int> closed;
+    vector<string> files;
+
+    string make_file(const string &name) {
+        string path = string(TEST_BUILD_DIR) + "/" + name;
+        ofstream(path) << name << endl;
+        files.push_back(path);
+        return path;
+    }
+
+public:
+    void setUp() override {
+        closed.clear();
+        files.clear();
+    }
+
+    void tearDown() override {
+        for (const auto &f: files)
+            unlink(f.c_str());
+    }
+
+    void disabled_test() {
+        BESFileHandleCache<int> cache(0, [this](int h) { closed.push_back(h); });
+        string f = make_file("fhc_a");
+        int h = -1;
+        CPPUNIT_ASSERT(!cache.get(f, h));
+        cache.add(f, 3);
+        CPPUNIT_ASSERT(cache.size() == 0);
+        CPPUNIT_ASSERT_MESSAGE("The caller must close the handle", !cache.release(3));
+    }
+
+    void reuse_test() {
+        BESFileHandleCache<int> cache(2, [this](int h) { closed.push_back(h); });
+        string f = make_file("fhc_a");
+        int h = -1;
+        CPPUNIT_ASSERT(!cache.get(f, h));
+        cache.add(f, 3);
+        CPPUNIT_ASSERT(cache.release(3));
+
+        CPPUNIT_ASSERT(cache.get(f, h));
+        CPPUNIT_ASSERT(h == 3);
+        CPPUNIT_ASSERT(cache.release(h));
+        CPPUNIT_ASSERT(closed.empty());
+    }
+
+    void lru_eviction_test() {
+        BESFileHandleCache<int> cache(2, [this](int h) { closed.push_back(h); });
+        string a = make_file("fhc_a");
+        string b = make_file("fhc_b");
+        string c = make_file("fhc_c");
+
+        cache.add(a, 1); cache.release(1);
+        cache.add(b, 2); cache.release(2);
+        int h = -1;
+        CPPUNIT_ASSERT(cache.get(a, h));   // a is now the most recently used
+        cache.release(h);
+
+        cache.add(c, 3); cache.release(3);
+        CPPUNIT_ASSERT(cache.size() == 2);
+        CPPUNIT_ASSERT(closed.size() == 1 && closed[0] == 2);
+        CPPUNIT_ASSERT(!cache.get(b, h));
+    }
+
+    void in_use_not_closed_test() {
+        BESFileHandleCache<int> cache(1, [this](int h) { closed.push_back(h); });
+        string a = make_file("fhc_a");
+        string b = make_file("fhc_b");
+
+        cache.add(a, 1);    // in use
+        cache.add(b, 2);    // in use; the cache is over its limit
+        CPPUNIT_ASSERT(closed.empty());
+        CPPUNIT_ASSERT(cache.size() == 2);
+
+        cache.release(2);   // b is the most recent, so a is the LRU entry, but it's still in use
+        CPPUNIT_ASSERT(closed.size() == 1 && closed[0] == 2);
+        cache.release(1);
+        CPPUNIT_ASSERT(cache.size() == 1);
+        int h = -1;
+        CPPUNIT_ASSERT(cache.get(a, h) && h == 1);
+        cache.release(h);
+    }
+
+    void modified_file_test() {
+        BESFileHandleCache<int> cache(4, [this](int h) { closed.push_back(h); });
+        string a = make_file("fhc_a");
+        cache.add(a, 1);
+
+        // Change the mtime while the handle is in use
+        struct utimbuf times {0, 0};
+        CPPUNIT_ASSERT(utime(a.c_str(), &times) == 0);
+
+        int h = -1;
+        CPPUNIT_ASSERT_MESSAGE("A modified file must be reopened", !cache.get(a, h));
+        CPPUNIT_ASSERT(closed.empty());
+        CPPUNIT_ASSERT(cache.release(1));
+        CPPUNIT_ASSERT(closed.size() == 1 && closed[0] == 1);
+        CPPUNIT_ASSERT(cache.size() == 0);
+    }
+
+    void destructor_closes_test() {
+        {
+            BESFileHandleCache<int> cache(4, [this](int h) { closed.push_back(h); });
+            cache.add(make_file("fhc_a"), 1);
+            cache.release(1);
+            cache.add(make_file("fhc_b"), 2);
+            cache.release(2);
+        }
+        CPPUNIT_ASSERT(closed.size() == 2);
+    }
+
+CPPUNIT_TEST_SUITE(BESFileHandleCacheTest);
+
+    CPPUNIT_TEST(disabled_test);
+    CPPUNIT_TEST(reuse_test);
+    CPPUNIT_TEST(lru_eviction_test);
+    CPPUNIT_TEST(in_use_not_closed_test);
+    CPPUNIT_TEST(modified_file_test);
+    CPPUNIT_TEST(destructor_closes_test);
+
+CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESFileHandleCacheTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESFileHandleCacheTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <unistd.h>
+
+#include "BESLog.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+// BESLog's constructor is protected; TheLog() builds only one instance.
+class TestLog : public BESLog {
+public:
+    TestLog() = default;
+};
+
+class BESLogTest : public CppUnit::TestFixture {
+    string d_log;
+
+    vector<string> read_lines() {
+        ifstream in(d_log);
+        vector<string> lines;
+        string line;
+        while (getline(in, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+public:
+    void setUp() override {
+        char tmpl[] = "/tmp/BESLogTest_XXXXXX";
+        int fd = mkstemp(tmpl);
+        CPPUNIT_ASSERT(fd >= 0);
+        close(fd);
+        d_log = tmpl;
+
+        TheBESKeys::TheKeys()->set_key("BES.LogName", d_log);
+        TheBESKeys::TheKeys()->set_key("BES.LogFormat", "json");
+        TheBESKeys::TheKeys()->set_key("BES.LogUnixTime", "false");
+        TheBESKeys::TheKeys()->set_key("BES.LogAsync", "no");
+        TheBESKeys::TheKeys()->set_key("AWS.instance-id", "i-1234");
+    }
+
+    void tearDown() override {
+        TheBESKeys::TheKeys()->set_key("BES.LogFormat", "text");
+        unlink(d_log.c_str());
+    }
+
+    void json_record_test() {
+        {
+            TestLog log;
+            log.set_request_id("req-1");
+            log.info("starting\n");
+            log.error("a \"quoted\" path\\name\nsecond line\ttab");
+            log.flush();
+        }
+
+        vector<string> lines = read_lines();
+        DBG(for (const auto &line : lines) cerr << line << endl);
+        CPPUNIT_ASSERT_EQUAL(size_t(2), lines.size());
+
+        const string pid = to_string(getpid());
+        const string info = lines[0];
+        CPPUNIT_ASSERT(info.front() == '{' && info.back() == '}');
+        CPPUNIT_ASSERT(info.compare(0, 9, "{\"time\":\"") == 0);
+        CPPUNIT_ASSERT(info.find(",\"instance\":\"i-1234\",\"pid\":" + pid + ",\"request\":\"req-1\"") != string::npos);
+        CPPUNIT_ASSERT(info.find(",\"type\":\"info\",\"message\":\"starting\"}") != string::npos);
+
+        const string error = lines[1];
+        CPPUNIT_ASSERT(error.find(",\"type\":\"error\"") != string::npos);
+        CPPUNIT_ASSERT(error.find(",\"message\":\"a \\\"quoted\\\" path\\\\name\\nsecond line\\ttab\"}") !=
+                       string::npos);
+    }
+
+    void json_trace_test() {
+        {
+            TestLog log;
+            log.trace_info("traced", "some_file.cc", 42);
+            log.flush();
+        }
+
+        vector<string> lines = read_lines();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        CPPUNIT_ASSERT(lines[0].find(",\"type\":\"trace-info\",\"file\":\"some_file.cc\",\"line\":42,"
+                                     "\"message\":\"traced\"}") != string::npos);
+    }
+
+    // With BES.LogUnixTime=true the time is a JSON number
+    void json_unix_time_test() {
+        TheBESKeys::TheKeys()->set_key("BES.LogUnixTime", "true");
+        {
+            TestLog log;
+            log.info("when");
+            log.flush();
+        }
+
+        vector<string> lines = read_lines();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        CPPUNIT_ASSERT(lines[0].compare(0, 8, "{\"time\":") == 0);
+        CPPUNIT_ASSERT(isdigit(lines[0][8]));
+        CPPUNIT_ASSERT(strtoll(lines[0].c_str() + 8, nullptr, 10) >= time(nullptr) - 60);
+    }
+
+    // Control characters other than \n, \r and \t are written as \u00XX
+    void json_control_char_test() {
+        {
+            TestLog log;
+            log.info(string("bell\x07") + "end");
+            log.flush();
+        }
+
+        vector<string> lines = read_lines();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        CPPUNIT_ASSERT(lines[0].find("\"message\":\"bell\\u0007end\"}") != string::npos);
+    }
+
+    // The default format is unchanged: fields separated by BESLog::mark
+    void text_record_test() {
+        TheBESKeys::TheKeys()->set_key("BES.LogFormat", "text");
+        {
+            TestLog log;
+            log.set_request_id("req-2");
+            log.info("plain");
+            log.flush();
+        }
+
+        vector<string> lines = read_lines();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        const string suffix = BESLog::mark + "i-1234" + BESLog::mark + to_string(getpid()) + BESLog::mark +
+                              "req-2" + BESLog::mark + "info" + BESLog::mark + "plain";
+        CPPUNIT_ASSERT(lines[0].size() > suffix.size());
+        CPPUNIT_ASSERT(lines[0].compare(lines[0].size() - suffix.size(), suffix.size(), suffix) == 0);
+    }
+
+CPPUNIT_TEST_SUITE(BESLogTest);
+
+    CPPUNIT_TEST(json_record_test);
+    CPPUNIT_TEST(json_trace_test);
+    CPPUNIT_TEST(json_unix_time_test);
+    CPPUNIT_TEST(json_control_char_test);
+    CPPUNIT_TEST(text_record_test);
+
+CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESLogTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESLogTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
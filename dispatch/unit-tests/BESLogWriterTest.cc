@@ -0,0 +1,222 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sys/wait.h>
+#include <syslog.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <unistd.h>
+
+#include "BESLogWriter.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+class BESLogWriterTest : public CppUnit::TestFixture {
+    string d_log;
+
+    size_t count_lines(const string &text) {
+        ifstream in(d_log);
+        string line;
+        size_t n = 0;
+        while (getline(in, line)) {
+            if (text.empty() || line == text)
+                ++n;
+        }
+        return n;
+    }
+
+public:
+    void setUp() override {
+        char tmpl[] = "/tmp/BESLogWriterTest_XXXXXX";
+        int fd = mkstemp(tmpl);
+        CPPUNIT_ASSERT(fd >= 0);
+        close(fd);
+        d_log = tmpl;
+    }
+
+    void tearDown() override { unlink(d_log.c_str()); }
+
+    void write_flush_test() {
+        BESLogWriter writer(d_log, false, 1024);
+        for (int i = 0; i < 100; ++i)
+            CPPUNIT_ASSERT(writer.write(LOG_INFO, "record " + to_string(i) + "\n"));
+        writer.flush();
+
+        CPPUNIT_ASSERT(count_lines("") == 100);
+        CPPUNIT_ASSERT(count_lines("record 99") == 1);
+        CPPUNIT_ASSERT(writer.written() == 100);
+        CPPUNIT_ASSERT(writer.dropped() == 0);
+    }
+
+    void threads_test() {
+        const int threads = 4;
+        const int records = 1000;
+        uint64_t written = 0;
+        {
+            BESLogWriter writer(d_log, false, records);
+            vector<thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&writer, t]() {
+                    for (int i = 0; i < records; ++i)
+                        writer.write(LOG_INFO, "thread " + to_string(t) + "\n");
+                });
+            }
+            for (auto &worker : workers)
+                worker.join();
+
+            writer.flush();
+            DBG(cerr << "written: " << writer.written() << ", dropped: " << writer.dropped() << endl);
+            CPPUNIT_ASSERT(writer.written() + writer.dropped() == threads * records);
+            written = writer.written();
+        }
+        CPPUNIT_ASSERT(count_lines("") == written);
+    }
+
+    void drop_test() {
+        BESLogWriter writer(d_log, false, 4);
+        int accepted = 0;
+        for (int i = 0; i < 10000; ++i)
+            accepted += writer.write(LOG_INFO, "x\n");
+        writer.flush();
+
+        DBG(cerr << "accepted: " << accepted << ", dropped: " << writer.dropped() << endl);
+        CPPUNIT_ASSERT(accepted + writer.dropped() == 10000);
+        CPPUNIT_ASSERT(writer.written() == (uint64_t)accepted);
+        CPPUNIT_ASSERT(count_lines("x") == (size_t)accepted);
+
+        uint64_t dropped = writer.dropped();
+        CPPUNIT_ASSERT(writer.take_unreported_drops() == dropped);
+        CPPUNIT_ASSERT(writer.take_unreported_drops() == 0);
+    }
+
+    // An error record is written even when the thread's ring is full.
+    void error_not_dropped_test() {
+        BESLogWriter writer(d_log, false, 2);
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 8; ++i)
+                writer.write(LOG_INFO, "x\n");
+            CPPUNIT_ASSERT(writer.write(LOG_ERR, "error " + to_string(round) + "\n"));
+        }
+        writer.flush();
+
+        DBG(cerr << "dropped: " << writer.dropped() << endl);
+        for (int round = 0; round < 100; ++round)
+            CPPUNIT_ASSERT(count_lines("error " + to_string(round)) == 1);
+    }
+
+    void destructor_test() {
+        {
+            BESLogWriter writer(d_log, false, 64);
+            writer.write(LOG_INFO, "last words\n");
+        }
+        CPPUNIT_ASSERT(count_lines("last words") == 1);
+    }
+
+    // Records queued before a fork are written once, by the parent.
+    void fork_test() {
+        BESLogWriter writer(d_log, false, 1024);
+        writer.write(LOG_INFO, "before fork\n");
+
+        pid_t pid = fork();
+        CPPUNIT_ASSERT(pid >= 0);
+        if (pid == 0) {
+            writer.write(LOG_INFO, "child\n");
+            writer.flush();
+            _exit(0);
+        }
+        writer.write(LOG_INFO, "parent\n");
+        int status = 0;
+        waitpid(pid, &status, 0);
+        writer.flush();
+
+        CPPUNIT_ASSERT(count_lines("before fork") == 1);
+        CPPUNIT_ASSERT(count_lines("child") == 1);
+        CPPUNIT_ASSERT(count_lines("parent") == 1);
+    }
+
+CPPUNIT_TEST_SUITE(BESLogWriterTest);
+
+    CPPUNIT_TEST(write_flush_test);
+    CPPUNIT_TEST(threads_test);
+    CPPUNIT_TEST(drop_test);
+    CPPUNIT_TEST(error_not_dropped_test);
+    CPPUNIT_TEST(destructor_test);
+    CPPUNIT_TEST(fork_test);
+
+CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESLogWriterTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESLogWriterTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include "BESMemoryLedger.h"
+#include "BESMetrics.h"
+#include "BESSyntaxUserError.h"
+#include "BESTimeoutError.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+static const uint64_t MB = 1024 * 1024;
+
+class BESMemoryLedgerTest : public CppUnit::TestFixture {
+    // A one megabyte budget
+    unique_ptr<BESMemoryLedger> make_ledger(const string &wait) {
+        TheBESKeys::TheKeys()->set_key("BES.MemoryLedger.budget", "1");
+        TheBESKeys::TheKeys()->set_key("BES.MemoryLedger.wait", wait);
+        return unique_ptr<BESMemoryLedger>(new BESMemoryLedger());
+    }
+
+    // The value of a counter, or zero if it has not been written
+    static uint64_t counter(const string &sample) {
+        ostringstream oss;
+        BESMetrics::TheMetrics()->write_prometheus(oss);
+        istringstream lines(oss.str());
+        string line;
+        while (getline(lines, line)) {
+            if (line.compare(0, sample.size() + 1, sample + " ") == 0)
+                return stoull(line.substr(sample.size() + 1));
+        }
+        return 0;
+    }
+
+public:
+    void setUp() override {
+        TheBESKeys::TheKeys()->set_key("BES.LogName", "./bes.log");
+        TheBESKeys::TheKeys()->set_key("BES.Metrics.Enabled", "yes");
+    }
+
+    void disabled_test() {
+        TheBESKeys::TheKeys()->set_key("BES.MemoryLedger.budget", "0");
+        BESMemoryLedger ledger;
+        CPPUNIT_ASSERT(!ledger.enabled());
+        auto reservation = ledger.admit(100 * MB, 100 * MB);
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, reservation.bytes());
+        CPPUNIT_ASSERT(!reservation.is_streaming());
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger.get_reserved());
+    }
+
+    void admit_release_test() {
+        auto ledger = make_ledger("0");
+        CPPUNIT_ASSERT(ledger->enabled());
+        CPPUNIT_ASSERT_EQUAL(MB, ledger->get_budget());
+        {
+            auto first = ledger->admit(MB / 2, MB / 8);
+            CPPUNIT_ASSERT(!first.is_streaming());
+            CPPUNIT_ASSERT_EQUAL(MB / 2, ledger->get_reserved());
+
+            // Only the streaming estimate fits now
+            auto second = ledger->admit(MB / 2 + 1, MB / 8);
+            CPPUNIT_ASSERT(second.is_streaming());
+            CPPUNIT_ASSERT_EQUAL(MB / 8, second.bytes());
+            CPPUNIT_ASSERT_EQUAL(MB / 2 + MB / 8, ledger->get_reserved());
+
+            BESMemoryLedger::Reservation moved = std::move(second);
+            CPPUNIT_ASSERT_EQUAL((uint64_t)0, second.bytes());
+            CPPUNIT_ASSERT_EQUAL(MB / 8, moved.bytes());
+            CPPUNIT_ASSERT_EQUAL(MB / 2 + MB / 8, ledger->get_reserved());
+
+            // A reservation can shrink, but not grow
+            moved.trim(MB / 16);
+            CPPUNIT_ASSERT_EQUAL(MB / 16, moved.bytes());
+            CPPUNIT_ASSERT_EQUAL(MB / 2 + MB / 16, ledger->get_reserved());
+            moved.trim(MB);
+            CPPUNIT_ASSERT_EQUAL(MB / 16, moved.bytes());
+
+            first.release();
+            CPPUNIT_ASSERT_EQUAL(MB / 16, ledger->get_reserved());
+        }
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger->get_reserved());
+    }
+
+    void too_big_test() {
+        auto ledger = make_ledger("0");
+        CPPUNIT_ASSERT_THROW(ledger->admit(2 * MB, 2 * MB), BESSyntaxUserError);
+
+        // Too big to build, but it can be streamed
+        auto reservation = ledger->admit(2 * MB, MB / 4);
+        CPPUNIT_ASSERT(reservation.is_streaming());
+        CPPUNIT_ASSERT_EQUAL(MB / 4, ledger->get_reserved());
+    }
+
+    void rejected_test() {
+        auto ledger = make_ledger("1");
+        auto held = ledger->admit(MB, MB);
+
+        auto start = chrono::steady_clock::now();
+        CPPUNIT_ASSERT_THROW(ledger->admit(MB / 2, MB / 2), BESTimeoutError);
+        chrono::duration<double> waited = chrono::steady_clock::now() - start;
+        DBG(cerr << "Waited " << waited.count() << "s" << endl);
+        CPPUNIT_ASSERT(waited.count() >= 1.0);
+        CPPUNIT_ASSERT_EQUAL(MB, ledger->get_reserved());
+    }
+
+    void queued_test() {
+        auto ledger = make_ledger("10");
+        auto held = ledger->admit(MB, MB);
+
+        thread releaser([&held]() {
+            this_thread::sleep_for(chrono::milliseconds(200));
+            held.release();
+        });
+        auto reservation = ledger->admit(MB / 2, MB / 2);
+        releaser.join();
+
+        CPPUNIT_ASSERT_EQUAL(MB / 2, reservation.bytes());
+        CPPUNIT_ASSERT_EQUAL(MB / 2, ledger->get_reserved());
+    }
+
+    // A process that dies holding a reservation does not keep the memory.
+    void dead_process_test() {
+        auto ledger = make_ledger("0");
+
+        pid_t pid = fork();
+        CPPUNIT_ASSERT(pid >= 0);
+        if (pid == 0) {
+            auto reservation = ledger->admit(MB, MB);
+            _exit(reservation.bytes() == MB ? 0 : 1);    // the destructor never runs
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CPPUNIT_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        CPPUNIT_ASSERT_EQUAL(MB, ledger->get_reserved());
+
+        auto reservation = ledger->admit(MB, MB);
+        CPPUNIT_ASSERT_EQUAL(MB, ledger->get_reserved());
+    }
+
+    // A live process that reused the pid of a dead one does not keep its memory.
+    void reused_pid_test() {
+        auto ledger = make_ledger("0");
+        const uint64_t start = BESMemoryLedger::process_start_time(getpid());
+        CPPUNIT_ASSERT(start != 0);
+
+        BESMemoryLedger::Slot &slot = ledger->d_table->slots[0];
+        slot.pid = getpid();
+        slot.start = start;
+        slot.bytes = MB;
+        CPPUNIT_ASSERT_THROW(ledger->admit(MB / 2, MB / 2), BESTimeoutError);
+
+        slot.start = start + 1;
+        CPPUNIT_ASSERT_EQUAL(MB, ledger->get_reserved());
+        auto reservation = ledger->admit(MB / 2, MB / 2);
+        CPPUNIT_ASSERT_EQUAL(MB / 2, reservation.bytes());
+        CPPUNIT_ASSERT_EQUAL(MB / 2, ledger->get_reserved());
+    }
+
+    // The lock is taken over from a process that has exited, even if its pid was reused.
+    void stale_lock_test() {
+        auto ledger = make_ledger("0");
+
+        pid_t pid = fork();
+        CPPUNIT_ASSERT(pid >= 0);
+        if (pid == 0)
+            _exit(0);
+        waitpid(pid, nullptr, 0);
+        ledger->d_table->lock = pid;
+        ledger->d_table->lock_start = 0;
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger->get_reserved());
+        CPPUNIT_ASSERT_EQUAL((pid_t)0, ledger->d_table->lock.load());
+
+        // The parent is alive, but it is not the process that took the lock
+        const pid_t parent = getppid();
+        const uint64_t start = BESMemoryLedger::process_start_time(parent);
+        CPPUNIT_ASSERT(start != 0);
+        ledger->d_table->lock = parent;
+        ledger->d_table->lock_start = start + 1;
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger->get_reserved());
+        CPPUNIT_ASSERT_EQUAL((pid_t)0, ledger->d_table->lock.load());
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger->d_table->lock_start.load());
+    }
+
+    // Each request is counted once as admitted, streamed or rejected; waiting is counted apart.
+    void metrics_test() {
+        const string admitted = "bes_memory_admissions_total{result=\"admitted\"}";
+        const string streamed = "bes_memory_admissions_total{result=\"streamed\"}";
+        const string rejected = "bes_memory_admissions_total{result=\"rejected\"}";
+        const string queued = "bes_memory_queued_total";
+        const uint64_t admitted_0 = counter(admitted), streamed_0 = counter(streamed);
+        const uint64_t rejected_0 = counter(rejected), queued_0 = counter(queued);
+
+        auto ledger = make_ledger("1");
+        {
+            auto held = ledger->admit(MB / 2, MB / 2);
+            auto streaming = ledger->admit(MB, MB / 4);
+            CPPUNIT_ASSERT_THROW(ledger->admit(MB / 2, MB / 2), BESTimeoutError);
+        }
+        CPPUNIT_ASSERT_THROW(ledger->admit(2 * MB, 2 * MB), BESSyntaxUserError);
+
+        auto held = ledger->admit(MB, MB);
+        thread releaser([&held]() {
+            this_thread::sleep_for(chrono::milliseconds(200));
+            held.release();
+        });
+        auto waited = ledger->admit(MB / 2, MB / 2);
+        releaser.join();
+
+        CPPUNIT_ASSERT_EQUAL(admitted_0 + 3, counter(admitted));
+        CPPUNIT_ASSERT_EQUAL(streamed_0 + 1, counter(streamed));
+        CPPUNIT_ASSERT_EQUAL(rejected_0 + 2, counter(rejected));
+        CPPUNIT_ASSERT_EQUAL(queued_0 + 2, counter(queued));
+    }
+
+    // The point of the shared table: children share one budget.
+    void fork_test() {
+        auto ledger = make_ledger("30");
+
+        vector<pid_t> children;
+        for (int c = 0; c < 4; ++c) {
+            pid_t pid = fork();
+            CPPUNIT_ASSERT(pid >= 0);
+            if (pid == 0) {
+                for (int i = 0; i < 50; ++i) {
+                    auto reservation = ledger->admit(MB / 2, MB / 2);
+                    if (ledger->get_reserved() > ledger->get_budget())
+                        _exit(1);
+                    this_thread::sleep_for(chrono::microseconds(100));
+                }
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            CPPUNIT_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, ledger->get_reserved());
+    }
+
+    CPPUNIT_TEST_SUITE(BESMemoryLedgerTest);
+
+    CPPUNIT_TEST(disabled_test);
+    CPPUNIT_TEST(admit_release_test);
+    CPPUNIT_TEST(too_big_test);
+    CPPUNIT_TEST(rejected_test);
+    CPPUNIT_TEST(queued_test);
+    CPPUNIT_TEST(dead_process_test);
+    CPPUNIT_TEST(reused_pid_test);
+    CPPUNIT_TEST(stale_lock_test);
+    CPPUNIT_TEST(metrics_test);
+    CPPUNIT_TEST(fork_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESMemoryLedgerTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESMemoryLedgerTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
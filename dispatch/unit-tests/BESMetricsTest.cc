@@ -0,0 +1,268 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include "BESMetrics.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+class BESMetricsTest : public CppUnit::TestFixture {
+    unique_ptr<BESMetrics> make_metrics(const string &entries) {
+        TheBESKeys::TheKeys()->set_key("BES.Metrics.Enabled", "yes");
+        TheBESKeys::TheKeys()->set_key("BES.Metrics.Entries", entries);
+        return unique_ptr<BESMetrics>(new BESMetrics());
+    }
+
+    string text(const BESMetrics &metrics) {
+        ostringstream oss;
+        metrics.write_prometheus(oss);
+        DBG(cerr << oss.str());
+        return oss.str();
+    }
+
+    bool contains(const string &haystack, const string &needle) { return haystack.find(needle) != string::npos; }
+
+public:
+    void setUp() override { TheBESKeys::TheKeys()->set_key("BES.LogName", "./bes.log"); }
+
+    void disabled_test() {
+        TheBESKeys::TheKeys()->set_key("BES.Metrics.Enabled", "no");
+        BESMetrics metrics;
+        CPPUNIT_ASSERT(!metrics.enabled());
+        metrics.add("bes_test_total");
+        metrics.observe("bes_test_seconds", 1.0);
+        CPPUNIT_ASSERT(text(metrics).empty());
+    }
+
+    void counter_gauge_test() {
+        auto metrics = make_metrics("64");
+        CPPUNIT_ASSERT(metrics->enabled());
+        metrics->add("bes_test_total");
+        metrics->add("bes_test_total", 4);
+        metrics->add("bes_test_total", 2, BESMetrics::label("result", "hit"));
+        metrics->gauge_set("bes_test_gauge", 10);
+        metrics->gauge_add("bes_test_gauge", -3);
+        metrics->add("bes_test_total_other");
+
+        string out = text(*metrics);
+        CPPUNIT_ASSERT(contains(out, "# TYPE bes_test_total counter\n"));
+        CPPUNIT_ASSERT(contains(out, "\nbes_test_total 5\n"));
+        CPPUNIT_ASSERT(contains(out, "\nbes_test_total{result=\"hit\"} 2\n"));
+        CPPUNIT_ASSERT(contains(out, "# TYPE bes_test_gauge gauge\nbes_test_gauge 7\n"));
+        // One TYPE line per name
+        CPPUNIT_ASSERT_EQUAL(out.find("# TYPE bes_test_total counter"), out.rfind("# TYPE bes_test_total counter"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_total{result=\"hit\"} 2\n# TYPE bes_test_total_other counter\n"));
+    }
+
+    void histogram_test() {
+        auto metrics = make_metrics("64");
+        string labels = BESMetrics::label("action", "get.dap");
+        metrics->observe("bes_test_seconds", 0.002, labels);
+        metrics->observe("bes_test_seconds", 0.3, labels);
+        metrics->observe("bes_test_seconds", 1000, labels);
+
+        string out = text(*metrics);
+        CPPUNIT_ASSERT(contains(out, "# TYPE bes_test_seconds histogram\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_bucket{action=\"get.dap\",le=\"0.005\"} 1\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_bucket{action=\"get.dap\",le=\"0.25\"} 1\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_bucket{action=\"get.dap\",le=\"0.5\"} 2\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_bucket{action=\"get.dap\",le=\"60\"} 2\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_bucket{action=\"get.dap\",le=\"+Inf\"} 3\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_sum{action=\"get.dap\"} 1000.302000\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_count{action=\"get.dap\"} 3\n"));
+    }
+
+    void label_test() {
+        CPPUNIT_ASSERT_EQUAL(string("a=\"x\\\"y\\\\z\\n\""), BESMetrics::label("a", "x\"y\\z\n"));
+    }
+
+    void full_test() {
+        auto metrics = make_metrics("4");
+        for (int i = 0; i < 10; ++i)
+            metrics->add("bes_test_" + to_string(i) + "_total");
+
+        string out = text(*metrics);
+        size_t n = 0;
+        for (string::size_type pos = 0; (pos = out.find("# TYPE", pos)) != string::npos; ++pos)
+            ++n;
+        CPPUNIT_ASSERT_EQUAL((size_t)4, n);
+
+        // A name too long to store, and a name reused with another type, are ignored.
+        metrics->add(string(BESMetrics::max_key_length + 1, 'x'));
+        metrics->observe("bes_test_0_total", 1.0);
+        CPPUNIT_ASSERT_EQUAL(out, text(*metrics));
+    }
+
+    void threads_test() {
+        auto metrics = make_metrics("64");
+        vector<thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&metrics, t]() {
+                for (int i = 0; i < 10000; ++i) {
+                    metrics->add("bes_test_total", 1, BESMetrics::label("n", to_string(i % 4)));
+                    metrics->observe("bes_test_seconds", 0.01);
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+
+        string out = text(*metrics);
+        for (int n = 0; n < 4; ++n)
+            CPPUNIT_ASSERT(contains(out, "bes_test_total{n=\"" + to_string(n) + "\"} 20000\n"));
+        CPPUNIT_ASSERT(contains(out, "bes_test_seconds_count 80000\n"));
+    }
+
+    // An entry left half claimed for a key, by a slow process or one killed
+    // during the claim, must not lead to a second entry for that key.
+    void stalled_claim_test() {
+        auto metrics = make_metrics("2");
+        const string key = "bes_test_total";
+
+        // BESMetrics hashes keys with FNV-1a; a claim is marked with the top
+        // bit of the state and 31 bits of the hash.
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        BESMetrics::Entry &home = metrics->d_entries[hash % 2];
+        home.state = 0x80000000 | static_cast<uint32_t>(hash >> 33);
+
+        metrics->add(key);
+        CPPUNIT_ASSERT(text(*metrics).empty());
+
+        // The claim finishes
+        home.type = BESMetrics::counter;
+        strcpy(home.key, key.c_str());
+        home.state = 1;
+
+        metrics->add(key, 2);
+        string out = text(*metrics);
+        CPPUNIT_ASSERT(contains(out, "\nbes_test_total 2\n"));
+        CPPUNIT_ASSERT_EQUAL(out.find("\nbes_test_total "), out.rfind("\nbes_test_total "));
+    }
+
+    // The point of the shared table: children's updates are seen by the parent.
+    void fork_test() {
+        auto metrics = make_metrics("64");
+        metrics->add("bes_test_total");
+
+        vector<pid_t> children;
+        for (int c = 0; c < 4; ++c) {
+            pid_t pid = fork();
+            CPPUNIT_ASSERT(pid >= 0);
+            if (pid == 0) {
+                for (int i = 0; i < 1000; ++i) {
+                    metrics->add("bes_test_total");
+                    metrics->add("bes_test_child_total", 1, BESMetrics::label("child", to_string(c)));
+                }
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            CPPUNIT_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+
+        string out = text(*metrics);
+        CPPUNIT_ASSERT(contains(out, "\nbes_test_total 4001\n"));
+        for (int c = 0; c < 4; ++c)
+            CPPUNIT_ASSERT(contains(out, "bes_test_child_total{child=\"" + to_string(c) + "\"} 1000\n"));
+    }
+
+    CPPUNIT_TEST_SUITE(BESMetricsTest);
+
+    CPPUNIT_TEST(disabled_test);
+    CPPUNIT_TEST(counter_gauge_test);
+    CPPUNIT_TEST(histogram_test);
+    CPPUNIT_TEST(label_test);
+    CPPUNIT_TEST(full_test);
+    CPPUNIT_TEST(threads_test);
+    CPPUNIT_TEST(stalled_claim_test);
+    CPPUNIT_TEST(fork_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESMetricsTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESMetricsTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <unistd.h>
+
+#include "BESInternalError.h"
+#include "BESPatternMatcher.h"
+#include "BESRegex.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+// TypeMatch patterns like those in the handler .conf files
+static const vector<string> type_patterns = {
+    R"(.*\.(nc|NC)(\.gz|\.bz2|\.Z)?$)", R"(.*\.nc4(\.gz|\.bz2|\.Z)?$)", R"(.*\.(HDF5|h5|he5|H5)(\.bz2|\.gz|\.Z)?$)",
+    R"(.*\.(HDF|hdf|EOS|eos)(\.gz|\.bz2|\.Z)?$)", R"(.*\.(fits|FITS)(\.gz|\.bz2|\.Z)?$)",
+    R"(.*\.(dat|bin)$)", R"(.*\.csv(\.gz)?$)", R"(.*\.(ncml|NCML)$)", R"(.*\.dmrpp(\.gz)?$)",
+    R"(.*\.(tif|TIF|tiff|TIFF)$)", R"(.*\.(jp2|JP2)$)", R"(.*\.(grb|grib|grib2)(\.gz)?$)",
+    R"(.*\.xml$)", R"(.*\.json$)", R"(.*\.(asc|txt)$)", R"(.*\.das$)", R"(.*\.dds$)", R"(.*\.dods$)",
+    R"(.*\.sqlite$)", R"(.*\.shp$)"
+};
+
+/// The way BESCatalogUtils::get_handler_name() used to work.
+static int compile_every_time(const vector<string> &patterns, const string &name) {
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        BESRegex expr(patterns[i].c_str());
+        if (expr.match(name.c_str(), name.size()) == (int)name.size())
+            return (int)i;
+    }
+    return -1;
+}
+
+class BESPatternMatcherTest : public CppUnit::TestFixture {
+    vector<string> names;
+
+public:
+    void setUp() override {
+        if (names.empty()) {
+            const vector<string> suffixes = {".nc", ".h5", ".hdf", ".csv.gz", ".dmrpp", ".tiff", ".grib2",
+                                             ".txt", ".sqlite", ".nc.bz2", ".jpg", ".md", ""};
+            for (int i = 0; i < 2000; ++i)
+                names.push_back("granule_" + to_string(i) + "_20250101T000000" + suffixes[i % suffixes.size()]);
+        }
+    }
+
+    void empty_test() {
+        BESPatternMatcher matcher;
+        CPPUNIT_ASSERT(matcher.empty());
+        CPPUNIT_ASSERT(matcher.first_match("anything") == -1);
+        CPPUNIT_ASSERT(!matcher.matches(""));
+    }
+
+    void order_test() {
+        BESPatternMatcher matcher({R"(.*\.nc$)", R"(.*\.h5$)", R"(.*)"});
+        CPPUNIT_ASSERT(matcher.size() == 3);
+        CPPUNIT_ASSERT(matcher.first_match("a.nc") == 0);
+        CPPUNIT_ASSERT(matcher.first_match("a.h5") == 1);
+        CPPUNIT_ASSERT(matcher.first_match("a.txt") == 2);
+        CPPUNIT_ASSERT(matcher.pattern(1) == R"(.*\.h5$)");
+    }
+
+    // A pattern must match the whole string, as BESRegex::match() reports it.
+    void full_match_test() {
+        BESPatternMatcher matcher({"nc", "a|ab"});
+        CPPUNIT_ASSERT(!matcher.matches("x.nc"));
+        CPPUNIT_ASSERT(matcher.first_match("nc") == 0);
+        CPPUNIT_ASSERT(matcher.first_match("a") == 1);
+        // The leftmost alternative wins, so "ab" is not a full match; this is the
+        // same answer the catalog code always got.
+        CPPUNIT_ASSERT(!matcher.matches("ab"));
+    }
+
+    void literal_suffixes_test() {
+        vector<string> suffixes;
+        CPPUNIT_ASSERT(BESPatternMatcher::literal_suffixes(R"(.*\.(nc|NC)(\.gz)?$)", suffixes));
+        CPPUNIT_ASSERT((suffixes == vector<string>{".NC", ".NC.gz", ".nc", ".nc.gz"}));
+
+        CPPUNIT_ASSERT(BESPatternMatcher::literal_suffixes(R"(^.*\.h5$)", suffixes));
+        CPPUNIT_ASSERT((suffixes == vector<string>{".h5"}));
+
+        // These are left to the regex engine
+        CPPUNIT_ASSERT(!BESPatternMatcher::literal_suffixes(R"(.*\.nc)", suffixes));      // no '$'
+        CPPUNIT_ASSERT(!BESPatternMatcher::literal_suffixes(R"(data/.*\.nc$)", suffixes)); // no leading '.*'
+        CPPUNIT_ASSERT(!BESPatternMatcher::literal_suffixes(R"(.*\.nc[34]$)", suffixes)); // bracket expression
+        CPPUNIT_ASSERT(!BESPatternMatcher::literal_suffixes(R"(.*_\d+\.nc$)", suffixes)); // \d and '+'
+        CPPUNIT_ASSERT(!BESPatternMatcher::literal_suffixes(R"(.*\.nc$|.*\.h5$)", suffixes)); // top-level '|'
+    }
+
+    // Suffix patterns and regex patterns mixed; the first in the list must win.
+    void mixed_order_test() {
+        BESPatternMatcher matcher({R"(.*_special\.nc$)", R"(data_[0-9]+\.nc)", R"(.*\.nc$)"});
+        CPPUNIT_ASSERT(matcher.first_match("x_special.nc") == 0);
+        CPPUNIT_ASSERT(matcher.first_match("data_12.nc") == 1);
+        CPPUNIT_ASSERT(matcher.first_match("data_x.nc") == 2);
+        CPPUNIT_ASSERT(matcher.first_match("data.h5") == -1);
+    }
+
+    // '.' does not match a newline, so a name with one is not a full match of '.*\.nc$'
+    void line_terminator_test() {
+        BESPatternMatcher matcher({R"(.*\.nc$)"});
+        CPPUNIT_ASSERT(matcher.matches("a.nc"));
+        CPPUNIT_ASSERT_EQUAL(compile_every_time({R"(.*\.nc$)"}, "a\nb.nc"), matcher.first_match("a\nb.nc"));
+    }
+
+    void malformed_pattern_test() {
+        BESPatternMatcher matcher;
+        CPPUNIT_ASSERT_THROW(matcher.add("(unbalanced"), BESInternalError);
+        CPPUNIT_ASSERT(matcher.empty());
+    }
+
+    void same_as_compile_every_time_test() {
+        BESPatternMatcher matcher(type_patterns);
+        for (const auto &name: names)
+            CPPUNIT_ASSERT_EQUAL(compile_every_time(type_patterns, name), matcher.first_match(name));
+    }
+
+    // Not an assertion about speed; run with -d to see the numbers.
+    void benchmark_test() {
+        using namespace std::chrono;
+
+        auto t0 = steady_clock::now();
+        int found_old = 0;
+        for (const auto &name: names)
+            found_old += compile_every_time(type_patterns, name) != -1;
+        auto t1 = steady_clock::now();
+
+        int found_new = 0;
+        BESPatternMatcher matcher(type_patterns);
+        for (const auto &name: names)
+            found_new += matcher.matches(name);
+        auto t2 = steady_clock::now();
+
+        CPPUNIT_ASSERT(found_old == found_new);
+
+        DBG(cerr << names.size() << " names, " << type_patterns.size() << " patterns, " << found_new << " matched"
+                 << endl);
+        DBG(cerr << "Compile for every test: " << duration<double>(t1 - t0).count() << " s" << endl);
+        DBG(cerr << "Compile once:           " << duration<double>(t2 - t1).count() << " s" << endl);
+    }
+
+CPPUNIT_TEST_SUITE(BESPatternMatcherTest);
+
+    CPPUNIT_TEST(empty_test);
+    CPPUNIT_TEST(order_test);
+    CPPUNIT_TEST(full_match_test);
+    CPPUNIT_TEST(literal_suffixes_test);
+    CPPUNIT_TEST(mixed_order_test);
+    CPPUNIT_TEST(line_terminator_test);
+    CPPUNIT_TEST(malformed_pattern_test);
+    CPPUNIT_TEST(same_as_compile_every_time_test);
+    CPPUNIT_TEST(benchmark_test);
+
+CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESPatternMatcherTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESPatternMatcherTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include "BESContextManager.h"
+#include "BESTrace.h"
+#include "TheBESKeys.h"
+
+using namespace std;
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) x; } while(false)
+
+class BESTraceTest : public CppUnit::TestFixture {
+    string trace() {
+        ostringstream oss;
+        BESTrace::write_chrome_trace(oss);
+        DBG(cerr << oss.str());
+        return oss.str();
+    }
+
+    static size_t count(const string &haystack, const string &needle) {
+        size_t n = 0;
+        for (auto pos = haystack.find(needle); pos != string::npos; pos = haystack.find(needle, pos + 1))
+            ++n;
+        return n;
+    }
+
+public:
+    void setUp() override { TheBESKeys::TheKeys()->set_key("BES.LogName", "./bes.log"); }
+
+    void tearDown() override { BESTrace::stop(); }
+
+    void disabled_test() {
+        int evaluated = 0;
+        auto name = [&evaluated]() { ++evaluated; return string("span"); };
+        {
+            BES_TRACE_SPAN("test", name());
+        }
+        CPPUNIT_ASSERT_EQUAL(0, evaluated);
+        CPPUNIT_ASSERT(!BESTrace::enabled());
+    }
+
+    void nested_test() {
+        BESTrace::start("nested", 100);
+        {
+            BES_TRACE_SPAN("test", "outer");
+            usleep(2000);
+            {
+                BES_TRACE_SPAN("test", string("inner ") + "span");
+                usleep(2000);
+            }
+        }
+        BESTrace::stop();
+        CPPUNIT_ASSERT_EQUAL((size_t)2, BESTrace::size());
+
+        string out = trace();
+        CPPUNIT_ASSERT(out.find("\"traceEvents\":[") != string::npos);
+        CPPUNIT_ASSERT(out.find("\"request_id\":\"nested\"") != string::npos);
+        CPPUNIT_ASSERT(out.find("\"name\":\"inner span\",\"cat\":\"test\",\"ph\":\"X\"") != string::npos);
+        // Sorted by start time, so the outer span comes first.
+        CPPUNIT_ASSERT(out.find("\"outer\"") < out.find("\"inner span\""));
+        CPPUNIT_ASSERT_EQUAL((size_t)1, count(out, "\"thread_name\""));
+    }
+
+    void threads_test() {
+        BESTrace::start("threads", 1000);
+        {
+            BES_TRACE_SPAN("test", "request");
+            vector<thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([]() {
+                    for (int i = 0; i < 10; ++i) {
+                        BES_TRACE_SPAN("test", "work");
+                    }
+                });
+            }
+            for (auto &t : threads)
+                t.join();
+        }
+        BESTrace::stop();
+
+        CPPUNIT_ASSERT_EQUAL((size_t)41, BESTrace::size());
+        string out = trace();
+        CPPUNIT_ASSERT_EQUAL((size_t)5, count(out, "\"thread_name\""));
+        CPPUNIT_ASSERT_EQUAL((size_t)4, count(out, "\"name\":\"worker "));
+    }
+
+    // Spans that straddle the start or end of a trace are not recorded.
+    void generation_test() {
+        BESTrace::start("first", 100);
+        BESTraceSpan early;
+        early.start("test", "early");
+        BESTrace::start("second", 100);
+        early.stop();
+
+        BESTraceSpan late;
+        late.start("test", "late");
+        BESTrace::stop();
+        late.stop();
+
+        CPPUNIT_ASSERT_EQUAL((size_t)0, BESTrace::size());
+    }
+
+    void max_events_test() {
+        BESTrace::start("max", 5);
+        for (int i = 0; i < 8; ++i) {
+            BES_TRACE_SPAN("test", "span");
+        }
+        BESTrace::stop();
+        CPPUNIT_ASSERT_EQUAL((size_t)5, BESTrace::size());
+        CPPUNIT_ASSERT(trace().find("\"dropped_events\":3") != string::npos);
+    }
+
+    void request_test() {
+        char tmpl[] = "/tmp/BESTraceTest_XXXXXX";
+        CPPUNIT_ASSERT(mkdtemp(tmpl));
+        string dir = tmpl;
+
+        // No context, no trace
+        TheBESKeys::TheKeys()->set_key("BES.Trace.Directory", dir);
+        CPPUNIT_ASSERT(!BESTrace::begin_request("r1"));
+
+        // A context but no directory, no trace
+        BESContextManager::TheManager()->set_context("bes_trace", "true");
+        TheBESKeys::TheKeys()->set_key("BES.Trace.Directory", "");
+        CPPUNIT_ASSERT(!BESTrace::begin_request("r1"));
+
+        TheBESKeys::TheKeys()->set_key("BES.Trace.Directory", dir);
+        CPPUNIT_ASSERT(BESTrace::begin_request("r1/x"));
+        {
+            BES_TRACE_SPAN("test", "request");
+        }
+        // Checking again before the next command keeps the trace going
+        CPPUNIT_ASSERT(BESTrace::begin_request("r1/x"));
+        CPPUNIT_ASSERT_EQUAL((size_t)1, BESTrace::size());
+        string file_name = BESTrace::end_request();
+        BESContextManager::TheManager()->unset_context("bes_trace");
+        DBG(cerr << "Trace file: " << file_name << endl);
+
+        CPPUNIT_ASSERT_EQUAL(dir + "/bes_trace_" + to_string(getpid()) + "_r1_x.json", file_name);
+        ifstream in(file_name);
+        string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        CPPUNIT_ASSERT(contents.find("\"name\":\"request\",\"cat\":\"test\"") != string::npos);
+        CPPUNIT_ASSERT(!BESTrace::enabled());
+        CPPUNIT_ASSERT(BESTrace::end_request().empty());
+
+        unlink(file_name.c_str());
+        rmdir(dir.c_str());
+    }
+
+    CPPUNIT_TEST_SUITE(BESTraceTest);
+
+    CPPUNIT_TEST(disabled_test);
+    CPPUNIT_TEST(nested_test);
+    CPPUNIT_TEST(threads_test);
+    CPPUNIT_TEST(generation_test);
+    CPPUNIT_TEST(max_events_test);
+    CPPUNIT_TEST(request_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BESTraceTest);
+
+int main(int argc, char *argv[]) {
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "d")) != -1) {
+        switch (option_char) {
+        case 'd':
+            debug = true; // debug is a static global
+            break;
+        default:
+            break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    bool wasSuccessful = true;
+    string test;
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    } else {
+        int i = 0;
+        while (i < argc) {
+            if (debug)
+                cerr << "Running " << argv[i] << endl;
+            test = BESTraceTest::suite()->getName().append("::").append(argv[i]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+            ++i;
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -32,7 +32,6 @@
 #include "BESUtil.h"
 #include "BESCatalogList.h"
 #include "BESCatalogUtils.h"
-#include "BESRegex.h"
 #include "TheBESKeys.h"
 #include "BESDebug.h"
 
@@ -171,21 +170,21 @@ bool AllowedHosts::is_allowed(const http::url &candidate_url, std::string &why_n
 }
 
 bool AllowedHosts::check(const std::string &url) const {
-    bool isAllowed=false;
-    for (auto const &a_regex_pattern: d_allowed_hosts) {
-        BESRegex reg_expr(a_regex_pattern.c_str());
-        int match_result = reg_expr.match(url.c_str(), (int)url.size());
-        if (match_result >= 0) {
-            if (match_result == static_cast<int>(url.size())) {
-                BESDEBUG(MODULE, prolog << "FULL MATCH. pattern: " << a_regex_pattern << " url: " << url << endl);
-                isAllowed = true;;
-            } else {
-                BESDEBUG(MODULE,  prolog << "No Match. pattern: " << a_regex_pattern << " url: " << url << endl);
-            }
-        }
+    // The patterns are compiled here, not in the constructor, because the constructor
+    // must not throw. If compiling throws, call_once() will try again on the next call.
+    std::call_once(d_compile_once, [this]() {
+        BESPatternMatcher matcher(d_allowed_hosts);
+        d_allowed_hosts_matcher = std::move(matcher);
+    });
+
+    int i = d_allowed_hosts_matcher.first_match(url);
+    if (i != -1) {
+        BESDEBUG(MODULE, prolog << "FULL MATCH. pattern: " << d_allowed_hosts_matcher.pattern(i) << " url: " << url << endl);
+        return true;
     }
 
-    return isAllowed;
+    BESDEBUG(MODULE,  prolog << "No Match. url: " << url << endl);
+    return false;
 }
 
 } // namespace http
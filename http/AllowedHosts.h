@@ -31,9 +31,11 @@
 #ifndef I_AllowedHosts_H
 #define I_AllowedHosts_H 1
 
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "BESPatternMatcher.h"
 #include "url_impl.h"
 
 #define ALLOWED_HOSTS_BES_KEY "AllowedHosts"
@@ -54,6 +56,10 @@ class AllowedHosts {
 private:
     std::vector<std::string> d_allowed_hosts;
 
+    // The d_allowed_hosts patterns, compiled on first use by check().
+    mutable BESPatternMatcher d_allowed_hosts_matcher;
+    mutable std::once_flag d_compile_once;
+
     bool check(const std::string &url) const;
 
     // Private constructor to prevent direct instantiation
@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <ctime>
 #include <cstring>
+#include <strings.h>
 
 #include <curl/curl.h>
 
@@ -43,6 +44,7 @@
 #include "BESRegex.h"
 #include "TheBESKeys.h"
 #include "BESLog.h"
+#include "BESMetrics.h"
 #include "BESStopWatch.h"
 
 #include "HttpNames.h"
@@ -994,6 +996,7 @@ static bool eval_http_get_response(CURL *ceh, const string &requested_url, long
         case 206: // Partial content - this is to be expected since we use range gets
             // cases 201-205 are things we should probably reject, unless we add more
             // comprehensive HTTP/S processing here. jhrg 8/8/18
+        case 304: // Not Modified - only returned for the conditional GETs made by HttpCache
             return true;
 
         default:
@@ -1099,6 +1102,7 @@ static void super_easy_perform(CURL *c_handle, int fd) {
                 effective_url = "Unable_To_Determine_CURLINFO_EFFECTIVE_URL: " + bie.get_message();
             }
             if (attempts == retry_limit) {
+                BESMetrics::TheMetrics()->add("bes_curl_failures_total", 1, BESMetrics::label("operation", "transfer"));
                 stringstream msg;
                 msg << prolog << "ERROR - Made " << retry_limit << " failed attempts to retrieve the URL ";
                 msg << filter_aws_url(target_url) << " The retry limit has been exceeded. Giving up! ";
@@ -1115,6 +1119,7 @@ static void super_easy_perform(CURL *c_handle, int fd) {
                                  + filter_aws_url(target_url) + " attempt: " + std::to_string(attempts) + "). "
                                  + "CURLINFO_EFFECTIVE_URL: " + effective_url + " "
                                  + "Returned HTTP_STATUS: " + std::to_string(http_code));
+                BESMetrics::TheMetrics()->add("bes_curl_retries_total", 1, BESMetrics::label("operation", "transfer"));
                 usleep(retry_time);
                 retry_time *= 2;
 
@@ -1154,15 +1159,17 @@ static void super_easy_perform(CURL *c_handle, int fd) {
  * @param http_response_headers Value/result parameter for the HTTP Response Headers.
  * @param http_request_headers A pointer to a curl_slist of HTTP request headers. Default is
  * null. These headers will be appended to the list of default headers.
+ * @return The HTTP response code; 200 unless the request was conditional (304).
  * @exception Error Thrown if libcurl encounters a problem; the libcurl
  * error message is stuffed into the Error object.
  */
-void http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, int fd,
+long http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, int fd,
                                  vector <string> *http_response_headers, curl_slist *http_request_headers) {
 
     vector<char> error_buffer(CURL_ERROR_SIZE, (char) 0);
     CURLcode res;
     CURL *ceh = nullptr;
+    long http_code = 0;
 
     BESDEBUG(MODULE, prolog << "BEGIN" << endl);
     // Before we do anything, make sure that the URL is OK to pursue.
@@ -1191,6 +1198,7 @@ void http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, i
         unset_error_buffer(ceh);
 
         super_easy_perform(ceh, fd);
+        http_code = get_http_code(ceh);
 
         // Free the header list
         BESDEBUG(MODULE, prolog << "Cleanup request headers. Calling curl_slist_free_all()." << endl);
@@ -1211,6 +1219,7 @@ void http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, i
     }
 
     BESDEBUG(MODULE, prolog << "END" << endl);
+    return http_code;
 }
 
 /**
@@ -1276,17 +1285,22 @@ curl_slist *add_edl_hdr_from_the_cm(const std::string &target_url, curl_slist *r
  * appended to this string.
  * @param http_request_headers A pointer to a curl_slist of HTTP request headers. Default is
  * null. These headers will be appended to the list of default headers.
+ * @param http_response_headers Value/result parameter for the HTTP Response Headers. Default
+ * is null.
+ * @return The HTTP response code; 200 unless the request was conditional (304).
  * @exception Throws when libcurl encounters a problem.
  */
-void http_get(const string &target_url, string &buf, curl_slist *http_request_headers) {
+long http_get(const string &target_url, string &buf, curl_slist *http_request_headers,
+              vector<string> *http_response_headers) {
     BESDEBUG(MODULE, prolog << "BEGIN\n");
 
     vector<char> error_buffer(CURL_ERROR_SIZE, (char) 0);
     CURL *ceh = nullptr;     ///< The libcurl handle object.
     CURLcode res;
+    long http_code = 0;
 
     try {
-        ceh = curl::init(target_url, http_request_headers, nullptr);
+        ceh = curl::init(target_url, http_request_headers, http_response_headers);
         if (!ceh)
             throw BESInternalError(string("ERROR! Failed to acquire cURL Easy Handle! "), __FILE__, __LINE__);
 
@@ -1305,6 +1319,7 @@ void http_get(const string &target_url, string &buf, curl_slist *http_request_he
         unset_error_buffer(ceh);
 
         super_easy_perform(ceh);
+        http_code = get_http_code(ceh);
 
         // Free the header list
         BESDEBUG(MODULE, prolog << "Cleanup request headers. Calling curl_slist_free_all()." << endl);
@@ -1323,6 +1338,146 @@ void http_get(const string &target_url, string &buf, curl_slist *http_request_he
         throw;
     }
     BESDEBUG(MODULE, prolog << "END\n");
+    return http_code;
+}
+
+/// State shared by the callbacks used by http_get_range()
+struct range_response {
+    char *buf = nullptr;                    ///< Where the body goes
+    unsigned long long size = 0;            ///< Size of buf
+    unsigned long long received = 0;        ///< Bytes written to buf by the current response
+    unsigned long long resource_size = 0;   ///< From the Content-Range header; zero if not seen
+};
+
+/**
+ * Header callback for http_get_range(). A status line starts a new response
+ * (a redirect or a retry), so the body offset and size are reset.
+ */
+static size_t range_response_header(const char *data, size_t size, size_t nmemb, void *userdata) {
+    auto response = static_cast<range_response *>(userdata);
+    string line(data, size * nmemb);
+
+    if (line.find("HTTP/") == 0) {
+        response->received = 0;
+        response->resource_size = 0;
+    }
+    else if (line.size() > 14 && strncasecmp(line.c_str(), "Content-Range:", 14) == 0) {
+        // Content-Range: bytes <first>-<last>/<size>; size may be '*'
+        auto slash = line.find('/');
+        if (slash != string::npos)
+            response->resource_size = strtoull(line.c_str() + slash + 1, nullptr, 10);
+    }
+
+    return size * nmemb;
+}
+
+/**
+ * Write callback for http_get_range(). Returning less than nmemb aborts the
+ * transfer; that only happens when the server ignored the Range header and
+ * is sending more than was asked for.
+ */
+static size_t range_response_body(const char *data, size_t /* size */, size_t nmemb, void *userdata) {
+    auto response = static_cast<range_response *>(userdata);
+
+    if (response->received + nmemb > response->size) {
+        BESDEBUG(MODULE, prolog << "Response is larger than the requested range; aborting." << endl);
+        return 0;
+    }
+
+    memcpy(response->buf + response->received, data, nmemb);
+    response->received += nmemb;
+
+    RequestServiceTimer::TheTimer()->throw_if_timeout_expired(CURL_WRITE_TO_FILE_TIMEOUT_MSG, __FILE__, __LINE__);
+
+    return nmemb;
+}
+
+/**
+ * @brief Read part of a resource using an HTTP Range GET
+ *
+ * The request is made (and retried) like http_get(). A server that answers
+ * with the whole resource (a 200 response) is accepted only if the resource
+ * fits in the buffer and offset is zero.
+ *
+ * @param target_url The URL to dereference.
+ * @param offset The offset of the first byte to read
+ * @param size The number of bytes to read; buf must be at least this big.
+ * @param buf Value-result; the bytes read
+ * @param resource_size Value-result; if not null, the size of the whole
+ * resource, or zero if the server did not say.
+ * @param http_request_headers A pointer to a curl_slist of HTTP request headers. Default is
+ * null. These headers will be appended to the list of default headers.
+ * @return The number of bytes read; less than size only at the end of the resource.
+ * @exception BESInternalError if the server did not honor the range.
+ */
+unsigned long long http_get_range(const string &target_url, unsigned long long offset, unsigned long long size,
+                                  char *buf, unsigned long long *resource_size, curl_slist *http_request_headers) {
+    BESDEBUG(MODULE, prolog << "BEGIN\n");
+
+    vector<char> error_buffer(CURL_ERROR_SIZE, (char) 0);
+    CURL *ceh = nullptr;
+    CURLcode res;
+
+    range_response response;
+    response.buf = buf;
+    response.size = size;
+
+    try {
+        ceh = curl::init(target_url, http_request_headers, nullptr);
+        if (!ceh)
+            throw BESInternalError(string("ERROR! Failed to acquire cURL Easy Handle! "), __FILE__, __LINE__);
+
+        set_error_buffer(ceh, error_buffer.data());
+
+        res = curl_easy_setopt(ceh, CURLOPT_RANGE, get_range_arg_string(offset, size).c_str());
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_RANGE", error_buffer.data(), __FILE__, __LINE__);
+
+        // A compressed body could not be matched to the byte range.
+        res = curl_easy_setopt(ceh, CURLOPT_ENCODING, nullptr);
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_ENCODING", error_buffer.data(), __FILE__, __LINE__);
+
+        res = curl_easy_setopt(ceh, CURLOPT_HEADERFUNCTION, range_response_header);
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_HEADERFUNCTION", error_buffer.data(), __FILE__, __LINE__);
+
+        res = curl_easy_setopt(ceh, CURLOPT_HEADERDATA, reinterpret_cast<void *>(&response));
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_HEADERDATA", error_buffer.data(), __FILE__, __LINE__);
+
+        res = curl_easy_setopt(ceh, CURLOPT_WRITEFUNCTION, range_response_body);
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_WRITEFUNCTION", error_buffer.data(), __FILE__, __LINE__);
+
+        res = curl_easy_setopt(ceh, CURLOPT_WRITEDATA, reinterpret_cast<void *>(&response));
+        eval_curl_easy_setopt_result(res, prolog, "CURLOPT_WRITEDATA", error_buffer.data(), __FILE__, __LINE__);
+
+        // We do this because we know super_easy_perform() is going to set it.
+        unset_error_buffer(ceh);
+
+        super_easy_perform(ceh);
+
+        long http_code = get_http_code(ceh);
+        if (http_code == 200) {
+            // The whole resource; fine as long as that is what was asked for.
+            if (offset != 0)
+                throw BESInternalError(prolog + "The server for " + filter_aws_url(target_url)
+                                       + " does not support HTTP Range requests.", __FILE__, __LINE__);
+            response.resource_size = response.received;
+        }
+
+        if (resource_size)
+            *resource_size = response.resource_size;
+
+        curl_slist_free_all(http_request_headers);
+        curl_easy_cleanup(ceh);
+    }
+    catch (...) {
+        curl_slist_free_all(http_request_headers);
+        if (ceh) {
+            curl_easy_cleanup(ceh);
+        }
+        throw;
+    }
+
+    BESDEBUG(MODULE, prolog << "END (" << response.received << " bytes)\n");
+    return response.received;
 }
 
 // used only in one place here. jhrg 3/8/23
@@ -1894,6 +2049,8 @@ std::shared_ptr<http::EffectiveUrl> get_redirect_url(const std::shared_ptr<http:
             success = gru_mk_attempt(origin_url, attempt, retry_limit, req_hdrs, redirect_url);
         }
         curl_slist_free_all(http_request_headers);
+        if (attempt > 1)
+            BESMetrics::TheMetrics()->add("bes_curl_retries_total", attempt - 1, BESMetrics::label("operation", "redirect"));
     }
     catch (...) {
         curl_slist_free_all(http_request_headers);
@@ -49,12 +49,17 @@ namespace curl {
 
 ///@name Get data from a URL
 ///@{
-void http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, int fd,
+long http_get_and_write_resource(const std::shared_ptr<http::url> &target_url, int fd,
                         std::vector<std::string> *http_response_headers, curl_slist *http_request_headers = nullptr);
 
 bool http_head(const std::string &target_url, int tries = 3, unsigned long wait_time_us = 1'000'000);
 
-void http_get(const std::string &target_url, std::string &buf, curl_slist *http_request_headers = nullptr);
+long http_get(const std::string &target_url, std::string &buf, curl_slist *http_request_headers = nullptr,
+              std::vector<std::string> *http_response_headers = nullptr);
+
+unsigned long long http_get_range(const std::string &target_url, unsigned long long offset, unsigned long long size,
+                                  char *buf, unsigned long long *resource_size = nullptr,
+                                  curl_slist *http_request_headers = nullptr);
 
 void super_easy_perform(CURL *ceh);
 ///@}
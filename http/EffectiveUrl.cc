@@ -27,6 +27,7 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <map>
@@ -56,6 +57,33 @@ using std::stringstream;
 
 namespace http {
 
+/**
+ * @brief The time this URL expires.
+ *
+ * This is the earlier of the expiration time encoded in the URL's query string
+ * (see url::expires_time()) and the ingest time plus the Cache-Control max-age
+ * value received with the URL, if any.
+ */
+std::time_t EffectiveUrl::expires_time() {
+    std::time_t expires = url::expires_time();
+
+    bool found = false;
+    string cc_hdr_val;
+    get_header(CACHE_CONTROL_HEADER_KEY, cc_hdr_val, found);
+    if (found) {
+        string max_age_key{"max-age="};
+        size_t max_age_index = cc_hdr_val.find(max_age_key);
+        if (max_age_index != cc_hdr_val.npos) {
+            long long msi = 0;
+            std::istringstream(cc_hdr_val.substr(max_age_index + max_age_key.size())) >> msi;
+            expires = std::min(expires, ingest_time() + static_cast<std::time_t>(msi));
+        }
+    }
+
+    BESDEBUG(MODULE, prolog << "expires_time: " << expires << endl);
+    return expires;
+}
+
 /**
  * @brief Returns true if URL is reusable, false otherwise.
  *
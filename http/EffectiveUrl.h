@@ -76,6 +76,7 @@ public:
 
     ~EffectiveUrl() override = default;
 
+    std::time_t expires_time() override;
     bool is_expired() override;
 
     void get_header(const std::string &name, std::string &value, bool &found );
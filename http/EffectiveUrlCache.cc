@@ -26,7 +26,9 @@
 
 #include "config.h"
 
+#include <chrono>
 #include <mutex>
+#include <thread>
 
 #include <sstream>
 #include <string>
@@ -34,6 +36,8 @@
 #include "TheBESKeys.h"
 #include "BESContextManager.h"
 #include "BESDebug.h"
+#include "BESError.h"
+#include "BESLog.h"
 #include "BESStopWatch.h"
 #include "BESUtil.h"
 #include "CurlUtils.h"
@@ -52,18 +56,155 @@ constexpr auto MODULE_DUMPER = "euc:dump";
 
 namespace http {
 
+/**
+ * @brief Waits for the prefetch threads to finish.
+ *
+ * The prefetch threads use this object, so they are joined before it is destroyed.
+ * They are bounded by the curl timeouts.
+ */
+EffectiveUrlCache::~EffectiveUrlCache() {
+    join_prefetchers();
+}
+
 /**
  * @brief Get the cached effective URL.
- * @param url_key Key to a cached effective URL.
- * @note This method is not, itself, thread safe.
+ * @param url Source URL; the EDL username is appended to form the key.
+ * @return The cached effective URL or nullptr if there is none.
  */
 shared_ptr <EffectiveUrl> EffectiveUrlCache::get_cached_eurl(string const &url) {
-    shared_ptr<EffectiveUrl> effective_url(nullptr);
     auto url_key = append_edl_username_to_key(url);
-    auto it = d_effective_urls.find(url_key);
-    if (it != d_effective_urls.end()) {
-        effective_url = (*it).second;
+    Shard &shard = get_shard(url_key);
+    std::lock_guard<std::mutex> lock_me(shard.mutex);
+    auto it = shard.effective_urls.find(url_key);
+    if (it != shard.effective_urls.end()) {
+        return it->second.effective_url;
     }
+    return nullptr;
+}
+
+/**
+ * @brief Add an effective URL to the cache.
+ *
+ * The time after which the URL must be acquired again is computed here, once,
+ * so that lookups don't have to parse the URL and its headers.
+ *
+ * @param key The source URL with the EDL username appended
+ * @param effective_url The effective URL
+ */
+void EffectiveUrlCache::add_cached_eurl(const string &key, const shared_ptr<EffectiveUrl> &effective_url) {
+    Entry entry;
+    entry.effective_url = effective_url;
+    entry.refresh_time = effective_url->expires_time() - HTTP_URL_REFRESH_THRESHOLD;
+
+    Shard &shard = get_shard(key);
+    std::lock_guard<std::mutex> lock_me(shard.mutex);
+    shard.effective_urls[key] = entry;
+}
+
+/**
+ * @brief Should redirects for this URL be skipped?
+ *
+ * The skip regex is only evaluated the first time a URL is seen; the URLs that
+ * match are remembered in the shard.
+ *
+ * @param shard The shard for this URL. Must be locked by the caller.
+ * @param source_url The source URL
+ * @return True if the URL matches the skip regex
+ */
+bool EffectiveUrlCache::is_skipped(Shard &shard, const string &source_url) {
+    if (shard.skipped.find(source_url) != shard.skipped.end())
+        return true;
+
+    std::call_once(d_skip_regex_flag, [this] { set_skip_regex(); });
+
+    if (d_skip_regex) {
+        size_t match_length = d_skip_regex->match(source_url.c_str(), (int) source_url.size());
+        if (match_length == source_url.size()) {
+            BESDEBUG(MODULE, prolog << "Candidate url matches the "
+                                       "no_redirects_regex_pattern [" << d_skip_regex->pattern() <<
+                                    "][match_length=" << match_length << "] SKIPPING." << endl);
+            shard.skipped.insert(source_url);
+            return true;
+        }
+        BESDEBUG(MODULE, prolog << "Candidate url: '" << source_url
+                                << "' does NOT match the skip_regex pattern [" << d_skip_regex->pattern() << "]"
+                                << endl);
+    } else {
+        BESDEBUG(MODULE, prolog << "The cache_effective_urls_skip_regex() was NOT SET " << endl);
+    }
+    return false;
+}
+
+/**
+ * @brief Is there a fresh effective URL for this key, or is one being acquired?
+ * @param shard The shard for this key. Must be locked by the caller.
+ * @param key The source URL with the EDL username appended
+ */
+bool EffectiveUrlCache::is_fresh_or_in_flight(Shard &shard, const string &key) {
+    auto it = shard.effective_urls.find(key);
+    return (it != shard.effective_urls.end() && time(nullptr) < it->second.refresh_time)
+           || shard.in_flight.find(key) != shard.in_flight.end();
+}
+
+/**
+ * @brief Follow the redirects for source_url and cache the result.
+ *
+ * The caller must have added the future for \arg result to the shard's in_flight map.
+ * It is removed here and the threads waiting on it get the effective URL, or the
+ * exception thrown while acquiring it.
+ *
+ * @param source_url
+ * @param key The source URL with the EDL username appended
+ * @param http_request_headers The http request headers to use; this method takes ownership.
+ * @param result The promise used to pass the result to other threads
+ * @return The effective URL
+ */
+shared_ptr<EffectiveUrl>
+EffectiveUrlCache::acquire_effective_url(const shared_ptr<url> &source_url, const string &key,
+                                         curl_slist *http_request_headers,
+                                         std::promise<shared_ptr<EffectiveUrl>> &result) {
+    BESDEBUG(MODULE, prolog << "Acquiring effective URL for  " << source_url->str() << endl);
+    Shard &shard = get_shard(key);
+    shared_ptr<EffectiveUrl> effective_url;
+    try {
+        BES_STOPWATCH_START(MODULE_TIMER, prolog + "Retrieve and cache effective url for source url: " + source_url->str());
+        try {
+            // This code throws an HttpError exception if there is a problem.
+            effective_url = curl::get_redirect_url(source_url, http_request_headers);
+        }
+        catch (http::HttpError &http_error) {
+            string err_msg = prolog + "Hyrax encountered a Service Chaining Error while "
+                             "attempting to retrieve a redirect URL.\n"
+                             "This is most likely problem with TEA, the AWS URL "
+                             "signing service.\n" + http_error.get_message();
+            http_error.set_message(err_msg);
+            throw;
+        }
+
+        add_cached_eurl(key, effective_url);
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> lock_me(shard.mutex);
+            shard.in_flight.erase(key);
+        }
+        result.set_exception(std::current_exception());
+        throw;
+    }
+
+    BESDEBUG(MODULE, prolog << "   source_url: " << source_url->str() << " ("
+                            << (source_url->is_trusted() ? "" : "NOT ") << "trusted)" << endl);
+    BESDEBUG(MODULE, prolog << "effective_url: " << effective_url->dump() << " ("
+                            << (source_url->is_trusted() ? "" : "NOT ") << "trusted)" << endl);
+
+    {
+        std::lock_guard<std::mutex> lock_me(shard.mutex);
+        shard.in_flight.erase(key);
+    }
+    result.set_value(effective_url);
+
+    BESDEBUG(MODULE, prolog << "Updated record for " << source_url->str() << endl);
+
     return effective_url;
 }
 
@@ -72,7 +213,8 @@ shared_ptr <EffectiveUrl> EffectiveUrlCache::get_cached_eurl(string const &url)
  * skip_regex then it will not be cached.
  *
  * @param source_url
- * @param http_request_headers The http request headers to use when contacting source_url
+ * @param http_request_headers The http request headers to use when contacting source_url.
+ * This method takes ownership of the headers.
  * @returns The effective URL
 */
 shared_ptr <EffectiveUrl> EffectiveUrlCache::get_effective_url(const shared_ptr <url>& source_url, curl_slist *http_request_headers) {
@@ -80,81 +222,65 @@ shared_ptr <EffectiveUrl> EffectiveUrlCache::get_effective_url(const shared_ptr
     BESDEBUG(MODULE, prolog << "BEGIN url: " << source_url->str() << endl);
     BESDEBUG(MODULE_DUMPER, prolog << "dump: " << endl << dump() << endl);
 
-    // Lock access to the cache, the d_effective_urls map. Released when the lock goes out of scope.
-    std::lock_guard<std::mutex> lock_me(d_cache_lock_mutex);
-
     if (!is_enabled()) {
         BESDEBUG(MODULE, prolog << "CACHE IS DISABLED." << endl);
+        curl_slist_free_all(http_request_headers);
         return shared_ptr<EffectiveUrl>(new EffectiveUrl(source_url));
     }
 
     // if it's not an HTTP url there is nothing to cache.
     if (source_url->str().find(HTTP_PROTOCOL) != 0 && source_url->str().find(HTTPS_PROTOCOL) != 0) {
         BESDEBUG(MODULE, prolog << "END Not an HTTP request, SKIPPING." << endl);
+        curl_slist_free_all(http_request_headers);
         return shared_ptr<EffectiveUrl>(new EffectiveUrl(source_url));
     }
 
-    if (!d_skip_regex)
-        set_skip_regex();
+    const string key = append_edl_username_to_key(source_url->str());
+    Shard &shard = get_shard(key);
 
-    if (d_skip_regex) {
-        size_t match_length = 0;
-        match_length = d_skip_regex->match(source_url->str().c_str(), (int) source_url->str().size());
-        if (match_length == source_url->str().size()) {
-            BESDEBUG(MODULE, prolog << "END Candidate url matches the "
-                                       "no_redirects_regex_pattern [" << d_skip_regex->pattern() <<
-                                    "][match_length=" << match_length << "] SKIPPING." << endl);
-            return shared_ptr<EffectiveUrl>(new EffectiveUrl(source_url));
-        }
-        BESDEBUG(MODULE, prolog << "Candidate url: '" << source_url->str()
-                                << "' does NOT match the skip_regex pattern [" << d_skip_regex->pattern() << "]"
-                                << endl);
-    } else {
-        BESDEBUG(MODULE, prolog << "The cache_effective_urls_skip_regex() was NOT SET " << endl);
-    }
+    std::promise<shared_ptr<EffectiveUrl>> result;
+    std::shared_future<shared_ptr<EffectiveUrl>> pending;
+    {
+        // Lock access to this shard. Released when the lock goes out of scope.
+        std::lock_guard<std::mutex> lock_me(shard.mutex);
 
-    shared_ptr<EffectiveUrl> effective_url = get_cached_eurl(source_url->str());
-    bool retrieve_and_cache = !effective_url || effective_url->is_expired();
+        auto it = shard.effective_urls.find(key);
+        if (it != shard.effective_urls.end() && time(nullptr) < it->second.refresh_time) {
+            curl_slist_free_all(http_request_headers);
+            // Here we have a !expired instance of a shared_ptr<EffectiveUrl> retrieved from the cache.
+            // Now we need to make a copy to return, inheriting trust from the requesting URL.
+            BESDEBUG(MODULE, prolog << "END Cache hit." << endl);
+            return make_shared<EffectiveUrl>(it->second.effective_url, source_url->is_trusted());
+        }
 
-    // It not found or expired, (re)load.
-    if (retrieve_and_cache) {
-        BESDEBUG(MODULE, prolog << "Acquiring effective URL for  " << source_url->str() << endl);
-        {
-            BES_STOPWATCH_START(MODULE_TIMER, prolog + "Retrieve and cache effective url for source url: " + source_url->str());
-            try {
-                // This code throws an HttpError exception if there is a problem.
-                effective_url = curl::get_redirect_url(source_url,http_request_headers);
-            }
-            catch (http::HttpError &http_error) {
-                string err_msg = prolog + "Hyrax encountered a Service Chaining Error while "
-                                 "attempting to retrieve a redirect URL.\n"
-                                 "This is most likely problem with TEA, the AWS URL "
-                                 "signing service.\n" + http_error.get_message();
-                http_error.set_message(err_msg);
-                throw;
+        auto in_flight = shard.in_flight.find(key);
+        if (in_flight != shard.in_flight.end()) {
+            pending = in_flight->second;
+        }
+        else {
+            if (is_skipped(shard, source_url->str())) {
+                curl_slist_free_all(http_request_headers);
+                return shared_ptr<EffectiveUrl>(new EffectiveUrl(source_url));
             }
+            shard.in_flight[key] = result.get_future().share();
         }
-        BESDEBUG(MODULE, prolog << "   source_url: " << source_url->str() << " ("
-                                << (source_url->is_trusted() ? "" : "NOT ") << "trusted)" << endl);
-        BESDEBUG(MODULE, prolog << "effective_url: " << effective_url->dump() << " ("
-                                << (source_url->is_trusted() ? "" : "NOT ") << "trusted)" << endl);
-
-        d_effective_urls[append_edl_username_to_key(source_url->str())] = effective_url;
-
-        BESDEBUG(MODULE, prolog << "Updated record for " << source_url->str() << " cache size: "
-                                << d_effective_urls.size() << endl);
-
-        // Since we don't want there to be a concurrency issue when we release the lock, we don't
-        // return the instance of shared_ptr<EffectiveUrl> that we placed in the cache. Rather
-        // we make a clone and return that. It will have its own lifecycle independent of
-        // the instance we placed in the cache - it can be modified and the one in the cache
-        // is unchanged. Trusted state was established from source_url when effective_url was
-        // created in curl::retrieve_effective_url()
-        effective_url = make_shared<EffectiveUrl>(effective_url);
-    } else {
-        // Here we have a !expired instance of a shared_ptr<EffectiveUrl> retrieved from the cache.
-        // Now we need to make a copy to return, inheriting trust from the requesting URL.
-        effective_url = make_shared<EffectiveUrl>(effective_url, source_url->is_trusted());
+    }
+
+    shared_ptr<EffectiveUrl> effective_url;
+    if (pending.valid()) {
+        // Another thread is acquiring this URL; wait for it. This rethrows its exception, if any.
+        BESDEBUG(MODULE, prolog << "Waiting for the effective URL for " << source_url->str() << endl);
+        curl_slist_free_all(http_request_headers);
+        effective_url = make_shared<EffectiveUrl>(pending.get(), source_url->is_trusted());
+    }
+    else {
+        // Since we don't want there to be a concurrency issue, we don't return the instance of
+        // shared_ptr<EffectiveUrl> that we placed in the cache. Rather we make a clone and return
+        // that. It will have its own lifecycle independent of the instance we placed in the
+        // cache - it can be modified and the one in the cache is unchanged. Trusted state was
+        // established from source_url when effective_url was created in curl::retrieve_effective_url()
+        effective_url = make_shared<EffectiveUrl>(
+                acquire_effective_url(source_url, key, http_request_headers, result));
     }
 
     BESDEBUG(MODULE_DUMPER, prolog << "dump: " << endl << dump() << endl);
@@ -163,6 +289,138 @@ shared_ptr <EffectiveUrl> EffectiveUrlCache::get_effective_url(const shared_ptr
     return effective_url;
 }
 
+/**
+ * @brief Start acquiring the effective URL for source_url in the background.
+ *
+ * If prefetching is enabled (Http.cache.effective.urls.prefetch) and the URL is not
+ * already cached or being acquired, a thread is started to follow its redirects.
+ * A later call to get_effective_url() for the URL waits for that thread instead of
+ * starting a second request. At most d_max_prefetch_threads run at once; when
+ * that many are running, this does nothing and the URL is acquired when it's used.
+ *
+ * @note The cache key includes the EDL username from the BESContext, so this must
+ * be called from the thread handling the request.
+ *
+ * @param source_url
+ * @param http_request_headers The http request headers to use when contacting source_url.
+ * This method takes ownership of the headers.
+ */
+void EffectiveUrlCache::prefetch(const shared_ptr<url> &source_url, curl_slist *http_request_headers) {
+    if (!is_enabled() || !is_prefetch_enabled()
+        || (source_url->str().find(HTTP_PROTOCOL) != 0 && source_url->str().find(HTTPS_PROTOCOL) != 0)) {
+        curl_slist_free_all(http_request_headers);
+        return;
+    }
+
+    const string key = append_edl_username_to_key(source_url->str(), false);
+    Shard &shard = get_shard(key);
+
+    auto result = make_shared<std::promise<shared_ptr<EffectiveUrl>>>();
+
+    std::lock_guard<std::mutex> lock_me(shard.mutex);
+    if (is_fresh_or_in_flight(shard, key) || is_skipped(shard, source_url->str())) {
+        curl_slist_free_all(http_request_headers);
+        return;
+    }
+
+    std::lock_guard<std::mutex> prefetch_lock(d_prefetch_mutex);
+    join_finished_prefetchers();
+    if (d_prefetchers.size() >= d_max_prefetch_threads) {
+        BESDEBUG(MODULE, prolog << "Too many prefetch threads, not prefetching " << source_url->str() << endl);
+        curl_slist_free_all(http_request_headers);
+        return;
+    }
+
+    shard.in_flight[key] = result->get_future().share();
+
+    BESDEBUG(MODULE, prolog << "Prefetching the effective URL for " << source_url->str() << endl);
+
+    // The thread can't finish before it is added to d_prefetchers since it must lock
+    // d_prefetch_mutex to do so.
+    std::thread prefetcher([this, source_url, key, http_request_headers, result]() {
+        try {
+            acquire_effective_url(source_url, key, http_request_headers, *result);
+        }
+        catch (const BESError &e) {
+            // The threads waiting on this URL get the exception; just note it here.
+            INFO_LOG(prolog + "Could not prefetch the effective URL for " + source_url->str() + ": " + e.get_message());
+        }
+        catch (...) {
+            INFO_LOG(prolog + "Could not prefetch the effective URL for " + source_url->str());
+        }
+
+        std::lock_guard<std::mutex> prefetch_lock(d_prefetch_mutex);
+        d_finished_prefetchers.push_back(std::this_thread::get_id());
+    });
+    auto id = prefetcher.get_id();
+    d_prefetchers.emplace(id, std::move(prefetcher));
+}
+
+/**
+ * @brief Would prefetch() start acquiring the effective URL for source_url?
+ *
+ * Use this to skip preparing the request headers for URLs that are already cached,
+ * are being acquired or won't be cached at all.
+ *
+ * @param source_url
+ * @return True if prefetching is enabled, a prefetch thread is free and the URL
+ * is not cached, being acquired or skipped.
+ */
+bool EffectiveUrlCache::is_prefetch_needed(const shared_ptr<url> &source_url) {
+    if (!is_enabled() || !is_prefetch_enabled()
+        || (source_url->str().find(HTTP_PROTOCOL) != 0 && source_url->str().find(HTTPS_PROTOCOL) != 0)) {
+        return false;
+    }
+
+    if (is_prefetch_pool_full())
+        return false;
+
+    const string key = append_edl_username_to_key(source_url->str(), false);
+    Shard &shard = get_shard(key);
+    std::lock_guard<std::mutex> lock_me(shard.mutex);
+    return !is_fresh_or_in_flight(shard, key) && !is_skipped(shard, source_url->str());
+}
+
+/**
+ * @brief Are d_max_prefetch_threads prefetch threads running?
+ * @note prefetch() checks again before starting a thread; this is a hint.
+ */
+bool EffectiveUrlCache::is_prefetch_pool_full() {
+    std::lock_guard<std::mutex> prefetch_lock(d_prefetch_mutex);
+    join_finished_prefetchers();
+    return d_prefetchers.size() >= d_max_prefetch_threads;
+}
+
+/**
+ * @brief Join the prefetch threads that have finished.
+ * @note The caller must lock d_prefetch_mutex.
+ */
+void EffectiveUrlCache::join_finished_prefetchers() {
+    for (auto const &id: d_finished_prefetchers) {
+        auto it = d_prefetchers.find(id);
+        if (it != d_prefetchers.end()) {
+            it->second.join();
+            d_prefetchers.erase(it);
+        }
+    }
+    d_finished_prefetchers.clear();
+}
+
+/**
+ * @brief Wait for all the prefetch threads to finish.
+ */
+void EffectiveUrlCache::join_prefetchers() {
+    std::map<std::thread::id, std::thread> prefetchers;
+    {
+        std::lock_guard<std::mutex> prefetch_lock(d_prefetch_mutex);
+        prefetchers.swap(d_prefetchers);
+        d_finished_prefetchers.clear();
+    }
+    // The threads lock d_prefetch_mutex as they finish, so don't hold it here.
+    for (auto &prefetcher: prefetchers)
+        prefetcher.second.join();
+}
+
 /**
  * @return Is the cache enabled (set in the bes.conf file)?
  */
@@ -177,6 +435,16 @@ bool EffectiveUrlCache::is_enabled() {
     return d_enabled;
 }
 
+/**
+ * @return Should effective URLs be acquired before they are needed (set in the bes.conf file)?
+ */
+bool EffectiveUrlCache::is_prefetch_enabled() {
+    if (d_prefetch_enabled < 0) {
+        d_prefetch_enabled = TheBESKeys::TheKeys()->read_bool_key(HTTP_CACHE_EFFECTIVE_URLS_PREFETCH_KEY, false);
+    }
+    return d_prefetch_enabled;
+}
+
 void EffectiveUrlCache::set_skip_regex() {
     if (!d_skip_regex) {
         string pattern = TheBESKeys::TheKeys()->read_string_key(HTTP_CACHE_EFFECTIVE_URLS_SKIP_REGEX_KEY, "");
@@ -188,6 +456,29 @@ void EffectiveUrlCache::set_skip_regex() {
     }
 }
 
+/**
+ * @return The number of effective URLs in the cache
+ */
+size_t EffectiveUrlCache::size() {
+    size_t size = 0;
+    for (auto &shard: d_shards) {
+        std::lock_guard<std::mutex> lock_me(shard.mutex);
+        size += shard.effective_urls.size();
+    }
+    return size;
+}
+
+/**
+ * @brief Remove all the effective URLs (and skipped URLs) from the cache.
+ */
+void EffectiveUrlCache::clear() {
+    for (auto &shard: d_shards) {
+        std::lock_guard<std::mutex> lock_me(shard.mutex);
+        shard.effective_urls.clear();
+        shard.skipped.clear();
+    }
+}
+
 /**
  * @brief dumps information about this object
  * @param strm C++ i/o stream to dump the information to
@@ -196,14 +487,19 @@ void EffectiveUrlCache::dump(ostream &strm) const {
     strm << BESIndent::LMarg << prolog << "(this: " << (void *) this << ")" << endl;
     BESIndent::Indent();
     strm << BESIndent::LMarg << "d_skip_regex: " << (d_skip_regex ? d_skip_regex->pattern() : "WAS NOT SET") << endl;
-    if (!d_effective_urls.empty()) {
-        strm << BESIndent::LMarg << "effective url list:" << endl;
-        BESIndent::Indent();
-        for (auto const &i: d_effective_urls) {
-            strm << BESIndent::LMarg << i.first << " --> " << i.second->str();
+    bool empty = true;
+    for (auto const &shard: d_shards) {
+        std::lock_guard<std::mutex> lock_me(shard.mutex);
+        for (auto const &i: shard.effective_urls) {
+            if (empty) {
+                strm << BESIndent::LMarg << "effective url list:" << endl;
+                empty = false;
+            }
+            strm << BESIndent::LMarg << "    " << i.first << " --> " << i.second.effective_url->str()
+                 << " (refresh_time: " << i.second.refresh_time << ")" << endl;
         }
-        BESIndent::UnIndent();
-    } else {
+    }
+    if (empty) {
         strm << BESIndent::LMarg << "effective url list: EMPTY" << endl;
     }
     BESIndent::UnIndent();
@@ -212,16 +508,23 @@ void EffectiveUrlCache::dump(ostream &strm) const {
 /**
  * @brief Append the EDL username from the BESContext to key.
  * @param key Key prefix.
+ * @param log_missing_uid If true, log a missing UID to the info log, else to the
+ * debug log. The prefetch calls are made for every chunk of a DMR++.
  * @note This method is not, itself, thread safe.
  */
-std::string EffectiveUrlCache::append_edl_username_to_key(string const &key) {
+std::string EffectiveUrlCache::append_edl_username_to_key(string const &key, bool log_missing_uid) {
     bool found = false;
     string uid = BESContextManager::TheManager()->get_context(UID_CONTEXT_KEY, found);
     BESDEBUG(MODULE, prolog << "UID_CONTEXT_KEY(" << UID_CONTEXT_KEY << "): " << uid << endl);
     if (found && !uid.empty()) {
         return key + ":" + uid;
     }
-    INFO_LOG(prolog + string("SERVICE CHAIN WARNING - EDL UID missing; using raw key " + key));
+    if (log_missing_uid) {
+        INFO_LOG(prolog + string("SERVICE CHAIN WARNING - EDL UID missing; using raw key " + key));
+    }
+    else {
+        BESDEBUG(MODULE, prolog << "SERVICE CHAIN WARNING - EDL UID missing; using raw key " << key << endl);
+    }
     return key;
 }
 
@@ -27,10 +27,17 @@
 #ifndef _bes_http_EffectiveUrlCache_h_
 #define _bes_http_EffectiveUrlCache_h_ 1
 
+#include <array>
+#include <atomic>
+#include <ctime>
+#include <future>
 #include <memory>
 #include <map>
+#include <set>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <curl/curl.h>
 
@@ -49,28 +56,81 @@ class url;
  * is termed the "effective url" and that is stored in an in memory cache (std::map) so that later requests may
  * skip the redirects and just get required bytes from the actual source.
  *
+ * The cache is split into shards, each with its own lock, so that the threads reading
+ * chunks of different files do not contend for one mutex. When an effective URL must be
+ * (re)acquired, only one thread follows the redirects for it; other threads that need the
+ * same URL wait for that result. The time after which a cached URL must be acquired again
+ * is computed once, when it is cached, from the URL's signature expiry (see
+ * EffectiveUrl::expires_time()).
+ *
+ * When Http.cache.effective.urls.prefetch is true, prefetch() can be used to start
+ * acquiring effective URLs in the background as soon as they are known, e.g., while
+ * a DMR++ is being parsed.
+ *
  * @note This is the same as following a chain HTTP redirects to get the URL to the origin of the data.
  */
 class EffectiveUrlCache : public BESObj {
 private:
     EffectiveUrlCache() = default;
 
-    std::mutex d_cache_lock_mutex;
+    /// A cached effective URL and the time after which it must be acquired again
+    struct Entry {
+        std::shared_ptr<http::EffectiveUrl> effective_url;
+        std::time_t refresh_time = 0;
+    };
+
+    /// One independently locked part of the cache
+    struct Shard {
+        mutable std::mutex mutex;
+        std::map<std::string, Entry> effective_urls;
+        // Effective URLs being acquired now; other threads wait on these.
+        std::map<std::string, std::shared_future<std::shared_ptr<http::EffectiveUrl>>> in_flight;
+        // URLs that matched the skip regex
+        std::set<std::string> skipped;
+    };
 
-    std::map<std::string, std::shared_ptr<http::EffectiveUrl>> d_effective_urls;
+    static constexpr size_t d_num_shards = 16;
+    static constexpr unsigned int d_max_prefetch_threads = 8;
+
+    std::array<Shard, d_num_shards> d_shards;
 
     // URLs that match are not cached.
     std::unique_ptr<BESRegex> d_skip_regex = nullptr;
+    std::once_flag d_skip_regex_flag;
+
+    std::atomic<int> d_enabled{-1};
+    std::atomic<int> d_prefetch_enabled{-1};
+
+    // The prefetch threads, running or finished but not yet joined, and the ids of
+    // the finished ones. Guarded by d_prefetch_mutex.
+    std::mutex d_prefetch_mutex;
+    std::map<std::thread::id, std::thread> d_prefetchers;
+    std::vector<std::thread::id> d_finished_prefetchers;
 
-    int d_enabled = -1;
+    Shard &get_shard(const std::string &key) { return d_shards[std::hash<std::string>{}(key) % d_num_shards]; }
 
     std::shared_ptr<EffectiveUrl> get_cached_eurl(std::string const &url);
+    void add_cached_eurl(const std::string &key, const std::shared_ptr<EffectiveUrl> &effective_url);
+
+    bool is_skipped(Shard &shard, const std::string &source_url);
+    bool is_fresh_or_in_flight(Shard &shard, const std::string &key);
+
+    void join_finished_prefetchers();
+    bool is_prefetch_pool_full();
+    void join_prefetchers();
+
+    std::shared_ptr<EffectiveUrl> acquire_effective_url(const std::shared_ptr<url> &source_url, const std::string &key,
+                                                        curl_slist *http_request_headers,
+                                                        std::promise<std::shared_ptr<EffectiveUrl>> &result);
 
     void set_skip_regex();
 
     bool is_enabled();
 
-    std::string append_edl_username_to_key(std::string const &key);
+    std::string append_edl_username_to_key(std::string const &key, bool log_missing_uid = true);
+
+    size_t size();
+    void clear();
 
     friend class EffectiveUrlCacheTest;
 
@@ -94,10 +154,15 @@ public:
     EffectiveUrlCache(const EffectiveUrlCache &src) = delete;
     EffectiveUrlCache &operator=(const EffectiveUrlCache &rhs) = delete;
 
-    ~EffectiveUrlCache() override = default;
+    ~EffectiveUrlCache() override;
 
     std::shared_ptr<EffectiveUrl> get_effective_url(const std::shared_ptr<url>& source_url, curl_slist *http_request_headers = nullptr);
 
+    void prefetch(const std::shared_ptr<url> &source_url, curl_slist *http_request_headers = nullptr);
+
+    bool is_prefetch_enabled();
+    bool is_prefetch_needed(const std::shared_ptr<url> &source_url);
+
     void dump(std::ostream &strm) const override;
 
     std::string dump() const {
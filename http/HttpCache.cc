@@ -0,0 +1,465 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BESDebug.h"
+#include "BESIndent.h"
+#include "BESInternalError.h"
+#include "BESLog.h"
+#include "BESUtil.h"
+#include "TheBESKeys.h"
+#include "FileCache.h"
+
+#include "CurlUtils.h"
+#include "HttpCache.h"
+#include "HttpNames.h"
+#include "url_impl.h"
+
+#define MODULE HTTP_MODULE
+#define prolog string("HttpCache::").append(__func__).append("() - ")
+
+// The metadata for the body cached as <key> is cached as <key>.meta
+#define META_SUFFIX ".meta"
+
+using namespace std;
+
+namespace http {
+
+/// Copy everything from one file descriptor to another, starting at the current offsets.
+static bool copy_fd(int from, int to) {
+    vector<char> buf(1024 * 1024);
+    ssize_t n;
+    while ((n = read(from, buf.data(), buf.size())) > 0) {
+        if (write(to, buf.data(), n) != n)
+            return false;
+    }
+    return n == 0;
+}
+
+class HttpCache::FileTarget : public HttpCache::Target {
+    const shared_ptr<http::url> &d_url;
+    int d_fd;
+
+    bool rewind() const { return lseek(d_fd, 0, SEEK_SET) == 0; }
+
+public:
+    FileTarget(const shared_ptr<http::url> &target_url, int fd) : d_url(target_url), d_fd(fd) {}
+
+    long fetch(curl_slist *http_request_headers, vector<string> *http_response_headers) override {
+        return curl::http_get_and_write_resource(d_url, d_fd, http_response_headers, http_request_headers);
+    }
+
+    bool load(int cache_fd) override {
+        if (rewind() && ftruncate(d_fd, 0) == 0 && copy_fd(cache_fd, d_fd) && rewind())
+            return true;
+
+        if (ftruncate(d_fd, 0) != 0 || !rewind())
+            throw BESInternalError(prolog + "Could not reset the response file (" + strerror(errno) + ").",
+                                   __FILE__, __LINE__);
+        return false;
+    }
+
+    bool store(int cache_fd) override {
+        bool status = rewind() && copy_fd(d_fd, cache_fd);
+        return rewind() && status;
+    }
+
+    unsigned long long size() const override {
+        struct stat sb = {};
+        return fstat(d_fd, &sb) == 0 ? sb.st_size : 0;
+    }
+};
+
+class HttpCache::StringTarget : public HttpCache::Target {
+    const string &d_url;
+    string &d_buf;
+    string::size_type d_start;  // http_get() appends to the string
+
+public:
+    StringTarget(const string &target_url, string &buf) : d_url(target_url), d_buf(buf), d_start(buf.size()) {}
+
+    long fetch(curl_slist *http_request_headers, vector<string> *http_response_headers) override {
+        return curl::http_get(d_url, d_buf, http_request_headers, http_response_headers);
+    }
+
+    bool load(int cache_fd) override {
+        vector<char> buf(64 * 1024);
+        ssize_t n;
+        while ((n = read(cache_fd, buf.data(), buf.size())) > 0)
+            d_buf.append(buf.data(), n);
+        if (n == 0)
+            return true;
+
+        d_buf.resize(d_start);
+        return false;
+    }
+
+    bool store(int cache_fd) override {
+        auto bytes = d_buf.size() - d_start;
+        return write(cache_fd, d_buf.data() + d_start, bytes) == static_cast<ssize_t>(bytes);
+    }
+
+    unsigned long long size() const override { return d_buf.size() - d_start; }
+};
+
+/**
+ * @brief Read the configuration and initialize the FileCache
+ *
+ * If Http.ObjectCache.Dir is not set or the cache cannot be initialized, the
+ * cache is disabled and the get methods call the curl:: functions directly.
+ */
+HttpCache::HttpCache() {
+    d_cache_dir = TheBESKeys::TheKeys()->read_string_key(HTTP_OBJECT_CACHE_DIR_KEY, "");
+    if (d_cache_dir.empty())
+        return;
+
+    const long long size_mb = TheBESKeys::TheKeys()->read_ulong_key(HTTP_OBJECT_CACHE_SIZE_KEY, 1000);
+    const long long purge_mb = TheBESKeys::TheKeys()->read_ulong_key(HTTP_OBJECT_CACHE_PURGE_SIZE_KEY, 100);
+    d_default_max_age = TheBESKeys::TheKeys()->read_ulong_key(HTTP_OBJECT_CACHE_DEFAULT_MAX_AGE_KEY, 0);
+
+    d_cache.reset(new FileCache());
+    if (!d_cache->initialize(d_cache_dir, size_mb * 1024 * 1024, purge_mb * 1024 * 1024)) {
+        ERROR_LOG(prolog + "Could not initialize the HTTP object cache in " + d_cache_dir + "; it is disabled.");
+        d_cache.reset();
+        return;
+    }
+
+    d_enabled = true;
+    BESDEBUG(MODULE, prolog << "HTTP object cache: " << d_cache_dir << ", " << size_mb << "MB" << endl);
+}
+
+// Defined here because FileCache is incomplete in the header.
+HttpCache::~HttpCache() = default;
+
+/**
+ * @brief The cache key for a request
+ *
+ * The request headers are part of the key. This keeps a response fetched
+ * with one user's credentials from being returned to another user.
+ */
+string HttpCache::make_key(const string &url, const curl_slist *http_request_headers) {
+    string key = url;
+    for (auto header = http_request_headers; header; header = header->next) {
+        key.append("\n").append(header->data);
+    }
+    return FileCache::hash_key(key);
+}
+
+/**
+ * @brief Get the validators and expiration time from the response headers
+ *
+ * With redirects, the headers of every response in the chain are present;
+ * the ones that come last (from the final response) are used.
+ *
+ * @param response_headers The response headers
+ * @param keyed_by_user True if the key holds user credentials; responses
+ * marked 'private' are cached only in that case
+ * @param default_max_age Use this when the response has no freshness information
+ * @param entry Value-result; the etag, last_modified and expires fields are set
+ * @return False if the response should not be cached
+ */
+bool HttpCache::parse_response_headers(const vector<string> &response_headers, bool keyed_by_user,
+                                       unsigned long default_max_age, Entry &entry) {
+    string cache_control;
+    string expires;
+    for (const auto &header: response_headers) {
+        auto colon = header.find(':');
+        if (colon == string::npos)
+            continue;
+
+        string name = BESUtil::lowercase(header.substr(0, colon));
+        auto start = header.find_first_not_of(" \t", colon + 1);
+        string value = (start == string::npos) ? "" : header.substr(start, header.find_last_not_of(" \t") + 1 - start);
+
+        if (name == "etag")
+            entry.etag = value;
+        else if (name == "last-modified")
+            entry.last_modified = value;
+        else if (name == "cache-control")
+            cache_control = BESUtil::lowercase(value);
+        else if (name == "expires")
+            expires = value;
+    }
+
+    long max_age = -1;
+    long s_maxage = -1;
+    bool no_cache = false;
+    vector<string> directives;
+    BESUtil::tokenize(cache_control, directives, ", ");
+    for (const auto &directive: directives) {
+        if (directive == "no-store")
+            return false;
+        if (directive == "private" && !keyed_by_user)
+            return false;
+        if (directive == "no-cache")
+            no_cache = true;
+        else if (directive.find("s-maxage=") == 0)
+            s_maxage = strtol(directive.c_str() + 9, nullptr, 10);
+        else if (directive.find("max-age=") == 0)
+            max_age = strtol(directive.c_str() + 8, nullptr, 10);
+    }
+
+    const time_t now = time(nullptr);
+    if (no_cache) {
+        max_age = 0;
+    }
+    else if (s_maxage >= 0) {   // This is a shared cache
+        max_age = s_maxage;
+    }
+    else if (max_age < 0 && !expires.empty()) {
+        time_t expires_time = curl_getdate(expires.c_str(), nullptr);
+        max_age = (expires_time > now) ? expires_time - now : 0;
+    }
+    else if (max_age < 0) {
+        max_age = static_cast<long>(default_max_age);
+    }
+
+    entry.expires = now + max_age;
+
+    // An entry that is never fresh and cannot be revalidated is of no use
+    return max_age > 0 || !entry.etag.empty() || !entry.last_modified.empty();
+}
+
+bool HttpCache::item_exists(const string &key) const {
+    return access(BESUtil::pathConcat(d_cache_dir, key).c_str(), F_OK) == 0;
+}
+
+bool HttpCache::read_entry(const string &key, Entry &entry) const {
+    FileCache::Item item;
+    if (!d_cache->get(key + META_SUFFIX, item))
+        return false;
+
+    string text;
+    vector<char> buf(4096);
+    ssize_t n;
+    while ((n = read(item.get_fd(), buf.data(), buf.size())) > 0)
+        text.append(buf.data(), n);
+
+    istringstream iss(text);
+    string line;
+    while (getline(iss, line)) {
+        auto colon = line.find(": ");
+        if (colon == string::npos)
+            continue;
+        string name = line.substr(0, colon);
+        string value = line.substr(colon + 2);
+        if (name == "url")
+            entry.url = value;
+        else if (name == "etag")
+            entry.etag = value;
+        else if (name == "last-modified")
+            entry.last_modified = value;
+        else if (name == "expires")
+            entry.expires = strtol(value.c_str(), nullptr, 10);
+        else if (name == "size")
+            entry.size = strtoull(value.c_str(), nullptr, 10);
+    }
+
+    return !entry.url.empty();
+}
+
+void HttpCache::write_entry(const string &key, const Entry &entry) {
+    ostringstream oss;
+    oss << "url: " << entry.url << "\n"
+        << "etag: " << entry.etag << "\n"
+        << "last-modified: " << entry.last_modified << "\n"
+        << "expires: " << entry.expires << "\n"
+        << "size: " << entry.size << "\n";
+
+    // FileCache does not overwrite items
+    const string meta_key = key + META_SUFFIX;
+    if (item_exists(meta_key) && !d_cache->del(meta_key))
+        return;
+    d_cache->put_data(meta_key, oss.str());
+}
+
+/**
+ * @brief Get a response from the cache, the server or both
+ * @param url The URL
+ * @param http_request_headers The request headers; this takes ownership
+ * @param http_response_headers Value-result; the response headers, if the server was contacted
+ * @param target Where the response body goes
+ * @return The HTTP response code; 200 when the cached body was used
+ */
+long HttpCache::get_resource(const string &url, curl_slist *http_request_headers,
+                             vector<string> *http_response_headers, Target &target) {
+    if (!d_enabled)
+        return target.fetch(http_request_headers, http_response_headers);
+
+    const bool keyed_by_user = http_request_headers != nullptr;
+    const string key = make_key(url, http_request_headers);
+
+    // Hold a shared lock on the cached body while it is used or revalidated so
+    // that it cannot be purged or replaced.
+    Entry entry;
+    unique_ptr<FileCache::Item> body(new FileCache::Item());
+    bool cached = read_entry(key, entry) && entry.url == url && d_cache->get(key, *body);
+
+    if (cached && time(nullptr) < entry.expires && target.load(body->get_fd())) {
+        ++d_hits;
+        d_bytes_saved += entry.size;
+        curl_slist_free_all(http_request_headers);
+        BESDEBUG(MODULE, prolog << "Fresh: " << url << endl);
+        return 200;
+    }
+
+    if (cached && (!entry.etag.empty() || !entry.last_modified.empty())) {
+        if (!entry.etag.empty())
+            http_request_headers = curl::append_http_header(http_request_headers, "If-None-Match", entry.etag);
+        if (!entry.last_modified.empty())
+            http_request_headers = curl::append_http_header(http_request_headers, "If-Modified-Since",
+                                                            entry.last_modified);
+    }
+    else {
+        cached = false;
+        body.reset();
+    }
+
+    vector<string> local_headers;
+    auto response_headers = http_response_headers ? http_response_headers : &local_headers;
+    auto first = response_headers->size();
+
+    long http_code = target.fetch(http_request_headers, response_headers);
+
+    const vector<string> new_headers(response_headers->begin() + first, response_headers->end());
+
+    if (http_code == 304 && cached) {
+        if (!target.load(body->get_fd()))
+            throw BESInternalError(prolog + "Could not read the cached response for " + url, __FILE__, __LINE__);
+
+        ++d_revalidations;
+        d_bytes_saved += entry.size;
+        body.reset();
+
+        // The 304 response may update the freshness information
+        Entry update;
+        entry.expires = parse_response_headers(new_headers, keyed_by_user, d_default_max_age, update)
+                        ? update.expires : time(nullptr);
+        write_entry(key, entry);
+        BESDEBUG(MODULE, prolog << "Not modified: " << url << endl);
+        return 200;
+    }
+
+    ++d_misses;
+    d_bytes_fetched += target.size();
+    body.reset();
+
+    Entry fresh;
+    fresh.url = url;
+    fresh.size = target.size();
+    if (http_code != 200 || !parse_response_headers(new_headers, keyed_by_user, d_default_max_age, fresh)) {
+        BESDEBUG(MODULE, prolog << "Not cacheable (" << http_code << "): " << url << endl);
+        if (item_exists(key + META_SUFFIX))
+            d_cache->del(key + META_SUFFIX);
+        return http_code;
+    }
+
+    // Replace the cached body. If another process is reading it, leave it alone.
+    if (item_exists(key + META_SUFFIX) && !d_cache->del(key + META_SUFFIX))
+        return http_code;
+    if (item_exists(key) && !d_cache->del(key))
+        return http_code;
+
+    {
+        FileCache::PutItem item(*d_cache);
+        if (!d_cache->put(key, item) || !target.store(item.get_fd())) {
+            ERROR_LOG(prolog + "Could not cache the response for " + url);
+            return http_code;
+        }
+    }
+
+    write_entry(key, fresh);
+    d_cache->purge();
+
+    BESDEBUG(MODULE, prolog << "Cached: " << url << " (" << fresh.size << " bytes, ETag: " << fresh.etag
+                            << ", Last-Modified: " << fresh.last_modified << ")" << endl);
+    return http_code;
+}
+
+/**
+ * @brief Get a resource and write it to an open file, using the cache
+ *
+ * This has the same semantics as curl::http_get_and_write_resource().
+ *
+ * @param target_url The URL to dereference
+ * @param fd An open file descriptor; when this returns, the response body
+ * can be read from it.
+ * @param http_response_headers Value/result parameter for the HTTP Response
+ * Headers. These are not set when a fresh cached response is used.
+ * @param http_request_headers A pointer to a curl_slist of HTTP request
+ * headers. This method takes ownership of the list.
+ * @return The HTTP response code; 200 when the cached response was used.
+ */
+long HttpCache::get_and_write_resource(const shared_ptr<http::url> &target_url, int fd,
+                                       vector<string> *http_response_headers, curl_slist *http_request_headers) {
+    FileTarget target(target_url, fd);
+    return get_resource(target_url->str(), http_request_headers, http_response_headers, target);
+}
+
+/**
+ * @brief Get a resource and append it to a string, using the cache
+ *
+ * This has the same semantics as curl::http_get().
+ *
+ * @param target_url The URL to dereference
+ * @param buf The response is appended to this string
+ * @param http_request_headers A pointer to a curl_slist of HTTP request
+ * headers. This method takes ownership of the list.
+ */
+void HttpCache::get(const string &target_url, string &buf, curl_slist *http_request_headers) {
+    StringTarget target(target_url, buf);
+    get_resource(target_url, http_request_headers, nullptr, target);
+}
+
+/// @return The fraction of requests answered using the cache (including revalidated responses)
+double HttpCache::get_hit_ratio() const {
+    unsigned long long used = d_hits + d_revalidations;
+    unsigned long long total = used + d_misses;
+    return total == 0 ? 0.0 : static_cast<double>(used) / static_cast<double>(total);
+}
+
+void HttpCache::dump(ostream &strm) const {
+    strm << BESIndent::LMarg << prolog << "(this: " << (void *) this << ")" << endl;
+    BESIndent::Indent();
+    strm << BESIndent::LMarg << "enabled: " << (d_enabled ? "true" : "false") << endl;
+    strm << BESIndent::LMarg << "cache_dir: " << d_cache_dir << endl;
+    strm << BESIndent::LMarg << "default_max_age: " << d_default_max_age << endl;
+    strm << BESIndent::LMarg << "hits: " << d_hits << endl;
+    strm << BESIndent::LMarg << "revalidations: " << d_revalidations << endl;
+    strm << BESIndent::LMarg << "misses: " << d_misses << endl;
+    strm << BESIndent::LMarg << "hit_ratio: " << get_hit_ratio() << endl;
+    strm << BESIndent::LMarg << "bytes_saved: " << d_bytes_saved << endl;
+    strm << BESIndent::LMarg << "bytes_fetched: " << d_bytes_fetched << endl;
+    BESIndent::UnIndent();
+}
+
+} // namespace http
@@ -0,0 +1,167 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _bes_http_HttpCache_h_
+#define _bes_http_HttpCache_h_ 1
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "BESObj.h"
+
+class FileCache;
+
+namespace http {
+
+class url;
+
+/**
+ * @brief A persistent cache of HTTP responses, shared by all the beslistener processes
+ *
+ * This is a singleton class. Response bodies are stored in a FileCache, named
+ * by the SHA256 hash of the URL and the request headers, along with a small
+ * metadata item that holds the ETag, Last-Modified and expiration time of the
+ * response. A fresh entry (see Cache-Control: max-age and Expires) is used
+ * without contacting the server. A stale entry with a validator is revalidated
+ * with a conditional GET; if the server answers 304 (Not Modified), the cached
+ * body is used. Responses marked no-store are never cached and those marked
+ * private are cached only when the request carried headers (e.g., an EDL
+ * token), since those are part of the key.
+ *
+ * The cache is off unless Http.ObjectCache.Dir is set.
+ *
+ * @note The methods take ownership of the request headers, like the curl::
+ * functions they replace.
+ */
+class HttpCache : public BESObj {
+private:
+    /// What is known about a cached response
+    struct Entry {
+        std::string url;
+        std::string etag;
+        std::string last_modified;
+        time_t expires = 0;
+        unsigned long long size = 0;
+    };
+
+    /// Where a response is put: the code to fetch it and to move it to and from the cache
+    class Target {
+    public:
+        virtual ~Target() = default;
+
+        /// Get the response from the server; takes ownership of the request headers
+        virtual long fetch(curl_slist *http_request_headers, std::vector<std::string> *http_response_headers) = 0;
+        /// Copy a cached body from cache_fd; on failure, leave the target empty
+        virtual bool load(int cache_fd) = 0;
+        /// Copy the fetched body to cache_fd
+        virtual bool store(int cache_fd) = 0;
+        /// @return The size of the fetched (or loaded) body
+        virtual unsigned long long size() const = 0;
+    };
+
+    class FileTarget;
+    class StringTarget;
+
+    std::unique_ptr<FileCache> d_cache;
+    std::string d_cache_dir;
+    bool d_enabled = false;
+    unsigned long d_default_max_age = 0;
+
+    std::atomic<unsigned long long> d_hits{0};
+    std::atomic<unsigned long long> d_revalidations{0};
+    std::atomic<unsigned long long> d_misses{0};
+    std::atomic<unsigned long long> d_bytes_saved{0};
+    std::atomic<unsigned long long> d_bytes_fetched{0};
+
+    HttpCache();
+
+    static std::string make_key(const std::string &url, const curl_slist *http_request_headers);
+    static bool parse_response_headers(const std::vector<std::string> &response_headers, bool keyed_by_user,
+                                       unsigned long default_max_age, Entry &entry);
+
+    bool read_entry(const std::string &key, Entry &entry) const;
+    void write_entry(const std::string &key, const Entry &entry);
+    bool item_exists(const std::string &key) const;
+
+    long get_resource(const std::string &url, curl_slist *http_request_headers,
+                      std::vector<std::string> *http_response_headers, Target &target);
+
+    friend class HttpCacheTest;
+
+public:
+    /** @brief Get the singleton HttpCache instance.
+     *
+     * Thread safe with C++-11 and greater.
+     *
+     * @return A pointer to the HttpCache singleton
+     */
+    static HttpCache *TheCache() {
+        static HttpCache instance;
+        return &instance;
+    }
+
+    HttpCache(const HttpCache &src) = delete;
+    HttpCache &operator=(const HttpCache &rhs) = delete;
+
+    ~HttpCache() override;
+
+    /// @return True if responses are cached
+    bool is_enabled() const { return d_enabled; }
+
+    long get_and_write_resource(const std::shared_ptr<http::url> &target_url, int fd,
+                                std::vector<std::string> *http_response_headers,
+                                curl_slist *http_request_headers = nullptr);
+
+    void get(const std::string &target_url, std::string &buf, curl_slist *http_request_headers = nullptr);
+
+    /// @return The number of responses used without contacting the server
+    unsigned long long get_hits() const { return d_hits; }
+    /// @return The number of responses the server said were not modified
+    unsigned long long get_revalidations() const { return d_revalidations; }
+    /// @return The number of responses read from the server
+    unsigned long long get_misses() const { return d_misses; }
+    /// @return The number of response body bytes that were not transferred
+    unsigned long long get_bytes_saved() const { return d_bytes_saved; }
+    /// @return The number of response body bytes that were transferred
+    unsigned long long get_bytes_fetched() const { return d_bytes_fetched; }
+
+    double get_hit_ratio() const;
+
+    void dump(std::ostream &strm) const override;
+
+    std::string dump() const {
+        std::stringstream sstrm;
+        dump(sstrm);
+        return sstrm.str();
+    }
+};
+
+} // namespace http
+
+#endif // _bes_http_HttpCache_h_
@@ -63,6 +63,7 @@
 #define HTTP_NO_RETRY_URL_REGEX_KEY "Http.No.Retry.Regex"
 #define HTTP_CACHE_EFFECTIVE_URLS_KEY "Http.cache.effective.urls"
 #define HTTP_CACHE_EFFECTIVE_URLS_SKIP_REGEX_KEY "Http.cache.effective.urls.skip.regex.pattern"
+#define HTTP_CACHE_EFFECTIVE_URLS_PREFETCH_KEY "Http.cache.effective.urls.prefetch"
 
 #define AWS_CACHE_SIGNED_URLS_KEY "AWS.cache.signed.urls"
 #define AMS_EXPIRES_HEADER_KEY "X-Amz-Expires"
@@ -85,6 +86,19 @@
 #define REMOTE_RESOURCE_TMP_DIR_KEY "Http.RemoteResource.TmpDir"    // default is /tmp/bes_rr_tmp
 #define REMOTE_RESOURCE_DELETE_TMP_FILE "Http.RemoteResource.TmpFile.Delete"    // default is true
 
+// Handler types (e.g., h5) whose remote resources are read using HTTP Range GETs
+// instead of being downloaded. Default is none.
+#define REMOTE_RESOURCE_RANGE_READ_HANDLERS_KEY "Http.RemoteResource.RangeRead.Handlers"
+#define REMOTE_RESOURCE_RANGE_READ_BLOCK_SIZE_KEY "Http.RemoteResource.RangeRead.BlockSize"    // default is 1MB
+#define REMOTE_RESOURCE_RANGE_READ_CACHE_BLOCKS_KEY "Http.RemoteResource.RangeRead.CacheBlocks"    // default is 64
+#define REMOTE_RESOURCE_RANGE_READ_AHEAD_KEY "Http.RemoteResource.RangeRead.ReadAhead"    // default is 4 blocks
+
+// A persistent cache of HTTP responses (see HttpCache). The cache is off unless the directory is set.
+#define HTTP_OBJECT_CACHE_DIR_KEY "Http.ObjectCache.Dir"
+#define HTTP_OBJECT_CACHE_SIZE_KEY "Http.ObjectCache.Size"    // MB, default is 1000
+#define HTTP_OBJECT_CACHE_PURGE_SIZE_KEY "Http.ObjectCache.PurgeSize"    // MB, default is 100
+#define HTTP_OBJECT_CACHE_DEFAULT_MAX_AGE_KEY "Http.ObjectCache.DefaultMaxAge"    // seconds, default is 0
+
 #define HTTP_MODULE "http"
 
 #endif //  _bes_http_HTTP_NAMES_H
@@ -0,0 +1,238 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "BESInternalError.h"
+#include "BESDebug.h"
+
+#include "CurlUtils.h"
+#include "HttpNames.h"
+#include "RangeReadFile.h"
+
+#define MODULE HTTP_MODULE
+#define prolog string("RangeReadFile::").append(__func__).append("() - ")
+
+using namespace std;
+
+namespace http {
+
+std::mutex RangeReadFile::d_registry_mutex;
+std::map<std::string, std::shared_ptr<RangeReadFile>> RangeReadFile::d_registry;
+
+/**
+ * @brief Make a RangeReadFile; no I/O is done until open() is called
+ * @param url The resource URL
+ * @param block_size The size of the blocks read from the resource and cached
+ * @param max_blocks The maximum number of blocks to cache
+ * @param read_ahead The number of blocks to read past the end of a read
+ * when the reads are sequential
+ */
+RangeReadFile::RangeReadFile(string url, unsigned long long block_size, unsigned int max_blocks,
+                             unsigned int read_ahead)
+        : d_url(std::move(url)), d_block_size(block_size ? block_size : 1), d_max_blocks(max_blocks ? max_blocks : 1),
+          d_read_ahead(read_ahead) {
+}
+
+unsigned long long
+RangeReadFile::get_range(unsigned long long offset, unsigned long long size, char *buf,
+                         unsigned long long *resource_size) {
+    return curl::http_get_range(d_url, offset, size, buf, resource_size);
+}
+
+/**
+ * @brief Read the first block of the resource and learn its size
+ *
+ * @exception BESError if the resource cannot be read or the server does not
+ * support HTTP Range requests. The caller should then download the whole
+ * resource.
+ */
+void RangeReadFile::open() {
+    lock_guard<mutex> lock(d_mutex);
+
+    if (d_open)
+        return;
+
+    auto block = make_shared<vector<char>>(d_block_size);
+    unsigned long long resource_size = 0;
+    unsigned long long bytes = get_range(0, d_block_size, block->data(), &resource_size);
+    ++d_requests;
+    d_bytes_transferred += bytes;
+
+    // No Content-Range header is OK only if the first block holds the whole resource.
+    if (resource_size == 0) {
+        if (bytes == d_block_size)
+            throw BESInternalError(prolog + "Could not determine the size of " + d_url, __FILE__, __LINE__);
+        resource_size = bytes;
+    }
+
+    d_size = resource_size;
+    block->resize(block_length(0));
+    if (bytes < block->size())
+        throw BESInternalError(prolog + "Short read of the first block of " + d_url, __FILE__, __LINE__);
+
+    if (!block->empty())
+        add_block(0, block);
+
+    d_open = true;
+    BESDEBUG(MODULE, prolog << d_url << " size: " << d_size << endl);
+}
+
+unsigned long long RangeReadFile::block_length(unsigned long long block) const {
+    unsigned long long start = block * d_block_size;
+    return start >= d_size ? 0 : min(d_block_size, d_size - start);
+}
+
+void RangeReadFile::add_block(unsigned long long block, block_ptr data) {
+    d_lru.push_front(block);
+    d_blocks[block] = make_pair(std::move(data), d_lru.begin());
+
+    while (d_blocks.size() > d_max_blocks) {
+        d_blocks.erase(d_lru.back());
+        d_lru.pop_back();
+    }
+}
+
+/**
+ * Read 'count' blocks, starting with 'first', with one Range GET. Copy the
+ * part of [offset, offset + size) that they hold into buf and cache them.
+ */
+void RangeReadFile::read_blocks(unsigned long long first, unsigned long long count, char *buf,
+                                unsigned long long offset, unsigned long long size) {
+    unsigned long long run_start = first * d_block_size;
+    unsigned long long run_size = min(count * d_block_size, d_size - run_start);
+
+    vector<char> run(run_size);
+    unsigned long long bytes = get_range(run_start, run_size, run.data(), nullptr);
+    ++d_requests;
+    d_bytes_transferred += bytes;
+    if (bytes != run_size)
+        throw BESInternalError(prolog + "Short read from " + d_url, __FILE__, __LINE__);
+
+    BESDEBUG(MODULE, prolog << "Read " << count << " blocks (" << run_size << " bytes) at " << run_start << endl);
+
+    // Copy the overlap with the caller's range
+    unsigned long long copy_start = max(offset, run_start);
+    unsigned long long copy_end = min(offset + size, run_start + run_size);
+    if (copy_start < copy_end)
+        memcpy(buf + (copy_start - offset), run.data() + (copy_start - run_start), copy_end - copy_start);
+
+    for (unsigned long long i = 0; i < count; ++i) {
+        auto start = run.begin() + i * d_block_size;
+        add_block(first + i, make_shared<vector<char>>(start, start + block_length(first + i)));
+    }
+}
+
+/**
+ * @brief Read bytes from the resource
+ * @param buf Value-result; must hold at least size bytes
+ * @param size The number of bytes to read
+ * @param offset The offset of the first byte
+ * @exception BESInternalError if the range is not within the resource or
+ * the read fails.
+ */
+void RangeReadFile::read(char *buf, unsigned long long size, unsigned long long offset) {
+    lock_guard<mutex> lock(d_mutex);
+
+    if (!d_open)
+        throw BESInternalError(prolog + "The resource " + d_url + " is not open.", __FILE__, __LINE__);
+
+    if (size == 0)
+        return;
+
+    if (offset > d_size || size > d_size - offset)
+        throw BESInternalError(prolog + "Read past the end of " + d_url, __FILE__, __LINE__);
+
+    const unsigned long long first = offset / d_block_size;
+    const unsigned long long last = (offset + size - 1) / d_block_size;
+    const unsigned long long num_blocks = (d_size + d_block_size - 1) / d_block_size;
+    const bool sequential = first == d_last_block || first == d_last_block + 1;
+
+    unsigned long long block = first;
+    while (block <= last) {
+        auto it = d_blocks.find(block);
+        if (it != d_blocks.end()) {
+            // Copy the overlap of this cached block with the caller's range
+            unsigned long long block_start = block * d_block_size;
+            unsigned long long copy_start = max(offset, block_start);
+            unsigned long long copy_end = min(offset + size, block_start + it->second.first->size());
+            memcpy(buf + (copy_start - offset), it->second.first->data() + (copy_start - block_start),
+                   copy_end - copy_start);
+
+            d_lru.splice(d_lru.begin(), d_lru, it->second.second);
+            ++block;
+            continue;
+        }
+
+        // Find the run of missing blocks; extend it past the end of the read
+        // if the reads are sequential, but never past what the cache holds.
+        unsigned long long end = block + 1;
+        while (end <= last && d_blocks.find(end) == d_blocks.end())
+            ++end;
+        if (sequential && end > last) {
+            unsigned long long limit = min(num_blocks, last + 1 + d_read_ahead);
+            while (end < limit && d_blocks.find(end) == d_blocks.end())
+                ++end;
+        }
+        unsigned long long count = min<unsigned long long>(end - block, d_max_blocks);
+        count = max<unsigned long long>(count, min(end, last + 1) - block);   // Always cover the read
+
+        read_blocks(block, count, buf, offset, size);
+        block += count;
+    }
+
+    d_last_block = last;
+}
+
+/**
+ * @brief Make a RangeReadFile available to handlers by name
+ * @param name The name passed to the handler in place of a file name
+ * @param file The open RangeReadFile
+ */
+void RangeReadFile::register_file(const string &name, shared_ptr<RangeReadFile> file) {
+    lock_guard<mutex> lock(d_registry_mutex);
+    d_registry[name] = std::move(file);
+}
+
+void RangeReadFile::unregister_file(const string &name) {
+    lock_guard<mutex> lock(d_registry_mutex);
+    d_registry.erase(name);
+}
+
+/**
+ * @brief Find a registered RangeReadFile
+ * @param name The name passed to the handler
+ * @return The RangeReadFile or null if name is not registered (i.e., it is
+ * a regular file).
+ */
+shared_ptr<RangeReadFile> RangeReadFile::find(const string &name) {
+    lock_guard<mutex> lock(d_registry_mutex);
+    auto it = d_registry.find(name);
+    return it == d_registry.end() ? nullptr : it->second;
+}
+
+} // namespace http
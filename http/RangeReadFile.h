@@ -0,0 +1,134 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _bes_http_RANGE_READ_FILE_H_
+#define _bes_http_RANGE_READ_FILE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace http {
+
+/**
+ * @brief A read-only 'file' whose bytes are read from a URL using HTTP Range GETs
+ *
+ * The resource is divided into blocks of a fixed size. Reads are satisfied
+ * from an LRU cache of blocks; missing blocks are read with one Range GET
+ * for each contiguous run. When the reads move forward through the file,
+ * the run is extended by a number of read-ahead blocks.
+ *
+ * A RemoteResource that uses one of these registers it with a file name
+ * that is passed to the handler in place of a temporary file. A handler
+ * that can read through this class (e.g., the hdf5_handler using its
+ * virtual file driver) uses find() to get it; other handlers never see
+ * such names because RemoteResource only does this for the handler types
+ * listed in Http.RemoteResource.RangeRead.Handlers.
+ *
+ * The methods are thread-safe.
+ */
+class RangeReadFile {
+private:
+    friend class RangeReadFileTest;
+
+    std::string d_url;
+    unsigned long long d_block_size;
+    unsigned int d_max_blocks;
+    unsigned int d_read_ahead;
+
+    /// The size of the resource; valid once open() returns
+    unsigned long long d_size = 0;
+    bool d_open = false;
+
+    using block_ptr = std::shared_ptr<std::vector<char>>;
+
+    /// Block numbers, most recently used first
+    std::list<unsigned long long> d_lru;
+    std::unordered_map<unsigned long long, std::pair<block_ptr, std::list<unsigned long long>::iterator>> d_blocks;
+
+    /// The last block touched by read(); used to detect sequential access
+    unsigned long long d_last_block = 0;
+
+    unsigned long long d_bytes_transferred = 0;
+    unsigned long d_requests = 0;
+
+    mutable std::mutex d_mutex;
+
+    static std::mutex d_registry_mutex;
+    static std::map<std::string, std::shared_ptr<RangeReadFile>> d_registry;
+
+    unsigned long long block_length(unsigned long long block) const;
+    void add_block(unsigned long long block, block_ptr data);
+    void read_blocks(unsigned long long first, unsigned long long count, char *buf, unsigned long long offset,
+                     unsigned long long size);
+
+protected:
+    /**
+     * Read bytes from the resource. This is the only method that uses the
+     * network; the unit tests replace it.
+     * @return The number of bytes read
+     */
+    virtual unsigned long long get_range(unsigned long long offset, unsigned long long size, char *buf,
+                                         unsigned long long *resource_size);
+
+public:
+    RangeReadFile(std::string url, unsigned long long block_size, unsigned int max_blocks, unsigned int read_ahead);
+    RangeReadFile(const RangeReadFile &rhs) = delete;
+    RangeReadFile &operator=(const RangeReadFile &rhs) = delete;
+
+    virtual ~RangeReadFile() = default;
+
+    void open();
+
+    void read(char *buf, unsigned long long size, unsigned long long offset);
+
+    /// @return The size of the resource in bytes
+    unsigned long long size() const { return d_size; }
+
+    /// @return The URL of the resource
+    std::string get_url() const { return d_url; }
+
+    /// @return The number of bytes read from the server so far
+    unsigned long long get_bytes_transferred() const {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_bytes_transferred;
+    }
+
+    /// @return The number of Range GET requests made so far
+    unsigned long get_requests() const {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_requests;
+    }
+
+    static void register_file(const std::string &name, std::shared_ptr<RangeReadFile> file);
+    static void unregister_file(const std::string &name);
+    static std::shared_ptr<RangeReadFile> find(const std::string &name);
+};
+
+} // namespace http
+
+#endif // _bes_http_RANGE_READ_FILE_H_
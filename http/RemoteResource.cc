@@ -35,6 +35,8 @@
 #include <utility>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include "BESInternalError.h"
 
@@ -44,8 +46,10 @@
 #include "HttpUtils.h"
 #include "CurlUtils.h"
 #include "HttpError.h"
+#include "HttpCache.h"
 #include "HttpNames.h"
 #include "RemoteResource.h"
+#include "RangeReadFile.h"
 #include "TheBESKeys.h"
 #include "BESStopWatch.h"
 #include "BESLog.h"
@@ -115,6 +119,8 @@ RemoteResource::RemoteResource(shared_ptr <http::url> target_url, string uid)
  * will remove the temporary file from the file system.
  */
 RemoteResource::~RemoteResource() {
+    if (d_range_read)
+        RangeReadFile::unregister_file(d_filename);
     if (!d_filename.empty() && d_delete_file)
         unlink(d_filename.c_str());
     if (d_fd != -1)
@@ -159,6 +165,62 @@ void RemoteResource::set_delete_temp_file() {
     d_delete_file = TheBESKeys::TheKeys()->read_bool_key(REMOTE_RESOURCE_DELETE_TMP_FILE, true);
 }
 
+/**
+ * @brief Should this resource be read using HTTP Range GETs?
+ *
+ * @note Private
+ *
+ * @return True if the resource's type is listed in REMOTE_RESOURCE_RANGE_READ_HANDLERS_KEY
+ */
+bool RemoteResource::use_range_read() const {
+    vector<string> handlers;
+    bool found = false;
+    TheBESKeys::TheKeys()->get_values(REMOTE_RESOURCE_RANGE_READ_HANDLERS_KEY, handlers, found);
+    return found && find(handlers.begin(), handlers.end(), d_type) != handlers.end();
+}
+
+/**
+ * @brief Open a RangeReadFile for the resource and register it
+ *
+ * @note Private
+ *
+ * The name the RangeReadFile is registered under is in the temporary file
+ * directory and ends with '#' and the basename, like a downloaded resource,
+ * but no file is made.
+ *
+ * @return True if the server supports Range GETs and the file was registered,
+ * false if the resource should be downloaded instead.
+ */
+bool RemoteResource::open_range_read_file() {
+    static atomic<unsigned long> range_read_count{0};
+
+    auto block_size = TheBESKeys::TheKeys()->read_ulong_key(REMOTE_RESOURCE_RANGE_READ_BLOCK_SIZE_KEY, 1024 * 1024);
+    auto cache_blocks = TheBESKeys::TheKeys()->read_ulong_key(REMOTE_RESOURCE_RANGE_READ_CACHE_BLOCKS_KEY, 64);
+    auto read_ahead = TheBESKeys::TheKeys()->read_ulong_key(REMOTE_RESOURCE_RANGE_READ_AHEAD_KEY, 4);
+
+    auto file = make_shared<RangeReadFile>(d_url->str(), block_size, cache_blocks, read_ahead);
+    try {
+        file->open();
+    }
+    catch (BESError &e) {
+        INFO_LOG(prolog + "Range GETs are not possible for " + d_url->str() + ", downloading it instead ("
+                 + e.get_message() + ")");
+        return false;
+    }
+
+    d_filename = BESUtil::pathConcat(d_temp_file_dir, "range_read_" + to_string(getpid()) + "_"
+                                     + to_string(range_read_count++) + "_" + d_uid + "#" + d_basename);
+    RangeReadFile::register_file(d_filename, file);
+
+    d_range_read = true;
+    d_delete_file = false;
+    d_fd = -1;
+
+    BESDEBUG(MODULE, prolog << "Reading " << d_url->str() << " (" << file->size() << " bytes) using Range GETs as "
+                            << d_filename << endl);
+    return true;
+}
+
 /**
  * @brief Set the filename field for a file URL
  *
@@ -191,7 +253,10 @@ void RemoteResource::set_filename_for_file_url() {
  *
  * When this method returns the RemoteResource object is fully initialized
  * URL contents are available in the temporary file. For file:// URLs this
- * method is a no-op.
+ * method is a no-op. If the resource's handler can read it using HTTP Range
+ * GETs (see Http.RemoteResource.RangeRead.Handlers) and the server supports
+ * them, no temporary file is made; get_filename() returns the name of the
+ * registered RangeReadFile.
  * @param http_request_headers A pointer to a curl_slist of HTTP request headers. Default is
  * null. These headers will be appended to the list of default headers.
  */
@@ -200,6 +265,13 @@ void RemoteResource::retrieve_resource(curl_slist *http_request_headers) {
         return;
     }
 
+    // For handlers that can read a RangeReadFile, skip the download. The Range GETs
+    // are made without extra request headers, so requests that need them are downloaded.
+    if (!http_request_headers && use_range_read() && open_range_read_file()) {
+        d_initialized = true;
+        return;
+    }
+
     {
         lock_guard<mutex> lock(d_mkstemp_mutex);
         // Make a temporary file, get an open descriptor for it. The make_temp_file() function
@@ -242,8 +314,8 @@ void RemoteResource::get_url(int fd, curl_slist *http_request_headers) {
     BES_STOPWATCH_START(MODULE, prolog + "Timing retrieval. Target url: " + d_url->str());
 
     try {
-        // Throws an HttpError if there is a curl error.
-        curl::http_get_and_write_resource(d_url, fd, &d_response_headers, http_request_headers);
+        // Throws an HttpError if there is a curl error. Uses the persistent cache, if configured.
+        HttpCache::TheCache()->get_and_write_resource(d_url, fd, &d_response_headers, http_request_headers);
         BESDEBUG(MODULE, prolog << "Resource " << d_url->str() << " saved to temporary file " << d_filename << endl);
     }
     catch (http::HttpError &http_error) {
@@ -43,6 +43,11 @@ class url;
  * retrieve the content of the resource and place it in a local temporary file.
  * It can be configured to use a proxy server for the outgoing requests using
  * features of the CurlUtils functions.
+ *
+ * For the handler types listed in Http.RemoteResource.RangeRead.Handlers, the
+ * content is not downloaded. Instead, a RangeReadFile is registered under the
+ * name returned by get_filename() and the handler reads only the parts of the
+ * resource it needs.
  */
 class RemoteResource {
 private:
@@ -83,6 +88,9 @@ private:
     /// The raw HTTP response headers returned by the request for the remote resource.
     std::vector<std::string> d_response_headers; // Response headers
 
+    /// If true, d_filename names a RangeReadFile and no temporary file was made.
+    bool d_range_read = false;
+
     /// write the url content to a file, set the type, and rewind the file descriptor
     void get_url(int fd, curl_slist *http_request_headers = nullptr);
 
@@ -93,6 +101,10 @@ private:
 
     void set_delete_temp_file();
 
+    bool use_range_read() const;
+
+    bool open_range_read_file();
+
 public:
     /// The default constructor is here to ease testing. Remove if not needed. jhrg 3/8/23
     RemoteResource() = default;
@@ -115,6 +127,9 @@ public:
 
     /// Return the file descriptor to the open temp file
     int get_fd() const { return d_fd; }
+
+    /// True if the content is read using HTTP Range GETs; get_filename() then names a RangeReadFile.
+    bool is_range_read() const { return d_range_read; }
 };
 
 } /* namespace http */
@@ -40,6 +40,7 @@
 #include <ctime>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 #include <openssl/evp.h>
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
@@ -242,140 +243,228 @@ std::string hmac_to_string(const unsigned char *hmac) {
  *          where md must be EVP_MAX_MD_SIZE in size
  */
 
-std::string calculate_signature(const std::time_t &request_date,
-                                      const std::string &secret,
-                                      const std::string &region,
-                                      const std::string &service,
-                                      const std::string &string_to_sign) {
+// The signing keys and the request signers are cached using the SHA256 of
+// the secret key and the other values, so the secret is not kept in the
+// caches' keys.
+static std::mutex signing_keys_mutex;
+static std::map<std::string, std::vector<unsigned char>> signing_keys;
+
+static std::mutex signers_mutex;
+static std::map<std::string, std::shared_ptr<const GetRequestSigner>> signers;
+
+static std::string hashed_cache_key(const std::vector<std::string> &parts) {
+    return sha256_base16(join(parts, ENDL));
+}
+
+/// @return The number of signing keys cached by signing_key()
+size_t signing_key_cache_size() {
+    std::lock_guard<std::mutex> lock(signing_keys_mutex);
+    return signing_keys.size();
+}
+
+/// @return The number of signers cached by get_request_signer()
+size_t request_signer_cache_size() {
+    std::lock_guard<std::mutex> lock(signers_mutex);
+    return signers.size();
+}
+
+/**
+ * @brief Get the signing key (kSigning) for a secret, day, region and service
+ *
+ * The key is derived using four HMACs and cached; it changes only when the
+ * day (UTC) changes.
+ *
+ * @param request_date The request date; only the day is used
+ * @param secret The AWS secret key
+ * @param region The AWS region
+ * @param service The AWS service
+ * @param key Value-result; the signing key
+ */
+void signing_key(const std::time_t &request_date, const std::string &secret, const std::string &region,
+                 const std::string &service, unsigned char key[SHA256_DIGEST_LENGTH]) {
+    const std::string yyyymmdd = utc_yyyymmdd(request_date);
+    const std::string cache_key = hashed_cache_key({yyyymmdd, region, service, secret});
+
+    std::lock_guard<std::mutex> lock(signing_keys_mutex);
+    auto it = signing_keys.find(cache_key);
+    if (it != signing_keys.end()) {
+        memcpy(key, it->second.data(), SHA256_DIGEST_LENGTH);
+        return;
+    }
 
     // These are used/re-used for the various signatures. jhrg 1/3/20
     unsigned char md[EVP_MAX_MD_SIZE + 1];
     unsigned int md_len;
 
     const std::string k1 = AWS4 + secret;
-    const std::string yyyymmdd = utc_yyyymmdd(request_date);
     // NB: The third argument for HMAC is an unsigned int. jhrg 10/31/22
     const unsigned char *kDate = HMAC(EVP_sha256(), (const void *)k1.c_str(), (unsigned int)k1.size(),
                                 (const unsigned char *) yyyymmdd.c_str(), yyyymmdd.size(), md, &md_len);
     if (!kDate)
         throw BESInternalError("Could not compute AWS V4 request signature.", __FILE__, __LINE__);
 
-    md[md_len] = '\0';
-    BESDEBUG(HTTP_MODULE,
-             prolog << "kDate: " << hmac_to_string(kDate) << " md_len: " << md_len << " md: " << hmac_to_string(md)
-                    << std::endl);
-
     const unsigned char *kRegion = HMAC(EVP_sha256(), md, md_len,
                                   (const unsigned char *) region.c_str(), region.size(), md, &md_len);
     if (!kRegion)
         throw BESInternalError("Could not compute AWS V4 request signature.", __FILE__, __LINE__);
 
-    md[md_len] = '\0';
-    BESDEBUG(HTTP_MODULE,
-             prolog << "kRegion: " << hmac_to_string(kRegion) << " md_len: " << md_len << " md: " << hmac_to_string(md)
-                    << std::endl);
-
     const unsigned char *kService = HMAC(EVP_sha256(), md, md_len,
                                    (const unsigned char *) service.c_str(), service.size(), md, &md_len);
     if (!kService)
         throw BESInternalError("Could not compute AWS V4 request signature.", __FILE__, __LINE__);
 
-    md[md_len] = '\0';
-    BESDEBUG(HTTP_MODULE, prolog << "kService: " << hmac_to_string(kService) << " md_len: " << md_len << " md: "
-                           << hmac_to_string(md) << std::endl);
-
     const unsigned char *kSigning = HMAC(EVP_sha256(), md, md_len,
                                    (const unsigned char *) AWS4_REQUEST.c_str(), AWS4_REQUEST.size(), md, &md_len);
-    if (!kSigning)
+    if (!kSigning || md_len != SHA256_DIGEST_LENGTH)
         throw BESInternalError("Could not compute AWS V4 request signature.", __FILE__, __LINE__);
 
-    md[md_len] = '\0';
-    BESDEBUG(HTTP_MODULE,
-             prolog << "kSigning: " << hmac_to_string(kRegion) << " md_len: " << md_len << " md: " << hmac_to_string(md)
-                    << std::endl);
+    BESDEBUG(HTTP_MODULE, prolog << "kSigning: " << hmac_to_string(md) << " for " << yyyymmdd << "/" << region
+                                 << "/" << service << std::endl);
+
+    // The keys for past days are of no further use.
+    if (signing_keys.size() >= max_signing_keys)
+        signing_keys.clear();
+    signing_keys.emplace(cache_key, std::vector<unsigned char>(md, md + SHA256_DIGEST_LENGTH));
 
-    const unsigned char *kSig = HMAC(EVP_sha256(), md, md_len,
+    memcpy(key, md, SHA256_DIGEST_LENGTH);
+}
+
+std::string calculate_signature(const std::time_t &request_date,
+                                      const std::string &secret,
+                                      const std::string &region,
+                                      const std::string &service,
+                                      const std::string &string_to_sign) {
+    unsigned char key[SHA256_DIGEST_LENGTH];
+    signing_key(request_date, secret, region, service, key);
+
+    unsigned char md[EVP_MAX_MD_SIZE + 1];
+    unsigned int md_len;
+    const unsigned char *kSig = HMAC(EVP_sha256(), key, SHA256_DIGEST_LENGTH,
                                (const unsigned char *) string_to_sign.c_str(), string_to_sign.size(), md, &md_len);
     if (!kSig)
         throw BESInternalError("Could not compute AWS V4 request signature.", __FILE__, __LINE__);
 
-    md[md_len] = '\0';
     auto sig = hmac_to_string(md);
-    BESDEBUG(HTTP_MODULE, prolog << "kSig: " << sig << " md_len: " << md_len << " md: " << hmac_to_string(md) << std::endl);
+    BESDEBUG(HTTP_MODULE, prolog << "kSig: " << sig << " md_len: " << md_len << std::endl);
     return sig;
 }
 
 /**
- * @brief Return the AWS V4 signature for a given GET request.
- *
- * This version takes strings for the path, query string and host.
+ * @brief Build the parts of the canonical request that do not change
  *
  * @param canonical_uri The path part of the URI
  * @param canonical_query The URI query string
  * @param host The host part of the URI
- * @param request_date The current date & time
- * @param secret_key The Secret key for this resource (the thing referenced by the URI).
- * @param region The AWS region where the request is being made (us-west-2 by default)
- * @param service The AWS service that is the target of the request (S3 by default)
- * @return The AWS V4 Signature string.
+ * @param public_key The AWS key id
+ * @param secret_key The AWS secret key
+ * @param region The AWS region
+ * @param service The AWS service
  */
-std::string compute_awsv4_signature(const std::string &canonical_uri, const std::string &canonical_query,
-                                    const std::string &host, const std::time_t &request_date,
-                                    const std::string &public_key, const std::string &secret_key,
-                                    const std::string &region, const std::string &service) {
+GetRequestSigner::GetRequestSigner(const std::string &canonical_uri, const std::string &canonical_query,
+                                   const std::string &host, std::string public_key, std::string secret_key,
+                                   std::string region, std::string service)
+        : d_public_key(std::move(public_key)), d_secret_key(std::move(secret_key)), d_region(std::move(region)),
+          d_service(std::move(service)) {
     // We can eliminate one call to sha256 if the payload is null, which
     // is the case for a GET request. jhrg 11/25/19
     const std::string sha256_empty_payload = {"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"};
-    // All AWS V4 signature require x-amz-content-sha256. jhrg 11/24/19
 
-    // We used to do it like the code in the other half of this #if
-    // But it seems we don't need the x-amz-content-sha256 header for empty payload
-    // so here it is without.
+    // The signed headers are host and x-amz-date. We don't need the
+    // x-amz-content-sha256 header for an empty payload.
     //
     // NOTE: Changing this will break the awsv4_test using tests. jhrg 1/3/20
-    std::vector<std::string> headers{"host: ", "x-amz-date: "};
-    headers[0].append(host);
-    headers[1].append(ISO8601_date(request_date));
-
-    const auto canonical_headers_map = canonicalize_headers(headers);
-    if (canonical_headers_map.empty()) {
+    const std::string canonical_host = trim(host);
+    if (canonical_host.empty()) {
         throw std::runtime_error("Empty header list while building AWS V4 request signature");
     }
-    const auto headers_string = map_headers_string(canonical_headers_map);
-    const auto signed_headers = map_signed_headers(canonical_headers_map);
-    const auto canonical_request = canonicalize_request(AWSV4::GET,
-                                                        canonical_uri,
-                                                        canonical_query,
-                                                        headers_string,
-                                                        signed_headers,
-                                                        sha256_empty_payload);
+
+    d_canonical_prefix = std::string(AWSV4::GET).append(ENDL).append(canonical_uri).append(ENDL)
+            .append(canonical_query).append(ENDL).append("host:").append(canonical_host).append(ENDL)
+            .append("x-amz-date:");
+    d_canonical_suffix = std::string(ENDL).append(ENDL).append("host;x-amz-date").append(ENDL)
+            .append(sha256_empty_payload);
+}
+
+/**
+ * @brief Get the value of the Authorization header for a request made at request_date
+ * @param request_date The current date & time; use the same value for the x-amz-date header.
+ * @return The AWS V4 Authorization header value
+ */
+std::string GetRequestSigner::authorization_header(const std::time_t &request_date) const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (request_date == d_last_date && !d_last_header.empty())
+        return d_last_header;
+
+    const std::string request_iso_date = ISO8601_date(request_date);
+    const std::string canonical_request = d_canonical_prefix + request_iso_date + d_canonical_suffix;
 
     BESDEBUG(HTTP_MODULE, prolog << "Canonical Request: " << canonical_request << std::endl);
 
-    auto hashed_canonical_request = sha256_base16(canonical_request);
-    auto credential_scope = AWSV4::credential_scope(request_date, region, service);
-    auto string_to_sign = AWSV4::string_to_sign(STRING_TO_SIGN_ALGO,
-                                                request_date,
-                                                credential_scope,
-                                                hashed_canonical_request);
+    const auto scope = credential_scope(request_date, d_region, d_service);
+    const auto to_sign = std::string(STRING_TO_SIGN_ALGO).append(ENDL).append(request_iso_date).append(ENDL)
+            .append(scope).append(ENDL).append(sha256_base16(canonical_request));
 
-    BESDEBUG(HTTP_MODULE, prolog << "String to Sign: " << string_to_sign << std::endl);
+    BESDEBUG(HTTP_MODULE, prolog << "String to Sign: " << to_sign << std::endl);
 
-    auto signature = calculate_signature(request_date,
-                                         secret_key,
-                                         region,
-                                         service,
-                                         string_to_sign);
+    const auto signature = calculate_signature(request_date, d_secret_key, d_region, d_service, to_sign);
 
-    BESDEBUG(HTTP_MODULE, prolog << "signature: " << signature << std::endl);
+    d_last_header = STRING_TO_SIGN_ALGO + " Credential=" + d_public_key + "/" + scope
+                    + ", SignedHeaders=host;x-amz-date, Signature=" + signature;
+    d_last_date = request_date;
 
-    std::string authorization_header = STRING_TO_SIGN_ALGO + " Credential=" + public_key + "/"
-                                       + credential_scope + ", SignedHeaders=" + signed_headers + ", Signature=" +
-                                       signature;
+    BESDEBUG(HTTP_MODULE, prolog << "authorization_header: " << d_last_header << std::endl);
 
-    BESDEBUG(HTTP_MODULE, prolog << "authorization_header: " << authorization_header << std::endl);
+    return d_last_header;
+}
 
-    return authorization_header;
+/**
+ * @brief Get the GetRequestSigner for a URL and set of credentials
+ *
+ * The signers are cached, so the DMR++ handler's many requests for chunks
+ * of one file share one.
+ */
+std::shared_ptr<const GetRequestSigner> get_request_signer(const std::string &canonical_uri,
+                                                           const std::string &canonical_query,
+                                                           const std::string &host, const std::string &public_key,
+                                                           const std::string &secret_key, const std::string &region,
+                                                           const std::string &service) {
+    const std::string key = hashed_cache_key({canonical_uri, canonical_query, host, public_key, secret_key, region,
+                                              service});
+
+    std::lock_guard<std::mutex> lock(signers_mutex);
+    auto it = signers.find(key);
+    if (it != signers.end())
+        return it->second;
+
+    if (signers.size() >= max_request_signers)
+        signers.clear();
+
+    auto signer = std::make_shared<const GetRequestSigner>(canonical_uri, canonical_query, host, public_key,
+                                                           secret_key, region, service);
+    signers.emplace(key, signer);
+    return signer;
+}
+
+/**
+ * @brief Return the AWS V4 signature for a given GET request.
+ *
+ * This version takes strings for the path, query string and host.
+ *
+ * @param canonical_uri The path part of the URI
+ * @param canonical_query The URI query string
+ * @param host The host part of the URI
+ * @param request_date The current date & time
+ * @param secret_key The Secret key for this resource (the thing referenced by the URI).
+ * @param region The AWS region where the request is being made (us-west-2 by default)
+ * @param service The AWS service that is the target of the request (S3 by default)
+ * @return The AWS V4 Signature string.
+ */
+std::string compute_awsv4_signature(const std::string &canonical_uri, const std::string &canonical_query,
+                                    const std::string &host, const std::time_t &request_date,
+                                    const std::string &public_key, const std::string &secret_key,
+                                    const std::string &region, const std::string &service) {
+    return get_request_signer(canonical_uri, canonical_query, host, public_key, secret_key, region, service)
+            ->authorization_header(request_date);
 }
 
 /**
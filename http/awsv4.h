@@ -34,6 +34,7 @@
 #include <cstdio>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <ctime>
 #include <iostream>
@@ -87,6 +88,56 @@ std::string calculate_signature(const std::time_t &request_date,
                                       const std::string &service,
                                       const std::string &string_to_sign);
 
+void signing_key(const std::time_t &request_date, const std::string &secret, const std::string &region,
+                 const std::string &service, unsigned char key[SHA256_DIGEST_LENGTH]);
+
+/// The caches of signing keys and request signers are emptied when they reach these sizes
+const size_t max_signing_keys = 64;
+const size_t max_request_signers = 1024;
+
+size_t signing_key_cache_size();
+size_t request_signer_cache_size();
+
+/**
+ * @brief Sign GET requests for one URL
+ *
+ * Everything in the canonical request except the x-amz-date value depends
+ * only on the URL, so it is built once. Signing a request then costs one
+ * SHA256 of the canonical request and one HMAC using the signing key,
+ * which is cached for each secret, day, region and service. Requests made
+ * in the same second share a signature.
+ *
+ * Thread safe.
+ */
+class GetRequestSigner {
+    std::string d_public_key;
+    std::string d_secret_key;
+    std::string d_region;
+    std::string d_service;
+
+    /// The canonical request up to, and after, the x-amz-date value
+    std::string d_canonical_prefix;
+    std::string d_canonical_suffix;
+
+    mutable std::mutex d_mutex;
+    mutable std::time_t d_last_date = 0;
+    mutable std::string d_last_header;
+
+public:
+    GetRequestSigner(const std::string &canonical_uri, const std::string &canonical_query, const std::string &host,
+                     std::string public_key, std::string secret_key, std::string region, std::string service);
+    GetRequestSigner(const GetRequestSigner &) = delete;
+    GetRequestSigner &operator=(const GetRequestSigner &) = delete;
+
+    std::string authorization_header(const std::time_t &request_date) const;
+};
+
+std::shared_ptr<const GetRequestSigner> get_request_signer(const std::string &canonical_uri,
+                                                           const std::string &canonical_query,
+                                                           const std::string &host, const std::string &public_key,
+                                                           const std::string &secret_key, const std::string &region,
+                                                           const std::string &service);
+
 // The whole enchilada. Added jhrg 11/25/19
 std::string compute_awsv4_signature(const std::shared_ptr<http::url> &uri_str, const std::time_t &request_date,
                                     const std::string &public_key, const std::string &secret_key,
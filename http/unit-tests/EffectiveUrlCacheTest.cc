@@ -23,8 +23,14 @@
 
 #include "config.h"
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <cppunit/TextTestRunner.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -102,7 +108,7 @@ public:
 
         // Clear the cache for the next test.
         EffectiveUrlCache *theCache = EffectiveUrlCache::TheCache();
-        theCache->d_effective_urls.clear();
+        theCache->clear();
 
         if (!token.empty()) {
             DBG(cerr << "Setting BESContext " << EDL_AUTH_TOKEN_CONTEXT_KEY << " to: '" << token << "'" << endl);
@@ -122,9 +128,8 @@ public:
         shared_ptr<http::url> src_url_00(new http::url("http://started_here.com"));
         auto effective_url_00 = shared_ptr<http::EffectiveUrl>(new http::EffectiveUrl("https://ended_here.com"));
 
-        EffectiveUrlCache::TheCache()->d_effective_urls.insert(
-                pair<string, shared_ptr<http::EffectiveUrl>>(src_url_00->str(), effective_url_00));
-        CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+        EffectiveUrlCache::TheCache()->add_cached_eurl(src_url_00->str(), effective_url_00);
+        CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
         // This one does not add the URL or even check it because it _should_ be matching the skip regex.
         auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(src_url_00);
@@ -141,7 +146,7 @@ public:
             // in the bes.conf
             shared_ptr<http::url> src_url(new http::url("https://foobar.com/opendap/data/nc/fnoc1.nc?dap4.ce=u;v"));
             auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(src_url);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.empty());
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 0);
             CPPUNIT_ASSERT(result_url->str() == src_url->str());
         }
         catch (const BESError &be) {
@@ -169,16 +174,15 @@ public:
                               "Nzd0ffK8VtxO8JP7thrGIQ%3D%3D&X-Amz-SignedHeaders=host&X-Amz-Signature=260a7c4dd4-AW"
                               "S-SIGGY-0c7a39ee899";
             auto effective_url_00 = shared_ptr<http::EffectiveUrl>(new http::EffectiveUrl(eurl_str));
-            EffectiveUrlCache::TheCache()->d_effective_urls.insert(pair<string, shared_ptr<http::EffectiveUrl>>(src_url_00, effective_url_00));
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            EffectiveUrlCache::TheCache()->add_cached_eurl(src_url_00, effective_url_00);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 #endif
 
             string src_url_01 = "http://test.opendap.org/data/httpd_catalog/READTHIS";
             string eurl_str = "https://test.opendap.org/data/httpd_catalog/READTHIS";
             auto effective_url_01 = shared_ptr<http::EffectiveUrl>(new http::EffectiveUrl(eurl_str));
-            EffectiveUrlCache::TheCache()->d_effective_urls.insert(
-                    pair<string, shared_ptr<http::EffectiveUrl>>(src_url_01, effective_url_01));
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            EffectiveUrlCache::TheCache()->add_cached_eurl(src_url_01, effective_url_01);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             // This one actually does the thing
             eurl_str = "http://test.opendap.org/opendap/";
@@ -187,7 +191,7 @@ public:
             shared_ptr<http::url> src_url_02(new http::url("http://test.opendap.org/opendap"));
             DBG(cerr << prolog << "Retrieving effective URL for: " << src_url_02->str() << endl);
             auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(src_url_02);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 2);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 2);
 
             DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->get_effective_url() returned: " << result_url
                      << endl);
@@ -257,7 +261,7 @@ public:
 
             DBG(cerr << prolog << "Retrieving effective URL for: " << thing1->str() << endl);
             auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(thing1);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->get_effective_url() returned: " << result_url
                      << endl);
@@ -295,7 +299,7 @@ public:
 
             DBG(cerr << prolog << "Retrieving effective URL for: " << thing1->str() << endl);
             auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(thing1);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->get_effective_url() returned: " << result_url
                      << endl);
@@ -334,9 +338,9 @@ public:
             DBG(cerr << prolog << "result_url: " << result_url->str() << " is "
                      << (result_url->is_trusted() ? "" : "NOT ") << "trusted." << endl);
 
-            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->d_effective_urls.size(): "
-                     << EffectiveUrlCache::TheCache()->d_effective_urls.size() << endl);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->size(): "
+                     << EffectiveUrlCache::TheCache()->size() << endl);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             DBG(cerr << prolog << "result_url->str() == result_url_str: " <<
                 (result_url->str() == result_url_str?"true":"false") << "\n");
@@ -352,9 +356,9 @@ public:
             DBG(cerr << prolog << "result_url: " << result_url->str() << " is "
                      << (result_url->is_trusted() ? "" : "NOT ") << "trusted." << endl);
 
-            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->d_effective_urls.size(): "
-                     << EffectiveUrlCache::TheCache()->d_effective_urls.size() << endl);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->size(): "
+                     << EffectiveUrlCache::TheCache()->size() << endl);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             DBG(cerr << prolog << "result_url->str() == result_url_str: " <<
             (result_url->str() == result_url_str?"true":"false") << "\n");
@@ -370,9 +374,9 @@ public:
             DBG(cerr << prolog << "result_url: " << result_url->str() << " is "
                      << (result_url->is_trusted() ? "" : "NOT ") << "trusted." << endl);
 
-            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->d_effective_urls.size(): "
-                     << EffectiveUrlCache::TheCache()->d_effective_urls.size() << endl);
-            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->d_effective_urls.size() == 1);
+            DBG(cerr << prolog << "EffectiveUrlCache::TheCache()->size(): "
+                     << EffectiveUrlCache::TheCache()->size() << endl);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
 
             DBG(cerr << prolog << "result_url->str() == result_url_str: " <<
                 (result_url->str() == result_url_str?"true":"false") << "\n");
@@ -406,6 +410,222 @@ public:
         DBG(cerr << prolog << "END" << endl);
     }
 
+    // A cached URL is used until HTTP_URL_REFRESH_THRESHOLD seconds before its signature expires.
+    void refresh_time_test() {
+        DBG(cerr << prolog << "BEGIN" << endl);
+        try {
+            EffectiveUrlCache::TheCache()->d_enabled = true;
+
+            time_t now = time(nullptr);
+            string src_url = "http://test.opendap.org/data/nothing_is_here.html";
+            string eurl_str = "https://test.opendap.org/data/httpd_catalog/READTHIS?Expires=" + to_string(now + 3600);
+            EffectiveUrlCache::TheCache()->add_cached_eurl(src_url + ":test_user", make_shared<http::EffectiveUrl>(eurl_str));
+
+            auto &shard = EffectiveUrlCache::TheCache()->get_shard(src_url + ":test_user");
+            auto const &entry = shard.effective_urls.at(src_url + ":test_user");
+            DBG(cerr << prolog << "refresh_time: " << entry.refresh_time << endl);
+            CPPUNIT_ASSERT(entry.refresh_time == now + 3600 - HTTP_URL_REFRESH_THRESHOLD);
+
+            // Fresh, so this must not contact the server.
+            auto result_url = EffectiveUrlCache::TheCache()->get_effective_url(make_shared<http::url>(src_url));
+            CPPUNIT_ASSERT(result_url->str() == eurl_str);
+
+            // This one expires inside the refresh threshold, so it is stale as soon as it's cached.
+            eurl_str = "https://test.opendap.org/data/httpd_catalog/READTHIS?Expires=" + to_string(now + 10);
+            EffectiveUrlCache::TheCache()->add_cached_eurl(src_url + ":test_user", make_shared<http::EffectiveUrl>(eurl_str));
+            CPPUNIT_ASSERT(shard.effective_urls.at(src_url + ":test_user").refresh_time < now);
+            CPPUNIT_ASSERT(EffectiveUrlCache::TheCache()->size() == 1);
+        }
+        catch (const BESError &be) {
+            stringstream msg;
+            msg << prolog << "ERROR! Caught BESError. Message: " << be.get_message() << endl;
+            CPPUNIT_FAIL(msg.str());
+        }
+        DBG(cerr << prolog << "END" << endl);
+    }
+
+    // Threads that need a URL that is being acquired wait for it and share the result.
+    void single_flight_test() {
+        DBG(cerr << prolog << "BEGIN" << endl);
+        EffectiveUrlCache *cache = EffectiveUrlCache::TheCache();
+        cache->d_enabled = true;
+
+        const string src_url = "http://test.opendap.org/data/single_flight";
+        const string key = src_url + ":test_user";
+        const string eurl_str = "https://test.opendap.org/data/httpd_catalog/READTHIS?Expires="
+                                + to_string(time(nullptr) + 3600);
+
+        // Pretend that another thread is following the redirects for src_url.
+        std::promise<shared_ptr<EffectiveUrl>> acquiring;
+        auto &shard = cache->get_shard(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight[key] = acquiring.get_future().share();
+        }
+
+        std::atomic<int> done{0};
+        vector<string> results(4);
+        vector<thread> waiters;
+        for (auto &result: results) {
+            waiters.emplace_back([&result, &done, cache, src_url]() {
+                result = cache->get_effective_url(make_shared<http::url>(src_url))->str();
+                ++done;
+            });
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(100));
+        CPPUNIT_ASSERT_MESSAGE("The waiters must not contact the server", done == 0);
+
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight.erase(key);
+        }
+        acquiring.set_value(make_shared<EffectiveUrl>(eurl_str));
+        for (auto &waiter: waiters)
+            waiter.join();
+
+        CPPUNIT_ASSERT(done == 4);
+        for (auto const &result: results)
+            CPPUNIT_ASSERT_EQUAL(eurl_str, result);
+        DBG(cerr << prolog << "END" << endl);
+    }
+
+    // When the thread acquiring a URL fails, the threads waiting for it get its exception.
+    void single_flight_error_test() {
+        DBG(cerr << prolog << "BEGIN" << endl);
+        EffectiveUrlCache *cache = EffectiveUrlCache::TheCache();
+        cache->d_enabled = true;
+
+        const string src_url = "http://test.opendap.org/data/single_flight_error";
+        const string key = src_url + ":test_user";
+
+        std::promise<shared_ptr<EffectiveUrl>> acquiring;
+        auto &shard = cache->get_shard(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight[key] = acquiring.get_future().share();
+        }
+
+        std::atomic<int> errors{0};
+        vector<thread> waiters;
+        for (int i = 0; i < 4; ++i) {
+            waiters.emplace_back([&errors, cache, src_url]() {
+                try {
+                    cache->get_effective_url(make_shared<http::url>(src_url));
+                }
+                catch (const std::runtime_error &) {
+                    ++errors;
+                }
+            });
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(100));
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight.erase(key);
+        }
+        acquiring.set_exception(make_exception_ptr(std::runtime_error("Redirect failed")));
+        for (auto &waiter: waiters)
+            waiter.join();
+
+        CPPUNIT_ASSERT(errors == 4);
+        CPPUNIT_ASSERT(cache->size() == 0);
+        DBG(cerr << prolog << "END" << endl);
+    }
+
+    // prefetch() does nothing for URLs that are cached, being acquired, or not HTTP.
+    void prefetch_needed_test() {
+        DBG(cerr << prolog << "BEGIN" << endl);
+        EffectiveUrlCache *cache = EffectiveUrlCache::TheCache();
+        cache->d_enabled = true;
+        cache->d_prefetch_enabled = true;
+
+        auto cached_url = make_shared<http::url>("http://test.opendap.org/data/cached");
+        cache->add_cached_eurl(cached_url->str() + ":test_user", make_shared<EffectiveUrl>(
+                "https://test.opendap.org/data/cached?Expires=" + to_string(time(nullptr) + 3600)));
+        CPPUNIT_ASSERT(!cache->is_prefetch_needed(cached_url));
+
+        auto in_flight_url = make_shared<http::url>("http://test.opendap.org/data/in_flight");
+        std::promise<shared_ptr<EffectiveUrl>> acquiring;
+        auto &shard = cache->get_shard(in_flight_url->str() + ":test_user");
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight[in_flight_url->str() + ":test_user"] = acquiring.get_future().share();
+        }
+        CPPUNIT_ASSERT(!cache->is_prefetch_needed(in_flight_url));
+
+        auto file_url = make_shared<http::url>("file:///tmp/not_http");
+        CPPUNIT_ASSERT(!cache->is_prefetch_needed(file_url));
+
+        cache->prefetch(cached_url);
+        cache->prefetch(in_flight_url);
+        cache->prefetch(file_url);
+        CPPUNIT_ASSERT(cache->d_prefetchers.empty());
+
+        auto new_url = make_shared<http::url>("http://test.opendap.org/data/not_cached");
+        CPPUNIT_ASSERT(cache->is_prefetch_needed(new_url));
+
+        // Nothing is needed while all of the prefetch threads are busy
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        {
+            std::lock_guard<std::mutex> lock(cache->d_prefetch_mutex);
+            for (unsigned int i = 0; i < EffectiveUrlCache::d_max_prefetch_threads; ++i) {
+                std::thread busy([released]() { released.wait(); });
+                auto id = busy.get_id();
+                cache->d_prefetchers.emplace(id, std::move(busy));
+            }
+        }
+        CPPUNIT_ASSERT(!cache->is_prefetch_needed(new_url));
+        release.set_value();
+        cache->join_prefetchers();
+        CPPUNIT_ASSERT(cache->is_prefetch_needed(new_url));
+
+        cache->d_prefetch_enabled = false;
+        CPPUNIT_ASSERT(!cache->is_prefetch_needed(new_url));
+        cache->prefetch(new_url);
+        CPPUNIT_ASSERT(cache->d_prefetchers.empty());
+
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.in_flight.clear();
+        }
+        DBG(cerr << prolog << "END" << endl);
+    }
+
+    // A prefetched URL is acquired once, by the prefetch thread.
+    void prefetch_test() {
+        DBG(cerr << prolog << "BEGIN" << endl);
+        EffectiveUrlCache *cache = EffectiveUrlCache::TheCache();
+        try {
+            cache->d_enabled = true;
+            cache->d_prefetch_enabled = true;
+
+            auto src_url = make_shared<http::url>("http://test.opendap.org/opendap");
+            cache->prefetch(src_url);
+            CPPUNIT_ASSERT(cache->d_prefetchers.size() == 1);
+            CPPUNIT_ASSERT(!cache->is_prefetch_needed(src_url));
+
+            // Either waits for the prefetch thread or finds its result in the cache.
+            auto result_url = cache->get_effective_url(src_url);
+            DBG(cerr << prolog << "result_url: " << result_url->str() << endl);
+            CPPUNIT_ASSERT(result_url->str() == "http://test.opendap.org/opendap/");
+            CPPUNIT_ASSERT(cache->size() == 1);
+
+            cache->join_prefetchers();
+            CPPUNIT_ASSERT(cache->d_prefetchers.empty());
+            cache->d_prefetch_enabled = false;
+        }
+        catch (const BESError &be) {
+            cache->join_prefetchers();
+            cache->d_prefetch_enabled = false;
+            stringstream msg;
+            msg << prolog << "ERROR! Caught BESError. Message: " << be.get_message() << endl;
+            CPPUNIT_FAIL(msg.str());
+        }
+        DBG(cerr << prolog << "END" << endl);
+    }
+
 /* TESTS END */
 /*##################################################################################################*/
 
@@ -418,6 +638,11 @@ CPPUNIT_TEST_SUITE(EffectiveUrlCacheTest);
         CPPUNIT_TEST(euc_ghrc_tea_url_test);
         CPPUNIT_TEST(euc_harmony_url_test);
         CPPUNIT_TEST(trusted_url_test_01);
+        CPPUNIT_TEST(refresh_time_test);
+        CPPUNIT_TEST(single_flight_test);
+        CPPUNIT_TEST(single_flight_error_test);
+        CPPUNIT_TEST(prefetch_needed_test);
+        CPPUNIT_TEST(prefetch_test);
 
     CPPUNIT_TEST_SUITE_END();
 };
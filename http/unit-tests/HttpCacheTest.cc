@@ -0,0 +1,422 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BESInternalError.h"
+#include "BESUtil.h"
+#include "TheBESKeys.h"
+
+#include "CurlUtils.h"
+#include "HttpCache.h"
+#include "HttpNames.h"
+
+#include "test_config.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+
+#define prolog std::string("HttpCacheTest::").append(__func__).append("() - ")
+
+namespace http {
+
+class HttpCacheTest : public CppUnit::TestFixture {
+
+    using Entry = HttpCache::Entry;
+
+    const string cache_dir = string(TEST_BUILD_DIR) + "/http-object-cache";
+    const string data_url = "https://data.test/granule.h5";
+
+    // Stands in for the server and the caller's buffer. Each fetch() answers
+    // with the next of 'responses' and records the request headers.
+    class MockTarget : public HttpCache::Target {
+    public:
+        struct Response {
+            long code;
+            vector<string> headers;
+            string body;
+        };
+
+        vector<Response> responses;
+        vector<vector<string>> requests;
+        string body;
+        bool fail_load = false;
+
+        explicit MockTarget(vector<Response> r = {}) : responses(std::move(r)) {}
+
+        long fetch(curl_slist *http_request_headers, vector<string> *http_response_headers) override {
+            vector<string> sent;
+            for (auto header = http_request_headers; header; header = header->next)
+                sent.emplace_back(header->data);
+            curl_slist_free_all(http_request_headers);
+            requests.push_back(sent);
+
+            if (requests.size() > responses.size())
+                throw BESInternalError("Unexpected request", __FILE__, __LINE__);
+            const Response &response = responses.at(requests.size() - 1);
+            if (http_response_headers)
+                http_response_headers->insert(http_response_headers->end(), response.headers.begin(),
+                                              response.headers.end());
+            body = response.code == 304 ? "" : response.body;
+            return response.code;
+        }
+
+        bool load(int cache_fd) override {
+            if (fail_load)
+                return false;
+            body.clear();
+            char buf[1024];
+            ssize_t n;
+            while ((n = read(cache_fd, buf, sizeof(buf))) > 0)
+                body.append(buf, n);
+            return n == 0;
+        }
+
+        bool store(int cache_fd) override {
+            return write(cache_fd, body.data(), body.size()) == static_cast<ssize_t>(body.size());
+        }
+
+        unsigned long long size() const override { return body.size(); }
+
+        // True if the last request carried 'header'
+        bool sent(const string &header) const {
+            const auto &last = requests.back();
+            return find(last.begin(), last.end(), header) != last.end();
+        }
+    };
+
+    unique_ptr<HttpCache> d_cache;
+
+    static bool parse(const vector<string> &headers, Entry &entry, bool keyed_by_user = false,
+                      unsigned long default_max_age = 0) {
+        return HttpCache::parse_response_headers(headers, keyed_by_user, default_max_age, entry);
+    }
+
+    long get(MockTarget &target, curl_slist *http_request_headers = nullptr) {
+        return d_cache->get_resource(data_url, http_request_headers, nullptr, target);
+    }
+
+    // Make an entry stale without waiting for it to expire
+    void expire(curl_slist *http_request_headers = nullptr) {
+        const string key = HttpCache::make_key(data_url, http_request_headers);
+        Entry entry;
+        CPPUNIT_ASSERT(d_cache->read_entry(key, entry));
+        entry.expires = time(nullptr) - 1;
+        d_cache->write_entry(key, entry);
+    }
+
+public:
+    HttpCacheTest() = default;
+    ~HttpCacheTest() override = default;
+
+    void setUp() override {
+        TheBESKeys::ConfigFile = BESUtil::assemblePath(TEST_BUILD_DIR, "bes.conf");
+        CPPUNIT_ASSERT(system(("rm -rf " + cache_dir).c_str()) == 0);
+        TheBESKeys::TheKeys()->set_key(HTTP_OBJECT_CACHE_DIR_KEY, cache_dir);
+        TheBESKeys::TheKeys()->set_key(HTTP_OBJECT_CACHE_DEFAULT_MAX_AGE_KEY, "0");
+        d_cache.reset(new HttpCache());
+        CPPUNIT_ASSERT(d_cache->is_enabled());
+    }
+
+    void tearDown() override {
+        d_cache.reset();
+        TheBESKeys::TheKeys()->set_key(HTTP_OBJECT_CACHE_DIR_KEY, "");
+        CPPUNIT_ASSERT(system(("rm -rf " + cache_dir).c_str()) == 0);
+    }
+
+/*##################################################################################################*/
+/* TESTS BEGIN */
+
+    void validators_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"Content-Type: text/xml", "ETag:  \"abc123\" ",
+                              "Last-Modified: Wed, 21 Oct 2015 07:28:00 GMT"}, entry));
+        CPPUNIT_ASSERT_EQUAL(string("\"abc123\""), entry.etag);
+        CPPUNIT_ASSERT_EQUAL(string("Wed, 21 Oct 2015 07:28:00 GMT"), entry.last_modified);
+        CPPUNIT_ASSERT(entry.expires <= time(nullptr));
+    }
+
+    void no_validators_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(!parse({"Content-Type: text/xml"}, entry));
+        CPPUNIT_ASSERT(parse({"Content-Type: text/xml"}, entry, false, 60));
+        CPPUNIT_ASSERT(entry.expires > time(nullptr));
+    }
+
+    void max_age_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"Cache-Control: public, max-age=3600"}, entry));
+        CPPUNIT_ASSERT(entry.expires > time(nullptr) + 3000);
+    }
+
+    void s_maxage_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"Cache-Control: max-age=3600, s-maxage=10", "ETag: \"x\""}, entry));
+        CPPUNIT_ASSERT(entry.expires <= time(nullptr) + 10);
+    }
+
+    void no_cache_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"Cache-Control: no-cache, max-age=3600", "ETag: \"x\""}, entry));
+        CPPUNIT_ASSERT(entry.expires <= time(nullptr));
+    }
+
+    void no_store_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(!parse({"Cache-Control: no-store", "ETag: \"x\""}, entry));
+    }
+
+    void private_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(!parse({"cache-control: private, max-age=60"}, entry));
+        CPPUNIT_ASSERT(parse({"cache-control: private, max-age=60"}, entry, true));
+    }
+
+    void expires_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"Expires: Thu, 01 Jan 2099 00:00:00 GMT"}, entry));
+        CPPUNIT_ASSERT(entry.expires > time(nullptr));
+        CPPUNIT_ASSERT(!parse({"Expires: Thu, 01 Jan 1998 00:00:00 GMT"}, entry));
+    }
+
+    void last_header_wins_test() {
+        Entry entry;
+        CPPUNIT_ASSERT(parse({"ETag: \"redirect\"", "Location: https://s3/x", "ETag: \"final\""}, entry));
+        CPPUNIT_ASSERT_EQUAL(string("\"final\""), entry.etag);
+    }
+
+    void key_test() {
+        auto k1 = HttpCache::make_key("https://cmr/granules?x=1", nullptr);
+        CPPUNIT_ASSERT_EQUAL(k1, HttpCache::make_key("https://cmr/granules?x=1", nullptr));
+        CPPUNIT_ASSERT(k1 != HttpCache::make_key("https://cmr/granules?x=2", nullptr));
+
+        curl_slist *user1 = curl::append_http_header(nullptr, "Authorization", "Bearer one");
+        curl_slist *user2 = curl::append_http_header(nullptr, "Authorization", "Bearer two");
+        auto k2 = HttpCache::make_key("https://cmr/granules?x=1", user1);
+        auto k3 = HttpCache::make_key("https://cmr/granules?x=1", user2);
+        curl_slist_free_all(user1);
+        curl_slist_free_all(user2);
+
+        CPPUNIT_ASSERT(k1 != k2);
+        CPPUNIT_ASSERT(k2 != k3);
+    }
+
+    // The get_resource() flow
+
+    void disabled_test() {
+        d_cache.reset();
+        TheBESKeys::TheKeys()->set_key(HTTP_OBJECT_CACHE_DIR_KEY, "");
+        d_cache.reset(new HttpCache());
+        CPPUNIT_ASSERT(!d_cache->is_enabled());
+
+        MockTarget target({{200, {"Cache-Control: max-age=3600"}, "one"}, {200, {}, "two"}});
+        CPPUNIT_ASSERT_EQUAL(200L, get(target));
+        CPPUNIT_ASSERT_EQUAL(200L, get(target));
+        CPPUNIT_ASSERT_EQUAL(string("two"), target.body);
+        CPPUNIT_ASSERT_EQUAL((size_t)2, target.requests.size());
+    }
+
+    void fresh_hit_test() {
+        MockTarget first({{200, {"Cache-Control: max-age=3600", "ETag: \"v1\""}, "granule data"}});
+        CPPUNIT_ASSERT_EQUAL(200L, get(first));
+        CPPUNIT_ASSERT_EQUAL(string("granule data"), first.body);
+        CPPUNIT_ASSERT_EQUAL(1ULL, d_cache->get_misses());
+
+        // No request is made
+        MockTarget second;
+        CPPUNIT_ASSERT_EQUAL(200L, get(second));
+        CPPUNIT_ASSERT_EQUAL(string("granule data"), second.body);
+        CPPUNIT_ASSERT(second.requests.empty());
+        CPPUNIT_ASSERT_EQUAL(1ULL, d_cache->get_hits());
+        CPPUNIT_ASSERT_EQUAL(12ULL, d_cache->get_bytes_saved());
+        CPPUNIT_ASSERT_EQUAL(0.5, d_cache->get_hit_ratio());
+    }
+
+    // The request headers are part of the key
+    void fresh_hit_other_user_test() {
+        MockTarget first({{200, {"Cache-Control: private, max-age=3600"}, "user one"}});
+        get(first, curl::append_http_header(nullptr, "Authorization", "Bearer one"));
+
+        MockTarget second({{200, {"Cache-Control: private, max-age=3600"}, "user two"}});
+        get(second, curl::append_http_header(nullptr, "Authorization", "Bearer two"));
+        CPPUNIT_ASSERT_EQUAL(string("user two"), second.body);
+        CPPUNIT_ASSERT_EQUAL((size_t)1, second.requests.size());
+
+        MockTarget third;
+        get(third, curl::append_http_header(nullptr, "Authorization", "Bearer one"));
+        CPPUNIT_ASSERT_EQUAL(string("user one"), third.body);
+    }
+
+    void revalidation_test() {
+        MockTarget first({{200, {"ETag: \"v1\"", "Last-Modified: Wed, 21 Oct 2015 07:28:00 GMT"}, "granule data"}});
+        get(first);
+
+        // The entry is stale at once (no max-age), so it is revalidated
+        MockTarget second({{304, {"Cache-Control: max-age=3600"}, ""}});
+        CPPUNIT_ASSERT_EQUAL(200L, get(second));
+        CPPUNIT_ASSERT_EQUAL(string("granule data"), second.body);
+        CPPUNIT_ASSERT(second.sent("If-None-Match: \"v1\""));
+        CPPUNIT_ASSERT(second.sent("If-Modified-Since: Wed, 21 Oct 2015 07:28:00 GMT"));
+        CPPUNIT_ASSERT_EQUAL(1ULL, d_cache->get_revalidations());
+        CPPUNIT_ASSERT_EQUAL(12ULL, d_cache->get_bytes_saved());
+
+        // The 304 made the entry fresh
+        MockTarget third;
+        CPPUNIT_ASSERT_EQUAL(200L, get(third));
+        CPPUNIT_ASSERT_EQUAL(string("granule data"), third.body);
+        CPPUNIT_ASSERT_EQUAL(1ULL, d_cache->get_hits());
+    }
+
+    void changed_entry_test() {
+        MockTarget first({{200, {"ETag: \"v1\"", "Cache-Control: max-age=3600"}, "old data"}});
+        get(first);
+        expire();
+
+        MockTarget second({{200, {"ETag: \"v2\"", "Cache-Control: max-age=3600"}, "new data, longer"}});
+        CPPUNIT_ASSERT_EQUAL(200L, get(second));
+        CPPUNIT_ASSERT(second.sent("If-None-Match: \"v1\""));
+        CPPUNIT_ASSERT_EQUAL(string("new data, longer"), second.body);
+        CPPUNIT_ASSERT_EQUAL(2ULL, d_cache->get_misses());
+
+        // The new body and validator replaced the old ones
+        MockTarget third;
+        get(third);
+        CPPUNIT_ASSERT_EQUAL(string("new data, longer"), third.body);
+
+        expire();
+        MockTarget fourth({{304, {}, ""}});
+        get(fourth);
+        CPPUNIT_ASSERT(fourth.sent("If-None-Match: \"v2\""));
+        CPPUNIT_ASSERT_EQUAL(string("new data, longer"), fourth.body);
+    }
+
+    // A response that cannot be cached removes the old entry
+    void not_cacheable_test() {
+        MockTarget first({{200, {"ETag: \"v1\""}, "data"}});
+        get(first);
+
+        MockTarget second({{200, {"Cache-Control: no-store"}, "secret"}, {200, {}, "other"}});
+        get(second);
+        CPPUNIT_ASSERT_EQUAL(string("secret"), second.body);
+        get(second);
+        CPPUNIT_ASSERT(!second.sent("If-None-Match: \"v1\""));
+        CPPUNIT_ASSERT_EQUAL(string("other"), second.body);
+
+        MockTarget error({{404, {"Cache-Control: max-age=3600"}, "Not Found"}, {200, {}, "found"}});
+        CPPUNIT_ASSERT_EQUAL(404L, get(error));
+        CPPUNIT_ASSERT_EQUAL(200L, get(error));
+        CPPUNIT_ASSERT_EQUAL(string("found"), error.body);
+    }
+
+    // When the cached body cannot be loaded, it is fetched again
+    void load_failure_test() {
+        MockTarget first({{200, {"Cache-Control: max-age=3600"}, "data"}});
+        get(first);
+
+        MockTarget second({{200, {"Cache-Control: max-age=3600"}, "data"}});
+        second.fail_load = true;
+        CPPUNIT_ASSERT_EQUAL(200L, get(second));
+        CPPUNIT_ASSERT_EQUAL((size_t)1, second.requests.size());
+        CPPUNIT_ASSERT_EQUAL(string("data"), second.body);
+        CPPUNIT_ASSERT_EQUAL(0ULL, d_cache->get_hits());
+    }
+
+    // Many concurrent requests for a few URLs: each gets its own URL's body,
+    // and every request is counted once.
+    void load_test() {
+        const int threads = 8;
+        const int requests = 50;
+        vector<int> failures(threads, 0);
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([this, t, &failures]() {
+                for (int r = 0; r < requests; ++r) {
+                    const string url = "https://data.test/granule-" + to_string(r % 5) + ".h5";
+                    const string expected = "body of " + url;
+                    MockTarget target({{200, {"ETag: \"" + url + "\"", "Cache-Control: max-age=3600"}, expected},
+                                       {304, {"Cache-Control: max-age=3600"}, ""}});
+                    try {
+                        long code = d_cache->get_resource(url, nullptr, nullptr, target);
+                        if (code != 200 || target.body != expected)
+                            ++failures[t];
+                    }
+                    catch (...) {
+                        ++failures[t];
+                    }
+                }
+            });
+        }
+        for (auto &w: workers)
+            w.join();
+
+        for (int t = 0; t < threads; ++t)
+            CPPUNIT_ASSERT_EQUAL(0, failures[t]);
+        CPPUNIT_ASSERT_EQUAL((unsigned long long)threads * requests,
+                             d_cache->get_hits() + d_cache->get_revalidations() + d_cache->get_misses());
+        CPPUNIT_ASSERT(d_cache->get_hits() > 0);
+    }
+
+/* TESTS END */
+/*##################################################################################################*/
+
+CPPUNIT_TEST_SUITE(HttpCacheTest);
+
+        CPPUNIT_TEST(validators_test);
+        CPPUNIT_TEST(no_validators_test);
+        CPPUNIT_TEST(max_age_test);
+        CPPUNIT_TEST(s_maxage_test);
+        CPPUNIT_TEST(no_cache_test);
+        CPPUNIT_TEST(no_store_test);
+        CPPUNIT_TEST(private_test);
+        CPPUNIT_TEST(expires_test);
+        CPPUNIT_TEST(last_header_wins_test);
+        CPPUNIT_TEST(key_test);
+
+        CPPUNIT_TEST(disabled_test);
+        CPPUNIT_TEST(fresh_hit_test);
+        CPPUNIT_TEST(fresh_hit_other_user_test);
+        CPPUNIT_TEST(revalidation_test);
+        CPPUNIT_TEST(changed_entry_test);
+        CPPUNIT_TEST(not_cacheable_test);
+        CPPUNIT_TEST(load_failure_test);
+        CPPUNIT_TEST(load_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HttpCacheTest);
+
+} // namespace http
+
+int main(int argc, char *argv[]) {
+    return bes_run_tests<http::HttpCacheTest>(argc, argv, "cerr,bes,http") ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <memory>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+#include "BESInternalError.h"
+
+#include "RangeReadFile.h"
+
+#include "test_config.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+
+#define prolog std::string("RangeReadFileTest::").append(__func__).append("() - ")
+
+namespace http {
+
+/// A RangeReadFile that reads from a vector instead of a URL
+class MockRangeReadFile : public RangeReadFile {
+public:
+    vector<char> d_data;
+    vector<pair<unsigned long long, unsigned long long>> d_gets;
+
+    MockRangeReadFile(unsigned long long data_size, unsigned long long block_size, unsigned int max_blocks,
+                      unsigned int read_ahead)
+            : RangeReadFile("http://mock/data.h5", block_size, max_blocks, read_ahead), d_data(data_size) {
+        for (unsigned long long i = 0; i < data_size; ++i)
+            d_data[i] = static_cast<char>(i % 251);
+    }
+
+protected:
+    unsigned long long get_range(unsigned long long offset, unsigned long long size, char *buf,
+                                 unsigned long long *resource_size) override {
+        d_gets.emplace_back(offset, size);
+        if (resource_size)
+            *resource_size = d_data.size();
+        unsigned long long bytes = offset >= d_data.size() ? 0 : min(size, d_data.size() - offset);
+        memcpy(buf, d_data.data() + offset, bytes);
+        return bytes;
+    }
+};
+
+class RangeReadFileTest : public CppUnit::TestFixture {
+
+    bool same_bytes(const MockRangeReadFile &file, const vector<char> &buf, unsigned long long offset) {
+        return memcmp(buf.data(), file.d_data.data() + offset, buf.size()) == 0;
+    }
+
+public:
+    RangeReadFileTest() = default;
+    ~RangeReadFileTest() override = default;
+
+/*##################################################################################################*/
+/* TESTS BEGIN */
+
+    void open_test() {
+        MockRangeReadFile file(1000, 100, 4, 0);
+        file.open();
+        CPPUNIT_ASSERT_EQUAL(1000ULL, file.size());
+        CPPUNIT_ASSERT_EQUAL(1UL, file.get_requests());
+        CPPUNIT_ASSERT_EQUAL(100ULL, file.get_bytes_transferred());
+    }
+
+    void small_file_test() {
+        MockRangeReadFile file(40, 100, 4, 0);
+        file.open();
+        CPPUNIT_ASSERT_EQUAL(40ULL, file.size());
+
+        vector<char> buf(40);
+        file.read(buf.data(), buf.size(), 0);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 0));
+        CPPUNIT_ASSERT_EQUAL(1UL, file.get_requests());
+    }
+
+    void cached_block_test() {
+        MockRangeReadFile file(1000, 100, 4, 0);
+        file.open();
+
+        vector<char> buf(50);
+        file.read(buf.data(), buf.size(), 25);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 25));
+        CPPUNIT_ASSERT_EQUAL(1UL, file.get_requests());
+    }
+
+    void run_test() {
+        MockRangeReadFile file(1000, 100, 8, 0);
+        file.open();
+
+        // Blocks 3 to 5 are read with one GET
+        vector<char> buf(250);
+        file.read(buf.data(), buf.size(), 320);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 320));
+        CPPUNIT_ASSERT_EQUAL(2UL, file.get_requests());
+        CPPUNIT_ASSERT_EQUAL(300ULL, file.d_gets.back().first);
+        CPPUNIT_ASSERT_EQUAL(300ULL, file.d_gets.back().second);
+    }
+
+    void read_ahead_test() {
+        MockRangeReadFile file(1000, 100, 8, 2);
+        file.open();
+
+        // Sequential after block 0: blocks 1, 2 and 3 are read
+        vector<char> buf(100);
+        file.read(buf.data(), buf.size(), 100);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 100));
+        CPPUNIT_ASSERT_EQUAL(300ULL, file.d_gets.back().second);
+
+        file.read(buf.data(), buf.size(), 200);
+        file.read(buf.data(), buf.size(), 300);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 300));
+        CPPUNIT_ASSERT_EQUAL(2UL, file.get_requests());
+    }
+
+    void last_block_test() {
+        MockRangeReadFile file(1010, 100, 4, 4);
+        file.open();
+
+        vector<char> buf(30);
+        file.read(buf.data(), buf.size(), 980);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 980));
+        CPPUNIT_ASSERT_EQUAL(210ULL, file.get_bytes_transferred());
+    }
+
+    void eviction_test() {
+        MockRangeReadFile file(1000, 100, 2, 0);
+        file.open();
+
+        vector<char> buf(10);
+        file.read(buf.data(), buf.size(), 500);
+        file.read(buf.data(), buf.size(), 700);     // Evicts block 0
+        file.read(buf.data(), buf.size(), 0);
+        CPPUNIT_ASSERT(same_bytes(file, buf, 0));
+        CPPUNIT_ASSERT_EQUAL(4UL, file.get_requests());
+    }
+
+    void read_past_eof_test() {
+        MockRangeReadFile file(1000, 100, 4, 0);
+        file.open();
+
+        vector<char> buf(20);
+        CPPUNIT_ASSERT_THROW(file.read(buf.data(), buf.size(), 990), BESInternalError);
+    }
+
+    void not_open_test() {
+        MockRangeReadFile file(1000, 100, 4, 0);
+        vector<char> buf(20);
+        CPPUNIT_ASSERT_THROW(file.read(buf.data(), buf.size(), 0), BESInternalError);
+    }
+
+    void registry_test() {
+        auto file = make_shared<MockRangeReadFile>(1000, 100, 4, 0);
+        RangeReadFile::register_file("range_read_test#data.h5", file);
+        CPPUNIT_ASSERT(RangeReadFile::find("range_read_test#data.h5") == file);
+        CPPUNIT_ASSERT(!RangeReadFile::find("data.h5"));
+
+        RangeReadFile::unregister_file("range_read_test#data.h5");
+        CPPUNIT_ASSERT(!RangeReadFile::find("range_read_test#data.h5"));
+    }
+
+/* TESTS END */
+/*##################################################################################################*/
+
+CPPUNIT_TEST_SUITE(RangeReadFileTest);
+
+        CPPUNIT_TEST(open_test);
+        CPPUNIT_TEST(small_file_test);
+        CPPUNIT_TEST(cached_block_test);
+        CPPUNIT_TEST(run_test);
+        CPPUNIT_TEST(read_ahead_test);
+        CPPUNIT_TEST(last_block_test);
+        CPPUNIT_TEST(eviction_test);
+        CPPUNIT_TEST(read_past_eof_test);
+        CPPUNIT_TEST(not_open_test);
+        CPPUNIT_TEST(registry_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RangeReadFileTest);
+
+} // namespace http
+
+int main(int argc, char *argv[]) {
+    return bes_run_tests<http::RangeReadFileTest>(argc, argv, "cerr,bes,http") ? 0 : 1;
+}
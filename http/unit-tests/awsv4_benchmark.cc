@@ -0,0 +1,83 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES http package, part of the Hyrax data server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Time AWS V4 signing of GET requests, the way the DMR++ handler signs its
+// chunk requests. Not run by 'make check'; run it by hand:
+//
+//   ./awsv4_benchmark [iterations]
+
+#include "config.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+#include "awsv4.h"
+
+using namespace std;
+
+static const string host = "example-bucket.s3.us-west-2.amazonaws.com";
+static const string key_id = "AKIDEXAMPLE";
+static const string secret = "wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY";
+static const string region = "us-west-2";
+
+template<typename F>
+static void time_it(const string &name, unsigned long iterations, F f) {
+    auto start = chrono::steady_clock::now();
+    for (unsigned long i = 0; i < iterations; ++i)
+        f(i);
+    chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+    cout << name << ": " << elapsed.count() / iterations << " us/request" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned long iterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 100000;
+    const time_t now = time(nullptr);
+
+    // A new URL for every request: the canonical request prefix is built
+    // each time, but the signing key is cached.
+    time_it("new URL", iterations, [now](unsigned long i) {
+        AWSV4::compute_awsv4_signature("/granules/file_" + to_string(i) + ".h5", "", host, now + i, key_id, secret,
+                                       region, "s3");
+    });
+
+    // Chunks of one file, a new second for each: one SHA256 and one HMAC.
+    time_it("same URL, new second", iterations, [now](unsigned long i) {
+        AWSV4::compute_awsv4_signature("/granules/file.h5", "", host, now + i, key_id, secret, region, "s3");
+    });
+
+    // Chunks of one file, all in the same second: the signature is reused.
+    time_it("same URL, same second", iterations, [now](unsigned long) {
+        AWSV4::compute_awsv4_signature("/granules/file.h5", "", host, now, key_id, secret, region, "s3");
+    });
+
+    // The full key derivation and signature, as every request did before
+    // the signing key was cached.
+    time_it("uncached key derivation", iterations, [now](unsigned long i) {
+        AWSV4::calculate_signature(now, secret + to_string(i), region, "s3", "string to sign");
+    });
+
+    return 0;
+}
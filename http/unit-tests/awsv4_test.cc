@@ -25,6 +25,8 @@
 #include "config.h"
 
 #include <cstring>
+#include <iomanip>
+#include <sstream>
 
 #include "modules/common/run_tests_cppunit.h"
 
@@ -216,9 +218,85 @@ public:
         CPPUNIT_ASSERT(AWSV4::join(in, "") == "abc");
     }
 
+    static string to_hex(const unsigned char *bytes, size_t length) {
+        ostringstream oss;
+        for (size_t i = 0; i < length; ++i)
+            oss << hex << setw(2) << setfill('0') << (int)bytes[i];
+        return oss.str();
+    }
+
+    // The kSigning example from the AWS Signature Version 4 documentation
+    void signing_key_test() {
+        const time_t feb_15_2012 = 1329264000;
+        unsigned char key[SHA256_DIGEST_LENGTH];
+        AWSV4::signing_key(feb_15_2012, aws_secret_key, "us-east-1", "iam", key);
+        CPPUNIT_ASSERT_EQUAL(string("f4780e2d9f65fa895f9c67b32ce1baf0b0d8a43505a000a1a9e090d414db404d"),
+                             to_hex(key, SHA256_DIGEST_LENGTH));
+
+        // The second call is answered from the cache
+        const size_t cached = AWSV4::signing_key_cache_size();
+        unsigned char again[SHA256_DIGEST_LENGTH];
+        AWSV4::signing_key(feb_15_2012, aws_secret_key, "us-east-1", "iam", again);
+        CPPUNIT_ASSERT_EQUAL(to_hex(key, SHA256_DIGEST_LENGTH), to_hex(again, SHA256_DIGEST_LENGTH));
+        CPPUNIT_ASSERT_EQUAL(cached, AWSV4::signing_key_cache_size());
+
+        // A different secret makes a different key
+        AWSV4::signing_key(feb_15_2012, aws_secret_key + "x", "us-east-1", "iam", again);
+        CPPUNIT_ASSERT(to_hex(key, SHA256_DIGEST_LENGTH) != to_hex(again, SHA256_DIGEST_LENGTH));
+    }
+
+    void signing_key_cache_cap_test() {
+        unsigned char key[SHA256_DIGEST_LENGTH];
+        for (size_t i = 0; i < 2 * AWSV4::max_signing_keys + 1; ++i) {
+            AWSV4::signing_key(request_time, aws_secret_key + to_string(i), region, serviceName, key);
+            CPPUNIT_ASSERT(AWSV4::signing_key_cache_size() <= AWSV4::max_signing_keys);
+        }
+        CPPUNIT_ASSERT(AWSV4::signing_key_cache_size() > 0);
+
+        // Keys computed after the cache was emptied are the same as before
+        unsigned char first[SHA256_DIGEST_LENGTH];
+        AWSV4::signing_key(request_time, aws_secret_key + "0", region, serviceName, first);
+        for (size_t i = 1; i <= AWSV4::max_signing_keys; ++i)
+            AWSV4::signing_key(request_time, aws_secret_key + to_string(i), region, serviceName, key);
+        AWSV4::signing_key(request_time, aws_secret_key + "0", region, serviceName, key);
+        CPPUNIT_ASSERT_EQUAL(to_hex(first, SHA256_DIGEST_LENGTH), to_hex(key, SHA256_DIGEST_LENGTH));
+    }
+
+    void request_signer_cache_test() {
+        auto signer = AWSV4::get_request_signer("/", "", "example.amazonaws.com", aws_key_id, aws_secret_key,
+                                                region, serviceName);
+        auto same = AWSV4::get_request_signer("/", "", "example.amazonaws.com", aws_key_id, aws_secret_key,
+                                              region, serviceName);
+        CPPUNIT_ASSERT(signer == same);
+
+        auto other = AWSV4::get_request_signer("/", "", "example.amazonaws.com", aws_key_id, aws_secret_key + "x",
+                                               region, serviceName);
+        CPPUNIT_ASSERT(signer != other);
+        CPPUNIT_ASSERT(signer->authorization_header(request_time) != other->authorization_header(request_time));
+
+        // The header is the same whether or not the signer was cached
+        string auth_header_baseline;
+        load_test_baselines("get-vanilla", auth_header_baseline);
+        CPPUNIT_ASSERT_EQUAL(auth_header_baseline, same->authorization_header(request_time));
+        CPPUNIT_ASSERT_EQUAL(auth_header_baseline, same->authorization_header(request_time));
+    }
+
+    void request_signer_cache_cap_test() {
+        for (size_t i = 0; i < AWSV4::max_request_signers + 1; ++i) {
+            AWSV4::get_request_signer("/object-" + to_string(i), "", "example.amazonaws.com", aws_key_id,
+                                      aws_secret_key, region, serviceName);
+            CPPUNIT_ASSERT(AWSV4::request_signer_cache_size() <= AWSV4::max_request_signers);
+        }
+        CPPUNIT_ASSERT(AWSV4::request_signer_cache_size() > 0);
+    }
+
     CPPUNIT_TEST_SUITE(awsv4_test);
 
     CPPUNIT_TEST(join_test);
+    CPPUNIT_TEST(signing_key_test);
+    CPPUNIT_TEST(signing_key_cache_cap_test);
+    CPPUNIT_TEST(request_signer_cache_test);
+    CPPUNIT_TEST(request_signer_cache_cap_test);
 
     CPPUNIT_TEST(get_unreserved);
 
@@ -206,15 +206,12 @@ const vector<string> &url::query_parameter_values(const std::string &key) const
 }
 
 /**
- * @return True if the URL appears within the REFRESH_THRESHOLD of the expires time
- * read from one of CLOUDFRONT_EXPIRES_HEADER_KEY or AMS_EXPIRES_HEADER_KEY.
+ * @return The time this URL expires, read from one of CLOUDFRONT_EXPIRES_HEADER_KEY
+ * or AMS_EXPIRES_HEADER_KEY. If neither is present, the ingest time plus
+ * HTTP_EFFECTIVE_URL_DEFAULT_EXPIRES_INTERVAL.
  */
-bool url::is_expired()
+std::time_t url::expires_time()
 {
-    bool stale;
-    std::time_t now = system_clock::to_time_t(system_clock::now());
-
-    BESDEBUG(MODULE, prolog << "now: " << now << endl);
     // We set the expiration time to the default, in case other avenues don't work out so well.
     std::time_t expires_time = ingest_time() + HTTP_EFFECTIVE_URL_DEFAULT_EXPIRES_INTERVAL;
 
@@ -277,6 +274,23 @@ bool url::is_expired()
                                 " (expires_time: " << expires_time << ")" << endl);
     }
 
+    return expires_time;
+}
+
+/**
+ * @return True if the URL appears within the REFRESH_THRESHOLD of the expires time
+ * read from one of CLOUDFRONT_EXPIRES_HEADER_KEY or AMS_EXPIRES_HEADER_KEY.
+ */
+bool url::is_expired()
+{
+    bool stale;
+    std::time_t now = system_clock::to_time_t(system_clock::now());
+    BESDEBUG(MODULE, prolog << "now: " << now << endl);
+
+    // Call this class' version explicitly; EffectiveUrl overrides expires_time() and
+    // handles Cache-Control: max-age itself.
+    std::time_t expires_time = url::expires_time();
+
     std::time_t remaining = expires_time - now;
     BESDEBUG(MODULE, prolog << "expires_time: " << expires_time <<
                             "  remaining: " << remaining <<
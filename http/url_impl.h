@@ -122,6 +122,7 @@ public:
     virtual size_t query_parameter_values_size(const std::string &key) const;
     virtual const std::vector<std::string> &query_parameter_values(const std::string &key) const;
 
+    virtual std::time_t expires_time();
     virtual bool is_expired();
     virtual bool is_trusted() const { return d_trusted; };
 
@@ -48,6 +48,7 @@ using namespace std;
 
 #include "AsciiArray.h"
 #include <libdap/util.h>
+#include "AsciiRowFormatter.h"
 #include "get_ascii.h"
 
 using namespace dap_asciival;
@@ -117,6 +118,16 @@ void AsciiArray::print_vector(ostream &strm, bool print_name)
         bt = this;
     }
 
+    // Arrays of numeric types are formatted directly from the Array's buffer.
+    if (AsciiRowFormatter::is_supported(bt)) {
+        AsciiRowFormatter formatter(bt, strm);
+        if (print_name)
+            formatter.append(dynamic_cast<AsciiOutput*>(this)->get_full_name() + ", ");
+
+        formatter.print_values(0, dimension_size_ll(dim_begin(), true));
+        return;
+    }
+
     if (print_name)
         strm << dynamic_cast<AsciiOutput*>(this)->get_full_name() << ", " ;
 
@@ -161,7 +172,11 @@ int AsciiArray::print_row(ostream &strm, int index, int number)
     // Added 'if (number > 0)' to support zero-length arrays. jhrg 2/2/16
     // Changed to >= 0 to catch the edge case where the rightmost dimension
     // is constrained to be just one element. jhrg 6/9/16 (See Hyrax-225)
-    if (number >= 0) {
+    if (number >= 0 && AsciiRowFormatter::is_supported(bt)) {
+        AsciiRowFormatter formatter(bt, strm, number + 1);
+        index = formatter.print_values(index, number + 1);
+    }
+    else if (number >= 0) {
         for (int i = 0; i < number; ++i) {
             BaseType *curr_var = basetype_to_asciitype(bt->var(index++));
             dynamic_cast<AsciiOutput &>(*curr_var).print_ascii(strm, false);
@@ -270,6 +285,15 @@ void AsciiArray::print_array(ostream &strm, bool /*print_name */ )
     // on the row.
     vector < int >state(dims - 1, 0);
 
+    Array *bt = dynamic_cast < Array * >(_redirect);
+    if (!bt)
+        bt = this;
+
+    if (AsciiRowFormatter::is_supported(bt)) {
+        print_array_rows(bt, strm, shape, rightmost_dim_size, state);
+        return;
+    }
+
     bool more_indices;
     int index = 0;
     do {
@@ -291,6 +315,40 @@ void AsciiArray::print_array(ostream &strm, bool /*print_name */ )
     DBG(cerr << "ExitingAsciiArray::print_array" << endl);
 }
 
+/** Print the rows of an N-dimensional array of numeric values. This builds
+    the same text as print_array() but formats the values directly from the
+    Array's buffer and writes the output in large blocks.
+
+    @param bt The Array that holds the values
+    @param strm Write to this stream
+    @param shape Size of each of the first N-1 dimensions
+    @param rightmost_dim_size Number of values on each row
+    @param state The indices of the first row to print */
+void AsciiArray::print_array_rows(Array *bt, ostream &strm, const vector<int> &shape, int rightmost_dim_size,
+                                  vector<int> &state)
+{
+    AsciiRowFormatter formatter(bt, strm);
+    const string name = dynamic_cast <AsciiOutput *>(this)->get_full_name();
+
+    bool more_indices;
+    int64_t index = 0;
+    do {
+        formatter.append(name);
+        for (vector<int>::size_type i = 0; i < state.size(); ++i) {
+            formatter.append("[");
+            formatter.append(state[i]);
+            formatter.append("]");
+        }
+        formatter.append(", ");
+
+        index = formatter.print_values(index, rightmost_dim_size);
+        more_indices = increment_state(&state, shape);
+        if (more_indices)
+            formatter.append("\n");
+
+    } while (more_indices);
+}
+
 void AsciiArray::print_complex_array(ostream &strm, bool /*print_name */ )
 {
     DBG(cerr << "Entering AsciiArray::print_complex_array" << endl);
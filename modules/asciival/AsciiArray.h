@@ -46,6 +46,8 @@ private:
 
     void print_vector(ostream &strm, bool print_name);
     void print_array(ostream &strm, bool print_name);
+    void print_array_rows(Array *bt, ostream &strm, const vector<int> &shape, int rightmost_dim_size,
+                          vector<int> &state);
     void print_complex_array(ostream &strm, bool print_name);
 
 public:
@@ -0,0 +1,255 @@
+
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of asciival, software which can return an ASCII
+// representation of the data read from a DAP server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include <libdap/Array.h>
+#include <libdap/InternalErr.h>
+#include <libdap/dods-datatypes.h>
+
+#include "AsciiRowFormatter.h"
+
+using namespace std;
+using namespace libdap;
+
+namespace dap_asciival {
+
+// These match the precision used by libdap's Float32::print_val() and
+// Float64::print_val(). A stream with the default float field formats
+// values the same way printf's %g does.
+const int float32_precision = 6;
+const int float64_precision = 15;
+
+// Large enough for any 64-bit integer or a %.15g double plus a separator.
+const int max_value_width = 32;
+
+// Write the decimal digits of 'v' so they end at 'end'; return the start.
+static inline char *unsigned_to_chars(char *end, uint64_t v)
+{
+    do {
+        *--end = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    return end;
+}
+
+static inline char *signed_to_chars(char *end, int64_t v)
+{
+    if (v >= 0)
+        return unsigned_to_chars(end, static_cast<uint64_t>(v));
+
+    char *start = unsigned_to_chars(end, 0 - static_cast<uint64_t>(v));
+    *--start = '-';
+    return start;
+}
+
+// Byte is printed as an unsigned int and Int8 as an int, so one overload
+// for each signedness covers all of the integer types.
+static inline char *integer_to_chars(char *end, dods_byte v) { return unsigned_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_uint16 v) { return unsigned_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_uint32 v) { return unsigned_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_uint64 v) { return unsigned_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_int8 v) { return signed_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_int16 v) { return signed_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_int32 v) { return signed_to_chars(end, v); }
+static inline char *integer_to_chars(char *end, dods_int64 v) { return signed_to_chars(end, v); }
+
+/**
+ * @param a Print values from this Array
+ * @param strm Write to this stream
+ * @param count The number of values that will be printed; used to size the
+ * block so that printing one short row does not allocate block_size bytes.
+ * If less than zero, the length of the Array is used.
+ */
+AsciiRowFormatter::AsciiRowFormatter(Array *a, ostream &strm, int64_t count)
+    : d_strm(strm), d_type(a->var()->type()), d_buf(a->get_buf()), d_length(a->length_ll())
+{
+    if (!is_supported(a))
+        throw InternalErr(__FILE__, __LINE__, "AsciiRowFormatter cannot print values of type " + a->var()->type_name());
+
+    if (count < 0)
+        count = d_length;
+    // Each value takes at most max_value_width + 2 (the ', ') bytes
+    const uint64_t needed = static_cast<uint64_t>(count) * (max_value_width + 2);
+    d_block.reserve(std::min<uint64_t>(needed, block_size) + 4 * max_value_width);
+}
+
+AsciiRowFormatter::~AsciiRowFormatter()
+{
+    flush();
+}
+
+/**
+ * @brief Can the values of this Array be printed using this class?
+ *
+ * @param a The Array
+ * @return True if the element type is a numeric type and the values are
+ * held in the Array's internal buffer, false otherwise.
+ */
+bool AsciiRowFormatter::is_supported(Array *a)
+{
+    if (!a || !a->var() || !a->get_buf())
+        return false;
+
+    switch (a->var()->type()) {
+    case dods_byte_c:
+    case dods_uint8_c:
+    case dods_int8_c:
+    case dods_int16_c:
+    case dods_uint16_c:
+    case dods_int32_c:
+    case dods_uint32_c:
+    case dods_int64_c:
+    case dods_uint64_c:
+    case dods_float32_c:
+    case dods_float64_c:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void AsciiRowFormatter::append(int i)
+{
+    char digits[max_value_width];
+    char *end = digits + sizeof(digits);
+    char *start = signed_to_chars(end, i);
+    d_block.append(start, end - start);
+}
+
+template<typename T>
+void AsciiRowFormatter::format_integers(int64_t index, int64_t count)
+{
+    const T *values = reinterpret_cast<const T *>(d_buf) + index;
+    char digits[max_value_width];
+    char *end = digits + sizeof(digits);
+
+    for (int64_t i = 0; i < count; ++i) {
+        char *start = integer_to_chars(end, values[i]);
+        if (i > 0) {
+            *--start = ' ';
+            *--start = ',';
+        }
+        d_block.append(start, end - start);
+        flush_if_full();
+    }
+}
+
+template<typename T>
+void AsciiRowFormatter::format_floats(int64_t index, int64_t count, int precision)
+{
+    const T *values = reinterpret_cast<const T *>(d_buf) + index;
+    char digits[max_value_width + 2];
+
+    for (int64_t i = 0; i < count; ++i) {
+        char *start = digits;
+        if (i > 0) {
+            *start++ = ',';
+            *start++ = ' ';
+        }
+        int n = snprintf(start, max_value_width, "%.*g", precision, static_cast<double>(values[i]));
+        d_block.append(digits, (start - digits) + n);
+        flush_if_full();
+    }
+}
+
+/**
+ * @brief Format 'count' values, separated by commas, starting at 'index'.
+ *
+ * Nothing is added before the first or after the last value.
+ *
+ * @param index Index of the first value in the Array's buffer.
+ * @param count Number of values to print.
+ * @return One past the last value printed (i.e., the index of the next
+ * row's first value).
+ */
+int64_t AsciiRowFormatter::print_values(int64_t index, int64_t count)
+{
+    if (count <= 0)
+        return index;
+
+    if (index < 0 || index + count > d_length) {
+        ostringstream oss;
+        oss << "Attempt to print values " << index << " to " << index + count - 1 << " of an array with "
+            << d_length << " elements.";
+        throw InternalErr(__FILE__, __LINE__, oss.str());
+    }
+
+    switch (d_type) {
+    case dods_byte_c:
+    case dods_uint8_c:
+        format_integers<dods_byte>(index, count);
+        break;
+    case dods_int8_c:
+        format_integers<dods_int8>(index, count);
+        break;
+    case dods_int16_c:
+        format_integers<dods_int16>(index, count);
+        break;
+    case dods_uint16_c:
+        format_integers<dods_uint16>(index, count);
+        break;
+    case dods_int32_c:
+        format_integers<dods_int32>(index, count);
+        break;
+    case dods_uint32_c:
+        format_integers<dods_uint32>(index, count);
+        break;
+    case dods_int64_c:
+        format_integers<dods_int64>(index, count);
+        break;
+    case dods_uint64_c:
+        format_integers<dods_uint64>(index, count);
+        break;
+    case dods_float32_c:
+        format_floats<dods_float32>(index, count, float32_precision);
+        break;
+    case dods_float64_c:
+        format_floats<dods_float64>(index, count, float64_precision);
+        break;
+    default:
+        throw InternalErr(__FILE__, __LINE__, "Unexpected type in AsciiRowFormatter::print_values().");
+    }
+
+    return index + count;
+}
+
+/// Write any buffered text to the output stream.
+void AsciiRowFormatter::flush()
+{
+    if (!d_block.empty()) {
+        d_strm.write(d_block.data(), d_block.size());
+        d_block.clear();
+    }
+}
+
+} // namespace dap_asciival
@@ -0,0 +1,102 @@
+
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of asciival, software which can return an ASCII
+// representation of the data read from a DAP server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _ascii_row_formatter_h
+#define _ascii_row_formatter_h 1
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <libdap/Type.h>
+
+namespace libdap {
+    class Array;
+}
+
+namespace dap_asciival {
+
+/**
+ * @brief Format the values of an Array of numeric types without per-element
+ * BaseType objects.
+ *
+ * The old code built a new BaseType for every element (Vector::var(i)),
+ * wrapped it in an Ascii* instance and then called the virtual print_val()
+ * which uses iostreams. This class walks the Vector's internal buffer
+ * directly, formats each value with a function chosen once per Array based
+ * on the element type and collects the text in a block that is written to
+ * the output stream only when it fills.
+ *
+ * The text is byte-for-byte the same as libdap's print_val(): Byte values
+ * are printed as unsigned integers, Float32 uses six significant digits and
+ * Float64 fifteen.
+ *
+ * Use is_supported() to test an Array before using this; strings, URLs,
+ * enums and constructor types are not handled here.
+ */
+class AsciiRowFormatter {
+private:
+    std::ostream &d_strm;
+    std::string d_block;
+
+    libdap::Type d_type;
+    const char *d_buf;
+    int64_t d_length;
+
+    template<typename T> void format_integers(int64_t index, int64_t count);
+    template<typename T> void format_floats(int64_t index, int64_t count, int precision);
+
+    void flush_if_full()
+    {
+        if (d_block.size() >= block_size)
+            flush();
+    }
+
+public:
+    /// Text is written to the stream in blocks of (about) this many bytes.
+    static const size_t block_size = 64 * 1024;
+
+    AsciiRowFormatter(libdap::Array *a, std::ostream &strm, int64_t count = -1);
+    virtual ~AsciiRowFormatter();
+
+    static bool is_supported(libdap::Array *a);
+
+    /// Add text (names, indices, separators) to the output block.
+    void append(const std::string &text)
+    {
+        d_block.append(text);
+        flush_if_full();
+    }
+
+    void append(int i);
+
+    int64_t print_values(int64_t index, int64_t count);
+
+    void flush();
+};
+
+} // namespace dap_asciival
+
+#endif // _ascii_row_formatter_h
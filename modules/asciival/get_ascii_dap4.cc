@@ -41,6 +41,7 @@
 #include <libdap/crc.h>
 #include <libdap/InternalErr.h>
 
+#include "AsciiRowFormatter.h"
 #include "get_ascii_dap4.h"
 
 namespace dap_asciival {
@@ -66,6 +67,16 @@ static void print_val_by_rows(D4Sequence *seq, ostream &strm, Crc32 &checksum);
  */
 static void print_array_vector(Array *a, ostream &strm, bool print_name)
 {
+    // Arrays of numeric types are formatted directly from the Array's buffer.
+    if (AsciiRowFormatter::is_supported(a)) {
+        AsciiRowFormatter formatter(a, strm);
+        if (print_name)
+            formatter.append(a->FQN() + ", ");
+
+        formatter.print_values(0, a->dimension_size_ll(a->dim_begin(), true));
+        return;
+    }
+
     if (print_name)
         strm << a->FQN() << ", " ;
 
@@ -164,6 +175,40 @@ static int get_nth_dim_size(Array *a, size_t n)
     return a->dimension_size(a->dim_begin() + n, true);
 }
 
+/**
+ * Print the rows of an N-dimensional array of numeric values. This builds
+ * the same text as print_ndim_array() but formats the values directly from
+ * the Array's buffer and writes the output in large blocks.
+ */
+static void print_ndim_array_rows(Array *a, ostream &strm, const vector<int> &shape, int rightmost_dim_size,
+                                  vector<int> &state)
+{
+    AsciiRowFormatter formatter(a, strm);
+    const string name = a->FQN();
+
+    bool more_indices;
+    int64_t index = 0;
+    do {
+        formatter.append(name);
+        for (vector<int>::size_type i = 0; i < state.size(); ++i) {
+            formatter.append("[");
+            formatter.append(state[i]);
+            formatter.append("]");
+        }
+        formatter.append(", ");
+
+        // print_array_row() prints nothing for a row with a single value
+        // (number == 0); keep that behavior.
+        if (rightmost_dim_size > 1)
+            index = formatter.print_values(index, rightmost_dim_size);
+
+        more_indices = increment_state(&state, shape);
+        if (more_indices)
+            formatter.append("\n");
+
+    } while (more_indices);
+}
+
 static void print_ndim_array(Array *a, ostream &strm, bool /*print_name */ )
 {
 
@@ -182,6 +227,11 @@ static void print_ndim_array(Array *a, ostream &strm, bool /*print_name */ )
     // on the row.
     vector<int> state(dims - 1, 0);
 
+    if (AsciiRowFormatter::is_supported(a)) {
+        print_ndim_array_rows(a, strm, shape, rightmost_dim_size, state);
+        return;
+    }
+
     bool more_indices;
     int index = 0;
     do {
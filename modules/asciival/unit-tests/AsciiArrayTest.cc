@@ -25,6 +25,7 @@
 // Tests for the DataDDS class.
 
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <algorithm>
 #include <iterator>
@@ -33,10 +34,14 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <libdap/Byte.h>
 #include <libdap/DDS.h>
+#include <libdap/Float32.h>
+#include <libdap/Float64.h>
 
 #include "AsciiArray.h"
 #include "AsciiOutputFactory.h"
+#include "AsciiRowFormatter.h"
 
 #include "modules/common/run_tests_cppunit.h"
 #include "test_config.h"
@@ -93,6 +98,11 @@ CPPUNIT_TEST_SUITE( AsciiArrayTest );
     CPPUNIT_TEST(test_get_nth_dim_size);
     CPPUNIT_TEST(test_get_shape_vector);
     CPPUNIT_TEST(test_get_index);
+    CPPUNIT_TEST(test_print_vector);
+    CPPUNIT_TEST(test_print_array);
+    CPPUNIT_TEST(test_print_float32_vector);
+    CPPUNIT_TEST(test_print_float64_vector);
+    CPPUNIT_TEST(test_print_uint8_vector);
 
     CPPUNIT_TEST_SUITE_END()
     ;
@@ -245,6 +255,91 @@ CPPUNIT_TEST_SUITE( AsciiArrayTest );
             CPPUNIT_ASSERT(false);
         }
     }
+
+    // The values formatted by AsciiRowFormatter must match print_val().
+    string print_val_values(Array &array)
+    {
+        ostringstream oss;
+        oss << array.name() << ", ";
+        for (int i = 0; i < array.length(); ++i) {
+            array.var(i)->print_val(oss, "", false);
+            if (i < array.length() - 1) oss << ", ";
+        }
+        return oss.str();
+    }
+
+    void test_print_vector()
+    {
+        vector<dods_int32> values = { 0, -1, 2, -2147483647 - 1, 2147483647, 5, 6, 7, 8, 9 };
+        a->set_value(values, values.size());
+
+        ostringstream oss;
+        a->print_ascii(oss, true);
+        CPPUNIT_ASSERT_EQUAL(string("a, 0, -1, 2, -2147483648, 2147483647, 5, 6, 7, 8, 9"), oss.str());
+        CPPUNIT_ASSERT_EQUAL(print_val_values(*a), oss.str());
+    }
+
+    void test_print_array()
+    {
+        vector<dods_int32> values(100);
+        for (int i = 0; i < 100; ++i)
+            values[i] = i;
+        b->set_value(values, values.size());
+
+        ostringstream oss;
+        b->print_ascii(oss, true);
+
+        ostringstream expected;
+        for (int i = 0; i < 10; ++i) {
+            expected << "b[" << i << "]";
+            for (int j = 0; j < 10; ++j)
+                expected << ", " << i * 10 + j;
+            if (i < 9) expected << "\n";
+        }
+        CPPUNIT_ASSERT_EQUAL(expected.str(), oss.str());
+    }
+
+    void test_print_float32_vector()
+    {
+        Float32 proto("f32");
+        AsciiArray f("f32", &proto);
+        vector<dods_float32> values = { 0.0f, -1.5f, 3.14159265f, 1.0e-7f, 123456789.0f, 1.0f / 3.0f };
+        f.append_dim(values.size());
+        f.set_value(values, values.size());
+
+        ostringstream oss;
+        f.print_ascii(oss, true);
+        CPPUNIT_ASSERT_EQUAL(print_val_values(f), oss.str());
+    }
+
+    void test_print_float64_vector()
+    {
+        Float64 proto("f64");
+        AsciiArray f("f64", &proto);
+        vector<dods_float64> values = { 0.0, -1.5, 3.14159265358979, 1.0e-300, 6.02214076e23, 1.0 / 3.0, 47.5 };
+        f.append_dim(values.size());
+        f.set_value(values, values.size());
+
+        ostringstream oss;
+        f.print_ascii(oss, true);
+        CPPUNIT_ASSERT_EQUAL(print_val_values(f), oss.str());
+    }
+
+    // DAP4 UInt8 is a Byte with a different type; it is printed the same way
+    void test_print_uint8_vector()
+    {
+        Byte proto("u8");
+        proto.set_type(dods_uint8_c);
+        AsciiArray u("u8", &proto);
+        vector<dods_byte> values = { 0, 1, 127, 128, 255 };
+        u.append_dim(values.size());
+        u.set_value(values, values.size());
+
+        CPPUNIT_ASSERT(AsciiRowFormatter::is_supported(&u));
+        ostringstream oss;
+        u.print_ascii(oss, true);
+        CPPUNIT_ASSERT_EQUAL(string("u8, 0, 1, 127, 128, 255"), oss.str());
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(AsciiArrayTest);
@@ -0,0 +1,188 @@
+
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of asciival, software which can return an ASCII
+// representation of the data read from a DAP server.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Time the ASCII formatting of the arrays in DAP2 data responses. For each
+// data file, the values of every numeric array are printed using the
+// per-element print_val() calls the module used to use and then using
+// AsciiRowFormatter. The whole response is also built using
+// get_data_values_as_ascii().
+//
+// Build with 'make AsciiFormatBench' and run as:
+//   ./AsciiFormatBench [-n iterations] [file.data ...]
+// With no files, the data files in ../tests/data are used.
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <libdap/Array.h>
+#include <libdap/BaseTypeFactory.h>
+#include <libdap/Connect.h>
+#include <libdap/Constructor.h>
+#include <libdap/DDS.h>
+#include <libdap/Error.h>
+#include <libdap/Response.h>
+
+#include "AsciiRowFormatter.h"
+#include "get_ascii.h"
+
+#include "test_config.h"
+
+using namespace std;
+using namespace libdap;
+using namespace dap_asciival;
+
+static void read_data_file(const string &file, DDS &dds)
+{
+    unique_ptr<Connect> url(new Connect(file));
+    Response r(fopen(file.c_str(), "r"), 0);
+    if (!r.get_stream()) throw Error(string("Could not open: ") + file);
+    url->read_data_no_mime(dds, &r);
+
+    for (DDS::Vars_iter i = dds.var_begin(), e = dds.var_end(); i != e; ++i)
+        (*i)->set_read_p(true);
+}
+
+static void find_numeric_arrays(BaseType *btp, vector<Array *> &arrays)
+{
+    if (btp->type() == dods_array_c) {
+        Array *a = static_cast<Array *>(btp);
+        if (AsciiRowFormatter::is_supported(a)) arrays.push_back(a);
+    }
+    else if (btp->is_constructor_type()) {
+        Constructor *c = static_cast<Constructor *>(btp);
+        for (Constructor::Vars_iter i = c->var_begin(), e = c->var_end(); i != e; ++i)
+            find_numeric_arrays(*i, arrays);
+    }
+}
+
+// The way values were formatted before AsciiRowFormatter.
+static void print_per_element(Array *a, ostream &strm)
+{
+    int64_t length = a->length_ll();
+    for (int64_t i = 0; i < length; ++i) {
+        a->var_ll(i)->print_val(strm, "", false);
+        if (i < length - 1) strm << ", ";
+    }
+}
+
+static void print_with_formatter(Array *a, ostream &strm)
+{
+    AsciiRowFormatter formatter(a, strm);
+    formatter.print_values(0, a->length_ll());
+}
+
+template<typename F>
+static double time_it(int iterations, size_t &bytes, F f)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        ostringstream oss;
+        f(oss);
+        bytes = oss.str().size();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void report(const string &what, double seconds, size_t bytes, int iterations)
+{
+    cout << "    " << what << ": " << seconds << "s, "
+         << (static_cast<double>(bytes) * iterations / seconds) / (1024 * 1024) << " MB/s" << endl;
+}
+
+static void bench(const string &file, int iterations)
+{
+    BaseTypeFactory factory;
+    DDS dds(&factory);
+    read_data_file(file, dds);
+
+    vector<Array *> arrays;
+    for (DDS::Vars_iter i = dds.var_begin(), e = dds.var_end(); i != e; ++i)
+        find_numeric_arrays(*i, arrays);
+
+    cout << file << ": " << arrays.size() << " numeric arrays, " << iterations << " iterations" << endl;
+    if (arrays.empty()) return;
+
+    size_t bytes = 0;
+    double t = time_it(iterations, bytes, [&arrays](ostream &strm) {
+        for (auto a : arrays) print_per_element(a, strm);
+    });
+    report("print_val() per element", t, bytes, iterations);
+
+    t = time_it(iterations, bytes, [&arrays](ostream &strm) {
+        for (auto a : arrays) print_with_formatter(a, strm);
+    });
+    report("AsciiRowFormatter      ", t, bytes, iterations);
+
+    unique_ptr<DDS> ascii_dds(datadds_to_ascii_datadds(&dds));
+    t = time_it(iterations, bytes, [&ascii_dds](ostream &strm) {
+        get_data_values_as_ascii(ascii_dds.get(), strm);
+    });
+    report("whole ASCII response   ", t, bytes, iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 1000;
+
+    int option_char;
+    while ((option_char = getopt(argc, argv, "n:")) != -1) {
+        switch (option_char) {
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        default:
+            cerr << "Usage: " << argv[0] << " [-n iterations] [file.data ...]" << endl;
+            return 1;
+        }
+    }
+
+    vector<string> files(argv + optind, argv + argc);
+    if (files.empty()) {
+        files.push_back(string(TEST_SRC_DIR) + "/../tests/data/fnoc1.data");
+        files.push_back(string(TEST_SRC_DIR) + "/../tests/data/zero_length_array.data");
+    }
+
+    try {
+        for (auto &file : files)
+            bench(file, iterations);
+    }
+    catch (Error &e) {
+        cerr << "Error: " << e.get_error_message() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+// CSVArray.cc
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include <string>
+#include <vector>
+
+#include <BESInternalError.h>
+#include <BESDebug.h>
+
+#include "CSVArray.h"
+#include "CSV_Obj.h"
+
+using namespace std;
+using namespace libdap;
+
+bool CSVArray::read()
+{
+    if (read_p())
+        return true;
+
+    Dim_iter d = dim_begin();
+    int start = dimension_start(d, true);
+    int stride = dimension_stride(d, true);
+    int stop = dimension_stop(d, true);
+    int count = (stop - start) / stride + 1;
+
+    BESDEBUG("csv", "CSVArray::read() - " << name() << "[" << start << ":" << stride << ":" << stop << "]" << endl);
+
+    switch (var()->type()) {
+        case dods_str_c: {
+            vector<string> values;
+            d_csv->readField(name(), start, stride, stop, values);
+            set_value(values, count);
+            break;
+        }
+        case dods_int16_c: {
+            vector<dods_int16> values(count);
+            d_csv->readField(name(), start, stride, stop, values.data());
+            set_value(values.data(), count);
+            break;
+        }
+        case dods_int32_c: {
+            vector<int> values(count);
+            d_csv->readField(name(), start, stride, stop, values.data());
+            set_value(reinterpret_cast<dods_int32 *>(values.data()), count);
+            break;
+        }
+        case dods_float32_c: {
+            vector<dods_float32> values(count);
+            d_csv->readField(name(), start, stride, stop, values.data());
+            set_value(values.data(), count);
+            break;
+        }
+        case dods_float64_c: {
+            vector<dods_float64> values(count);
+            d_csv->readField(name(), start, stride, stop, values.data());
+            set_value(values.data(), count);
+            break;
+        }
+        default:
+            throw BESInternalError("Unknown type for field " + name(), __FILE__, __LINE__);
+    }
+
+    set_read_p(true);
+    return true;
+}
@@ -0,0 +1,59 @@
+// CSVArray.h
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_CSVArray_h
+#define I_CSVArray_h 1
+
+#include <memory>
+#include <string>
+
+#include <libdap/Array.h>
+
+class CSV_Obj;
+
+/**
+ * A column of a CSV file. The values are read from the file only when the
+ * array is read, and only for the records selected by the constraint. All
+ * the arrays of a dataset share one CSV_Obj, so the file is mapped and its
+ * records are found once.
+ */
+class CSVArray : public libdap::Array {
+    std::shared_ptr<CSV_Obj> d_csv;
+
+public:
+    CSVArray(const std::string &name, libdap::BaseType *proto, std::shared_ptr<CSV_Obj> csv)
+        : libdap::Array(name, proto), d_csv(std::move(csv)) {}
+
+    CSVArray(const CSVArray &rhs) = default;
+
+    ~CSVArray() override = default;
+
+    CSVArray &operator=(const CSVArray &rhs) = delete;
+
+    libdap::BaseType *ptr_duplicate() override { return new CSVArray(*this); }
+
+    bool read() override;
+};
+
+#endif // I_CSVArray_h
@@ -32,10 +32,12 @@
 //      pwest       Patrick West <pwest@ucar.edu>
 //      jgarcia     Jose Garcia <jgarcia@ucar.edu>
 
+#include <memory>
 #include <vector>
 #include <string>
 
 #include "CSVDDS.h"
+#include "CSVArray.h"
 #include "CSV_Obj.h"
 
 #include <BESInternalError.h>
@@ -55,18 +57,16 @@
 
 #include <BESDebug.h>
 
+using namespace std;
+
+/**
+ * Build the DDS for a CSV file. Each field becomes an array of records; the
+ * values are read only when (and if) the array is read (see CSVArray).
+ */
 void csv_read_descriptors(DDS &dds, const string &filename)
 {
-    string type;
-    int index = 0;
-
-    Array* ar = 0;
-    void* data = 0;
-    BaseType *bt = 0;
-
-    CSV_Obj* csvObj = new CSV_Obj();
+    auto csvObj = make_shared<CSV_Obj>();
     if (!csvObj->open(filename)) {
-        delete csvObj;
         string err = (string) "Unable to open file " + filename;
         throw BESNotFoundError(err, __FILE__, __LINE__);
     }
@@ -82,117 +82,28 @@ void csv_read_descriptors(DDS &dds, const string &filename)
     if (recordCount < 0)
         throw BESError("Could not read record count from the CSV dataset.", BES_NOT_FOUND_ERROR, __FILE__, __LINE__);
 
-    vector<string>::iterator it = fieldList.begin();
-    vector<string>::iterator et = fieldList.end();
-    for (; it != et; it++) {
-        string fieldName = (*it);
-        type = csvObj->getFieldType(fieldName);
-        ar = dds.get_factory()->NewArray(fieldName);
-        data = csvObj->getFieldData(fieldName);
-
-        if (type.compare(string(STRING)) == 0) {
-            string* strings = new string[recordCount];
-
-            bt = dds.get_factory()->NewStr(fieldName);
-            ar->add_var(bt);
-            ar->append_dim(recordCount, "record");
-
-            index = 0;
-            vector<string>::iterator iv = ((vector<string>*) data)->begin();
-            vector<string>::iterator ev = ((vector<string>*) data)->end();
-            for (; iv != ev; iv++) {
-                strings[index] = *iv;
-                index++;
-            }
-
-            ar->set_value(strings, recordCount);
-            delete[] strings;
-        }
-        else if (type.compare(string(INT16)) == 0) {
-            short* int16 = new short[recordCount];
-            bt = dds.get_factory()->NewInt16(fieldName);
-            ar->add_var(bt);
-            ar->append_dim(recordCount, "record");
-
-            index = 0;
-            vector<short>::iterator iv = ((vector<short>*) data)->begin();
-            vector<short>::iterator ev = ((vector<short>*) data)->end();
-            for (; iv != ev; iv++) {
-                int16[index] = *iv;
-                index++;
-            }
-
-            ar->set_value(int16, recordCount);
-            delete[] int16;
-        }
-        else if (type.compare(string(INT32)) == 0) {
-            int *int32 = new int[recordCount];
-            bt = dds.get_factory()->NewInt32(fieldName);
-            ar->add_var(bt);
-            ar->append_dim(recordCount, "record");
-
-            index = 0;
-            vector<int>::iterator iv = ((vector<int>*) data)->begin();
-            vector<int>::iterator ev = ((vector<int>*) data)->end();
-            for (; iv != ev; iv++) {
-                int32[index] = *iv;
-                index++;
-            }
-
-            ar->set_value((dods_int32*) int32, recordCount);
-            delete[] int32;
-        }
-        else if (type.compare(string(FLOAT32)) == 0) {
-            float *floats = new float[recordCount];
-            bt = dds.get_factory()->NewFloat32(fieldName);
-            ar->add_var(bt);
-            ar->append_dim(recordCount, "record");
-
-            index = 0;
-            vector<float>::iterator iv = ((vector<float>*) data)->begin();
-            vector<float>::iterator ev = ((vector<float>*) data)->end();
-            for (; iv != ev; iv++) {
-                floats[index] = *iv;
-                index++;
-            }
-
-            ar->set_value(floats, recordCount);
-            delete[] floats;
-        }
-        else if (type.compare(string(FLOAT64)) == 0) {
-            double *doubles = new double[recordCount];
-            bt = dds.get_factory()->NewFloat64(fieldName);
-            ar->add_var(bt);
-            ar->append_dim(recordCount, "record");
-
-            index = 0;
-            vector<double>::iterator iv = ((vector<double>*) data)->begin();
-            vector<double>::iterator ev = ((vector<double>*) data)->end();
-            for (; iv != ev; iv++) {
-                doubles[index] = *iv;
-                index++;
-            }
-
-            ar->set_value(doubles, recordCount);
-            delete[] doubles;
-        }
+    for (const auto &fieldName: fieldList) {
+        string type = csvObj->getFieldType(fieldName);
+        unique_ptr<BaseType> bt;
+
+        if (type.compare(string(STRING)) == 0)
+            bt.reset(dds.get_factory()->NewStr(fieldName));
+        else if (type.compare(string(INT16)) == 0)
+            bt.reset(dds.get_factory()->NewInt16(fieldName));
+        else if (type.compare(string(INT32)) == 0)
+            bt.reset(dds.get_factory()->NewInt32(fieldName));
+        else if (type.compare(string(FLOAT32)) == 0)
+            bt.reset(dds.get_factory()->NewFloat32(fieldName));
+        else if (type.compare(string(FLOAT64)) == 0)
+            bt.reset(dds.get_factory()->NewFloat64(fieldName));
         else {
-            delete csvObj;
             string err = (string) "Unknown type for field " + fieldName;
             throw BESInternalError(err, __FILE__, __LINE__);
         }
 
-        dds.add_var(ar);
+        CSVArray ar(fieldName, bt.get(), csvObj);
+        ar.append_dim(recordCount, "record");
 
-        //if( ar ) {
-        delete ar;
-        ar = 0; // }
-        //if( bt ) {
-        delete bt;
-        bt = 0; //}
+        dds.add_var(&ar);
     }
-
-    delete csvObj;
-    csvObj = 0;
 }
-
@@ -35,6 +35,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 
 #include "CSV_Obj.h"
 #include "CSV_Utils.h"
@@ -90,51 +91,34 @@ bool CSV_Obj::open(const string& filepath)
 	return _reader->open(filepath);
 }
 
+/**
+ * Read the header and find the data rows. The values themselves are read
+ * when they are needed (see readField() and getFieldData()), but each row is
+ * checked here to make sure it has a value for every field.
+ */
 void CSV_Obj::load()
 {
 	vector<string> txtLine;
-	bool OnHeader = true;
+	_rows.clear();
 	_reader->reset();
-	while (!_reader->eof()) {
-		_reader->get(txtLine);
-
-		if (OnHeader) {
-			if (_header->populate(&txtLine)) {
-				for (unsigned int i = 0; i < txtLine.size(); i++) {
-					_data->push_back(new CSV_Data());
-				}
-			}
-			OnHeader = false;
+	_reader->get(txtLine);
+
+	if (_header->populate(&txtLine)) {
+		for (unsigned int i = 0; i < txtLine.size(); i++) {
+			_data->push_back(0);	// see getFieldData()
 		}
-		else if (!txtLine.empty()) {
-			int index = 0;
-			vector<CSV_Data *>::iterator it = _data->begin();
-			vector<CSV_Data *>::iterator et = _data->end();
-			for (; it != et; it++) {
-				CSV_Data *d = (*it);
-				try {
-                    string token = txtLine.at(index);
-                    CSV_Utils::slim(token);
-                    CSV_Field *f = _header->getField(index);
-                    if (!f) {
-                        ostringstream err;
-                        err << " Attempting to add value " << token << " to field " << index << ", field does not exist";
-                        ERROR_LOG(err.str());
-                        throw BESInternalError(err.str(), __FILE__, __LINE__);
-                    }
-                    d->insert(f, &token);
-                }
-				catch (const std::out_of_range &/*e*/) {
-                    ostringstream err;
-                    err << "Error in CSV dataset, too few data elements on line " << _reader->get_row_number();
-                        // FIXME: Different on OSX and Linux << " (C++ Error: " << e.what() << ")";
-                    ERROR_LOG(err.str());
-                    throw BESSyntaxUserError(err.str(), __FILE__, __LINE__);
-				}
-				index++;
-			}
+	}
+
+	const char *line = 0;
+	size_t len = 0;
+	while (_reader->next_line(line, len)) {
+		if (CSV_Utils::count_fields(line, len, ',') < _data->size()) {
+			ostringstream err;
+			err << "Error in CSV dataset, too few data elements on line " << _reader->get_row_number();
+			ERROR_LOG(err.str());
+			throw BESSyntaxUserError(err.str(), __FILE__, __LINE__);
 		}
-		txtLine.clear();
+		_rows.push_back(_reader->line_offset());
 	}
 }
 
@@ -150,50 +134,107 @@ string CSV_Obj::getFieldType(const string& fieldName)
 
 int CSV_Obj::getRecordCount()
 {
-	CSV_Data* alphaField = _data->at(0);
-	string type = alphaField->getType();
+	return _rows.size();
+}
 
-	if (type.compare(string(STRING)) == 0) {
-		return ((vector<string>*) alphaField->getData())->size();
-	}
-	else if (type.compare(string(FLOAT32)) == 0) {
-		return ((vector<float>*) alphaField->getData())->size();
-	}
-	else if (type.compare(string(FLOAT64)) == 0) {
-		return ((vector<double>*) alphaField->getData())->size();
-	}
-	else if (type.compare(string(INT16)) == 0) {
-		return ((vector<short>*) alphaField->getData())->size();
-	}
-	else if (type.compare(string(INT32)) == 0) {
-		return ((vector<int>*) alphaField->getData())->size();
+// Get the value of field 'index' in data row 'row', with any quotes removed.
+void CSV_Obj::readToken(size_t row, unsigned int index, string &token)
+{
+	const char *line = 0;
+	size_t len = 0;
+	_reader->line_at(_rows.at(row), line, len);
+	if (!CSV_Utils::get_field(line, len, ',', index, token)) {
+		ostringstream err;
+		err << "Error in CSV dataset, too few data elements in record " << row;
+		throw BESSyntaxUserError(err.str(), __FILE__, __LINE__);
 	}
-	else {
-		return -1;
+	CSV_Utils::slim(token);
+}
+
+static CSV_Field *
+get_field_or_throw(CSV_Header *header, const string &field)
+{
+	CSV_Field *f = header->getField(field);
+	if (!f) {
+		string err = (string) "Unable to get data for field " + field + ", no such field exists";
+		throw BESInternalError(err, __FILE__, __LINE__);
 	}
+	return f;
 }
 
 void *
 CSV_Obj::getFieldData(const string& field)
 {
-	void *ret = 0;
-	CSV_Field *f = _header->getField(field);
-	if (f) {
-		int index = f->getIndex();
-		CSV_Data *d = _data->at(index);
-		if (d) {
-			ret = d->getData();
-		}
-		else {
-			string err = (string) "Unable to get data for field " + field;
-			throw BESInternalError(err, __FILE__, __LINE__);
+	CSV_Field *f = get_field_or_throw(_header, field);
+	int index = f->getIndex();
+	CSV_Data *d = _data->at(index);
+	if (!d) {
+		// Parse this field's values the first time they are asked for
+		d = new CSV_Data();
+		(*_data)[index] = d;
+		string token;
+		for (size_t row = 0; row < _rows.size(); row++) {
+			readToken(row, index, token);
+			d->insert(f, &token);
 		}
 	}
-	else {
-		string err = (string) "Unable to get data for field " + field + ", no such field exists";
-		throw BESInternalError(err, __FILE__, __LINE__);
+	return d->getData();
+}
+
+/**
+ * @brief Read the values of one field for a subset of the records
+ *
+ * Only the named field is parsed. The records are start, start + stride, ...
+ * up to and including stop.
+ *
+ * @param field The field name
+ * @param values Value-result parameter; the values are appended
+ */
+void CSV_Obj::readField(const string &field, int start, int stride, int stop, vector<string> &values)
+{
+	unsigned int index = get_field_or_throw(_header, field)->getIndex();
+	string token;
+	for (int row = start; row <= stop; row += stride) {
+		readToken(row, index, token);
+		values.push_back(token);
+	}
+}
+
+template<typename T> void
+CSV_Obj::readNumbers(unsigned int index, int start, int stride, int stop, T *values, T (*convert)(const char *))
+{
+	string token;
+	for (int row = start; row <= stop; row += stride) {
+		readToken(row, index, token);
+		*values++ = convert(token.c_str());
 	}
-	return ret;
+}
+
+// The same conversions CSV_Data::insert() uses
+static short to_short(const char *s) { return atoi(s); }
+static int to_int(const char *s) { return atoi(s); }
+static float to_float(const char *s) { return atof(s); }
+static double to_double(const char *s) { return atof(s); }
+
+/// @see readField(const string &, int, int, int, vector<string> &); values must have room for the values.
+void CSV_Obj::readField(const string &field, int start, int stride, int stop, short *values)
+{
+	readNumbers(get_field_or_throw(_header, field)->getIndex(), start, stride, stop, values, to_short);
+}
+
+void CSV_Obj::readField(const string &field, int start, int stride, int stop, int *values)
+{
+	readNumbers(get_field_or_throw(_header, field)->getIndex(), start, stride, stop, values, to_int);
+}
+
+void CSV_Obj::readField(const string &field, int start, int stride, int stop, float *values)
+{
+	readNumbers(get_field_or_throw(_header, field)->getIndex(), start, stride, stop, values, to_float);
+}
+
+void CSV_Obj::readField(const string &field, int start, int stride, int stop, double *values)
+{
+	readNumbers(get_field_or_throw(_header, field)->getIndex(), start, stride, stop, values, to_double);
 }
 
 vector<string> CSV_Obj::getRecord(const int rowNum)
@@ -50,6 +50,11 @@ private:
     CSV_Reader*			_reader ;
     CSV_Header*			_header ;
     std::vector<CSV_Data*>*		_data ;
+    std::vector<size_t>		_rows ;		// offsets of the data rows
+
+    template<typename T> void	readNumbers( unsigned int index, int start, int stride, int stop, T *values,
+                                             T (*convert)(const char *) ) ;
+    void			readToken( size_t row, unsigned int index, std::string &token ) ;
 public:
     				CSV_Obj() ;
     virtual			~CSV_Obj() ;
@@ -66,6 +71,13 @@ public:
 
     void *			getFieldData( const std::string& field ) ;
 
+    void			readField( const std::string &field, int start, int stride, int stop,
+                                   std::vector<std::string> &values ) ;
+    void			readField( const std::string &field, int start, int stride, int stop, short *values ) ;
+    void			readField( const std::string &field, int start, int stride, int stop, int *values ) ;
+    void			readField( const std::string &field, int start, int stride, int stop, float *values ) ;
+    void			readField( const std::string &field, int start, int stride, int stop, double *values ) ;
+
     std::vector<std::string>		getRecord( const int rowCount ) ;
 
     virtual void		dump( std::ostream &strm ) const ;
@@ -32,83 +32,145 @@
 //      pwest       Patrick West <pwest@ucar.edu>
 //      jgarcia     Jose Garcia <jgarcia@ucar.edu>
 
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "CSV_Reader.h"
 #include "CSV_Utils.h"
 #include "BESUtil.h"
 
 using std::ostream;
-using std::fstream;
 using std::endl;
-using std::ios;
 using std::string;
 using std::vector;
 
-CSV_Reader::CSV_Reader(): _row_number(0) {
-    _stream_in = new fstream();
+CSV_Reader::CSV_Reader(): _row_number(0), _fd(-1), _data(nullptr), _size(0), _pos(0), _line(0) {
 }
 
 CSV_Reader::~CSV_Reader() {
-    if (_stream_in) {
-        if (_stream_in->is_open()) {
-            _stream_in->close();
-        }
-        delete _stream_in;
-        _stream_in = 0;
-    }
+    close();
 }
 
 bool
 CSV_Reader::open(const string &filepath) {
-    bool ret = false;
+    close();
     _filepath = filepath;
-    _stream_in->open(filepath.c_str(), fstream::in);
-    if (!(_stream_in->fail()) && _stream_in->is_open()) {
-        _row_number = 0;
-        ret = true;
+    _fd = ::open(filepath.c_str(), O_RDONLY);
+    if (_fd < 0)
+        return false;
+
+    struct stat buf;
+    if (fstat(_fd, &buf) != 0) {
+        close();
+        return false;
     }
-    return ret;
+
+    _size = buf.st_size;
+    if (_size > 0) {
+        void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+        madvise(data, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char *>(data);
+    }
+
+    _row_number = 0;
+    _pos = 0;
+    _line = 0;
+    return true;
 }
 
 bool
-CSV_Reader::close() const {
-    bool ret = false;
-    if (_stream_in) {
-        _stream_in->close();
-        if (!(_stream_in->bad()) && !(_stream_in->is_open())) {
-            ret = true;
-        }
+CSV_Reader::close() {
+    bool ret = true;
+    if (_data) {
+        munmap(const_cast<char *>(_data), _size);
+        _data = nullptr;
     }
+    if (_fd >= 0) {
+        ret = (::close(_fd) == 0);
+        _fd = -1;
+    }
+    _size = 0;
+    _pos = 0;
+    _line = 0;
     return ret;
 }
 
 bool
 CSV_Reader::eof() const {
-    return _stream_in->eof();
+    return _pos >= _size;
 }
 
 void
 CSV_Reader::reset() {
     _row_number = 0;
-    _stream_in->seekg(ios::beg);
+    _pos = 0;
+    _line = 0;
+}
+
+/**
+ * @brief Get the next line
+ *
+ * Empty lines and comment lines are skipped. Comment lines must start with
+ * a '#'. Pretty primitive; if more is needed, add a function to test for a
+ * comment line. jhrg 3/11/21
+ *
+ * @param line Value-result parameter; the start of the line in the mapped file
+ * @param len Value-result parameter; the length of the line, without the newline
+ * @return False at the end of the file
+ */
+bool
+CSV_Reader::next_line(const char *&line, size_t &len) {
+    while (_pos < _size) {
+        _line = _pos;
+        line_at(_pos, line, len);
+        _pos = line_end(_pos) + 1;
+        if (len > 0 && line[0] != '#') {
+            _row_number++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The offset of the newline that ends the line at offset, or the file size
+size_t
+CSV_Reader::line_end(size_t offset) const {
+    const char *end = static_cast<const char *>(memchr(_data + offset, '\n', _size - offset));
+    return end ? end - _data : _size;
 }
 
+/**
+ * @brief Get the line that starts at an offset returned by line_offset()
+ * @param offset The offset of the line
+ * @param line Value-result parameter; the start of the line
+ * @param len Value-result parameter; the length of the line, without the
+ * newline or the carriage return of a CRLF
+ */
+void
+CSV_Reader::line_at(size_t offset, const char *&line, size_t &len) const {
+    line = _data + offset;
+    len = line_end(offset) - offset;
+    if (len > 0 && line[len - 1] == '\r')
+        len--;
+}
 
 void
 CSV_Reader::get(vector<string> &row) {
-    string line;
-
-    // Read and ignore empty lines of comment lines. Comment lines
-    // must start with a '#'. Pretty primitive; if more is needed,
-    // add a function to test for a comment line. jhrg 3/11/21
-    do {
-        getline(*_stream_in, line);
-        // when we reach EOF, line.size() is zero and that condition
-        // (i.e., when row is zero in CSV_Utils::split() below) signals
-        // EOF to this handler. jhrg 3/11/21
-    } while(!_stream_in->eof() && (line.size() == 0 || line[0] == '#'));
-
-    CSV_Utils::split(line, ',', row);
-    _row_number++;
+    // when we reach EOF, the line is empty and that condition (i.e., when
+    // row is zero in CSV_Utils::split() below) signals EOF to this handler.
+    // jhrg 3/11/21
+    const char *line = nullptr;
+    size_t len = 0;
+    if (next_line(line, len))
+        CSV_Utils::split(string(line, len), ',', row);
 }
 
 void
@@ -116,7 +178,7 @@ CSV_Reader::dump(ostream &strm) const {
     strm << BESIndent::LMarg << "CSV_Reader::dump - ("
          << (void *) this << ")" << endl;
     BESIndent::Indent();
-    if (_stream_in) {
+    if (_fd >= 0) {
         strm << BESIndent::LMarg << "File " << _filepath << " is open" << endl;
         strm << BESIndent::LMarg << "Current row " << _row_number << endl;
     }
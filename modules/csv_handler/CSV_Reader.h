@@ -37,17 +37,28 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
 #include <iostream>
-#include <algorithm>
 
 #include <BESObj.h>
 
+/**
+ * Read the lines of a CSV file. The file is memory mapped, lines are found
+ * with memchr() and blank lines and comment lines (starting with '#') are
+ * skipped. Callers can note the offset of a line (line_offset()) and come
+ * back to it later (line_at()) without rereading the file. Lines may end in
+ * either LF or CRLF.
+ */
 class CSV_Reader : public BESObj {
 private:
     unsigned long long _row_number;
     std::string _filepath;
-    std::fstream *_stream_in;
+    int _fd;
+    const char *_data;      // the mapped file, null if the file is empty or not open
+    size_t _size;
+    size_t _pos;            // offset of the next line
+    size_t _line;           // offset of the line next_line() last returned
+
+    size_t line_end(size_t offset) const;
 public:
     CSV_Reader();
 
@@ -55,7 +66,7 @@ public:
 
     bool open(const std::string &filepath);
 
-    bool close() const;
+    bool close();
 
     bool eof() const;
 
@@ -63,6 +74,16 @@ public:
 
     void get(std::vector<std::string> &row);
 
+    bool next_line(const char *&line, size_t &len);
+
+    /// @return The offset of the next line
+    size_t tell() const { return _pos; }
+
+    /// @return The offset of the line next_line() last returned, for use with line_at()
+    size_t line_offset() const { return _line; }
+
+    void line_at(size_t offset, const char *&line, size_t &len) const;
+
     unsigned long long get_row_number() const { return _row_number; }
     std::string get_file_name() const { return _filepath; }
 
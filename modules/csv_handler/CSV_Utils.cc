@@ -32,11 +32,13 @@
 //      pwest       Patrick West <pwest@ucar.edu>
 //      jgarcia     Jose Garcia <jgarcia@ucar.edu>
 
+#include <cstring>
 #include <list>
 
 #include "CSV_Utils.h"
 
 #include <BESUtil.h>
+#include <BESInternalError.h>
 
 using std::vector;
 using std::string;
@@ -70,7 +72,102 @@ CSV_Utils::split(const string &str, char delimiter, vector<string> &tokens) {
  */
 void
 CSV_Utils::slim(string &str) {
-    if (*(--str.end()) == '\"' and *str.begin() == '\"')
+    if (!str.empty() && *(--str.end()) == '\"' and *str.begin() == '\"')
         str = str.substr(1, str.size() - 2);
 }
 
+/** @brief Find the end of the field that starts at an offset in a line
+ *
+ * Fields are parsed as split() (BESUtil::explode()) does: a field that starts
+ * with a double quote runs to the matching (unescaped) quote, which must be
+ * followed by the delimiter or the end of the line.
+ *
+ * @param line The line; not null terminated
+ * @param len The length of the line
+ * @param start The offset of the start of the field
+ * @param delimiter The field delimiter
+ * @return The offset of the delimiter that ends the field, or len
+ */
+size_t
+CSV_Utils::field_end(const char *line, size_t len, size_t start, char delimiter) {
+    if (start < len && line[start] == '"') {
+        size_t qstart = start + 1;
+        bool endquote = false;
+        while (!endquote) {
+            const char *aquote = static_cast<const char *>(memchr(line + qstart, '"', len - qstart));
+            if (!aquote) {
+                string err = "CSV_Utils::field_end - No end quote after value " + string(line + start, len - start);
+                throw BESInternalError(err, __FILE__, __LINE__);
+            }
+            // could be an escaped escape character and an escaped
+            // quote, or an escaped escape character and a quote
+            size_t q = aquote - line;
+            endquote = (line[q - 1] != '\\' || line[q - 2] == '\\');
+            qstart = q + 1;
+        }
+        if (qstart != len && line[qstart] != delimiter) {
+            string err = "CSV_Utils::field_end - No delim after end quote " + string(line + start, qstart - start);
+            throw BESInternalError(err, __FILE__, __LINE__);
+        }
+        return qstart;
+    }
+
+    const char *adelim = static_cast<const char *>(memchr(line + start, delimiter, len - start));
+    return adelim ? adelim - line : len;
+}
+
+/** @brief Get one field of a line without splitting the whole line
+ *
+ * @param line The line; not null terminated
+ * @param len The length of the line
+ * @param delimiter The field delimiter
+ * @param index The zero-based index of the field
+ * @param token Value-result parameter; the field, including any quotes
+ * @return False if the line has fewer than index + 1 fields
+ */
+bool
+CSV_Utils::get_field(const char *line, size_t len, char delimiter, unsigned int index, string &token) {
+    if (len == 0)
+        return false;
+
+    size_t start = 0;
+    for (unsigned int i = 0;; i++) {
+        size_t end = field_end(line, len, start, delimiter);
+        if (i == index) {
+            token.assign(line + start, end - start);
+            return true;
+        }
+        if (end == len)
+            return false;
+        start = end + 1;
+        // A delimiter at the end of the line is followed by an empty field.
+        if (start == len) {
+            token.clear();
+            return i + 1 == index;
+        }
+    }
+}
+
+/** @brief The number of fields in a line; the same as the size of the vector split() makes
+ *
+ * @param line The line; not null terminated
+ * @param len The length of the line
+ * @param delimiter The field delimiter
+ */
+unsigned int
+CSV_Utils::count_fields(const char *line, size_t len, char delimiter) {
+    if (len == 0)
+        return 0;
+
+    unsigned int count = 0;
+    size_t start = 0;
+    while (true) {
+        size_t end = field_end(line, len, start, delimiter);
+        count++;
+        if (end == len)
+            return count;
+        start = end + 1;
+        if (start == len)
+            return count + 1;
+    }
+}
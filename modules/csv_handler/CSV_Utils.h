@@ -46,6 +46,12 @@ public:
     static void split(const std::string &str, char delimiter, std::vector<std::string> &tokens);
 
     static void slim(std::string &str);
+
+    static size_t field_end(const char *line, size_t len, size_t start, char delimiter);
+
+    static bool get_field(const char *line, size_t len, char delimiter, unsigned int index, std::string &token);
+
+    static unsigned int count_fields(const char *line, size_t len, char delimiter);
 };
 
 #endif // I_CSV_Utils_h
@@ -0,0 +1,125 @@
+// CSVObjTest.cc
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "CSV_Obj.h"
+
+#include "modules/common/run_tests_cppunit.h"
+#include "test_config.h"
+
+using namespace std;
+
+#define prolog std::string("CSVObjTest::").append(__func__).append("() - ")
+
+// lf.csv and crlf.csv hold the same records; one has LF line ends, the other CRLF
+class CSVObjTest: public CppUnit::TestFixture {
+private:
+    void check_file(const string &name)
+    {
+        DBG(cerr << prolog << name << endl);
+        CSV_Obj csv;
+        CPPUNIT_ASSERT(csv.open(string(TEST_SRC_DIR) + "/" + name));
+        csv.load();
+
+        vector<string> fields;
+        csv.getFieldList(fields);
+        CPPUNIT_ASSERT_EQUAL((size_t)4, fields.size());
+        CPPUNIT_ASSERT_EQUAL(string("Notes"), fields[3]);
+        CPPUNIT_ASSERT_EQUAL(string("String"), csv.getFieldType("Notes"));
+        CPPUNIT_ASSERT_EQUAL(string("Int32"), csv.getFieldType("count"));
+
+        // The comment and the blank line are not records
+        CPPUNIT_ASSERT_EQUAL(5, csv.getRecordCount());
+
+        // All the records
+        vector<string> notes;
+        csv.readField("Notes", 0, 1, 4, notes);
+        CPPUNIT_ASSERT_EQUAL((size_t)5, notes.size());
+        CPPUNIT_ASSERT_EQUAL(string(R"(say \"hi\")"), notes[0]);
+        CPPUNIT_ASSERT_EQUAL(string(""), notes[1]);
+        CPPUNIT_ASSERT_EQUAL(string("x, y"), notes[2]);
+        CPPUNIT_ASSERT_EQUAL(string(""), notes[3]);
+        CPPUNIT_ASSERT_EQUAL(string("last"), notes[4]);
+
+        // Every other record, as CSVArray::read() asks for them
+        vector<string> stations;
+        csv.readField("Station", 0, 2, 4, stations);
+        CPPUNIT_ASSERT_EQUAL((size_t)3, stations.size());
+        CPPUNIT_ASSERT_EQUAL(string("A,B"), stations[0]);
+        CPPUNIT_ASSERT_EQUAL(string("D"), stations[1]);
+        CPPUNIT_ASSERT_EQUAL(string("F"), stations[2]);
+
+        vector<int> counts(2);
+        csv.readField("count", 1, 3, 4, counts.data());
+        CPPUNIT_ASSERT_EQUAL(2, counts[0]);
+        CPPUNIT_ASSERT_EQUAL(5, counts[1]);
+
+        vector<float> temps(2);
+        csv.readField("temp", 2, 2, 4, temps.data());
+        CPPUNIT_ASSERT_EQUAL(12.5f, temps[0]);
+        CPPUNIT_ASSERT_EQUAL(14.5f, temps[1]);
+
+        // The whole-field path agrees with the stride path
+        auto all_notes = static_cast<vector<string> *>(csv.getFieldData("Notes"));
+        CPPUNIT_ASSERT(*all_notes == notes);
+
+        vector<string> record = csv.getRecord(0);
+        CPPUNIT_ASSERT_EQUAL((size_t)4, record.size());
+        CPPUNIT_ASSERT_EQUAL(string("A,B"), record[0]);
+        CPPUNIT_ASSERT_EQUAL(string("1"), record[1]);
+    }
+
+public:
+    CSVObjTest() = default;
+    ~CSVObjTest() = default;
+
+    void lf_test()
+    {
+        check_file("lf.csv");
+    }
+
+    void crlf_test()
+    {
+        check_file("crlf.csv");
+    }
+
+    CPPUNIT_TEST_SUITE( CSVObjTest );
+
+    CPPUNIT_TEST(lf_test);
+    CPPUNIT_TEST(crlf_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CSVObjTest);
+
+int main(int argc, char *argv[])
+{
+    return bes_run_tests<CSVObjTest>(argc, argv, "cerr,csv") ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// CSVUtilsTest.cc
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <BESInternalError.h>
+
+#include "CSV_Utils.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+
+#define prolog std::string("CSVUtilsTest::").append(__func__).append("() - ")
+
+class CSVUtilsTest: public CppUnit::TestFixture {
+private:
+    // The fields of line as get_field() returns them, checked against split()
+    static vector<string> fields(const string &line)
+    {
+        vector<string> tokens;
+        unsigned int count = CSV_Utils::count_fields(line.data(), line.size(), ',');
+        string token;
+        for (unsigned int i = 0; i < count; i++) {
+            CPPUNIT_ASSERT(CSV_Utils::get_field(line.data(), line.size(), ',', i, token));
+            tokens.push_back(token);
+        }
+        CPPUNIT_ASSERT(!CSV_Utils::get_field(line.data(), line.size(), ',', count, token));
+
+        vector<string> split;
+        CSV_Utils::split(line, ',', split);
+        DBG(cerr << prolog << "'" << line << "': " << count << " fields, split() made " << split.size() << endl);
+        CPPUNIT_ASSERT(tokens == split);
+
+        return tokens;
+    }
+
+public:
+    CSVUtilsTest() = default;
+    ~CSVUtilsTest() = default;
+
+    void plain_fields_test()
+    {
+        vector<string> f = fields("a,12,3.5");
+        CPPUNIT_ASSERT_EQUAL((size_t)3, f.size());
+        CPPUNIT_ASSERT_EQUAL(string("a"), f[0]);
+        CPPUNIT_ASSERT_EQUAL(string("12"), f[1]);
+        CPPUNIT_ASSERT_EQUAL(string("3.5"), f[2]);
+    }
+
+    void quoted_comma_test()
+    {
+        vector<string> f = fields("\"a,b\",1,\"c, d\"");
+        CPPUNIT_ASSERT_EQUAL((size_t)3, f.size());
+        CPPUNIT_ASSERT_EQUAL(string("\"a,b\""), f[0]);
+        CPPUNIT_ASSERT_EQUAL(string("1"), f[1]);
+        CPPUNIT_ASSERT_EQUAL(string("\"c, d\""), f[2]);
+
+        CSV_Utils::slim(f[2]);
+        CPPUNIT_ASSERT_EQUAL(string("c, d"), f[2]);
+    }
+
+    void embedded_quote_test()
+    {
+        vector<string> f = fields(R"("say \"hi\", bob",2)");
+        CPPUNIT_ASSERT_EQUAL((size_t)2, f.size());
+        CPPUNIT_ASSERT_EQUAL(string(R"("say \"hi\", bob")"), f[0]);
+        CPPUNIT_ASSERT_EQUAL(string("2"), f[1]);
+
+        // An escaped backslash before the closing quote
+        f = fields(R"("a\\",b)");
+        CPPUNIT_ASSERT_EQUAL((size_t)2, f.size());
+        CPPUNIT_ASSERT_EQUAL(string(R"("a\\")"), f[0]);
+    }
+
+    void empty_fields_test()
+    {
+        vector<string> f = fields("a,,b");
+        CPPUNIT_ASSERT_EQUAL((size_t)3, f.size());
+        CPPUNIT_ASSERT_EQUAL(string(""), f[1]);
+
+        f = fields("a,b,");
+        CPPUNIT_ASSERT_EQUAL((size_t)3, f.size());
+        CPPUNIT_ASSERT_EQUAL(string(""), f[2]);
+
+        f = fields("\"a\",");
+        CPPUNIT_ASSERT_EQUAL((size_t)2, f.size());
+        CPPUNIT_ASSERT_EQUAL(string(""), f[1]);
+
+        CPPUNIT_ASSERT_EQUAL(0U, CSV_Utils::count_fields("", 0, ','));
+        string token;
+        CPPUNIT_ASSERT(!CSV_Utils::get_field("", 0, ',', 0, token));
+    }
+
+    // The lines are not null terminated; nothing past len is looked at
+    void unterminated_line_test()
+    {
+        const string buf = "a,\"b\",c\"d,e";
+        CPPUNIT_ASSERT_EQUAL(2U, CSV_Utils::count_fields(buf.data(), 5, ','));
+        CPPUNIT_ASSERT_EQUAL((size_t)1, CSV_Utils::field_end(buf.data(), 5, 0, ','));
+        CPPUNIT_ASSERT_EQUAL((size_t)5, CSV_Utils::field_end(buf.data(), 5, 2, ','));
+        CPPUNIT_ASSERT_EQUAL((size_t)5, CSV_Utils::field_end(buf.data(), buf.size(), 2, ','));
+
+        string token;
+        CPPUNIT_ASSERT(CSV_Utils::get_field(buf.data(), 5, ',', 1, token));
+        CPPUNIT_ASSERT_EQUAL(string("\"b\""), token);
+    }
+
+    void bad_quote_test()
+    {
+        const string no_end = "a,\"b";
+        CPPUNIT_ASSERT_THROW(CSV_Utils::count_fields(no_end.data(), no_end.size(), ','), BESInternalError);
+
+        const string no_delim = "\"a\"b,c";
+        CPPUNIT_ASSERT_THROW(CSV_Utils::field_end(no_delim.data(), no_delim.size(), 0, ','), BESInternalError);
+    }
+
+    CPPUNIT_TEST_SUITE( CSVUtilsTest );
+
+    CPPUNIT_TEST(plain_fields_test);
+    CPPUNIT_TEST(quoted_comma_test);
+    CPPUNIT_TEST(embedded_quote_test);
+    CPPUNIT_TEST(empty_fields_test);
+    CPPUNIT_TEST(unterminated_line_test);
+    CPPUNIT_TEST(bad_quote_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CSVUtilsTest);
+
+int main(int argc, char *argv[])
+{
+    return bes_run_tests<CSVUtilsTest>(argc, argv, "cerr,csv") ? 0 : 1;
+}
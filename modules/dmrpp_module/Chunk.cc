@@ -23,6 +23,7 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <sstream>
 #include <cstring>
 
@@ -41,6 +42,9 @@
 #define PUGIXML_HEADER_ONLY
 #include <pugixml.hpp>
 
+#include "BESMetrics.h"
+#include "BESTrace.h"
+
 #include "Chunk.h"
 #include "CurlUtils.h"
 #include "CurlHandlePool.h"
@@ -58,6 +62,8 @@ using bes::SignedUrlCache;
 #define prolog std::string("Chunk::").append(__func__).append("() - ")
 
 #define FLETCHER32_CHECKSUM 4               // Bytes in the fletcher32 checksum
+#define FLETCHER32_LANES 8                  // Words summed in parallel by checksum_fletcher32()
+#define FLETCHER32_GROUPS 256               // Groups of words per block in checksum_fletcher32()
 #define ACTUALLY_USE_FLETCHER32_CHECKSUM 1  // Computing checksums takes time...
 
 namespace dmrpp {
@@ -594,12 +600,34 @@ static void checksum_fletcher32_sanity_check(const void *_data, size_t _len) {
         throw BESInternalError(msg, __FILE__, __LINE__);
     }
 }
+// Reduce a Fletcher sum to 16 bits without changing its value mod 65535.
+// This is the reduction the HDF5 code uses; it is repeated here because the
+// sums can be much larger than 32 bits.
+static inline uint64_t fletcher32_reduce(uint64_t sum)
+{
+    while (sum > 0xffff)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return sum;
+}
+
 /**
  * @brief Compute the Fletcher32 checksum for a block of bytes
+ *
+ * This returns the same values as the HDF5 library's H5_checksum_fletcher32(),
+ * from which it was adapted, but it sums the big-endian 16-bit words in
+ * FLETCHER32_LANES independent lanes so that the compiler can vectorize the
+ * loop. For the word at position j (from 1) in a block of n words, sum2 gets
+ * (n - j + 1) times the word. Each lane k keeps 'a', the sum of its words, and
+ * 'b', the sum of 'a' before each group of words was added; the block adds
+ * lanes * b + (lanes - k) * a to sum2. With 256 groups per block, neither 'a'
+ * nor 'b' can overflow 32 bits.
+ *
+ * The reduction keeps each sum's value mod 65535 and only makes it zero if
+ * it was zero, so the results do not depend on the block size.
+ *
  * @param _data Pointer to a block of byte data
  * @param _len Number of bytes to checksum
  * @return The Fletcher32 checksum
- * Credit: The following code is adapted from the HDF5 library
  */
 uint32_t
 checksum_fletcher32(const void *_data, size_t _len)
@@ -608,35 +636,50 @@ checksum_fletcher32(const void *_data, size_t _len)
 
     const auto *data = (const uint8_t *)_data;  // Pointer to the data to be summed
     size_t len = _len / 2;                      // Length in 16-bit words
-    uint32_t sum1 = 0, sum2 = 0;
-
-    // Compute checksum for pairs of bytes
-    // (the magic "360" value is the largest number of sums that can be performed without numeric overflow)
-    while (len) {
-        size_t tlen = len > 360 ? 360 : len;
-        len -= tlen;
-        do {
-            sum1 += (uint32_t)(((uint16_t)data[0]) << 8) | ((uint16_t)data[1]);
-            data += 2;
-            sum2 += sum1;
-        } while (--tlen);
-        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    uint64_t sum1 = 0, sum2 = 0;
+
+    while (len >= FLETCHER32_LANES) {
+        const size_t groups = min(len / FLETCHER32_LANES, (size_t)FLETCHER32_GROUPS);
+        uint32_t a[FLETCHER32_LANES] = {0};
+        uint32_t b[FLETCHER32_LANES] = {0};
+        for (size_t g = 0; g < groups; ++g) {
+            // Build each big-endian word from its bytes so the sums do not
+            // depend on the host's byte order
+            for (size_t k = 0; k < FLETCHER32_LANES; ++k) {
+                b[k] += a[k];
+                a[k] += ((uint32_t)data[2 * k] << 8) | data[2 * k + 1];
+            }
+            data += 2 * FLETCHER32_LANES;
+        }
+
+        const uint64_t n = groups * FLETCHER32_LANES;
+        uint64_t block_sum1 = 0, block_sum2 = 0;
+        for (size_t k = 0; k < FLETCHER32_LANES; ++k) {
+            block_sum1 += a[k];
+            block_sum2 += FLETCHER32_LANES * (uint64_t)b[k] + (FLETCHER32_LANES - k) * (uint64_t)a[k];
+        }
+        sum2 = fletcher32_reduce(sum2 + n * sum1 + block_sum2);
+        sum1 = fletcher32_reduce(sum1 + block_sum1);
+        len -= n;
+    }
+
+    // The words that don't fill a group
+    for (; len; --len) {
+        sum1 += ((uint64_t)data[0] << 8) | data[1];
+        sum2 += sum1;
+        data += 2;
     }
 
     /* Check for odd # of bytes */
-    if(_len % 2) {
-        sum1 += (uint32_t)(((uint16_t)*data) << 8);
+    if (_len % 2) {
+        sum1 += (uint64_t)data[0] << 8;
         sum2 += sum1;
-        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
-    } /* end if */
+    }
 
-    /* Second reduction step to reduce sums to 16 bits */
-    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    sum1 = fletcher32_reduce(sum1);
+    sum2 = fletcher32_reduce(sum2);
 
-    return ((sum2 << 16) | sum1);
+    return (uint32_t)((sum2 << 16) | sum1);
 } /* end checksum_fletcher32() */
 
 /**
@@ -654,6 +697,8 @@ void Chunk::filter_chunk(const string &filters, unsigned long long chunk_size, u
     if (d_is_inflated)
         return;
 
+    BES_TRACE_SPAN("dmrpp", "filter chunk " + filters);
+
     chunk_size *= elem_width;
 
     vector<string> filter_array = BESUtil::split(filters, ' ' );
@@ -1244,6 +1289,7 @@ void Chunk::read_chunk() {
             throw BESInternalError(prolog + "No more libcurl handles.", __FILE__, __LINE__);
 
         try {
+            BES_TRACE_SPAN("dmrpp", "transfer chunk " + std::to_string(get_size()) + " bytes");
             handle->read_data();  // retries until success when appropriate, else throws
             DmrppRequestHandler::curl_handle_pool->release_handle(handle);
         }
@@ -1266,6 +1312,20 @@ void Chunk::read_chunk() {
         throw BESInternalError(oss.str(), __FILE__, __LINE__);
     }
 
+    BESMetrics *metrics = BESMetrics::TheMetrics();
+    if (metrics->enabled()) {
+        static const string fill_value_label = BESMetrics::label("read", "fill_value");
+        static const string chunk_label = BESMetrics::label("read", "chunk");
+        if (d_uses_fill_value) {
+            metrics->add("bes_dmrpp_chunks_read_total", 1, fill_value_label);
+        }
+        else {
+            metrics->add("bes_dmrpp_chunks_read_total", 1, chunk_label);
+            metrics->add("bes_dmrpp_transfers_total", 1, chunk_label);
+            metrics->add("bes_dmrpp_transfer_bytes_total", get_bytes_read(), chunk_label);
+        }
+    }
+
     d_is_read = true;
 }
 
@@ -1286,6 +1346,7 @@ void Chunk::read_chunk_dio() {
         throw BESInternalError(prolog + "No more libcurl handles.", __FILE__, __LINE__);
 
     try {
+        BES_TRACE_SPAN("dmrpp", "transfer chunk (direct IO) " + std::to_string(get_size()) + " bytes");
         handle->read_data();  // retries until success when appropriate, else throws
         DmrppRequestHandler::curl_handle_pool->release_handle(handle);
     }
@@ -1308,6 +1369,14 @@ void Chunk::read_chunk_dio() {
         throw BESInternalError(oss.str(), __FILE__, __LINE__);
     }
 
+    BESMetrics *metrics = BESMetrics::TheMetrics();
+    if (metrics->enabled()) {
+        static const string direct_io_label = BESMetrics::label("read", "direct_io");
+        metrics->add("bes_dmrpp_chunks_read_total", 1, direct_io_label);
+        metrics->add("bes_dmrpp_transfers_total", 1, direct_io_label);
+        metrics->add("bes_dmrpp_transfer_bytes_total", get_bytes_read(), direct_io_label);
+    }
+
     d_is_read = true;
 
 
@@ -31,6 +31,7 @@
 
 // BES
 #include "url_impl.h"
+#include "ChunkStatistics.h"
 
 // libdap4
 #include <libdap/util.h>
@@ -68,6 +69,8 @@ size_t chunk_write_data(void *buffer, size_t size, size_t nmemb, void *data);
 
 void process_s3_error_response(const std::shared_ptr<http::url> &data_url, const std::string &xml_message);
 
+uint32_t checksum_fletcher32(const void *data, size_t len);
+
 /**
  * This class is used to encapsulate the state and behavior needed for reading
  * chunked data associated with a DAP variable. In particular it is based on the
@@ -106,6 +109,10 @@ private:
 
     std::vector<unsigned long long> d_chunk_position_in_array;
 
+    // Optional summary of the values in this chunk, recorded by build_dmrpp -S.
+    bool d_has_statistics{false};
+    bes::ChunkStatistics d_statistics;
+
     // These are used only during the libcurl callback; they are not duplicated by the
     // copy ctor or assignment operator.
 
@@ -161,6 +168,8 @@ protected:
         d_uses_fill_value = bs.d_uses_fill_value;
         d_query_marker = bs.d_query_marker;
         d_chunk_position_in_array = bs.d_chunk_position_in_array;
+        d_has_statistics = bs.d_has_statistics;
+        d_statistics = bs.d_statistics;
     }
 
 public:
@@ -558,6 +567,18 @@ public:
         return d_chunk_position_in_array;
     }
 
+    /// @return True if the min, max, etc., of this chunk's values are known.
+    virtual bool has_statistics() const { return d_has_statistics; }
+
+    /// @return The statistics for this chunk; the position field is not set.
+    virtual const bes::ChunkStatistics &get_statistics() const { return d_statistics; }
+
+    virtual void set_statistics(const bes::ChunkStatistics &stats)
+    {
+        d_statistics = stats;
+        d_has_statistics = true;
+    }
+
     void add_tracking_query_param();
 
     void set_position_in_array(const std::string &pia);
@@ -49,6 +49,9 @@
 #include <pugixml.hpp>
 
 #include "url_impl.h"           // see bes/http
+#include "CurlUtils.h"
+#include "EffectiveUrlCache.h"
+#include "SignedUrlCache.h"
 #include "DMRpp.h"
 #include "DMZ.h"                // this includes the pugixml header
 #include "Chunk.h"
@@ -93,6 +96,31 @@ namespace dmrpp {
 
 using shape = std::vector<unsigned long long>;
 
+/**
+ * @brief Start acquiring the effective URL for a data URL named in the DMR++.
+ *
+ * Chunk::get_data_url() first tries to sign the URL locally and falls back on the
+ * EffectiveUrlCache; do the same here so that the redirects are followed while the
+ * rest of the DMR++ is parsed. Does nothing unless Http.cache.effective.urls.prefetch
+ * is true, or if the effective URL is already cached or being acquired.
+ *
+ * @param data_url The URL from a dmrpp:href attribute
+ */
+static void prefetch_data_url(const shared_ptr<http::url> &data_url) {
+    // Most chunks share a URL; don't sign it or build its headers again once it's cached.
+    if (!http::EffectiveUrlCache::TheCache()->is_prefetch_needed(data_url))
+        return;
+
+    if (bes::SignedUrlCache::TheCache()->get_presigned_s3_url(data_url))
+        return;
+
+    curl_slist *req_hdrs = nullptr;
+    if (data_url->is_trusted()) {
+        req_hdrs = curl::add_edl_auth_headers(nullptr);
+    }
+    http::EffectiveUrlCache::TheCache()->prefetch(data_url, req_hdrs);
+}
+
 // The original unsupported fillValue flags from 4/22
 constexpr static const auto UNSUPPORTED_STRING = "unsupported-string";
 constexpr static const auto UNSUPPORTED_ARRAY = "unsupported-array";
@@ -353,6 +381,7 @@ void DMZ::process_dataset(DMR *dmr, const xml_node &xml_root) {
         throw BESInternalError("DMR++ XML dataset element dmrpp:href is missing. ", __FILE__, __LINE__);
 
     d_dataset_elem_href.reset(new http::url(href_attr, href_trusted));
+    prefetch_data_url(d_dataset_elem_href);
 }
 
 /**
@@ -1998,6 +2027,11 @@ void DMZ::process_chunk(DmrppCommon *dc, const xml_node &chunk) const {
     string size;
     string chunk_position_in_array;
     string filter_mask;
+    string min_value;
+    string max_value;
+    string fill_count;
+    string monotonic;
+    bool has_nan = false;
     bool href_trusted = false;
 
     for (xml_attribute attr = chunk.first_attribute(); attr; attr = attr.next_attribute()) {
@@ -2019,12 +2053,28 @@ void DMZ::process_chunk(DmrppCommon *dc, const xml_node &chunk) const {
         else if (is_eq(attr.name(), "trust") || is_eq(attr.name(), "dmrpp:trust")) {
             href_trusted = is_eq(attr.value(), "true");
         }
+        else if (is_eq(attr.name(), "min")) {
+            min_value = attr.value();
+        }
+        else if (is_eq(attr.name(), "max")) {
+            max_value = attr.value();
+        }
+        else if (is_eq(attr.name(), "fillCount")) {
+            fill_count = attr.value();
+        }
+        else if (is_eq(attr.name(), "monotonic")) {
+            monotonic = attr.value();
+        }
+        else if (is_eq(attr.name(), "hasNaN")) {
+            has_nan = is_eq(attr.value(), "true");
+        }
     }
 
     if (offset.empty() || size.empty())
         throw BESInternalError("Both size and offset are required for a chunk node.", __FILE__, __LINE__);
     if (!href.empty()) {
         shared_ptr<http::url> data_url(new http::url(href, href_trusted));
+        prefetch_data_url(data_url);
         if (filter_mask.empty())
             dc->add_chunk(data_url, dc->get_byte_order(), stoull(size), stoull(offset), chunk_position_in_array);
         else
@@ -2040,6 +2090,22 @@ void DMZ::process_chunk(DmrppCommon *dc, const xml_node &chunk) const {
                           chunk_position_in_array);
     }
 
+    // The statistics are optional (see build_dmrpp -S); fillCount is always
+    // written when they are present, min and max only when the chunk holds
+    // values other than the fill value.
+    if (!fill_count.empty()) {
+        bes::ChunkStatistics stats;
+        stats.fill_count = stoull(fill_count);
+        if (!min_value.empty() && !max_value.empty()) {
+            stats.has_values = true;
+            stats.min_value = stod(min_value);
+            stats.max_value = stod(max_value);
+        }
+        stats.monotonic = !is_eq(monotonic.c_str(), "false");
+        stats.has_nan = has_nan;
+        dc->get_immutable_chunks().back()->set_statistics(stats);
+    }
+
     dc->accumulate_storage_size(stoull(size));
 }
 
@@ -2068,6 +2134,7 @@ void DMZ::process_block(DmrppCommon *dc, const xml_node &chunk, unsigned int blo
         throw BESInternalError("Both size and offset are required for a block node.", __FILE__, __LINE__);
     if (!href.empty()) {
         shared_ptr<http::url> data_url(new http::url(href, href_trusted));
+        prefetch_data_url(data_url);
         dc->add_chunk(data_url, dc->get_byte_order(), stoull(size), stoull(offset), true, block_count);
     }
     else
@@ -2813,6 +2880,7 @@ void DMZ::process_multi_blocks_chunk(dmrpp::DmrppCommon *dc, const pugi::xml_nod
 
         if (!href.empty()) {
             shared_ptr<http::url> data_url(new http::url(href, href_trusted));
+            prefetch_data_url(data_url);
             dc->add_chunk(data_url, dc->get_byte_order(), chunk_position_in_array, temp_pair);
         }
         else {
@@ -2824,6 +2892,7 @@ void DMZ::process_multi_blocks_chunk(dmrpp::DmrppCommon *dc, const pugi::xml_nod
         //General Chunk, not the linked block.
         if (!href.empty()) {
             shared_ptr<http::url> data_url(new http::url(href, href_trusted));
+            prefetch_data_url(data_url);
             dc->add_chunk(data_url, dc->get_byte_order(), stoull(size), stoull(offset), chunk_position_in_array);
         }
         else {
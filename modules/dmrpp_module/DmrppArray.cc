@@ -35,6 +35,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <zlib.h>
@@ -51,6 +52,7 @@
 #include "BESInternalFatalError.h"
 #include "BESLog.h"
 #include "BESStopWatch.h"
+#include "BESTrace.h"
 
 #include "Base64.h"
 #include "Chunk.h"
@@ -2195,6 +2197,8 @@ bool DmrppArray::read() {
     if (length_ll() == 0)
         return true;
 
+    BES_TRACE_SPAN("dmrpp", "read " + name());
+
     if (this->get_dio_flag()) {
         BESDEBUG(MODULE, prolog << "dio is turned  on" << endl);
 
@@ -3624,4 +3628,55 @@ void DmrppArray::insert_chunk_fixed_size_str_unconstrained(unsigned int dim, uns
 }
 
 
+/**
+ * @brief Get the statistics build_dmrpp recorded for the chunks of this array
+ *
+ * @note This does not read any data, but it will load the chunk information
+ * if the DMR++ is being lazy-loaded.
+ *
+ * @param chunk_shape Value-result; the chunk dimension sizes
+ * @param stats Value-result; the statistics for each of the array's chunks
+ * @return False if the array is not chunked or if any chunk is missing its
+ * statistics, true otherwise.
+ */
+bool DmrppArray::get_chunk_statistics(vector<unsigned long long> &chunk_shape, vector<bes::ChunkStatistics> &stats) const
+{
+    auto self = const_cast<DmrppArray *>(this);
+    if (!get_chunks_loaded())
+        self->load_chunks(self);
+
+    if (get_chunk_dimension_sizes().empty() || get_chunk_dimension_sizes().size() != self->dimensions())
+        return false;
+
+    vector<bes::ChunkStatistics> chunk_stats;
+    chunk_stats.reserve(get_chunk_count());
+    for (const auto &chunk: get_immutable_chunks()) {
+        if (!chunk->has_statistics() || chunk->get_position_in_array().size() != self->dimensions())
+            return false;
+
+        chunk_stats.push_back(chunk->get_statistics());
+        chunk_stats.back().position = chunk->get_position_in_array();
+    }
+
+    chunk_shape = get_chunk_dimension_sizes();
+    stats = std::move(chunk_stats);
+    return true;
+}
+
+/**
+ * @brief Get the fill value as a double
+ * @param fill_value Value-result
+ * @return True if this array uses a numeric fill value, false otherwise
+ */
+bool DmrppArray::get_fill_value_as_double(double &fill_value) const
+{
+    if (!get_uses_fill_value() || get_fill_value().empty())
+        return false;
+
+    const string fv = get_fill_value();
+    char *end = nullptr;
+    fill_value = strtod(fv.c_str(), &end);
+    return end != fv.c_str() && *end == '\0';
+}
+
 } // namespace dmrpp
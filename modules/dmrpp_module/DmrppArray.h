@@ -35,6 +35,7 @@
 
 #include <libdap/Array.h>
 
+#include "ChunkStatistics.h"
 #include "DmrppCommon.h"
 #include "SuperChunk.h"
 
@@ -74,7 +75,7 @@ struct ons {
  * different kinds of optimizations, we have implemented two different read()
  * methods, one for the 'no chunks' case and one for arrays 'with chunks.'
  */
-class DmrppArray : public libdap::Array, public dmrpp::DmrppCommon {
+class DmrppArray : public libdap::Array, public dmrpp::DmrppCommon, public bes::ChunkStatisticsSource {
 
 private:
     // void _duplicate(const DmrppArray &ts);
@@ -272,6 +273,10 @@ public:
     void set_special_structure_flag(bool is_special_struct) { is_special_structure = is_special_struct; }
     bool get_special_structure_flag() const { return is_special_structure; }
     bool is_projected();
+
+    bool get_chunk_statistics(std::vector<unsigned long long> &chunk_shape,
+                              std::vector<bes::ChunkStatistics> &stats) const override;
+    bool get_fill_value_as_double(double &fill_value) const override;
 };
 
 /**
@@ -25,6 +25,7 @@
 
 #include <string>
 #include <sstream>
+#include <iomanip>
 #include <vector>
 #include <iterator>
 #include <cstdlib>
@@ -691,6 +692,9 @@ DmrppCommon::print_chunks_element(XMLWriter &xml, const string &name_space)
                 
 
             }
+
+            if (chunk->has_statistics())
+                print_chunk_statistics(xml, chunk->get_statistics());
         }
 
         // End element "chunk":
@@ -700,6 +704,47 @@ DmrppCommon::print_chunks_element(XMLWriter &xml, const string &name_space)
     if (xmlTextWriterEndElement(xml.get_writer()) < 0) throw BESInternalError("Could not end chunks element", __FILE__, __LINE__);
 }
 
+/**
+ * @brief Write the optional statistics for a chunk as attributes of the chunk element.
+ *
+ * The min and max values are written using enough digits to round-trip a double.
+ * The monotonic and hasNaN attributes are written only when they differ
+ * from their defaults.
+ */
+void
+DmrppCommon::print_chunk_statistics(XMLWriter &xml, const bes::ChunkStatistics &stats)
+{
+    if (xmlTextWriterWriteAttribute(xml.get_writer(), (const xmlChar *) "fillCount",
+                                    (const xmlChar *) to_string(stats.fill_count).c_str()) < 0)
+        throw BESInternalError("Could not write attribute fillCount", __FILE__, __LINE__);
+
+    if (stats.has_values) {
+        ostringstream min_value;
+        min_value << setprecision(17) << stats.min_value;
+        if (xmlTextWriterWriteAttribute(xml.get_writer(), (const xmlChar *) "min",
+                                        (const xmlChar *) min_value.str().c_str()) < 0)
+            throw BESInternalError("Could not write attribute min", __FILE__, __LINE__);
+
+        ostringstream max_value;
+        max_value << setprecision(17) << stats.max_value;
+        if (xmlTextWriterWriteAttribute(xml.get_writer(), (const xmlChar *) "max",
+                                        (const xmlChar *) max_value.str().c_str()) < 0)
+            throw BESInternalError("Could not write attribute max", __FILE__, __LINE__);
+    }
+
+    if (!stats.monotonic) {
+        if (xmlTextWriterWriteAttribute(xml.get_writer(), (const xmlChar *) "monotonic",
+                                        (const xmlChar *) "false") < 0)
+            throw BESInternalError("Could not write attribute monotonic", __FILE__, __LINE__);
+    }
+
+    if (stats.has_nan) {
+        if (xmlTextWriterWriteAttribute(xml.get_writer(), (const xmlChar *) "hasNaN",
+                                        (const xmlChar *) "true") < 0)
+            throw BESInternalError("Could not write attribute hasNaN", __FILE__, __LINE__);
+    }
+}
+
 /**
  * @brief Print the Compact base64-encoded information.
  * @see https://gnome.pages.gitlab.gnome.org/libxml2/devhelp/libxml2-xmlwriter.html#xmlTextWriterWriteElementNS
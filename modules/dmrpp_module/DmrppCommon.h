@@ -317,6 +317,7 @@ public:
     virtual bool get_one_chunk_fill_value() const { return d_one_chunk_fill_value; }
 
     void print_chunks_element(libdap::XMLWriter &xml, const std::string &name_space = "");
+    static void print_chunk_statistics(libdap::XMLWriter &xml, const bes::ChunkStatistics &stats);
 
     void print_compact_element(libdap::XMLWriter &xml, const std::string &name_space = "", const std::string &encoded = "") const;
     void print_missing_data_element(const libdap::XMLWriter &xml, const std::string &name_space = "", const std::string &encoded = "") const;
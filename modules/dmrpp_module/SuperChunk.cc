@@ -29,8 +29,10 @@
 
 #include "BESDebug.h"
 #include "BESInternalError.h"
+#include "BESMetrics.h"
 
 #include "BESStopWatch.h"
+#include "BESTrace.h"
 #include "Chunk.h"
 #include "CurlHandlePool.h"
 #include "DmrppArray.h"
@@ -671,6 +673,8 @@ void SuperChunk::read_aggregate_bytes() {
         throw BESInternalError(prolog + "No more libcurl handles.", __FILE__, __LINE__);
 
     try {
+        BES_TRACE_SPAN("dmrpp", "transfer superchunk " + std::to_string(d_size) + " bytes, " +
+                                    std::to_string(d_chunks.size()) + " chunks");
         handle->read_data(); // throws if error
         dmrpp::CurlHandlePool::release_handle(handle);
     } catch (...) {
@@ -685,6 +689,14 @@ void SuperChunk::read_aggregate_bytes() {
         throw BESInternalError(oss.str(), __FILE__, __LINE__);
     }
 
+    BESMetrics *metrics = BESMetrics::TheMetrics();
+    if (metrics->enabled()) {
+        static const string superchunk_label = BESMetrics::label("read", "superchunk");
+        metrics->add("bes_dmrpp_chunks_read_total", d_chunks.size(), superchunk_label);
+        metrics->add("bes_dmrpp_transfers_total", 1, superchunk_label);
+        metrics->add("bes_dmrpp_transfer_bytes_total", d_size, superchunk_label);
+    }
+
     d_is_read = true;
 }
 
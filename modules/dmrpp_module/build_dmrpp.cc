@@ -25,10 +25,22 @@
 
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <iterator>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <cstdlib>
 #include <libgen.h>
 
@@ -53,7 +65,9 @@ void usage() {
 
     build_dmrpp -V: Show build versions for components that make up the program
 
-    build_dmrpp -f <data file> -r <dmr file> [-u <href url>] [-c <bes conf file>] [-M] [-D] [-L] [-v] [-d] 
+    build_dmrpp -f <data file> -r <dmr file> [-u <href url>] [-c <bes conf file>] [-M] [-D] [-L] [-S] [-T] [-v] [-d] 
+
+    build_dmrpp -b <batch file> [-j <processes>] [-u <href url>] [-c <bes conf file>] [-M] [-D] [-L] [-S] [-T] [-v] [-d]
 
     options:
         -f: HDF5 file to build DMR++ from
@@ -63,6 +77,14 @@ void usage() {
         -M: Add production metadata to the built DMR++
         -D: Disable Direct IO feature
         -L: Save variable length data in a side car file
+        -S: Record the min, max and fill value count of each chunk of numeric variables
+        -b: Build many DMR++ documents. Each line of the batch file holds
+            '<data file> <dmr file> <output file> [<href url>]'; blank lines
+            and lines starting with '#' are ignored. The -f and -r options
+            are not used and -u is the default href url.
+        -j: The number of files to process concurrently in batch mode (default 1,
+            0 means one per CPU). Each file is built in its own process.
+        -T: Write the time spent in each phase of the build to stderr
         -h: Show this help
         -v: Verbose HDF5 errors
         -V: Show build versions for components that make up the program
@@ -71,6 +93,186 @@ void usage() {
     cerr << help << endl;
 }
 
+/// The options that apply to every DMR++ built by one invocation.
+struct build_options {
+    string bes_conf_file_used_to_create_dmr;
+    bool add_production_metadata = false;
+    bool disable_dio = false;
+    bool vlen_in_sc = false;
+    bool timing = false;
+};
+
+/// One line of a batch file.
+struct batch_job {
+    string h5_file_name;
+    string dmr_filename;
+    string output_filename;
+    string dmrpp_href_value;
+};
+
+static void print_phase_times(const string &h5_file_name, const phase_times &times)
+{
+    ostringstream oss;
+    oss << fixed << setprecision(6) << "build_dmrpp-timing: " << h5_file_name
+        << " parse_dmr: " << times.parse_dmr << " add_chunks: " << times.add_chunks
+        << " add_metadata: " << times.add_metadata << " serialize: " << times.serialize
+        << " write: " << times.write << " total: " << times.total() << endl;
+    cerr << oss.str();
+}
+
+/**
+ * @brief Read a batch file.
+ * @param batch_filename The file to read
+ * @param default_href Use this href when a line does not have one
+ * @return The jobs, in the order they appear in the file
+ */
+static vector<batch_job> read_batch_file(const string &batch_filename, const string &default_href)
+{
+    ifstream in(batch_filename);
+    if (!in) throw BESInternalFatalError("Could not open the batch file '" + batch_filename + "'.", __FILE__, __LINE__);
+
+    vector<batch_job> jobs;
+    string line;
+    unsigned int line_number = 0;
+    while (getline(in, line)) {
+        ++line_number;
+        istringstream iss(line);
+        batch_job job;
+        if (!(iss >> job.h5_file_name) || job.h5_file_name[0] == '#') continue;
+
+        if (!(iss >> job.dmr_filename >> job.output_filename)) {
+            stringstream msg;
+            msg << "Line " << line_number << " of the batch file '" << batch_filename
+                << "' must hold a data file, a DMR file and an output file.";
+            throw BESInternalFatalError(msg.str(), __FILE__, __LINE__);
+        }
+        if (!(iss >> job.dmrpp_href_value)) job.dmrpp_href_value = default_href;
+
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+/**
+ * @brief Build one DMR++ for a batch job.
+ *
+ * The document is written to a temporary file that is renamed to the output
+ * name only on success, so a failed build never leaves a partial DMR++.
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int build_one(const batch_job &job, const build_options &opts, int argc, char *argv[])
+{
+    string tmp_filename = job.output_filename + ".tmp";
+    try {
+        qc_input_file(job.h5_file_name);
+
+        phase_times times;
+        {
+            ofstream out(tmp_filename, ios::out | ios::trunc);
+            if (!out)
+                throw BESInternalFatalError("Could not open '" + tmp_filename + "' for writing.", __FILE__, __LINE__);
+
+            build_dmrpp_from_dmr_file(job.dmrpp_href_value, job.dmr_filename, job.h5_file_name,
+                    opts.add_production_metadata, opts.bes_conf_file_used_to_create_dmr, opts.disable_dio,
+                    opts.vlen_in_sc, argc, argv, out, &times);
+        }
+
+        if (rename(tmp_filename.c_str(), job.output_filename.c_str()) != 0)
+            throw BESInternalFatalError("Could not rename '" + tmp_filename + "' to '" + job.output_filename + "': "
+                + strerror(errno), __FILE__, __LINE__);
+
+        if (opts.timing) print_phase_times(job.h5_file_name, times);
+
+        return EXIT_SUCCESS;
+    }
+    catch (const BESError &e) {
+        cerr << "ERROR " << job.h5_file_name << ": Caught BESError. message: " << e.get_message() << endl;
+    }
+    catch (const std::exception &e) {
+        cerr << "ERROR " << job.h5_file_name << ": Caught std::exception. what: " << e.what() << endl;
+    }
+    catch (...) {
+        cerr << "ERROR " << job.h5_file_name << ": Caught Unknown Error." << endl;
+    }
+
+    unlink(tmp_filename.c_str());
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief Build the DMR++ documents for a batch of files using up to max_procs processes.
+ *
+ * Each file is built in a forked child. The HDF5 library serializes all calls within
+ * a process, so separate processes are what give real concurrency; they also keep a
+ * crash in one granule from taking down the whole batch.
+ *
+ * @return EXIT_SUCCESS if every file was built, EXIT_FAILURE otherwise.
+ */
+static int run_batch(const vector<batch_job> &jobs, unsigned int max_procs, const build_options &opts,
+        int argc, char *argv[])
+{
+    auto start = chrono::steady_clock::now();
+
+    map<pid_t, size_t> running;     // child pid -> index into jobs
+    size_t next = 0;
+    size_t failures = 0;
+
+    while (next < jobs.size() || !running.empty()) {
+        while (next < jobs.size() && running.size() < max_procs) {
+            // Flush so the children do not inherit (and repeat) buffered output.
+            cout.flush();
+            cerr.flush();
+
+            pid_t pid = fork();
+            if (pid < 0) {
+                if (running.empty())
+                    throw BESInternalFatalError(string("Could not fork a build process: ") + strerror(errno),
+                            __FILE__, __LINE__);
+                break;  // Wait for a running build to finish, then try again.
+            }
+            if (pid == 0) {
+                int status = build_one(jobs[next], opts, argc, argv);
+                cerr.flush();
+                _exit(status);
+            }
+            running[pid] = next++;
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            throw BESInternalFatalError(string("Failed waiting for a build process: ") + strerror(errno),
+                    __FILE__, __LINE__);
+        }
+
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+
+        if (WIFSIGNALED(status)) {
+            cerr << "ERROR " << jobs[it->second].h5_file_name << ": The build process was terminated by signal "
+                 << WTERMSIG(status) << endl;
+            unlink((jobs[it->second].output_filename + ".tmp").c_str());
+            ++failures;
+        }
+        else if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            ++failures;
+        }
+        running.erase(it);
+    }
+
+    if (opts.timing) {
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << fixed << setprecision(3) << "build_dmrpp-batch: files: " << jobs.size() << " failed: " << failures
+             << " processes: " << max_procs << " elapsed: " << elapsed << " files/s: "
+             << (elapsed > 0 ? jobs.size() / elapsed : 0.0) << endl;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 /**
  *
  * @param argc
@@ -82,13 +284,12 @@ int main(int argc, char *argv[]) {
     string h5_dset_path;
     string dmr_filename;
     string dmrpp_href_value;
-    string bes_conf_file_used_to_create_dmr;
-    bool add_production_metadata = false;
-    bool disable_dio = false;
-    bool vlen_in_sc = false;
+    string batch_filename;
+    unsigned int max_procs = 1;
+    build_options opts;
 
     int option_char;
-    while ((option_char = getopt(argc, argv, "c:f:r:u:dhvVMDL")) != -1) {
+    while ((option_char = getopt(argc, argv, "b:c:f:j:r:u:dhvVMDLST")) != -1) {
         switch (option_char) {
             case 'V':
                 cerr << basename(argv[0]) << "-" << CVER << " (bes-"<< CVER << ", " << libdap_name() << "-"
@@ -120,19 +321,36 @@ int main(int argc, char *argv[]) {
                 break;
 
             case 'c':
-                bes_conf_file_used_to_create_dmr = optarg;
+                opts.bes_conf_file_used_to_create_dmr = optarg;
+                break;
+
+            case 'b':
+                batch_filename = optarg;
+                break;
+
+            case 'j':
+                max_procs = static_cast<unsigned int>(strtoul(optarg, nullptr, 10));
+                if (max_procs == 0) max_procs = max(1U, thread::hardware_concurrency());
                 break;
 
             case 'M':
-                add_production_metadata = true;
+                opts.add_production_metadata = true;
                 break;
 
             case 'D':
-                disable_dio = true;
+                opts.disable_dio = true;
                 break;
 
             case 'L':
-                vlen_in_sc = true;
+                opts.vlen_in_sc = true;
+                break;
+
+            case 'T':
+                opts.timing = true;
+                break;
+
+            case 'S':
+                build_dmrpp_util::chunk_statistics = true;
                 break;
 
             default:
@@ -141,6 +359,10 @@ int main(int argc, char *argv[]) {
     }
 
     try {
+        if (!batch_filename.empty()) {
+            return run_batch(read_batch_file(batch_filename, dmrpp_href_value), max_procs, opts, argc, argv);
+        }
+
         // Check to see if the file is hdf5 compliant
         qc_input_file(h5_file_name);
 
@@ -151,15 +373,19 @@ int main(int argc, char *argv[]) {
         }
 
         // Build the dmr++ from an existing DMR file.
+        phase_times times;
         build_dmrpp_from_dmr_file(
                 dmrpp_href_value,
                 dmr_filename,
                 h5_file_name,
-                add_production_metadata,
-                bes_conf_file_used_to_create_dmr,
-                disable_dio,
-                vlen_in_sc,
-                argc,  argv);
+                opts.add_production_metadata,
+                opts.bes_conf_file_used_to_create_dmr,
+                opts.disable_dio,
+                opts.vlen_in_sc,
+                argc,  argv,
+                cout, &times);
+
+        if (opts.timing) print_phase_times(h5_file_name, times);
     }
     catch (const BESError &e) {
         cerr << "ERROR Caught BESError. message: " << e.get_message() << endl;
@@ -28,8 +28,11 @@
 #include <memory>
 #include <iterator>
 #include <unordered_set>
+#include <algorithm>
+#include <cmath>
 #include <iomanip>      // std::put_time()
 #include <ctime>      // std::gmtime_r()
+#include <chrono>
 
 #include <H5Ppublic.h>
 #include <H5Dpublic.h>
@@ -71,6 +74,7 @@ using namespace dmrpp;
 namespace build_dmrpp_util {
 
 bool verbose = false;   // Optionally set by build_dmrpp's main().
+bool chunk_statistics = false;  // Optionally set by build_dmrpp's main() (-S).
 
 #define VERBOSE(x) do { if (verbose) (x); } while(false)
 #define prolog std::string("# build_dmrpp::").append(__func__).append("() - ")
@@ -993,6 +997,132 @@ void process_contiguous_layout_dariable(hid_t dataset, BaseType *btp){
     }
 }
 
+/**
+ * @brief Summarize the values of one chunk
+ *
+ * Values equal to the fill value are counted and otherwise ignored. NaNs
+ * are ignored for the min and max (as the range() function does) and, since
+ * they break the ordering, a chunk holding a NaN is flagged and is never
+ * marked as non-monotonic.
+ *
+ * @param values The chunk's values, in row-major order
+ * @param use_fill True if the variable has a fill value
+ * @param fill The fill value
+ */
+bes::ChunkStatistics compute_chunk_statistics(const vector<double> &values, bool use_fill, double fill)
+{
+    bes::ChunkStatistics stats;
+    bool has_nan = false;
+    bool have_previous = false;
+    bool have_direction = false;
+    bool increasing = false;
+    double previous = 0.0;
+
+    for (double value: values) {
+        if (use_fill && (value == fill || (std::isnan(value) && std::isnan(fill)))) {
+            ++stats.fill_count;
+            continue;
+        }
+        if (std::isnan(value)) {
+            has_nan = true;
+            continue;
+        }
+
+        if (!stats.has_values) {
+            stats.min_value = value;
+            stats.max_value = value;
+            stats.has_values = true;
+        }
+        else {
+            stats.min_value = min(stats.min_value, value);
+            stats.max_value = max(stats.max_value, value);
+        }
+
+        if (have_previous) {
+            bool up = (value - previous) > 0.0;
+            if (have_direction && up != increasing)
+                stats.monotonic = false;
+            increasing = up;
+            have_direction = true;
+        }
+        previous = value;
+        have_previous = true;
+    }
+
+    if (has_nan) {
+        stats.has_nan = true;
+        stats.monotonic = true;
+    }
+
+    return stats;
+}
+
+/**
+ * @brief Record the min, max, etc. of each chunk of a numeric variable
+ *
+ * Each chunk is read using H5Dread() with the values converted to doubles, so
+ * the filters are applied by the HDF5 library. Only the part of an edge chunk
+ * that lies inside the dataset is summarized.
+ *
+ * @param dataset The hdf5 dataset
+ * @param dc The chunks for this variable; their statistics are set
+ * @param chunk_dims The chunk dimension sizes
+ */
+static void add_chunk_statistics(hid_t dataset, DmrppCommon *dc, const vector<hsize_t> &chunk_dims)
+{
+    hid_t dtype_id = H5Dget_type(dataset);
+    H5T_class_t type_class = H5Tget_class(dtype_id);
+    H5Tclose(dtype_id);
+    if (type_class != H5T_INTEGER && type_class != H5T_FLOAT)
+        return;
+
+    bool use_fill = false;
+    double fill = 0.0;
+    if (is_hdf5_fill_value_defined(dataset) > 0) {
+        hid_t plist_id = create_h5plist(dataset);
+        use_fill = H5Pget_fill_value(plist_id, H5T_NATIVE_DOUBLE, &fill) >= 0;
+        H5Pclose(plist_id);
+    }
+
+    hid_t fspace_id = H5Dget_space(dataset);
+    int rank = H5Sget_simple_extent_ndims(fspace_id);
+    vector<hsize_t> dims(rank);
+    H5Sget_simple_extent_dims(fspace_id, dims.data(), nullptr);
+
+    vector<double> values;
+    for (const auto &chunk: dc->get_immutable_chunks()) {
+        const auto &position = chunk->get_position_in_array();
+        if (position.size() != (size_t)rank)
+            continue;
+
+        vector<hsize_t> start(rank);
+        vector<hsize_t> count(rank);
+        hsize_t num_values = 1;
+        for (int d = 0; d < rank; ++d) {
+            start[d] = position[d];
+            count[d] = (position[d] < dims[d]) ? min(chunk_dims[d], dims[d] - position[d]) : 0;
+            num_values *= count[d];
+        }
+        if (num_values == 0)
+            continue;
+
+        values.resize(num_values);
+        hid_t mspace_id = H5Screate_simple(rank, count.data(), nullptr);
+        herr_t status = H5Sselect_hyperslab(fspace_id, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr);
+        if (status >= 0)
+            status = H5Dread(dataset, H5T_NATIVE_DOUBLE, mspace_id, fspace_id, H5P_DEFAULT, values.data());
+        H5Sclose(mspace_id);
+        if (status < 0) {
+            H5Sclose(fspace_id);
+            throw BESInternalError("Could not read a chunk to compute its statistics.", __FILE__, __LINE__);
+        }
+
+        chunk->set_statistics(compute_chunk_statistics(values, use_fill, fill));
+    }
+
+    H5Sclose(fspace_id);
+}
+
 /**
  * Processes the hdf5 storage information for a variable whose data is stored in the H5D_CHUNKED storage layout.
  * @param dataset The hdf5 dataset that is mate to the BaseType instance btp.
@@ -1072,6 +1202,8 @@ void process_chunked_layout_dariable(hid_t dataset, BaseType *btp, bool disable_
         dc->add_chunk(byte_order, (chunk_udata.chunk_sizes)[i], (chunk_udata.chunk_addrs)[i], (chunk_udata.filter_masks)[i], dmrpp_chunk_coords);
     }
 
+    if (chunk_statistics)
+        add_chunk_statistics(dataset, dc, chunk_dims);
 }
 
 H5D_layout_t get_h5_storage_layout(hid_t dataset){
@@ -2709,12 +2841,22 @@ void inject_build_dmrpp_metadata(DMRpp *dmrpp)
  * be added to the DMR++.
  * @param argc The number of arguments supplied to build_dmrpp
  * @param argv The arguments for build_dmrpp.
+ * @param out Write the DMR++ here.
+ * @param times If not null, record the time spent in each phase here.
  */
 void build_dmrpp_from_dmr_file(const string &dmrpp_href_value, const string &dmr_filename, const string &h5_file_fqn,
-        bool add_production_metadata, const string &bes_conf_file_used_to_create_dmr, bool disable_dio, 
-        bool vlen_in_sc, int argc, char *argv[])
+        bool add_production_metadata, const string &bes_conf_file_used_to_create_dmr, bool disable_dio,
+        bool vlen_in_sc, int argc, char *argv[], ostream &out, phase_times *times)
 {
+    using clock = std::chrono::steady_clock;
+    auto seconds_since = [](clock::time_point start) {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+    phase_times local_times;
+    if (!times) times = &local_times;
+
     // Get dmr:
+    auto start = clock::now();
     DMRpp dmrpp;
     DmrppTypeFactory dtf;
     dmrpp.set_factory(&dtf);
@@ -2722,16 +2864,43 @@ void build_dmrpp_from_dmr_file(const string &dmrpp_href_value, const string &dmr
     ifstream in(dmr_filename.c_str());
     D4ParserSax2 parser;
     parser.intern(in, &dmrpp, false);
+    times->parse_dmr = seconds_since(start);
 
+    start = clock::now();
     add_chunk_information(h5_file_fqn, &dmrpp, disable_dio, vlen_in_sc);
+    times->add_chunks = seconds_since(start);
 
     if (add_production_metadata) {
+        start = clock::now();
         inject_build_dmrpp_metadata(argc, argv, bes_conf_file_used_to_create_dmr, &dmrpp);
+        times->add_metadata = seconds_since(start);
     }
 
+    start = clock::now();
     XMLWriter writer;
     dmrpp.print_dmrpp(writer, dmrpp_href_value);
-    cout << writer.get_doc();
+    times->serialize = seconds_since(start);
+
+    // Write the writer's buffer directly; get_doc() does not copy it.
+    start = clock::now();
+    out << writer.get_doc();
+    out.flush();
+    times->write = seconds_since(start);
+
+    if (!out)
+        throw BESInternalFatalError("Failed to write the DMR++ for '" + h5_file_fqn + "'.", __FILE__, __LINE__);
+}
+
+/**
+ * @brief Builds a DMR++ from an existing DMR file and writes it to stdout.
+ * @see build_dmrpp_from_dmr_file(..., ostream &out, phase_times *times)
+ */
+void build_dmrpp_from_dmr_file(const string &dmrpp_href_value, const string &dmr_filename, const string &h5_file_fqn,
+        bool add_production_metadata, const string &bes_conf_file_used_to_create_dmr, bool disable_dio, 
+        bool vlen_in_sc, int argc, char *argv[])
+{
+    build_dmrpp_from_dmr_file(dmrpp_href_value, dmr_filename, h5_file_fqn, add_production_metadata,
+            bes_conf_file_used_to_create_dmr, disable_dio, vlen_in_sc, argc, argv, cout, nullptr);
 }
 
 
@@ -25,6 +25,7 @@
 #define BES_BUILD_DMRPP_UTIL_H
 
 #include <string>
+#include <ostream>
 
 
 namespace dmrpp {
@@ -35,10 +36,27 @@ namespace build_dmrpp_util {
 
 void add_chunk_information(const std::string &h5_file_name, dmrpp::DMRpp *dmrpp, bool disable_dio, bool vlen_in_sc);
 
+/**
+ * Wall-clock seconds spent in each phase of building one DMR++.
+ */
+struct phase_times {
+    double parse_dmr = 0.0;     ///< Parsing the DMR into a DMRpp
+    double add_chunks = 0.0;    ///< Walking the HDF5 file for chunk/storage information
+    double add_metadata = 0.0;  ///< Injecting the production metadata (-M)
+    double serialize = 0.0;     ///< Serializing the DMR++ XML document
+    double write = 0.0;         ///< Writing the document to the output stream
+
+    double total() const { return parse_dmr + add_chunks + add_metadata + serialize + write; }
+};
+
 void build_dmrpp_from_dmr_file(const string &dmrpp_href_value, const string &dmr_filename, const string &h5_file_fqn,
                                bool add_production_metadata, const string &bes_conf_file_used_to_create_dmr, bool disable_dio,
                                bool vlen_in_sc, int argc, char *argv[]);
 
+void build_dmrpp_from_dmr_file(const string &dmrpp_href_value, const string &dmr_filename, const string &h5_file_fqn,
+                               bool add_production_metadata, const string &bes_conf_file_used_to_create_dmr, bool disable_dio,
+                               bool vlen_in_sc, int argc, char *argv[], std::ostream &out, phase_times *times);
+
 void qc_input_file(const std::string &file_name);
 
 
@@ -47,6 +65,7 @@ void inject_build_dmrpp_metadata(int argc, char **argv, const string &bes_conf_f
 void inject_build_dmrpp_metadata(dmrpp::DMRpp *dmrpp);
 
 extern bool verbose;
+extern bool chunk_statistics;
 }
 
 #endif //BES_BUILD_DMRPP_UTIL_H
@@ -40,6 +40,7 @@
 #include "TheBESKeys.h"
 #include "CurlUtils.h"
 #include "HttpError.h"
+#include "HttpCache.h"
 
 #include "NgapApi.h"
 #include "NgapNames.h"
@@ -501,8 +502,9 @@ NgapApi::DataAccessUrls NgapApi::convert_ngap_resty_path_to_data_access_urls(con
     try {
         BES_PROFILE_TIMING(string("Request granule record from CMR - ") + cmr_query_url);
         // We know that CMR is an EDL authenticated situation, so we create those headers
-        // (if available) and pass them into the http_get() call
-        curl::http_get(cmr_query_url, cmr_json_string, curl::add_edl_auth_headers(nullptr));
+        // (if available) and pass them into the get() call. Unchanged granule records are
+        // read from the persistent HTTP cache, if it is configured.
+        http::HttpCache::TheCache()->get(cmr_query_url, cmr_json_string, curl::add_edl_auth_headers(nullptr));
     }
     catch (http::HttpError &http_error) {
         string err_msg = prolog + "Hyrax encountered a Service Chaining Error while "
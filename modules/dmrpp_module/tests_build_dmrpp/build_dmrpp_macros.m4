@@ -143,6 +143,37 @@ m4_define([AT_BUILD_DMRPP_OPTIONS],  [dnl
     AT_CLEANUP
 ])
 
+dnl Build several DMR++ documents with one batch mode (-b) invocation and compare
+dnl each one with the baseline used by AT_BUILD_DMRPP for the same file.
+dnl Usage: AT_BUILD_DMRPP_BATCH(<test name>, <space separated data files>, <processes>)
+m4_define([AT_BUILD_DMRPP_BATCH],  [dnl
+
+    AT_SETUP([$1])
+    AT_KEYWORDS([build_dmrpp dmrpp batch data dap4 DAP4])
+
+    build_dmrpp_app="${abs_top_builddir}/modules/dmrpp_module/build_dmrpp"
+    build_dmrpp_cmd="${build_dmrpp_app} -j $3 -b batch"
+
+    rm -f batch
+    n=0
+    for f in $2; do
+        n=`expr $n + 1`
+        echo "${abs_top_srcdir}/$f ${abs_top_srcdir}/$f.dmr out_$n.dmrpp" >> batch
+    done
+
+    AS_IF([test -z "$at_verbose"], [echo "COMMAND: ${build_dmrpp_cmd}"])
+
+    AT_CHECK([${build_dmrpp_cmd}], [], [ignore])
+
+    n=0
+    for f in $2; do
+        n=`expr $n + 1`
+        REMOVE_VERSIONS([out_$n.dmrpp])
+        AT_CHECK([diff -b -B ${abs_top_srcdir}/$f.dmrpp.baseline out_$n.dmrpp])
+    done
+
+    AT_CLEANUP
+])
 
 
 dnl Remove path components of DAP DMR Attributes that may vary with builds.
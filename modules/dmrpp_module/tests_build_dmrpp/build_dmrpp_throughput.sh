@@ -0,0 +1,49 @@
+#!/bin/bash
+#
+# Measure build_dmrpp batch mode throughput using the files the build_dmrpp
+# tests use. Each file is listed 'repeat' times in the batch and the batch is
+# run with 1, 2, ... up to 'max processes' processes. The per-file phase
+# timings are written to build_dmrpp_timing_<n>.txt.
+#
+# Usage: build_dmrpp_throughput.sh [build_dmrpp] [repeat] [max processes]
+#
+# Run this from the build directory, e.g.,
+#   ./build_dmrpp_throughput.sh ../build_dmrpp 20 8
+
+build_dmrpp=${1:-../build_dmrpp}
+repeat=${2:-10}
+max_procs=${3:-`getconf _NPROCESSORS_ONLN`}
+
+srcdir=`dirname $0`
+top_srcdir=`cd $srcdir/../../.. && pwd`
+
+if test ! -x "$build_dmrpp"; then
+    echo "Cannot run '$build_dmrpp'; build it first or pass its path as the first argument."
+    exit 1
+fi
+
+work=`mktemp -d ${TMPDIR:-/tmp}/build_dmrpp_throughput.XXXXXX`
+trap "rm -rf $work" EXIT
+
+# The data files from the AT_BUILD_DMRPP tests that are expected to pass.
+files=`sed -n -e '/xfail/d' -e 's/^AT_BUILD_DMRPP(\[\([^]]*\)\])$/\1/p' $srcdir/testsuite.at`
+
+for r in `seq 1 $repeat`; do
+    n=0
+    for f in $files; do
+        n=`expr $n + 1`
+        echo "$top_srcdir/$f $top_srcdir/$f.dmr $work/out_${r}_$n.dmrpp"
+    done
+done > $work/batch
+
+echo "files: `wc -l < $work/batch` (`echo $files | wc -w` distinct, repeated $repeat times)"
+
+procs=1
+while test $procs -le $max_procs; do
+    $build_dmrpp -T -j $procs -b $work/batch 2> $work/timing
+    grep "^build_dmrpp-batch:" $work/timing
+    grep "^build_dmrpp-timing:" $work/timing > build_dmrpp_timing_$procs.txt
+    grep "^ERROR" $work/timing | head -5
+    rm -f $work/out_*.dmrpp
+    procs=`expr $procs \* 2`
+done
@@ -24,7 +24,9 @@
 
 #include "config.h"
 
+#include <cstdlib>
 #include <memory>
+#include <vector>
 
 #include <cppunit/TextTestRunner.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -186,6 +188,65 @@ public:
     }
 
 
+    // The HDF5 library's H5_checksum_fletcher32(); checksum_fletcher32() must match it.
+    static uint32_t hdf5_fletcher32(const uint8_t *data, size_t _len)
+    {
+        size_t len = _len / 2;
+        uint32_t sum1 = 0, sum2 = 0;
+        while (len) {
+            size_t tlen = len > 360 ? 360 : len;
+            len -= tlen;
+            do {
+                sum1 += (uint32_t)(((uint16_t)data[0]) << 8) | ((uint16_t)data[1]);
+                data += 2;
+                sum2 += sum1;
+            } while (--tlen);
+            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+        if (_len % 2) {
+            sum1 += (uint32_t)(((uint16_t)*data) << 8);
+            sum2 += sum1;
+            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        return (sum2 << 16) | sum1;
+    }
+
+    void checksum_fletcher32_test()
+    {
+        CPPUNIT_ASSERT_EQUAL((uint32_t)0x4ff029c7, checksum_fletcher32("abcde", 5));
+        CPPUNIT_ASSERT_EQUAL((uint32_t)0x50562a2d, checksum_fletcher32("abcdef", 6));
+        CPPUNIT_ASSERT_EQUAL((uint32_t)0xe1eb9195, checksum_fletcher32("abcdefgh", 8));
+
+        // Sums that are multiples of 65535 are 0xffff unless they are zero
+        vector<uint8_t> ones(4096, 0xff);
+        CPPUNIT_ASSERT_EQUAL((uint32_t)0xffffffff, checksum_fletcher32(ones.data(), ones.size()));
+        vector<uint8_t> zeros(4096, 0);
+        CPPUNIT_ASSERT_EQUAL((uint32_t)0, checksum_fletcher32(zeros.data(), zeros.size()));
+    }
+
+    void checksum_fletcher32_hdf5_test()
+    {
+        vector<uint8_t> data(300000);
+        srand(42);
+        for (auto &byte: data)
+            byte = (uint8_t)(rand() & 0xff);
+
+        // Sizes around the lanes, groups and blocks
+        for (size_t len: {1, 2, 3, 15, 16, 17, 31, 4095, 4096, 4097, 8193, 65537, 300000}) {
+            DBG(cerr << prolog << "len: " << len << endl);
+            CPPUNIT_ASSERT_EQUAL(hdf5_fletcher32(data.data(), len), checksum_fletcher32(data.data(), len));
+        }
+    }
+
+    void checksum_fletcher32_empty_test()
+    {
+        checksum_fletcher32("", 0);
+    }
+
     void set_position_in_array_test()
     {
         DBG(cerr << prolog << "BEGIN" << endl);
@@ -380,6 +441,10 @@ public:
 
    CPPUNIT_TEST_SUITE( ChunkTest );
 
+    CPPUNIT_TEST(checksum_fletcher32_test);
+    CPPUNIT_TEST(checksum_fletcher32_hdf5_test);
+    CPPUNIT_TEST_EXCEPTION(checksum_fletcher32_empty_test, BESError);
+
     CPPUNIT_TEST(set_position_in_array_test);
     CPPUNIT_TEST(set_position_in_array_test_2);
 
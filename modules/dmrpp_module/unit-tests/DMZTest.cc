@@ -87,6 +87,7 @@ private:
     const string test_simple_6_dmrpp = string(TEST_SRC_DIR).append("/input-files/test_simple_6.xml");
     const string vlsa_element_values_dmrpp = string(TEST_SRC_DIR).append("/input-files/vlsa_element_values.dmrpp");
     const string vlsa_base64_values_dmrpp = string(TEST_SRC_DIR).append("/input-files/vlsa_base64_values.dmrpp");
+    const string chunk_statistics_dmrpp = string(TEST_SRC_DIR).append("/input-files/chunk_statistics.dmrpp");
 
     const string omps = string(TEST_SRC_DIR).append("/input-files/OMPS-NPP_NMTO3-L3-DAILY_v2.1_2018m0102_2018m0104t012837.h5.dmrpp");
     const string s5pnrtil = string(TEST_SRC_DIR).append("/input-files/S5PNRTIL2NO220180422T00470920180422T005209027060100110820180422T022729.nc.h5.dmrpp");
@@ -1008,6 +1009,60 @@ public:
         }
     }
 
+    // The min, max, fillCount, monotonic and hasNaN attributes written by build_dmrpp -S
+    void test_load_chunks_statistics() {
+        try {
+            d_dmz.reset(new DMZ(chunk_statistics_dmrpp));
+            DmrppTypeFactory factory;
+            DMR dmr(&factory);
+            d_dmz->build_thin_dmr(&dmr);
+
+            auto *btp = dmr.root()->find_var("/temperature");
+            CPPUNIT_ASSERT(btp);
+
+            d_dmz->load_chunks(btp);
+
+            auto chunks = dynamic_cast<DmrppCommon *>(btp)->get_immutable_chunks();
+            CPPUNIT_ASSERT(chunks.size() == 4);
+
+            CPPUNIT_ASSERT(chunks.at(0)->has_statistics());
+            const bes::ChunkStatistics &first = chunks.at(0)->get_statistics();
+            CPPUNIT_ASSERT(first.has_values);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, first.min_value, 0.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(9.25, first.max_value, 0.0);
+            CPPUNIT_ASSERT(first.fill_count == 0);
+            CPPUNIT_ASSERT(first.monotonic);
+            CPPUNIT_ASSERT(!first.has_nan);
+
+            CPPUNIT_ASSERT(chunks.at(1)->has_statistics());
+            const bes::ChunkStatistics &second = chunks.at(1)->get_statistics();
+            CPPUNIT_ASSERT(second.has_values);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0, second.min_value, 0.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(12.0, second.max_value, 0.0);
+            CPPUNIT_ASSERT(second.fill_count == 2);
+            CPPUNIT_ASSERT(!second.monotonic);
+            CPPUNIT_ASSERT(second.has_nan);
+
+            // All fill values: no min or max
+            CPPUNIT_ASSERT(chunks.at(2)->has_statistics());
+            CPPUNIT_ASSERT(!chunks.at(2)->get_statistics().has_values);
+            CPPUNIT_ASSERT(chunks.at(2)->get_statistics().fill_count == 10);
+
+            // Without fillCount the other attributes are ignored
+            CPPUNIT_ASSERT(!chunks.at(3)->has_statistics());
+
+            // ...so the array does not have statistics for all of its chunks
+            auto *array = dynamic_cast<DmrppArray *>(btp);
+            CPPUNIT_ASSERT(array);
+            vector<unsigned long long> chunk_shape;
+            vector<bes::ChunkStatistics> stats;
+            CPPUNIT_ASSERT(!array->get_chunk_statistics(chunk_shape, stats));
+        }
+        catch (...) {
+            handle_fatal_exceptions();
+        }
+    }
+
     void test_load_all_attributes_1() {
         try {
             d_dmz.reset(new DMZ(coads_climatology_dmrpp));
@@ -1191,6 +1246,7 @@ CPPUNIT_TEST_SUITE( DMZTest );
 
     CPPUNIT_TEST(test_load_chunks_1);
     CPPUNIT_TEST(test_load_chunks_2);
+    CPPUNIT_TEST(test_load_chunks_statistics);
 
     CPPUNIT_TEST(test_load_all_attributes_1);
 
@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cmath>
 
 #include <unistd.h>
 
@@ -40,8 +41,11 @@
 #include "BESInternalFatalError.h"
 #include "BESNotFoundError.h"
 
+#include "ChunkStatistics.h"
 #include "DMRpp.h"
+#include "DmrppCommon.h"
 #include "DmrppTypeFactory.h"
+#include "Chunk.h"
 
 #include "build_dmrpp_util.h"
 
@@ -62,6 +66,7 @@ namespace build_dmrpp_util {
 short is_hdf5_fill_value_defined(hid_t dataset_id);
 string get_value_as_string(hid_t h5_type_id, vector<char> &value);
 string get_hdf5_fill_value_str(hid_t dataset_id);
+bes::ChunkStatistics compute_chunk_statistics(const vector<double> &values, bool use_fill, double fill);
 
 class build_dmrpp_util_test : public CppUnit::TestFixture {
 private:
@@ -287,6 +292,83 @@ public:
         CPPUNIT_ASSERT_MESSAGE(string(__func__).append(": Expected -99"),
                                get_fill_value_test_helper(fill_value_chunks_file, "/chunks_all_fill", __func__) == "-99");
     }
+    void compute_chunk_statistics_test() {
+        auto stats = compute_chunk_statistics({3, 1, -99, 4, 1, 5}, true, -99);
+        CPPUNIT_ASSERT(stats.has_values);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, stats.min_value, 0.0);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, stats.max_value, 0.0);
+        CPPUNIT_ASSERT(stats.fill_count == 1);
+        CPPUNIT_ASSERT(!stats.monotonic);
+        CPPUNIT_ASSERT(!stats.has_nan);
+
+        // Without a fill value, -99 is a value
+        stats = compute_chunk_statistics({-99, 1, 2, 3}, false, -99);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-99.0, stats.min_value, 0.0);
+        CPPUNIT_ASSERT(stats.fill_count == 0);
+        CPPUNIT_ASSERT(stats.monotonic);
+    }
+
+    void compute_chunk_statistics_test_all_fill() {
+        auto stats = compute_chunk_statistics({-99, -99, -99}, true, -99);
+        CPPUNIT_ASSERT(!stats.has_values);
+        CPPUNIT_ASSERT(stats.fill_count == 3);
+    }
+
+    // NaN is left out of the min and max; the chunk is never marked as non-monotonic
+    void compute_chunk_statistics_test_nan() {
+        auto stats = compute_chunk_statistics({2, NAN, 1, 3}, false, 0);
+        CPPUNIT_ASSERT(stats.has_values);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, stats.min_value, 0.0);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, stats.max_value, 0.0);
+        CPPUNIT_ASSERT(stats.has_nan);
+        CPPUNIT_ASSERT(stats.monotonic);
+
+        // A NaN fill value is counted as fill
+        stats = compute_chunk_statistics({NAN, 1, NAN}, true, NAN);
+        CPPUNIT_ASSERT(stats.fill_count == 2);
+        CPPUNIT_ASSERT(!stats.has_nan);
+    }
+
+    // build_dmrpp -S: the two written chunks of /chunks_some_fill hold 0, 1, 1, 2 and 4, 5, 5, 6
+    void add_chunk_information_test_statistics() {
+        chunk_statistics = true;
+        try {
+            add_chunk_information(fill_value_file_name, fv_dmrpp.get(), false, false);
+        }
+        catch (...) {
+            chunk_statistics = false;
+            throw;
+        }
+        chunk_statistics = false;
+
+        auto *dc = dynamic_cast<DmrppCommon *>(fv_dmrpp->root()->var("chunks_some_fill"));
+        CPPUNIT_ASSERT(dc);
+        auto chunks = dc->get_immutable_chunks();
+        CPPUNIT_ASSERT(chunks.size() == 2);
+
+        CPPUNIT_ASSERT(chunks.at(0)->has_statistics());
+        const auto &first = chunks.at(0)->get_statistics();
+        CPPUNIT_ASSERT(first.has_values);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, first.min_value, 0.0);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, first.max_value, 0.0);
+        CPPUNIT_ASSERT(first.fill_count == 0);
+
+        CPPUNIT_ASSERT(chunks.at(1)->has_statistics());
+        const auto &second = chunks.at(1)->get_statistics();
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, second.min_value, 0.0);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, second.max_value, 0.0);
+    }
+
+    // Without -S no statistics are recorded
+    void add_chunk_information_test_no_statistics() {
+        add_chunk_information(fill_value_file_name, fv_dmrpp.get(), false, false);
+
+        auto *dc = dynamic_cast<DmrppCommon *>(fv_dmrpp->root()->var("chunks_some_fill"));
+        CPPUNIT_ASSERT(dc);
+        for (const auto &chunk: dc->get_immutable_chunks())
+            CPPUNIT_ASSERT(!chunk->has_statistics());
+    }
+
     void vector_init_test() {
 
         vector<string> t1 = {""};
@@ -310,6 +392,12 @@ public:
     CPPUNIT_TEST_SUITE(build_dmrpp_util_test);
 
         CPPUNIT_TEST(vector_init_test);
+
+        CPPUNIT_TEST(compute_chunk_statistics_test);
+        CPPUNIT_TEST(compute_chunk_statistics_test_all_fill);
+        CPPUNIT_TEST(compute_chunk_statistics_test_nan);
+        CPPUNIT_TEST(add_chunk_information_test_statistics);
+        CPPUNIT_TEST(add_chunk_information_test_no_statistics);
         CPPUNIT_TEST(file_and_dmr_test);
 
         CPPUNIT_TEST(test_input_file_signature_no_file);
@@ -0,0 +1,129 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the BES
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Measure what checksums cost, in seconds per GB of data:
+//  - the Fletcher32 checksum the DMR++ handler computes for chunks that use
+//    the HDF5 fletcher32 filter (the HDF5 library's loop and the handler's);
+//  - the CRC32 that libdap's D4StreamMarshaller computes for each variable of
+//    a DAP4 data response when checksums are on (the dap4.checksum context);
+//  - zlib's crc32(), which computes the same CRC32 as libdap.
+//
+// Usage: checksum_benchmark [megabytes] (default 256)
+
+#include "config.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <zlib.h>
+
+#include <libdap/crc.h>
+
+#include "Chunk.h"
+
+using namespace std;
+
+// The HDF5 library's H5_checksum_fletcher32(), the handler's old code
+static uint32_t hdf5_fletcher32(const void *_data, size_t _len)
+{
+    const auto *data = (const uint8_t *)_data;
+    size_t len = _len / 2;
+    uint32_t sum1 = 0, sum2 = 0;
+    while (len) {
+        size_t tlen = len > 360 ? 360 : len;
+        len -= tlen;
+        do {
+            sum1 += (uint32_t)(((uint16_t)data[0]) << 8) | ((uint16_t)data[1]);
+            data += 2;
+            sum2 += sum1;
+        } while (--tlen);
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    }
+    if (_len % 2) {
+        sum1 += (uint32_t)(((uint16_t)*data) << 8);
+        sum2 += sum1;
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    }
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    return (sum2 << 16) | sum1;
+}
+
+// libdap computes the CRC32 as the response is written, a buffer at a time.
+static uint32_t libdap_crc32(const vector<uint8_t> &data)
+{
+    const size_t buffer_size = 64 * 1024;
+    Crc32 crc;
+    for (size_t pos = 0; pos < data.size(); pos += buffer_size)
+        crc.AddData(data.data() + pos, (uint32_t)min(buffer_size, data.size() - pos));
+    return crc.GetCrc32();
+}
+
+static uint32_t zlib_crc32(const vector<uint8_t> &data)
+{
+    const size_t buffer_size = 64 * 1024;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (size_t pos = 0; pos < data.size(); pos += buffer_size)
+        crc = crc32(crc, data.data() + pos, (uInt)min(buffer_size, data.size() - pos));
+    return (uint32_t)crc;
+}
+
+// Run 'checksum' several times and report the best time, per GB
+template<typename F>
+static void time_it(const string &name, const vector<uint8_t> &data, F checksum)
+{
+    double best = 0;
+    uint32_t value = 0;
+    for (int i = 0; i < 5; ++i) {
+        auto start = chrono::steady_clock::now();
+        value = checksum();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+
+    const double gb = data.size() / 1e9;
+    cout << left << setw(28) << name << right << fixed << setprecision(3) << setw(8) << best / gb << " s/GB"
+         << setprecision(2) << setw(10) << gb / best << " GB/s   (0x" << hex << value << dec << ")" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 256;
+    vector<uint8_t> data(megabytes * 1024 * 1024);
+    srand(1);
+    for (auto &byte: data)
+        byte = (uint8_t)(rand() & 0xff);
+
+    cout << "Checksums of " << megabytes << "MB of random data" << endl;
+    time_it("fletcher32 (HDF5)", data, [&data]() { return hdf5_fletcher32(data.data(), data.size()); });
+    time_it("fletcher32 (DMR++ handler)", data, [&data]() { return dmrpp::checksum_fletcher32(data.data(), data.size()); });
+    time_it("crc32 (libdap, DAP4)", data, [&data]() { return libdap_crc32(data); });
+    time_it("crc32 (zlib)", data, [&data]() { return zlib_crc32(data); });
+
+    return 0;
+}
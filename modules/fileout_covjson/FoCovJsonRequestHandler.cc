@@ -42,6 +42,8 @@ using std::map;
 
 bool FoCovJsonRequestHandler::_may_ignore_z_axis   = true;
 bool FoCovJsonRequestHandler::_simple_geo   = true;
+bool FoCovJsonRequestHandler::_stream_data  = false;
+uint64_t FoCovJsonRequestHandler::_stream_max_memory = 65536 * 1024ULL;
 
 /** @brief Constructor for FileOut Coverage JSON module
  *
@@ -64,6 +66,9 @@ FoCovJsonRequestHandler::FoCovJsonRequestHandler(const string &name) :
     if (has_key) 
         _simple_geo = key_value;  
 
+    _stream_data = TheBESKeys::read_bool_key("FoCovJson.StreamData", false);
+    _stream_max_memory = TheBESKeys::read_uint64_key("FoCovJson.StreamMaxMemoryKB", 65536) * 1024;
+
 #if 0
 if(_may_ignore_z_axis == true) 
 std::cerr<<"IGNORE mode "<<endl;
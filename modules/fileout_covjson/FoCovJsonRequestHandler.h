@@ -29,6 +29,8 @@
 #ifndef I_FoCovJsonRequestHandler_H
 #define I_FoCovJsonRequestHandler_H 1
 
+#include <cstdint>
+
 #include "BESRequestHandler.h"
 #include <BESUtil.h>
 #include <TheBESKeys.h>
@@ -46,6 +48,8 @@ class FoCovJsonRequestHandler: public BESRequestHandler {
 private:
     static bool _may_ignore_z_axis;
     static bool _simple_geo;
+    static bool _stream_data;
+    static uint64_t _stream_max_memory;
 public:
     FoCovJsonRequestHandler(const std::string &name);
     virtual ~FoCovJsonRequestHandler(void);
@@ -54,6 +58,8 @@ public:
 
     static bool get_may_ignore_z_axis() { return _may_ignore_z_axis; }
     static bool get_simple_geo() { return _simple_geo; }
+    static bool get_stream_data() { return _stream_data; }
+    static uint64_t get_stream_max_memory() { return _stream_max_memory; }
     static bool build_help(BESDataHandlerInterface &dhi);
     static bool build_version(BESDataHandlerInterface &dhi);
 };
@@ -73,6 +73,7 @@ using std::istringstream;
 
 #include <BESDebug.h>
 #include <BESInternalError.h>
+#include <BESDapArraySlabReader.h>
 #include <DapFunctionUtils.h>
 #include <RequestServiceTimer.h>
 #include "FoDapCovJsonTransform.h"
@@ -346,6 +347,76 @@ unsigned int FoDapCovJsonTransform::covjsonSimpleTypeArrayWorker(ostream *strm,
     return indx;
 }
 
+template<typename T>
+void FoDapCovJsonTransform::covjsonStreamedTypeArray(ostream *strm, libdap::Array *a)
+{
+    int numDim = a->dimensions(true);
+    vector<unsigned int> shape(numDim);
+    focovjson::computeConstrainedShape(a, &shape);
+
+    BESDapArraySlabReader reader(a, _max_slab_bytes);
+    vector<T> src;
+
+    for (unsigned int row = 0; row < reader.rows();) {
+        unsigned int num_rows = reader.read_slab(row);
+        src.resize(a->length());
+        a->value(src.data());
+
+        // Format each slab the same way covjsonSimpleTypeArray() formats a whole array.
+        vector<unsigned int> slab_shape = shape;
+        slab_shape[0] = num_rows;
+        ostringstream pstrm;
+        covjsonSimpleTypeArrayWorker(&pstrm, src.data(), 0, &slab_shape, 0, false, a->var()->type());
+
+        if (row > 0)
+            *strm << ", ";
+        *strm << pstrm.str();
+
+        row += num_rows;
+
+        // Hand this slab to the transmit stream before reading the next one.
+        strm->flush();
+    }
+}
+
+void FoDapCovJsonTransform::printDeferredParameterValues(ostream *strm, libdap::Array *a)
+{
+    RequestServiceTimer::TheTimer()->throw_if_timeout_expired(prolog + "ERROR: bes-timeout expired before transmit " + a->name(), __FILE__, __LINE__);
+
+    switch (a->var()->type()) {
+    case libdap::dods_byte_c:
+        covjsonStreamedTypeArray<libdap::dods_byte>(strm, a);
+        break;
+
+    case libdap::dods_int16_c:
+        covjsonStreamedTypeArray<libdap::dods_int16>(strm, a);
+        break;
+
+    case libdap::dods_uint16_c:
+        covjsonStreamedTypeArray<libdap::dods_uint16>(strm, a);
+        break;
+
+    case libdap::dods_int32_c:
+        covjsonStreamedTypeArray<libdap::dods_int32>(strm, a);
+        break;
+
+    case libdap::dods_uint32_c:
+        covjsonStreamedTypeArray<libdap::dods_uint32>(strm, a);
+        break;
+
+    case libdap::dods_float32_c:
+        covjsonStreamedTypeArray<libdap::dods_float32>(strm, a);
+        break;
+
+    case libdap::dods_float64_c:
+        covjsonStreamedTypeArray<libdap::dods_float64>(strm, a);
+        break;
+
+    default:
+        throw BESInternalError("File out COVJSON, cannot stream the values of " + a->name(), __FILE__, __LINE__);
+    }
+}
+
 template<typename T>
 void FoDapCovJsonTransform::covjsonSimpleTypeArray(ostream *strm, libdap::Array *a, string indent, bool sendData)
 {
@@ -385,6 +456,9 @@ void FoDapCovJsonTransform::covjsonSimpleTypeArray(ostream *strm, libdap::Array
             if (sendData) {
                 currAxis->values += "\"values\": [";
                 unsigned int indx = 0;
+                // Axis values are needed as text before the coverage is printed.
+                if (!a->read_p())
+                    a->read();
                 vector<T> src(length);
                 a->value(src.data());
 
@@ -456,7 +530,11 @@ cerr<<"Parameter name is "<< currParameter->name<<endl;
         }
         currParameter->shape += "],";
 
-        if (sendData) {
+        if (sendData && !a->read_p()) {
+            // Streaming: the values are read and written by printRanges().
+            currParameter->deferred_values = a;
+        }
+        else if (sendData) {
             currParameter->values += "\"values\": [";
             unsigned int indx = 0;
             vector<T> src(length);
@@ -1557,7 +1635,14 @@ void FoDapCovJsonTransform::printRanges(ostream *strm, string indent)
             if (parameters[i]->shape!="")
                 *strm << child_indent2 << parameters[i]->shape << endl;
         }
-        *strm << child_indent2 << parameters[i]->values << endl;
+        if (parameters[i]->deferred_values) {
+            *strm << child_indent2 << "\"values\": [";
+            printDeferredParameterValues(strm, parameters[i]->deferred_values);
+            *strm << "]" << endl;
+        }
+        else {
+            *strm << child_indent2 << parameters[i]->values << endl;
+        }
 
         if(i == parameterCount - 1) {
             *strm << child_indent1 << "}" << endl;
@@ -2899,6 +2984,9 @@ void FoDapCovJsonTransform::obtain_bound_values(libdap::DDS *dds, const axisVar
 //cerr<<"d_a->name in obtain_bound_values is "<<d_a->name() <<endl;
 //cerr<<"in obtain_bound_values bnd_dim_name is "<<bnd_dim_name <<endl;
 #endif
+        if(sendData && !d_a->read_p())
+            d_a->read();
+
         if(d_a->var()->type_name() == "Float64") {
             if(sendData) {
                 int num_lengths = d_a->length();
@@ -2940,6 +3028,9 @@ void FoDapCovJsonTransform::obtain_bound_values(libdap::DDS *dds, const axisVar
 cerr<<"d_a->name in obtain_bound_values is "<<d_a->name() <<endl;
 cerr<<"in obtain_bound_values bnd_dim_name is "<<bnd_dim_name <<endl;
 #endif
+        if(sendData && !d_a->read_p())
+            d_a->read();
+
         if(d_a->var()->type_name() == "Float64") {
             if(sendData) {
                 int num_lengths = d_a->length();
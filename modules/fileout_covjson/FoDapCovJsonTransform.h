@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 
 #include <BESObj.h>
 
@@ -59,6 +60,7 @@ private:
     libdap::DMR *_dmr;
     std::string _returnAs;
     std::string _indent_increment = "  ";
+    uint64_t _max_slab_bytes = 0;
     std::string atomicVals;
     std::string currDataType;
     std::string domainType = "Unknown";
@@ -86,6 +88,8 @@ private:
         std::string standardName;
         std::string shape;
         std::string values;
+        // When streaming, the values are not read until the ranges are printed.
+        libdap::Array *deferred_values = nullptr;
     };
 
     unsigned int axisCount = 0;
@@ -530,6 +534,18 @@ private:
      *
      * @returns the most recently completed index
      */
+    /**
+     * @brief Writes the values of a Parameter whose data were not read, reading
+     *   them one slab of the outer dimension at a time.
+     *
+     * @param strm Write to this output stream
+     * @param a The Parameter's source array; its data must not have been read
+     */
+    void printDeferredParameterValues(std::ostream *strm, libdap::Array *a);
+
+    template<typename T>
+    void covjsonStreamedTypeArray(std::ostream *strm, libdap::Array *a);
+
     template<typename T>
     unsigned int covjsonSimpleTypeArrayWorker(std::ostream *strm, T *values, unsigned int indx,
         std::vector<unsigned int> *shape, unsigned int currentDim, bool is_axis_t_sgeo,libdap::Type a_type);
@@ -592,6 +608,15 @@ public:
     virtual void transform(std::ostream &ostrm, bool sendData, bool testOverride);
     virtual void transform_dap4(std::ostream &ostrm, bool sendData, bool testOverride);
 
+    /**
+     * @brief Sets the memory budget used to write Parameters whose data have
+     *   not been read when the transform reaches them.
+     *
+     * Such Parameters are read and written in slabs of at most this many bytes
+     * while the ranges are printed. Zero reads them in one piece.
+     */
+    void set_max_slab_bytes(uint64_t max_slab_bytes) { _max_slab_bytes = max_slab_bytes; }
+
     /**
      * @brief Get the CovJSON encoding for a DDS
      *
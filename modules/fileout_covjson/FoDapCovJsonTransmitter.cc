@@ -42,6 +42,8 @@
 #include <fstream>
 
 #include <libdap/DataDDS.h>
+#include <libdap/DMR.h>
+#include <libdap/D4Group.h>
 #include <libdap/BaseType.h>
 #include <libdap/escaping.h>
 #include <libdap/ConstraintEvaluator.h>
@@ -59,9 +61,11 @@
 #include <BESDapResponseBuilder.h>
 #include <BESDebug.h>
 #include <DapFunctionUtils.h>
+#include <DapUtils.h>
 
 #include "FoDapCovJsonTransmitter.h"
 #include "FoDapCovJsonTransform.h"
+#include "FoCovJsonRequestHandler.h"
 
 using namespace ::libdap;
 
@@ -134,12 +138,19 @@ void FoDapCovJsonTransmitter::send_data(BESResponseObject *obj, BESDataHandlerIn
         // Note that the BESResponseObject will manage the loaded_dds object's
         // memory. Make this a shared_ptr<>. jhrg 9/6/16
 
-        // TODO improve this pattern by enabling reading then transforming one varaible
-        // at a time so that the whole dataset is not loaded into memory. jhrg 6/11/20
+        // When FoCovJson.StreamData is set, Arrays bigger than the streaming budget
+        // are not read here; the transform reads them in slabs as it writes them.
         DDS *loaded_dds;
         try {
             // Added this try block to debug memory use issues in this handler. jhrg 6/11/20
-            loaded_dds = responseBuilder.intern_dap2_data(obj, dhi);
+            if (FoCovJsonRequestHandler::get_stream_data()) {
+                loaded_dds = responseBuilder.setup_dap2_intern_data(obj, dhi);
+                auto bdds = dynamic_cast<BESDataDDSResponse *>(obj);
+                dap_utils::intern_data_up_to(*loaded_dds, bdds->get_ce(), FoCovJsonRequestHandler::get_stream_max_memory());
+            }
+            else {
+                loaded_dds = responseBuilder.intern_dap2_data(obj, dhi);
+            }
         }
         catch(std::exception &e) {
             throw BESSyntaxUserError(string("Caught a C++ standard exception in responseBuilder.intern_dap2_data. The error was: ").append(e.what()), __FILE__, __LINE__);
@@ -150,6 +161,7 @@ void FoDapCovJsonTransmitter::send_data(BESResponseObject *obj, BESDataHandlerIn
             throw BESInternalError("Output stream is not set, can not return as COVJSON", __FILE__, __LINE__);
 
         FoDapCovJsonTransform ft(loaded_dds);
+        ft.set_max_slab_bytes(FoCovJsonRequestHandler::get_stream_max_memory());
         ft.transform(o_strm, true, false); // Send metadata and data; Test override false
         //ft.transform(o_strm, true, false); // Send metadata and data; Test override false
     }
@@ -251,12 +263,17 @@ void FoDapCovJsonTransmitter::send_dap4data(BESResponseObject *obj, BESDataHandl
         // Note that the BESResponseObject will manage the loaded_dds object's
         // memory. Make this a shared_ptr<>. jhrg 9/6/16
 
-        // TODO improve this pattern by enabling reading then transforming one varaible
-        // at a time so that the whole dataset is not loaded into memory. jhrg 6/11/20
+        // See send_data() for FoCovJson.StreamData
         DMR *loaded_dmr;
         try {
             // Added this try block to debug memory use issues in this handler. jhrg 6/11/20
-            loaded_dmr = responseBuilder.intern_dap4_data(obj, dhi);
+            if (FoCovJsonRequestHandler::get_stream_data()) {
+                loaded_dmr = responseBuilder.process_dap4_dmr(obj, dhi);
+                dap_utils::intern_data_up_to(loaded_dmr->root(), FoCovJsonRequestHandler::get_stream_max_memory());
+            }
+            else {
+                loaded_dmr = responseBuilder.intern_dap4_data(obj, dhi);
+            }
         }
         catch(std::exception &e) {
             throw BESSyntaxUserError(string("Caught a C++ standard exception in responseBuilder.intern_dap4_data. The error was: ").append(e.what()), __FILE__, __LINE__);
@@ -267,6 +284,7 @@ void FoDapCovJsonTransmitter::send_dap4data(BESResponseObject *obj, BESDataHandl
             throw BESInternalError("Output stream is not set, can not return as COVJSON", __FILE__, __LINE__);
 
         FoDapCovJsonTransform ft(loaded_dmr);
+        ft.set_max_slab_bytes(FoCovJsonRequestHandler::get_stream_max_memory());
         ft.transform_dap4(o_strm, true, false); // Send metadata and data; Test override false
     }
     catch (Error &e) {
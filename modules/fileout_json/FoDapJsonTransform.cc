@@ -55,6 +55,7 @@ using std::istringstream;
 
 #include <BESDebug.h>
 #include <BESInternalError.h>
+#include <BESDapArraySlabReader.h>
 
 #include "BESUtil.h"
 #include "RequestServiceTimer.h"
@@ -104,6 +105,54 @@ unsigned int FoDapJsonTransform::json_simple_type_array_worker(ostream *strm, T
     return indx;
 }
 
+/**
+ * Writes the values of a DAP Array of simple types. If the Array's data have been
+ * read, they are written from memory. Otherwise the Array is read one slab of its
+ * outer dimension at a time and each slab is written and released before the next
+ * is read, so that large Arrays can be sent without holding all of their values.
+ *
+ * @return The number of values written
+ */
+template<typename T>
+unsigned int FoDapJsonTransform::json_simple_type_array_data(ostream *strm, libdap::Array *a, long length,
+    vector<unsigned int> *shape)
+{
+    if (a->read_p()) {
+        vector<T> src(length);
+        a->value(src.data());
+        return json_simple_type_array_worker(strm, src.data(), 0, shape, 0);
+    }
+
+    BESDapArraySlabReader reader(a, _max_slab_bytes);
+    vector<T> src;
+    unsigned int indx = 0;
+
+    *strm << "[";
+    for (unsigned int row = 0; row < reader.rows();) {
+        unsigned int num_rows = reader.read_slab(row);
+        src.resize(a->length());
+        a->value(src.data());
+
+        unsigned int slab_indx = 0;
+        for (unsigned int r = 0; r < num_rows; ++r) {
+            if (row + r) *strm << ", ";
+            if (shape->size() > 1)
+                slab_indx = json_simple_type_array_worker<T>(strm, src.data(), slab_indx, shape, 1);
+            else
+                *strm << src[slab_indx++];
+        }
+
+        indx += slab_indx;
+        row += num_rows;
+
+        // Hand this slab to the transmit stream before reading the next one.
+        strm->flush();
+    }
+    *strm << "]";
+
+    return indx;
+}
+
 /**
  * Writes the json representation of the passed DAP Array of simple types. If the
  * parameter "sendData" evaluates to true then data will also be sent.
@@ -134,8 +183,6 @@ void FoDapJsonTransform::json_simple_type_array(ostream *strm, libdap::Array *a,
         // Data
         *strm << childindent << "\"data\": ";
         unsigned int indx = 0;
-        vector<T> src(length);
-        a->value(src.data());
 
         // I added this, and a corresponding block in FoInstance... because I fixed
         // an issue in libdap::Float64 where the precision was not properly reset
@@ -145,7 +192,7 @@ void FoDapJsonTransform::json_simple_type_array(ostream *strm, libdap::Array *a,
         if (typeid(T) == typeid(libdap::dods_float64)) {
             streamsize prec = strm->precision(int_64_precision);
             try {
-                indx = json_simple_type_array_worker(strm, src.data(), 0, &shape, 0);
+                indx = json_simple_type_array_data<T>(strm, a, length, &shape);
                 strm->precision(prec);
             }
             catch(...) {
@@ -154,7 +201,7 @@ void FoDapJsonTransform::json_simple_type_array(ostream *strm, libdap::Array *a,
             }
         }
         else {
-            indx = json_simple_type_array_worker(strm, src.data(), 0, &shape, 0);
+            indx = json_simple_type_array_data<T>(strm, a, length, &shape);
         }
 
         assert(length == indx);
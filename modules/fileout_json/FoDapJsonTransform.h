@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 
 #include <BESObj.h>
 
@@ -53,6 +54,7 @@ private:
     libdap::DDS *_dds;
     std::string _returnAs;
     std::string _indent_increment;
+    uint64_t _max_slab_bytes = 0;
 
     void writeNodeMetadata(std::ostream *strm, libdap::BaseType *bt, std::string indent);
     void writeLeafMetadata(std::ostream *strm, libdap::BaseType *bt, std::string indent);
@@ -78,6 +80,10 @@ private:
 
     void json_string_array(std::ostream *strm, libdap::Array *a, std::string indent, bool sendData);
 
+    template<typename T>
+    unsigned int json_simple_type_array_data(std::ostream *strm, libdap::Array *a, long length,
+        std::vector<unsigned int> *shape);
+
     template<typename T>
     unsigned int json_simple_type_array_worker(std::ostream *strm, T *values, unsigned int indx,
         std::vector<unsigned int> *shape, unsigned int currentDim);
@@ -88,6 +94,13 @@ public:
 
     virtual void transform(std::ostream &ostrm, bool sendData);
 
+    /**
+     * Arrays whose data have not been read when the transform reaches them are
+     * read and written in slabs of at most this many bytes. Zero reads such an
+     * Array in one piece.
+     */
+    void set_max_slab_bytes(uint64_t max_slab_bytes) { _max_slab_bytes = max_slab_bytes; }
+
     void dump(std::ostream &strm) const override;
 };
 
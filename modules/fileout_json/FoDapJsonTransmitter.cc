@@ -58,9 +58,11 @@
 #include <BESDapResponseBuilder.h>
 #include <BESDebug.h>
 #include <DapFunctionUtils.h>
+#include <DapUtils.h>
 
 #include "FoDapJsonTransmitter.h"
 #include "FoDapJsonTransform.h"
+#include "FoJsonRequestHandler.h"
 
 using namespace ::libdap;
 
@@ -132,13 +134,24 @@ void FoDapJsonTransmitter::send_data(BESResponseObject *obj, BESDataHandlerInter
         // from the DataHandlerInterface to load the DDS with values.
         // Note that the BESResponseObject will manage the loaded_dds object's
         // memory. Make this a shared_ptr<>. jhrg 9/6/16
-        DDS *loaded_dds = responseBuilder.intern_dap2_data(obj, dhi);
+        DDS *loaded_dds = nullptr;
+        if (FoJsonRequestHandler::get_stream_data()) {
+            // Read only the variables that fit in the streaming budget; the
+            // transform reads the rest in slabs as it writes them.
+            loaded_dds = responseBuilder.setup_dap2_intern_data(obj, dhi);
+            auto bdds = dynamic_cast<BESDataDDSResponse *>(obj);
+            dap_utils::intern_data_up_to(*loaded_dds, bdds->get_ce(), FoJsonRequestHandler::get_stream_max_memory());
+        }
+        else {
+            loaded_dds = responseBuilder.intern_dap2_data(obj, dhi);
+        }
 
         ostream &o_strm = dhi.get_output_stream();
         if (!o_strm)
             throw BESInternalError("Output stream is not set, can not return as JSON", __FILE__, __LINE__);
 
         FoDapJsonTransform ft(loaded_dds);
+        ft.set_max_slab_bytes(FoJsonRequestHandler::get_stream_max_memory());
 
         ft.transform(o_strm, true /* send data */);
     }
@@ -49,6 +49,7 @@
 #include <BESDebug.h>
 #include "BESUtil.h"
 #include <BESInternalError.h>
+#include <BESDapArraySlabReader.h>
 #include "RequestServiceTimer.h"
 
 #include "FoInstanceJsonTransform.h"
@@ -95,6 +96,53 @@ unsigned int FoInstanceJsonTransform::json_simple_type_array_worker(std::ostream
     return indx;
 }
 
+/**
+ * Writes the values of a DAP Array of simple types. If the Array's data have been
+ * read, they are written from memory. Otherwise the Array is read one slab of its
+ * outer dimension at a time and each slab is written and released before the next
+ * is read.
+ *
+ * @return The number of values written
+ */
+template<typename T>
+unsigned int FoInstanceJsonTransform::json_simple_type_array_data(std::ostream *strm, libdap::Array *a, long length,
+    const std::vector<unsigned int> &shape)
+{
+    if (a->read_p()) {
+        vector<T> src(length);
+        a->value(src.data());
+        return json_simple_type_array_worker(strm, src, 0, shape, 0);
+    }
+
+    BESDapArraySlabReader reader(a, _max_slab_bytes);
+    vector<T> src;
+    unsigned int indx = 0;
+
+    *strm << "[";
+    for (unsigned int row = 0; row < reader.rows();) {
+        unsigned int num_rows = reader.read_slab(row);
+        src.resize(a->length());
+        a->value(src.data());
+
+        unsigned int slab_indx = 0;
+        for (unsigned int r = 0; r < num_rows; ++r) {
+            if (row + r) *strm << ", ";
+            if (shape.size() > 1)
+                slab_indx = json_simple_type_array_worker(strm, src, slab_indx, shape, 1);
+            else
+                *strm << src[slab_indx++];
+        }
+
+        indx += slab_indx;
+        row += num_rows;
+
+        strm->flush();
+    }
+    *strm << "]";
+
+    return indx;
+}
+
 /**
  * @brief Writes out (in a JSON instance object representation) the metadata and data values for the passed array of simple types.
  *
@@ -113,15 +161,12 @@ template<typename T> void FoInstanceJsonTransform::json_simple_type_array(std::o
         std::vector<unsigned int> shape(a->dimensions(true));
         long length = fojson::computeConstrainedShape(a, &shape);
 
-        vector<T> src(length);
-        a->value(src.data());
-
         unsigned int indx = 0;
 
         if (typeid(T) == typeid(libdap::dods_float64)) {
             streamsize prec = strm->precision(int_64_precision);
             try {
-                indx = json_simple_type_array_worker(strm, src, 0, shape, 0);
+                indx = json_simple_type_array_data<T>(strm, a, length, shape);
                 strm->precision(prec);
             }
             catch (...) {
@@ -130,7 +175,7 @@ template<typename T> void FoInstanceJsonTransform::json_simple_type_array(std::o
             }
         }
         else {
-            indx = json_simple_type_array_worker(strm, src, 0, shape, 0);
+            indx = json_simple_type_array_data<T>(strm, a, length, shape);
         }
 
         // make this an assert?
@@ -29,6 +29,7 @@
 #ifndef FoInstanceJsonTransfrom_h_
 #define FoInstanceJsonTransfrom_h_ 1
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -57,12 +58,15 @@ private:
     // std::string _localfile;
     std::string _returnAs;
     std::string _indent_increment;
+    uint64_t _max_slab_bytes = 0;
 
     // std::ostream *_ostrm;
 
     template<typename T> unsigned int json_simple_type_array_worker(std::ostream *strm, const std::vector<T> &values,
         unsigned int indx, const std::vector<unsigned int> &shape, unsigned int currentDim);
 
+    template<typename T> unsigned int json_simple_type_array_data(std::ostream *strm, libdap::Array *a, long length,
+        const std::vector<unsigned int> &shape);
     template<typename T> void json_simple_type_array(std::ostream *strm, libdap::Array *a, std::string indent,
         bool sendData);
     void json_string_array(std::ostream *strm, libdap::Array *a, std::string indent, bool sendData);
@@ -85,6 +89,13 @@ public:
 
     virtual void transform(std::ostream &ostrm, bool sendData);
 
+    /**
+     * Arrays whose data have not been read when the transform reaches them are
+     * read and written in slabs of at most this many bytes. Zero reads such an
+     * Array in one piece.
+     */
+    void set_max_slab_bytes(uint64_t max_slab_bytes) { _max_slab_bytes = max_slab_bytes; }
+
     void dump(std::ostream &strm) const override;
 };
 
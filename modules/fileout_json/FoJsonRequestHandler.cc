@@ -40,6 +40,13 @@ using std::ostream;
 using std::string;
 using std::map;
 
+#define FOJSON_STREAM_DATA_KEY "FoJson.StreamData"
+#define FOJSON_STREAM_MAX_MEMORY_KB_KEY "FoJson.StreamMaxMemoryKB"
+#define FOJSON_STREAM_MAX_MEMORY_KB 65536
+
+bool FoJsonRequestHandler::_stream_data = false;
+uint64_t FoJsonRequestHandler::_stream_max_memory = FOJSON_STREAM_MAX_MEMORY_KB * 1024ULL;
+
 /** @brief Constructor for FileOut NetCDF module
  *
  * This constructor adds functions to add to the build of a help request
@@ -53,6 +60,9 @@ FoJsonRequestHandler::FoJsonRequestHandler(const string &name) :
 {
     add_method( HELP_RESPONSE, FoJsonRequestHandler::build_help);
     add_method( VERS_RESPONSE, FoJsonRequestHandler::build_version);
+
+    _stream_data = TheBESKeys::read_bool_key(FOJSON_STREAM_DATA_KEY, false);
+    _stream_max_memory = TheBESKeys::read_uint64_key(FOJSON_STREAM_MAX_MEMORY_KB_KEY, FOJSON_STREAM_MAX_MEMORY_KB) * 1024;
 }
 
 /** @brief Any cleanup that needs to take place
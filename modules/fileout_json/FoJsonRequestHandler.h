@@ -29,6 +29,8 @@
 #ifndef I_FoJsonRequestHandler_H
 #define I_FoJsonRequestHandler_H 1
 
+#include <cstdint>
+
 #include "BESRequestHandler.h"
 
 /** @brief A Request Handler for the Fileout NetCDF request
@@ -39,12 +41,21 @@
  * here.
  */
 class FoJsonRequestHandler: public BESRequestHandler {
+private:
+    static bool _stream_data;
+    static uint64_t _stream_max_memory;
+
 public:
     FoJsonRequestHandler(const std::string &name);
     virtual ~FoJsonRequestHandler(void);
 
     void dump(std::ostream &strm) const override;
 
+    /// @return True if data responses should read and write big Arrays in slabs
+    static bool get_stream_data() { return _stream_data; }
+    /// @return The memory budget, in bytes, for one slab when streaming data
+    static uint64_t get_stream_max_memory() { return _stream_max_memory; }
+
     static bool build_help(BESDataHandlerInterface &dhi);
     static bool build_version(BESDataHandlerInterface &dhi);
 };
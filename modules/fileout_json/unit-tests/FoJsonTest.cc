@@ -29,6 +29,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <math.h>       /* atan */
 #include <vector>
+#include <sstream>
 
 #include <unistd.h>
 #include <libdap/DataDDS.h>
@@ -69,6 +70,33 @@ static bool debug = false;
 
 namespace fojson {
 
+/**
+ * A 2D Int32 Array whose read() honors the constraint. Each value is the
+ * element's index in the unconstrained array, so a response built from slabs
+ * can be compared with one built from the whole array.
+ */
+class IndexArray: public libdap::Array {
+public:
+    IndexArray(const string &n, libdap::BaseType *v) : libdap::Array(n, v) { }
+    libdap::BaseType *ptr_duplicate() override { return new IndexArray(*this); }
+
+    bool read() override
+    {
+        Dim_iter rows = dim_begin();
+        Dim_iter cols = rows + 1;
+        int ncols = dimension_size(cols, false);
+
+        vector<libdap::dods_int32> values;
+        for (int r = dimension_start(rows, true); r <= dimension_stop(rows, true); r += dimension_stride(rows, true))
+            for (int c = dimension_start(cols, true); c <= dimension_stop(cols, true); c += dimension_stride(cols, true))
+                values.push_back(r * ncols + c);
+
+        set_value(values, values.size());
+        set_read_p(true);
+        return true;
+    }
+};
+
 class FoJsonTest: public CppUnit::TestFixture {
 
 private:
@@ -139,6 +167,8 @@ CPPUNIT_TEST_SUITE( FoJsonTest );
     CPPUNIT_TEST(test_abstract_object_data_representation);
     CPPUNIT_TEST(test_instance_object_metadata_representation);
     CPPUNIT_TEST(test_instance_object_data_representation);
+    CPPUNIT_TEST(test_streamed_array_data);
+    CPPUNIT_TEST(test_streamed_instance_array_data);
 
     CPPUNIT_TEST_SUITE_END()
     ;
@@ -462,6 +492,80 @@ CPPUNIT_TEST_SUITE( FoJsonTest );
         return dds;
     }
 
+    /**
+     * Build the JSON data response for a 7x5 IndexArray, constrained to
+     * [1:2:5][0:1:4]. When max_slab_bytes is zero the data are read before the
+     * transform runs; otherwise the transform reads them in slabs.
+     */
+    template<class Transform>
+    string streamed_array_json(uint64_t max_slab_bytes)
+    {
+        libdap::DataDDS dds(nullptr, "StreamDataset");
+        libdap::Int32 tmplt("index");
+        IndexArray a("index", &tmplt);
+        a.append_dim(7, "rows");
+        a.append_dim(5, "cols");
+        dds.add_var(&a);
+
+        auto ia = dynamic_cast<libdap::Array *>(dds.var("index"));
+        ia->set_send_p(true);
+        ia->add_constraint(ia->dim_begin(), 1, 2, 5);
+
+        if (max_slab_bytes == 0)
+            ia->read();
+
+        Transform ft(&dds);
+        ft.set_max_slab_bytes(max_slab_bytes);
+
+        std::ostringstream oss;
+        ft.transform(oss, true);
+
+        // The slab reader must leave the constraint as it found it.
+        CPPUNIT_ASSERT_EQUAL(1, ia->dimension_start(ia->dim_begin(), true));
+        CPPUNIT_ASSERT_EQUAL(5, ia->dimension_stop(ia->dim_begin(), true));
+
+        return oss.str();
+    }
+
+    template<class Transform>
+    void check_streamed_array_data()
+    {
+        string baseline = streamed_array_json<Transform>(0);
+        DBG(cerr << "check_streamed_array_data() - baseline: " << baseline << endl);
+        CPPUNIT_ASSERT(baseline.find("[[5, 6, 7, 8, 9], [15, 16, 17, 18, 19], [25, 26, 27, 28, 29]]") != string::npos);
+
+        // One row (5 Int32 values) per slab, two rows per slab and all the rows in one slab.
+        CPPUNIT_ASSERT_EQUAL(baseline, streamed_array_json<Transform>(1));
+        CPPUNIT_ASSERT_EQUAL(baseline, streamed_array_json<Transform>(40));
+        CPPUNIT_ASSERT_EQUAL(baseline, streamed_array_json<Transform>(1024));
+    }
+
+    void test_streamed_array_data()
+    {
+        try {
+            check_streamed_array_data<FoDapJsonTransform>();
+        }
+        catch (BESInternalError &e) {
+            CPPUNIT_FAIL("BESInternalError: " + e.get_message());
+        }
+        catch (libdap::Error &e) {
+            CPPUNIT_FAIL("Error: " + e.get_error_message());
+        }
+    }
+
+    void test_streamed_instance_array_data()
+    {
+        try {
+            check_streamed_array_data<FoInstanceJsonTransform>();
+        }
+        catch (BESInternalError &e) {
+            CPPUNIT_FAIL("BESInternalError: " + e.get_message());
+        }
+        catch (libdap::Error &e) {
+            CPPUNIT_FAIL("Error: " + e.get_error_message());
+        }
+    }
+
     libdap::DataDDS *makeTestDDS()
     {
         // build a DataDDS of simple types and set values for each of the
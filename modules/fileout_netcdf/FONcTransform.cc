@@ -60,6 +60,8 @@
 #include <BESDebug.h>
 #include <BESInternalError.h>
 #include <BESInternalFatalError.h>
+#include <BESTrace.h>
+#include <BESMemoryLedger.h>
 #include "BESSyntaxUserError.h"
 #include "RequestServiceTimer.h"
 
@@ -87,6 +89,20 @@ using namespace std;
 #define MSG_LABEL_CLASSIC_MODEL " (classic model)"
 #define MSG_LABEL_SIXTYFOUR_BIT_MODEL " (64-bit offset model)"
 
+// The variables are written to the file, and their data released, one at a
+// time, so the largest one is all the memory the file needs. A reservation
+// made before server functions ran covers what they read; keep only that.
+static void reserve_largest_var(BESMemoryLedger::Reservation &reservation, uint64_t largest_var)
+{
+    if (largest_var <= reservation.bytes()) {
+        reservation.trim(largest_var);
+    }
+    else {
+        reservation.release();
+        reservation = BESMemoryLedger::TheLedger()->admit(largest_var, largest_var);
+    }
+}
+
 /** @brief Constructor that creates transformation object from the specified BESResponseObject object to the specified file
  *
  * @param dds DataDDS object that contains the data structure, attributes
@@ -283,6 +299,7 @@ void FONcTransform::throw_if_dap2_response_too_big(DDS *dds, const string &dap2_
  * top level of the DataDDS.
  */
 void FONcTransform::transform_dap2() {
+    BES_TRACE_SPAN("fileout_netcdf", "transform DAP2");
 
     BESDEBUG(MODULE, prolog << "BEGIN" << endl);
     BESDEBUG(MODULE, prolog << "Reading data into DataDDS" << endl);
@@ -319,9 +336,16 @@ void FONcTransform::transform_dap2() {
     // If there are functions, parse them and eval.
     // Use that DDS and parse the non-function ce
     // Serialize using the second ce and the second dds
+    BESMemoryLedger::Reservation reservation;
     if (!besDRB.get_btp_func_ce().empty()) {
         BESDEBUG(MODULE,  prolog << "Found function(s) in CE: " << besDRB.get_btp_func_ce() << endl);
 
+        // The functions read their arguments and build their results here,
+        // so reserve memory for the input variables first.
+        uint64_t largest_input = 0;
+        const uint64_t input = dap_utils::compute_unconstrained_memory_estimate(_dds->variables(), largest_input);
+        reservation = BESMemoryLedger::TheLedger()->admit(input, largest_input);
+
         BESDapFunctionResponseCache *responseCache = BESDapFunctionResponseCache::get_instance();
 
         ConstraintEvaluator func_eval;
@@ -366,6 +390,15 @@ void FONcTransform::transform_dap2() {
     throw_if_dap2_response_too_big(_dds, besDRB.get_ce());
     dap_utils::throw_for_dap4_typed_vars_or_attrs(_dds,__FILE__,__LINE__);
 
+    vector<BaseType *> sent_vars;
+    for (auto vi = _dds->var_begin(), ve = _dds->var_end(); vi != ve; vi++) {
+        if ((*vi)->send_p())
+            sent_vars.push_back(*vi);
+    }
+    uint64_t largest_var = 0;
+    dap_utils::compute_memory_estimate(sent_vars, largest_var);
+    reserve_largest_var(reservation, largest_var);
+
     // Convert the DDS into an internal format to keep track of
     // variables, arrays, shared dimensions, grids, common maps,
     // embedded structures. It only grabs the variables that are to be
@@ -459,6 +492,7 @@ void FONcTransform::transform_dap2() {
             fbt->set_dds(_dds);
             fbt->set_eval(&eval);
 
+            BES_TRACE_SPAN("fileout_netcdf", "write " + fbt->name());
             fbt->write(_ncid);
             nc_sync(_ncid);
         }
@@ -511,12 +545,23 @@ void FONcTransform::throw_if_dap4_response_too_big(DMR *dmr, const string &dap4_
  * top level of the DMR.
  */
 void FONcTransform::transform_dap4() {
+    BES_TRACE_SPAN("fileout_netcdf", "transform DAP4");
     BESDEBUG(MODULE,  prolog << "BEGIN" << endl);
 
     FONcUtils::reset();
 
     d_dhi->first_container();
 
+    // Any server functions are evaluated by setup_dap4_intern_data(), so
+    // reserve memory for the variables they can read first.
+    BESMemoryLedger::Reservation reservation;
+    auto bdmr = dynamic_cast<BESDMRResponse *>(d_obj);
+    if (bdmr && bdmr->get_dmr() && !d_dhi->data[DAP4_FUNCTION].empty()) {
+        uint64_t largest_input = 0;
+        const uint64_t input = dap_utils::compute_unconstrained_memory_estimate(bdmr->get_dmr()->root(), largest_input);
+        reservation = BESMemoryLedger::TheLedger()->admit(input, largest_input);
+    }
+
     BESDapResponseBuilder responseBuilder;
     _dmr = responseBuilder.setup_dap4_intern_data(d_obj, *d_dhi).release();
 
@@ -548,6 +593,11 @@ void FONcTransform::transform_dap4() {
 
     throw_if_dap4_response_too_big(_dmr,responseBuilder.get_dap4ce() );
 
+    // As for DAP2, the variables are written one at a time.
+    uint64_t largest_var = 0;
+    dap_utils::compute_memory_estimate(_dmr->root(), largest_var);
+    reserve_largest_var(reservation, largest_var);
+
     BESDapResponseBuilder besDRB;
 
     besDRB.set_dataset_name(_dmr->filename());
@@ -906,6 +956,7 @@ void FONcTransform::transform_dap4_no_group() {
             FONcBaseType *fbt = *i;
             RequestServiceTimer::TheTimer()->throw_if_timeout_expired(prolog + "ERROR: bes-timeout expired before transmitting: " + fbt->name() , __FILE__, __LINE__);
             BESDEBUG(MODULE, prolog << "Writing data for variable:  " << fbt->name() << endl);
+            BES_TRACE_SPAN("fileout_netcdf", "write " + fbt->name());
             fbt->write(_ncid);
         }
 
@@ -1150,6 +1201,7 @@ void FONcTransform::transform_dap4_group_internal(D4Group *d4_grp,
             FONcBaseType *fbt = *i;
             RequestServiceTimer::TheTimer()->throw_if_timeout_expired(prolog + "ERROR: bes-timeout expired before transmitting: " + fbt->name() , __FILE__, __LINE__);
             BESDEBUG(MODULE, prolog << "Writing data for variable:  " << fbt->name() << endl);
+            BES_TRACE_SPAN("fileout_netcdf", "write " + fbt->name());
             fbt->write(nc4_grp_id);
         }
 
@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include <cassert>
+#include <climits>
 #include <sstream>
 #include <memory>
 
@@ -44,163 +45,120 @@
 #include <BESDebug.h>
 
 #include "BBoxFunction.h"
-#include "Odometer.h"
 #include "roi_util.h"
-
-// Set this to 1 to use special code for arrays of rank 1 and 2.
-// set it to 0 (... comment out, etc.) to use the general code for
-// all cases. I've run the unit and regression tests both ways.
-// jhrg 3/2/15
-#define UNWIND_BBOX_CODE 1
+#include "functions_util.h"
+#include "array_kernels.h"
 
 using namespace std;
 using namespace libdap;
 
 namespace functions {
 
-unique_ptr<Array> bbox_helper(double min_value, double max_value, Array* the_array)
+/**
+ * @brief Find the bounding box of the values in [min_value, max_value]
+ *
+ * @param min_value
+ * @param max_value
+ * @param the_array Look at these values; use its current constraint
+ * @param origin If not empty, the index of the constraint's first element
+ * in each dimension. It is added to the indices of the bounding box so they
+ * are relative to the whole Array.
+ * @return The bounding box
+ */
+unique_ptr<Array> bbox_helper(double min_value, double max_value, Array* the_array,
+    const vector<unsigned int> &origin = vector<unsigned int>())
 {
-    // Get the values as doubles
-    vector<double> the_values;
-    extract_double_array(the_array, the_values); // This function sets the size of the_values
-
-    // Build the response
-    unsigned int rank = the_array->dimensions();
-    unique_ptr<Array> response = roi_bbox_build_empty_bbox(rank, the_array->name());
-
-    switch (rank) {
-    case 1: {
-        unsigned int X = the_array->dimension_size(the_array->dim_begin());
-        bool found_start = false;
-        unsigned int start = 0;
-        for (unsigned int i = 0; i < X && !found_start; ++i) {
-            if (the_values[i] >= min_value && the_values[i] <= max_value) {
-                start = i;
-                found_start = true;
-            }
-        }
-        // ! found_start == error?
-        if (!found_start) {
-            ostringstream oss("In function bbox(): No values between ", std::ios::ate);
-            oss << min_value << " and " << max_value << " were found in the array '" << the_array->name() << "'";
-            throw Error(oss.str());
-        }
-        bool found_stop = false;
-        unsigned int stop = X - 1;
-        for (int i = X - 1; i >= 0 && !found_stop; --i) {
-            if (the_values[i] >= min_value && the_values[i] <= max_value) {
-                stop = (unsigned int) (i);
-                found_stop = true;
-            }
-        }
-        // ! found_stop == error?
-        if (!found_stop) throw InternalErr(__FILE__, __LINE__, "In BBoxFunction: Found start but not stop.");
+    auto offset = [&origin](unsigned int d) -> unsigned int { return origin.empty() ? 0 : origin.at(d); };
 
-        Structure* slice = roi_bbox_build_slice(start, stop, the_array->dimension_name(the_array->dim_begin()));
-        response->set_vec_nocopy(0, slice);
-        break;
+    // Scan the values in the Array's buffer using their own type. The
+    // callers only pass Arrays of numeric types; an empty Array has no
+    // buffer and so holds no values in the range.
+    vector<uint64_t> shape;
+    for (Array::Dim_iter i = the_array->dim_begin(), e = the_array->dim_end(); i != e; ++i)
+        shape.push_back(the_array->dimension_size_ll(i, true));
+
+    vector<uint64_t> start, stop;
+    bool found = false;
+    with_numeric_values(the_array, [&](auto *values) {
+        found = bbox_kernel(values, shape, min_value, max_value, start, stop);
+    });
+
+    if (!found) {
+        ostringstream oss("In function bbox(): No values between ", std::ios::ate);
+        oss << min_value << " and " << max_value << " were found in the array '" << the_array->name() << "'";
+        throw Error(oss.str());
     }
-    case 2: {
-        // quick reminder: rows == y == j; cols == x == i
-        Array::Dim_iter rows = the_array->dim_begin(), cols = the_array->dim_begin() + 1;
-        unsigned int Y = the_array->dimension_size(rows);
-        unsigned int X = the_array->dimension_size(cols);
-        unsigned int x_start = X - 1; //= 0;
-        unsigned int y_start = 0;
-        bool found_y_start = false;
-        // Must look at all rows to find the 'left-most' col with value
-        for (unsigned int j = 0; j < Y; ++j) {
-            bool found_x_start = false;
-            for (unsigned int i = 0; i < X && !found_x_start; ++i) {
-                unsigned int ind = j * X + i;
-                if (the_values[ind] >= min_value && the_values[ind] <= max_value) {
-                    x_start = min(i, x_start);
-                    found_x_start = true;
-                    if (!found_y_start) {
-                        y_start = j;
-                        found_y_start = true;
-                    }
-                }
-            }
-        }
-        // ! found_y_start == error?
-        if (!found_y_start) {
-            ostringstream oss("In function bbox(): No values between ", std::ios::ate);
-            oss << min_value << " and " << max_value << " were found in the array '" << the_array->name() << "'";
-            throw Error(oss.str());
-        }
-        unsigned int x_stop = 0;
-        unsigned int y_stop = 0;
-        bool found_y_stop = false;
-        // Must look at all rows to find the 'left-most' col with value
-        for (int j = Y - 1; j >= (int) (y_start); --j) {
-            bool found_x_stop = false;
-            for (int i = X - 1; i >= 0 && !found_x_stop; --i) {
-                unsigned int ind = j * X + i;
-                if (the_values[ind] >= min_value && the_values[ind] <= max_value) {
-                    x_stop = max((unsigned int) (i), x_stop);
-                    found_x_stop = true;
-                    if (!found_y_stop) {
-                        y_stop = j;
-                        found_y_stop = true;
-                    }
-                }
-            }
-        }
-        // ! found_stop == error?
-        if (!found_y_stop) throw InternalErr(__FILE__, __LINE__, "In BBoxFunction: Found start but not stop.");
 
-        response->set_vec_nocopy(0, roi_bbox_build_slice(y_start, y_stop, the_array->dimension_name(rows)));
-        response->set_vec_nocopy(1, roi_bbox_build_slice(x_start, x_stop, the_array->dimension_name(cols)));
-        break;
+    unique_ptr<Array> response = roi_bbox_build_empty_bbox(shape.size(), the_array->name());
+    unsigned int d = 0;
+    for (Array::Dim_iter i = the_array->dim_begin(), e = the_array->dim_end(); i != e; ++i, ++d) {
+        response->set_vec_nocopy(d, roi_bbox_build_slice(start[d] + offset(d), stop[d] + offset(d),
+                                                         the_array->dimension_name(i)));
     }
-    default: {
-        Odometer::shape shape(rank); // the shape of 'the_array'
-        int j = 0;
-        for (Array::Dim_iter i = the_array->dim_begin(), e = the_array->dim_end(); i != e; ++i) {
-            shape.at(j++) = the_array->dimension_size(i);
-        }
-        Odometer odometer(shape);
-        Odometer::shape indices(rank); // Holds a given index
-        Odometer::shape min = shape; // Holds the minimum values for each of rank dimensions
-        Odometer::shape max(rank, 0); // ... and the maximum. min and max define the bounding box
-        // NB: shape is initialized with the size of the array
-        do {
-            if (the_values[odometer.offset()] >= min_value && the_values[odometer.offset()] <= max_value) {
-                // record this index
-                odometer.indices(indices);
-                Odometer::shape::iterator m = min.begin();
-                Odometer::shape::iterator x = max.begin();
-                for (Odometer::shape::iterator i = indices.begin(), e = indices.end(); i != e; ++i, ++m, ++x) {
-                    if (*i < *m) *m = *i;
-
-                    if (*i > *x) *x = *i;
-                }
-            }
-        } while (odometer.next() != odometer.end());
-        // cheap test for 'did we find any values.' If we did, then the
-        // min index will have to be less than the shape (which is the
-        // size of the array). We only need to test one of the indices.
-        if (min[0] == shape[0]) {
-            ostringstream oss("In function bbox(): No values between ", std::ios::ate);
-            oss << min_value << " and " << max_value << " were found in the array '" << the_array->name() << "'";
-            throw Error(oss.str());
-        }
-        Odometer::shape::iterator m = min.begin();
-        Odometer::shape::iterator x = max.begin();
-        Array::Dim_iter d = the_array->dim_begin();
-        for (unsigned int i = 0; i < rank; ++i, ++m, ++x, ++d) {
-            response->set_vec_nocopy(i, roi_bbox_build_slice(*m, *x, the_array->dimension_name(d)));
-        }
-        break;
-    } // default
-    } // switch
 
     response->set_read_p(true);
     response->set_send_p(true);
     return response;
 }
 
+/**
+ * @brief Use chunk statistics to find the part of an Array that can hold
+ * values in [min_value, max_value]
+ *
+ * A chunk is a candidate if its range of values overlaps [min_value, max_value]
+ * or if it holds fill values and the fill value is in that range. The box
+ * returned is the smallest one that holds all of the candidate chunks.
+ *
+ * @param the_array
+ * @param min_value
+ * @param max_value
+ * @param start Value-result; the first index of the box in each dimension
+ * @param stop Value-result; the last index of the box in each dimension
+ * @return False if there are no chunk statistics or they cannot exclude
+ * any part of the Array, true if start and stop were set. If they were set
+ * and start is empty, no chunk can hold a value in the range.
+ */
+static bool find_candidate_chunks(Array *the_array, double min_value, double max_value,
+    vector<unsigned int> &start, vector<unsigned int> &stop)
+{
+    array_chunk_stats_t stats;
+    if (!get_array_chunk_stats(the_array, stats))
+        return false;
+
+    const bool fill_in_range = stats.has_fill && stats.fill_value >= min_value && stats.fill_value <= max_value;
+    // Chunks that are not listed hold only the fill value, but they could be anywhere
+    if (stats.implicit_chunks > 0 && (!stats.has_fill || fill_in_range))
+        return false;
+
+    const unsigned long rank = stats.shape.size();
+    vector<unsigned long long> first(rank, ULLONG_MAX);
+    vector<unsigned long long> last(rank, 0);
+    bool found = false;
+    for (const auto &chunk: stats.chunks) {
+        bool candidate = (chunk.has_values && chunk.max_value >= min_value && chunk.min_value <= max_value)
+            || (chunk.fill_count > 0 && fill_in_range);
+        if (!candidate)
+            continue;
+
+        found = true;
+        for (unsigned long d = 0; d < rank; ++d) {
+            first[d] = min(first[d], chunk.position[d]);
+            last[d] = max(last[d], min(chunk.position[d] + stats.chunk_shape[d], stats.shape[d]) - 1);
+        }
+    }
+
+    start.clear();
+    stop.clear();
+    if (found) {
+        for (unsigned long d = 0; d < rank; ++d) {
+            start.push_back(static_cast<unsigned int>(first[d]));
+            stop.push_back(static_cast<unsigned int>(last[d]));
+        }
+    }
+
+    return true;
+}
+
 /**
  * @brief Return the bounding box for an array
  *
@@ -249,13 +207,51 @@ function_dap2_bbox(int argc, BaseType *argv[], DDS &, BaseType **btpp)
     Array *the_array = static_cast<Array*>(argv[0]);
     BESDEBUG("bbox", "the_array: " << the_array->name() << ": " << (void*)the_array << endl);
 
+    double min_value = extract_double_value(argv[1]);
+    double max_value = extract_double_value(argv[2]);
+
+    // If the handler recorded chunk statistics, read only the chunks that
+    // can hold values in the range. The constraint is removed once the
+    // bounding box is found so the variable can still be read whole.
+    vector<unsigned int> start, stop;
+    if (!the_array->read_p() && find_candidate_chunks(the_array, min_value, max_value, start, stop)) {
+        if (start.empty()) {
+            ostringstream oss("In function bbox(): No values between ", std::ios::ate);
+            oss << min_value << " and " << max_value << " were found in the array '" << the_array->name() << "'";
+            throw Error(oss.str());
+        }
+
+        unsigned int d = 0;
+        for (Array::Dim_iter i = the_array->dim_begin(), e = the_array->dim_end(); i != e; ++i, ++d)
+            the_array->add_constraint(i, start.at(d), 1, stop.at(d));
+
+        BESDEBUG("bbox", "Reading part of " << the_array->name() << " (" << the_array->length_ll() << " elements)" << endl);
+
+        unique_ptr<Array> response;
+        try {
+            the_array->read();
+            the_array->set_read_p(true);
+            response = bbox_helper(min_value, max_value, the_array, start);
+        }
+        catch (...) {
+            the_array->clear_local_data();
+            the_array->set_read_p(false);
+            the_array->reset_constraint();
+            throw;
+        }
+
+        the_array->clear_local_data();
+        the_array->set_read_p(false);
+        the_array->reset_constraint();
+
+        *btpp = response.release();
+        return;
+    }
+
     // Read the variable into memory
     the_array->read();
     the_array->set_read_p(true);
 
-    double min_value = extract_double_value(argv[1]);
-    double max_value = extract_double_value(argv[2]);
-
     // Get the values as doubles
     unique_ptr<Array> response = bbox_helper(min_value, max_value, the_array);
 
@@ -52,6 +52,7 @@
 #include "IdentityFunction.h"
 #include "DapFunctionsRequestHandler.h"
 #include "DapFunctions.h"
+#include "array_kernels.h"
 
 #if HAVE_STARE
 #include "stare/StareFunctions.h"
@@ -115,6 +116,8 @@ void DapFunctions::initialize(const string &modname)
     stare_sidecar_suffix = TheBESKeys::TheKeys()->read_string_key(STARE_SIDECAR_SUFFIX_KEY, stare_sidecar_suffix);
 #endif
 
+    kernel_max_threads = TheBESKeys::TheKeys()->read_ulong_key(FUNCTIONS_MAX_THREADS_KEY, kernel_max_threads);
+
 #if HAVE_GDAL
     libdap::ServerFunctionsList::TheList()->add_function(new ScaleArray());
     libdap::ServerFunctionsList::TheList()->add_function(new ScaleGrid());
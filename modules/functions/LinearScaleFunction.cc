@@ -43,6 +43,7 @@
 #include "BESDebug.h"
 
 #include "LinearScaleFunction.h"
+#include "array_kernels.h"
 
 using namespace libdap;
 
@@ -144,6 +145,27 @@ static double get_missing_value(BaseType *var)
     return get_attribute_double_value(var, "missing_value");
 }
 
+/**
+ * @brief Scale the values of an Array that has been read
+ * @param a The Array
+ * @param m
+ * @param b
+ * @return The values 'y = mx + b' in a new array of doubles; the caller must delete[] it.
+ */
+static double *scale_array_values(Array *a, double m, double b)
+{
+    int length = a->length();
+    double *data = new double[length];
+    if (!with_numeric_values(a, [&](auto *values) { linear_scale_kernel(values, data, length, m, b); })) {
+        delete[] data;
+        data = extract_double_array(a);
+        for (int i = 0; i < length; ++i)
+            data[i] = data[i] * m + b;
+    }
+
+    return data;
+}
+
 BaseType *function_linear_scale_worker(BaseType *bt, double m, double b, double missing, bool use_missing)
 {
     // Read the data, scale and return the result. Must replace the new data
@@ -166,12 +188,10 @@ BaseType *function_linear_scale_worker(BaseType *bt, double m, double b, double
         // Get the Array part and read the values
         Array *a = source.get_array();
         //a->read();
-        data = extract_double_array(a);
 
         // Now scale the data.
+        data = scale_array_values(a, m, b);
         int length = a->length();
-        for (int i = 0; i < length; ++i)
-            data[i] = data[i] * m + b;
 
         // Copy source Grid to result Grid. Could improve on this by not using this
         // trick since it copies all of 'source' to 'dest', including the main Array.
@@ -202,10 +222,8 @@ BaseType *function_linear_scale_worker(BaseType *bt, double m, double b, double
         else
             source.read();
 
-        data = extract_double_array(&source);
+        data = scale_array_values(&source, m, b);
         int length = source.length();
-        for (int i = 0; i < length; ++i)
-            data[i] = data[i] * m + b;
 
         Array *result = new Array(source);
 
@@ -51,6 +51,7 @@
 
 #include "MakeArrayFunction.h"
 #include "functions_util.h"
+#include "array_kernels.h"
 
 using namespace libdap;
 
@@ -61,11 +62,117 @@ string mask_array_info =
                 + "<function name=\"mask_array\" version=\"1.0\" href=\"http://docs.opendap.org/index.php/Server_Side_Processing_Functions#mask_array\">\n"
                 + "</function>";
 
+/**
+ * Find the smallest box, in the shape of the array, that holds all of the
+ * set elements of the mask.
+ *
+ * @param array The data array; it must not be constrained
+ * @param mask The mask
+ * @param start Value-result; the first index of the box in each dimension.
+ * Empty if no element of the mask is set.
+ * @param stop Value-result; the last index of the box in each dimension
+ * @return False if the box is the whole array, true otherwise
+ */
+static bool find_mask_box(Array *array, const vector<dods_byte> &mask, vector<unsigned long long> &start,
+    vector<unsigned long long> &stop)
+{
+    vector<unsigned long long> shape;
+    for (Array::Dim_iter d = array->dim_begin(), e = array->dim_end(); d != e; ++d)
+        shape.push_back(array->dimension_size_ll(d, true));
+
+    const unsigned long rank = shape.size();
+    start = shape;
+    stop.assign(rank, 0);
+    bool found = false;
+
+    vector<unsigned long long> index(rank, 0);
+    for (vector<dods_byte>::size_type m = 0; m < mask.size(); ++m) {
+        if (mask[m]) {
+            found = true;
+            for (unsigned long d = 0; d < rank; ++d) {
+                start[d] = min(start[d], index[d]);
+                stop[d] = max(stop[d], index[d]);
+            }
+        }
+        // Advance the index, rightmost dimension varies fastest
+        for (unsigned long d = rank; d-- > 0;) {
+            if (++index[d] < shape[d]) break;
+            index[d] = 0;
+        }
+    }
+
+    if (!found) {
+        start.clear();
+        stop.clear();
+        return true;
+    }
+
+    for (unsigned long d = 0; d < rank; ++d) {
+        if (start[d] != 0 || stop[d] != shape[d] - 1)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Read only the part of the array that holds the set elements of the mask
+ * and return the masked values for the whole array. When the data are
+ * chunked, the chunks outside of that part are never read.
+ */
+template <typename T>
+static void masked_box_values(Array *array, double no_data_value, const vector<dods_byte> &mask,
+    const vector<unsigned long long> &start, const vector<unsigned long long> &stop, vector<T> &data)
+{
+    data.assign(mask.size(), static_cast<T>(no_data_value));
+    if (start.empty())
+        return;
+
+    const unsigned long rank = start.size();
+    vector<unsigned long long> shape;
+    unsigned int d = 0;
+    for (Array::Dim_iter i = array->dim_begin(), e = array->dim_end(); i != e; ++i, ++d) {
+        shape.push_back(array->dimension_size_ll(i, true));
+        array->add_constraint(i, static_cast<int>(start[d]), 1, static_cast<int>(stop[d]));
+    }
+
+    vector<T> box;
+    try {
+        array->read();
+        array->set_read_p(true);
+        box.resize(array->length_ll());
+        array->value(box.data());
+    }
+    catch (...) {
+        array->clear_local_data();
+        array->set_read_p(false);
+        array->reset_constraint();
+        throw;
+    }
+    array->clear_local_data();
+    array->reset_constraint();
+
+    // Copy the box values where the mask is set
+    vector<unsigned long long> index(start);
+    for (typename vector<T>::size_type b = 0; b < box.size(); ++b) {
+        unsigned long long offset = 0;
+        for (unsigned long i = 0; i < rank; ++i)
+            offset = offset * shape[i] + index[i];
+        if (mask[offset]) data[offset] = box[b];
+
+        for (unsigned long i = rank; i-- > 0;) {
+            if (++index[i] <= stop[i]) break;
+            index[i] = start[i];
+        }
+    }
+}
+
 /**
  * Helper for the DAP2 and DAP4 server functions.
  *
  * After the server functions have done their QC, apply the mask to the
- * data array, altering its values in place.
+ * data array, altering its values in place. If the array has not been read
+ * and the mask selects only part of it, only that part is read.
  *
  * @note Assume the array, mask and no_data_value have been QC'd and are valid.
  *
@@ -76,9 +183,27 @@ string mask_array_info =
 template <typename T>
 void mask_array_helper(Array *array, double no_data_value, const vector<dods_byte> &mask)
 {
+    // If the mask selects only part of the array, read just that part.
+    vector<unsigned long long> start, stop;
+    if (!array->read_p() && is_unconstrained(array) && find_mask_box(array, mask, start, stop)) {
+        BESDEBUG("functions", "mask_array_helper() - reading part of " << array->name() << endl);
+        vector<T> data;
+        masked_box_values<T>(array, no_data_value, mask, start, stop, data);
+        array->set_value(data, data.size());
+        array->set_read_p(true);
+        return;
+    }
+
     // Read the data array's data
     array->read();
     array->set_read_p(true);
+
+    // Mask the values in place when they are in the array's buffer
+    if (array->get_buf() && (vector<dods_byte>::size_type)array->length_ll() == mask.size()) {
+        mask_kernel(reinterpret_cast<T*>(array->get_buf()), mask.data(), mask.size(), no_data_value);
+        return;
+    }
+
     vector<T> data(array->length());
     array->value(data.data());
 
@@ -25,6 +25,7 @@
 
 #include "config.h"
 
+#include <cmath>
 #include <sstream>
 
 #include <libdap/BaseType.h>
@@ -46,6 +47,8 @@
 #include "BESDebug.h"
 
 #include "RangeFunction.h"
+#include "functions_util.h"
+#include "array_kernels.h"
 
 using namespace libdap;
 
@@ -167,66 +170,87 @@ static double get_missing_value(BaseType *var)
  */
 min_max_t find_min_max(double* data, int length, bool use_missing, double missing)
 {
-    min_max_t v;
-    double previous_value;
-    bool increasing, previously_increasing;
+    return find_min_max_kernel(data, length, use_missing, missing);
+}
 
-    v.monotonic = true;
-    previous_value = data[0];
+/**
+ * @brief Find the min and max values using the Array's chunk statistics
+ *
+ * This reads no data. It returns the same values find_min_max() would for
+ * the whole Array or, when it cannot be sure of that, returns false so the
+ * caller can read the data.
+ *
+ * The statistics exclude the fill value, so it is added back unless it is
+ * also the missing value. The monotonic property can only be shown to be
+ * false: that takes a chunk whose values change direction and whose elements
+ * are contiguous in the Array (so the values are compared in the same order
+ * find_min_max() uses).
+ *
+ * @param a The Array
+ * @param use_missing True if values matching missing should be excluded
+ * @param missing The missing value
+ * @param v Value-result parameter for the min, max and monotonic values
+ * @return True if v was set, false otherwise
+ */
+static bool find_min_max_from_chunk_stats(Array *a, bool use_missing, double missing, min_max_t &v)
+{
+    array_chunk_stats_t stats;
+    if (!get_array_chunk_stats(a, stats))
+        return false;
+
+    BESDEBUG("function", "find_min_max_from_chunk_stats() - " << a->name() << ": " << stats.chunks.size()
+            << " chunks, " << stats.implicit_chunks << " implicit chunks" << endl);
+
+    // Chunks that are not listed hold the fill value; we need to know it.
+    if (stats.implicit_chunks > 0 && !stats.has_fill)
+        return false;
+
+    // find_min_max() compares values to the missing value using double_eq(),
+    // which is not exact. Unless the missing value is well outside of the
+    // values in every chunk, the result depends on the data.
+    const bool exclude_fill = use_missing && stats.has_fill && double_eq(stats.fill_value, missing);
     if (use_missing) {
-        for (int i = 0; i < length; ++i) {
-            if (!double_eq(data[i], missing)) {
-                if(v.monotonic && i>0){
-                    increasing = (data[i] - previous_value) > 0.0;
-                    if(i>1){
-                        if(previously_increasing!=increasing){
-                            v.monotonic = false;
-                        }
-                    }
-                    previously_increasing = increasing;
-                    previous_value = data[i];
-                }
-                v.max_val = max(v.max_val, data[i]);
-                v.min_val = min(v.min_val, data[i]);
-            }
+        const double tolerance = 1.0e-4 * max(1.0, fabs(missing));
+        for (const auto &chunk: stats.chunks) {
+            if (chunk.has_values && missing >= chunk.min_value - tolerance && missing <= chunk.max_value + tolerance)
+                return false;
         }
     }
-    else {
-        for (int i = 0; i < length; ++i) {
-            if(v.monotonic && i>0){
-                increasing = (data[i] - previous_value) > 0.0;
-                if(i>1){
-                    if(previously_increasing!=increasing){
-                        v.monotonic = false;
-                    }
-                }
-                previously_increasing = increasing;
-                previous_value = data[i];
-            }
-            v.max_val = max(v.max_val, data[i]);
-            v.min_val = min(v.min_val, data[i]);
-        }
+
+    // Contiguous in the Array means the chunk spans all but the first dimension.
+    bool chunks_are_contiguous = true;
+    for (unsigned long i = 1; i < stats.shape.size(); ++i) {
+        if (stats.chunk_shape[i] < stats.shape[i])
+            chunks_are_contiguous = false;
     }
 
-#if 0
-    for (int i = 0; i < length; ++i) {
-        if (!use_missing || !double_eq(data[i], missing)) {
-            if(v.monotonic && i>0){
-                increasing = (data[i] - previous_value) > 0.0;
-                if(i>1){
-                    if(previously_increasing!=increasing){
-                        v.monotonic = false;
-                    }
-                }
-                previously_increasing = increasing;
-                previous_value = data[i];
-            }
-            v.max_val = max(v.max_val, data[i]);
-            v.min_val = min(v.min_val, data[i]);
+    min_max_t result;
+    bool has_fill_values = stats.implicit_chunks > 0;
+    bool not_monotonic = false;
+    for (const auto &chunk: stats.chunks) {
+        if (chunk.has_values) {
+            result.max_val = max(result.max_val, chunk.max_value);
+            result.min_val = min(result.min_val, chunk.min_value);
         }
+        if (chunk.fill_count > 0)
+            has_fill_values = true;
+        if (chunks_are_contiguous && !chunk.monotonic && !chunk.has_nan && (chunk.fill_count == 0 || exclude_fill))
+            not_monotonic = true;
     }
-#endif
-    return v;
+
+    if (!not_monotonic)
+        return false;
+
+    // NaN is ignored by find_min_max() (max() and min() return their first argument)
+    if (has_fill_values && !exclude_fill && !std::isnan(stats.fill_value)) {
+        result.max_val = max(result.max_val, stats.fill_value);
+        result.min_val = min(result.min_val, stats.fill_value);
+    }
+
+    result.monotonic = false;
+    v = result;
+
+    return true;
 }
 
 // TODO Modify this to include information about monotonicity of vectors.
@@ -249,7 +273,15 @@ BaseType *range_worker(BaseType *bt, double missing, bool use_missing)
 
     min_max_t v;
 
-    if (bt->type() == dods_grid_c) {
+    if (bt->type() == dods_grid_c && !bt->read_p()
+        && find_min_max_from_chunk_stats(dynamic_cast<Grid&>(*bt).get_array(), use_missing, missing, v)) {
+        BESDEBUG("function", "range_worker() - Used chunk statistics for " << bt->name() << ": " << v << endl);
+    }
+    else if (bt->is_vector_type() && !bt->read_p()
+        && find_min_max_from_chunk_stats(&dynamic_cast<Array&>(*bt), use_missing, missing, v)) {
+        BESDEBUG("function", "range_worker() - Used chunk statistics for " << bt->name() << ": " << v << endl);
+    }
+    else if (bt->type() == dods_grid_c) {
         // Grab the whole Grid; note that the scaling is done only on the array part
         Grid &source = dynamic_cast<Grid&>(*bt);
 
@@ -261,16 +293,18 @@ BaseType *range_worker(BaseType *bt, double missing, bool use_missing)
         source.set_send_p(true);
         source.read();
 
-        // Get the Array part and read the values
+        // Get the Array part and determine the range.
         Array *a = source.get_array();
-        double *data = extract_double_array(a);
-
-        // Now determine the range.
-        int length = a->length();
+        if (!with_numeric_values(a, [&](auto *values) {
+                v = find_min_max_kernel(values, a->length_ll(), use_missing, missing);
+            })) {
+            double *data = extract_double_array(a);
+            int length = a->length();
 
-        v = find_min_max(data, length, use_missing, missing);
+            v = find_min_max(data, length, use_missing, missing);
 
-        delete[] data;
+            delete[] data;
+        }
     }
     else if (bt->is_vector_type()) {
         Array &source = dynamic_cast<Array&>(*bt);
@@ -283,14 +317,17 @@ BaseType *range_worker(BaseType *bt, double missing, bool use_missing)
         else
             source.read();
 
-        double *data = extract_double_array(&source);
-
         // Now determine the range.
-        int length = source.length();
+        if (!with_numeric_values(&source, [&](auto *values) {
+                v = find_min_max_kernel(values, source.length_ll(), use_missing, missing);
+            })) {
+            double *data = extract_double_array(&source);
+            int length = source.length();
 
-        v = find_min_max(data, length, use_missing, missing);
+            v = find_min_max(data, length, use_missing, missing);
 
-        delete[] data;
+            delete[] data;
+        }
     }
     else if (bt->is_simple_type() && !(bt->type() == dods_str_c || bt->type() == dods_url_c)) {
         double data = extract_double_value(bt);
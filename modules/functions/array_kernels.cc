@@ -0,0 +1,128 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ implementation of the OPeNDAP
+// Hyrax data server
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Authors: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <thread>
+#include <vector>
+
+#include "array_kernels.h"
+
+using namespace std;
+
+namespace functions {
+
+unsigned int kernel_max_threads = 0;    // Optionally set by DapFunctions::initialize()
+
+/**
+ * @brief How many parts should an array of 'length' values be split into?
+ * @param length Number of values
+ * @return The number of threads to use, at least one
+ */
+unsigned int kernel_thread_count(uint64_t length)
+{
+    unsigned int max_threads = kernel_max_threads;
+    if (max_threads == 0)
+        max_threads = thread::hardware_concurrency();
+
+    uint64_t parts = length / kernel_min_elements_per_thread;
+    if (parts > max_threads)
+        parts = max_threads;
+
+    return parts < 1 ? 1 : static_cast<unsigned int>(parts);
+}
+
+/**
+ * @brief Split [0, length) into 'parts' contiguous ranges and call f() for
+ * each one on its own thread.
+ *
+ * The last part is run on the calling thread. This returns once all of the
+ * parts are done.
+ *
+ * @param length
+ * @param parts
+ * @param f Called with the range and the part number (0, ..., parts - 1)
+ */
+void kernel_parallel_for(uint64_t length, unsigned int parts,
+                         const function<void(uint64_t begin, uint64_t end, unsigned int part)> &f)
+{
+    if (parts <= 1) {
+        f(0, length, 0);
+        return;
+    }
+
+    const uint64_t part_size = length / parts;
+    vector<thread> threads;
+    threads.reserve(parts - 1);
+    for (unsigned int p = 0; p < parts - 1; ++p)
+        threads.emplace_back(f, p * part_size, (p + 1) * part_size, p);
+
+    f((parts - 1) * part_size, length, parts - 1);
+
+    for (auto &t: threads)
+        t.join();
+}
+
+/**
+ * @brief Join the result for the next part of an array to this one
+ *
+ * Parts must be joined in order.
+ */
+void min_max_part_t::join(const min_max_part_t &next)
+{
+    v.max_val = (v.max_val < next.v.max_val) ? next.v.max_val : v.max_val;
+    v.min_val = (next.v.min_val < v.min_val) ? next.v.min_val : v.min_val;
+
+    if (!next.has_values)
+        return;
+
+    if (!has_values) {
+        has_values = true;
+        first = next.first;
+        last = next.last;
+        has_first_dir = next.has_first_dir;
+        first_dir = next.first_dir;
+        last_dir = next.last_dir;
+        v.monotonic = v.monotonic && next.v.monotonic;
+        return;
+    }
+
+    // The direction from the last value of this part to the first of the next
+    bool dir = (next.first - last) > 0.0;
+    bool monotonic = v.monotonic && next.v.monotonic;
+    if (has_first_dir && last_dir != dir)
+        monotonic = false;
+    if (next.has_first_dir && next.first_dir != dir)
+        monotonic = false;
+
+    if (!has_first_dir) {
+        has_first_dir = true;
+        first_dir = dir;
+    }
+    last = next.last;
+    last_dir = next.has_first_dir ? next.last_dir : dir;
+    v.monotonic = monotonic;
+}
+
+} // namespace functions
@@ -0,0 +1,388 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ implementation of the OPeNDAP
+// Hyrax data server
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Authors: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef FUNCTIONS_ARRAY_KERNELS_H_
+#define FUNCTIONS_ARRAY_KERNELS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <libdap/Array.h>
+#include <libdap/dods-datatypes.h>
+#include <libdap/util.h>
+
+#include "RangeFunction.h"
+
+// The kernels used by range(), bbox(), mask_array() and linear_scale().
+//
+// Each kernel works on the values in an Array's buffer using the Array's own
+// element type, so the values are not first copied to a vector of doubles.
+// The inner loops are written so that the compiler can vectorize them (no
+// calls, no early exits and, for the reductions, one accumulator per
+// value). Arrays with more than kernel_min_elements_per_thread values are
+// split into contiguous parts that are processed on separate threads and
+// then combined. The results are the same as the scalar code they replace.
+
+#define FUNCTIONS_MAX_THREADS_KEY "FUNCTIONS.MaxThreads"
+
+namespace functions {
+
+// Set from FUNCTIONS.MaxThreads; zero means use the number of cores.
+extern unsigned int kernel_max_threads;
+
+// Smaller arrays are not worth starting threads for.
+const uint64_t kernel_min_elements_per_thread = 1024 * 1024;
+
+unsigned int kernel_thread_count(uint64_t length);
+
+void kernel_parallel_for(uint64_t length, unsigned int parts,
+                         const std::function<void(uint64_t begin, uint64_t end, unsigned int part)> &f);
+
+/**
+ * @brief Call f() with a pointer to the Array's values, using their type
+ *
+ * @param a The Array; it must have been read
+ * @param f A callable that takes a pointer to any of the numeric types
+ * (typically a generic lambda)
+ * @return False if the Array does not hold numeric values in its buffer,
+ * in which case f() is not called.
+ */
+template<typename F>
+bool with_numeric_values(libdap::Array *a, F f)
+{
+    if (!a->var() || !a->get_buf())
+        return false;
+
+    char *buf = a->get_buf();
+    switch (a->var()->type()) {
+    case libdap::dods_byte_c:
+    case libdap::dods_uint8_c:
+        f(reinterpret_cast<libdap::dods_byte *>(buf));
+        return true;
+    case libdap::dods_int8_c:
+        f(reinterpret_cast<libdap::dods_int8 *>(buf));
+        return true;
+    case libdap::dods_int16_c:
+        f(reinterpret_cast<libdap::dods_int16 *>(buf));
+        return true;
+    case libdap::dods_uint16_c:
+        f(reinterpret_cast<libdap::dods_uint16 *>(buf));
+        return true;
+    case libdap::dods_int32_c:
+        f(reinterpret_cast<libdap::dods_int32 *>(buf));
+        return true;
+    case libdap::dods_uint32_c:
+        f(reinterpret_cast<libdap::dods_uint32 *>(buf));
+        return true;
+    case libdap::dods_int64_c:
+        f(reinterpret_cast<libdap::dods_int64 *>(buf));
+        return true;
+    case libdap::dods_uint64_c:
+        f(reinterpret_cast<libdap::dods_uint64 *>(buf));
+        return true;
+    case libdap::dods_float32_c:
+        f(reinterpret_cast<libdap::dods_float32 *>(buf));
+        return true;
+    case libdap::dods_float64_c:
+        f(reinterpret_cast<libdap::dods_float64 *>(buf));
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The start value for a typed max() reduction. For floating point types this
+// is -inf so that a part holding only NaNs is still recognized as 'no value.'
+template<typename T>
+inline T lowest_value()
+{
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::lowest();
+}
+
+template<typename T>
+inline T highest_value()
+{
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::max();
+}
+
+/// The part of find_min_max() computed for one contiguous part of an array.
+struct min_max_part_t {
+    min_max_t v;
+
+    // Members used to join the monotonic property of adjacent parts
+    bool has_values = false;    // True if the part holds a value in the sequence
+    double first = 0.0;         // First and last values in the sequence
+    double last = 0.0;
+    bool has_first_dir = false; // True if the sequence holds at least two values
+    bool first_dir = false;     // True if the first two values increase
+    bool last_dir = false;      // True if the last two values increase
+
+    void join(const min_max_part_t &next);
+};
+
+/**
+ * @brief Find the min, max and monotonic values for data[begin, end)
+ *
+ * The values compared for the monotonic property are the ones not equal to
+ * the missing value, plus data[0], matching find_min_max(). NaNs are ignored
+ * by the min and max, as they are by std::min() and std::max().
+ */
+template<typename T>
+min_max_part_t find_min_max_part(const T *data, uint64_t begin, uint64_t end, bool use_missing, double missing)
+{
+    min_max_part_t part;
+    if (begin >= end)
+        return part;
+
+    // min and max
+    if (use_missing) {
+        for (uint64_t i = begin; i < end; ++i) {
+            double value = data[i];
+            if (!libdap::double_eq(value, missing)) {
+                part.v.max_val = (part.v.max_val < value) ? value : part.v.max_val;
+                part.v.min_val = (value < part.v.min_val) ? value : part.v.min_val;
+            }
+        }
+    }
+    else {
+        T max_val = lowest_value<T>();
+        T min_val = highest_value<T>();
+        for (uint64_t i = begin; i < end; ++i) {
+            max_val = (max_val < data[i]) ? data[i] : max_val;
+            min_val = (data[i] < min_val) ? data[i] : min_val;
+        }
+        // If the part holds only NaNs, max_val and min_val are still +/-inf
+        // and the defaults are kept, just as with the double version.
+        part.v.max_val = (part.v.max_val < static_cast<double>(max_val)) ? max_val : part.v.max_val;
+        part.v.min_val = (static_cast<double>(min_val) < part.v.min_val) ? min_val : part.v.min_val;
+    }
+
+    // monotonic
+    auto in_sequence = [&](uint64_t i) {
+        return i == 0 || !use_missing || !libdap::double_eq(data[i], missing);
+    };
+
+    bool have_previous = false;
+    bool have_direction = false;
+    bool increasing = false;
+    double previous = 0.0;
+    uint64_t i = begin;
+    for (; i < end; ++i) {
+        if (!in_sequence(i)) continue;
+
+        double value = data[i];
+        if (!have_previous) {
+            part.has_values = true;
+            part.first = value;
+        }
+        else {
+            bool up = (value - previous) > 0.0;
+            if (!have_direction) {
+                part.has_first_dir = true;
+                part.first_dir = up;
+            }
+            else if (up != increasing) {
+                part.v.monotonic = false;
+                break;
+            }
+            increasing = up;
+            have_direction = true;
+        }
+        previous = value;
+        have_previous = true;
+    }
+
+    if (part.v.monotonic) {
+        part.last = previous;
+        part.last_dir = increasing;
+    }
+    else {
+        // Stopped early; find the last two values in the sequence.
+        uint64_t j = end;
+        while (!in_sequence(--j)) { }
+        part.last = data[j];
+        while (!in_sequence(--j)) { }
+        part.last_dir = (part.last - static_cast<double>(data[j])) > 0.0;
+    }
+
+    return part;
+}
+
+/**
+ * @brief Find the min, max and monotonic values of an array
+ * @see find_min_max()
+ */
+template<typename T>
+min_max_t find_min_max_kernel(const T *data, uint64_t length, bool use_missing, double missing)
+{
+    unsigned int parts = kernel_thread_count(length);
+    if (parts <= 1)
+        return find_min_max_part(data, 0, length, use_missing, missing).v;
+
+    std::vector<min_max_part_t> results(parts);
+    kernel_parallel_for(length, parts, [&](uint64_t begin, uint64_t end, unsigned int part) {
+        results[part] = find_min_max_part(data, begin, end, use_missing, missing);
+    });
+
+    for (unsigned int p = 1; p < parts; ++p)
+        results[0].join(results[p]);
+
+    return results[0].v;
+}
+
+/**
+ * @brief Find the bounding box of the values in [min_value, max_value]
+ *
+ * The array is treated as a set of rows (the rightmost dimension); the rows
+ * are split among the threads.
+ *
+ * @param data The values
+ * @param shape The size of each dimension
+ * @param min_value
+ * @param max_value
+ * @param start Value-result; the first index of the box in each dimension
+ * @param stop Value-result; the last index of the box in each dimension
+ * @return False if no value was in the range
+ */
+template<typename T>
+bool bbox_kernel(const T *data, const std::vector<uint64_t> &shape, double min_value, double max_value,
+                 std::vector<uint64_t> &start, std::vector<uint64_t> &stop)
+{
+    const unsigned long rank = shape.size();
+    if (rank == 0)
+        return false;
+
+    const uint64_t row_length = shape.back();
+    uint64_t rows = 1;
+    for (unsigned long d = 0; d + 1 < rank; ++d)
+        rows *= shape[d];
+
+    if (row_length == 0 || rows == 0)
+        return false;
+
+    auto in_range = [min_value, max_value](T v) {
+        double value = v;
+        return value >= min_value && value <= max_value;
+    };
+
+    unsigned int parts = kernel_thread_count(rows * row_length);
+    if (parts > rows) parts = static_cast<unsigned int>(rows);
+    if (parts < 1) parts = 1;
+
+    std::vector<std::vector<uint64_t>> starts(parts, shape);
+    std::vector<std::vector<uint64_t>> stops(parts, std::vector<uint64_t>(rank, 0));
+    std::vector<char> found(parts, 0);
+
+    auto scan_rows = [&](uint64_t begin, uint64_t end, unsigned int part) {
+        std::vector<uint64_t> &first = starts[part];
+        std::vector<uint64_t> &last = stops[part];
+        std::vector<uint64_t> index(rank, 0);
+        for (uint64_t row = begin; row < end; ++row) {
+            const T *values = data + row * row_length;
+            uint64_t i = 0;
+            while (i < row_length && !in_range(values[i])) ++i;
+            if (i == row_length) continue;
+
+            uint64_t j = row_length - 1;
+            while (!in_range(values[j])) --j;
+
+            found[part] = 1;
+            first[rank - 1] = std::min(first[rank - 1], i);
+            last[rank - 1] = std::max(last[rank - 1], j);
+
+            uint64_t r = row;
+            for (unsigned long d = rank - 1; d-- > 0;) {
+                index[d] = r % shape[d];
+                r /= shape[d];
+                first[d] = std::min(first[d], index[d]);
+                last[d] = std::max(last[d], index[d]);
+            }
+        }
+    };
+
+    if (parts == 1)
+        scan_rows(0, rows, 0);
+    else
+        kernel_parallel_for(rows, parts, scan_rows);
+
+    bool any = false;
+    start = shape;
+    stop.assign(rank, 0);
+    for (unsigned int p = 0; p < parts; ++p) {
+        if (!found[p]) continue;
+        any = true;
+        for (unsigned long d = 0; d < rank; ++d) {
+            start[d] = std::min(start[d], starts[p][d]);
+            stop[d] = std::max(stop[d], stops[p][d]);
+        }
+    }
+
+    return any;
+}
+
+/**
+ * @brief Replace the values where the mask is not set with no_data_value
+ */
+template<typename T>
+void mask_kernel(T *data, const libdap::dods_byte *mask, uint64_t length, double no_data_value)
+{
+    const T no_data = static_cast<T>(no_data_value);
+    auto apply = [=](uint64_t begin, uint64_t end, unsigned int) {
+        for (uint64_t i = begin; i < end; ++i)
+            data[i] = mask[i] ? data[i] : no_data;
+    };
+
+    unsigned int parts = kernel_thread_count(length);
+    if (parts <= 1)
+        apply(0, length, 0);
+    else
+        kernel_parallel_for(length, parts, apply);
+}
+
+/**
+ * @brief Compute dest[i] = src[i] * m + b
+ */
+template<typename T>
+void linear_scale_kernel(const T *src, double *dest, uint64_t length, double m, double b)
+{
+    auto scale = [=](uint64_t begin, uint64_t end, unsigned int) {
+        for (uint64_t i = begin; i < end; ++i)
+            dest[i] = static_cast<double>(src[i]) * m + b;
+    };
+
+    unsigned int parts = kernel_thread_count(length);
+    if (parts <= 1)
+        scale(0, length, 0);
+    else
+        kernel_parallel_for(length, parts, scale);
+}
+
+} // namespace functions
+
+#endif // FUNCTIONS_ARRAY_KERNELS_H_
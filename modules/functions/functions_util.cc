@@ -46,6 +46,8 @@
 #include <libdap/Error.h>
 #include <libdap/util.h>
 
+#include "functions_util.h"
+
 using namespace std;
 using namespace libdap;
 
@@ -174,4 +176,60 @@ unsigned int extract_uint_value(BaseType *arg)
     }
 }
 
+/**
+ * @brief Does the Array's current constraint select all of its elements?
+ * @param a The Array
+ * @return True if every dimension starts at zero, has a stride of one and
+ * includes all of its elements.
+ */
+bool is_unconstrained(Array *a)
+{
+    for (Array::Dim_iter d = a->dim_begin(), e = a->dim_end(); d != e; ++d) {
+        if (a->dimension_start_ll(d, true) != 0 || a->dimension_stride_ll(d, true) != 1
+            || a->dimension_size_ll(d, true) != a->dimension_size_ll(d, false))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the chunk statistics for an Array without reading its data
+ *
+ * The statistics are available only when the Array's handler records them
+ * (see bes::ChunkStatisticsSource) and the Array is not constrained, since
+ * they describe the whole variable.
+ *
+ * @param a The Array
+ * @param stats Value-result parameter
+ * @return True if the statistics were found, false otherwise.
+ */
+bool get_array_chunk_stats(Array *a, array_chunk_stats_t &stats)
+{
+    auto source = dynamic_cast<bes::ChunkStatisticsSource *>(a);
+    if (!source || !is_unconstrained(a))
+        return false;
+
+    if (!source->get_chunk_statistics(stats.chunk_shape, stats.chunks))
+        return false;
+
+    stats.shape.clear();
+    unsigned long long total_chunks = 1;
+    unsigned int d = 0;
+    for (Array::Dim_iter i = a->dim_begin(), e = a->dim_end(); i != e; ++i, ++d) {
+        unsigned long long size = a->dimension_size_ll(i, false);
+        if (d >= stats.chunk_shape.size() || stats.chunk_shape[d] == 0)
+            return false;
+        stats.shape.push_back(size);
+        total_chunks *= (size + stats.chunk_shape[d] - 1) / stats.chunk_shape[d];
+    }
+    if (stats.shape.size() != stats.chunk_shape.size() || stats.chunks.size() > total_chunks)
+        return false;
+
+    stats.implicit_chunks = total_chunks - stats.chunks.size();
+    stats.has_fill = source->get_fill_value_as_double(stats.fill_value);
+
+    return true;
+}
+
 } // namespace functions
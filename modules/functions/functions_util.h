@@ -26,6 +26,11 @@
 #ifndef FUNCTIONS_FUNCTIONS_UTIL_H_
 #define FUNCTIONS_FUNCTIONS_UTIL_H_
 
+#include <string>
+#include <vector>
+
+#include "ChunkStatistics.h"
+
 namespace libdap {
 class BaseType;
 class Array;
@@ -50,6 +55,23 @@ void check_number_type_array(libdap::BaseType *btp, unsigned int rank = 0);
 
 unsigned int extract_uint_value(libdap::BaseType *arg);
 
+bool is_unconstrained(libdap::Array *a);
+
+/**
+ * The chunk statistics for an Array, as reported by the handler that
+ * read it. See bes::ChunkStatisticsSource.
+ */
+struct array_chunk_stats_t {
+    std::vector<unsigned long long> shape;          // The Array's shape
+    std::vector<unsigned long long> chunk_shape;
+    std::vector<bes::ChunkStatistics> chunks;       // The chunks that hold data
+    unsigned long long implicit_chunks = 0;         // Chunks that hold only the fill value
+    bool has_fill = false;
+    double fill_value = 0.0;
+};
+
+bool get_array_chunk_stats(libdap::Array *a, array_chunk_stats_t &stats);
+
 #if 0
 /// We might move these into functions_util over time if they become generally
 /// useful. jhrg 5/1/15
@@ -0,0 +1,472 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ implementation of the OPeNDAP
+// Hyrax data server
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Tests for the typed kernels in array_kernels.h. Each kernel is compared
+// with a plain scalar version of the code it replaced, on one thread and
+// split into parts that are joined.
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cppunit/TextTestRunner.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <libdap/dods-datatypes.h>
+#include <libdap/util.h>
+
+#include "RangeFunction.h"
+#include "array_kernels.h"
+
+static bool debug = false;
+
+#undef DBG
+#define DBG(x) do { if (debug) (x); } while(false);
+
+using namespace CppUnit;
+using namespace libdap;
+using namespace functions;
+using namespace std;
+
+// The scalar find_min_max(): the monotonic property uses the values not
+// equal to the missing value, plus data[0].
+static min_max_t reference_min_max(const vector<double> &data, bool use_missing, double missing)
+{
+    min_max_t v;
+    bool have_previous = false;
+    bool have_direction = false;
+    bool increasing = false;
+    double previous = 0.0;
+    for (vector<double>::size_type i = 0; i < data.size(); ++i) {
+        bool is_missing = use_missing && double_eq(data[i], missing);
+        if (!is_missing) {
+            v.max_val = max(v.max_val, data[i]);
+            v.min_val = min(v.min_val, data[i]);
+        }
+        if (is_missing && i != 0)
+            continue;
+
+        if (have_previous) {
+            bool up = (data[i] - previous) > 0.0;
+            if (have_direction && up != increasing)
+                v.monotonic = false;
+            increasing = up;
+            have_direction = true;
+        }
+        previous = data[i];
+        have_previous = true;
+    }
+    return v;
+}
+
+// The rank N bbox() code the kernel replaced
+static bool reference_bbox(const vector<double> &data, const vector<uint64_t> &shape, double min_value,
+                           double max_value, vector<uint64_t> &start, vector<uint64_t> &stop)
+{
+    const auto rank = shape.size();
+    start = shape;
+    stop.assign(rank, 0);
+    bool found = false;
+    vector<uint64_t> index(rank, 0);
+    for (vector<double>::size_type i = 0; i < data.size(); ++i) {
+        uint64_t r = i;
+        for (auto d = rank; d-- > 0;) {
+            index[d] = r % shape[d];
+            r /= shape[d];
+        }
+        if (data[i] >= min_value && data[i] <= max_value) {
+            found = true;
+            for (vector<uint64_t>::size_type d = 0; d < rank; ++d) {
+                start[d] = min(start[d], index[d]);
+                stop[d] = max(stop[d], index[d]);
+            }
+        }
+    }
+    return found;
+}
+
+// Join find_min_max_part() for the parts split at 'cuts', in order
+template<typename T>
+static min_max_t split_min_max(const vector<T> &data, const vector<uint64_t> &cuts, bool use_missing, double missing)
+{
+    min_max_part_t result;
+    uint64_t begin = 0;
+    for (auto cut: cuts) {
+        result.join(find_min_max_part(data.data(), begin, cut, use_missing, missing));
+        begin = cut;
+    }
+    result.join(find_min_max_part(data.data(), begin, data.size(), use_missing, missing));
+    return result.v;
+}
+
+static void assert_equal(const min_max_t &expected, const min_max_t &actual, const string &msg)
+{
+    DBG(cerr << msg << ": expected " << expected << ", got " << actual << endl);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(msg + " min", expected.min_val, actual.min_val);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(msg + " max", expected.max_val, actual.max_val);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(msg + " monotonic", expected.monotonic, actual.monotonic);
+}
+
+class ArrayKernelsTest: public TestFixture {
+private:
+    unsigned int d_saved_max_threads = 0;
+
+    // Check every way of splitting 'values' into two and three parts
+    template<typename T>
+    void check_all_splits(const vector<T> &values, bool use_missing, double missing, const string &name)
+    {
+        vector<double> as_doubles(values.begin(), values.end());
+        min_max_t expected = reference_min_max(as_doubles, use_missing, missing);
+
+        assert_equal(expected, find_min_max_part(values.data(), 0, values.size(), use_missing, missing).v,
+                     name + " whole");
+
+        for (uint64_t i = 0; i <= values.size(); ++i) {
+            assert_equal(expected, split_min_max(values, {i}, use_missing, missing),
+                         name + " split at " + to_string(i));
+            for (uint64_t j = i; j <= values.size(); ++j)
+                assert_equal(expected, split_min_max(values, {i, j}, use_missing, missing),
+                             name + " split at " + to_string(i) + ", " + to_string(j));
+        }
+    }
+
+    template<typename T>
+    void check_min_max_random(unsigned int seed)
+    {
+        mt19937 gen(seed);
+        uniform_int_distribution<int> dist(0, 99);
+        uniform_int_distribution<int> length(1, 12);
+
+        for (int n = 0; n < 50; ++n) {
+            vector<T> values(length(gen));
+            for (auto &v: values)
+                v = static_cast<T>(dist(gen) < 10 ? 7 : dist(gen));
+            check_all_splits(values, false, 0, "random " + to_string(n));
+            check_all_splits(values, true, 7, "random, missing " + to_string(n));
+        }
+    }
+
+public:
+    void setUp() override { d_saved_max_threads = kernel_max_threads; }
+
+    void tearDown() override { kernel_max_threads = d_saved_max_threads; }
+
+    void thread_count_test()
+    {
+        kernel_max_threads = 4;
+        CPPUNIT_ASSERT_EQUAL(1U, kernel_thread_count(0));
+        CPPUNIT_ASSERT_EQUAL(1U, kernel_thread_count(kernel_min_elements_per_thread - 1));
+        CPPUNIT_ASSERT_EQUAL(2U, kernel_thread_count(2 * kernel_min_elements_per_thread));
+        CPPUNIT_ASSERT_EQUAL(4U, kernel_thread_count(100 * kernel_min_elements_per_thread));
+
+        kernel_max_threads = 1;
+        CPPUNIT_ASSERT_EQUAL(1U, kernel_thread_count(100 * kernel_min_elements_per_thread));
+    }
+
+    // Every element is visited once, and each part sees a contiguous range
+    void parallel_for_test()
+    {
+        for (unsigned int parts = 1; parts <= 5; ++parts) {
+            vector<int> visits(103, 0);
+            vector<uint64_t> begins(parts), ends(parts);
+            kernel_parallel_for(visits.size(), parts, [&](uint64_t begin, uint64_t end, unsigned int part) {
+                begins[part] = begin;
+                ends[part] = end;
+                for (uint64_t i = begin; i < end; ++i)
+                    ++visits[i];
+            });
+
+            for (auto v: visits)
+                CPPUNIT_ASSERT_EQUAL(1, v);
+            CPPUNIT_ASSERT_EQUAL((uint64_t)0, begins[0]);
+            CPPUNIT_ASSERT_EQUAL((uint64_t)visits.size(), ends[parts - 1]);
+            for (unsigned int p = 1; p < parts; ++p)
+                CPPUNIT_ASSERT_EQUAL(ends[p - 1], begins[p]);
+        }
+    }
+
+    void min_max_test()
+    {
+        check_all_splits(vector<dods_int32>{1, 2, 3, 4, 5, 6}, false, 0, "increasing");
+        check_all_splits(vector<dods_int32>{6, 5, 4, 3, 2, 1}, false, 0, "decreasing");
+        check_all_splits(vector<dods_int32>{1, 2, 3, 2, 5, 6}, false, 0, "one dip");
+        check_all_splits(vector<dods_int32>{1, 2, 2, 3}, false, 0, "repeated value");
+        check_all_splits(vector<dods_int32>{5}, false, 0, "one value");
+    }
+
+    void min_max_missing_test()
+    {
+        // The missing value is not part of the min, max or monotonic sequence...
+        check_all_splits(vector<dods_float64>{1, -99, 2, 3, -99, 4}, true, -99, "increasing with missing");
+        check_all_splits(vector<dods_float64>{-99, -99, -99}, true, -99, "all missing");
+        check_all_splits(vector<dods_float64>{4, 3, -99, 5}, true, -99, "dip with missing");
+        // ...except for the first element
+        check_all_splits(vector<dods_float64>{-99, 1, 2, 3}, true, -99, "missing first");
+        check_all_splits(vector<dods_float64>{-99, 3, 2, 1}, true, -99, "missing first, decreasing");
+    }
+
+    void min_max_nan_test()
+    {
+        vector<dods_float32> values{NAN, 2, 1, NAN, 5};
+        min_max_t v = find_min_max_part(values.data(), 0, values.size(), false, 0).v;
+        CPPUNIT_ASSERT_EQUAL(1.0, v.min_val);
+        CPPUNIT_ASSERT_EQUAL(5.0, v.max_val);
+
+        // A part of only NaNs keeps the defaults
+        min_max_t defaults;
+        vector<dods_float64> nans{NAN, NAN};
+        v = find_min_max_part(nans.data(), 0, nans.size(), false, 0).v;
+        CPPUNIT_ASSERT_EQUAL(defaults.min_val, v.min_val);
+        CPPUNIT_ASSERT_EQUAL(defaults.max_val, v.max_val);
+    }
+
+    void min_max_types_test()
+    {
+        check_min_max_random<dods_byte>(1);
+        check_min_max_random<dods_int8>(2);
+        check_min_max_random<dods_int16>(3);
+        check_min_max_random<dods_uint16>(4);
+        check_min_max_random<dods_int32>(5);
+        check_min_max_random<dods_uint32>(6);
+        check_min_max_random<dods_int64>(7);
+        check_min_max_random<dods_uint64>(8);
+        check_min_max_random<dods_float32>(9);
+        check_min_max_random<dods_float64>(10);
+    }
+
+    // Large enough to use four threads; the direction changes just after a
+    // part boundary.
+    void min_max_threads_test()
+    {
+        const uint64_t length = 4 * kernel_min_elements_per_thread;
+        vector<dods_int16> values(length);
+        for (uint64_t i = 0; i < length; ++i)
+            values[i] = static_cast<dods_int16>(i % 1000);
+
+        kernel_max_threads = 4;
+        CPPUNIT_ASSERT_EQUAL(4U, kernel_thread_count(length));
+
+        vector<double> as_doubles(values.begin(), values.end());
+        assert_equal(reference_min_max(as_doubles, false, 0), find_min_max_kernel(values.data(), length, false, 0),
+                     "sawtooth");
+
+        // Monotonic except at the start of the third part
+        for (uint64_t i = 0; i < length; ++i)
+            as_doubles[i] = static_cast<double>(i);
+        as_doubles[2 * kernel_min_elements_per_thread] = 0;
+        assert_equal(reference_min_max(as_doubles, false, 0),
+                     find_min_max_kernel(as_doubles.data(), length, false, 0), "one dip at a boundary");
+
+        as_doubles[2 * kernel_min_elements_per_thread] = 2 * kernel_min_elements_per_thread;
+        min_max_t v = find_min_max_kernel(as_doubles.data(), length, false, 0);
+        CPPUNIT_ASSERT(v.monotonic);
+        CPPUNIT_ASSERT_EQUAL(0.0, v.min_val);
+        CPPUNIT_ASSERT_EQUAL(static_cast<double>(length - 1), v.max_val);
+    }
+
+    void bbox_test()
+    {
+        mt19937 gen(11);
+        uniform_int_distribution<int> dist(0, 99);
+        const vector<vector<uint64_t>> shapes{{17}, {5, 7}, {3, 4, 5}, {2, 3, 2, 3}, {1, 9}, {9, 1}};
+        for (const auto &shape: shapes) {
+            uint64_t length = 1;
+            for (auto s: shape) length *= s;
+
+            for (int n = 0; n < 20; ++n) {
+                vector<dods_uint16> values(length);
+                for (auto &v: values)
+                    v = static_cast<dods_uint16>(dist(gen));
+                vector<double> as_doubles(values.begin(), values.end());
+
+                // A narrow range so that some of the boxes are empty
+                double low = dist(gen);
+                double high = low + 3;
+
+                vector<uint64_t> expected_start, expected_stop, start, stop;
+                bool expected = reference_bbox(as_doubles, shape, low, high, expected_start, expected_stop);
+                bool found = bbox_kernel(values.data(), shape, low, high, start, stop);
+                CPPUNIT_ASSERT_EQUAL(expected, found);
+                if (expected) {
+                    CPPUNIT_ASSERT(expected_start == start);
+                    CPPUNIT_ASSERT(expected_stop == stop);
+                }
+            }
+        }
+    }
+
+    void bbox_empty_test()
+    {
+        vector<dods_float32> values;
+        vector<uint64_t> start, stop;
+        CPPUNIT_ASSERT(!bbox_kernel(values.data(), {0, 4}, 0, 1, start, stop));
+        CPPUNIT_ASSERT(!bbox_kernel(values.data(), {}, 0, 1, start, stop));
+    }
+
+    // The rows are split among four threads; the matches are in the first
+    // and last parts.
+    void bbox_threads_test()
+    {
+        const vector<uint64_t> shape{4 * 1024, 1024};
+        vector<dods_byte> values(shape[0] * shape[1], 0);
+        values[10 * 1024 + 500] = 1;
+        values[4000 * 1024 + 20] = 1;
+
+        kernel_max_threads = 4;
+        CPPUNIT_ASSERT_EQUAL(4U, kernel_thread_count(values.size()));
+
+        vector<uint64_t> start, stop;
+        CPPUNIT_ASSERT(bbox_kernel(values.data(), shape, 1, 1, start, stop));
+        CPPUNIT_ASSERT(start == (vector<uint64_t>{10, 20}));
+        CPPUNIT_ASSERT(stop == (vector<uint64_t>{4000, 500}));
+    }
+
+    void mask_test()
+    {
+        vector<dods_int32> values{1, 2, 3, 4, 5};
+        vector<dods_byte> mask{1, 0, 1, 0, 0};
+        mask_kernel(values.data(), mask.data(), values.size(), -1);
+        CPPUNIT_ASSERT(values == (vector<dods_int32>{1, -1, 3, -1, -1}));
+
+        vector<dods_float32> floats{1.5, 2.5};
+        mask = {0, 1};
+        mask_kernel(floats.data(), mask.data(), floats.size(), -9999.5);
+        CPPUNIT_ASSERT(floats == (vector<dods_float32>{-9999.5, 2.5}));
+    }
+
+    void mask_threads_test()
+    {
+        const uint64_t length = 3 * kernel_min_elements_per_thread + 7;
+        vector<dods_uint32> values(length);
+        vector<dods_byte> mask(length);
+        for (uint64_t i = 0; i < length; ++i) {
+            values[i] = static_cast<dods_uint32>(i);
+            mask[i] = (i % 3) == 0;
+        }
+
+        kernel_max_threads = 3;
+        mask_kernel(values.data(), mask.data(), length, 0);
+        for (uint64_t i = 0; i < length; ++i)
+            CPPUNIT_ASSERT_EQUAL(static_cast<dods_uint32>(mask[i] ? i : 0), values[i]);
+    }
+
+    void linear_scale_test()
+    {
+        vector<dods_int16> values{-2, 0, 3};
+        vector<double> scaled(values.size());
+        linear_scale_kernel(values.data(), scaled.data(), values.size(), 0.5, 10);
+        CPPUNIT_ASSERT(scaled == (vector<double>{9.0, 10.0, 11.5}));
+
+        vector<dods_uint64> big{18446744073709551615ULL};
+        linear_scale_kernel(big.data(), scaled.data(), big.size(), 1, 0);
+        CPPUNIT_ASSERT_EQUAL(static_cast<double>(18446744073709551615ULL), scaled[0]);
+    }
+
+    void linear_scale_threads_test()
+    {
+        const uint64_t length = 2 * kernel_min_elements_per_thread + 3;
+        vector<dods_byte> values(length);
+        for (uint64_t i = 0; i < length; ++i)
+            values[i] = static_cast<dods_byte>(i % 256);
+
+        kernel_max_threads = 2;
+        vector<double> scaled(length);
+        linear_scale_kernel(values.data(), scaled.data(), length, 2, -1);
+        for (uint64_t i = 0; i < length; ++i)
+            CPPUNIT_ASSERT_EQUAL(values[i] * 2.0 - 1, scaled[i]);
+    }
+
+    CPPUNIT_TEST_SUITE( ArrayKernelsTest );
+
+    CPPUNIT_TEST(thread_count_test);
+    CPPUNIT_TEST(parallel_for_test);
+    CPPUNIT_TEST(min_max_test);
+    CPPUNIT_TEST(min_max_missing_test);
+    CPPUNIT_TEST(min_max_nan_test);
+    CPPUNIT_TEST(min_max_types_test);
+    CPPUNIT_TEST(min_max_threads_test);
+    CPPUNIT_TEST(bbox_test);
+    CPPUNIT_TEST(bbox_empty_test);
+    CPPUNIT_TEST(bbox_threads_test);
+    CPPUNIT_TEST(mask_test);
+    CPPUNIT_TEST(mask_threads_test);
+    CPPUNIT_TEST(linear_scale_test);
+    CPPUNIT_TEST(linear_scale_threads_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ArrayKernelsTest);
+
+int main(int argc, char*argv[])
+{
+    int option_char;
+    while ((option_char = getopt(argc, argv, "dh")) != -1)
+        switch (option_char) {
+        case 'd':
+            debug = 1;  // debug is a static global
+            break;
+
+        case 'h': {     // help - show test names
+            cerr << "Usage: ArrayKernelsTest has the following tests:" << endl;
+            const std::vector<Test*> &tests = ArrayKernelsTest::suite()->getTests();
+            unsigned int prefix_len = ArrayKernelsTest::suite()->getName().append("::").size();
+            for (std::vector<Test*>::const_iterator i = tests.begin(), e = tests.end(); i != e; ++i) {
+                cerr << (*i)->getName().replace(0, prefix_len, "") << endl;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+    argc -= optind;
+    argv += optind;
+
+    CppUnit::TextTestRunner runner;
+    runner.addTest(CppUnit::TestFactoryRegistry::getRegistry().makeTest());
+
+    bool wasSuccessful = true;
+    string test = "";
+    if (0 == argc) {
+        // run them all
+        wasSuccessful = runner.run("");
+    }
+    else {
+        int i = 0;
+        while (i < argc) {
+            if (debug) cerr << "Running " << argv[i] << endl;
+            test = ArrayKernelsTest::suite()->getName().append("::").append(argv[i++]);
+            wasSuccessful = wasSuccessful && runner.run(test);
+        }
+    }
+
+    return wasSuccessful ? 0 : 1;
+}
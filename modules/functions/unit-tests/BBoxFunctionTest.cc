@@ -29,6 +29,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <sstream>
+#include <memory>
 
 #include <libdap/BaseType.h>
 #include <libdap/Byte.h>
@@ -48,6 +49,7 @@
 
 #include "test_config.h"
 #include "test_utils.h"
+#include "ChunkStatsArray.h"
 
 #include "BBoxFunction.h"
 
@@ -377,6 +379,97 @@ public:
         }
     }
 
+    // Ten values in two chunks of five: 1 to 5 and 20 to 24
+    void make_stats_array(ChunkStatsArray &a)
+    {
+        a.append_dim(10, "x");
+        for (int i = 0; i < 5; ++i)
+            a.d_values.push_back(i + 1);
+        for (int i = 0; i < 5; ++i)
+            a.d_values.push_back(i + 20);
+        a.d_chunk_shape.push_back(5);
+        a.d_stats.push_back(chunk_stats({0}, 1, 5, 0, true));
+        a.d_stats.push_back(chunk_stats({5}, 20, 24, 0, true));
+    }
+
+    // Only the chunk that can hold values in the range is read
+    void chunk_stats_test()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a);
+
+        Float64 min("min");
+        min.set_value(21.0);
+        min.set_read_p(true);
+        Float64 max("max");
+        max.set_value(23.0);
+        max.set_read_p(true);
+        BaseType *argv[] = { &a, &min, &max };
+
+        BaseType *result = 0;
+        function_dap2_bbox(3, argv, *float32_array, &result);
+        unique_ptr<BaseType> response(result);
+
+        CPPUNIT_ASSERT_EQUAL(5ULL, a.d_elements_read);
+        // The constraint used to read the chunk is removed
+        CPPUNIT_ASSERT(!a.read_p());
+        CPPUNIT_ASSERT_EQUAL(10, a.length());
+
+        Structure *indices = static_cast<Structure*>(static_cast<Array*>(result)->var(0));
+        CPPUNIT_ASSERT_EQUAL(6, static_cast<Int32*>(indices->var("start"))->value());
+        CPPUNIT_ASSERT_EQUAL(8, static_cast<Int32*>(indices->var("stop"))->value());
+    }
+
+    // No chunk can hold a value in the range, so nothing is read
+    void chunk_stats_no_values_test()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a);
+
+        Float64 min("min");
+        min.set_value(10.0);
+        min.set_read_p(true);
+        Float64 max("max");
+        max.set_value(15.0);
+        max.set_read_p(true);
+        BaseType *argv[] = { &a, &min, &max };
+
+        BaseType *result = 0;
+        CPPUNIT_ASSERT_THROW(function_dap2_bbox(3, argv, *float32_array, &result), Error);
+        CPPUNIT_ASSERT(!a.d_was_read);
+    }
+
+    // A fill value in the range makes the chunks that hold it candidates
+    void chunk_stats_fill_test()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a);
+        a.d_values[2] = -1;
+        a.d_stats[0].fill_count = 1;
+        a.d_has_fill = true;
+        a.d_fill = -1;
+
+        Float64 min("min");
+        min.set_value(-1.0);
+        min.set_read_p(true);
+        Float64 max("max");
+        max.set_value(0.0);
+        max.set_read_p(true);
+        BaseType *argv[] = { &a, &min, &max };
+
+        BaseType *result = 0;
+        function_dap2_bbox(3, argv, *float32_array, &result);
+        unique_ptr<BaseType> response(result);
+
+        CPPUNIT_ASSERT_EQUAL(5ULL, a.d_elements_read);
+        Structure *indices = static_cast<Structure*>(static_cast<Array*>(result)->var(0));
+        CPPUNIT_ASSERT_EQUAL(2, static_cast<Int32*>(indices->var("start"))->value());
+        CPPUNIT_ASSERT_EQUAL(2, static_cast<Int32*>(indices->var("stop"))->value());
+    }
+
 CPPUNIT_TEST_SUITE( BBoxFunctionTest );
 
     CPPUNIT_TEST(no_arg_test);
@@ -384,6 +477,9 @@ CPPUNIT_TEST_SUITE( BBoxFunctionTest );
     CPPUNIT_TEST(float32_array_test);
     CPPUNIT_TEST(float32_2d_array_test);
     CPPUNIT_TEST(float32_2d_array_test_error);
+    CPPUNIT_TEST(chunk_stats_test);
+    CPPUNIT_TEST(chunk_stats_no_values_test);
+    CPPUNIT_TEST(chunk_stats_fill_test);
 
     CPPUNIT_TEST_SUITE_END()
     ;
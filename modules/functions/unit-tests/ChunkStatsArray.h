@@ -0,0 +1,120 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef _chunk_stats_array_h
+#define _chunk_stats_array_h
+
+#include <string>
+#include <vector>
+
+#include <libdap/Array.h>
+
+#include "ChunkStatistics.h"
+
+/**
+ * A Float64 Array with chunk statistics, like the one the DMR++ handler
+ * builds. read() returns the values of d_values (the whole Array, in
+ * row-major order) selected by the current constraint, or 1.0 for every
+ * element if d_values is empty, and counts the elements read.
+ */
+class ChunkStatsArray: public libdap::Array, public bes::ChunkStatisticsSource {
+public:
+    std::vector<libdap::dods_float64> d_values;
+    std::vector<unsigned long long> d_chunk_shape;
+    std::vector<bes::ChunkStatistics> d_stats;
+    bool d_has_fill = false;
+    double d_fill = 0.0;
+    bool d_was_read = false;
+    unsigned long long d_elements_read = 0;
+
+    ChunkStatsArray(const std::string &n, libdap::BaseType *v) : libdap::Array(n, v) { }
+
+    libdap::BaseType *ptr_duplicate() override { return new ChunkStatsArray(*this); }
+
+    bool read() override
+    {
+        d_was_read = true;
+        std::vector<libdap::dods_float64> values;
+        if (d_values.empty()) {
+            values.assign(length(), 1.0);
+        }
+        else {
+            std::vector<int> shape, start, stride, count;
+            for (auto d = dim_begin(), e = dim_end(); d != e; ++d) {
+                shape.push_back(dimension_size(d, false));
+                start.push_back(dimension_start(d, true));
+                stride.push_back(dimension_stride(d, true));
+                count.push_back(dimension_size(d, true));
+            }
+
+            // Walk the constrained indices, rightmost dimension fastest
+            std::vector<int> index(shape.size(), 0);
+            for (int n = 0; n < length(); ++n) {
+                unsigned long long offset = 0;
+                for (std::vector<int>::size_type d = 0; d < shape.size(); ++d)
+                    offset = offset * shape[d] + start[d] + index[d] * stride[d];
+                values.push_back(d_values.at(offset));
+
+                for (auto d = shape.size(); d-- > 0;) {
+                    if (++index[d] < count[d]) break;
+                    index[d] = 0;
+                }
+            }
+        }
+
+        d_elements_read += values.size();
+        set_value(values, values.size());
+        set_read_p(true);
+        return true;
+    }
+
+    bool get_chunk_statistics(std::vector<unsigned long long> &chunk_shape,
+                              std::vector<bes::ChunkStatistics> &stats) const override
+    {
+        chunk_shape = d_chunk_shape;
+        stats = d_stats;
+        return true;
+    }
+
+    bool get_fill_value_as_double(double &fill_value) const override
+    {
+        fill_value = d_fill;
+        return d_has_fill;
+    }
+};
+
+/// Statistics for a chunk whose first element is at 'position'
+inline bes::ChunkStatistics chunk_stats(const std::vector<unsigned long long> &position, double min_value,
+                                        double max_value, unsigned long long fill_count, bool monotonic)
+{
+    bes::ChunkStatistics stats;
+    stats.position = position;
+    stats.has_values = true;
+    stats.min_value = min_value;
+    stats.max_value = max_value;
+    stats.fill_count = fill_count;
+    stats.monotonic = monotonic;
+    return stats;
+}
+
+#endif // _chunk_stats_array_h
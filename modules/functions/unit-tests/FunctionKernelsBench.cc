@@ -0,0 +1,202 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of bes, A C++ implementation of the OPeNDAP
+// Hyrax data server
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Authors: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Time the kernels used by range(), bbox(), mask_array() and linear_scale()
+// for each element type. Each kernel is timed three ways: the way the
+// functions used to work (copy the values to a vector of doubles and then
+// scan them on one thread), the typed kernel on one thread and the typed
+// kernel using FUNCTIONS.MaxThreads threads (default: all of the cores).
+//
+// Build with 'make FunctionKernelsBench' and run as:
+//   ./FunctionKernelsBench [-n elements] [-i iterations] [-t threads]
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libdap/dods-datatypes.h>
+
+#include "RangeFunction.h"
+#include "array_kernels.h"
+
+using namespace std;
+using namespace libdap;
+using namespace functions;
+
+static uint64_t elements = 16 * 1024 * 1024;
+static int iterations = 10;
+static unsigned int threads = 0;
+
+// The sink keeps the compiler from removing the work being timed.
+static double sink = 0.0;
+
+template<typename F>
+static double time_it(F f)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template<typename T>
+static void report(const string &type_name, const string &what, double seconds)
+{
+    double bytes = static_cast<double>(elements) * sizeof(T) * iterations;
+    cout << "  " << setw(8) << left << type_name << setw(36) << what << right << fixed << setprecision(4)
+         << seconds << "s  " << setprecision(1) << bytes / seconds / (1024 * 1024) << " MB/s" << endl;
+}
+
+// Run f() with one thread and then with 'threads' threads
+template<typename T, typename F>
+static void time_kernel(const string &type_name, const string &what, F f)
+{
+    kernel_max_threads = 1;
+    report<T>(type_name, what + " (1 thread)", time_it(f));
+
+    kernel_max_threads = threads;
+    report<T>(type_name, what + " (" + to_string(kernel_thread_count(elements)) + " threads)", time_it(f));
+}
+
+template<typename T>
+static void bench(const string &type_name)
+{
+    // Values in [0, 100) with a few 'missing' values (-99)
+    mt19937 gen(42);
+    uniform_int_distribution<int> dist(0, 99);
+    vector<T> values(elements);
+    for (auto &v: values)
+        v = static_cast<T>(dist(gen));
+    for (uint64_t i = 0; i < elements; i += 97)
+        values[i] = static_cast<T>(-99);
+
+    vector<dods_byte> mask(elements);
+    for (uint64_t i = 0; i < elements; ++i)
+        mask[i] = (i % 3) != 0;
+
+    // The row length used for bbox()
+    vector<uint64_t> shape = {elements / 1024, 1024};
+
+    // range()
+    report<T>(type_name, "range() as doubles", time_it([&]() {
+        vector<double> data(values.begin(), values.end());
+        kernel_max_threads = 1;
+        sink += find_min_max(data.data(), data.size(), false, 0).max_val;
+    }));
+    time_kernel<T>(type_name, "range() typed", [&]() {
+        sink += find_min_max_kernel(values.data(), elements, false, 0).max_val;
+    });
+    time_kernel<T>(type_name, "range() typed, missing value", [&]() {
+        sink += find_min_max_kernel(values.data(), elements, true, -99).max_val;
+    });
+
+    // bbox()
+    report<T>(type_name, "bbox() as doubles", time_it([&]() {
+        vector<double> data(values.begin(), values.end());
+        vector<uint64_t> start, stop;
+        kernel_max_threads = 1;
+        bbox_kernel(data.data(), shape, 200, 300, start, stop);
+        sink += start.size();
+    }));
+    time_kernel<T>(type_name, "bbox() typed", [&]() {
+        vector<uint64_t> start, stop;
+        bbox_kernel(values.data(), shape, 200, 300, start, stop);
+        sink += start.size();
+    });
+
+    // mask_array()
+    report<T>(type_name, "mask_array() copy", time_it([&]() {
+        vector<T> data(values);
+        for (uint64_t i = 0; i < elements; ++i)
+            if (!mask[i]) data[i] = static_cast<T>(-1);
+        sink += data[1];
+    }));
+    time_kernel<T>(type_name, "mask_array() in place", [&]() {
+        vector<T> data(values);   // Copy so each iteration does the same work
+        mask_kernel(data.data(), mask.data(), elements, -1);
+        sink += data[1];
+    });
+
+    // linear_scale()
+    report<T>(type_name, "linear_scale() as doubles", time_it([&]() {
+        vector<double> data(values.begin(), values.end());
+        for (auto &d: data)
+            d = d * 0.5 + 10;
+        sink += data[1];
+    }));
+    time_kernel<T>(type_name, "linear_scale() typed", [&]() {
+        vector<double> data(elements);
+        linear_scale_kernel(values.data(), data.data(), elements, 0.5, 10);
+        sink += data[1];
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    int option_char;
+    while ((option_char = getopt(argc, argv, "n:i:t:")) != -1) {
+        switch (option_char) {
+        case 'n':
+            elements = strtoull(optarg, nullptr, 10);
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        default:
+            cerr << "Usage: " << argv[0] << " [-n elements] [-i iterations] [-t threads]" << endl;
+            return 1;
+        }
+    }
+
+    if (elements < 1024) {
+        cerr << "Use at least 1024 elements." << endl;
+        return 1;
+    }
+    elements -= elements % 1024;
+
+    cout << elements << " elements, " << iterations << " iterations, "
+         << (threads ? threads : thread::hardware_concurrency()) << " threads" << endl;
+
+    bench<dods_byte>("Byte");
+    bench<dods_int16>("Int16");
+    bench<dods_int32>("Int32");
+    bench<dods_float32>("Float32");
+    bench<dods_float64>("Float64");
+
+    cerr << sink << endl;
+    return 0;
+}
@@ -50,6 +50,7 @@
 
 #include "test_config.h"
 #include "test_utils.h"
+#include "ChunkStatsArray.h"
 
 #include "MaskArrayFunction.h"
 
@@ -266,6 +267,46 @@ public:
         DBG(cerr << "Out mask_array_helper_float_2d_test" << endl);
     }
 
+    // Only the part of the array that holds the set elements of the mask is read
+    void mask_array_helper_box_test()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        a.append_dim(4, "y");
+        a.append_dim(4, "x");
+        for (int i = 0; i < 16; ++i)
+            a.d_values.push_back(i);
+
+        vector<dods_byte> mask(16, 0);
+        mask[5] = mask[6] = mask[10] = 1;   // rows 1 and 2, columns 1 and 2
+
+        mask_array_helper<dods_float64>(&a, -1, mask);
+
+        CPPUNIT_ASSERT_EQUAL(4ULL, a.d_elements_read);
+        CPPUNIT_ASSERT_EQUAL(16, a.length());
+        vector<dods_float64> data(a.length());
+        a.value(data.data());
+        for (int i = 0; i < 16; ++i)
+            CPPUNIT_ASSERT_EQUAL(mask[i] ? (dods_float64)i : -1.0, data[i]);
+    }
+
+    // Nothing is read when no element of the mask is set
+    void mask_array_helper_empty_mask_test()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        a.append_dim(4, "x");
+
+        vector<dods_byte> mask(4, 0);
+        mask_array_helper<dods_float64>(&a, -1, mask);
+
+        CPPUNIT_ASSERT(!a.d_was_read);
+        vector<dods_float64> data(a.length());
+        a.value(data.data());
+        for (auto value: data)
+            CPPUNIT_ASSERT_EQUAL(-1.0, value);
+    }
+
     void float32_2d_mask_array_test()
     {
         DBG(cerr << "In float32_2d_mask_array_test..." << endl);
@@ -453,6 +494,8 @@ CPPUNIT_TEST_SUITE( MaskArrayFunctionTest );
     CPPUNIT_TEST(mask_array_helper_one_d_test);
     CPPUNIT_TEST(mask_array_helper_two_d_test);
     CPPUNIT_TEST(mask_array_helper_float_2d_test);
+    CPPUNIT_TEST(mask_array_helper_box_test);
+    CPPUNIT_TEST(mask_array_helper_empty_mask_test);
 
     CPPUNIT_TEST(float32_2d_mask_array_test);
     CPPUNIT_TEST(general_mask_array_test);
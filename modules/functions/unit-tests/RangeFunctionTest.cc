@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <limits>
 #include <functional>
+#include <memory>
 
 #include <cmath>
 #include <cppunit/TextTestRunner.h>
@@ -42,6 +43,7 @@
 #include <unistd.h>
 
 #include <libdap/BaseType.h>
+#include <libdap/Byte.h>
 #include <libdap/Float32.h>
 #include <libdap/Float64.h>
 #include <libdap/Array.h>
@@ -53,6 +55,7 @@
 #include <libdap/util.h>
 #include <libdap/debug.h>
 
+#include "ChunkStatsArray.h"
 #include "RangeFunction.h"
 
 #include "test_config.h"
@@ -414,6 +417,63 @@ public:
         DBG(cerr << __func__ << "() - END" << endl);
     }
 
+    // Ten values in two chunks; the second chunk holds one fill value
+    void make_stats_array(ChunkStatsArray &a, bool first_chunk_monotonic)
+    {
+        a.append_dim(10, "x");
+        a.d_chunk_shape.push_back(5);
+        a.d_stats.push_back(chunk_stats({0}, 1.0, 5.0, 0, first_chunk_monotonic));
+        a.d_stats.push_back(chunk_stats({5}, 2.0, 8.9, 1, true));
+        a.d_has_fill = true;
+        a.d_fill = -99.0;
+    }
+
+    void test_range_worker_chunk_stats()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a, false);
+
+        unique_ptr<Structure> result(dynamic_cast<Structure*>(range_worker(&a, -99, true)));
+        CPPUNIT_ASSERT(result);
+        CPPUNIT_ASSERT(!a.d_was_read);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("min"))->value() == 1);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("max"))->value() == 8.9);
+        CPPUNIT_ASSERT(dynamic_cast<Byte*>(result->var("is_monotonic"))->value() == 0);
+
+        // Without a missing value the fill value is part of the range
+        result.reset(dynamic_cast<Structure*>(range_worker(&a, 0, false)));
+        CPPUNIT_ASSERT(result);
+        CPPUNIT_ASSERT(!a.d_was_read);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("min"))->value() == -99);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("max"))->value() == 8.9);
+    }
+
+    // The statistics cannot show the values are monotonic, so the data are read
+    void test_range_worker_chunk_stats_monotonic()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a, true);
+
+        unique_ptr<Structure> result(dynamic_cast<Structure*>(range_worker(&a, -99, true)));
+        CPPUNIT_ASSERT(result);
+        CPPUNIT_ASSERT(a.d_was_read);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("min"))->value() == 1);
+        CPPUNIT_ASSERT(dynamic_cast<Float64*>(result->var("max"))->value() == 1);
+    }
+
+    // The missing value is inside the range of a chunk, so the data are read
+    void test_range_worker_chunk_stats_missing()
+    {
+        Float64 proto("data");
+        ChunkStatsArray a("data", &proto);
+        make_stats_array(a, false);
+
+        unique_ptr<Structure> result(dynamic_cast<Structure*>(range_worker(&a, 3, true)));
+        CPPUNIT_ASSERT(result);
+        CPPUNIT_ASSERT(a.d_was_read);
+    }
 
     CPPUNIT_TEST_SUITE( RangeFunctionTest );
 
@@ -428,6 +488,9 @@ public:
     CPPUNIT_TEST(test_range_worker_2);
     CPPUNIT_TEST(test_range_worker_3);
     CPPUNIT_TEST(test_range_worker_4);
+    CPPUNIT_TEST(test_range_worker_chunk_stats);
+    CPPUNIT_TEST(test_range_worker_chunk_stats_monotonic);
+    CPPUNIT_TEST(test_range_worker_chunk_stats_missing);
 
     CPPUNIT_TEST_SUITE_END();
 };
@@ -53,6 +53,7 @@
 #include <BESServiceRegistry.h>
 #include <BESUtil.h>
 #include <TheBESKeys.h>
+#include <BESFileHandleCache.h>
 #include <libdap/InternalErr.h>
 #include <BESInternalError.h>
 #include <BESDapError.h>
@@ -118,6 +119,7 @@ bool HDF4RequestHandler::_enable_special_eos       = false;
 bool HDF4RequestHandler::_disable_scaleoffset_comp = false;
 bool HDF4RequestHandler::_disable_ecsmetadata_min  = false;
 bool HDF4RequestHandler::_disable_ecsmetadata_all  = false;
+BESFileHandleCache<int32> *HDF4RequestHandler::_file_handle_cache = nullptr;
 
 
 // Keys to tune the performance - cache
@@ -174,6 +176,11 @@ HDF4RequestHandler::HDF4RequestHandler(const string & name) :
     _disable_ecsmetadata_min           = TheBESKeys::read_bool_key("H4.DisableECSMetaDataMin", false);
     _disable_ecsmetadata_all           = TheBESKeys::read_bool_key("H4.DisableECSMetaDataAll", false);
 
+    // Keep the SD interface of files open between variables and requests. Zero (the default) disables this.
+    int open_files = TheBESKeys::read_int_key("H4.OpenFileCacheEntries", 0);
+    if (open_files > 0 && !_file_handle_cache)
+        _file_handle_cache = new BESFileHandleCache<int32>(open_files, [](int32 sdid) { SDend(sdid); });
+
     // Keys to tune the performance - cache
     _enable_eosgeo_cachefile           = TheBESKeys::read_bool_key("H4.EnableEOSGeoCacheFile", false);
     _enable_data_cachefile             = TheBESKeys::read_bool_key("H4.EnableDataCacheFile", false);
@@ -209,6 +216,11 @@ HDF4RequestHandler::HDF4RequestHandler(const string & name) :
 
 }
 
+HDF4RequestHandler::~HDF4RequestHandler()
+{
+    delete _file_handle_cache;
+}
+
 bool HDF4RequestHandler::hdf4_build_das(BESDataHandlerInterface & dhi) {
 
 
@@ -30,8 +30,12 @@
 
 #include <string>
 
+#include "hdf.h"
+
 #include "BESRequestHandler.h"
 
+template<typename Handle> class BESFileHandleCache; // in bes/dispatch
+
 class HDF4RequestHandler:public BESRequestHandler {
 
   private:
@@ -55,6 +59,9 @@ class HDF4RequestHandler:public BESRequestHandler {
     static bool _disable_scaleoffset_comp;
     static bool _disable_ecsmetadata_min;
     static bool _disable_ecsmetadata_all;
+
+    // Open SD interface IDs kept between variables and requests (H4.OpenFileCacheEntries)
+    static BESFileHandleCache<int32> *_file_handle_cache;
     
     // Keys to tune the performance - cache
     static bool _enable_eosgeo_cachefile;
@@ -90,7 +97,7 @@ class HDF4RequestHandler:public BESRequestHandler {
 
   public:
     explicit HDF4RequestHandler(const std::string & name);
-    ~HDF4RequestHandler(void) override = default;
+    ~HDF4RequestHandler(void) override;
 
     static bool hdf4_build_das(BESDataHandlerInterface & dhi);
     static bool hdf4_build_dds(BESDataHandlerInterface & dhi);
@@ -111,6 +118,7 @@ class HDF4RequestHandler:public BESRequestHandler {
     static bool get_disable_scaleoffset_comp() { return _disable_scaleoffset_comp; }
     static bool get_disable_ecsmetadata_min() { return _disable_ecsmetadata_min; }
     static bool get_disable_ecsmetadata_all() { return _disable_ecsmetadata_all; }
+    static BESFileHandleCache<int32> *get_file_handle_cache() { return _file_handle_cache; }
 
     // Keys to tune the performance - cache
     static bool get_enable_eosgeo_cachefile() { return _enable_eosgeo_cachefile;}
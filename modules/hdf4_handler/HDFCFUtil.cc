@@ -4,6 +4,7 @@
 #include "HDFCFUtil.h"
 #include <BESDebug.h>
 #include <BESLog.h>
+#include <BESFileHandleCache.h>
 #include <math.h>
 #include"dodsutil.h"
 #include"HDFSPArray_RealField.h"
@@ -3572,10 +3573,26 @@ ssize_t HDFCFUtil::read_buffer_from_file(int fd,  void*buf, size_t total_read) {
     
     return ret_val;
 }
+int32 HDFCFUtil::open_sd_file(const string &filename) {
+
+    BESFileHandleCache<int32> *cache = HDF4RequestHandler::get_file_handle_cache();
+    int32 sdid = -1;
+    if (cache && cache->get(filename, sdid))
+        return sdid;
+
+    sdid = SDstart(const_cast<char *>(filename.c_str()), DFACC_READ);
+    if (sdid >= 0 && cache)
+        cache->add(filename, sdid);
+
+    return sdid;
+}
+
 void HDFCFUtil::close_fileid(int32 sdfd, int32 fileid,int32 gridfd, int32 swathfd,bool pass_fileid) {
 
     if(false == pass_fileid) {
-        if(sdfd != -1)
+        // SD IDs from open_sd_file() may belong to the open file cache.
+        BESFileHandleCache<int32> *cache = HDF4RequestHandler::get_file_handle_cache();
+        if(sdfd != -1 && !(cache && cache->release(sdfd)))
             SDend(sdfd);
         if(fileid != -1)
             Hclose(fileid);
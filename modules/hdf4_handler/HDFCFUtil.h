@@ -68,6 +68,10 @@ struct HDFCFUtil
 
     /// Close HDF4 and HDF-EOS2 file IDs. For performance reasons, we want to keep HDF-EOS2/HDF4 IDs open
     /// for one operation(DDS,DAS or DATA). In case of exceptions, these IDs need to be closed.
+    /// Open the SD interface of a file, reusing an open SD ID if there is one (see H4.OpenFileCacheEntries).
+    /// Close it with close_fileid().
+    static int32 open_sd_file(const std::string &filename);
+
     static void close_fileid(int32 sdfd,int32 file_id,int32 gridfd,int32 swathfd,bool pass_fileid_key);
 
     static std::string escattr_fvalue(std::string  s);
@@ -1425,6 +1425,14 @@ HDFEOS2ArrayGridGeoField::CalculateLatLon (int32 gridid, int g_fieldtype,
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
 
+    // When the lat/lon is not written to the cache and the request is a subset,
+    // only pass the constrained points to GDij2ll instead of the whole grid.
+    if (false == write_latlon_cache && nelms != (xdim * ydim)) {
+        CalculateLatLonSubset(g_fieldtype, outlatlon, projcode, zone, params, sphere, xdim, ydim,
+                              upleft, lowright, pixreg, origin, offset, count, step, nelms);
+        return;
+    }
+
     vector<int32>rows;
     vector<int32>cols;
     vector<float64>lon;
@@ -1583,6 +1591,47 @@ HDFEOS2ArrayGridGeoField::CalculateLatLon (int32 gridid, int g_fieldtype,
 }
 
 
+// Calculate lat/lon with GDij2ll only for the points in the subset, in the
+// order LatLon2DSubset would have copied them from the whole grid. The cost
+// is proportional to the number of points requested, not to the grid size.
+void
+HDFEOS2ArrayGridGeoField::CalculateLatLonSubset (int g_fieldtype, float64 * outlatlon,
+                                                 int32 projcode, int32 zone, float64 * params, int32 sphere,
+                                                 int32 xdim, int32 ydim, float64 * upleft, float64 * lowright,
+                                                 int32 pixreg, int32 origin,
+                                                 const int32 * offset, const int32 * count,
+                                                 const int32 * step, int nelms) const
+{
+    vector<int32>rows(nelms);
+    vector<int32>cols(nelms);
+    vector<float64>lon(nelms);
+    vector<float64>lat(nelms);
+
+    // With ydimmajor, the first dimension of the field is Y (rows); otherwise it is X (columns).
+    int k = 0;
+    for (int i = 0; i < count[0]; i++) {
+        int32 dim0index = offset[0] + i * step[0];
+        for (int j = 0; j < count[1]; j++) {
+            int32 dim1index = offset[1] + j * step[1];
+            rows[k] = ydimmajor ? dim0index : dim1index;
+            cols[k] = ydimmajor ? dim1index : dim0index;
+            k++;
+        }
+    }
+
+    int r = GDij2ll (projcode, zone, params, sphere, xdim, ydim, upleft, lowright,
+                     nelms, rows.data(), cols.data(), lon.data(), lat.data(), pixreg, origin);
+    if (r != 0) {
+        string msg = "Cannot calculate grid latitude and longitude.";
+        throw BESInternalError(msg,__FILE__,__LINE__);
+    }
+
+    if (g_fieldtype == 1)
+        memcpy (outlatlon, lat.data(), nelms * sizeof (double));
+    else
+        memcpy (outlatlon, lon.data(), nelms * sizeof (double));
+}
+
 // Map the subset of the lat/lon buffer to the corresponding 2D array.
 template<class T> void
 HDFEOS2ArrayGridGeoField::LatLon2DSubset (T * outlatlon, int /*majordim */,
@@ -126,6 +126,11 @@ class HDFEOS2ArrayGridGeoField:public libdap::Array
         // Calculate Lat and Lon based on HDF-EOS2 library.
         void CalculateLatLon (int32 gridid, int fieldtype, int specialformat, float64 * outlatlon, float64* latlon_all, const int32 * offset, const int32 * count, const int32 * step, int nelms,bool write_latlon_cache);
 
+        // Calculate Latitude and Longitude with GDij2ll only for the points in the subset.
+        void CalculateLatLonSubset (int fieldtype, float64 * outlatlon, int32 projcode, int32 zone, float64 * params, int32 sphere,
+                                    int32 xdim, int32 ydim, float64 * upleft, float64 * lowright, int32 pixreg, int32 origin,
+                                    const int32 * offset, const int32 * count, const int32 * step, int nelms) const;
+
         // Calculate Special Latitude and Longitude.
         //One MOD13C2 file doesn't provide projection code
         // The upperleft and lowerright coordinates are all -1
@@ -213,7 +213,7 @@ HDFSPArrayGeoField::readtrmml2_v6 (const int32 * offset32, const int32 * count32
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__, __LINE__);
@@ -526,7 +526,7 @@ HDFSPArrayGeoField::readtrmml3_v7 (const int32 * offset32,
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__, __LINE__);
@@ -635,7 +635,7 @@ HDFSPArrayGeoField::readobpgl2 (int32 * offset32, int32 * count32,
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File "+ filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__, __LINE__);
@@ -937,7 +937,7 @@ HDFSPArrayGeoField::readobpgl3 (const int *offset,  const int *step, const int n
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -1354,7 +1354,7 @@ HDFSPArrayGeoField::readceravgsyn (int32 * offset32, int32 * count32,
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__, __LINE__);
@@ -1469,7 +1469,7 @@ HDFSPArrayGeoField::readceres4ig (const int32 * offset32, const int32 * count32,
     int32 sdid = -1;
 
     if(false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__, __LINE__);
@@ -167,7 +167,7 @@ HDFSPArray_RealField::read ()
 
     // Obtain SD ID.
     if (false == check_pass_fileid_key) {
-        sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+        sdid = HDFCFUtil::open_sd_file(filename);
         if (sdid < 0) {
             string msg = "File " + filename + " cannot be open.";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -179,7 +179,7 @@ HDFSPArray_RealField::read ()
 
         if (true == HDF4RequestHandler::get_enable_metadata_cachefile()) {
 
-            sdid = SDstart (const_cast < char *>(filename.c_str ()), DFACC_READ);
+            sdid = HDFCFUtil::open_sd_file(filename);
             if (sdid < 0) {
                 string msg =  "File " + filename + " cannot be open.";
                 throw BESInternalError(msg,__FILE__,__LINE__);
@@ -43,6 +43,7 @@
 #include "HDF5Array.h"
 #include "HDF5Structure.h"
 #include "HDF5Str.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -110,7 +111,12 @@ bool HDF5Array::read()
 	    << " data_size=" << d_memneed << " length=" << length()
 	    << endl);
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    vector<int64_t> offset(d_num_dim);
+    vector<int64_t> count(d_num_dim);
+    vector<int64_t> step(d_num_dim);
+    int64_t nelms = format_constraint(offset.data(), step.data(), count.data()); // Throws Error.
+
+    hid_t file_id = open_hdf5_file(dataset());
 
     BESDEBUG("h5","variable name is "<<name() <<endl);
     BESDEBUG("h5","variable path is  "<<var_path <<endl);
@@ -118,25 +124,20 @@ bool HDF5Array::read()
     hid_t dset_id = -1;
 
     if (true == is_dap4())
-        dset_id = H5Dopen2(file_id,var_path.c_str(),H5P_DEFAULT);
+        dset_id = open_hdf5_dataset(file_id,var_path,d_num_dim,offset.data(),step.data(),count.data());
     else 
-        dset_id = H5Dopen2(file_id,name().c_str(),H5P_DEFAULT);
+        dset_id = open_hdf5_dataset(file_id,name(),d_num_dim,offset.data(),step.data(),count.data());
 
     BESDEBUG("h5","after H5Dopen2 "<<endl);
 
     hid_t dtype_id = H5Dget_type(dset_id);
     if(dtype_id < 0) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the datatype .";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
 
- 
-    vector<int64_t> offset(d_num_dim);
-    vector<int64_t> count(d_num_dim);
-    vector<int64_t> step(d_num_dim);
-    int64_t nelms = format_constraint(offset.data(), step.data(), count.data()); // Throws Error.
     vector<char>values;
 
     // We only map the reference to URL when the dataset is an array of reference.
@@ -146,13 +147,13 @@ bool HDF5Array::read()
 	    ret_ref = m_array_of_reference(dset_id);
             H5Tclose(dtype_id);
             H5Dclose(dset_id);
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
  
         }
         catch(...) {
             H5Tclose(dtype_id);
             H5Dclose(dset_id);
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
             throw;
  
         }
@@ -165,13 +166,13 @@ bool HDF5Array::read()
     catch(...) {
         H5Tclose(dtype_id);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw; 
     }
 
     H5Tclose(dtype_id);
     H5Dclose(dset_id);
-    H5Fclose(file_id);
+    close_hdf5_file(file_id);
     
     return true;
 }
@@ -43,6 +43,7 @@
 #include <BESInternalError.h>
 #include "h5dds.h"
 #include "HDF5Byte.h"
+#include "h5common.h"
 
 
 using namespace std;
@@ -64,7 +65,7 @@ bool HDF5Byte::read()
     // The dataset() will return the full path of the variable for the CF option scalar type. See HDF5CFByte.cc. 
     // Make dataset() return the same kind of object name is a low-priority TODO task. This also applies to HDF5Int16.cc, HDF5Float32.cc, etc.
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -81,7 +82,7 @@ bool HDF5Byte::read()
 #endif
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -98,12 +99,12 @@ bool HDF5Byte::read()
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
 
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
 
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
@@ -38,6 +38,7 @@
 #include "HDF5CFArray.h"
 #include "h5cfdaputil.h"
 #include "ObjMemCache.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -278,13 +279,13 @@ void HDF5CFArray::read_data_NOT_from_mem_cache(bool add_mem_cache,void*buf) {
    
     bool pass_fileid = HDF5RequestHandler::get_pass_fileid();
     if(false == pass_fileid) {
-        if ((fileid = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,H5P_DEFAULT))<0) {
+        if ((fileid = open_hdf5_file(filename))<0) {
             string msg = "HDF5 File " + filename + " cannot be opened. ";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
     }
 
-    if ((dsetid = H5Dopen(fileid,varname.c_str(),H5P_DEFAULT))<0) {
+    if ((dsetid = open_hdf5_dataset(fileid,varname,rank,offset.data(),step.data(),count.data()))<0) {
         HDF5CFUtil::close_fileid(fileid,pass_fileid);
         string msg = "H5Dopen() failed for the variable " + varname + ".";
         throw BESInternalError(msg,__FILE__,__LINE__);
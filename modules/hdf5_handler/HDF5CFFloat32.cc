@@ -60,7 +60,7 @@ bool HDF5CFFloat32::read()
     if (read_p())
         return true;
 
-    hid_t file_id = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(filename);
     if (file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -69,7 +69,7 @@ bool HDF5CFFloat32::read()
     hid_t dset_id = -1;
     dset_id = H5Dopen2(file_id,dataset().c_str(),H5P_DEFAULT);
     if (dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -86,11 +86,11 @@ bool HDF5CFFloat32::read()
             string msg = "Unable to close the HDF5 dataset " + dataset() +".";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
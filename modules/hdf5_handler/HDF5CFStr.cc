@@ -40,6 +40,7 @@
 #include "HDF5RequestHandler.h"
 #include "h5cfdaputil.h"
 #include "HDF5CFStr.h"
+#include "h5common.h"
 #include <hdf5.h>
 
 using namespace std;
@@ -66,27 +67,27 @@ bool HDF5CFStr::read()
     hid_t dtypeid = -1;
     hid_t memtype = -1;
 
-    if ((fileid = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT))<0) {
+    if ((fileid = open_hdf5_file(dataset()))<0) {
         string msg = "HDF5 File " + dataset() + " cannot be opened. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
 
     if ((dsetid = H5Dopen(fileid,varname.c_str(),H5P_DEFAULT))<0) {
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = "HDF5 dataset " + varname  + " cannot be opened. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
 
     if ((dspace = H5Dget_space(dsetid))<0) {
         H5Dclose(dsetid);
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = "Space id of the HDF5 dataset " + varname + " cannot be obtained. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
 
     if (H5S_SCALAR != H5Sget_simple_extent_type(dspace)) {
         H5Dclose(dsetid);
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = " The HDF5 dataset " + varname + " is not scalar.";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -95,7 +96,7 @@ bool HDF5CFStr::read()
     if ((dtypeid = H5Dget_type(dsetid)) < 0) {
         H5Sclose(dspace);
         H5Dclose(dsetid);
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = " Obtaining the datatype of the HDF5 dataset " + varname +" fails.";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -104,7 +105,7 @@ bool HDF5CFStr::read()
         H5Tclose(dtypeid);
         H5Sclose(dspace);
         H5Dclose(dsetid);
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = "Obtaining the memory type of the HDF5 dataset " + varname + " fails.";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -117,7 +118,7 @@ bool HDF5CFStr::read()
             H5Tclose(dtypeid);
             H5Sclose(dspace);
             H5Dclose(dsetid);
-            H5Fclose(fileid);
+            close_hdf5_file(fileid);
             string msg = "Cannot obtain the size of the fixed size HDF5 string of the dataset" + varname + " fails.";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
@@ -131,7 +132,7 @@ bool HDF5CFStr::read()
             H5Tclose(dtypeid);
             H5Sclose(dspace);
             H5Dclose(dsetid);
-            H5Fclose(fileid);
+            close_hdf5_file(fileid);
             string msg = "Cannot read the HDF5 dataset " + varname + " with the type of the HDF5 variable length string.";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
@@ -155,7 +156,7 @@ bool HDF5CFStr::read()
                 H5Tclose(dtypeid);
                 H5Sclose(dspace);
                 H5Dclose(dsetid);
-                H5Fclose(fileid);
+                close_hdf5_file(fileid);
                 string msg = "Cannot reclaim the memory buffer of the HDF5 variable length string of the dataset ";
                 msg = msg + varname + ".";
                 throw BESInternalError(msg,__FILE__,__LINE__);
@@ -179,7 +180,7 @@ bool HDF5CFStr::read()
             H5Tclose(dtypeid);
             H5Sclose(dspace);
             H5Dclose(dsetid);
-            H5Fclose(fileid);
+            close_hdf5_file(fileid);
             string msg = "Cannot obtain the size of the fixed size HDF5 string of the dataset ";
             msg = msg + varname + ".";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -194,7 +195,7 @@ bool HDF5CFStr::read()
             H5Tclose(dtypeid);
             H5Sclose(dspace);
             H5Dclose(dsetid);
-            H5Fclose(fileid);
+            close_hdf5_file(fileid);
             string msg = "Cannot read the HDF5 dataset ";
             msg = msg + " with the type of the fixed size HDF5 string.";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -228,7 +229,7 @@ bool HDF5CFStr::read()
         H5Tclose(dtypeid);
         H5Sclose(dspace);
         H5Dclose(dsetid);
-        H5Fclose(fileid);
+        close_hdf5_file(fileid);
         string msg = "H5Tis_variable_str returns negative value.";
         throw BESInternalError(msg,__FILE__,__LINE__);
     } 
@@ -237,7 +238,7 @@ bool HDF5CFStr::read()
     H5Tclose(dtypeid);
     H5Sclose(dspace);
     H5Dclose(dsetid);
-    H5Fclose(fileid);
+    close_hdf5_file(fileid);
 
 
     return true;
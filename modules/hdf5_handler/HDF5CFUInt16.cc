@@ -62,7 +62,7 @@ bool HDF5CFUInt16::read()
         return true;
 
     hid_t file_id = -1;
-    if ((file_id = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,H5P_DEFAULT))<0) {
+    if ((file_id = open_hdf5_file(filename))<0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -71,7 +71,7 @@ bool HDF5CFUInt16::read()
 
     dset_id = H5Dopen2(file_id,dataset().c_str(),H5P_DEFAULT);
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -88,11 +88,11 @@ bool HDF5CFUInt16::read()
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
 
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
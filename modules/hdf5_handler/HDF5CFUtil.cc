@@ -31,6 +31,7 @@
 
 #include "HDF5CFUtil.h"
 #include "HDF5RequestHandler.h"
+#include "h5common.h"
 #include <set>
 #include <sstream>
 #include <algorithm>
@@ -577,7 +578,7 @@ void HDF5CFUtil::parser_gpm_l3_gridheader(const vector<char>& value,
 
 void HDF5CFUtil::close_fileid(hid_t file_id,bool pass_fileid) {
     if((false == pass_fileid) && (file_id !=-1)) 
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
 }
 
 // Somehow the conversion of double to c++ string with sprintf causes the memory error in
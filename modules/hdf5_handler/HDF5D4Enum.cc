@@ -35,6 +35,7 @@
 #include <BESInternalError.h>
 
 #include "HDF5D4Enum.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -59,7 +60,7 @@ bool HDF5D4Enum::read()
         throw InternalErr(__FILE__,__LINE__, msg);
     }
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() + ".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -68,7 +69,7 @@ bool HDF5D4Enum::read()
     hid_t dset_id = -1;
     dset_id = H5Dopen2(file_id,var_path.c_str(),H5P_DEFAULT);
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -76,14 +77,14 @@ bool HDF5D4Enum::read()
     hid_t dtypeid = H5Dget_type(dset_id); 
     if(dtypeid < 0) { 
         H5Dclose(dset_id); 
-        H5Fclose(file_id); 
+        close_hdf5_file(file_id); 
         string msg = "Fail to obtain the datatype for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg); 
     } 
 
     if (H5T_ENUM != H5Tget_class(dtypeid)) {
         H5Dclose(dset_id); 
-        H5Fclose(file_id); 
+        close_hdf5_file(file_id); 
         string msg = "Fail to obtain the enum datatype class for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg); 
     }
@@ -238,6 +239,6 @@ void HDF5D4Enum::close_objids(hid_t mem_type, hid_t base_type, hid_t dtype, hid_
     if (dset_id >0)
         H5Dclose(dset_id);
     if (file_id >0)
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
 
 }
@@ -40,6 +40,7 @@
 #include <libdap/InternalErr.h>
 #include <BESInternalError.h>
 #include "HDF5Float32.h"
+#include "h5common.h"
 
 
 using namespace std;
@@ -60,7 +61,7 @@ bool HDF5Float32::read()
     if (read_p())
         return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if (file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -78,7 +79,7 @@ bool HDF5Float32::read()
 #endif
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -96,11 +97,11 @@ bool HDF5Float32::read()
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
 
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
@@ -37,6 +37,7 @@
 #include "HDF5RequestHandler.h"
 #include "HDF5GMCFMissLLArray.h"
 #include "h5apicompatible.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -117,7 +118,7 @@ void HDF5GMCFMissLLArray::obtain_aqu_obpg_l3_ll(const int64_t* offset, const int
 
     bool check_pass_fileid_key = HDF5RequestHandler::get_pass_fileid();
     if (false == check_pass_fileid_key) {
-        if ((fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0) {
+        if ((fileid = open_hdf5_file(filename)) < 0) {
             string msg = "HDF5 File " + filename + " cannot be opened. ";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
@@ -243,7 +244,7 @@ void HDF5GMCFMissLLArray::obtain_gpm_l3_ll(const int64_t* offset, const int64_t*
     bool check_pass_fileid_key = HDF5RequestHandler::get_pass_fileid();
 
     if (false == check_pass_fileid_key) {
-        if ((fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0) {
+        if ((fileid = open_hdf5_file(filename)) < 0) {
             string msg = "HDF5 File " + filename + " cannot be opened. ";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
@@ -315,7 +316,7 @@ void HDF5GMCFMissLLArray::obtain_gpm_l3_ll(const int64_t* offset, const int64_t*
         }
         catch (...) {
             H5Gclose(grid_grp_id);
-            H5Fclose(fileid);
+            close_hdf5_file(fileid);
             throw;
         }
     
@@ -462,7 +463,7 @@ void HDF5GMCFMissLLArray::obtain_gpm_l3_new_grid_info(hid_t file,
 
    herr_t ret_o= H5OVISIT(file, H5_INDEX_NAME, H5_ITER_INC, visit_obj_cb, (void*)&attr_na);
    if(ret_o < 0){
-        H5Fclose(file);
+        close_hdf5_file(file);
         string msg = "H5OVISIT failed. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
    }
@@ -482,7 +483,7 @@ void HDF5GMCFMissLLArray::obtain_gpm_l3_new_grid_info(hid_t file,
         // In this round, we need to release the memory allocated for the second grid info.
         herr_t ret_o2= H5OVISIT(file, H5_INDEX_NAME, H5_ITER_INC, visit_obj_cb, (void*)&attr_na);
         if(ret_o2 < 0) {
-            H5Fclose(file);
+            close_hdf5_file(file);
             string msg = "H5OVISIT failed again. ";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
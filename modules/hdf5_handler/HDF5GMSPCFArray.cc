@@ -39,6 +39,7 @@
 
 #include "HDF5RequestHandler.h"
 #include "HDF5GMSPCFArray.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -111,13 +112,13 @@ void HDF5GMSPCFArray::read_data_NOT_from_mem_cache(bool /*add_cache*/,void*/*buf
     hid_t memtype = -1;
 
     if(false == check_pass_fileid_key) {
-        if ((fileid = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,H5P_DEFAULT))<0) {
+        if ((fileid = open_hdf5_file(filename))<0) {
             string msg = "HDF5 File " + filename + " cannot be opened. ";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
     }
 
-    if ((dsetid = H5Dopen(fileid,varname.c_str(),H5P_DEFAULT))<0) {
+    if ((dsetid = open_hdf5_dataset(fileid,varname,rank,offset.data(),step.data(),count.data()))<0) {
         HDF5CFUtil::close_fileid(fileid,check_pass_fileid_key);
         string msg = "HDF5 dataset " + varname + " cannot be opened. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
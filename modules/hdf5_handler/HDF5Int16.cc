@@ -45,6 +45,7 @@
 
 #include "h5dds.h"
 #include "HDF5Int16.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -72,7 +73,7 @@ bool HDF5Int16::read()
     if (read_p())
      return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -89,7 +90,7 @@ bool HDF5Int16::read()
 #endif 
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -97,7 +98,7 @@ bool HDF5Int16::read()
     hid_t dtypeid = H5Dget_type(dset_id); 
     if(dtypeid < 0) { 
         H5Dclose(dset_id); 
-        H5Fclose(file_id); 
+        close_hdf5_file(file_id); 
         string msg = "Fail to obtain the datatype for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg); 
     } 
@@ -107,7 +108,7 @@ bool HDF5Int16::read()
     if (memtype < 0){
         H5Tclose(dtypeid);
         H5Dclose(dset_id); 
-        H5Fclose(file_id); 
+        close_hdf5_file(file_id); 
         string msg = "Fail to obtain the memory datatype for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg); 
     }
@@ -150,14 +151,14 @@ bool HDF5Int16::read()
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
 
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
 
     catch(...) {
         H5Tclose(memtype);
         H5Tclose(dtypeid);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
     return true;
@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////////////////
+// This file is part of the hdf5 data handler for the OPeNDAP data server.
+//
+// A read-only HDF5 virtual file driver that reads remote files (see
+// http::RangeReadFile) using HTTP Range GETs.
+//
+// Copyright (c) 2024 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "BESDebug.h"
+#include "BESError.h"
+#include "BESLog.h"
+#include "BESInternalError.h"
+
+#include "RangeReadFile.h"
+
+#include "HDF5RangeReadVFD.h"
+
+using namespace std;
+
+// The HDF5 file handle for the driver. 'pub' must be the first member; the
+// library only sees the H5FD_t.
+typedef struct H5FD_range_read_t {
+    H5FD_t pub;
+    shared_ptr<http::RangeReadFile> *file;
+    haddr_t eoa;
+} H5FD_range_read_t;
+
+static H5FD_t *range_read_open(const char *name, unsigned flags, hid_t /*fapl*/, haddr_t /*maxaddr*/)
+{
+    if (flags & (H5F_ACC_RDWR | H5F_ACC_CREAT | H5F_ACC_TRUNC))
+        return nullptr;
+
+    auto file = http::RangeReadFile::find(name);
+    if (!file)
+        return nullptr;
+
+    auto handle = new H5FD_range_read_t;
+    memset(&handle->pub, 0, sizeof(H5FD_t));
+    handle->file = new shared_ptr<http::RangeReadFile>(file);
+    handle->eoa = 0;
+
+    BESDEBUG("h5", "Opened " << name << " using HTTP Range GETs (" << file->size() << " bytes)" << endl);
+    return &handle->pub;
+}
+
+static herr_t range_read_close(H5FD_t *_file)
+{
+    auto handle = reinterpret_cast<H5FD_range_read_t *>(_file);
+    BESDEBUG("h5", "Closed " << (*handle->file)->get_url() << "; " << (*handle->file)->get_requests()
+             << " requests, " << (*handle->file)->get_bytes_transferred() << " bytes" << endl);
+    delete handle->file;
+    delete handle;
+    return 0;
+}
+
+static int range_read_cmp(const H5FD_t *f1, const H5FD_t *f2)
+{
+    auto a = reinterpret_cast<const H5FD_range_read_t *>(f1)->file->get();
+    auto b = reinterpret_cast<const H5FD_range_read_t *>(f2)->file->get();
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static herr_t range_read_query(const H5FD_t * /*f*/, unsigned long *flags)
+{
+    // Let the library aggregate metadata and small raw data reads so fewer
+    // (and larger) reads reach the block cache.
+    if (flags)
+        *flags = H5FD_FEAT_AGGREGATE_METADATA | H5FD_FEAT_ACCUMULATE_METADATA | H5FD_FEAT_DATA_SIEVE
+                 | H5FD_FEAT_AGGREGATE_SMALLDATA;
+    return 0;
+}
+
+static haddr_t range_read_get_eoa(const H5FD_t *_file, H5FD_mem_t /*type*/)
+{
+    return reinterpret_cast<const H5FD_range_read_t *>(_file)->eoa;
+}
+
+static herr_t range_read_set_eoa(H5FD_t *_file, H5FD_mem_t /*type*/, haddr_t addr)
+{
+    reinterpret_cast<H5FD_range_read_t *>(_file)->eoa = addr;
+    return 0;
+}
+
+static haddr_t range_read_get_eof(const H5FD_t *_file, H5FD_mem_t /*type*/)
+{
+    return (*reinterpret_cast<const H5FD_range_read_t *>(_file)->file)->size();
+}
+
+static herr_t range_read_read(H5FD_t *_file, H5FD_mem_t /*type*/, hid_t /*dxpl*/, haddr_t addr, size_t size,
+                              void *buf)
+{
+    auto &file = *reinterpret_cast<H5FD_range_read_t *>(_file)->file;
+
+    // Exceptions must not cross the HDF5 library; log the reason and fail the read.
+    try {
+        // HDF5 reads past the EOF as zeros.
+        unsigned long long eof = file->size();
+        size_t in_file = (addr >= eof) ? 0 : static_cast<size_t>(min<unsigned long long>(size, eof - addr));
+        file->read(static_cast<char *>(buf), in_file, addr);
+        if (in_file < size)
+            memset(static_cast<char *>(buf) + in_file, 0, size - in_file);
+    }
+    catch (BESError &e) {
+        ERROR_LOG("HDF5 range read of " + file->get_url() + " failed: " + e.get_message());
+        return -1;
+    }
+    catch (std::exception &e) {
+        ERROR_LOG("HDF5 range read of " + file->get_url() + " failed: " + e.what());
+        return -1;
+    }
+
+    return 0;
+}
+
+static herr_t range_read_write(H5FD_t * /*file*/, H5FD_mem_t /*type*/, hid_t /*dxpl*/, haddr_t /*addr*/,
+                               size_t /*size*/, const void * /*buf*/)
+{
+    return -1;
+}
+
+static H5FD_class_t make_range_read_class()
+{
+    H5FD_class_t cls;
+    memset(&cls, 0, sizeof(cls));
+
+#ifdef H5FD_CLASS_VERSION
+    cls.version = H5FD_CLASS_VERSION;
+    cls.value = (H5FD_class_value_t) 511;  // 256-511 are for testing and unregistered drivers
+#endif
+    cls.name = "bes_range_read";
+    cls.maxaddr = HADDR_MAX;
+    cls.fc_degree = H5F_CLOSE_WEAK;
+    cls.open = range_read_open;
+    cls.close = range_read_close;
+    cls.cmp = range_read_cmp;
+    cls.query = range_read_query;
+    cls.get_eoa = range_read_get_eoa;
+    cls.set_eoa = range_read_set_eoa;
+    cls.get_eof = range_read_get_eof;
+    cls.read = range_read_read;
+    cls.write = range_read_write;
+    for (int i = 0; i < H5FD_MEM_NTYPES; ++i)
+        cls.fl_map[i] = H5FD_MEM_DEFAULT;
+
+    return cls;
+}
+
+// Registered once and never closed; HDF5 keeps a pointer to the class.
+static H5FD_class_t range_read_class = make_range_read_class();
+
+hid_t get_hdf5_fapl(const string &filename)
+{
+    static mutex fapl_mutex;
+    static hid_t fapl = H5I_INVALID_HID;
+
+    if (!http::RangeReadFile::find(filename))
+        return H5P_DEFAULT;
+
+    lock_guard<mutex> lock(fapl_mutex);
+    if (fapl == H5I_INVALID_HID) {
+        hid_t driver = H5FDregister(&range_read_class);
+        if (driver < 0)
+            throw BESInternalError("Could not register the HDF5 range read driver.", __FILE__, __LINE__);
+
+        fapl = H5Pcreate(H5P_FILE_ACCESS);
+        if (fapl < 0 || H5Pset_driver(fapl, driver, nullptr) < 0) {
+            fapl = H5I_INVALID_HID;
+            throw BESInternalError("Could not make the HDF5 range read file access property list.", __FILE__,
+                                   __LINE__);
+        }
+    }
+
+    return fapl;
+}
@@ -0,0 +1,39 @@
+/////////////////////////////////////////////////////////////////////////////
+// This file is part of the hdf5 data handler for the OPeNDAP data server.
+//
+// A read-only HDF5 virtual file driver that reads remote files (see
+// http::RangeReadFile) using HTTP Range GETs.
+//
+// Copyright (c) 2024 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HDF5_RANGE_READ_VFD_H
+#define _HDF5_RANGE_READ_VFD_H
+
+#include <string>
+
+#include <hdf5.h>
+
+/// Get the file access property list to use with H5Fopen() for filename.
+///
+/// When the gateway (or NcML) passes the name of a remote resource that is
+/// read using HTTP Range GETs instead of a downloaded file, this returns a
+/// property list that uses the range-read driver. Otherwise it returns
+/// H5P_DEFAULT. The property list is owned by this module; do not close it.
+hid_t get_hdf5_fapl(const std::string &filename);
+
+#endif
@@ -44,6 +44,7 @@
 #include <libdap/DMR.h>
 #include <libdap/D4BaseTypeFactory.h>
 #include <ObjMemCache.h>
+#include <BESFileHandleCache.h>
 #include "HDF5_DMR.h"
 
 #include <libdap/mime_util.h>
@@ -70,6 +71,7 @@
 
 #define HDF5_NAME "h5"
 #include "h5cfdaputil.h"
+#include "HDF5RangeReadVFD.h"
 
 using namespace std;
 using namespace libdap;
@@ -125,6 +127,12 @@ ObjMemCache *HDF5RequestHandler::dmr_cache = nullptr;
 
 ObjMemCache *HDF5RequestHandler::lrdata_mem_cache = nullptr;
 ObjMemCache *HDF5RequestHandler::srdata_mem_cache = nullptr;
+BESFileHandleCache<hid_t> *HDF5RequestHandler::file_handle_cache = nullptr;
+
+size_t HDF5RequestHandler::_chunk_cache_size = 0;
+size_t HDF5RequestHandler::_chunk_cache_max_size = 0;
+size_t HDF5RequestHandler::_chunk_cache_slots = 0;
+double HDF5RequestHandler::_chunk_cache_w0 = -1.0;
 
 // Set default values of all BES keys according to h5.conf.in.
 // This will help the dmrpp module. No need to
@@ -217,6 +225,7 @@ HDF5RequestHandler::~HDF5RequestHandler()
     delete dmr_cache;
     delete lrdata_mem_cache;
     delete srdata_mem_cache;
+    delete file_handle_cache;
      
 }
 
@@ -241,6 +250,20 @@ void HDF5RequestHandler::load_config()
         dmr_cache = new ObjMemCache(get_mdcache_entries(), get_cache_purge_level());
     }
 
+    // Keep HDF5 files open between variables and requests. Zero (the default) disables this.
+    int open_files = TheBESKeys::read_int_key("H5.OpenFileCacheEntries", 0);
+    if (open_files > 0 && !file_handle_cache)
+        file_handle_cache = new BESFileHandleCache<hid_t>(open_files, [](hid_t file_id) { H5Fclose(file_id); });
+
+    // The raw data chunk cache used when reading a chunked dataset (see open_hdf5_dataset()).
+    // Zero, and a negative w0, mean the HDF5 library's defaults.
+    _chunk_cache_size = TheBESKeys::read_ulong_key("H5.ChunkCacheSize", 0);
+    _chunk_cache_max_size = TheBESKeys::read_ulong_key("H5.ChunkCacheMaxSize", 0);
+    _chunk_cache_slots = TheBESKeys::read_ulong_key("H5.ChunkCacheSlots", 0);
+    _chunk_cache_w0 = TheBESKeys::read_float_key("H5.ChunkCacheW0", -1.0F);
+    if (_chunk_cache_w0 > 1.0)
+        throw BESInternalError("H5.ChunkCacheW0 must be between 0 and 1.", __FILE__, __LINE__);
+
     // Starting from hyrax 1.16.5, users don't need to explicitly set the BES keys if
     // they are happy with the default settings in the h5.conf.in.
     // In the previous releases, we required users to set BES key values. Otherwise,
@@ -590,7 +613,7 @@ void HDF5RequestHandler::hdf5_build_das_internal_no_mem_cache(const string& file
         H5Eset_auto2(H5E_DEFAULT,nullptr,nullptr);
         if (true == _usecf) {//CF option
 
-            cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
             if (cf_fileid < 0){
                 string invalid_file_msg="Could not open this HDF5 file ";
                 invalid_file_msg +=filename;
@@ -768,7 +791,7 @@ void HDF5RequestHandler::read_dds_from_file(DDS *dds, const string &filename, hi
     // For the time being, not mess up CF's fileID with Default's fileID
     if (true == _usecf) {
 
-        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
         if (cf_fileid < 0){
             string invalid_file_msg="Could not open this HDF5 file ";
             invalid_file_msg +=filename;
@@ -914,7 +937,7 @@ void HDF5RequestHandler::read_datadds_from_file(DDS *dds, const string &filename
     // For the time being, not mess up CF's fileID with Default's fileID
     if (true == _usecf) {
 
-        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
         if (cf_fileid < 0){
             string invalid_file_msg="Could not open this HDF5 file ";
             invalid_file_msg +=filename;
@@ -1166,7 +1189,7 @@ bool HDF5RequestHandler::hdf5_build_data_with_IDs(BESDataHandlerInterface & dhi)
     string filename = dhi.container->access();
     
     H5Eset_auto2(H5E_DEFAULT,nullptr,nullptr);
-    cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
     if (cf_fileid < 0){
         string invalid_file_msg="Could not open this HDF5 file ";
         invalid_file_msg +=filename;
@@ -1391,7 +1414,7 @@ bool HDF5RequestHandler::hdf5_build_dmr_from_file(BESDataHandlerInterface & dhi,
                 return hdf5_build_dmr_with_IDs(dhi);
 
 
-            cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
             if (cf_fileid < 0) {
                 string invalid_file_msg="Could not open this HDF5 file ";
                 invalid_file_msg +=filename;
@@ -1411,7 +1434,7 @@ bool HDF5RequestHandler::hdf5_build_dmr_from_file(BESDataHandlerInterface & dhi,
             return true;
         }
 
-        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
         if (cf_fileid < 0){
             string invalid_file_msg="Could not open this HDF5 file ";
             invalid_file_msg +=filename;
@@ -1562,7 +1585,7 @@ bool HDF5RequestHandler::hdf5_build_dmr_with_IDs(BESDataHandlerInterface & dhi)
     hid_t cf_fileid = -1;
 
     H5Eset_auto2(H5E_DEFAULT,nullptr,nullptr);
-    cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    cf_fileid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
     if (cf_fileid < 0){
         string invalid_file_msg="Could not open this HDF5 file ";
         invalid_file_msg +=filename;
@@ -2235,7 +2258,7 @@ void HDF5RequestHandler::read_das_from_file(DAS *das, const string &filename, co
     if (true == _usecf) {
         // go to the CF option
         if (h5_file_open == false)
-            h5_fd = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            h5_fd = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
 
         read_cfdas( *das,filename,h5_fd);
         if (h5_file_open == false)
@@ -2437,7 +2460,7 @@ void HDF5RequestHandler::add_attributes(BESDataHandlerInterface &dhi) {
         hid_t h5_fd =-1;
         if (true == _usecf) {
             // go to the CF option
-            h5_fd = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            h5_fd = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
             if (h5_fd < 0){
                 string invalid_file_msg="Could not open this HDF5 file ";
                 invalid_file_msg +=filename;
@@ -39,6 +39,8 @@
 
 class ObjMemCache; // in bes/dap
 
+template<typename Handle> class BESFileHandleCache; // in bes/dispatch
+
 namespace libdap {
 
     class DAS;
@@ -108,6 +110,15 @@ class HDF5RequestHandler:public BESRequestHandler {
                                              {lrdata_mem_cache=my_lrdata_mem_cache;}
 
     static ObjMemCache* get_srdata_mem_cache() {return srdata_mem_cache;}
+    static BESFileHandleCache<hid_t>* get_file_handle_cache() {return file_handle_cache;}
+
+    // Raw data chunk cache of the datasets the handler reads
+    static size_t get_chunk_cache_size() {return _chunk_cache_size;}
+    static size_t get_chunk_cache_max_size() {return _chunk_cache_max_size;}
+    static size_t get_chunk_cache_slots() {return _chunk_cache_slots;}
+    static double get_chunk_cache_w0() {return _chunk_cache_w0;}
+    static void set_chunk_cache(size_t size, size_t max_size, size_t slots, double w0)
+                     {_chunk_cache_size=size; _chunk_cache_max_size=max_size; _chunk_cache_slots=slots; _chunk_cache_w0=w0;}
     void set_srdata_mem_cache(ObjMemCache* my_srdata_mem_cache) const
                                              {srdata_mem_cache=my_srdata_mem_cache;}
 
@@ -163,6 +174,12 @@ class HDF5RequestHandler:public BESRequestHandler {
     static ObjMemCache *dmr_cache;
     static ObjMemCache *lrdata_mem_cache;
     static ObjMemCache *srdata_mem_cache;
+    static BESFileHandleCache<hid_t> *file_handle_cache;
+
+    static size_t _chunk_cache_size;
+    static size_t _chunk_cache_max_size;
+    static size_t _chunk_cache_slots;
+    static double _chunk_cache_w0;
 
     // BES keys
     static bool _usecf;
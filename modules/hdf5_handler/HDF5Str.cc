@@ -52,6 +52,7 @@
 #include "h5dds.h"
 #include "HDF5Str.h"
 #include "BESDebug.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -73,7 +74,7 @@ bool HDF5Str::read()
     if (read_p())
         return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -86,7 +87,7 @@ bool HDF5Str::read()
         dset_id = H5Dopen2(file_id,name().c_str(),H5P_DEFAULT);
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -94,7 +95,7 @@ bool HDF5Str::read()
     hid_t dtypeid = H5Dget_type(dset_id);
     if(dtypeid < 0) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the datatype for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg); 
     }
@@ -104,7 +105,7 @@ bool HDF5Str::read()
     if (size == 0) {
         H5Tclose(dtypeid);
 	H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the size of datatype for the variable " + var_path +".";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -128,14 +129,14 @@ bool HDF5Str::read()
         }
         H5Tclose(dtypeid);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
 
    }
 
     catch(...) {
         H5Tclose(dtypeid);
 	H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
@@ -32,6 +32,7 @@
 #include <libdap/InternalErr.h>
 #include <BESInternalError.h>
 #include "BESDebug.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -72,7 +73,7 @@ bool HDF5Structure::read()
     if (read_p())
         return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if (file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -85,7 +86,7 @@ bool HDF5Structure::read()
         dset_id = H5Dopen2(file_id,name().c_str(),H5P_DEFAULT);
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -94,7 +95,7 @@ bool HDF5Structure::read()
     hid_t dtypeid = H5Dget_type(dset_id);
     if(dtypeid < 0) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 data type for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -104,14 +105,14 @@ bool HDF5Structure::read()
     catch(...) {
         H5Tclose(dtypeid);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
          throw;
     }
     set_read_p(true);
 
     H5Tclose(dtypeid);
     H5Dclose(dset_id);
-    H5Fclose(file_id);
+    close_hdf5_file(file_id);
 
     return true;
 }
@@ -46,6 +46,7 @@
 #include "h5dds.h"
 #include "HDF5UInt32.h"
 #include "BESDebug.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -65,7 +66,7 @@ bool HDF5UInt32::read()
     if (read_p())
 	return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -82,7 +83,7 @@ bool HDF5UInt32::read()
         dset_id = H5Dopen2(file_id,name().c_str(),H5P_DEFAULT);
 #endif
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -99,11 +100,11 @@ bool HDF5UInt32::read()
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
 
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
@@ -44,6 +44,7 @@
 #include <BESInternalError.h>
 #include "h5dds.h"
 #include "HDF5UInt64.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -64,7 +65,7 @@ bool HDF5UInt64::read()
     if (read_p())
 	return true;
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -81,7 +82,7 @@ bool HDF5UInt64::read()
 #endif
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -97,12 +98,12 @@ bool HDF5UInt64::read()
             string msg = "Unable to close the HDF5 dataset " + var_path +".";
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
     }
 
     catch(...) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         throw;
     }
 
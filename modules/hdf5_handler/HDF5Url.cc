@@ -39,6 +39,7 @@
 #include <string>
 #include <memory>
 #include "HDF5Url.h"
+#include "h5common.h"
 #include <libdap/InternalErr.h>
 #include <BESInternalError.h>
 
@@ -58,7 +59,7 @@ BaseType *HDF5Url::ptr_duplicate()
 bool HDF5Url::read()
 {
 
-   hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+   hid_t file_id = open_hdf5_file(dataset());
     if(file_id < 0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -71,7 +72,7 @@ bool HDF5Url::read()
         dset_id = H5Dopen2(file_id,name().c_str(),H5P_DEFAULT);
 
     if(dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the HDF5 dataset ID for the variable " + var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -81,7 +82,7 @@ bool HDF5Url::read()
     if (H5Dread(dset_id, H5T_STD_REF_OBJ, H5S_ALL, H5S_ALL, H5P_DEFAULT, 
 		&rbuf) < 0) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "H5Dread() failed for the variable " + var_path +".";
 	throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -90,13 +91,13 @@ bool HDF5Url::read()
     char r_name[DODS_NAMELEN];
     if (did_r < 0){
 	H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "H5RDEREFERENCE() failed for the variable " + var_path +".";
 	throw BESInternalError(msg,__FILE__,__LINE__);
     }
     if (H5Iget_name(did_r, r_name, DODS_NAMELEN) < 0){
 	H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Unable to retrieve the name of the dereferenced object. ";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -105,7 +106,7 @@ bool HDF5Url::read()
 
      // Release the handles.
     H5Dclose(dset_id); 
-    H5Fclose(file_id);
+    close_hdf5_file(file_id);
 
 
     return true;
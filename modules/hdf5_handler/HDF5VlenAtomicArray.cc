@@ -37,6 +37,7 @@
 
 #include "HDF5RequestHandler.h"
 #include "HDF5VlenAtomicArray.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -62,7 +63,7 @@ bool HDF5VlenAtomicArray::read()
 
 void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
 
-    hid_t file_id = H5Fopen(dataset().c_str(),H5F_ACC_RDONLY,H5P_DEFAULT);
+    hid_t file_id = open_hdf5_file(dataset());
     if (file_id <0) {
         string msg = "Fail to obtain the HDF5 file ID for the file " + dataset() +".";
         throw InternalErr(__FILE__,__LINE__, msg);
@@ -74,7 +75,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
 
     hid_t dset_id = H5Dopen2(file_id,vlen_var_path.c_str(),H5P_DEFAULT);
     if (dset_id < 0) {
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to open the vlen variable " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -82,7 +83,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
     hid_t vlen_type = H5Dget_type(dset_id);
     if (vlen_type <0) {
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the vlen data type for variable " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -90,7 +91,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
     if (vlen_basetype <0) {
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the vlen base data type for variable " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -99,7 +100,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Only support float or intger variable-length datatype, the variable name is " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -109,7 +110,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the vlen memory base data type for the variable " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -120,7 +121,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to create the vlen memory data type for the variable " + vlen_var_path +".";
         throw InternalErr(__FILE__,__LINE__, msg);
     }
@@ -133,7 +134,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Fail to obtain the vlen data space ID for the variable " + vlen_var_path +".";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -145,7 +146,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Only support array of float or intger variable-length datatype,";
         msg += "the vlen variable name is " + vlen_var_path + ".";
         throw BESInternalError(msg,__FILE__,__LINE__);
@@ -183,7 +184,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
             H5Tclose(vlen_basetype);
             H5Tclose(vlen_type);
             H5Dclose(dset_id);
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
             string msg = "This variable is a variable-length array, the number of dimensions for DAP4 representation must be greater than 1.";
             msg += "The variable name is " + vlen_var_path + ".";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -207,7 +208,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
             H5Tclose(vlen_basetype);
             H5Tclose(vlen_type);
             H5Dclose(dset_id);
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
             string msg = "This variable is a variable-length array, the last dimension in the DAP4 representation cannot be subset.";
             msg += "The variable name is " + vlen_var_path + ".";
             throw BESInternalError(msg,__FILE__,__LINE__);
@@ -240,7 +241,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Could not select hyperslab for the vlen variable " + vlen_var_path + ".";
         throw BESInternalError(msg,__FILE__,__LINE__);
     } 
@@ -253,7 +254,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Could not create memory space  for the vlen variable " + vlen_var_path + ".";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -267,7 +268,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "Could not read the data for the vlen variable " + vlen_var_path + ".";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -282,7 +283,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
             H5Tclose(vlen_basetype);
             H5Tclose(vlen_type);
             H5Dclose(dset_id); 
-            H5Fclose(file_id);
+            close_hdf5_file(file_id);
             string msg = "vlen_index datatype must be 32-bit integer."; 
             throw InternalErr( __FILE__, __LINE__, msg); 
         } 
@@ -340,7 +341,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
                 H5Tclose(vlen_basetype);
                 H5Tclose(vlen_type);
                 H5Dclose(dset_id); 
-                H5Fclose(file_id);
+                close_hdf5_file(file_id);
                 string msg = "Vector::val2buf: bad type.";
                 throw BESInternalError(msg,__FILE__,__LINE__);
             }
@@ -354,7 +355,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
         H5Tclose(vlen_basetype);
         H5Tclose(vlen_type);
         H5Dclose(dset_id);
-        H5Fclose(file_id);
+        close_hdf5_file(file_id);
         string msg = "H5Dvlen_reclaim failed.";
         throw BESInternalError(msg,__FILE__,__LINE__);
     }
@@ -365,7 +366,7 @@ void HDF5VlenAtomicArray::read_vlen_internal(bool vlen_index) {
     H5Tclose(vlen_type);
     H5Tclose(vlen_memtype);
     H5Dclose(dset_id);
-    H5Fclose(file_id);
+    close_hdf5_file(file_id);
 
     set_read_p(true);
     
@@ -37,6 +37,7 @@
 
 #include "HDF5RequestHandler.h"
 #include "HDFEOS5CFSpecialCVArray.h"
+#include "h5common.h"
 
 using namespace std;
 using namespace libdap;
@@ -80,7 +81,7 @@ void HDFEOS5CFSpecialCVArray::read_data_NOT_from_mem_cache(bool /*add_cache*/, v
     }
 
     if(false == check_pass_fileid_key) {
-        if ((fileid = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,H5P_DEFAULT))<0) {
+        if ((fileid = open_hdf5_file(filename))<0) {
             string msg = "HDF5 File " + filename + " cannot be opened. "; 
             throw BESInternalError(msg,__FILE__,__LINE__);
         }
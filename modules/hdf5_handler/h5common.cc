@@ -34,6 +34,9 @@
 #include <libdap/InternalErr.h>
 #include <BESInternalError.h>
 #include <BESDebug.h>
+#include <BESFileHandleCache.h>
+
+#include "HDF5RequestHandler.h"
 
 
 using namespace std;
@@ -409,3 +412,198 @@ void get_vlen_str_data(const char*temp_bp,string &finalstr_val) {
         finalstr_val="";
 
 }
+
+/// \brief Open an HDF5 file read-only, reusing an open file ID if there is one.
+///
+/// The IDs are kept in the HDF5RequestHandler's open file cache (see
+/// H5.OpenFileCacheEntries). Pass the ID to close_hdf5_file() when done.
+/// \param filename The pathname of the file
+/// \return The file ID, negative on error
+hid_t open_hdf5_file(const string &filename)
+{
+    BESFileHandleCache<hid_t> *cache = HDF5RequestHandler::get_file_handle_cache();
+    hid_t file_id = -1;
+    if (cache && cache->get(filename, file_id))
+        return file_id;
+
+    file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, get_hdf5_fapl(filename));
+    if (file_id >= 0 && cache)
+        cache->add(filename, file_id);
+
+    return file_id;
+}
+
+/// \brief Release a file ID from open_hdf5_file().
+///
+/// The file is closed unless its ID is held by the open file cache.
+/// \param file_id The file ID
+/// \return Negative on error
+herr_t close_hdf5_file(hid_t file_id)
+{
+    BESFileHandleCache<hid_t> *cache = HDF5RequestHandler::get_file_handle_cache();
+    if (cache && cache->release(file_id))
+        return 0;
+
+    return H5Fclose(file_id);
+}
+
+// The smallest prime >= n; the number of chunk cache slots should be prime.
+static size_t next_prime(size_t n)
+{
+    if (n <= 2)
+        return 2;
+    if (n % 2 == 0)
+        n++;
+    for (;; n += 2) {
+        bool prime = true;
+        for (size_t d = 3; d * d <= n; d += 2) {
+            if (n % d == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (prime)
+            return n;
+    }
+}
+
+/// \brief Work out the raw data chunk cache to use for reading part of a dataset.
+///
+/// When H5.ChunkCacheMaxSize is set, the cache is made large enough to hold
+/// all the chunks the selection touches (at least H5.ChunkCacheSize and at
+/// most H5.ChunkCacheMaxSize bytes), so no chunk is read and decompressed
+/// twice. Otherwise the cache is H5.ChunkCacheSize bytes. Values that are not
+/// set in the configuration are taken from the dataset's current access
+/// property list, i.e., the library defaults.
+///
+/// \param dset_id The dataset
+/// \param rank Number of dimensions of the selection, 0 for the whole dataset
+/// \param offset, step, count The selection (see format_constraint())
+/// \param nslots, nbytes, w0 Value-result parameters; the chunk cache settings
+/// \return True if the dataset is chunked and the settings differ from the
+/// dataset's current chunk cache, false otherwise.
+bool get_chunk_cache_config(hid_t dset_id, int rank, const int64_t *offset, const int64_t *step,
+                            const int64_t *count, size_t &nslots, size_t &nbytes, double &w0)
+{
+    hid_t dcpl = H5Dget_create_plist(dset_id);
+    if (dcpl < 0)
+        return false;
+
+    int ndims = H5Pget_layout(dcpl) == H5D_CHUNKED ? H5Pget_chunk(dcpl, 0, nullptr) : -1;
+    vector<hsize_t> chunk_dims(ndims > 0 ? ndims : 0);
+    if (ndims > 0)
+        H5Pget_chunk(dcpl, ndims, chunk_dims.data());
+    H5Pclose(dcpl);
+    if (ndims <= 0)
+        return false;
+
+    hid_t dapl = H5Dget_access_plist(dset_id);
+    if (dapl < 0)
+        return false;
+    size_t cur_nslots = 0;
+    size_t cur_nbytes = 0;
+    double cur_w0 = 0;
+    herr_t status = H5Pget_chunk_cache(dapl, &cur_nslots, &cur_nbytes, &cur_w0);
+    H5Pclose(dapl);
+    if (status < 0)
+        return false;
+
+    hid_t dtype_id = H5Dget_type(dset_id);
+    size_t chunk_bytes = dtype_id < 0 ? 0 : H5Tget_size(dtype_id);
+    if (dtype_id >= 0)
+        H5Tclose(dtype_id);
+    for (const auto &dim: chunk_dims)
+        chunk_bytes *= dim;
+
+    nbytes = HDF5RequestHandler::get_chunk_cache_size() ? HDF5RequestHandler::get_chunk_cache_size() : cur_nbytes;
+
+    size_t max_bytes = HDF5RequestHandler::get_chunk_cache_max_size();
+    if (max_bytes > 0 && chunk_bytes > 0) {
+        // The number of chunks that hold the selection, or all the chunks of the dataset.
+        vector<hsize_t> dims(ndims);
+        bool have_selection = (rank == ndims && offset && step && count);
+        if (!have_selection) {
+            hid_t dspace = H5Dget_space(dset_id);
+            if (dspace < 0 || H5Sget_simple_extent_dims(dspace, dims.data(), nullptr) != ndims) {
+                if (dspace >= 0)
+                    H5Sclose(dspace);
+                return false;
+            }
+            H5Sclose(dspace);
+        }
+
+        size_t nchunks = 1;
+        for (int i = 0; i < ndims; i++) {
+            size_t n;
+            if (have_selection) {
+                hsize_t first = offset[i] / chunk_dims[i];
+                hsize_t last = (offset[i] + (count[i] - 1) * step[i]) / chunk_dims[i];
+                n = min((size_t)(last - first + 1), (size_t)count[i]);
+            }
+            else {
+                n = (dims[i] + chunk_dims[i] - 1) / chunk_dims[i];
+            }
+            nchunks = (n > 0 && nchunks > max_bytes / n) ? max_bytes : nchunks * n;
+        }
+
+        size_t selection_bytes = (nchunks > max_bytes / chunk_bytes) ? max_bytes : nchunks * chunk_bytes;
+        nbytes = max(nbytes, min(selection_bytes, max_bytes));
+    }
+
+    if (HDF5RequestHandler::get_chunk_cache_slots())
+        nslots = HDF5RequestHandler::get_chunk_cache_slots();
+    else if (nbytes > cur_nbytes && chunk_bytes > 0)
+        // The HDF5 documentation suggests about 100 times the number of chunks that fit in the cache.
+        nslots = max(cur_nslots, next_prime(min(nbytes / chunk_bytes * 100, (size_t)1000000)));
+    else
+        nslots = cur_nslots;
+
+    w0 = HDF5RequestHandler::get_chunk_cache_w0() >= 0 ? HDF5RequestHandler::get_chunk_cache_w0() : cur_w0;
+
+    return nslots != cur_nslots || nbytes != cur_nbytes || w0 != cur_w0;
+}
+
+/// \brief Open a dataset for reading with a raw data chunk cache sized for the selection.
+///
+/// Use this in place of H5Dopen2(file_id, path, H5P_DEFAULT) when reading
+/// data; see get_chunk_cache_config() and the H5.ChunkCache* keys. If the
+/// keys are not set this is just H5Dopen2().
+///
+/// \param file_id The file (or group) ID
+/// \param path The path to the dataset
+/// \param rank Number of dimensions of the selection, 0 if the whole dataset is read
+/// \param offset, step, count The selection
+/// \return The dataset ID, negative on error
+hid_t open_hdf5_dataset(hid_t file_id, const string &path, int rank, const int64_t *offset, const int64_t *step,
+                        const int64_t *count)
+{
+    hid_t dset_id = H5Dopen2(file_id, path.c_str(), H5P_DEFAULT);
+
+    if (dset_id < 0 || (HDF5RequestHandler::get_chunk_cache_size() == 0
+                        && HDF5RequestHandler::get_chunk_cache_max_size() == 0
+                        && HDF5RequestHandler::get_chunk_cache_slots() == 0
+                        && HDF5RequestHandler::get_chunk_cache_w0() < 0))
+        return dset_id;
+
+    size_t nslots = 0;
+    size_t nbytes = 0;
+    double w0 = 0;
+    if (!get_chunk_cache_config(dset_id, rank, offset, step, count, nslots, nbytes, w0))
+        return dset_id;
+
+    // The chunk cache can only be set when the dataset is opened, so open it again.
+    hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS);
+    if (dapl < 0 || H5Pset_chunk_cache(dapl, nslots, nbytes, w0) < 0) {
+        if (dapl >= 0)
+            H5Pclose(dapl);
+        return dset_id;
+    }
+
+    BESDEBUG("h5", "Chunk cache for " << path << ": " << nbytes << " bytes, " << nslots << " slots, w0 " << w0 << endl);
+
+    H5Dclose(dset_id);
+    dset_id = H5Dopen2(file_id, path.c_str(), dapl);
+    H5Pclose(dapl);
+
+    return dset_id;
+}
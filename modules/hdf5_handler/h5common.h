@@ -51,6 +51,14 @@ void get_vlen_str_data(const char*src,std::string &finalstrval);
 
 bool promote_char_to_short(H5T_class_t type_cls, hid_t type_id);
 
+hid_t open_hdf5_file(const std::string &filename);
+herr_t close_hdf5_file(hid_t file_id);
+
+hid_t open_hdf5_dataset(hid_t file_id, const std::string &path, int rank = 0, const int64_t *offset = nullptr,
+                        const int64_t *step = nullptr, const int64_t *count = nullptr);
+bool get_chunk_cache_config(hid_t dset_id, int rank, const int64_t *offset, const int64_t *step,
+                            const int64_t *count, size_t &nslots, size_t &nbytes, double &w0);
+
 
 
 #endif                          //_H5COMMON_H
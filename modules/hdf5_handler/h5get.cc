@@ -52,6 +52,7 @@
 #include "HDF5Structure.h"
 #include "HDF5RequestHandler.h"
 #include "util.h"
+#include "HDF5RangeReadVFD.h"
 
 #include <BESDebug.h>
 #include <BESSyntaxUserError.h>
@@ -422,7 +423,7 @@ string get_dap_integer_type(hid_t dtype, bool is_dap4) {
 ///////////////////////////////////////////////////////////////////////////////
 hid_t get_fileid(const char *filename)
 {
-    hid_t fileid = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+    hid_t fileid = H5Fopen(filename, H5F_ACC_RDONLY, get_hdf5_fapl(filename));
     if (fileid < 0){
         string msg = "cannot open the HDF5 file  ";
         string filenamestr(filename);
@@ -0,0 +1,274 @@
+// This file is part of hdf5_handler: an HDF5 file handler for the OPeNDAP
+// data server.
+
+// Copyright (c) 2025 The HDF Group, Inc. and OPeNDAP, Inc.
+//
+// This is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your
+// option) any later version.
+//
+// This software is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Tests for the raw data chunk cache the handler uses when it reads a
+// chunked dataset (see open_hdf5_dataset() and the H5.ChunkCache* keys).
+
+#include "config.h"
+
+#include <vector>
+
+#include <hdf5.h>
+
+#include "h5common.h"
+#include "HDF5RequestHandler.h"
+
+#include "modules/common/run_tests_cppunit.h"
+
+using namespace std;
+
+#define prolog std::string("ChunkCacheTest::").append(__func__).append("() - ")
+
+// A 1000x1000 Float64 dataset in 100x100 chunks: 100 chunks of 80,000 bytes.
+static const char *test_file = "chunk_cache_test.h5";
+static const hsize_t dim_size = 1000;
+static const hsize_t chunk_size = 100;
+static const size_t chunk_bytes = chunk_size * chunk_size * sizeof(double);
+
+class ChunkCacheTest : public CppUnit::TestFixture {
+private:
+    hid_t d_file = -1;
+
+    // The library's chunk cache settings for a dataset opened with H5P_DEFAULT
+    size_t d_default_nslots = 0;
+    size_t d_default_nbytes = 0;
+    double d_default_w0 = 0;
+
+    static void make_test_file() {
+        hid_t file = H5Fcreate(test_file, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+        CPPUNIT_ASSERT(file >= 0);
+
+        hsize_t dims[2] = {dim_size, dim_size};
+        hid_t space = H5Screate_simple(2, dims, nullptr);
+
+        hsize_t chunk[2] = {chunk_size, chunk_size};
+        hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+        H5Pset_chunk(dcpl, 2, chunk);
+        hid_t dset = H5Dcreate2(file, "/chunked", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+        CPPUNIT_ASSERT(dset >= 0);
+
+        vector<double> values(dim_size * dim_size);
+        for (hsize_t i = 0; i < values.size(); ++i)
+            values[i] = (double)i;
+        CPPUNIT_ASSERT(H5Dwrite(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data()) >= 0);
+        H5Dclose(dset);
+        H5Pclose(dcpl);
+
+        dset = H5Dcreate2(file, "/contiguous", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        CPPUNIT_ASSERT(dset >= 0);
+        H5Dclose(dset);
+
+        H5Sclose(space);
+        H5Fclose(file);
+    }
+
+    static void get_chunk_cache(hid_t dset, size_t &nslots, size_t &nbytes, double &w0) {
+        hid_t dapl = H5Dget_access_plist(dset);
+        CPPUNIT_ASSERT(dapl >= 0);
+        CPPUNIT_ASSERT(H5Pget_chunk_cache(dapl, &nslots, &nbytes, &w0) >= 0);
+        H5Pclose(dapl);
+    }
+
+public:
+    // Called once before everything gets tested
+    ChunkCacheTest() = default;
+
+    // Called at the end of the test
+    ~ChunkCacheTest() override = default;
+
+    // Called before each test
+    void setUp() override {
+        static bool made = false;
+        if (!made) {
+            make_test_file();
+            made = true;
+        }
+
+        d_file = H5Fopen(test_file, H5F_ACC_RDONLY, H5P_DEFAULT);
+        CPPUNIT_ASSERT(d_file >= 0);
+
+        hid_t dset = H5Dopen2(d_file, "/chunked", H5P_DEFAULT);
+        get_chunk_cache(dset, d_default_nslots, d_default_nbytes, d_default_w0);
+        H5Dclose(dset);
+
+        HDF5RequestHandler::set_chunk_cache(0, 0, 0, -1.0);
+    }
+
+    // Called after each test
+    void tearDown() override {
+        HDF5RequestHandler::set_chunk_cache(0, 0, 0, -1.0);
+        H5Fclose(d_file);
+    }
+
+    // With none of the keys set, datasets are opened with the library's chunk cache.
+    void no_keys_test() {
+        hid_t dset = open_hdf5_dataset(d_file, "/chunked");
+        CPPUNIT_ASSERT(dset >= 0);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        get_chunk_cache(dset, nslots, nbytes, w0);
+        H5Dclose(dset);
+
+        CPPUNIT_ASSERT_EQUAL(d_default_nslots, nslots);
+        CPPUNIT_ASSERT_EQUAL(d_default_nbytes, nbytes);
+        CPPUNIT_ASSERT_EQUAL(d_default_w0, w0);
+    }
+
+    // H5.ChunkCacheMaxSize: the cache holds all the chunks read, here all of them.
+    void whole_dataset_test() {
+        HDF5RequestHandler::set_chunk_cache(0, 64 * 1024 * 1024, 0, -1.0);
+        hid_t dset = H5Dopen2(d_file, "/chunked", H5P_DEFAULT);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        CPPUNIT_ASSERT(get_chunk_cache_config(dset, 0, nullptr, nullptr, nullptr, nslots, nbytes, w0));
+        H5Dclose(dset);
+
+        DBG(cerr << prolog << "nslots: " << nslots << ", nbytes: " << nbytes << ", w0: " << w0 << endl);
+        CPPUNIT_ASSERT_EQUAL(100 * chunk_bytes, nbytes);
+        // About 100 slots per chunk, rounded up to a prime
+        CPPUNIT_ASSERT_EQUAL((size_t)10007, nslots);
+        CPPUNIT_ASSERT_EQUAL(d_default_w0, w0);
+    }
+
+    // The cache is sized for the chunks a strided selection touches.
+    void selection_test() {
+        HDF5RequestHandler::set_chunk_cache(0, 64 * 1024 * 1024, 0, -1.0);
+        hid_t dset = H5Dopen2(d_file, "/chunked", H5P_DEFAULT);
+
+        // Rows 0, 200, ..., 800, all the columns: 5 rows of 10 chunks
+        int64_t offset[2] = {0, 0};
+        int64_t step[2] = {200, 1};
+        int64_t count[2] = {5, dim_size};
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        CPPUNIT_ASSERT(get_chunk_cache_config(dset, 2, offset, step, count, nslots, nbytes, w0));
+        CPPUNIT_ASSERT_EQUAL(50 * chunk_bytes, nbytes);
+
+        // One row is 10 chunks, which fit in the library's cache; nothing changes.
+        int64_t row_offset[2] = {150, 0};
+        int64_t row_step[2] = {1, 1};
+        int64_t row_count[2] = {1, dim_size};
+        CPPUNIT_ASSERT(10 * chunk_bytes <= d_default_nbytes);
+        CPPUNIT_ASSERT(!get_chunk_cache_config(dset, 2, row_offset, row_step, row_count, nslots, nbytes, w0));
+        CPPUNIT_ASSERT_EQUAL(d_default_nbytes, nbytes);
+        CPPUNIT_ASSERT_EQUAL(d_default_nslots, nslots);
+
+        H5Dclose(dset);
+    }
+
+    // The cache never grows past H5.ChunkCacheMaxSize
+    void max_size_test() {
+        HDF5RequestHandler::set_chunk_cache(0, 2000000, 0, -1.0);
+        hid_t dset = H5Dopen2(d_file, "/chunked", H5P_DEFAULT);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        CPPUNIT_ASSERT(get_chunk_cache_config(dset, 0, nullptr, nullptr, nullptr, nslots, nbytes, w0));
+        H5Dclose(dset);
+
+        CPPUNIT_ASSERT_EQUAL((size_t)2000000, nbytes);
+    }
+
+    // H5.ChunkCacheSize, H5.ChunkCacheSlots and H5.ChunkCacheW0 are used as given.
+    void fixed_size_test() {
+        HDF5RequestHandler::set_chunk_cache(4 * 1024 * 1024, 0, 1009, 0.5);
+        hid_t dset = H5Dopen2(d_file, "/chunked", H5P_DEFAULT);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        CPPUNIT_ASSERT(get_chunk_cache_config(dset, 0, nullptr, nullptr, nullptr, nslots, nbytes, w0));
+        H5Dclose(dset);
+
+        CPPUNIT_ASSERT_EQUAL((size_t)4 * 1024 * 1024, nbytes);
+        CPPUNIT_ASSERT_EQUAL((size_t)1009, nslots);
+        CPPUNIT_ASSERT_EQUAL(0.5, w0);
+    }
+
+    // Datasets that are not chunked have no chunk cache to size.
+    void contiguous_test() {
+        HDF5RequestHandler::set_chunk_cache(0, 64 * 1024 * 1024, 0, -1.0);
+        hid_t dset = H5Dopen2(d_file, "/contiguous", H5P_DEFAULT);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        CPPUNIT_ASSERT(!get_chunk_cache_config(dset, 0, nullptr, nullptr, nullptr, nslots, nbytes, w0));
+        H5Dclose(dset);
+    }
+
+    // open_hdf5_dataset() opens the dataset with the cache, and the data read are the same.
+    void open_dataset_test() {
+        HDF5RequestHandler::set_chunk_cache(0, 64 * 1024 * 1024, 0, -1.0);
+        int64_t offset[2] = {0, 0};
+        int64_t step[2] = {200, 1};
+        int64_t count[2] = {5, dim_size};
+        hid_t dset = open_hdf5_dataset(d_file, "/chunked", 2, offset, step, count);
+        CPPUNIT_ASSERT(dset >= 0);
+
+        size_t nslots = 0;
+        size_t nbytes = 0;
+        double w0 = 0;
+        get_chunk_cache(dset, nslots, nbytes, w0);
+        CPPUNIT_ASSERT_EQUAL(50 * chunk_bytes, nbytes);
+
+        hsize_t start[2] = {0, 0};
+        hsize_t stride[2] = {200, 1};
+        hsize_t block_count[2] = {5, dim_size};
+        hid_t fspace = H5Dget_space(dset);
+        H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, stride, block_count, nullptr);
+        hid_t mspace = H5Screate_simple(2, block_count, nullptr);
+
+        vector<double> values(5 * dim_size);
+        CPPUNIT_ASSERT(H5Dread(dset, H5T_NATIVE_DOUBLE, mspace, fspace, H5P_DEFAULT, values.data()) >= 0);
+        H5Sclose(mspace);
+        H5Sclose(fspace);
+        H5Dclose(dset);
+
+        for (hsize_t row = 0; row < 5; ++row)
+            for (hsize_t col = 0; col < dim_size; ++col)
+                CPPUNIT_ASSERT_EQUAL((double)(row * 200 * dim_size + col), values[row * dim_size + col]);
+    }
+
+    CPPUNIT_TEST_SUITE(ChunkCacheTest);
+
+    CPPUNIT_TEST(no_keys_test);
+    CPPUNIT_TEST(whole_dataset_test);
+    CPPUNIT_TEST(selection_test);
+    CPPUNIT_TEST(max_size_test);
+    CPPUNIT_TEST(fixed_size_test);
+    CPPUNIT_TEST(contiguous_test);
+    CPPUNIT_TEST(open_dataset_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ChunkCacheTest);
+
+int main(int argc, char *argv[]) {
+    return bes_run_tests<ChunkCacheTest>(argc, argv, "cerr,h5") ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// This file is part of hdf5_handler: an HDF5 file handler for the OPeNDAP
+// data server.
+
+// Copyright (c) 2025 The HDF Group, Inc. and OPeNDAP, Inc.
+//
+// This is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your
+// option) any later version.
+//
+// This software is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+// Measure what the raw data chunk cache (the H5.ChunkCache* keys) does for
+// reads of a compressed, chunked dataset: a 4000x4000 Float32 dataset with
+// deflate and 500x500 chunks. Each run opens the dataset with
+// open_hdf5_dataset(), as the handler does, then makes one strided read of
+// the whole dataset and 1000 reads of one row. With the library's 1 MiB cache
+// (which holds one chunk) most chunks are read and decompressed many times.
+//
+// Usage: chunk_cache_benchmark [max cache size in MiB] (default 64)
+
+#include "config.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+
+#include "h5common.h"
+#include "HDF5RequestHandler.h"
+
+using namespace std;
+
+static const char *bench_file = "chunk_cache_benchmark.h5";
+static const hsize_t dim_size = 4000;
+static const hsize_t chunk_size = 500;
+static const hsize_t row_reads = 1000;
+
+static void make_bench_file()
+{
+    hid_t file = H5Fcreate(bench_file, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    hsize_t dims[2] = {dim_size, dim_size};
+    hid_t space = H5Screate_simple(2, dims, nullptr);
+
+    hsize_t chunk[2] = {chunk_size, chunk_size};
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 2, chunk);
+    H5Pset_deflate(dcpl, 4);
+    hid_t dset = H5Dcreate2(file, "/data", H5T_NATIVE_FLOAT, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+    vector<float> values(dim_size * dim_size);
+    for (hsize_t i = 0; i < dim_size; ++i)
+        for (hsize_t j = 0; j < dim_size; ++j)
+            values[i * dim_size + j] = (float)(sin(i / 100.0) * cos(j / 100.0));
+    H5Dwrite(dset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+
+    H5Dclose(dset);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    H5Fclose(file);
+}
+
+static void read_selection(hid_t dset, const hsize_t *start, const hsize_t *stride, const hsize_t *count,
+                           vector<float> &values)
+{
+    hid_t fspace = H5Dget_space(dset);
+    H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, stride, count, nullptr);
+    hid_t mspace = H5Screate_simple(2, count, nullptr);
+    values.resize(count[0] * count[1]);
+    if (H5Dread(dset, H5T_NATIVE_FLOAT, mspace, fspace, H5P_DEFAULT, values.data()) < 0) {
+        cerr << "H5Dread() failed" << endl;
+        exit(1);
+    }
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+}
+
+// One strided read of the whole dataset (every other row and column) and
+// 'row_reads' reads of one row each, best of three runs
+static double time_reads(hid_t file, double &checksum)
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        checksum = 0;
+        auto start_time = chrono::steady_clock::now();
+
+        hid_t dset = open_hdf5_dataset(file, "/data");
+        vector<float> values;
+
+        hsize_t start[2] = {0, 0};
+        hsize_t stride[2] = {2, 2};
+        hsize_t count[2] = {dim_size / 2, dim_size / 2};
+        read_selection(dset, start, stride, count, values);
+        checksum += values[values.size() / 2];
+
+        for (hsize_t r = 0; r < row_reads; ++r) {
+            hsize_t row_start[2] = {(r * 7) % dim_size, 0};
+            hsize_t row_stride[2] = {1, 1};
+            hsize_t row_count[2] = {1, dim_size};
+            read_selection(dset, row_start, row_stride, row_count, values);
+            checksum += values[r % dim_size];
+        }
+
+        H5Dclose(dset);
+
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start_time;
+        if (run == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t max_mb = argc > 1 ? strtoul(argv[1], nullptr, 10) : 64;
+
+    make_bench_file();
+    hid_t file = H5Fopen(bench_file, H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+        cerr << "Could not open " << bench_file << endl;
+        return 1;
+    }
+
+    cout << dim_size << "x" << dim_size << " Float32, deflate, " << chunk_size << "x" << chunk_size
+         << " chunks; one strided read and " << row_reads << " row reads" << endl;
+
+    double checksum = 0;
+    HDF5RequestHandler::set_chunk_cache(0, 0, 0, -1.0);
+    double seconds = time_reads(file, checksum);
+    cout << left << setw(32) << "library default cache" << right << fixed << setprecision(3) << setw(8)
+         << seconds << " s   (" << checksum << ")" << endl;
+
+    HDF5RequestHandler::set_chunk_cache(0, max_mb * 1024 * 1024, 0, -1.0);
+    seconds = time_reads(file, checksum);
+    cout << left << setw(32) << "H5.ChunkCacheMaxSize=" + to_string(max_mb) + " MiB" << right << fixed
+         << setprecision(3) << setw(8) << seconds << " s   (" << checksum << ")" << endl;
+
+    H5Fclose(file);
+    remove(bench_file);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file is part of the "NcML Module" project, a BES module designed
+// to allow NcML files to be used to be used as a wrapper to add
+// AIS to existing datasets of any format.
+//
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// For more information, please also see the main website: http://opendap.org/
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// Please see the files COPYING and COPYRIGHT for more information on the GLPL.
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <libdap/Array.h>
+
+#include "BESDebug.h"
+#include "TheBESKeys.h"
+
+#include "AggregationGranuleReader.h"
+#include "AggMemberDataset.h"
+#include "AggregationUtil.h"
+#include "NCMLDebug.h"
+
+#define MAX_PARALLEL_READS_KEY "NCML.MaxParallelGranuleReads"
+#define prolog std::string("AggregationGranuleReader::").append(__func__).append("() - ")
+
+using std::string;
+using std::vector;
+
+namespace agg_util {
+
+AggregationGranuleReader::AggregationGranuleReader(const string& varName, const ArrayGetterInterface& arrayGetter,
+    const string& debugChannel) :
+    _varName(varName), _arrayGetter(arrayGetter), _debugChannel(debugChannel), _failedGranule(0)
+{
+}
+
+AggregationGranuleReader::~AggregationGranuleReader()
+{
+    // Granules read but not passed to the callback because an earlier one failed
+    for (auto& granule : _granules) {
+        if (granule.array) granule.array->clear_local_data();
+    }
+}
+
+/* static */
+unsigned int AggregationGranuleReader::getMaxParallelReads()
+{
+    static const unsigned long max_reads = TheBESKeys::read_ulong_key(MAX_PARALLEL_READS_KEY, 1);
+    return max_reads == 0 ? 1 : static_cast<unsigned int>(max_reads);
+}
+
+void AggregationGranuleReader::addGranule(AggMemberDataset& dataset, const libdap::Array& constrainedTemplateArray)
+{
+    Granule granule;
+    granule.dataset = &dataset;
+    granule.constraints.reset(
+        static_cast<libdap::Array*>(const_cast<libdap::Array&>(constrainedTemplateArray).ptr_duplicate()));
+    granule.array = nullptr;
+    _granules.push_back(std::move(granule));
+}
+
+void AggregationGranuleReader::readGranule(Granule& granule)
+{
+    try {
+        granule.array = AggregationUtil::readDatasetArrayDataForAggregation(*granule.constraints, _varName,
+            *granule.dataset, _arrayGetter, _debugChannel);
+    }
+    catch (...) {
+        granule.error = std::current_exception();
+    }
+}
+
+void AggregationGranuleReader::readGranules(const GranuleCallback& callback)
+{
+    const unsigned int max_reads = getMaxParallelReads();
+    _failedGranule = size();
+
+    for (unsigned int batch = 0; batch < size(); batch += max_reads) {
+        const unsigned int batch_end = std::min(batch + max_reads, size());
+
+        // Load the DDSs here; the DDSLoader is not thread-safe. The DDS is
+        // cached by the dataset, so readGranule() will not load it again.
+        for (unsigned int i = batch; i < batch_end; ++i) {
+            _failedGranule = i;
+            const libdap::DDS* pDDS = _granules[i].dataset->getDDS();
+            NCML_ASSERT_MSG(pDDS, "AggregationGranuleReader::readGranules(): Got a null "
+                "DataDDS while loading dataset = " + _granules[i].dataset->getLocation());
+        }
+        _failedGranule = size();
+
+        if (batch_end - batch == 1) {
+            readGranule(_granules[batch]);
+        }
+        else {
+            BESDEBUG(_debugChannel, prolog << "Reading granules " << batch << " to " << batch_end - 1
+                << " of " << _varName << " in parallel" << std::endl);
+
+            // The calling thread reads the first granule of the batch
+            vector<std::thread> threads;
+            for (unsigned int i = batch + 1; i < batch_end; ++i)
+                threads.emplace_back(&AggregationGranuleReader::readGranule, this, std::ref(_granules[i]));
+            readGranule(_granules[batch]);
+            for (auto& t : threads)
+                t.join();
+        }
+
+        // Hand the data to the caller in order, stopping at the first error
+        for (unsigned int i = batch; i < batch_end; ++i) {
+            Granule& granule = _granules[i];
+            if (granule.error) {
+                _failedGranule = i;
+                std::rethrow_exception(granule.error);
+            }
+
+            try {
+                callback(i, *granule.array);
+            }
+            catch (...) {
+                _failedGranule = i;
+                throw;
+            }
+
+            granule.array->clear_local_data();
+            granule.array = nullptr;
+        }
+    }
+}
+
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file is part of the "NcML Module" project, a BES module designed
+// to allow NcML files to be used to be used as a wrapper to add
+// AIS to existing datasets of any format.
+//
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// For more information, please also see the main website: http://opendap.org/
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// Please see the files COPYING and COPYRIGHT for more information on the GLPL.
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+/////////////////////////////////////////////////////////////////////////////
+#ifndef __AGG_UTIL__AGGREGATION_GRANULE_READER_H__
+#define __AGG_UTIL__AGGREGATION_GRANULE_READER_H__
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libdap {
+class Array;
+}
+
+namespace agg_util {
+
+class AggMemberDataset;
+class ArrayGetterInterface;
+
+/**
+ * Read the constrained slices of an aggregation variable from its member
+ * datasets, up to NCML.MaxParallelGranuleReads of them at a time.
+ *
+ * The granules are added in output order, each with its own copy of the
+ * constraints to use. readGranules() then reads them in batches and hands
+ * each granule's Array to a callback, always in the order they were added,
+ * so the callback can write the slice into its offset in the output buffer
+ * or stream it with put_vector_part().
+ *
+ * Loading each member dataset's DDS is done on the calling thread since the
+ * DDSLoader shares the request's DataHandlerInterface. Only the read() calls
+ * are run in parallel, so the key should only be set above one when the
+ * handlers for the member datasets have thread-safe read() methods (e.g.,
+ * the DMR++ handler).
+ */
+class AggregationGranuleReader {
+public:
+    /// Called with the index of the granule (in the order added) and its data
+    typedef std::function<void(unsigned int granule, libdap::Array& granuleArray)> GranuleCallback;
+
+    AggregationGranuleReader(const std::string& varName, const ArrayGetterInterface& arrayGetter,
+        const std::string& debugChannel);
+    ~AggregationGranuleReader();
+
+    AggregationGranuleReader(const AggregationGranuleReader&) = delete;
+    AggregationGranuleReader& operator=(const AggregationGranuleReader&) = delete;
+
+    /**
+     * Add a granule to read.
+     * @param dataset The member dataset that holds the granule
+     * @param constrainedTemplateArray The constraints to use; a copy is made
+     * so the caller can change the template for the next granule.
+     */
+    void addGranule(AggMemberDataset& dataset, const libdap::Array& constrainedTemplateArray);
+
+    /** @return The number of granules added */
+    unsigned int size() const
+    {
+        return _granules.size();
+    }
+
+    /**
+     * Read all of the granules, calling callback once for each, in order.
+     * Each granule's data are released once the callback returns. If a read
+     * fails, the exception is rethrown after the callbacks for the granules
+     * before it have been made; getFailedGranule() returns its index.
+     */
+    void readGranules(const GranuleCallback& callback);
+
+    /** @return The index of the granule whose read threw, or size() */
+    unsigned int getFailedGranule() const
+    {
+        return _failedGranule;
+    }
+
+    /** @return The value of NCML.MaxParallelGranuleReads; one if not set */
+    static unsigned int getMaxParallelReads();
+
+private:
+    struct Granule {
+        AggMemberDataset* dataset;
+        std::unique_ptr<libdap::Array> constraints;
+        libdap::Array* array;
+        std::exception_ptr error;
+    };
+
+    void readGranule(Granule& granule);
+
+    std::string _varName;
+    const ArrayGetterInterface& _arrayGetter;
+    std::string _debugChannel;
+    std::vector<Granule> _granules;
+    unsigned int _failedGranule;
+};
+
+}
+
+#endif /* __AGG_UTIL__AGGREGATION_GRANULE_READER_H__ */
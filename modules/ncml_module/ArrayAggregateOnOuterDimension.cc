@@ -31,6 +31,7 @@
 
 #include "ArrayAggregateOnOuterDimension.h"
 #include "AggregationException.h"
+#include "AggregationGranuleReader.h"
 
 #include <libdap/DataDDS.h> // libdap::DataDDS
 #include <libdap/Marshaller.h>
@@ -155,33 +156,35 @@ bool ArrayAggregateOnOuterDimension::serialize(libdap::ConstraintEvaluator &eval
         // Keep this to do some error checking
         int nextElementIndex = 0;
 
-        // Traverse the dataset array respecting hyperslab
+        // Traverse the dataset array respecting hyperslab; the reads may be
+        // done in parallel but the slices are always written in order.
+        AggregationGranuleReader reader(name(), getArrayGetterInterface(), DEBUG_CHANNEL);
+        vector<int> datasetIndices;
         for (int i = outerDim.start; i <= outerDim.stop && i < outerDim.size; i += outerDim.stride) {
-            AggMemberDataset& dataset = *((getDatasetList())[i]);
+            reader.addGranule(*((getDatasetList())[i]), getGranuleTemplateArray());
+            datasetIndices.push_back(i);
+        }
 
-            try {
-                Array* pDatasetArray = AggregationUtil::readDatasetArrayDataForAggregation(getGranuleTemplateArray(),
-                    name(), dataset, getArrayGetterInterface(), DEBUG_CHANNEL);
+        try {
+            reader.readGranules([&](unsigned int, Array& datasetArray) {
 #if PIPELINING
                 delete bes_timing::elapsedTimeToTransmitStart;
                 bes_timing::elapsedTimeToTransmitStart = 0;
-                m.put_vector_part(pDatasetArray->get_buf(), getGranuleTemplateArray().length(), var()->width(),
+                m.put_vector_part(datasetArray.get_buf(), getGranuleTemplateArray().length(), var()->width(),
                     var()->type());
 #else
-                this->set_value_slice_from_row_major_vector(*pDatasetArray, nextElementIndex);
+                this->set_value_slice_from_row_major_vector(datasetArray, nextElementIndex);
 #endif
-
-                pDatasetArray->clear_local_data();
-            }
-            catch (agg_util::AggregationException& ex) {
-                std::ostringstream oss;
-                oss << "Got AggregationException while streaming dataset index=" << i << " data for location=\""
-                    << dataset.getLocation() << "\" The error msg was: " << std::string(ex.what());
-                THROW_NCML_PARSE_ERROR(-1, oss.str());
-            }
-
-            // Jump forward by the amount we added.
-            nextElementIndex += getGranuleTemplateArray().length();
+                // Jump forward by the amount we added.
+                nextElementIndex += getGranuleTemplateArray().length();
+            });
+        }
+        catch (agg_util::AggregationException& ex) {
+            int i = datasetIndices[reader.getFailedGranule()];
+            std::ostringstream oss;
+            oss << "Got AggregationException while streaming dataset index=" << i << " data for location=\""
+                << getDatasetList()[i]->getLocation() << "\" The error msg was: " << std::string(ex.what());
+            THROW_NCML_PARSE_ERROR(-1, oss.str());
         }
 
         // If we succeeded, we are at the end of the array!
@@ -264,26 +267,28 @@ void ArrayAggregateOnOuterDimension::readConstrainedGranuleArraysAndAggregateDat
     int nextElementIndex = 0;
 
     // Traverse the dataset array respecting hyperslab
+    AggregationGranuleReader reader(name(), getArrayGetterInterface(), DEBUG_CHANNEL);
+    vector<int> datasetIndices;
     for (int i = outerDim.start; i <= outerDim.stop && i < outerDim.size; i += outerDim.stride) {
-        AggMemberDataset& dataset = *((getDatasetList())[i]);
+        reader.addGranule(*((getDatasetList())[i]), getGranuleTemplateArray());
+        datasetIndices.push_back(i);
+    }
 
-        try {
-            agg_util::AggregationUtil::addDatasetArrayDataToAggregationOutputArray(*this, // into the output buffer of this object
-                nextElementIndex, // into the next open slice
-                getGranuleTemplateArray(), // constraints template
-                name(), // aggvar name
-                dataset, // Dataset who's DDS should be searched
-                getArrayGetterInterface(), DEBUG_CHANNEL);
-        }
-        catch (agg_util::AggregationException& ex) {
-            std::ostringstream oss;
-            oss << "Got AggregationException while streaming dataset index=" << i << " data for location=\""
-                << dataset.getLocation() << "\" The error msg was: " << std::string(ex.what());
-            THROW_NCML_PARSE_ERROR(-1, oss.str());
-        }
+    try {
+        reader.readGranules([&](unsigned int, Array& datasetArray) {
+            // into the output buffer of this object, into the next open slice
+            this->set_value_slice_from_row_major_vector(datasetArray, nextElementIndex);
 
-        // Jump forward by the amount we added.
-        nextElementIndex += getGranuleTemplateArray().length();
+            // Jump forward by the amount we added.
+            nextElementIndex += getGranuleTemplateArray().length();
+        });
+    }
+    catch (agg_util::AggregationException& ex) {
+        int i = datasetIndices[reader.getFailedGranule()];
+        std::ostringstream oss;
+        oss << "Got AggregationException while streaming dataset index=" << i << " data for location=\""
+            << getDatasetList()[i]->getLocation() << "\" The error msg was: " << std::string(ex.what());
+        THROW_NCML_PARSE_ERROR(-1, oss.str());
     }
 
     // If we succeeded, we are at the end of the array!
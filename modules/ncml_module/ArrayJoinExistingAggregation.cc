@@ -39,6 +39,7 @@
 #include "ArrayJoinExistingAggregation.h"
 
 #include "AggregationException.h" // agg_util
+#include "AggregationGranuleReader.h" // agg_util
 #include "AggregationUtil.h" // agg_util
 #include "NCMLDebug.h"
 
@@ -164,6 +165,7 @@ bool ArrayJoinExistingAggregation::serialize(libdap::ConstraintEvaluator &eval,
 
             // where in this output array we are writing next
             unsigned int nextOutputBufferElementIndex = 0;
+            AggregationGranuleReader reader(name(), getArrayGetterInterface(), DEBUG_CHANNEL);
 
             // Traverse the outer dimension constraints,
             // Keeping track of which dataset we need to
@@ -240,26 +242,26 @@ bool ArrayJoinExistingAggregation::serialize(libdap::ConstraintEvaluator &eval,
                     // mapped endpoint clamped within this granule
                     granuleConstraintTemplate.add_constraint(outerDimIt, localGranuleIndex, clampedStride,
                         granuleStopIndex);
-                    Array* pDatasetArray = AggregationUtil::readDatasetArrayDataForAggregation(
-                        getGranuleTemplateArray(), name(), const_cast<AggMemberDataset&>(*pCurrDataset),
-                        getArrayGetterInterface(), DEBUG_CHANNEL);
-#if PIPELINING
-                    m.put_vector_part(pDatasetArray->get_buf(), getGranuleTemplateArray().length(), var()->width(),
-                        var()->type());
-#else
-                    this->set_value_slice_from_row_major_vector(*pDatasetArray, nextOutputBufferElementIndex);
-#endif
 
-                    pDatasetArray->clear_local_data();
-
-                    // Jump output buffer index forward by the amount we added.
-                    nextOutputBufferElementIndex += getGranuleTemplateArray().length();
+                    // The reader copies the constraints, so the template can be reused for the next granule
+                    reader.addGranule(const_cast<AggMemberDataset&>(*pCurrDataset), granuleConstraintTemplate);
                     currDatasetWasRead = true;
-
-                    BESDEBUG_FUNC(DEBUG_CHANNEL,
-                        " The granule index " << currDatasetIndex << " was read with constraints and copied into the aggregation output." << endl);
                 } // !currDatasetWasRead
             } // for loop over outerDim
+
+            // Read the granules (maybe in parallel) and send or copy them in order
+            reader.readGranules([&](unsigned int granule, Array& datasetArray) {
+#if PIPELINING
+                m.put_vector_part(datasetArray.get_buf(), datasetArray.length(), var()->width(), var()->type());
+#else
+                this->set_value_slice_from_row_major_vector(datasetArray, nextOutputBufferElementIndex);
+#endif
+                // Jump output buffer index forward by the amount we added.
+                nextOutputBufferElementIndex += datasetArray.length();
+
+                BESDEBUG_FUNC(DEBUG_CHANNEL,
+                    " The granule " << granule << " was read with constraints and copied into the aggregation output." << endl);
+            });
         } // end of try
         catch (AggregationException& ex) {
             THROW_NCML_PARSE_ERROR(-1, ex.what());
@@ -333,6 +335,7 @@ void ArrayJoinExistingAggregation::readConstrainedGranuleArraysAndAggregateDataH
 
         // where in this output array we are writing next
         unsigned int nextOutputBufferElementIndex = 0;
+        AggregationGranuleReader reader(name(), getArrayGetterInterface(), DEBUG_CHANNEL);
 
         // Traverse the outer dimension constraints,
         // Keeping track of which dataset we need to
@@ -409,22 +412,22 @@ void ArrayJoinExistingAggregation::readConstrainedGranuleArraysAndAggregateDataH
                 // mapped endpoint clamped within this granule
                 granuleConstraintTemplate.add_constraint(outerDimIt, localGranuleIndex, clampedStride, granuleStopIndex);
 
-                // Do the constrained read and copy it into this output buffer
-                agg_util::AggregationUtil::addDatasetArrayDataToAggregationOutputArray(*this, // into the output buffer of this object
-                    nextOutputBufferElementIndex, // into the next open slice
-                    getGranuleTemplateArray(), // constraints we just setup
-                    name(), // aggvar name
-                    const_cast<AggMemberDataset&>(*pCurrDataset), // Dataset who's DDS should be searched
-                    getArrayGetterInterface(), DEBUG_CHANNEL);
-
-                // Jump output buffer index forward by the amount we added.
-                nextOutputBufferElementIndex += getGranuleTemplateArray().length();
+                // The reader copies the constraints we just setup
+                reader.addGranule(const_cast<AggMemberDataset&>(*pCurrDataset), granuleConstraintTemplate);
                 currDatasetWasRead = true;
-
-                BESDEBUG_FUNC(DEBUG_CHANNEL,
-                    " The granule index " << currDatasetIndex << " was read with constraints and copied into the aggregation output." << endl);
             } // !currDatasetWasRead
         } // for loop over outerDim
+
+        // Do the constrained reads (maybe in parallel) and copy them into this output buffer
+        reader.readGranules([&](unsigned int granule, Array& datasetArray) {
+            this->set_value_slice_from_row_major_vector(datasetArray, nextOutputBufferElementIndex);
+
+            // Jump output buffer index forward by the amount we added.
+            nextOutputBufferElementIndex += datasetArray.length();
+
+            BESDEBUG_FUNC(DEBUG_CHANNEL,
+                " The granule " << granule << " was read with constraints and copied into the aggregation output." << endl);
+        });
     } // try
 
     catch (AggregationException& ex) {
@@ -0,0 +1,260 @@
+// -*- mode: c++; c-basic-offset:4 -*-
+
+// This file is part of the "NcML Module" project, a BES module designed
+// to allow NcML files to be used to be used as a wrapper to add
+// AIS to existing datasets of any format.
+
+// Copyright (c) 2024 OPeNDAP, Inc.
+// Author: James Gallagher <jgallagher@opendap.org>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <libdap/Array.h>
+#include <libdap/BaseTypeFactory.h>
+#include <libdap/DDS.h>
+#include <libdap/Int32.h>
+
+#include "TheBESKeys.h"
+
+#include "AggMemberDatasetDDSWrapper.h"
+#include "AggregationException.h"
+#include "AggregationGranuleReader.h"
+#include "AggregationUtil.h"
+#include "DDSAccessInterface.h"
+
+#include "modules/common/run_tests_cppunit.h"
+#include "test_config.h"
+
+using namespace std;
+using namespace libdap;
+using namespace agg_util;
+
+#define prolog std::string("AggregationGranuleReaderTest::").append(__func__).append("() - ")
+
+static const unsigned int MAX_READS = 3;
+static const unsigned int NUM_GRANULES = 7;
+static const unsigned int ARRAY_LENGTH = 4;
+
+// A DDS holding the array 'v[x = 4]' for granule 'index'.
+class GranuleDDS: public DDSAccessInterface {
+    BaseTypeFactory d_factory;
+    DDS d_dds;
+
+public:
+    explicit GranuleDDS(unsigned int index) :
+        d_dds(&d_factory, "granule_" + to_string(index))
+    {
+        Int32 proto("v");
+        Array v("v", &proto);
+        v.append_dim(ARRAY_LENGTH, "x");
+        d_dds.add_var(&v);
+    }
+
+    ~GranuleDDS() override = default;
+
+    const DDS* getDDS() const override
+    {
+        return &d_dds;
+    }
+};
+
+// 'Reads' the array by filling it with the granule number. Earlier granules
+// take longer, so within a batch the reads finish in reverse order. Reading
+// the granule 'fail_granule' throws.
+class SlowArrayGetter: public ArrayGetterInterface {
+public:
+    mutable atomic<unsigned int> in_flight{0};
+    mutable atomic<unsigned int> max_in_flight{0};
+    unsigned int fail_granule = NUM_GRANULES;
+
+    SlowArrayGetter* clone() const override
+    {
+        return new SlowArrayGetter;
+    }
+
+    Array* readAndGetArray(const string& name, const DDS& dds, const Array* const,
+        const string&) const override
+    {
+        const unsigned int granule = stoul(const_cast<DDS&>(dds).get_dataset_name().substr(string("granule_").size()));
+
+        const unsigned int now = ++in_flight;
+        unsigned int seen = max_in_flight;
+        while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) { }
+
+        this_thread::sleep_for(chrono::milliseconds(20 * (MAX_READS - granule % MAX_READS)));
+        --in_flight;
+
+        if (granule == fail_granule)
+            throw AggregationException("Could not read granule " + to_string(granule));
+
+        auto array = dynamic_cast<Array*>(const_cast<DDS&>(dds).var(name));
+        vector<dods_int32> values(ARRAY_LENGTH, static_cast<dods_int32>(granule));
+        array->set_value(values, values.size());
+        array->set_read_p(true);
+        return array;
+    }
+};
+
+class AggregationGranuleReaderTest: public CppUnit::TestFixture {
+private:
+    vector<unique_ptr<GranuleDDS> > d_holders;
+    vector<unique_ptr<AggMemberDatasetDDSWrapper> > d_datasets;
+    unique_ptr<Array> d_template;
+
+    void add_granules(AggregationGranuleReader& reader)
+    {
+        for (auto& dataset : d_datasets)
+            reader.addGranule(*dataset, *d_template);
+    }
+
+public:
+    AggregationGranuleReaderTest() = default;
+    ~AggregationGranuleReaderTest() = default;
+
+    void setUp() override
+    {
+        // getMaxParallelReads() caches the key the first time it is called
+        TheBESKeys::TheKeys()->set_key("NCML.MaxParallelGranuleReads", to_string(MAX_READS));
+
+        for (unsigned int i = 0; i < NUM_GRANULES; ++i) {
+            d_holders.emplace_back(new GranuleDDS(i));
+            d_datasets.emplace_back(new AggMemberDatasetDDSWrapper(d_holders.back().get()));
+        }
+
+        Int32 proto("v");
+        d_template.reset(new Array("v", &proto));
+        d_template->append_dim(ARRAY_LENGTH, "x");
+    }
+
+    void tearDown() override
+    {
+        d_datasets.clear();
+        d_holders.clear();
+        d_template.reset();
+    }
+
+    void max_parallel_reads_test()
+    {
+        CPPUNIT_ASSERT_EQUAL(MAX_READS, AggregationGranuleReader::getMaxParallelReads());
+    }
+
+    // The callbacks are made in granule order even though the reads of each
+    // batch finish in the reverse order.
+    void read_order_test()
+    {
+        SlowArrayGetter getter;
+        AggregationGranuleReader reader("v", getter, "ncml");
+        add_granules(reader);
+        CPPUNIT_ASSERT_EQUAL(NUM_GRANULES, reader.size());
+
+        vector<unsigned int> order;
+        vector<dods_int32> values;
+        reader.readGranules([&](unsigned int granule, Array& array) {
+            order.push_back(granule);
+            vector<dods_int32> data(array.length());
+            array.value(data.data());
+            values.push_back(data.front());
+            CPPUNIT_ASSERT(all_of(data.begin(), data.end(), [&](dods_int32 d) { return d == data.front(); }));
+        });
+
+        DBG(cerr << prolog << "max in flight: " << getter.max_in_flight << endl);
+        CPPUNIT_ASSERT_EQUAL((size_t)NUM_GRANULES, order.size());
+        for (unsigned int i = 0; i < NUM_GRANULES; ++i) {
+            CPPUNIT_ASSERT_EQUAL(i, order[i]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<dods_int32>(i), values[i]);
+        }
+        CPPUNIT_ASSERT_EQUAL(NUM_GRANULES, reader.getFailedGranule());
+    }
+
+    // No more than NCML.MaxParallelGranuleReads reads are ever in flight, and
+    // the reads of a batch do overlap.
+    void batch_limit_test()
+    {
+        SlowArrayGetter getter;
+        AggregationGranuleReader reader("v", getter, "ncml");
+        add_granules(reader);
+
+        reader.readGranules([](unsigned int, Array&) { });
+
+        DBG(cerr << prolog << "max in flight: " << getter.max_in_flight << endl);
+        CPPUNIT_ASSERT(getter.max_in_flight <= MAX_READS);
+        CPPUNIT_ASSERT(getter.max_in_flight > 1);
+        CPPUNIT_ASSERT_EQUAL(0U, getter.in_flight.load());
+    }
+
+    // A failed read is reported after the callbacks for the granules before
+    // it, and getFailedGranule() names it.
+    void failed_granule_test()
+    {
+        SlowArrayGetter getter;
+        getter.fail_granule = 4;
+        AggregationGranuleReader reader("v", getter, "ncml");
+        add_granules(reader);
+
+        vector<unsigned int> order;
+        CPPUNIT_ASSERT_THROW(reader.readGranules([&](unsigned int granule, Array&) { order.push_back(granule); }),
+            AggregationException);
+
+        CPPUNIT_ASSERT_EQUAL(4U, reader.getFailedGranule());
+        CPPUNIT_ASSERT_EQUAL((size_t)4, order.size());
+        for (unsigned int i = 0; i < order.size(); ++i)
+            CPPUNIT_ASSERT_EQUAL(i, order[i]);
+    }
+
+    // An exception thrown by the callback is reported the same way.
+    void failed_callback_test()
+    {
+        SlowArrayGetter getter;
+        AggregationGranuleReader reader("v", getter, "ncml");
+        add_granules(reader);
+
+        CPPUNIT_ASSERT_THROW(reader.readGranules([](unsigned int granule, Array&) {
+            if (granule == 2) throw AggregationException("callback failed");
+        }), AggregationException);
+
+        CPPUNIT_ASSERT_EQUAL(2U, reader.getFailedGranule());
+    }
+
+    CPPUNIT_TEST_SUITE( AggregationGranuleReaderTest );
+
+    CPPUNIT_TEST(max_parallel_reads_test);
+    CPPUNIT_TEST(read_order_test);
+    CPPUNIT_TEST(batch_limit_test);
+    CPPUNIT_TEST(failed_granule_test);
+    CPPUNIT_TEST(failed_callback_test);
+
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AggregationGranuleReaderTest);
+
+int main(int argc, char *argv[])
+{
+    return bes_run_tests<AggregationGranuleReaderTest>(argc, argv, "cerr,ncml") ? 0 : 1;
+}
@@ -45,6 +45,7 @@ static char rcsid[] not_used = { "$Id$" };
 #include <libdap/util.h>
 
 #include "NCByte.h"
+#include "nc_util.h"
 
 // This `helper function' creates a pointer to the a NCByte and returns
 // that pointer. It takes the same arguments as the class's ctor. If any of
@@ -98,7 +99,7 @@ bool NCByte::read() {
         return true;
 
     int ncid, errstat;
-    errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
     if (errstat != NC_NOERR) {
         string err = "Could not open the dataset's file (" + dataset() + ")";
         throw Error(errstat, err);
@@ -139,7 +140,7 @@ bool NCByte::read() {
 
     val2buf(&Dbyte);
 
-    if (nc_close(ncid) != NC_NOERR)
+    if (close_nc_file(ncid) != NC_NOERR)
         throw InternalErr(__FILE__, __LINE__, "Could not close the dataset!");
 
     return true;
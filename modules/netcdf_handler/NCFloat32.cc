@@ -47,6 +47,7 @@ static char rcsid[] not_used ={"$Id$"};
 #include <libdap/InternalErr.h>
 
 #include "NCFloat32.h"
+#include "nc_util.h"
 
 
 NCFloat32::NCFloat32(const string &n, const string &d) : Float32(n, d)
@@ -93,7 +94,7 @@ bool NCFloat32::read()
         return true;
 
     int ncid, errstat;
-    errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
     if (errstat != NC_NOERR) {
         string err = "Could not open the dataset's file (" + dataset() + ")";
         throw Error(errstat, err);
@@ -122,7 +123,7 @@ bool NCFloat32::read()
         flt32 = (dods_float32) flt;
         val2buf(&flt32);
 
-        if (nc_close(ncid) != NC_NOERR)
+        if (close_nc_file(ncid) != NC_NOERR)
             throw InternalErr(__FILE__, __LINE__, "Could not close the dataset!");
     }
     else
@@ -44,6 +44,7 @@ static char rcsid[] not_used ={"$Id$"};
 #include <libdap/InternalErr.h>
 
 #include "NCFloat64.h"
+#include "nc_util.h"
 
 
 NCFloat64::NCFloat64(const string &n, const string &d) : Float64(n, d)
@@ -92,7 +93,7 @@ NCFloat64::read()
         return true;
 
     int ncid, errstat;
-    errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
 
     if (errstat != NC_NOERR)
     {
@@ -128,7 +129,7 @@ NCFloat64::read()
 	flt64 = (dods_float64) dbl;
 	val2buf((void *) &flt64 );
 
-	if (nc_close(ncid) != NC_NOERR)
+	if (close_nc_file(ncid) != NC_NOERR)
 	  throw InternalErr(__FILE__, __LINE__, 
 			    "Could not close the dataset!");
     }
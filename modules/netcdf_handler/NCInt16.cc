@@ -45,6 +45,7 @@ static char rcsid[] not_used ={"$Id$"};
 
 #include "NCRequestHandler.h"
 #include "NCInt16.h"
+#include "nc_util.h"
 
 
 NCInt16::NCInt16(const string &n, const string &d) : Int16(n, d)
@@ -83,7 +84,7 @@ bool NCInt16::read() {
         return true;
 
     int ncid, errstat;
-    errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
     if (errstat != NC_NOERR) {
         string err = "Could not open the dataset's file (" + dataset() + ")";
         throw Error(errstat, err);
@@ -135,7 +136,7 @@ bool NCInt16::read() {
     dods_int16 intg16 = (dods_int16) sht;
     val2buf(&intg16);
 
-    if (nc_close(ncid) != NC_NOERR)
+    if (close_nc_file(ncid) != NC_NOERR)
         throw InternalErr(__FILE__, __LINE__, "Could not close the dataset!");
 
     return true;
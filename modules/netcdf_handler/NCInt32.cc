@@ -43,6 +43,7 @@ static char rcsid[] not_used = { "$Id$" };
 #include <libdap/InternalErr.h>
 
 #include "NCInt32.h"
+#include "nc_util.h"
 
 NCInt32::NCInt32(const string &n, const string &d) :
     Int32(n, d)
@@ -82,7 +83,7 @@ bool NCInt32::read()
         return true;
 
     int ncid, errstat;
-    errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
     if (errstat != NC_NOERR) {
         string err = "Could not open the dataset's file (" + dataset() + ")";
         throw Error(errstat, err);
@@ -127,7 +128,7 @@ bool NCInt32::read()
     dods_int32 intg32 = (dods_int32) lht;
     val2buf(&intg32);
 
-    if (nc_close(ncid) != NC_NOERR)
+    if (close_nc_file(ncid) != NC_NOERR)
         throw InternalErr(__FILE__, __LINE__, "Could not close the dataset!");
 
     return true;
@@ -30,6 +30,8 @@
 #include <sstream>
 #include <exception>
 
+#include <netcdf.h>
+
 #include <libdap/DMR.h>
 #include <libdap/DataDDS.h>
 #include <libdap/mime_util.h>
@@ -55,6 +57,7 @@
 #include <BESDMRResponse.h>
 
 #include <ObjMemCache.h>
+#include <BESFileHandleCache.h>
 
 #include <libdap/InternalErr.h>
 #include <libdap/Ancillary.h>
@@ -86,6 +89,8 @@ ObjMemCache *NCRequestHandler::dds_cache = 0;
 ObjMemCache *NCRequestHandler::datadds_cache = 0;
 ObjMemCache *NCRequestHandler::dmr_cache = 0;
 
+BESFileHandleCache<int> *NCRequestHandler::file_handle_cache = 0;
+
 extern void nc_read_dataset_attributes(DAS & das, const string & filename);
 extern void nc_read_dataset_variables(DDS & dds, const string & filename);
 
@@ -187,6 +192,12 @@ NCRequestHandler::NCRequestHandler(const string &name) :
         dmr_cache = new ObjMemCache(get_cache_entries(), get_cache_purge_level());
     }
 
+    // Keep netCDF files open between variables and requests. Zero (the default) disables this.
+    unsigned int open_files = static_cast<unsigned int>(TheBESKeys::read_ulong_key("NC.OpenFileCacheEntries", 0));
+    if (open_files && !file_handle_cache) {
+        file_handle_cache = new BESFileHandleCache<int>(open_files, [](int ncid) { nc_close(ncid); });
+    }
+
     BESDEBUG(NC_NAME, prolog << "END" << endl);
 }
 
@@ -196,6 +207,7 @@ NCRequestHandler::~NCRequestHandler()
     delete dds_cache;
     delete datadds_cache;
     delete dmr_cache;
+    delete file_handle_cache;
 }
 
 bool NCRequestHandler::nc_build_das(BESDataHandlerInterface & dhi)
@@ -31,6 +31,8 @@
 
 class ObjMemCache;  // in bes/dap
 
+template<typename Handle> class BESFileHandleCache;  // in bes/dispatch
+
 namespace libdap {
 class DDS;
 }
@@ -56,6 +58,8 @@ private:
     static ObjMemCache *datadds_cache;
     static ObjMemCache *dmr_cache;
 
+    static BESFileHandleCache<int> *file_handle_cache;
+
     static void get_dds_with_attributes(const std::string& dataset_name, const std::string& container_name, libdap::DDS* dds);
     static void get_dds_without_attributes(const std::string& dataset_name, const std::string& container_name, libdap::DDS* dds);
 
@@ -94,6 +98,10 @@ public:
 	{
 	    return _cache_purge_level;
 	}
+    static BESFileHandleCache<int> *get_file_handle_cache()
+    {
+        return file_handle_cache;
+    }
 
     // This handler supports the "not including attributes" in
     // the data access feature. Attributes are generated only
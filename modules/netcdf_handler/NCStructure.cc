@@ -242,7 +242,7 @@ bool NCStructure::read()
         return true;
 
     int ncid;
-    int errstat = nc_open(dataset().c_str(), NC_NOWRITE, &ncid); /* netCDF id */
+    int errstat = open_nc_file(dataset(), &ncid); /* netCDF id */
     if (errstat != NC_NOERR)
         throw Error(errstat, "Could not open the dataset's file (" + dataset() + ")");
 
@@ -265,7 +265,7 @@ bool NCStructure::read()
 
     set_read_p(true);
 
-    if (nc_close(ncid) != NC_NOERR)
+    if (close_nc_file(ncid) != NC_NOERR)
         throw InternalErr(__FILE__, __LINE__, "Could not close the dataset!");
 
     return true;
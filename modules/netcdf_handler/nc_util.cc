@@ -24,8 +24,15 @@
 
 #include "config.h"
 
+#include <string>
+
 #include <netcdf.h>
 
+#include <BESFileHandleCache.h>
+
+#include "NCRequestHandler.h"
+#include "nc_util.h"
+
 bool is_user_defined_type(int /*ncid*/, int type)
 {
 #if NETCDF_VERSION >= 4
@@ -54,3 +61,42 @@ bool is_user_defined_type(int /*ncid*/, int type)
 #endif
 }
 
+/**
+ * @brief Open a netCDF file for reading, reusing an open handle if there is one
+ *
+ * The handles are kept in the NCRequestHandler's open file cache (see
+ * NC.OpenFileCacheEntries). Pass the id to close_nc_file() when done.
+ *
+ * @param path The pathname of the file
+ * @param ncid Value-result parameter for the netCDF id
+ * @return The netCDF status; NC_NOERR on success
+ */
+int open_nc_file(const std::string &path, int *ncid)
+{
+    BESFileHandleCache<int> *cache = NCRequestHandler::get_file_handle_cache();
+    if (cache && cache->get(path, *ncid))
+        return NC_NOERR;
+
+    int status = nc_open(path.c_str(), NC_NOWRITE, ncid);
+    if (status == NC_NOERR && cache)
+        cache->add(path, *ncid);
+
+    return status;
+}
+
+/**
+ * @brief Release a netCDF id from open_nc_file()
+ *
+ * The file is closed unless its id is held by the open file cache.
+ *
+ * @param ncid The netCDF id
+ * @return The netCDF status; NC_NOERR on success
+ */
+int close_nc_file(int ncid)
+{
+    BESFileHandleCache<int> *cache = NCRequestHandler::get_file_handle_cache();
+    if (cache && cache->release(ncid))
+        return NC_NOERR;
+
+    return nc_close(ncid);
+}
@@ -22,4 +22,9 @@
 //
 // You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
 
+#include <string>
+
 bool is_user_defined_type(int ncid, int type);
+
+int open_nc_file(const std::string &path, int *ncid);
+int close_nc_file(int ncid);
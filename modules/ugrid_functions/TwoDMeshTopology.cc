@@ -27,8 +27,11 @@
 
 #include "config.h"
 
+#include <sys/stat.h>
+
 #include <sstream>
 #include <vector>
+#include <list>
 #include <algorithm>
 #include <functional>
 
@@ -55,6 +58,8 @@
 
 #include "BESDebug.h"
 #include "BESError.h"
+#include "BESInternalError.h"
+#include "TheBESKeys.h"
 
 #ifdef NDEBUG
 #undef BESDEBUG
@@ -67,14 +72,98 @@ using namespace ugrid;
 
 namespace ugrid {
 
+GFTopology::~GFTopology()
+{
+    BESDEBUG("ugrid", "~GFTopology() - Deleting GF::GridField 'inputGridField'." << endl);
+    delete inputGridField;
+
+    BESDEBUG("ugrid", "~GFTopology() - Deleting GF::Grid 'gridTopology'." << endl);
+    delete gridTopology;
+
+    BESDEBUG("ugrid", "~GFTopology() - Deleting GF::Arrays..." << endl);
+    for (vector<GF::Array *>::iterator it = gfArrays.begin(); it != gfArrays.end(); ++it) {
+        GF::Array *gfa = *it;
+        BESDEBUG("ugrid", "~GFTopology() - Deleting GF:Array  '" << gfa->getName() << "'" << endl);
+        delete gfa;
+    }
+
+    BESDEBUG("ugrid", "~GFTopology() - Deleting sharedIntArrays..." << endl);
+    for (vector<int *>::iterator it = sharedIntArrays.begin(); it != sharedIntArrays.end(); ++it)
+        delete[] *it;
+
+    BESDEBUG("ugrid", "~GFTopology() - Deleting sharedFloatArrays..." << endl);
+    for (vector<float *>::iterator it = sharedFloatArrays.begin(); it != sharedFloatArrays.end(); ++it)
+        delete[] *it;
+
+    BESDEBUG("ugrid", "~GFTopology() - Deleting face node connectivity cell array (GF::Node's)." << endl);
+    delete[] fncCellArray;
+}
+
+/**
+ * A small LRU cache of GFTopology objects, keyed by the dataset file, its
+ * modification time and the mesh variable name. Building the topology means
+ * reading the face node connectivity and coordinate arrays and converting them
+ * to GridFields objects, which dominates the cost of ugr5() and ugrid_restrict()
+ * on large meshes; repeated subsets of the same mesh reuse the cached copy.
+ *
+ * The size is set by UGrid.TopologyCacheEntries; zero (the default) disables it.
+ */
+class GFTopologyCache {
+    std::mutex d_lock;
+    std::list<std::pair<string, std::shared_ptr<GFTopology> > > d_entries;   // MRU at the front
+    unsigned long d_max_entries;
+
+    GFTopologyCache() :
+        d_max_entries(TheBESKeys::read_ulong_key("UGrid.TopologyCacheEntries", 0))
+    {
+    }
+
+public:
+    static GFTopologyCache *get_instance()
+    {
+        static GFTopologyCache instance;
+        return &instance;
+    }
+
+    bool enabled() const
+    {
+        return d_max_entries > 0;
+    }
+
+    std::shared_ptr<GFTopology> get(const string &key)
+    {
+        std::lock_guard<std::mutex> lock(d_lock);
+        for (auto it = d_entries.begin(); it != d_entries.end(); ++it) {
+            if (it->first == key) {
+                d_entries.splice(d_entries.begin(), d_entries, it);
+                return d_entries.front().second;
+            }
+        }
+        return std::shared_ptr<GFTopology>();
+    }
+
+    void put(const string &key, std::shared_ptr<GFTopology> gf)
+    {
+        std::lock_guard<std::mutex> lock(d_lock);
+        for (auto it = d_entries.begin(); it != d_entries.end(); ++it) {
+            if (it->first == key) {
+                d_entries.erase(it);
+                break;
+            }
+        }
+        d_entries.emplace_front(key, gf);
+        // Evicted entries stay alive until the last TwoDMeshTopology using them is deleted.
+        while (d_entries.size() > d_max_entries)
+            d_entries.pop_back();
+    }
+};
+
 /* not used. faceCoordinateNames(0), */
 TwoDMeshTopology::TwoDMeshTopology() :
     d_meshVar(0), nodeCoordinateArrays(0), nodeCount(0), faceNodeConnectivityArray(0), faceCount(0), faceCoordinateArrays(
-        0), gridTopology(0), d_inputGridField(0), resultGridField(0), fncCellArray(0), _initialized(false)
+        0), resultGridField(0), _initialized(false)
 {
     rangeDataArrays = new vector<MeshDataVariable *>();
-    sharedIntArrays = new vector<int *>();
-    sharedFloatArrays = new vector<float *>();
 }
 
 TwoDMeshTopology::~TwoDMeshTopology()
@@ -85,35 +174,8 @@ TwoDMeshTopology::~TwoDMeshTopology()
     BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting GF::GridField 'resultGridField'." << endl);
     delete resultGridField;
 
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting GF::GridField 'inputGridField'." << endl);
-    delete d_inputGridField;
-
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting GF::Grid 'gridTopology'." << endl);
-    delete gridTopology;
-
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting GF::Arrays..." << endl);
-    for (vector<GF::Array *>::iterator it = gfArrays.begin(); it != gfArrays.end(); ++it) {
-        GF::Array *gfa = *it;
-        BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting GF:Array  '" << gfa->getName() << "'" << endl);
-        delete gfa;
-    }
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - GF::Arrays deleted." << endl);
-
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting sharedIntArrays..." << endl);
-    for (vector<int *>::iterator it = sharedIntArrays->begin(); it != sharedIntArrays->end(); ++it) {
-        int *i = *it;
-        BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting integer array '" << i << "'" << endl);
-        delete[] i;
-    }
-    delete sharedIntArrays;
-
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting sharedFloatArrays..." << endl);
-    for (vector<float *>::iterator it = sharedFloatArrays->begin(); it != sharedFloatArrays->end(); ++it) {
-        float *f = *it;
-        BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting float array '" << f << "'" << endl);
-        delete[] f;
-    }
-    delete sharedFloatArrays;
+    // The GridFields input objects (d_gf) are released with the shared_ptr; they may
+    // still be held by the topology cache.
 
     BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting range data vector" << endl);
     delete rangeDataArrays;
@@ -125,9 +187,6 @@ TwoDMeshTopology::~TwoDMeshTopology()
     BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting vector of face coordinate arrays." << endl);
     delete faceCoordinateArrays;
 
-    BESDEBUG("ugrid", "~TwoDMeshTopology() - Deleting face node connectivity cell array (GF::Node's)." << endl);
-    delete[] fncCellArray;
-
     BESDEBUG("ugrid", "~TwoDMeshTopology() - END" << endl);
 }
 
@@ -185,6 +244,16 @@ void TwoDMeshTopology::init(string meshVarName, DDS *dds)
             string("ugr5(): While trying to read the UGrid mesh variable, an error occurred: ") + e.what());
     }
 
+    // The topology can be cached only when the dataset is a file we can stat; the
+    // modification time is part of the key so a changed file is never matched.
+    struct stat st;
+    if (GFTopologyCache::get_instance()->enabled() && !dds->filename().empty()
+        && stat(dds->filename().c_str(), &st) == 0) {
+        ostringstream key;
+        key << dds->filename() << '#' << st.st_mtime << '#' << meshVarName << '#' << nodeCount << 'x' << faceCount;
+        d_cacheKey = key.str();
+    }
+
     _initialized = true;
 }
 
@@ -667,20 +736,31 @@ void TwoDMeshTopology::ingestNodeCoordinateArrays(libdap::BaseType *meshTopology
 
 void TwoDMeshTopology::buildBasicGfTopology()
 {
+    if (!d_cacheKey.empty()) {
+        d_gf = GFTopologyCache::get_instance()->get(d_cacheKey);
+        if (d_gf) {
+            BESDEBUG("ugrid",
+                "TwoDMeshTopology::buildBasicGfTopology() - Using cached GridFields objects for " << d_cacheKey << endl);
+            return;
+        }
+    }
+
+    // Build into a local; if anything throws, the partial topology is released here.
+    std::shared_ptr<GFTopology> gf = std::make_shared<GFTopology>();
 
     BESDEBUG("ugrid",
         "TwoDMeshTopology::buildBasicGfTopology() - Building GridFields objects for mesh_topology variable "<< getMeshVariable()->name() << endl);
     // Start building the Grid for the GridField operation.
     BESDEBUG("ugrid",
         "TwoDMeshTopology::buildGridFieldsTopology() - Constructing new GF::Grid for "<< meshVarName() << endl);
-    gridTopology = new GF::Grid(meshVarName());
+    gf->gridTopology = new GF::Grid(meshVarName());
 
     // 1) Make the implicit nodes - same size as the node coordinate arrays
     BESDEBUG("ugrid",
         "TwoDMeshTopology::buildGridFieldsTopology() - Building and adding implicit range Nodes to the GF::Grid" << endl);
     GF::AbstractCellArray *nodes = new GF::Implicit0Cells(nodeCount);
     // Attach the implicit nodes to the grid at rank 0
-    gridTopology->setKCells(nodes, node);
+    gf->gridTopology->setKCells(nodes, node);
 
     // @TODO Do I need to add implicit k-cells for faces (rank 2) if I plan to add range data on faces later?
     // Apparently not...
@@ -690,17 +770,17 @@ void TwoDMeshTopology::buildBasicGfTopology()
     // FIXME Read this array once! It is read again below..
     BESDEBUG("ugrid",
         "TwoDMeshTopology::buildGridFieldsTopology() - Building face node connectivity Cell array from the DAP version" << endl);
-    GF::CellArray *faceNodeConnectivityCells = getFaceNodeConnectivityCells();
+    GF::CellArray *faceNodeConnectivityCells = getFaceNodeConnectivityCells(gf.get());
 
     // Attach the Mesh to the grid at rank 2
     // This 2 stands for rank 2, or faces.
     BESDEBUG("ugrid", "TwoDMeshTopology::buildGridFieldsTopology() - Attaching Cell array to GF::Grid" << endl);
-    gridTopology->setKCells(faceNodeConnectivityCells, face);
+    gf->gridTopology->setKCells(faceNodeConnectivityCells, face);
 
     // The Grid is complete. Now we make a GridField from the Grid
     BESDEBUG("ugrid",
         "TwoDMeshTopology::buildGridFieldsTopology() - Construct new GF::GridField from GF::Grid" << endl);
-    d_inputGridField = new GF::GridField(gridTopology);
+    gf->inputGridField = new GF::GridField(gf->gridTopology);
     // TODO Question for Bill: Can we delete the GF::Grid (tdmt->gridTopology) here?
 
     // We read and add the coordinate data (using GridField->addAttribute()) to the GridField at
@@ -710,9 +790,9 @@ void TwoDMeshTopology::buildBasicGfTopology()
         libdap::Array *nca = *ncit;
         BESDEBUG("ugrid",
             "TwoDMeshTopology::buildGridFieldsTopology() - Adding node coordinate "<< nca->name() << " to GF::GridField at rank 0" << endl);
-        GF::Array *gfa = extractGridFieldArray(nca, sharedIntArrays, sharedFloatArrays);
-        gfArrays.push_back(gfa);
-        d_inputGridField->AddAttribute(node, gfa);
+        GF::Array *gfa = extractGridFieldArray(nca, &gf->sharedIntArrays, &gf->sharedFloatArrays);
+        gf->gfArrays.push_back(gfa);
+        gf->inputGridField->AddAttribute(node, gfa);
     }
 
     // We read and add the coordinate data (using GridField->addAttribute() to the GridField at
@@ -721,10 +801,13 @@ void TwoDMeshTopology::buildBasicGfTopology()
         libdap::Array *fca = *ncit;
         BESDEBUG("ugrid",
             "TwoDMeshTopology::buildGridFieldsTopology() - Adding face coordinate "<< fca->name() << " to GF::GridField at rank " << face << endl);
-        GF::Array *gfa = extractGridFieldArray(fca, sharedIntArrays, sharedFloatArrays);
-        gfArrays.push_back(gfa);
-        d_inputGridField->AddAttribute(face, gfa);
+        GF::Array *gfa = extractGridFieldArray(fca, &gf->sharedIntArrays, &gf->sharedFloatArrays);
+        gf->gfArrays.push_back(gfa);
+        gf->inputGridField->AddAttribute(face, gfa);
     }
+
+    d_gf = gf;
+    if (!d_cacheKey.empty()) GFTopologyCache::get_instance()->put(d_cacheKey, d_gf);
 }
 
 int TwoDMeshTopology::getResultGridSize(locationType dim)
@@ -828,7 +911,7 @@ int TwoDMeshTopology::getStartIndex(libdap::Array *array)
  * Converts a Face node connectivity DAP array (either 3xN or Nx3)
  * into a GF::CellArray
  */
-GF::CellArray *TwoDMeshTopology::getFaceNodeConnectivityCells()
+GF::CellArray *TwoDMeshTopology::getFaceNodeConnectivityCells(GFTopology *gf)
 {
     BESDEBUG("ugrid",
         "TwoDMeshTopology::getFaceNodeConnectivityCells() - Building face node connectivity Cell array from the Array '" << faceNodeConnectivityArray->name() << "'" << endl);
@@ -838,7 +921,8 @@ GF::CellArray *TwoDMeshTopology::getFaceNodeConnectivityCells()
 
     BESDEBUG("ugrid",
         "TwoDMeshTopology::getFaceNodeConnectivityCells() - Converting FNCArray to GF::Node array." << endl);
-    fncCellArray = getFncArrayAsGFCells(faceNodeConnectivityArray);
+    GF::Node *fncCellArray = getFncArrayAsGFCells(faceNodeConnectivityArray);
+    gf->fncCellArray = fncCellArray;
 
     // adjust for the start_index (cardinal or ordinal array access)
     int startIndex = getStartIndex(faceNodeConnectivityArray);
@@ -868,7 +952,8 @@ void TwoDMeshTopology::applyRestrictOperator(locationType loc, string filterExpr
     // Build the restriction operator
     BESDEBUG("ugrid",
         "TwoDMeshTopology::applyRestrictOperator() - Constructing new GF::RestrictOp using user "<< "supplied 'dimension' value and filter expression combined with the GF:GridField " << endl);
-    GF::RestrictOp op = GF::RestrictOp(filterExpression, loc, d_inputGridField);
+    if (!d_gf) throw BESInternalError("The GridFields topology has not been built.", __FILE__, __LINE__);
+    GF::RestrictOp op = GF::RestrictOp(filterExpression, loc, d_gf->inputGridField);
 
     // Apply the operator and get the result;
     BESDEBUG("ugrid", "TwoDMeshTopology::applyRestrictOperator() - Applying GridField operator." << endl);
@@ -1277,18 +1362,26 @@ int TwoDMeshTopology::getInputGridSize(locationType location)
 
 /**
  * @brief Adds an index variable at the gridfields rank as indicated by the passed locationType.
+ *
+ * The index is added only once per location, so calling this on a topology
+ * taken from the cache is a no-op.
  */
 void TwoDMeshTopology::addIndexVariable(locationType location)
 {
+    if (!d_gf) throw BESInternalError("The GridFields topology has not been built.", __FILE__, __LINE__);
+
+    std::lock_guard<std::mutex> lock(d_gf->lock);
+    if (!d_gf->indexedLocations.insert(location).second) return;
+
     int size = getInputGridSize(location);
     string name = getIndexVariableName(location);
 
     BESDEBUG("ugrid",
         "TwoDMeshTopology::addIndexVariable() - Adding index variable '" << name << "'  size: " << libdap::long_to_string(size) << " at rank " << libdap::long_to_string(location) << endl);
 
-    GF::Array *indexArray = newGFIndexArray(name, size, sharedIntArrays);
-    d_inputGridField->AddAttribute(location, indexArray);
-    gfArrays.push_back(indexArray);
+    GF::Array *indexArray = newGFIndexArray(name, size, &d_gf->sharedIntArrays);
+    d_gf->inputGridField->AddAttribute(location, indexArray);
+    d_gf->gfArrays.push_back(indexArray);
 }
 
 /**
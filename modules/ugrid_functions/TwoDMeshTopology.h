@@ -28,6 +28,10 @@
 #ifndef _TwoDMeshTopology_h
 #define _TwoDMeshTopology_h 1
 
+#include <set>
+#include <mutex>
+#include <memory>
+
 #include <gridfields/type.h>
 #include <gridfields/gridfield.h>
 #include <gridfields/grid.h>
@@ -44,6 +48,33 @@ class Grid;
 
 namespace ugrid {
 
+/**
+ * The GridFields objects built from a mesh topology variable: the GF::Grid, the input
+ * GF::GridField with its coordinate and index attributes, and the memory backing them.
+ * Instances are immutable once built (apart from addIndexVariable(), which is guarded by
+ * the mutex) so they can be shared between TwoDMeshTopology instances that refer to the
+ * same mesh in the same file. See TwoDMeshTopology::buildBasicGfTopology().
+ */
+struct GFTopology {
+    GF::Grid *gridTopology;
+    GF::GridField *inputGridField;
+    GF::Node *fncCellArray;
+
+    vector<GF::Array *> gfArrays;
+    vector<int *> sharedIntArrays;
+    vector<float *> sharedFloatArrays;
+
+    /// The locations that already have an index attribute.
+    std::set<int> indexedLocations;
+    std::mutex lock;
+
+    GFTopology() :
+        gridTopology(0), inputGridField(0), fncCellArray(0)
+    {
+    }
+    ~GFTopology();
+};
+
 /**
  * Identifies the location/rank/dimension that various grid components are associated with.
  */
@@ -178,16 +209,11 @@ private:
      */
     //vector<string> *edgeCoordinateNames;
     //vector<Array *> *edgeCoordinateArrays;
-    GF::Grid *gridTopology;
-    GF::GridField *d_inputGridField;
+    std::shared_ptr<GFTopology> d_gf;
     GF::GridField *resultGridField;
 
-    vector<int *> *sharedIntArrays;
-    vector<float *> *sharedFloatArrays;
-
-    vector<GF::Array *> gfArrays;
-
-    GF::Node *fncCellArray;
+    /// Key used for the topology cache; empty if this mesh cannot be cached.
+    string d_cacheKey;
 
     bool _initialized;
 
@@ -197,7 +223,7 @@ private:
 
     GF::Node *getFncArrayAsGFCells(libdap::Array *fncVar);
     int getStartIndex(libdap::Array *array);
-    GF::CellArray *getFaceNodeConnectivityCells();
+    GF::CellArray *getFaceNodeConnectivityCells(GFTopology *gf);
 
     libdap::Array *getGFAttributeAsDapArray(libdap::Array *sourceArray, locationType rank,
         GF::GridField *resultGridField);
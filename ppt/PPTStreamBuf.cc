@@ -80,7 +80,9 @@ int PPTStreamBuf::sync()
         strm << hex << setw(7) << setfill('0') << (unsigned int) (pptr() - pbase()) << "d";
         write(d_fd, strm.str().c_str(), strm.str().size());
 
-        count += write(d_fd, d_buffer, pptr() - pbase());
+        ssize_t bytes = write(d_fd, d_buffer, pptr() - pbase());
+        if (bytes > 0)
+            count += bytes;
         setp(d_buffer, d_buffer + d_bufsize);
     }
 
@@ -103,6 +105,7 @@ void PPTStreamBuf::finish()
 
     write(d_fd, eod_marker, eod_marker_len);
 
+    d_response_bytes = count;
     count = 0;
 }
 
@@ -40,7 +40,8 @@ private:
     unsigned d_bufsize {0};
     int d_fd {-1};
     char * d_buffer {nullptr};
-    unsigned int count {0};
+    unsigned long long count {0};
+    unsigned long long d_response_bytes {0};
 
     PPTStreamBuf() = default;
 
@@ -55,6 +56,9 @@ public:
     int overflow(int c) override;
 
     void finish();
+
+    /// @brief The number of data bytes in the response ended by the last call to finish()
+    unsigned long long response_bytes() const { return d_response_bytes; }
 };
 
 #endif // I_PPTStreamBuf_h 1
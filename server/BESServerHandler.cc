@@ -55,6 +55,7 @@
 #include "PPTStreamBuf.h"
 #include "PPTProtocolNames.h"
 #include "BESLog.h"
+#include "BESMetrics.h"
 #include "BESDebug.h"
 #include "BESStopWatch.h"
 
@@ -197,6 +198,7 @@ void BESServerHandler::execute(Connection *connection)
         if (status == 0) {
             cmd.finish(status);
             fds.finish();
+            BESMetrics::TheMetrics()->add("bes_response_bytes_total", fds.response_bytes());
             BESDEBUG(MODULE, prolog << "Client command successfully processed." << endl);
         }
         else {
@@ -215,6 +217,7 @@ void BESServerHandler::execute(Connection *connection)
             cmd.finish(status);
             // we are finished, send the last chunk
             fds.finish();
+            BESMetrics::TheMetrics()->add("bes_response_bytes_total", fds.response_bytes());
 
             // If the status is fatal, then we want to exit. Otherwise,
             // continue, wait for the next request.
@@ -51,6 +51,8 @@
 #include "ServerExitConditions.h"
 #include "TheBESKeys.h"
 #include "BESLog.h"
+#include "BESMemoryLedger.h"
+#include "BESMetrics.h"
 #include "SocketListener.h"
 #include "TcpSocket.h"
 #include "UnixSocket.h"
@@ -433,6 +435,11 @@ int ServerApp::initialize(int argc, char **argv)
     int ret = BESModuleApp::initialize(argc, argv);
     BESDEBUG("beslistener", "beslistener: done initializing loaded modules" << endl);
 
+    // Make the metrics table and the memory ledger now, so the processes
+    // forked for each client share them.
+    BESMetrics::TheMetrics();
+    BESMemoryLedger::TheLedger();
+
     BESDEBUG("beslistener", "beslistener: initialized settings:" << *this);
 
     if (needhelp) {
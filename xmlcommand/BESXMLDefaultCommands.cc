@@ -53,6 +53,8 @@
 #include "ShowPathInfoCommand.h"
 #include "ShowBesKeyCommand.h"
 #include "ShowBesKeyResponseHandler.h"
+#include "ShowMetricsCommand.h"
+#include "ShowMetricsResponseHandler.h"
 
 #include "SetContextsNames.h"
 #include "XMLSetContextsCommand.h"
@@ -119,6 +121,11 @@ int BESXMLDefaultCommands::initialize(int, char**)
     BESDEBUG("besxml", "    adding " << SHOW_BES_KEY_RESPONSE << " response handler" << endl ) ;
     BESResponseHandlerList::TheList()->add_handler( SHOW_BES_KEY_RESPONSE, ShowBesKeyResponseHandler::ShowBesKeyResponseBuilder ) ;
 
+    BESXMLCommand::add_command( SHOW_METRICS_RESPONSE_STR, ShowMetricsCommand::CommandBuilder ) ;
+
+    BESDEBUG("besxml", "    adding " << SHOW_METRICS_RESPONSE << " response handler" << endl ) ;
+    BESResponseHandlerList::TheList()->add_handler( SHOW_METRICS_RESPONSE, ShowMetricsResponseHandler::ShowMetricsResponseBuilder ) ;
+
     BESDEBUG("besxml", "Done Initializing default commands:" << endl);
 
     return 0;
@@ -155,6 +162,8 @@ int BESXMLDefaultCommands::terminate(void)
     BESXMLCommand::del_command( DELETE_CONTAINER_STR);
     BESXMLCommand::del_command( DELETE_CONTAINERS_STR);
     BESXMLCommand::del_command( DELETE_DEFINITION_STR);
+    BESXMLCommand::del_command( SHOW_METRICS_RESPONSE_STR);
+    BESResponseHandlerList::TheList()->remove_handler(SHOW_METRICS_RESPONSE);
 
     BESDEBUG("besxml", "Done Removing default commands:" << endl);
 
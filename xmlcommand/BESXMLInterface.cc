@@ -46,6 +46,7 @@
 #include "BESReturnManager.h"
 #include "BESInfo.h"
 #include "BESStopWatch.h"
+#include "BESTrace.h"
 #include "TheBESKeys.h"
 
 #include "BESDebug.h"
@@ -357,6 +358,9 @@ void BESXMLInterface::execute_data_request_plan()
 
         d_dhi_ptr = &bescmd->get_xmlcmd_dhi();
 
+        // A setContexts command that ran before this one may have asked for a trace.
+        BESTrace::begin_request(BESLog::TheLog()->get_request_id());
+
         log_the_command();
 
         // Here's where we could look at the dynamic type to do something different
@@ -370,12 +374,16 @@ void BESXMLInterface::execute_data_request_plan()
             throw BESInternalError(string("The response handler '") + d_dhi_ptr->action + "' does not exist", __FILE__,
             __LINE__);
 
-        d_dhi_ptr->response_handler->execute(*d_dhi_ptr);
+        {
+            BES_TRACE_SPAN("dispatch", "execute " + d_dhi_ptr->action);
+            d_dhi_ptr->response_handler->execute(*d_dhi_ptr);
+        }
 
         RequestServiceTimer::TheTimer()->throw_if_timeout_expired(
                 prolog + "The BES ran out of time before the data could be transmitted.",
                 __FILE__,__LINE__);
 
+        BES_TRACE_SPAN("dispatch", "transmit " + d_dhi_ptr->action);
         transmit_data();
     }
 }
@@ -0,0 +1,86 @@
+// ShowMetricsCommand.cc
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include "ShowMetricsCommand.h"
+#include "BESDebug.h"
+#include "BESXMLUtils.h"
+#include "BESSyntaxUserError.h"
+
+using std::endl;
+using std::ostream;
+using std::string;
+using std::map;
+
+ShowMetricsCommand::ShowMetricsCommand(const BESDataHandlerInterface &base_dhi) :
+    BESXMLCommand(base_dhi)
+{
+}
+
+/** @brief parse a showMetrics command. No properties or children elements
+ *
+ * ~~~{.xml}
+ * <showMetrics />
+ * ~~~
+ *
+ * @param node xml2 element node pointer
+ */
+void ShowMetricsCommand::parse_request(xmlNode *node)
+{
+    string name;
+    string value;
+    map<string, string> props;
+    BESXMLUtils::GetNodeInfo(node, name, value, props);
+    if (name != SHOW_METRICS_RESPONSE_STR) {
+        string err = "The specified command " + name + " is not a " + SHOW_METRICS_RESPONSE_STR + " command";
+        throw BESSyntaxUserError(err, __FILE__, __LINE__);
+    }
+
+    d_xmlcmd_dhi.action = SHOW_METRICS_RESPONSE;
+    d_cmd_log_info = "show metrics;";
+
+    BESDEBUG("besxml", "Built BES Command: '" << d_cmd_log_info << "'" << endl);
+
+    BESXMLCommand::set_response();
+}
+
+/** @brief dumps information about this object
+ *
+ * Displays the pointer value of this instance
+ *
+ * @param strm C++ i/o stream to dump the information to
+ */
+void ShowMetricsCommand::dump(ostream &strm) const
+{
+    strm << BESIndent::LMarg << "ShowMetricsCommand::dump - (" << (void *) this << ")" << endl;
+    BESIndent::Indent();
+    BESXMLCommand::dump(strm);
+    BESIndent::UnIndent();
+}
+
+BESXMLCommand *
+ShowMetricsCommand::CommandBuilder(const BESDataHandlerInterface &base_dhi)
+{
+    return new ShowMetricsCommand(base_dhi);
+}
@@ -0,0 +1,62 @@
+// ShowMetricsCommand.h
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef A_ShowMetricsCommand_h
+#define A_ShowMetricsCommand_h 1
+
+#include "BESXMLCommand.h"
+
+class BESDataHandlerInterface;
+
+#define SHOW_METRICS_RESPONSE_STR "showMetrics"
+#define SHOW_METRICS_RESPONSE     "show.metrics"
+
+/**
+ * @brief Return the server's metrics in the Prometheus text format
+ *
+ * The command syntax is
+ * ~~~{.xml}
+ * <showMetrics/>
+ * ~~~
+ * The response is the text written by BESMetrics::write_prometheus(), so it
+ * holds the counts and latencies of all the BES processes. It is empty when
+ * BES.Metrics.Enabled is not true.
+ */
+class ShowMetricsCommand: public BESXMLCommand {
+public:
+    ShowMetricsCommand(const BESDataHandlerInterface &base_dhi);
+    virtual ~ShowMetricsCommand() = default;
+
+    void parse_request(xmlNode *node) override;
+
+    bool has_response() override
+    {
+        return true;
+    }
+
+    void dump(std::ostream &strm) const override;
+
+    static BESXMLCommand * CommandBuilder(const BESDataHandlerInterface &base_dhi);
+};
+
+#endif // A_ShowMetricsCommand_h
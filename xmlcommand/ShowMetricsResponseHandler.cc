@@ -0,0 +1,95 @@
+// ShowMetricsResponseHandler.cc
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#include "config.h"
+
+#include <sstream>
+
+#include "ShowMetricsResponseHandler.h"
+
+#include "BESTextInfo.h"
+#include "BESMetrics.h"
+#include "BESInternalError.h"
+#include "BESDebug.h"
+
+using namespace std;
+
+ShowMetricsResponseHandler::ShowMetricsResponseHandler(const string &name) :
+    BESResponseHandler(name)
+{
+}
+
+/** @brief executes the command 'show metrics;'
+ *
+ * The response object, a BESTextInfo, holds the metrics in the Prometheus
+ * text format.
+ *
+ * @param dhi structure that holds request and response information
+ */
+void ShowMetricsResponseHandler::execute(BESDataHandlerInterface &dhi)
+{
+    BESInfo *info = new BESTextInfo();
+    d_response_object = info;
+
+    ostringstream oss;
+    BESMetrics::TheMetrics()->write_prometheus(oss);
+
+    info->begin_response(SHOW_METRICS_RESPONSE_STR, dhi);
+    info->add_data(oss.str());
+    info->end_response();
+}
+
+/** @brief transmit the response object built by the execute command
+ * using the specified transmitter object
+ *
+ * @param transmitter object that knows how to transmit specific basic types
+ * @param dhi structure that holds the request and response information
+ */
+void ShowMetricsResponseHandler::transmit(BESTransmitter *transmitter, BESDataHandlerInterface &dhi)
+{
+    if (d_response_object) {
+        BESInfo *info = dynamic_cast<BESInfo *>(d_response_object);
+        if (!info) throw BESInternalError("Could not get the Info object in ShowMetricsResponseHandler::transmit()", __FILE__, __LINE__);
+        info->transmit(transmitter, dhi);
+    }
+}
+
+/** @brief dumps information about this object
+ *
+ * Displays the pointer value of this instance
+ *
+ * @param strm C++ i/o stream to dump the information to
+ */
+void ShowMetricsResponseHandler::dump(ostream &strm) const
+{
+    strm << BESIndent::LMarg << "ShowMetricsResponseHandler::dump - (" << (void *) this << ")" << std::endl;
+    BESIndent::Indent();
+    BESResponseHandler::dump(strm);
+    BESIndent::UnIndent();
+}
+
+BESResponseHandler *
+ShowMetricsResponseHandler::ShowMetricsResponseBuilder(const string &name)
+{
+    return new ShowMetricsResponseHandler(name);
+}
@@ -0,0 +1,54 @@
+// ShowMetricsResponseHandler.h
+
+// This file is part of bes, A C++ back-end server implementation framework
+// for the OPeNDAP Data Access Protocol.
+
+// Copyright (c) 2025 OPeNDAP, Inc.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//
+// You can contact OPeNDAP, Inc. at PO Box 112, Saunderstown, RI. 02874-0112.
+
+#ifndef I_ShowMetricsResponseHandler_h
+#define I_ShowMetricsResponseHandler_h 1
+
+#include <string>
+#include <ostream>
+
+#include "BESResponseHandler.h"
+#include "ShowMetricsCommand.h"
+
+/** @brief Response handler that returns the BES metrics
+ *
+ * Like the site map, the metrics have a format of their own (the Prometheus
+ * text exposition format), so this handler uses a BESTextInfo object
+ * regardless of the BES's default Info object configuration.
+ *
+ * @see BESMetrics
+ */
+class ShowMetricsResponseHandler: public BESResponseHandler {
+public:
+    ShowMetricsResponseHandler(const std::string &name);
+    virtual ~ShowMetricsResponseHandler() = default;
+
+    void execute(BESDataHandlerInterface &dhi) override;
+    void transmit(BESTransmitter *transmitter, BESDataHandlerInterface &dhi) override;
+
+    void dump(std::ostream &strm) const override;
+
+    static BESResponseHandler *ShowMetricsResponseBuilder(const std::string &name);
+};
+
+#endif // I_ShowMetricsResponseHandler_h